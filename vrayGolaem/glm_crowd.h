@@ -13,6 +13,7 @@
 
 	You can #define GLMC_ASSERT(expression) before the #include to avoid using system assert.
 	And #define GLMC_MALLOC(size), GLMC_REALLOC(pointer, size), and GLMC_FREE(pointer, size) to avoid using malloc, realloc, and free
+	#define GLMC_NO_SSE to build the scalar frame kernels only, or GLMC_NO_AVX2 to leave out the AVX2 ones (see glmInitSimdDispatch)
 
 	QUICK NOTES:
 	Primarily of interest to pipeline developers to integrate Golaem Crowd simulation cache
@@ -193,6 +194,41 @@ extern "C"
 	} GlmFrameData_v0;
 	typedef GlmFrameData_v0 GlmFrameData;
 
+#define GSC_SOA_ALIGNMENT 32 // bytes, alignment of GlmFrameDataSoA arrays
+#define GSC_SOA_LANE_COUNT 8 // GlmFrameDataSoA arrays are padded to a multiple of this count
+
+	// structure of arrays view of GlmFrameData bones, for vectorized consumers. Bones are in GlmFrameData order (per EntityType, then per entity in its entityType)
+	typedef struct GlmFrameDataSoA_v0
+	{
+		uint32_t _entityCount; // number of entities in the simulation cache
+		uint32_t _boneValueCount; // number of bones of all entities
+		uint32_t _paddedBoneValueCount; // _boneValueCount rounded up to GSC_SOA_LANE_COUNT, padding bones are identity transforms
+		uint32_t* _entityBoneOffsets; // index of the first bone of each entity (in simulation entity order), array size = _entityCount
+
+		// GSC_SOA_ALIGNMENT aligned, array size = _paddedBoneValueCount
+		float* _positionsX;
+		float* _positionsY;
+		float* _positionsZ;
+		float* _orientationsX;
+		float* _orientationsY;
+		float* _orientationsZ;
+		float* _orientationsW;
+
+		void* _allocation; // single allocation holding all arrays
+	} GlmFrameDataSoA_v0;
+	typedef GlmFrameDataSoA_v0 GlmFrameDataSoA;
+
+	// bones evaluated at several sub-frame times, for motion blur
+	typedef struct GlmFrameSamples_v0
+	{
+		uint32_t _sampleCount; // number of sample times
+		uint32_t _boneValueCount; // number of bones of one sample, in GlmFrameData bone order
+		float* _sampleTimes; // sample times in frames, array size = _sampleCount
+		float(*_bonePositions)[3]; // [sample][bone] bone positions, array size = _sampleCount * _boneValueCount
+		float(*_boneOrientations)[4]; // [sample][bone] bone orientations, array size = _sampleCount * _boneValueCount
+	} GlmFrameSamples_v0;
+	typedef GlmFrameSamples_v0 GlmFrameSamples;
+
 	// per tranform layer
 	typedef struct GlmHistory_v0
 	{
@@ -363,6 +399,7 @@ extern "C"
 		// edited posture
 		uint32_t _postureCount;
 		uint32_t *_postureFrames;
+		uint32_t *_postureFrameOrder; // posture indices sorted by frame, size = _postureCount
 		
 		uint32_t _postureBoneCount; // bones per posture. total bone for this entity must be multiplied by _postureFrameCount. Just a helper instead of accessing simulation data.
 		float(*_posturesPositions)[3]; // transform vector4 parameter, size = _transformCount
@@ -449,6 +486,7 @@ extern "C"
 		GSC_FILE_FORMAT_ERROR, // incorrect format, could be a newer version of the Golaem Simulation Cache
 		GSC_SIMULATION_FILE_DOES_NOT_MATCH, // used Golaem Simulation Cache simulation file does not match this frame file
 		GSC_SIMULATION_NO_FRAMES_FOUND, // used when no frame could be loaded from the cache
+		GSC_OUT_OF_MEMORY, // an allocation failed, only returned by the functions implemented in this header
 	} GlmSimulationCacheStatus;
 
 	// convert a simulation cache status in an error message
@@ -456,7 +494,7 @@ extern "C"
 
 	// Simulation cache functions-------------------------------------------------
 
-	// allocate *simulationData
+	// allocate *simulationData, NULL if it could not be allocated
 	void glmCreateSimulationData(
 		GlmSimulationData** simulationData, // *simulationData will be allocated by this function
 		uint32_t entityCount, // number of entities, range = 0..4,294,967,295
@@ -495,9 +533,65 @@ extern "C"
 	// return GSC_SUCCESS || GSC_FILE_OPEN_FAILED
 	extern GlmSimulationCacheStatus glmWriteFrameData(const char* file, const GlmFrameData* frameData, const GlmSimulationData* simulationData);
 
+	// write *frameData in a chunked .gscf file : frame data are split per entity type in blocks of entityBlockSize entities taken in simulation order,
+	// located by an offset table with the simulation entity index range of each block, so that entity subsets can be read without decoding the whole file.
+	// glmReadFrameData and glmCreateAndReadCompressedFrameData read chunked files entirely
+	// return GSC_SUCCESS || GSC_FILE_OPEN_FAILED
+	extern GlmSimulationCacheStatus glmWriteFrameDataBlocks(const char* file, const GlmFrameData* frameData, const GlmSimulationData* simulationData, unsigned int entityBlockSize);
+
+	// read the entities [firstEntity, firstEntity + entityCount) of a chunked .gscf file in the previously allocated *frameData. Blocks whose simulation entity
+	// index range intersects these entities are decoded entirely, the other entities of the frame are not written and cloth data only hold the decoded entities.
+	// Files which are not chunked are read entirely
+	// return GSC_SUCCESS || GSC_FILE_OPEN_FAILED || GSC_FILE_MAGIC_NUMBER_ERROR || GSC_FILE_VERSION_ERROR || GSC_FILE_FORMAT_ERROR || GSC_SIMULATION_FILE_DOES_NOT_MATCH
+	extern GlmSimulationCacheStatus glmReadFrameDataEntityRange(GlmFrameData* frameData, const GlmSimulationData* simulationData, const char* file, unsigned int firstEntity, unsigned int entityCount);
+
+	// same as glmReadFrameDataEntityRange for the entities of the entity types enabled in entityTypeEnabled, array size = entityTypeCount
+	extern GlmSimulationCacheStatus glmReadFrameDataEntityTypes(GlmFrameData* frameData, const GlmSimulationData* simulationData, const char* file, const uint8_t* entityTypeEnabled);
+
 	// deallocate *frameData and set it to NULL
 	extern void glmDestroyFrameData(GlmFrameData** frameData, const GlmSimulationData* simulationData);
 
+	// frame keeping the bones of a .gscf file in their quantized file encoding, bones are decoded on demand per entity or for the whole frame.
+	// Only the payloads of _cacheFormat are allocated. The other data (sns, blind data, geo behavior, cloth, pp attributes) are decoded in
+	// _frameData, whose bone arrays are NULL
+	typedef struct GlmCompressedFrameData_v0
+	{
+		uint8_t _cacheFormat;
+		uint32_t _boneCount; // total bone count of the frame
+		uint32_t _rootBoneCount; // one root bone per entity
+
+		uint32_t* _iRootBoneOffsetPerEntityType; // P48 : index of the first root of the entity type in _rootBonePositions, array size = entityTypeCount
+		float(*_rootBonePositions)[3]; // P48 : root bones positions, array size = _rootBoneCount
+		uint16_t(*_compressedBonePositions)[3]; // P48 : child bones positions relative to their root, array size = _boneCount - _rootBoneCount
+		float(*_bonePositions)[3]; // P96 : array size = _boneCount
+
+		uint32_t* _compressedBoneOrientations32; // O32 : array size = _boneCount
+		uint64_t* _compressedBoneOrientations64; // O64 : array size = _boneCount
+		float(*_boneOrientations)[4]; // O128 : array size = _boneCount
+
+		GlmFrameData* _frameData;
+	} GlmCompressedFrameData_v0;
+	typedef GlmCompressedFrameData_v0 GlmCompressedFrameData;
+
+	// allocate *compressedFrameData and read a .gscf file in it. *compressedFrameData is NULL on failure
+	// return GSC_SUCCESS || GSC_FILE_OPEN_FAILED || GSC_FILE_MAGIC_NUMBER_ERROR || GSC_FILE_VERSION_ERROR || GSC_FILE_FORMAT_ERROR || GSC_SIMULATION_FILE_DOES_NOT_MATCH
+	extern GlmSimulationCacheStatus glmCreateAndReadCompressedFrameData(GlmCompressedFrameData** compressedFrameData, const GlmSimulationData* simulationData, const char* file);
+
+	// decode the bones of entity entityIndex, same values as glmReadFrameData. arrays size = bone count of the entity type
+	extern void glmGetCompressedEntityBones(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, unsigned int entityIndex, float(*bonePositions)[3], float(*boneOrientations)[4]);
+
+	// decode the root bone of entity entityIndex only, same values as glmReadFrameData
+	extern void glmGetCompressedEntityRootBone(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, unsigned int entityIndex, float bonePosition[3], float boneOrientation[4]);
+
+	// allocate *frameData and decode the whole frame in it, same result as glmReadFrameData
+	extern void glmDecompressFrameData(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, GlmFrameData** frameData);
+
+	// Compute the size in bytes allocated for a GlmCompressedFrameData
+	extern uint64_t glmComputeCompressedFrameDataSize(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData);
+
+	// deallocate *compressedFrameData and set it to NULL
+	extern void glmDestroyCompressedFrameData(GlmCompressedFrameData** compressedFrameData, const GlmSimulationData* simulationData);
+
 	// create a transform layer
 	extern void glmCreateHistory(GlmHistory** history, unsigned int transformCount, unsigned int transformGroupCount, unsigned int entityCount, unsigned int totalPostureCount, unsigned int totalPostureBoneCount, unsigned int totalEntityTypesBoneCount, unsigned int totalMeshAssetsOverride, unsigned int duplicatedEntityCount, unsigned int totalEntityTypeCount, unsigned int expandCount, unsigned int totalFrameOffsetCount, unsigned int totalFrameWarpCount, unsigned int scaleRangeCount, unsigned int perFramePosOriCount, unsigned int snapToTotalCount);
 
@@ -508,6 +602,11 @@ extern "C"
 	extern int (*glmRaycastClosest)(void *terrain, const float* rayOrigin, const float* rayEnd, float *collisionPoint, float *collisionNormal, float *proxyMatrix, float *proxyMatrixInverse);
 
 	extern void(*glmTerrainSetFrame)(void *terrainSource, void *terrainDestination, int frame);
+
+	// optional host parallel loop shared by the library: cloth decoding and transform here, frame interpolation, skinning and skinned
+	// entity generation in glm_crowd_io.h. Must run task on ranges covering [0, count) and return once all are done.
+	// left NULL, the loop runs on the calling thread
+	extern void(*glmParallelFor)(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count);
 #ifndef GLMC_NO_JSON
 	// write *frameData in a JSON .gscla file
 	// return GSC_SUCCESS || GSC_FILE_OPEN_FAILED
@@ -527,18 +626,193 @@ extern "C"
 	// deallocate a GlmEntityTransform
 	void glmDestroyEntityTransforms(GlmEntityTransform** entityTransforms, unsigned int entityTransformCount);
 
-	// Create a new GlmSimulationData pointed by simulationDataDestination made of simulationDataSource and modifications. User is responsible of simulationDataDestination deletion
+	// Create a new GlmSimulationData pointed by simulationDataDestination made of simulationDataSource and modifications, NULL if it could not be allocated.
+	// User is responsible of simulationDataDestination deletion
 	void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmSimulationData** simulationDataDestination);
 
+	// same as glmCreateModifiedSimulationData when entityTransforms keep the entity set of simulationDataSource (no duplicate or snap to, same entity order) :
+	// *simulationDataDestination shares the source arrays, only the fields modified by the transforms (scales, radius, height, max hierarchy length) are its own.
+	// Returns 0 and sets *simulationDataDestination to NULL otherwise, use glmCreateModifiedSimulationData then.
+	// simulationDataSource must stay alive while the view is used : release both with glmDestroySimulationDataView + glmDestroySimulationData,
+	// or destroy the source with glmDetachSimulationDataView once not needed anymore, the view then owns all its arrays and is released with glmDestroySimulationData.
+	// glmUpdateLayoutEvaluator uses a view as _simulationDataOut for layouts without duplicate or snap to
+	int glmCreateModifiedSimulationDataView(GlmSimulationData* simulationDataSource, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmSimulationData** simulationDataDestination);
+
+	// deallocate *simulationDataView and its own scale fields, the arrays shared with simulationDataSource are left alive, and set it to NULL
+	void glmDestroySimulationDataView(GlmSimulationData** simulationDataView, const GlmSimulationData* simulationDataSource);
+
+	// deallocate *simulationDataSource except the arrays shared with simulationDataView, and set it to NULL
+	void glmDetachSimulationDataView(GlmSimulationData* simulationDataView, GlmSimulationData** simulationDataSource);
+
 	// Create a new GlmFrameData pointed by frameDataDestination made of frameDataSource and modifications. User is responsible of frameDataDestination deletion
 	GlmSimulationCacheStatus glmCreateModifiedFrameData(GlmSimulationData* simulationDataIn, GlmFrameData* frameDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmSimulationData* simulationDataOut, GlmFrameData** frameDataOut, int currentFrame, const char * filePathModel, const char * cacheDirectory);
 
 	void glmInterpolateFrameData(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result); // ratio must be between 0 (full frame 1) and 1 (full frame 2), frames must be of same simulationData
 
+	// allocate *frameSamples and evaluate the bones of simulationDataIn at sampleTimes (in frames, any order)
+	// each integer frame surrounding the samples is read, and modified when history is not NULL, only once.
+	// entityTransforms come from glmCreateEntityTransforms, simulationDataOut from glmCreateModifiedSimulationData (both shared by all samples), simulationDataOut = simulationDataIn if history is NULL
+	// filePathModel is the .gscf path with %d for the frame index. A missing frame is replaced by the last cache frame before it,
+	// a sample with neither of its frames found fails the whole call
+	// return GSC_SUCCESS || GSC_SIMULATION_NO_FRAMES_FOUND || GSC_OUT_OF_MEMORY (nothing left allocated)
+	GlmSimulationCacheStatus glmCreateFrameSamples(GlmFrameSamples** frameSamples, GlmSimulationData* simulationDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmSimulationData* simulationDataOut, const float* sampleTimes, unsigned int sampleCount, const char* filePathModel, const char* cacheDirectory);
+
+	// deallocate *frameSamples and set it to NULL
+	void glmDestroyFrameSamples(GlmFrameSamples** frameSamples);
+
+	// incremental layout evaluation : keeps the last evaluated history, entity transforms and modified frame. glmUpdateLayoutEvaluator diffs
+	// the new history transform by transform, re-evaluates the transforms of the entities referenced by changed transforms (with the sources
+	// and duplicates of their duplicate/snap to transforms) and only recomputes their frame data, cloth included.
+	// A frame change reuses the transforms and simulation data and recomputes the frame data of all the entities.
+	// Transforms are rebuilt from scratch when the entity set, the history options, groups, local bones or postures change.
+	// With _deferDuplicates the frame result is a GlmDeferredFrameData : rigid duplicates are not materialized
+	typedef struct GlmLayoutEvaluator_v0
+	{
+		GlmSimulationData* _simulationDataIn; // source simulation data, not owned
+		const GlmFrameData* _frameDataIn; // source frame of the last evaluation, not owned
+		int _currentFrame;
+		int _deferDuplicates; // set before the first update : the frame result is _deferredFrameDataOut instead of _frameDataOut
+
+		// last evaluated history
+		uint32_t _historyHash; // everything the evaluation reads outside of the per transform arrays
+		uint32_t _transformCount;
+		uint32_t* _transformHashes; // array size = _transformCount
+		uint8_t* _transformTypes; // array size = _transformCount
+		int64_t* _entityIds; // copy of history->_entityIds
+		uint32_t* _entityArrayStartIndex; // array size = _transformCount
+		uint32_t* _entityArrayCount; // array size = _transformCount
+		int64_t* _duplicatedEntityIds; // copy of history->_duplicatedEntityIds
+		uint32_t* _duplicatedEntityArrayStartIndex; // array size = _transformCount
+		uint32_t* _duplicatedEntityArrayCount; // array size = _transformCount
+
+		// last evaluation result
+		GlmEntityTransform* _entityTransforms;
+		int _entityTransformCount;
+		struct GlmEntityIndexMap_v0* _entityIndexMap; // entity id to index in _entityTransforms
+		GlmSimulationData* _simulationDataOut; // view of _simulationDataIn when the layout keeps its entity set, see glmCreateModifiedSimulationDataView
+		GlmFrameData* _frameDataOut; // NULL with _deferDuplicates
+		struct GlmDeferredFrameData_v0* _deferredFrameDataOut; // entities of _simulationDataOut, refers to _frameDataIn. NULL without _deferDuplicates
+		uint32_t _updatedTransformCount; // entity transforms re-evaluated by the last update, _entityTransformCount when rebuilt
+		uint32_t _updatedEntityCount; // entities whose frame data was recomputed by the last update
+		uint8_t _simulationDataOutIsView; // _simulationDataOut shares the arrays of _simulationDataIn
+	} GlmLayoutEvaluator_v0;
+	typedef GlmLayoutEvaluator_v0 GlmLayoutEvaluator;
+
+	// allocate *evaluator for simulationDataIn, nothing is evaluated before the first glmUpdateLayoutEvaluator. *evaluator is NULL if the allocation failed
+	void glmCreateLayoutEvaluator(GlmLayoutEvaluator** evaluator, GlmSimulationData* simulationDataIn);
+
+	// evaluate history on frameDataIn, result in evaluator->_simulationDataOut / _frameDataOut or _deferredFrameDataOut (owned by the evaluator).
+	// frameDataIn must outlive a deferred result
+	// same parameters as glmCreateModifiedFrameData, return GSC_SUCCESS || GSC_SIMULATION_NO_FRAMES_FOUND || GSC_OUT_OF_MEMORY.
+	// On failure the evaluator is cleared and the next update evaluates from scratch
+	GlmSimulationCacheStatus glmUpdateLayoutEvaluator(GlmLayoutEvaluator* evaluator, GlmFrameData* frameDataIn, GlmHistory* history, int currentFrame, const char* filePathModel, const char* cacheDirectory);
+
+	// deallocate *evaluator and its results, and set it to NULL
+	void glmDestroyLayoutEvaluator(GlmLayoutEvaluator** evaluator);
+
+	// copy on write frame data : duplicated entities which are a plain rigid copy of their source (no bone edit, posture, cloth, frame offset,
+	// trajectory or ground adaptation) keep a reference to the source entity in frameDataIn and their transform, their bones are computed on demand.
+	// Other entities are materialized in a frame of their own
+	typedef struct GlmDeferredFrameData_v0
+	{
+		const GlmSimulationData* _simulationDataIn; // not owned
+		const GlmFrameData* _frameDataIn; // source frame of deferred entities, not owned, must outlive the deferred frame
+		GlmSimulationData* _materializedSimulationData; // layout of _materializedFrameData
+		GlmFrameData* _materializedFrameData;
+
+		uint32_t _entityCount; // == entityTransformCount
+		int32_t* _entityIndices; // >= 0 : index in _materializedFrameData, < 0 : deferred entity -1 - _entityIndices[i]. array size = _entityCount
+
+		// deferred entities. array size = _deferredEntityCount
+		uint32_t _deferredEntityCount;
+		int32_t* _deferredSourceIndices; // index in _frameDataIn
+		float(*_deferredMatrices)[16];
+		float(*_deferredOrientations)[4];
+		float* _deferredScales;
+	} GlmDeferredFrameData_v0;
+	typedef GlmDeferredFrameData_v0 GlmDeferredFrameData;
+
+	// same as glmCreateModifiedFrameData but duplicates are deferred when possible. entityTransforms are updated like with glmCreateModifiedFrameData
+	// return GSC_SUCCESS || GSC_SIMULATION_NO_FRAMES_FOUND || GSC_OUT_OF_MEMORY
+	GlmSimulationCacheStatus glmCreateDeferredFrameData(GlmSimulationData* simulationDataIn, GlmFrameData* frameDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmDeferredFrameData** deferredFrameData, int currentFrame, const char * filePathModel, const char * cacheDirectory);
+
+	// world bones of entity entityIndex (index in simulationDataOut), computed for deferred entities. arrays size = bone count of the entity type
+	void glmGetDeferredEntityBones(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, float(*bonePositions)[3], float(*boneOrientations)[4]);
+
+	// world root bone of entity entityIndex, without computing the other bones
+	void glmGetDeferredEntityRootBone(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, float bonePosition[3], float boneOrientation[4]);
+
+	// frame holding the other data of entity entityIndex (sns, blind data, geo behavior, pp attributes), returned with its simulation data and the entity index in it.
+	// Bones of the returned frame are only valid for non deferred entities
+	const GlmFrameData* glmGetDeferredEntityFrameData(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, const GlmSimulationData** simulationData, unsigned int* indexInFrame);
+
+	// create the full frame, same result as glmCreateModifiedFrameData. simulationDataOut from glmCreateModifiedSimulationData
+	void glmMaterializeDeferredFrameData(const GlmDeferredFrameData* deferredFrameData, const GlmSimulationData* simulationDataOut, GlmFrameData** frameDataOut);
+
+	// deallocate *deferredFrameData and set it to NULL
+	void glmDestroyDeferredFrameData(GlmDeferredFrameData** deferredFrameData);
+
+	// bone interpolation modes
+	typedef enum
+	{
+		GSC_INTERPOLATION_STRICT, // bit exact with the scalar interpolation
+		GSC_INTERPOLATION_FAST, // approximated quaternion normalization (relative error < 1e-6)
+	} GlmInterpolationMode;
+
+	// interpolate bones [firstBoneValue, lastBoneValue) of frames, in GlmFrameData bone order. Distinct ranges can be processed by different threads
+	void glmInterpolateFrameDataBones(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode);
+
+	// instruction sets of the frame kernels : bone interpolation, bone and cloth vertex transforms, bone and cloth vertex decoding
+	typedef enum
+	{
+		GSC_SIMD_SCALAR,
+		GSC_SIMD_SSE2,
+		GSC_SIMD_AVX2,
+	} GlmSimdLevel;
+
+	// select the frame kernels of the best level supported by the CPU, or of the GLMC_SIMD_LEVEL environment variable level when set
+	// ("scalar", "sse2" or "avx2", for testing and benchmarking). To be called once at startup, before any frame is read. Return the selected level
+	GlmSimdLevel glmInitSimdDispatch(void);
+
+	// select the frame kernels of level, lowered to what the CPU and the build support. Return the selected level
+	GlmSimdLevel glmSetSimdLevel(GlmSimdLevel level);
+
+	// level of the frame kernels, GSC_SIMD_SSE2 (GSC_SIMD_SCALAR with GLMC_NO_SSE) until glmInitSimdDispatch or glmSetSimdLevel
+	GlmSimdLevel glmGetSimdLevel(void);
+
+	// frustum test of the boxes [first, last) given in structure of arrays (centers[axis][i], half extents[axis][i]) against planes (nx, ny, nz, d),
+	// inside when n.p + d >= 0. outside[i - first] = 1 when the box is fully behind one of the planes. Same results at every GlmSimdLevel
+	void glmCullBoxes(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside);
+
+	// glmInterpolateFrameData without the bones : sns, geometry behaviors, blind data, pp attributes and cloth
+	void glmInterpolateFrameDataAttributes(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result);
+
+	// allocate *frameDataSoA for the bones of simulationData, *frameDataSoA is NULL if an allocation failed
+	void glmCreateFrameDataSoA(GlmFrameDataSoA** frameDataSoA, const GlmSimulationData* simulationData);
+
+	// deallocate *frameDataSoA and set it to NULL
+	void glmDestroyFrameDataSoA(GlmFrameDataSoA** frameDataSoA);
+
+	// copy bone positions / orientations between a GlmFrameData and a GlmFrameDataSoA created for the same simulationData
+	void glmConvertFrameDataToSoA(const GlmFrameData* frameData, GlmFrameDataSoA* frameDataSoA);
+	void glmConvertFrameDataFromSoA(const GlmFrameDataSoA* frameDataSoA, GlmFrameData* frameData);
+
+	// same as glmInterpolateFrameData for bones only, frames must be created for the same simulationData
+	void glmInterpolateFrameDataSoA(const GlmFrameDataSoA* frameData1, const GlmFrameDataSoA* frameData2, float ratio, GlmFrameDataSoA* result);
+
 	uint32_t getClothEntityMeshCount(const GlmFrameData* frameData, int clothEntityIndex);
 	uint32_t getClothEntityIMeshVertexCount(const GlmFrameData* frameData, int clothEntityIndex, int iMesh); // a clothEntity has "meshCount" meshes. Get each of its index in all cloth entities meshes cache via this.
 	void getClothEntityIMeshVerticesPtr(const GlmFrameData* frameData, int clothEntityIndex, int iMesh, float(**outFirstVertexPtr)[3]); // a clothEntity has "meshCount" meshes. Get each of its index in all cloth entities meshes cache via this.
 
+	// quaternions are xyzw. r = a * b : rotates by b then by a
+	void glmMultQuaternion(const float *a, const float *b, float *r);
+
+	// r = pos rotated by the unit quaternion rot
+	void glmMultVec3Quaternion(const float *rot, const float *pos, float *r);
+
+	// result = 4x4 matrix (row vector convention, translation in result[12..14]) rotating by rotation then translating by translation
+	void glmConvertMatrix(float* result, const float *translation, const float *rotation);
+
 	// compression interface (usde in crowd_io)
 	extern void glmFileWrite(const void* data, unsigned long elementSize, unsigned long count, FILE* fp);
 	extern void glmFileWriteUInt16(const uint16_t* data, unsigned int count, FILE* fp);
@@ -550,8 +824,23 @@ extern "C"
 	extern void glmFileReadUInt32(uint32_t* data, unsigned int count, FILE* fp);
 	extern void glmFileReadUInt64(uint64_t* data, unsigned int count, FILE* fp);
 
+	// frame bones and cloth vertices decoding from a .gscf file, for any format
+	extern void glmFileReadOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp, GlmSimulationCacheFormat format);
+	extern void glmFileReadPositions(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp, GlmSimulationCacheFormat format);
+	extern void glmFileReadClothVertices(GlmFrameData* frameData, FILE* fp, GlmSimulationCacheFormat format);
+
 #ifdef __cplusplus
 }
+
+// C++ front end : frame decoders of one GlmSimulationCacheFormat known at compile time. Instantiated for the six formats,
+// glmFileReadOrientations / glmFileReadPositions / glmFileReadClothVertices dispatch to them through glmFrameDecoders in C++ builds
+template <GlmSimulationCacheFormat format>
+struct GlmFrameDecoder
+{
+	static void readOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp);
+	static void readPositions(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp);
+	static void readClothVertices(GlmFrameData* frameData, FILE* fp);
+};
 #endif
 
 //
@@ -638,6 +927,27 @@ extern "C"
 #define GLMC_FREE(p)       free(p)
 #endif
 
+#if !defined(GLMC_NO_SSE) && (defined(_M_X64) || defined(__SSE2__))
+#ifndef GLMC_USE_SSE
+#define GLMC_USE_SSE
+#endif
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are built next to the SSE2 ones whatever the compiler target, and only selected on CPUs supporting them
+#if defined(GLMC_USE_SSE) && !defined(GLMC_NO_AVX2) && (defined(_MSC_VER) || defined(__GNUC__))
+#ifndef GLMC_USE_AVX2
+#define GLMC_USE_AVX2
+#endif
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GLMC_TARGET_AVX2
+#else
+#define GLMC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 #define GLMC_EPSILON 0.001f
 #define GLMC_PI 3.14159265358979323846f
 #define GLMC_PI_DIV_2 1.57079632679489661923f
@@ -645,6 +955,109 @@ extern "C"
 
 int(*glmRaycastClosest)(void *terrain, const float* rayOrigin, const float* rayEnd, float *collisionPoint, float *collisionNormal, float *proxyMatrix, float *proxyMatrixInverse) = NULL;
 void(*glmTerrainSetFrame)(void *terrainSource, void *terrainDestination, int frame) = NULL;
+void(*glmParallelFor)(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count) = NULL;
+
+//----------------------------------------------------------------------------
+// frame kernels, one variant per GlmSimdLevel, called through glmSimdKernels. A variant processes what it can and hands the tail
+// of the range to the level below, all variants give the same results (except GSC_INTERPOLATION_FAST normalization)
+static void glmUncompressPositions48Scalar(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3]);
+static void glmTransformClothVerticesScalar(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3]);
+static void glmTransformPointsScalar(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count);
+static void glmMultQuaternionsScalar(const float *a, const float(*b)[4], float(*r)[4], unsigned int count);
+static void glmNormalizeQuaternionsScalar(float(*r)[4], unsigned int count);
+static void glmMultVec3QuaternionsScalar(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count);
+static void glmInterpolateFrameDataBonesScalar(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode);
+static void glmCullBoxesScalar(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside);
+#ifdef GLMC_USE_SSE
+static void glmUncompressPositions48Sse2(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3]);
+static void glmTransformClothVerticesSse2(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3]);
+static void glmTransformPointsSse2(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count);
+static void glmMultQuaternionsSse2(const float *a, const float(*b)[4], float(*r)[4], unsigned int count);
+static void glmNormalizeQuaternionsSse2(float(*r)[4], unsigned int count);
+static void glmMultVec3QuaternionsSse2(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count);
+static void glmInterpolateFrameDataBonesSse2(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode);
+static void glmCullBoxesSse2(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside);
+
+//-------------------------------------------------------------------------
+static void glmCullBoxesSse2(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside)
+{
+	unsigned int i = first;
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(centers[0] + i);
+		__m128 cy = _mm_loadu_ps(centers[1] + i);
+		__m128 cz = _mm_loadu_ps(centers[2] + i);
+		__m128 ex = _mm_loadu_ps(extents[0] + i);
+		__m128 ey = _mm_loadu_ps(extents[1] + i);
+		__m128 ez = _mm_loadu_ps(extents[2] + i);
+		__m128 isOutside = _mm_setzero_ps();
+		int iPlane, mask, k;
+		for (iPlane = 0; iPlane < 6; iPlane++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[iPlane][0])), _mm_mul_ps(cy, _mm_set1_ps(planes[iPlane][1]))),
+				_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[iPlane][2])), _mm_set1_ps(planes[iPlane][3])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(fabsf(planes[iPlane][0]))), _mm_mul_ps(ey, _mm_set1_ps(fabsf(planes[iPlane][1])))),
+				_mm_mul_ps(ez, _mm_set1_ps(fabsf(planes[iPlane][2]))));
+			isOutside = _mm_or_ps(isOutside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+		mask = _mm_movemask_ps(isOutside);
+		for (k = 0; k < 4; k++)
+			outside[i - first + k] = (uint8_t)((mask >> k) & 1);
+	}
+	glmCullBoxesScalar(centers, extents, i, last, planes, outside + (i - first));
+}
+#endif
+#ifdef GLMC_USE_AVX2
+GLMC_TARGET_AVX2 static void glmUncompressPositions48Avx2(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3]);
+GLMC_TARGET_AVX2 static void glmTransformClothVerticesAvx2(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3]);
+GLMC_TARGET_AVX2 static void glmTransformPointsAvx2(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count);
+GLMC_TARGET_AVX2 static void glmMultQuaternionsAvx2(const float *a, const float(*b)[4], float(*r)[4], unsigned int count);
+GLMC_TARGET_AVX2 static void glmNormalizeQuaternionsAvx2(float(*r)[4], unsigned int count);
+GLMC_TARGET_AVX2 static void glmMultVec3QuaternionsAvx2(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count);
+GLMC_TARGET_AVX2 static void glmInterpolateFrameDataBonesAvx2(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode);
+GLMC_TARGET_AVX2 static void glmCullBoxesAvx2(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside);
+#endif
+
+typedef struct GlmSimdKernels
+{
+	GlmSimdLevel _level;
+	void(*_uncompressPositions48)(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3]);
+	void(*_transformClothVertices)(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3]);
+	void(*_transformPoints)(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count);
+	void(*_multQuaternions)(const float *a, const float(*b)[4], float(*r)[4], unsigned int count);
+	void(*_normalizeQuaternions)(float(*r)[4], unsigned int count);
+	void(*_multVec3Quaternions)(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count);
+	void(*_interpolateFrameDataBones)(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode);
+	void(*_cullBoxes)(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside);
+} GlmSimdKernels;
+
+static const GlmSimdKernels glmSimdKernelsScalar = { GSC_SIMD_SCALAR, glmUncompressPositions48Scalar, glmTransformClothVerticesScalar, glmTransformPointsScalar,
+	glmMultQuaternionsScalar, glmNormalizeQuaternionsScalar, glmMultVec3QuaternionsScalar, glmInterpolateFrameDataBonesScalar, glmCullBoxesScalar };
+#ifdef GLMC_USE_SSE
+static const GlmSimdKernels glmSimdKernelsSse2 = { GSC_SIMD_SSE2, glmUncompressPositions48Sse2, glmTransformClothVerticesSse2, glmTransformPointsSse2,
+	glmMultQuaternionsSse2, glmNormalizeQuaternionsSse2, glmMultVec3QuaternionsSse2, glmInterpolateFrameDataBonesSse2, glmCullBoxesSse2 };
+#endif
+#ifdef GLMC_USE_AVX2
+static const GlmSimdKernels glmSimdKernelsAvx2 = { GSC_SIMD_AVX2, glmUncompressPositions48Avx2, glmTransformClothVerticesAvx2, glmTransformPointsAvx2,
+	glmMultQuaternionsAvx2, glmNormalizeQuaternionsAvx2, glmMultVec3QuaternionsAvx2, glmInterpolateFrameDataBonesAvx2, glmCullBoxesAvx2 };
+#endif
+
+#ifdef GLMC_USE_SSE
+static const GlmSimdKernels* glmSimdKernels = &glmSimdKernelsSse2;
+#else
+static const GlmSimdKernels* glmSimdKernels = &glmSimdKernelsScalar;
+#endif
+
+//----------------------------------------------------------------------------
+static void glmRunParallelFor(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	if (count == 0)
+		return;
+	if (glmParallelFor && count > 1)
+		glmParallelFor(task, userData, count);
+	else
+		task(userData, 0, count);
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -689,6 +1102,14 @@ static void glmCumulativeHash32(uint32_t valueToHash, uint32_t* currentHashValue
 	glmCumulativeHash8(valueToHash >> 24, currentHashValue);
 }
 
+static void glmCumulativeHashBytes(const void* valuesToHash, size_t size, uint32_t* currentHashValue)
+{
+	const uint8_t* bytes = (const uint8_t*)valuesToHash;
+	size_t i;
+	for (i = 0; i < size; i++)
+		glmCumulativeHash8(bytes[i], currentHashValue);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Endian
@@ -757,7 +1178,7 @@ static uint64_t glmSwapByteOrder64(uint64_t value)
 #define GLMC_COMPRESSED_QUATERNION32_COMPONENT_0 0x00000ffcUL
 #define GLMC_COMPRESSED_QUATERNION32_BIT_SHIFT 10U
 
-#define GLMC_COMPRESSED_QUATERNION64_COMPONENT_0 0x00000000003fffcULL
+#define GLMC_COMPRESSED_QUATERNION64_COMPONENT_0 0x00000000003ffffcULL
 #define GLMC_COMPRESSED_QUATERNION64_BIT_SHIFT 20U
 
 // map a floating-point value to an interval, during the encoding process the 
@@ -952,12 +1373,81 @@ static void glmCompressPosition48(uint16_t outputPosition[3], float inputPositio
 	outputPosition[2] = (uint16_t)component;
 }
 
-static void glmUncompressPosition48(float outputPosition[3], uint16_t inputPosition[3], float max)
+// 48bit positions (glmCompressPosition48) + reference offset on a contiguous range (cloth vertices, child bones), same operations as the per position path
+static void glmUncompressPositions48Scalar(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3])
+{
+	float min = -max;
+	float range = max - min;
+	float intervalSize = 1.0f / (float)((1u << 16u) - 1u);
+	uint32_t iVertex;
+	unsigned int iComp;
+
+	for (iVertex = 0; iVertex < vertexCount; iVertex++)
+	{
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			outputVertices[iVertex][iComp] = min + (((float)inputVertices[iVertex][iComp] * intervalSize) * range);
+			outputVertices[iVertex][iComp] += reference[iComp];
+		}
+	}
+}
+
+#ifdef GLMC_USE_SSE
+// 4 vertices = 12 floats = 3 registers, component pattern xyzx yzxy zxyz
+static void glmUncompressPositions48Sse2(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3])
+{
+	float min = -max;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 minV = _mm_set1_ps(min);
+	const __m128 rangeV = _mm_set1_ps(max - min);
+	const __m128 intervalV = _mm_set1_ps(1.0f / (float)((1u << 16u) - 1u));
+	const __m128 reference0 = _mm_setr_ps(reference[0], reference[1], reference[2], reference[0]);
+	const __m128 reference1 = _mm_setr_ps(reference[1], reference[2], reference[0], reference[1]);
+	const __m128 reference2 = _mm_setr_ps(reference[2], reference[0], reference[1], reference[2]);
+	uint32_t iVertex = 0;
+
+	for (; iVertex + 4 <= vertexCount; iVertex += 4)
+	{
+		const uint16_t* input = inputVertices[iVertex];
+		float* output = outputVertices[iVertex];
+		__m128 q0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)input), zero));
+		__m128 q1 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(input + 4)), zero));
+		__m128 q2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(input + 8)), zero));
+		_mm_storeu_ps(output, _mm_add_ps(_mm_add_ps(minV, _mm_mul_ps(_mm_mul_ps(q0, intervalV), rangeV)), reference0));
+		_mm_storeu_ps(output + 4, _mm_add_ps(_mm_add_ps(minV, _mm_mul_ps(_mm_mul_ps(q1, intervalV), rangeV)), reference1));
+		_mm_storeu_ps(output + 8, _mm_add_ps(_mm_add_ps(minV, _mm_mul_ps(_mm_mul_ps(q2, intervalV), rangeV)), reference2));
+	}
+	glmUncompressPositions48Scalar(outputVertices + iVertex, inputVertices + iVertex, vertexCount - iVertex, max, reference);
+}
+#endif
+
+#ifdef GLMC_USE_AVX2
+// 8 vertices = 24 floats = 3 registers, component pattern xyzxyzxy zxyzxyzx yzxyzxyz
+GLMC_TARGET_AVX2 static void glmUncompressPositions48Avx2(float(*outputVertices)[3], const uint16_t(*inputVertices)[3], uint32_t vertexCount, float max, const float reference[3])
 {
-	glmUncompressFloatRL(&outputPosition[0], (uint32_t)inputPosition[0], -max, max, 16u);
-	glmUncompressFloatRL(&outputPosition[1], (uint32_t)inputPosition[1], -max, max, 16u);
-	glmUncompressFloatRL(&outputPosition[2], (uint32_t)inputPosition[2], -max, max, 16u);
+	float min = -max;
+	const __m256 minV = _mm256_set1_ps(min);
+	const __m256 rangeV = _mm256_set1_ps(max - min);
+	const __m256 intervalV = _mm256_set1_ps(1.0f / (float)((1u << 16u) - 1u));
+	const __m256 reference0 = _mm256_setr_ps(reference[0], reference[1], reference[2], reference[0], reference[1], reference[2], reference[0], reference[1]);
+	const __m256 reference1 = _mm256_setr_ps(reference[2], reference[0], reference[1], reference[2], reference[0], reference[1], reference[2], reference[0]);
+	const __m256 reference2 = _mm256_setr_ps(reference[1], reference[2], reference[0], reference[1], reference[2], reference[0], reference[1], reference[2]);
+	uint32_t iVertex = 0;
+
+	for (; iVertex + 8 <= vertexCount; iVertex += 8)
+	{
+		const uint16_t* input = inputVertices[iVertex];
+		float* output = outputVertices[iVertex];
+		__m256 q0 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)input)));
+		__m256 q1 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(input + 8))));
+		__m256 q2 = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(input + 16))));
+		_mm256_storeu_ps(output, _mm256_add_ps(_mm256_add_ps(minV, _mm256_mul_ps(_mm256_mul_ps(q0, intervalV), rangeV)), reference0));
+		_mm256_storeu_ps(output + 8, _mm256_add_ps(_mm256_add_ps(minV, _mm256_mul_ps(_mm256_mul_ps(q1, intervalV), rangeV)), reference1));
+		_mm256_storeu_ps(output + 16, _mm256_add_ps(_mm256_add_ps(minV, _mm256_mul_ps(_mm256_mul_ps(q2, intervalV), rangeV)), reference2));
+	}
+	glmUncompressPositions48Sse2(outputVertices + iVertex, inputVertices + iVertex, vertexCount - iVertex, max, reference);
 }
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -1146,6 +1636,7 @@ void glmFileWriteUInt64(const uint64_t* data, unsigned int count, FILE* fp)
 #define GSC_VERSION 0x02
 #define GSCS_MAGIC_NUMBER 0x65C5
 #define GSCF_MAGIC_NUMBER 0x65CF
+#define GSCF_BLOCKS_MAGIC_NUMBER 0x65CB // chunked .gscf, see glmWriteFrameDataBlocks
 #define GSCL_MAGIC_NUMBER 0xB00F
 
 const char golaemFrameExtension[] = "gscf"; // need to be declared lowercase for comparison
@@ -1174,6 +1665,8 @@ const char* glmConvertSimulationCacheStatus(GlmSimulationCacheStatus status)
 		return "Golaem simulation cache: used Golaem Simulation Cache simulation file does not match this frame file";
 	case GSC_SIMULATION_NO_FRAMES_FOUND:
 		return "Golaem simulation cache: unable to find and open a valid Simulation Cache Frame";
+	case GSC_OUT_OF_MEMORY:
+		return "Golaem simulation cache: out of memory";
 	default:
 		return "Golaem simulation cache: unkown error code";
 	}
@@ -1198,6 +1691,8 @@ void glmCreateSimulationData(
 	// entity
 	*simulationData = (GlmSimulationData*)GLMC_MALLOC(sizeof(GlmSimulationData));
 	data = *simulationData;
+	if (data == NULL)
+		return;
 
 	// entity
 	data->_entityCount = entityCount;
@@ -1613,146 +2108,270 @@ void glmCreateFrameData(GlmFrameData** frameData, const GlmSimulationData* simul
 }
 
 //----------------------------------------------------------------------------
-void glmFileReadOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp, GlmSimulationCacheFormat format)
+// orientations quantized on 32bit
+static void glmReadOrientations32(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp)
 {
-	switch (format)
+	unsigned int i;
+	uint32_t* compressedBoneOrientations = (uint32_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint32_t));
+	glmFileReadUInt32(compressedBoneOrientations, totalBoneCount, fp);
+	for (i = 0; i < totalBoneCount; ++i)
 	{
-	case GSC_O32_P48:
-	case GSC_O32_P96:
+		glmUncompressQuaternion32(bonesOrientations[i], compressedBoneOrientations[i]);
+	}
+	GLMC_FREE(compressedBoneOrientations);
+}
+
+//----------------------------------------------------------------------------
+// orientations quantized on 64bit
+static void glmReadOrientations64(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp)
+{
+	unsigned int i;
+	uint64_t* compressedBoneOrientations = (uint64_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint64_t));
+	glmFileReadUInt64(compressedBoneOrientations, totalBoneCount, fp);
+	for (i = 0; i < totalBoneCount; ++i)
 	{
-		unsigned int i;
-		uint32_t* compressedBoneOrientations = (uint32_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint32_t));
-		glmFileReadUInt32(compressedBoneOrientations, totalBoneCount, fp);
-		for (i = 0; i < totalBoneCount; ++i)
+		glmUncompressQuaternion64(bonesOrientations[i], compressedBoneOrientations[i]);
+	}
+	GLMC_FREE(compressedBoneOrientations);
+}
+
+//----------------------------------------------------------------------------
+// orientations not quantized
+static void glmReadOrientations128(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp)
+{
+	glmFileRead(bonesOrientations, sizeof(float), totalBoneCount * 4, fp);
+}
+
+//----------------------------------------------------------------------------
+// root bones positions not quantized, child bones positions quantized on 48bit relative to their root. Roots and children are
+// decoded in separate passes, children of an entity as one contiguous range
+static void glmReadPositions48(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp)
+{
+	unsigned int iEntityType;
+	unsigned int iRootBone = 0;
+	float(*rootBonePositions)[3];
+	uint16_t(*compressedBonePositions)[3];
+
+	uint32_t validEntityCount = 0;
+	for (iEntityType = 0; iEntityType < data->_entityTypeCount; ++iEntityType)
+	{
+		validEntityCount += data->_entityCountPerEntityType[iEntityType];
+	}
+
+	rootBonePositions = (float(*)[3])GLMC_MALLOC(validEntityCount * sizeof(float[3]));
+	compressedBonePositions = (uint16_t(*)[3])GLMC_MALLOC((totalBoneCount - validEntityCount) * sizeof(uint16_t[3]));
+	glmFileRead(rootBonePositions, sizeof(float), validEntityCount * 3, fp);
+	glmFileReadUInt16(compressedBonePositions[0], (totalBoneCount - validEntityCount) * 3, fp);
+
+	// roots
+	for (iEntityType = 0; iEntityType < data->_entityTypeCount; ++iEntityType)
+	{
+		unsigned int iEntity;
+		for (iEntity = 0; iEntity < data->_entityCountPerEntityType[iEntityType]; ++iEntity)
 		{
-			glmUncompressQuaternion32(bonesOrientations[i], compressedBoneOrientations[i]);
+			unsigned int iBoneOffset = data->_iBoneOffsetPerEntityType[iEntityType] + iEntity * data->_boneCount[iEntityType];
+			memcpy(bonesPositions[iBoneOffset], rootBonePositions[iRootBone], sizeof(float[3]));
+			++iRootBone;
 		}
-		GLMC_FREE(compressedBoneOrientations);
 	}
-	break;
-	case GSC_O64_P48:
-	case GSC_O64_P96:
+
+	// children, compressed positions skip the roots
+	iRootBone = 0;
+	for (iEntityType = 0; iEntityType < data->_entityTypeCount; ++iEntityType)
 	{
-		unsigned int i;
-		uint64_t* compressedBoneOrientations = (uint64_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint64_t));
-		glmFileReadUInt64(compressedBoneOrientations, totalBoneCount, fp);
-		for (i = 0; i < totalBoneCount; ++i)
+		unsigned int iEntity;
+		unsigned int childCount = data->_boneCount[iEntityType] > 1 ? data->_boneCount[iEntityType] - 1u : 0u;
+		float maxExtent = data->_maxBonesHierarchyLength[iEntityType];
+		for (iEntity = 0; iEntity < data->_entityCountPerEntityType[iEntityType]; ++iEntity)
 		{
-			glmUncompressQuaternion64(bonesOrientations[i], compressedBoneOrientations[i]);
+			unsigned int iBoneOffset = data->_iBoneOffsetPerEntityType[iEntityType] + iEntity * data->_boneCount[iEntityType];
+			glmSimdKernels->_uncompressPositions48(bonesPositions + iBoneOffset + 1, (const uint16_t(*)[3])(compressedBonePositions + iBoneOffset - iRootBone), childCount, maxExtent, rootBonePositions[iRootBone]);
+			++iRootBone;
 		}
-		GLMC_FREE(compressedBoneOrientations);
-	}
-	break;
-	default:
-		glmFileRead(bonesOrientations, sizeof(float), totalBoneCount * 4, fp);
 	}
+	GLMC_FREE(compressedBonePositions);
+	GLMC_FREE(rootBonePositions);
 }
 
 //----------------------------------------------------------------------------
-void glmFileReadPositions(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp, GlmSimulationCacheFormat format)
+// positions not quantized
+static void glmReadPositions96(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp)
 {
-	switch (format)
-	{
-	case GSC_O32_P48:
-	case GSC_O64_P48:
-	case GSC_O128_P48:
+	(void)data;
+	glmFileRead(bonesPositions, sizeof(float), totalBoneCount * 3, fp);
+}
+
+//----------------------------------------------------------------------------
+typedef struct GlmClothDecodeTask
+{
+	GlmFrameData* _frameData;
+	uint16_t(*_compressedVertices)[3];
+	uint32_t* _firstVertex; // _clothEntityCount + 1 offsets
+} GlmClothDecodeTask;
+
+//----------------------------------------------------------------------------
+static void glmDecodeClothEntities(void* userData, unsigned int firstClothEntity, unsigned int lastClothEntity)
+{
+	GlmClothDecodeTask* task = (GlmClothDecodeTask*)userData;
+	GlmFrameData* frameData = task->_frameData;
+	unsigned int iClothEntity;
+
+	// cloth max extent and reference must be read priori to calling this function
+	for (iClothEntity = firstClothEntity; iClothEntity < lastClothEntity; iClothEntity++)
 	{
-		unsigned int iEntityType;
-		unsigned int iRootBone = 0;
-		float localPosition[3];
-		float(*rootBonePositions)[3];
-		uint16_t(*compressedBonePositions)[3];
+		uint32_t firstVertex = task->_firstVertex[iClothEntity];
+		glmSimdKernels->_uncompressPositions48(frameData->_clothVertices + firstVertex, (const uint16_t(*)[3])(task->_compressedVertices + firstVertex),
+			task->_firstVertex[iClothEntity + 1] - firstVertex,
+			frameData->_clothEntityQuantizationMaxExtent[iClothEntity], frameData->_clothEntityQuantizationReference[iClothEntity]);
+	}
+}
 
-		uint32_t validEntityCount = 0;
-		for (iEntityType = 0; iEntityType < data->_entityTypeCount; ++iEntityType)
-		{
-			validEntityCount += data->_entityCountPerEntityType[iEntityType];
-		}
+//----------------------------------------------------------------------------
+// cloth vertices quantized on 48bit relative to the cloth entity reference
+static void glmReadClothVertices48(GlmFrameData* frameData, FILE* fp)
+{
+	unsigned int iClothEntityMesh = 0;
+	unsigned int iAbsoluteClothMesh = 0;
+	unsigned int iClothEntity = 0;
+	GlmClothDecodeTask task;
 
-		rootBonePositions = (float(*)[3])GLMC_MALLOC(validEntityCount * sizeof(float[3]));
-		compressedBonePositions = (uint16_t(*)[3])GLMC_MALLOC((totalBoneCount - validEntityCount) * sizeof(uint16_t[3]));
-		glmFileRead(rootBonePositions, sizeof(float), validEntityCount * 3, fp);
-		glmFileReadUInt16(compressedBonePositions[0], (totalBoneCount - validEntityCount) * 3, fp);
-		for (iEntityType = 0; iEntityType < data->_entityTypeCount; ++iEntityType)
+	task._frameData = frameData;
+	task._compressedVertices = (uint16_t(*)[3])GLMC_MALLOC(frameData->_clothTotalVertices * sizeof(uint16_t[3]));
+	task._firstVertex = (uint32_t*)GLMC_MALLOC((frameData->_clothEntityCount + 1) * sizeof(uint32_t));
+
+	glmFileReadUInt16(task._compressedVertices[0], frameData->_clothTotalVertices * 3, fp);
+
+	// vertex ranges per cloth entity, entities are then decoded independently
+	task._firstVertex[0] = 0;
+	for (iClothEntity = 0; iClothEntity < frameData->_clothEntityCount; iClothEntity++)
+	{
+		task._firstVertex[iClothEntity + 1] = task._firstVertex[iClothEntity];
+		for (iClothEntityMesh = 0; iClothEntityMesh < frameData->_clothEntityMeshCount[iClothEntity]; iClothEntityMesh++)
 		{
-			unsigned int iEntity;
-			for (iEntity = 0; iEntity < data->_entityCountPerEntityType[iEntityType]; ++iEntity)
-			{
-				unsigned int iBone;
-				unsigned int iBoneOffset = data->_iBoneOffsetPerEntityType[iEntityType] + iEntity * data->_boneCount[iEntityType];
-				memcpy(bonesPositions[iBoneOffset], rootBonePositions[iRootBone], sizeof(float[3]));
-				++iRootBone;
-				for (iBone = 1; iBone < data->_boneCount[iEntityType]; ++iBone)
-				{
-					unsigned int i = iBone + iBoneOffset;
-					glmUncompressPosition48(localPosition, compressedBonePositions[i - iRootBone], data->_maxBonesHierarchyLength[iEntityType]);
-					bonesPositions[i][0] = localPosition[0] + rootBonePositions[iRootBone - 1][0];
-					bonesPositions[i][1] = localPosition[1] + rootBonePositions[iRootBone - 1][1];
-					bonesPositions[i][2] = localPosition[2] + rootBonePositions[iRootBone - 1][2];
-				}
-			}
+			task._firstVertex[iClothEntity + 1] += frameData->_clothMeshVertexCount[iAbsoluteClothMesh];
+			iAbsoluteClothMesh++;
 		}
-		GLMC_FREE(compressedBonePositions);
-		GLMC_FREE(rootBonePositions);
-	}
-	break;
-	default:
-		glmFileRead(bonesPositions, sizeof(float), totalBoneCount * 3, fp);
 	}
+
+	glmRunParallelFor(glmDecodeClothEntities, &task, frameData->_clothEntityCount);
+
+	GLMC_FREE(task._firstVertex);
+	GLMC_FREE(task._compressedVertices);
 }
 
 //----------------------------------------------------------------------------
-void glmFileReadClothVertices(GlmFrameData* frameData, FILE* fp, GlmSimulationCacheFormat format)
+// cloth vertices not quantized
+static void glmReadClothVertices96(GlmFrameData* frameData, FILE* fp)
 {
-	switch (format)
-	{
-	case GSC_O32_P48:
-	case GSC_O64_P48:
-	case GSC_O128_P48:
-	{
-		unsigned int iClothEntityMesh = 0;
-		unsigned int iClothVertex = 0;
-		float * vertex = NULL;
+	glmFileRead(frameData->_clothVertices, sizeof(float), frameData->_clothTotalVertices * 3, fp);
+}
 
-		int iAbsoluteMeshVertex = 0;
-		int iAbsoluteClothMesh = 0;
-		unsigned int iClothEntity = 0;
-		uint16_t(*compressedClothVertices)[3] = (uint16_t(*)[3])GLMC_MALLOC(frameData->_clothTotalVertices * sizeof(uint16_t[3]));
+#ifdef __cplusplus
+//----------------------------------------------------------------------------
+// orientation and position encodings of the formats
+template <GlmSimulationCacheFormat format> struct GlmCacheFormatEncoding;
+template <> struct GlmCacheFormatEncoding<GSC_O128_P96> { enum { _orientationBits = 128, _positionBits = 96 }; };
+template <> struct GlmCacheFormatEncoding<GSC_O64_P96> { enum { _orientationBits = 64, _positionBits = 96 }; };
+template <> struct GlmCacheFormatEncoding<GSC_O32_P96> { enum { _orientationBits = 32, _positionBits = 96 }; };
+template <> struct GlmCacheFormatEncoding<GSC_O128_P48> { enum { _orientationBits = 128, _positionBits = 48 }; };
+template <> struct GlmCacheFormatEncoding<GSC_O64_P48> { enum { _orientationBits = 64, _positionBits = 48 }; };
+template <> struct GlmCacheFormatEncoding<GSC_O32_P48> { enum { _orientationBits = 32, _positionBits = 48 }; };
+
+template <int orientationBits> struct GlmOrientationDecoder;
+template <> struct GlmOrientationDecoder<128> { static void read(float(*o)[4], unsigned int count, FILE* fp) { glmReadOrientations128(o, count, fp); } };
+template <> struct GlmOrientationDecoder<64> { static void read(float(*o)[4], unsigned int count, FILE* fp) { glmReadOrientations64(o, count, fp); } };
+template <> struct GlmOrientationDecoder<32> { static void read(float(*o)[4], unsigned int count, FILE* fp) { glmReadOrientations32(o, count, fp); } };
+
+template <int positionBits> struct GlmPositionDecoder;
+template <> struct GlmPositionDecoder<96>
+{
+	static void read(float(*p)[3], unsigned int count, const GlmSimulationData* data, FILE* fp) { glmReadPositions96(p, count, data, fp); }
+	static void readClothVertices(GlmFrameData* frameData, FILE* fp) { glmReadClothVertices96(frameData, fp); }
+};
+template <> struct GlmPositionDecoder<48>
+{
+	static void read(float(*p)[3], unsigned int count, const GlmSimulationData* data, FILE* fp) { glmReadPositions48(p, count, data, fp); }
+	static void readClothVertices(GlmFrameData* frameData, FILE* fp) { glmReadClothVertices48(frameData, fp); }
+};
 
-		glmFileReadUInt16(compressedClothVertices[0], frameData->_clothTotalVertices * 3, fp);
+//----------------------------------------------------------------------------
+template <GlmSimulationCacheFormat format>
+void GlmFrameDecoder<format>::readOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp)
+{
+	GlmOrientationDecoder<GlmCacheFormatEncoding<format>::_orientationBits>::read(bonesOrientations, totalBoneCount, fp);
+}
 
-		// iteration per cloth entity:
-		for (iClothEntity = 0; iClothEntity < frameData->_clothEntityCount; iClothEntity++)
-		{
-			// cloth max extent and reference must be read priori to calling this function
-			float *referencePosition = frameData->_clothEntityQuantizationReference[iClothEntity];
-			float maxExtent = frameData->_clothEntityQuantizationMaxExtent[iClothEntity];
+//----------------------------------------------------------------------------
+template <GlmSimulationCacheFormat format>
+void GlmFrameDecoder<format>::readPositions(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp)
+{
+	GlmPositionDecoder<GlmCacheFormatEncoding<format>::_positionBits>::read(bonesPositions, totalBoneCount, data, fp);
+}
 
-			for (iClothEntityMesh = 0; iClothEntityMesh < frameData->_clothEntityMeshCount[iClothEntity]; iClothEntityMesh++)
-			{
-				for (iClothVertex = 0; iClothVertex < frameData->_clothMeshVertexCount[iAbsoluteClothMesh]; iClothVertex++)
-				{
-					vertex = frameData->_clothVertices[iAbsoluteMeshVertex];
+//----------------------------------------------------------------------------
+template <GlmSimulationCacheFormat format>
+void GlmFrameDecoder<format>::readClothVertices(GlmFrameData* frameData, FILE* fp)
+{
+	GlmPositionDecoder<GlmCacheFormatEncoding<format>::_positionBits>::readClothVertices(frameData, fp);
+}
 
-					glmUncompressPosition48(vertex, compressedClothVertices[iAbsoluteMeshVertex], maxExtent);
+template struct GlmFrameDecoder<GSC_O128_P96>;
+template struct GlmFrameDecoder<GSC_O64_P96>;
+template struct GlmFrameDecoder<GSC_O32_P96>;
+template struct GlmFrameDecoder<GSC_O128_P48>;
+template struct GlmFrameDecoder<GSC_O64_P48>;
+template struct GlmFrameDecoder<GSC_O32_P48>;
 
-					vertex[0] += referencePosition[0];
-					vertex[1] += referencePosition[1];
-					vertex[2] += referencePosition[2];
+// the GlmFrameDecoder instantiation of a format
+#define GLMC_FRAME_DECODER(format, orientationBits, positionBits) { GlmFrameDecoder<format>::readOrientations, GlmFrameDecoder<format>::readPositions, GlmFrameDecoder<format>::readClothVertices }
+#else
+#define GLMC_FRAME_DECODER(format, orientationBits, positionBits) { glmReadOrientations##orientationBits, glmReadPositions##positionBits, glmReadClothVertices##positionBits }
+#endif
 
-					iAbsoluteMeshVertex++;
-				}
+//----------------------------------------------------------------------------
+// orientation, position and cloth vertex decoders of a GlmSimulationCacheFormat
+typedef struct GlmFrameDecoderFunctions
+{
+	void(*_readOrientations)(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp);
+	void(*_readPositions)(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp);
+	void(*_readClothVertices)(GlmFrameData* frameData, FILE* fp);
+} GlmFrameDecoderFunctions;
+
+// indexed by GlmSimulationCacheFormat
+static const GlmFrameDecoderFunctions glmFrameDecoders[] = {
+	GLMC_FRAME_DECODER(GSC_O128_P96, 128, 96),
+	GLMC_FRAME_DECODER(GSC_O64_P96, 64, 96),
+	GLMC_FRAME_DECODER(GSC_O32_P96, 32, 96),
+	GLMC_FRAME_DECODER(GSC_O128_P48, 128, 48),
+	GLMC_FRAME_DECODER(GSC_O64_P48, 64, 48),
+	GLMC_FRAME_DECODER(GSC_O32_P48, 32, 48),
+};
 
-				iAbsoluteClothMesh++;
-			}
-		}
+//----------------------------------------------------------------------------
+// unknown formats are read as GSC_O128_P96
+static const GlmFrameDecoderFunctions* glmGetFrameDecoder(GlmSimulationCacheFormat format)
+{
+	if ((unsigned int)format >= sizeof(glmFrameDecoders) / sizeof(glmFrameDecoders[0]))
+		return &glmFrameDecoders[GSC_O128_P96];
+	return &glmFrameDecoders[format];
+}
 
-		GLMC_FREE(compressedClothVertices);
-	}
-	break;
-	default:
-		glmFileRead(frameData->_clothVertices, sizeof(float), frameData->_clothTotalVertices * 3, fp);
-	}
+//----------------------------------------------------------------------------
+void glmFileReadOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp, GlmSimulationCacheFormat format)
+{
+	glmGetFrameDecoder(format)->_readOrientations(bonesOrientations, totalBoneCount, fp);
+}
+
+//----------------------------------------------------------------------------
+void glmFileReadPositions(float(*bonesPositions)[3], unsigned int totalBoneCount, const GlmSimulationData* data, FILE* fp, GlmSimulationCacheFormat format)
+{
+	glmGetFrameDecoder(format)->_readPositions(bonesPositions, totalBoneCount, data, fp);
+}
+
+//----------------------------------------------------------------------------
+void glmFileReadClothVertices(GlmFrameData* frameData, FILE* fp, GlmSimulationCacheFormat format)
+{
+	glmGetFrameDecoder(format)->_readClothVertices(frameData, fp);
 }
 
 //----------------------------------------------------------------------------
@@ -1807,10 +2426,29 @@ void glmCreateClothData(const GlmSimulationData* simuData, GlmFrameData* data, u
 }
 
 //----------------------------------------------------------------------------
-uint64_t glmComputeFrameDataSize(const GlmFrameData* frameData, const GlmSimulationData* simulationData)
+// copy the cloth data of frameDataIn in frameDataOut, entity indices are the same in both frames
+static void glmCopyClothData(const GlmFrameData* frameDataIn, const GlmSimulationData* simuDataOut, GlmFrameData* frameDataOut)
 {
-	unsigned int i;
-	unsigned int totalBoneCount = 0;
+	if (frameDataIn->_clothEntityCount == 0)
+		return;
+
+	glmCreateClothData(simuDataOut, frameDataOut, frameDataIn->_clothEntityCount, frameDataIn->_clothTotalMeshIndices, frameDataIn->_clothTotalVertices);
+	memcpy(frameDataOut->_entityClothIndex, frameDataIn->_entityClothIndex, simuDataOut->_entityCount * sizeof(int32_t));
+	memcpy(frameDataOut->_clothEntityMeshCount, frameDataIn->_clothEntityMeshCount, frameDataIn->_clothEntityCount * sizeof(uint32_t));
+	memcpy(frameDataOut->_clothEntityFirstAssetMeshIndex, frameDataIn->_clothEntityFirstAssetMeshIndex, frameDataIn->_clothEntityCount * sizeof(uint32_t));
+	memcpy(frameDataOut->_clothEntityFirstMeshVertex, frameDataIn->_clothEntityFirstMeshVertex, frameDataIn->_clothEntityCount * sizeof(uint32_t));
+	memcpy(frameDataOut->_clothEntityQuantizationReference, frameDataIn->_clothEntityQuantizationReference, frameDataIn->_clothEntityCount * sizeof(float[3]));
+	memcpy(frameDataOut->_clothEntityQuantizationMaxExtent, frameDataIn->_clothEntityQuantizationMaxExtent, frameDataIn->_clothEntityCount * sizeof(float));
+	memcpy(frameDataOut->_clothMeshIndicesInCharAssets, frameDataIn->_clothMeshIndicesInCharAssets, frameDataIn->_clothTotalMeshIndices * sizeof(uint32_t));
+	memcpy(frameDataOut->_clothMeshVertexCount, frameDataIn->_clothMeshVertexCount, frameDataIn->_clothTotalMeshIndices * sizeof(uint32_t));
+	memcpy(frameDataOut->_clothVertices, frameDataIn->_clothVertices, frameDataIn->_clothTotalVertices * sizeof(float[3]));
+}
+
+//----------------------------------------------------------------------------
+uint64_t glmComputeFrameDataSize(const GlmFrameData* frameData, const GlmSimulationData* simulationData)
+{
+	unsigned int i;
+	unsigned int totalBoneCount = 0;
 	unsigned int totalSnSCount = 0;
 	unsigned int totalBlindDataCount = 0;
 	unsigned int totalGeoBehaviorCount = 0;
@@ -1853,7 +2491,682 @@ uint64_t glmComputeFrameDataSize(const GlmFrameData* frameData, const GlmSimulat
 }
 
 //----------------------------------------------------------------------------
-GlmSimulationCacheStatus glmReadFrameData(GlmFrameData* data, const GlmSimulationData* simulationData, const char* file)
+// allocate the bone payloads of format in a compressed frame
+static void glmCreateCompressedBones(GlmCompressedFrameData* data, unsigned int totalBoneCount, const GlmSimulationData* simulationData, GlmSimulationCacheFormat format)
+{
+	unsigned int iEntityType;
+
+	data->_cacheFormat = (uint8_t)format;
+	data->_boneCount = totalBoneCount;
+	data->_rootBoneCount = 0;
+	data->_iRootBoneOffsetPerEntityType = (uint32_t*)GLMC_MALLOC(simulationData->_entityTypeCount * sizeof(uint32_t));
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; ++iEntityType)
+	{
+		data->_iRootBoneOffsetPerEntityType[iEntityType] = data->_rootBoneCount;
+		data->_rootBoneCount += simulationData->_entityCountPerEntityType[iEntityType];
+	}
+
+	switch (format)
+	{
+	case GSC_O32_P48:
+	case GSC_O64_P48:
+	case GSC_O128_P48:
+		data->_rootBonePositions = (float(*)[3])GLMC_MALLOC(data->_rootBoneCount * sizeof(float[3]));
+		data->_compressedBonePositions = (uint16_t(*)[3])GLMC_MALLOC((totalBoneCount - data->_rootBoneCount) * sizeof(uint16_t[3]));
+		break;
+	default:
+		data->_bonePositions = (float(*)[3])GLMC_MALLOC(totalBoneCount * sizeof(float[3]));
+	}
+
+	switch (format)
+	{
+	case GSC_O32_P48:
+	case GSC_O32_P96:
+		data->_compressedBoneOrientations32 = (uint32_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint32_t));
+		break;
+	case GSC_O64_P48:
+	case GSC_O64_P96:
+		data->_compressedBoneOrientations64 = (uint64_t*)GLMC_MALLOC(totalBoneCount * sizeof(uint64_t));
+		break;
+	default:
+		data->_boneOrientations = (float(*)[4])GLMC_MALLOC(totalBoneCount * sizeof(float[4]));
+	}
+}
+
+//----------------------------------------------------------------------------
+// bone payloads of a .gscf frame, kept in their file encoding in the arrays allocated by glmCreateCompressedBones
+static void glmFileReadCompressedBones(GlmCompressedFrameData* data, FILE* fp)
+{
+	unsigned int totalBoneCount = data->_boneCount;
+
+	switch (data->_cacheFormat)
+	{
+	case GSC_O32_P48:
+	case GSC_O64_P48:
+	case GSC_O128_P48:
+		glmFileRead(data->_rootBonePositions, sizeof(float), data->_rootBoneCount * 3, fp);
+		glmFileReadUInt16(data->_compressedBonePositions[0], (totalBoneCount - data->_rootBoneCount) * 3, fp);
+		break;
+	default:
+		glmFileRead(data->_bonePositions, sizeof(float), totalBoneCount * 3, fp);
+	}
+
+	switch (data->_cacheFormat)
+	{
+	case GSC_O32_P48:
+	case GSC_O32_P96:
+		glmFileReadUInt32(data->_compressedBoneOrientations32, totalBoneCount, fp);
+		break;
+	case GSC_O64_P48:
+	case GSC_O64_P96:
+		glmFileReadUInt64(data->_compressedBoneOrientations64, totalBoneCount, fp);
+		break;
+	default:
+		glmFileRead(data->_boneOrientations, sizeof(float), totalBoneCount * 4, fp);
+	}
+}
+
+//----------------------------------------------------------------------------
+// decode the bones of one entity : boneCount bones from iBoneOffset, the entity root being iRootBone
+static void glmDecodeCompressedBones(const GlmCompressedFrameData* data, const GlmSimulationData* simulationData, unsigned int entityType, unsigned int iBoneOffset, unsigned int iRootBone,
+	unsigned int boneCount, float(*bonePositions)[3], float(*boneOrientations)[4])
+{
+	unsigned int iBone;
+
+	if (data->_compressedBonePositions != NULL)
+	{
+		// children are stored without the roots
+		memcpy(bonePositions[0], data->_rootBonePositions[iRootBone], sizeof(float[3]));
+		glmSimdKernels->_uncompressPositions48(bonePositions + 1, (const uint16_t(*)[3])(data->_compressedBonePositions + iBoneOffset - iRootBone), boneCount > 1 ? boneCount - 1u : 0u,
+			simulationData->_maxBonesHierarchyLength[entityType], data->_rootBonePositions[iRootBone]);
+	}
+	else
+	{
+		memcpy(bonePositions, data->_bonePositions + iBoneOffset, boneCount * sizeof(float[3]));
+	}
+
+	if (data->_compressedBoneOrientations32 != NULL)
+	{
+		for (iBone = 0; iBone < boneCount; ++iBone)
+		{
+			glmUncompressQuaternion32(boneOrientations[iBone], data->_compressedBoneOrientations32[iBoneOffset + iBone]);
+		}
+	}
+	else if (data->_compressedBoneOrientations64 != NULL)
+	{
+		for (iBone = 0; iBone < boneCount; ++iBone)
+		{
+			glmUncompressQuaternion64(boneOrientations[iBone], data->_compressedBoneOrientations64[iBoneOffset + iBone]);
+		}
+	}
+	else
+	{
+		memcpy(boneOrientations, data->_boneOrientations + iBoneOffset, boneCount * sizeof(float[4]));
+	}
+}
+
+//----------------------------------------------------------------------------
+// 64bit file offsets of chunked frame files
+static uint64_t glmFileTell(FILE* fp)
+{
+#ifdef _MSC_VER
+	return (uint64_t)_ftelli64(fp);
+#else
+	return (uint64_t)ftell(fp);
+#endif
+}
+
+//----------------------------------------------------------------------------
+static void glmFileSeek(FILE* fp, uint64_t offset)
+{
+#ifdef _MSC_VER
+	_fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+	fseek(fp, (long)offset, SEEK_SET);
+#endif
+}
+
+//----------------------------------------------------------------------------
+// fp is left at the end of the file
+static uint64_t glmFileSize(FILE* fp)
+{
+#ifdef _MSC_VER
+	_fseeki64(fp, 0, SEEK_END);
+#else
+	fseek(fp, 0, SEEK_END);
+#endif
+	return glmFileTell(fp);
+}
+
+//----------------------------------------------------------------------------
+// blocks of a chunked frame : per entity type, ceil(entity count / entityBlockSize) blocks
+static uint32_t glmComputeEntityBlockCount(const GlmSimulationData* simulationData, unsigned int entityBlockSize)
+{
+	unsigned int iEntityType;
+	uint32_t blockCount = 0;
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; ++iEntityType)
+	{
+		blockCount += (simulationData->_entityCountPerEntityType[iEntityType] + entityBlockSize - 1) / entityBlockSize;
+	}
+	return blockCount;
+}
+
+//----------------------------------------------------------------------------
+// simulation entity indices grouped by entity type, in simulation order within each entity type : the entities of entity type iEntityType are
+// entityIndices[firstEntityPerEntityType[iEntityType]] to entityIndices[firstEntityPerEntityType[iEntityType] + _entityCountPerEntityType[iEntityType] - 1]
+static uint32_t* glmCreateEntityIndicesPerEntityType(const GlmSimulationData* simulationData, uint32_t* firstEntityPerEntityType)
+{
+	unsigned int i;
+	uint32_t entityCount = 0;
+	uint32_t* entityIndices;
+	uint32_t* entityTypeFill = (uint32_t*)GLMC_MALLOC(simulationData->_entityTypeCount * sizeof(uint32_t));
+
+	for (i = 0; i < simulationData->_entityTypeCount; ++i)
+	{
+		firstEntityPerEntityType[i] = entityCount;
+		entityTypeFill[i] = 0;
+		entityCount += simulationData->_entityCountPerEntityType[i];
+	}
+	entityIndices = (uint32_t*)GLMC_MALLOC(entityCount * sizeof(uint32_t));
+	memset(entityIndices, 0, entityCount * sizeof(uint32_t));
+	for (i = 0; i < simulationData->_entityCount; ++i)
+	{
+		uint16_t entityType = simulationData->_entityTypes[i];
+		if ((entityType < simulationData->_entityTypeCount) && (entityTypeFill[entityType] < simulationData->_entityCountPerEntityType[entityType]))
+			entityIndices[firstEntityPerEntityType[entityType] + entityTypeFill[entityType]++] = i;
+	}
+	GLMC_FREE(entityTypeFill);
+	return entityIndices;
+}
+
+//----------------------------------------------------------------------------
+// entities of a block are not contiguous in the frame arrays : the entityElementSize bytes of entity iEntity of the block are at
+// frameArray + frameIndices[iEntity] * entityElementSize
+static void glmScatterBlockElements(void* frameArray, const void* blockArray, size_t entityElementSize, const uint32_t* frameIndices, unsigned int entityCount)
+{
+	unsigned int iEntity;
+	for (iEntity = 0; iEntity < entityCount; ++iEntity)
+	{
+		memcpy((char*)frameArray + frameIndices[iEntity] * entityElementSize, (const char*)blockArray + iEntity * entityElementSize, entityElementSize);
+	}
+}
+
+//----------------------------------------------------------------------------
+// reverse of glmScatterBlockElements
+static void glmGatherBlockElements(void* blockArray, const void* frameArray, size_t entityElementSize, const uint32_t* frameIndices, unsigned int entityCount)
+{
+	unsigned int iEntity;
+	for (iEntity = 0; iEntity < entityCount; ++iEntity)
+	{
+		memcpy((char*)blockArray + iEntity * entityElementSize, (const char*)frameArray + frameIndices[iEntity] * entityElementSize, entityElementSize);
+	}
+}
+
+//----------------------------------------------------------------------------
+// index in entity type of the entities of a block, where their bones, sns, blind data and geo behavior are in the frame
+static uint32_t* glmCreateBlockIndicesInEntityType(const GlmSimulationData* simulationData, const uint32_t* blockEntityIndices, unsigned int entityCount)
+{
+	unsigned int iEntity;
+	uint32_t* indicesInEntityType = (uint32_t*)GLMC_MALLOC(entityCount * sizeof(uint32_t));
+	for (iEntity = 0; iEntity < entityCount; ++iEntity)
+	{
+		indicesInEntityType[iEntity] = simulationData->_indexInEntityType[blockEntityIndices[iEntity]];
+	}
+	return indicesInEntityType;
+}
+
+//----------------------------------------------------------------------------
+// entities to read from a chunked frame
+typedef struct GlmFrameEntitySelection
+{
+	uint32_t _firstEntity; // simulation entity range
+	uint32_t _entityCount;
+	const uint8_t* _entityTypeEnabled; // NULL : all entity types
+} GlmFrameEntitySelection;
+
+//----------------------------------------------------------------------------
+// a block is read when its simulation entity index range [minEntityIndex, maxEntityIndex] intersects the selected range
+static int glmIsEntityBlockSelected(const GlmFrameEntitySelection* selection, unsigned int entityType, uint32_t minEntityIndex, uint32_t maxEntityIndex)
+{
+	if (selection == NULL)
+		return 1;
+	if ((selection->_entityTypeEnabled != NULL) && !selection->_entityTypeEnabled[entityType])
+		return 0;
+	return (selection->_entityCount > 0) && (maxEntityIndex >= selection->_firstEntity)
+		&& ((minEntityIndex < selection->_firstEntity) || (minEntityIndex - selection->_firstEntity < selection->_entityCount));
+}
+
+//----------------------------------------------------------------------------
+// cloth of an entity block, gathered in the frame in entity order once all blocks are read
+typedef struct GlmEntityBlockCloth
+{
+	uint32_t _clothEntityCount;
+	uint32_t _meshCount;
+	uint32_t _vertexCount;
+	uint8_t* _entityUseCloth; // array size = entity count of the block
+	uint32_t* _clothEntityMeshCount; // array size = _clothEntityCount
+	float(*_clothEntityQuantizationReference)[3]; // array size = _clothEntityCount
+	float* _clothEntityQuantizationMaxExtent; // array size = _clothEntityCount
+	uint32_t* _clothEntityFirstMesh; // array size = _clothEntityCount + 1
+	uint32_t* _clothEntityFirstVertex; // array size = _clothEntityCount + 1
+	uint32_t* _clothMeshIndicesInCharAssets; // array size = _meshCount
+	uint32_t* _clothMeshVertexCount; // array size = _meshCount
+	float(*_clothVertices)[3]; // array size = _vertexCount
+} GlmEntityBlockCloth;
+
+//----------------------------------------------------------------------------
+static void glmDestroyEntityBlockCloth(GlmEntityBlockCloth* cloth)
+{
+	GLMC_FREE(cloth->_entityUseCloth);
+	GLMC_FREE(cloth->_clothEntityMeshCount);
+	GLMC_FREE(cloth->_clothEntityQuantizationReference);
+	GLMC_FREE(cloth->_clothEntityQuantizationMaxExtent);
+	GLMC_FREE(cloth->_clothEntityFirstMesh);
+	GLMC_FREE(cloth->_clothEntityFirstVertex);
+	GLMC_FREE(cloth->_clothMeshIndicesInCharAssets);
+	GLMC_FREE(cloth->_clothMeshVertexCount);
+	GLMC_FREE(cloth->_clothVertices);
+}
+
+//----------------------------------------------------------------------------
+// read a block of entityCount entities of entityType written by glmFileWriteEntityBlock, blockEntityIndices are their simulation entity indices.
+// Bones are kept in their file encoding in compressedData when it is not NULL, data bone arrays are not written. Cloth is read in blockCloth
+// return GSC_SUCCESS || GSC_FILE_FORMAT_ERROR when the cloth counts of the block do not match
+static GlmSimulationCacheStatus glmFileReadEntityBlock(GlmFrameData* data, GlmCompressedFrameData* compressedData, const GlmSimulationData* simulationData, const uint32_t* blockEntityIndices,
+	unsigned int entityType, unsigned int entityCount, GlmEntityBlockCloth* blockCloth, FILE* fp, GlmSimulationCacheFormat format)
+{
+	unsigned int i, iEntity;
+	unsigned int boneCount = simulationData->_boneCount[entityType];
+	unsigned int snsCount = simulationData->_snsCountPerEntityType[entityType];
+	unsigned int blindDataCount = simulationData->_blindDataCount[entityType];
+	unsigned int iBoneOffset = simulationData->_iBoneOffsetPerEntityType[entityType];
+	uint32_t* indicesInEntityType = glmCreateBlockIndicesInEntityType(simulationData, blockEntityIndices, entityCount);
+	void* blockValues;
+
+	if (boneCount > 0)
+	{
+		unsigned int blockBoneCount = entityCount * boneCount;
+		switch (format)
+		{
+		case GSC_O32_P48:
+		case GSC_O64_P48:
+		case GSC_O128_P48:
+		{
+			unsigned int childCount = boneCount - 1;
+			float maxExtent = simulationData->_maxBonesHierarchyLength[entityType];
+			float(*rootBonePositions)[3] = (float(*)[3])GLMC_MALLOC(entityCount * sizeof(float[3]));
+			uint16_t(*compressedBonePositions)[3] = (uint16_t(*)[3])GLMC_MALLOC(entityCount * childCount * sizeof(uint16_t[3]));
+			glmFileRead(rootBonePositions, sizeof(float), entityCount * 3, fp);
+			glmFileReadUInt16(compressedBonePositions[0], entityCount * childCount * 3, fp);
+			if (compressedData != NULL)
+			{
+				// children are stored without the roots, see glmDecodeCompressedBones
+				unsigned int iRootBoneOffset = compressedData->_iRootBoneOffsetPerEntityType[entityType];
+				glmScatterBlockElements(compressedData->_rootBonePositions + iRootBoneOffset, rootBonePositions, sizeof(float[3]), indicesInEntityType, entityCount);
+				glmScatterBlockElements(compressedData->_compressedBonePositions + iBoneOffset - iRootBoneOffset, compressedBonePositions, childCount * sizeof(uint16_t[3]), indicesInEntityType, entityCount);
+			}
+			else
+			{
+				for (iEntity = 0; iEntity < entityCount; ++iEntity)
+				{
+					float(*bonePositions)[3] = data->_bonePositions + iBoneOffset + indicesInEntityType[iEntity] * boneCount;
+					memcpy(bonePositions[0], rootBonePositions[iEntity], sizeof(float[3]));
+					glmSimdKernels->_uncompressPositions48(bonePositions + 1, (const uint16_t(*)[3])(compressedBonePositions + iEntity * childCount), childCount, maxExtent, rootBonePositions[iEntity]);
+				}
+			}
+			GLMC_FREE(compressedBonePositions);
+			GLMC_FREE(rootBonePositions);
+		}
+		break;
+		default:
+			blockValues = GLMC_MALLOC(blockBoneCount * sizeof(float[3]));
+			glmFileRead(blockValues, sizeof(float), blockBoneCount * 3, fp);
+			glmScatterBlockElements((compressedData != NULL ? compressedData->_bonePositions : data->_bonePositions) + iBoneOffset, blockValues, boneCount * sizeof(float[3]), indicesInEntityType, entityCount);
+			GLMC_FREE(blockValues);
+		}
+
+		if (compressedData == NULL)
+		{
+			blockValues = GLMC_MALLOC(blockBoneCount * sizeof(float[4]));
+			glmFileReadOrientations((float(*)[4])blockValues, blockBoneCount, fp, format);
+			glmScatterBlockElements(data->_boneOrientations + iBoneOffset, blockValues, boneCount * sizeof(float[4]), indicesInEntityType, entityCount);
+		}
+		else
+		{
+			switch (format)
+			{
+			case GSC_O32_P48:
+			case GSC_O32_P96:
+				blockValues = GLMC_MALLOC(blockBoneCount * sizeof(uint32_t));
+				glmFileReadUInt32((uint32_t*)blockValues, blockBoneCount, fp);
+				glmScatterBlockElements(compressedData->_compressedBoneOrientations32 + iBoneOffset, blockValues, boneCount * sizeof(uint32_t), indicesInEntityType, entityCount);
+				break;
+			case GSC_O64_P48:
+			case GSC_O64_P96:
+				blockValues = GLMC_MALLOC(blockBoneCount * sizeof(uint64_t));
+				glmFileReadUInt64((uint64_t*)blockValues, blockBoneCount, fp);
+				glmScatterBlockElements(compressedData->_compressedBoneOrientations64 + iBoneOffset, blockValues, boneCount * sizeof(uint64_t), indicesInEntityType, entityCount);
+				break;
+			default:
+				blockValues = GLMC_MALLOC(blockBoneCount * sizeof(float[4]));
+				glmFileRead(blockValues, sizeof(float), blockBoneCount * 4, fp);
+				glmScatterBlockElements(compressedData->_boneOrientations + iBoneOffset, blockValues, boneCount * sizeof(float[4]), indicesInEntityType, entityCount);
+			}
+		}
+		GLMC_FREE(blockValues);
+	}
+
+	blockValues = GLMC_MALLOC(entityCount * snsCount * sizeof(float[4]));
+	glmFileRead(blockValues, sizeof(float), entityCount * snsCount * 4, fp);
+	glmScatterBlockElements(data->_snsValues + simulationData->_snsOffsetPerEntityType[entityType], blockValues, snsCount * sizeof(float[4]), indicesInEntityType, entityCount);
+	GLMC_FREE(blockValues);
+	blockValues = GLMC_MALLOC(entityCount * blindDataCount * sizeof(float));
+	glmFileRead(blockValues, sizeof(float), entityCount * blindDataCount, fp);
+	glmScatterBlockElements(data->_blindData + simulationData->_iBlindDataOffsetPerEntityType[entityType], blockValues, blindDataCount * sizeof(float), indicesInEntityType, entityCount);
+	GLMC_FREE(blockValues);
+	if (simulationData->_hasGeoBehavior[entityType])
+	{
+		uint32_t iGeoBehaviorOffset = simulationData->_iGeoBehaviorOffsetPerEntityType[entityType];
+		blockValues = GLMC_MALLOC(entityCount * sizeof(float[3]));
+		glmFileReadUInt16((uint16_t*)blockValues, entityCount, fp);
+		glmScatterBlockElements(data->_geoBehaviorGeometryIds + iGeoBehaviorOffset, blockValues, sizeof(uint16_t), indicesInEntityType, entityCount);
+		glmFileRead(blockValues, sizeof(float), entityCount * 3, fp);
+		glmScatterBlockElements(data->_geoBehaviorAnimFrameInfo + iGeoBehaviorOffset, blockValues, sizeof(float[3]), indicesInEntityType, entityCount);
+		glmFileRead(blockValues, sizeof(uint8_t), entityCount, fp);
+		glmScatterBlockElements(data->_geoBehaviorBlendModes + iGeoBehaviorOffset, blockValues, sizeof(uint8_t), indicesInEntityType, entityCount);
+		GLMC_FREE(blockValues);
+	}
+	GLMC_FREE(indicesInEntityType);
+
+	// ppAttribute, per simulation entity in the frame
+	if (simulationData->_ppFloatAttributeCount + simulationData->_ppVectorAttributeCount > 0)
+	{
+		float(*ppValues)[3] = (float(*)[3])GLMC_MALLOC(entityCount * sizeof(float[3]));
+		for (i = 0; i < simulationData->_ppFloatAttributeCount; ++i)
+		{
+			glmFileRead(ppValues, sizeof(float), entityCount, fp);
+			glmScatterBlockElements(data->_ppFloatAttributeData[i], ppValues, sizeof(float), blockEntityIndices, entityCount);
+		}
+		for (i = 0; i < simulationData->_ppVectorAttributeCount; ++i)
+		{
+			glmFileRead(ppValues, sizeof(float), entityCount * 3, fp);
+			glmScatterBlockElements(data->_ppVectorAttributeData[i], ppValues, sizeof(float[3]), blockEntityIndices, entityCount);
+		}
+		GLMC_FREE(ppValues);
+	}
+
+	// cloth, counts are checked before they index the block arrays
+	memset(blockCloth, 0, sizeof(GlmEntityBlockCloth));
+	glmFileReadUInt32(&blockCloth->_clothEntityCount, 1, fp);
+	if (blockCloth->_clothEntityCount > entityCount)
+		return GSC_FILE_FORMAT_ERROR;
+	if (blockCloth->_clothEntityCount != 0)
+	{
+		uint32_t clothEntityCount = blockCloth->_clothEntityCount;
+		uint32_t iClothEntity;
+		uint32_t useClothCount = 0;
+		uint64_t meshCount = 0;
+		uint64_t vertexCount = 0;
+
+		blockCloth->_entityUseCloth = (uint8_t*)GLMC_MALLOC(entityCount * sizeof(uint8_t));
+		blockCloth->_clothEntityMeshCount = (uint32_t*)GLMC_MALLOC(clothEntityCount * sizeof(uint32_t));
+		blockCloth->_clothEntityQuantizationReference = (float(*)[3])GLMC_MALLOC(clothEntityCount * sizeof(float[3]));
+		blockCloth->_clothEntityQuantizationMaxExtent = (float*)GLMC_MALLOC(clothEntityCount * sizeof(float));
+		glmFileRead(blockCloth->_entityUseCloth, sizeof(uint8_t), entityCount, fp);
+		glmFileReadUInt32(blockCloth->_clothEntityMeshCount, clothEntityCount, fp);
+		glmFileRead(blockCloth->_clothEntityQuantizationReference, sizeof(float), clothEntityCount * 3, fp);
+		glmFileRead(blockCloth->_clothEntityQuantizationMaxExtent, sizeof(float), clothEntityCount, fp);
+		for (iEntity = 0; iEntity < entityCount; ++iEntity)
+		{
+			if (blockCloth->_entityUseCloth[iEntity])
+				useClothCount++;
+		}
+		for (iClothEntity = 0; iClothEntity < clothEntityCount; ++iClothEntity)
+		{
+			meshCount += blockCloth->_clothEntityMeshCount[iClothEntity];
+		}
+
+		glmFileReadUInt32(&blockCloth->_meshCount, 1, fp);
+		if ((useClothCount != clothEntityCount) || (meshCount != blockCloth->_meshCount))
+			return GSC_FILE_FORMAT_ERROR;
+		blockCloth->_clothMeshIndicesInCharAssets = (uint32_t*)GLMC_MALLOC(blockCloth->_meshCount * sizeof(uint32_t));
+		blockCloth->_clothMeshVertexCount = (uint32_t*)GLMC_MALLOC(blockCloth->_meshCount * sizeof(uint32_t));
+		glmFileReadUInt32(blockCloth->_clothMeshIndicesInCharAssets, blockCloth->_meshCount, fp);
+		glmFileReadUInt32(blockCloth->_clothMeshVertexCount, blockCloth->_meshCount, fp);
+
+		// mesh and vertex ranges per cloth entity
+		blockCloth->_clothEntityFirstMesh = (uint32_t*)GLMC_MALLOC((clothEntityCount + 1) * sizeof(uint32_t));
+		blockCloth->_clothEntityFirstVertex = (uint32_t*)GLMC_MALLOC((clothEntityCount + 1) * sizeof(uint32_t));
+		blockCloth->_clothEntityFirstMesh[0] = 0;
+		blockCloth->_clothEntityFirstVertex[0] = 0;
+		for (iClothEntity = 0; iClothEntity < clothEntityCount; ++iClothEntity)
+		{
+			uint32_t iMesh;
+			uint32_t firstMesh = blockCloth->_clothEntityFirstMesh[iClothEntity];
+			blockCloth->_clothEntityFirstMesh[iClothEntity + 1] = firstMesh + blockCloth->_clothEntityMeshCount[iClothEntity];
+			blockCloth->_clothEntityFirstVertex[iClothEntity + 1] = blockCloth->_clothEntityFirstVertex[iClothEntity];
+			for (iMesh = firstMesh; iMesh < blockCloth->_clothEntityFirstMesh[iClothEntity + 1]; ++iMesh)
+			{
+				blockCloth->_clothEntityFirstVertex[iClothEntity + 1] += blockCloth->_clothMeshVertexCount[iMesh];
+				vertexCount += blockCloth->_clothMeshVertexCount[iMesh];
+			}
+		}
+
+		glmFileReadUInt32(&blockCloth->_vertexCount, 1, fp);
+		if (vertexCount != blockCloth->_vertexCount)
+			return GSC_FILE_FORMAT_ERROR;
+		blockCloth->_clothVertices = (float(*)[3])GLMC_MALLOC(blockCloth->_vertexCount * sizeof(float[3]));
+		switch (format)
+		{
+		case GSC_O32_P48:
+		case GSC_O64_P48:
+		case GSC_O128_P48:
+		{
+			uint16_t(*compressedVertices)[3] = (uint16_t(*)[3])GLMC_MALLOC(blockCloth->_vertexCount * sizeof(uint16_t[3]));
+			glmFileReadUInt16(compressedVertices[0], blockCloth->_vertexCount * 3, fp);
+			for (iClothEntity = 0; iClothEntity < clothEntityCount; ++iClothEntity)
+			{
+				uint32_t firstVertex = blockCloth->_clothEntityFirstVertex[iClothEntity];
+				glmSimdKernels->_uncompressPositions48(blockCloth->_clothVertices + firstVertex, (const uint16_t(*)[3])(compressedVertices + firstVertex), blockCloth->_clothEntityFirstVertex[iClothEntity + 1] - firstVertex,
+					blockCloth->_clothEntityQuantizationMaxExtent[iClothEntity], blockCloth->_clothEntityQuantizationReference[iClothEntity]);
+			}
+			GLMC_FREE(compressedVertices);
+		}
+		break;
+		default:
+			glmFileRead(blockCloth->_clothVertices, sizeof(float), blockCloth->_vertexCount * 3, fp);
+		}
+	}
+	return GSC_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// set the frame cloth data from the cloth of the read blocks, cloth entities are ordered by simulation entity index like in glmReadFrameData
+static void glmGatherEntityBlockCloth(GlmFrameData* data, const GlmSimulationData* simulationData, const GlmEntityBlockCloth* blockCloths, const uint32_t* blockFirstEntity, uint32_t blockCount,
+	const uint32_t* entityIndices)
+{
+	uint32_t iBlock;
+	uint32_t iEntity;
+	uint32_t clothEntityCount = 0;
+	uint32_t clothMeshCount = 0;
+	uint32_t clothVertexCount = 0;
+	int32_t* clothBlock;
+	uint32_t* clothIndexInBlock;
+	uint32_t iClothEntity = 0;
+	uint32_t iClothMesh = 0;
+	uint32_t iClothVertex = 0;
+
+	for (iBlock = 0; iBlock < blockCount; ++iBlock)
+	{
+		clothEntityCount += blockCloths[iBlock]._clothEntityCount;
+		clothMeshCount += blockCloths[iBlock]._meshCount;
+		clothVertexCount += blockCloths[iBlock]._vertexCount;
+	}
+	if (clothEntityCount == 0)
+	{
+		data->_clothEntityCount = 0;
+		data->_clothTotalMeshIndices = 0;
+		data->_clothTotalVertices = 0;
+		return;
+	}
+
+	glmCreateClothData(simulationData, data, clothEntityCount, clothMeshCount, clothVertexCount);
+
+	// source block of each cloth entity
+	clothBlock = (int32_t*)GLMC_MALLOC(simulationData->_entityCount * sizeof(int32_t));
+	clothIndexInBlock = (uint32_t*)GLMC_MALLOC(simulationData->_entityCount * sizeof(uint32_t));
+	for (iEntity = 0; iEntity < simulationData->_entityCount; ++iEntity)
+	{
+		clothBlock[iEntity] = -1;
+	}
+	for (iBlock = 0; iBlock < blockCount; ++iBlock)
+	{
+		const GlmEntityBlockCloth* blockCloth = blockCloths + iBlock;
+		uint32_t iClothEntityInBlock = 0;
+		if (blockCloth->_clothEntityCount == 0)
+			continue;
+		for (iEntity = 0; iEntity < blockFirstEntity[iBlock + 1] - blockFirstEntity[iBlock]; ++iEntity)
+		{
+			if (blockCloth->_entityUseCloth[iEntity])
+			{
+				uint32_t entityIndex = entityIndices[blockFirstEntity[iBlock] + iEntity];
+				clothBlock[entityIndex] = (int32_t)iBlock;
+				clothIndexInBlock[entityIndex] = iClothEntityInBlock++;
+			}
+		}
+	}
+
+	for (iEntity = 0; iEntity < simulationData->_entityCount; ++iEntity)
+	{
+		const GlmEntityBlockCloth* blockCloth;
+		uint32_t iClothEntityInBlock;
+		uint32_t meshCount;
+		uint32_t vertexCount;
+
+		if (clothBlock[iEntity] < 0)
+		{
+			data->_entityClothIndex[iEntity] = -1;
+			continue;
+		}
+		blockCloth = blockCloths + clothBlock[iEntity];
+		iClothEntityInBlock = clothIndexInBlock[iEntity];
+		meshCount = blockCloth->_clothEntityMeshCount[iClothEntityInBlock];
+		vertexCount = blockCloth->_clothEntityFirstVertex[iClothEntityInBlock + 1] - blockCloth->_clothEntityFirstVertex[iClothEntityInBlock];
+
+		data->_entityClothIndex[iEntity] = (int32_t)iClothEntity;
+		data->_clothEntityMeshCount[iClothEntity] = meshCount;
+		data->_clothEntityFirstAssetMeshIndex[iClothEntity] = iClothMesh;
+		data->_clothEntityFirstMeshVertex[iClothEntity] = iClothVertex;
+		memcpy(data->_clothEntityQuantizationReference[iClothEntity], blockCloth->_clothEntityQuantizationReference[iClothEntityInBlock], sizeof(float[3]));
+		data->_clothEntityQuantizationMaxExtent[iClothEntity] = blockCloth->_clothEntityQuantizationMaxExtent[iClothEntityInBlock];
+		memcpy(data->_clothMeshIndicesInCharAssets + iClothMesh, blockCloth->_clothMeshIndicesInCharAssets + blockCloth->_clothEntityFirstMesh[iClothEntityInBlock], meshCount * sizeof(uint32_t));
+		memcpy(data->_clothMeshVertexCount + iClothMesh, blockCloth->_clothMeshVertexCount + blockCloth->_clothEntityFirstMesh[iClothEntityInBlock], meshCount * sizeof(uint32_t));
+		memcpy(data->_clothVertices + iClothVertex, blockCloth->_clothVertices + blockCloth->_clothEntityFirstVertex[iClothEntityInBlock], vertexCount * sizeof(float[3]));
+
+		iClothEntity++;
+		iClothMesh += meshCount;
+		iClothVertex += vertexCount;
+	}
+
+	GLMC_FREE(clothIndexInBlock);
+	GLMC_FREE(clothBlock);
+}
+
+//----------------------------------------------------------------------------
+// read the selected blocks of a chunked frame, fp is after the frame header. Bones are kept in their file encoding in compressedData when it is not NULL
+// return GSC_SUCCESS || GSC_FILE_FORMAT_ERROR when the block table or a block does not match the file or the simulation
+static GlmSimulationCacheStatus glmFileReadFrameBlocks(GlmFrameData* data, GlmCompressedFrameData* compressedData, const GlmFrameEntitySelection* selection, const GlmSimulationData* simulationData,
+	FILE* fp, GlmSimulationCacheFormat format)
+{
+	uint32_t entityBlockSize = 0;
+	uint64_t blockTableOffset = 0;
+	uint64_t firstBlockOffset;
+	uint32_t blockCount = 0;
+	uint64_t* blockOffsets;
+	uint32_t* blockMinEntity;
+	uint32_t* blockMaxEntity;
+	uint32_t* blockFirstEntity;
+	uint32_t* firstEntityPerEntityType;
+	uint32_t* entityIndices;
+	GlmEntityBlockCloth* blockCloths;
+	unsigned int iEntityType;
+	uint32_t iBlock = 0;
+	GlmSimulationCacheStatus status = GSC_SUCCESS;
+
+	glmFileReadUInt32(&entityBlockSize, 1, fp);
+	glmFileReadUInt64(&blockTableOffset, 1, fp);
+	firstBlockOffset = glmFileTell(fp);
+	if ((entityBlockSize == 0) || (blockTableOffset < firstBlockOffset) || (blockTableOffset + sizeof(uint32_t) > glmFileSize(fp)))
+		return GSC_FILE_FORMAT_ERROR;
+
+	// block table
+	glmFileSeek(fp, blockTableOffset);
+	glmFileReadUInt32(&blockCount, 1, fp);
+	if (blockCount != glmComputeEntityBlockCount(simulationData, entityBlockSize))
+		return GSC_FILE_FORMAT_ERROR;
+	blockOffsets = (uint64_t*)GLMC_MALLOC(blockCount * sizeof(uint64_t));
+	blockMinEntity = (uint32_t*)GLMC_MALLOC(blockCount * sizeof(uint32_t));
+	blockMaxEntity = (uint32_t*)GLMC_MALLOC(blockCount * sizeof(uint32_t));
+	glmFileReadUInt64(blockOffsets, blockCount, fp);
+	glmFileReadUInt32(blockMinEntity, blockCount, fp);
+	glmFileReadUInt32(blockMaxEntity, blockCount, fp);
+
+	firstEntityPerEntityType = (uint32_t*)GLMC_MALLOC(simulationData->_entityTypeCount * sizeof(uint32_t));
+	entityIndices = glmCreateEntityIndicesPerEntityType(simulationData, firstEntityPerEntityType);
+	blockFirstEntity = (uint32_t*)GLMC_MALLOC((blockCount + 1) * sizeof(uint32_t));
+	blockCloths = (GlmEntityBlockCloth*)GLMC_MALLOC(blockCount * sizeof(GlmEntityBlockCloth));
+	memset(blockCloths, 0, blockCount * sizeof(GlmEntityBlockCloth));
+
+	for (iEntityType = 0; (iEntityType < simulationData->_entityTypeCount) && (status == GSC_SUCCESS); ++iEntityType)
+	{
+		unsigned int firstIndex;
+		unsigned int entityTypeCount = simulationData->_entityCountPerEntityType[iEntityType];
+		for (firstIndex = 0; (firstIndex < entityTypeCount) && (status == GSC_SUCCESS); firstIndex += entityBlockSize, ++iBlock)
+		{
+			unsigned int entityCount = entityTypeCount - firstIndex < entityBlockSize ? entityTypeCount - firstIndex : entityBlockSize;
+			const uint32_t* blockEntityIndices = entityIndices + firstEntityPerEntityType[iEntityType] + firstIndex;
+
+			blockFirstEntity[iBlock] = firstEntityPerEntityType[iEntityType] + firstIndex;
+			blockFirstEntity[iBlock + 1] = blockFirstEntity[iBlock] + entityCount;
+
+			// blocks are between the header and the block table, and hold the entities the simulation has in them
+			if ((blockOffsets[iBlock] < firstBlockOffset) || (blockOffsets[iBlock] >= blockTableOffset)
+				|| (blockMinEntity[iBlock] != blockEntityIndices[0]) || (blockMaxEntity[iBlock] != blockEntityIndices[entityCount - 1]))
+			{
+				status = GSC_FILE_FORMAT_ERROR;
+				break;
+			}
+			if (!glmIsEntityBlockSelected(selection, iEntityType, blockMinEntity[iBlock], blockMaxEntity[iBlock]))
+				continue;
+
+			glmFileSeek(fp, blockOffsets[iBlock]);
+			status = glmFileReadEntityBlock(data, compressedData, simulationData, blockEntityIndices, iEntityType, entityCount, blockCloths + iBlock, fp, format);
+		}
+	}
+
+	if (status == GSC_SUCCESS)
+	{
+		glmGatherEntityBlockCloth(data, simulationData, blockCloths, blockFirstEntity, blockCount, entityIndices);
+	}
+
+	for (iBlock = 0; iBlock < blockCount; ++iBlock)
+	{
+		glmDestroyEntityBlockCloth(blockCloths + iBlock);
+	}
+	GLMC_FREE(blockCloths);
+	GLMC_FREE(blockFirstEntity);
+	GLMC_FREE(entityIndices);
+	GLMC_FREE(firstEntityPerEntityType);
+	GLMC_FREE(blockMaxEntity);
+	GLMC_FREE(blockMinEntity);
+	GLMC_FREE(blockOffsets);
+	return status;
+}
+
+//----------------------------------------------------------------------------
+// read a .gscf file in data. When compressedData is not NULL, bones are kept quantized in compressedData and data bone arrays are not written.
+// selection restricts the entities read from chunked files, NULL reads all entities
+static GlmSimulationCacheStatus glmReadFrameDataFile(GlmFrameData* data, GlmCompressedFrameData* compressedData, const GlmFrameEntitySelection* selection, const GlmSimulationData* simulationData, const char* file)
 {
 	uint16_t magicNumber;
 	uint8_t version;
@@ -1876,7 +3189,7 @@ GlmSimulationCacheStatus glmReadFrameData(GlmFrameData* data, const GlmSimulatio
 
 	// header
 	glmFileReadUInt16(&magicNumber, 1, fp);
-	if (magicNumber != GSCF_MAGIC_NUMBER)
+	if ((magicNumber != GSCF_MAGIC_NUMBER) && (magicNumber != GSCF_BLOCKS_MAGIC_NUMBER))
 	{
 		fclose(fp);
 		return GSC_FILE_MAGIC_NUMBER_ERROR;
@@ -1916,13 +3229,32 @@ GlmSimulationCacheStatus glmReadFrameData(GlmFrameData* data, const GlmSimulatio
 			totalGeoBehaviorCount += simulationData->_entityCountPerEntityType[i];
 		}
 	}
-	glmFileReadPositions(data->_bonePositions, totalBoneCount, simulationData, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
-	glmFileReadOrientations(data->_boneOrientations, totalBoneCount, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
-	if (simulationData->_version < 0x01)
+	if (compressedData != NULL)
 	{
-		int iBone;
-		float(*snsValue)[4] = data->_snsValues;
-		float(*snsValueSource)[3] = (float(*)[3])data->_snsValues;
+		glmCreateCompressedBones(compressedData, totalBoneCount, simulationData, (GlmSimulationCacheFormat)data->_cacheFormat);
+	}
+
+	if (magicNumber == GSCF_BLOCKS_MAGIC_NUMBER)
+	{
+		GlmSimulationCacheStatus status = glmFileReadFrameBlocks(data, compressedData, selection, simulationData, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
+		fclose(fp);
+		return status;
+	}
+
+	if (compressedData != NULL)
+	{
+		glmFileReadCompressedBones(compressedData, fp);
+	}
+	else
+	{
+		glmFileReadPositions(data->_bonePositions, totalBoneCount, simulationData, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
+		glmFileReadOrientations(data->_boneOrientations, totalBoneCount, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
+	}
+	if (simulationData->_version < 0x01)
+	{
+		int iBone;
+		float(*snsValue)[4] = data->_snsValues;
+		float(*snsValueSource)[3] = (float(*)[3])data->_snsValues;
 
 		glmFileRead(data->_snsValues, sizeof(float), totalSnSCount * 4, fp);
 
@@ -2059,6 +3391,187 @@ GlmSimulationCacheStatus glmReadFrameData(GlmFrameData* data, const GlmSimulatio
 	return GSC_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+GlmSimulationCacheStatus glmReadFrameData(GlmFrameData* data, const GlmSimulationData* simulationData, const char* file)
+{
+	return glmReadFrameDataFile(data, NULL, NULL, simulationData, file);
+}
+
+//----------------------------------------------------------------------------
+GlmSimulationCacheStatus glmReadFrameDataEntityRange(GlmFrameData* data, const GlmSimulationData* simulationData, const char* file, unsigned int firstEntity, unsigned int entityCount)
+{
+	GlmFrameEntitySelection selection;
+	selection._firstEntity = firstEntity;
+	selection._entityCount = entityCount;
+	selection._entityTypeEnabled = NULL;
+	return glmReadFrameDataFile(data, NULL, &selection, simulationData, file);
+}
+
+//----------------------------------------------------------------------------
+GlmSimulationCacheStatus glmReadFrameDataEntityTypes(GlmFrameData* data, const GlmSimulationData* simulationData, const char* file, const uint8_t* entityTypeEnabled)
+{
+	GlmFrameEntitySelection selection;
+	selection._firstEntity = 0;
+	selection._entityCount = simulationData->_entityCount;
+	selection._entityTypeEnabled = entityTypeEnabled;
+	return glmReadFrameDataFile(data, NULL, &selection, simulationData, file);
+}
+
+//----------------------------------------------------------------------------
+GlmSimulationCacheStatus glmCreateAndReadCompressedFrameData(GlmCompressedFrameData** compressedFrameData, const GlmSimulationData* simulationData, const char* file)
+{
+	GlmSimulationCacheStatus status;
+	GlmCompressedFrameData* data = (GlmCompressedFrameData*)GLMC_MALLOC(sizeof(GlmCompressedFrameData));
+	memset(data, 0, sizeof(GlmCompressedFrameData));
+
+	// other frame data are read decoded, bones are read in the compressed frame
+	glmCreateFrameData(&data->_frameData, simulationData);
+	GLMC_FREE(data->_frameData->_bonePositions);
+	GLMC_FREE(data->_frameData->_boneOrientations);
+	data->_frameData->_bonePositions = NULL;
+	data->_frameData->_boneOrientations = NULL;
+
+	status = glmReadFrameDataFile(data->_frameData, data, NULL, simulationData, file);
+	if (status != GSC_SUCCESS)
+	{
+		glmDestroyCompressedFrameData(&data, simulationData);
+	}
+	*compressedFrameData = data;
+	return status;
+}
+
+//----------------------------------------------------------------------------
+void glmGetCompressedEntityBones(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, unsigned int entityIndex, float(*bonePositions)[3], float(*boneOrientations)[4])
+{
+	uint16_t entityType = simulationData->_entityTypes[entityIndex];
+	uint32_t indexInEntityType = simulationData->_indexInEntityType[entityIndex];
+	uint16_t boneCount = simulationData->_boneCount[entityType];
+	uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityType] + boneCount * indexInEntityType;
+
+	if (boneCount == 0)
+		return;
+	glmDecodeCompressedBones(compressedFrameData, simulationData, entityType, offset, compressedFrameData->_iRootBoneOffsetPerEntityType[entityType] + indexInEntityType, boneCount, bonePositions, boneOrientations);
+}
+
+//----------------------------------------------------------------------------
+void glmGetCompressedEntityRootBone(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, unsigned int entityIndex, float bonePosition[3], float boneOrientation[4])
+{
+	uint16_t entityType = simulationData->_entityTypes[entityIndex];
+	uint32_t indexInEntityType = simulationData->_indexInEntityType[entityIndex];
+	uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_boneCount[entityType] * indexInEntityType;
+
+	if (simulationData->_boneCount[entityType] == 0)
+		return;
+	glmDecodeCompressedBones(compressedFrameData, simulationData, entityType, offset, compressedFrameData->_iRootBoneOffsetPerEntityType[entityType] + indexInEntityType, 1,
+		(float(*)[3])bonePosition, (float(*)[4])boneOrientation);
+}
+
+//----------------------------------------------------------------------------
+void glmDecompressFrameData(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData, GlmFrameData** frameData)
+{
+	const GlmFrameData* frameIn = compressedFrameData->_frameData;
+	GlmFrameData* frameOut;
+	unsigned int totalSnSCount = 0;
+	unsigned int totalBlindDataCount = 0;
+	unsigned int totalGeoBehaviorCount = 0;
+	unsigned int iEntityType;
+	unsigned int i;
+
+	glmCreateFrameData(frameData, simulationData);
+	frameOut = *frameData;
+	frameOut->_cacheFormat = frameIn->_cacheFormat;
+	frameOut->_hasSquashAndStretch = frameIn->_hasSquashAndStretch;
+	frameOut->_simulationContentHashKey = frameIn->_simulationContentHashKey;
+
+	// bones
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; ++iEntityType)
+	{
+		unsigned int iEntity;
+		unsigned int boneCount = simulationData->_boneCount[iEntityType];
+
+		totalSnSCount += simulationData->_snsCountPerEntityType[iEntityType] * simulationData->_entityCountPerEntityType[iEntityType];
+		totalBlindDataCount += simulationData->_blindDataCount[iEntityType] * simulationData->_entityCountPerEntityType[iEntityType];
+		if (simulationData->_hasGeoBehavior[iEntityType])
+		{
+			totalGeoBehaviorCount += simulationData->_entityCountPerEntityType[iEntityType];
+		}
+
+		if (boneCount == 0)
+			continue;
+		for (iEntity = 0; iEntity < simulationData->_entityCountPerEntityType[iEntityType]; ++iEntity)
+		{
+			unsigned int offset = simulationData->_iBoneOffsetPerEntityType[iEntityType] + iEntity * boneCount;
+			glmDecodeCompressedBones(compressedFrameData, simulationData, iEntityType, offset, compressedFrameData->_iRootBoneOffsetPerEntityType[iEntityType] + iEntity, boneCount,
+				frameOut->_bonePositions + offset, frameOut->_boneOrientations + offset);
+		}
+	}
+
+	// other data are already decoded
+	memcpy(frameOut->_snsValues, frameIn->_snsValues, totalSnSCount * sizeof(float[4]));
+	memcpy(frameOut->_blindData, frameIn->_blindData, totalBlindDataCount * sizeof(float));
+	if (totalGeoBehaviorCount > 0)
+	{
+		memcpy(frameOut->_geoBehaviorGeometryIds, frameIn->_geoBehaviorGeometryIds, totalGeoBehaviorCount * sizeof(uint16_t));
+		memcpy(frameOut->_geoBehaviorAnimFrameInfo, frameIn->_geoBehaviorAnimFrameInfo, totalGeoBehaviorCount * sizeof(float[3]));
+		memcpy(frameOut->_geoBehaviorBlendModes, frameIn->_geoBehaviorBlendModes, totalGeoBehaviorCount * sizeof(uint8_t));
+	}
+	for (i = 0; i < simulationData->_ppFloatAttributeCount; ++i)
+	{
+		memcpy(frameOut->_ppFloatAttributeData[i], frameIn->_ppFloatAttributeData[i], simulationData->_entityCount * sizeof(float));
+	}
+	for (i = 0; i < simulationData->_ppVectorAttributeCount; ++i)
+	{
+		memcpy(frameOut->_ppVectorAttributeData[i], frameIn->_ppVectorAttributeData[i], simulationData->_entityCount * sizeof(float[3]));
+	}
+	glmCopyClothData(frameIn, simulationData, frameOut);
+}
+
+//----------------------------------------------------------------------------
+uint64_t glmComputeCompressedFrameDataSize(const GlmCompressedFrameData* compressedFrameData, const GlmSimulationData* simulationData)
+{
+	uint64_t totalSize = sizeof(GlmCompressedFrameData);
+	uint64_t boneCount = compressedFrameData->_boneCount;
+
+	// glmComputeFrameDataSize counts the decoded bones, not allocated here
+	totalSize += glmComputeFrameDataSize(compressedFrameData->_frameData, simulationData) - boneCount * 7 * sizeof(float);
+	totalSize += simulationData->_entityTypeCount * sizeof(uint32_t);
+	if (compressedFrameData->_compressedBonePositions != NULL)
+	{
+		totalSize += compressedFrameData->_rootBoneCount * 3 * sizeof(float);
+		totalSize += (boneCount - compressedFrameData->_rootBoneCount) * 3 * sizeof(uint16_t);
+	}
+	else
+	{
+		totalSize += boneCount * 3 * sizeof(float);
+	}
+	if (compressedFrameData->_compressedBoneOrientations32 != NULL)
+		totalSize += boneCount * sizeof(uint32_t);
+	else if (compressedFrameData->_compressedBoneOrientations64 != NULL)
+		totalSize += boneCount * sizeof(uint64_t);
+	else
+		totalSize += boneCount * 4 * sizeof(float);
+	return totalSize;
+}
+
+//----------------------------------------------------------------------------
+void glmDestroyCompressedFrameData(GlmCompressedFrameData** compressedFrameData, const GlmSimulationData* simulationData)
+{
+	GlmCompressedFrameData* data = *compressedFrameData;
+	if (data == NULL)
+		return;
+	if (data->_frameData)
+		glmDestroyFrameData(&data->_frameData, simulationData);
+	GLMC_FREE(data->_iRootBoneOffsetPerEntityType);
+	GLMC_FREE(data->_rootBonePositions);
+	GLMC_FREE(data->_compressedBonePositions);
+	GLMC_FREE(data->_bonePositions);
+	GLMC_FREE(data->_compressedBoneOrientations32);
+	GLMC_FREE(data->_compressedBoneOrientations64);
+	GLMC_FREE(data->_boneOrientations);
+	GLMC_FREE(data);
+	*compressedFrameData = NULL;
+}
+
 //----------------------------------------------------------------------------
 void glmFileWriteOrientations(float(*bonesOrientations)[4], unsigned int totalBoneCount, FILE* fp, GlmSimulationCacheFormat format)
 {
@@ -2310,6 +3823,329 @@ GlmSimulationCacheStatus glmWriteFrameData(const char* file, const GlmFrameData*
 	return GSC_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+// write a block of entityCount entities of entityType, blockEntityIndices are their simulation entity indices in increasing order :
+// bones, sns, blind data, geo behavior, pp attributes and cloth. clothFirstMesh / clothFirstVertex : mesh and vertex ranges per cloth entity of the frame
+static void glmFileWriteEntityBlock(const GlmFrameData* data, const GlmSimulationData* simulationData, const uint32_t* blockEntityIndices, unsigned int entityType, unsigned int entityCount,
+	const uint32_t* clothFirstMesh, const uint32_t* clothFirstVertex, FILE* fp, GlmSimulationCacheFormat format)
+{
+	unsigned int i, iEntity;
+	unsigned int boneCount = simulationData->_boneCount[entityType];
+	unsigned int snsCount = simulationData->_snsCountPerEntityType[entityType];
+	unsigned int blindDataCount = simulationData->_blindDataCount[entityType];
+	unsigned int iBoneOffset = simulationData->_iBoneOffsetPerEntityType[entityType];
+	uint32_t* indicesInEntityType = glmCreateBlockIndicesInEntityType(simulationData, blockEntityIndices, entityCount);
+	void* blockValues;
+	uint32_t clothEntityCount = 0;
+
+	if (boneCount > 0)
+	{
+		unsigned int blockBoneCount = entityCount * boneCount;
+		switch (format)
+		{
+		case GSC_O32_P48:
+		case GSC_O64_P48:
+		case GSC_O128_P48:
+		{
+			unsigned int childCount = boneCount - 1;
+			float maxExtent = simulationData->_maxBonesHierarchyLength[entityType];
+			float(*rootBonePositions)[3] = (float(*)[3])GLMC_MALLOC(entityCount * sizeof(float[3]));
+			uint16_t(*compressedBonePositions)[3] = (uint16_t(*)[3])GLMC_MALLOC(entityCount * childCount * sizeof(uint16_t[3]));
+			for (iEntity = 0; iEntity < entityCount; ++iEntity)
+			{
+				unsigned int iBone;
+				const float(*bonePositions)[3] = (const float(*)[3])data->_bonePositions + iBoneOffset + indicesInEntityType[iEntity] * boneCount;
+				memcpy(rootBonePositions[iEntity], bonePositions[0], sizeof(float[3]));
+				for (iBone = 1; iBone < boneCount; ++iBone)
+				{
+					float localPosition[3];
+					localPosition[0] = bonePositions[iBone][0] - bonePositions[0][0];
+					localPosition[1] = bonePositions[iBone][1] - bonePositions[0][1];
+					localPosition[2] = bonePositions[iBone][2] - bonePositions[0][2];
+					glmCompressPosition48(compressedBonePositions[iEntity * childCount + iBone - 1], localPosition, maxExtent);
+				}
+			}
+			glmFileWrite(rootBonePositions, sizeof(float), entityCount * 3, fp);
+			glmFileWriteUInt16(compressedBonePositions[0], entityCount * childCount * 3, fp);
+			GLMC_FREE(compressedBonePositions);
+			GLMC_FREE(rootBonePositions);
+		}
+		break;
+		default:
+			blockValues = GLMC_MALLOC(blockBoneCount * sizeof(float[3]));
+			glmGatherBlockElements(blockValues, data->_bonePositions + iBoneOffset, boneCount * sizeof(float[3]), indicesInEntityType, entityCount);
+			glmFileWrite(blockValues, sizeof(float), blockBoneCount * 3, fp);
+			GLMC_FREE(blockValues);
+		}
+		blockValues = GLMC_MALLOC(blockBoneCount * sizeof(float[4]));
+		glmGatherBlockElements(blockValues, data->_boneOrientations + iBoneOffset, boneCount * sizeof(float[4]), indicesInEntityType, entityCount);
+		glmFileWriteOrientations((float(*)[4])blockValues, blockBoneCount, fp, format);
+		GLMC_FREE(blockValues);
+	}
+
+	blockValues = GLMC_MALLOC(entityCount * snsCount * sizeof(float[4]));
+	glmGatherBlockElements(blockValues, data->_snsValues + simulationData->_snsOffsetPerEntityType[entityType], snsCount * sizeof(float[4]), indicesInEntityType, entityCount);
+	glmFileWrite(blockValues, sizeof(float), entityCount * snsCount * 4, fp);
+	GLMC_FREE(blockValues);
+	blockValues = GLMC_MALLOC(entityCount * blindDataCount * sizeof(float));
+	glmGatherBlockElements(blockValues, data->_blindData + simulationData->_iBlindDataOffsetPerEntityType[entityType], blindDataCount * sizeof(float), indicesInEntityType, entityCount);
+	glmFileWrite(blockValues, sizeof(float), entityCount * blindDataCount, fp);
+	GLMC_FREE(blockValues);
+	if (simulationData->_hasGeoBehavior[entityType])
+	{
+		uint32_t iGeoBehaviorOffset = simulationData->_iGeoBehaviorOffsetPerEntityType[entityType];
+		blockValues = GLMC_MALLOC(entityCount * sizeof(float[3]));
+		glmGatherBlockElements(blockValues, data->_geoBehaviorGeometryIds + iGeoBehaviorOffset, sizeof(uint16_t), indicesInEntityType, entityCount);
+		glmFileWriteUInt16((uint16_t*)blockValues, entityCount, fp);
+		glmGatherBlockElements(blockValues, data->_geoBehaviorAnimFrameInfo + iGeoBehaviorOffset, sizeof(float[3]), indicesInEntityType, entityCount);
+		glmFileWrite(blockValues, sizeof(float), entityCount * 3, fp);
+		glmGatherBlockElements(blockValues, data->_geoBehaviorBlendModes + iGeoBehaviorOffset, sizeof(uint8_t), indicesInEntityType, entityCount);
+		glmFileWrite(blockValues, sizeof(uint8_t), entityCount, fp);
+		GLMC_FREE(blockValues);
+	}
+	GLMC_FREE(indicesInEntityType);
+
+	// ppAttribute, gathered from the simulation entity indices
+	if (simulationData->_ppFloatAttributeCount + simulationData->_ppVectorAttributeCount > 0)
+	{
+		float(*ppValues)[3] = (float(*)[3])GLMC_MALLOC(entityCount * sizeof(float[3]));
+		for (i = 0; i < simulationData->_ppFloatAttributeCount; ++i)
+		{
+			glmGatherBlockElements(ppValues, data->_ppFloatAttributeData[i], sizeof(float), blockEntityIndices, entityCount);
+			glmFileWrite(ppValues, sizeof(float), entityCount, fp);
+		}
+		for (i = 0; i < simulationData->_ppVectorAttributeCount; ++i)
+		{
+			glmGatherBlockElements(ppValues, data->_ppVectorAttributeData[i], sizeof(float[3]), blockEntityIndices, entityCount);
+			glmFileWrite(ppValues, sizeof(float), entityCount * 3, fp);
+		}
+		GLMC_FREE(ppValues);
+	}
+
+	// cloth
+	if (clothFirstMesh != NULL)
+	{
+		for (iEntity = 0; iEntity < entityCount; ++iEntity)
+		{
+			if (data->_entityClothIndex[blockEntityIndices[iEntity]] != -1)
+				clothEntityCount++;
+		}
+	}
+	glmFileWriteUInt32(&clothEntityCount, 1, fp);
+	if (clothEntityCount != 0)
+	{
+		uint32_t iClothEntity = 0;
+		uint32_t meshCount = 0;
+		uint32_t vertexCount = 0;
+		uint8_t* entityUseCloth = (uint8_t*)GLMC_MALLOC(entityCount * sizeof(uint8_t));
+		uint32_t* clothEntityMeshCount = (uint32_t*)GLMC_MALLOC(clothEntityCount * sizeof(uint32_t));
+		float(*clothReference)[3] = (float(*)[3])GLMC_MALLOC(clothEntityCount * sizeof(float[3]));
+		float* clothMaxExtent = (float*)GLMC_MALLOC(clothEntityCount * sizeof(float));
+		uint32_t* clothMeshIndices;
+		uint32_t* clothMeshVertexCount;
+
+		for (iEntity = 0; iEntity < entityCount; ++iEntity)
+		{
+			int32_t clothIndex = data->_entityClothIndex[blockEntityIndices[iEntity]];
+			entityUseCloth[iEntity] = clothIndex == -1 ? 0 : 1;
+			if (clothIndex == -1)
+				continue;
+			clothEntityMeshCount[iClothEntity] = data->_clothEntityMeshCount[clothIndex];
+			memcpy(clothReference[iClothEntity], data->_clothEntityQuantizationReference[clothIndex], sizeof(float[3]));
+			clothMaxExtent[iClothEntity] = data->_clothEntityQuantizationMaxExtent[clothIndex];
+			meshCount += clothFirstMesh[clothIndex + 1] - clothFirstMesh[clothIndex];
+			vertexCount += clothFirstVertex[clothIndex + 1] - clothFirstVertex[clothIndex];
+			iClothEntity++;
+		}
+		glmFileWrite(entityUseCloth, sizeof(uint8_t), entityCount, fp);
+		glmFileWriteUInt32(clothEntityMeshCount, clothEntityCount, fp);
+		glmFileWrite(clothReference, sizeof(float), clothEntityCount * 3, fp);
+		glmFileWrite(clothMaxExtent, sizeof(float), clothEntityCount, fp);
+
+		clothMeshIndices = (uint32_t*)GLMC_MALLOC(meshCount * sizeof(uint32_t));
+		clothMeshVertexCount = (uint32_t*)GLMC_MALLOC(meshCount * sizeof(uint32_t));
+		meshCount = 0;
+		for (iEntity = 0; iEntity < entityCount; ++iEntity)
+		{
+			int32_t clothIndex = data->_entityClothIndex[blockEntityIndices[iEntity]];
+			uint32_t entityMeshCount;
+			if (clothIndex == -1)
+				continue;
+			entityMeshCount = clothFirstMesh[clothIndex + 1] - clothFirstMesh[clothIndex];
+			memcpy(clothMeshIndices + meshCount, data->_clothMeshIndicesInCharAssets + clothFirstMesh[clothIndex], entityMeshCount * sizeof(uint32_t));
+			memcpy(clothMeshVertexCount + meshCount, data->_clothMeshVertexCount + clothFirstMesh[clothIndex], entityMeshCount * sizeof(uint32_t));
+			meshCount += entityMeshCount;
+		}
+		glmFileWriteUInt32(&meshCount, 1, fp);
+		glmFileWriteUInt32(clothMeshIndices, meshCount, fp);
+		glmFileWriteUInt32(clothMeshVertexCount, meshCount, fp);
+
+		glmFileWriteUInt32(&vertexCount, 1, fp);
+		switch (format)
+		{
+		case GSC_O32_P48:
+		case GSC_O64_P48:
+		case GSC_O128_P48:
+		{
+			uint16_t(*compressedVertices)[3] = (uint16_t(*)[3])GLMC_MALLOC(vertexCount * sizeof(uint16_t[3]));
+			uint32_t iBlockVertex = 0;
+			for (iEntity = 0; iEntity < entityCount; ++iEntity)
+			{
+				int32_t clothIndex = data->_entityClothIndex[blockEntityIndices[iEntity]];
+				uint32_t iVertex;
+				if (clothIndex == -1)
+					continue;
+				for (iVertex = clothFirstVertex[clothIndex]; iVertex < clothFirstVertex[clothIndex + 1]; ++iVertex)
+				{
+					// relative to the cloth entity reference, like glmFileWriteClothVertices
+					float localPosition[3];
+					localPosition[0] = data->_clothVertices[iVertex][0] - data->_clothEntityQuantizationReference[clothIndex][0];
+					localPosition[1] = data->_clothVertices[iVertex][1] - data->_clothEntityQuantizationReference[clothIndex][1];
+					localPosition[2] = data->_clothVertices[iVertex][2] - data->_clothEntityQuantizationReference[clothIndex][2];
+					glmCompressPosition48(compressedVertices[iBlockVertex], localPosition, data->_clothEntityQuantizationMaxExtent[clothIndex]);
+					iBlockVertex++;
+				}
+			}
+			glmFileWriteUInt16(compressedVertices[0], vertexCount * 3, fp);
+			GLMC_FREE(compressedVertices);
+		}
+		break;
+		default:
+		{
+			float(*vertices)[3] = (float(*)[3])GLMC_MALLOC(vertexCount * sizeof(float[3]));
+			uint32_t iBlockVertex = 0;
+			for (iEntity = 0; iEntity < entityCount; ++iEntity)
+			{
+				int32_t clothIndex = data->_entityClothIndex[blockEntityIndices[iEntity]];
+				if (clothIndex == -1)
+					continue;
+				memcpy(vertices + iBlockVertex, data->_clothVertices + clothFirstVertex[clothIndex], (clothFirstVertex[clothIndex + 1] - clothFirstVertex[clothIndex]) * sizeof(float[3]));
+				iBlockVertex += clothFirstVertex[clothIndex + 1] - clothFirstVertex[clothIndex];
+			}
+			glmFileWrite(vertices, sizeof(float), vertexCount * 3, fp);
+			GLMC_FREE(vertices);
+		}
+		}
+
+		GLMC_FREE(clothMeshVertexCount);
+		GLMC_FREE(clothMeshIndices);
+		GLMC_FREE(clothMaxExtent);
+		GLMC_FREE(clothReference);
+		GLMC_FREE(clothEntityMeshCount);
+		GLMC_FREE(entityUseCloth);
+	}
+}
+
+//----------------------------------------------------------------------------
+// chunked frame layout :
+//		header : magic number, version, format, simulation content hash key, entity block size, block table offset
+//		blocks : per entity type, per block of entityBlockSize entities taken in simulation order, see glmFileWriteEntityBlock
+//		block table : block count, block offsets, smallest and largest simulation entity index of each block
+GlmSimulationCacheStatus glmWriteFrameDataBlocks(const char* file, const GlmFrameData* data, const GlmSimulationData* simulationData, unsigned int entityBlockSize)
+{
+	uint16_t magicNumber;
+	uint8_t version;
+	uint32_t blockSize = entityBlockSize;
+	uint64_t blockTableOffset = 0;
+	uint64_t blockTableOffsetPosition;
+	uint32_t blockCount;
+	uint64_t* blockOffsets;
+	uint32_t* blockMinEntity;
+	uint32_t* blockMaxEntity;
+	uint32_t* firstEntityPerEntityType;
+	uint32_t* entityIndices;
+	uint32_t* clothFirstMesh = NULL;
+	uint32_t* clothFirstVertex = NULL;
+	unsigned int iEntityType;
+	uint32_t iBlock = 0;
+
+	GLMC_ASSERT((entityBlockSize > 0) && "entityBlockSize must be > 0");
+
+#ifdef _MSC_VER				
+	FILE* fp;
+	errno_t err;
+	err = fopen_s(&fp, file, "wb");
+	if (err != 0) return GSC_FILE_OPEN_FAILED;
+#else
+	FILE* fp = fopen(file, "wb");
+	if (fp == NULL) return GSC_FILE_OPEN_FAILED;
+#endif
+
+	// header
+	magicNumber = GSCF_BLOCKS_MAGIC_NUMBER;
+	glmFileWriteUInt16(&magicNumber, 1, fp);
+	version = GSC_VERSION;
+	glmFileWrite(&version, sizeof(uint8_t), 1, fp);
+	glmFileWrite(&(data->_cacheFormat), sizeof(uint8_t), 1, fp);
+	glmFileWriteUInt32((uint32_t*)&data->_simulationContentHashKey, 1, fp);
+	glmFileWriteUInt32(&blockSize, 1, fp);
+	blockTableOffsetPosition = glmFileTell(fp);
+	glmFileWriteUInt64(&blockTableOffset, 1, fp); // written once the blocks are written
+
+	// mesh and vertex ranges per cloth entity, recomputed like in glmReadFrameData
+	if ((data->_clothEntityCount != 0) && (data->_clothTotalMeshIndices > 0))
+	{
+		uint32_t iClothEntity;
+		clothFirstMesh = (uint32_t*)GLMC_MALLOC((data->_clothEntityCount + 1) * sizeof(uint32_t));
+		clothFirstVertex = (uint32_t*)GLMC_MALLOC((data->_clothEntityCount + 1) * sizeof(uint32_t));
+		clothFirstMesh[0] = 0;
+		clothFirstVertex[0] = 0;
+		for (iClothEntity = 0; iClothEntity < data->_clothEntityCount; ++iClothEntity)
+		{
+			uint32_t iMesh;
+			clothFirstMesh[iClothEntity + 1] = clothFirstMesh[iClothEntity] + data->_clothEntityMeshCount[iClothEntity];
+			clothFirstVertex[iClothEntity + 1] = clothFirstVertex[iClothEntity];
+			for (iMesh = clothFirstMesh[iClothEntity]; iMesh < clothFirstMesh[iClothEntity + 1]; ++iMesh)
+			{
+				clothFirstVertex[iClothEntity + 1] += data->_clothMeshVertexCount[iMesh];
+			}
+		}
+	}
+
+	blockCount = glmComputeEntityBlockCount(simulationData, entityBlockSize);
+	blockOffsets = (uint64_t*)GLMC_MALLOC(blockCount * sizeof(uint64_t));
+	blockMinEntity = (uint32_t*)GLMC_MALLOC(blockCount * sizeof(uint32_t));
+	blockMaxEntity = (uint32_t*)GLMC_MALLOC(blockCount * sizeof(uint32_t));
+	firstEntityPerEntityType = (uint32_t*)GLMC_MALLOC(simulationData->_entityTypeCount * sizeof(uint32_t));
+	entityIndices = glmCreateEntityIndicesPerEntityType(simulationData, firstEntityPerEntityType);
+
+	// blocks
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; ++iEntityType)
+	{
+		unsigned int firstIndex;
+		unsigned int entityTypeCount = simulationData->_entityCountPerEntityType[iEntityType];
+		for (firstIndex = 0; firstIndex < entityTypeCount; firstIndex += entityBlockSize, ++iBlock)
+		{
+			unsigned int entityCount = entityTypeCount - firstIndex < entityBlockSize ? entityTypeCount - firstIndex : entityBlockSize;
+			const uint32_t* blockEntityIndices = entityIndices + firstEntityPerEntityType[iEntityType] + firstIndex;
+			blockOffsets[iBlock] = glmFileTell(fp);
+			blockMinEntity[iBlock] = blockEntityIndices[0];
+			blockMaxEntity[iBlock] = blockEntityIndices[entityCount - 1];
+			glmFileWriteEntityBlock(data, simulationData, blockEntityIndices, iEntityType, entityCount, clothFirstMesh, clothFirstVertex, fp, (GlmSimulationCacheFormat)data->_cacheFormat);
+		}
+	}
+
+	// block table
+	blockTableOffset = glmFileTell(fp);
+	glmFileWriteUInt32(&blockCount, 1, fp);
+	glmFileWriteUInt64(blockOffsets, blockCount, fp);
+	glmFileWriteUInt32(blockMinEntity, blockCount, fp);
+	glmFileWriteUInt32(blockMaxEntity, blockCount, fp);
+	glmFileSeek(fp, blockTableOffsetPosition);
+	glmFileWriteUInt64(&blockTableOffset, 1, fp);
+
+	fclose(fp);
+
+	GLMC_FREE(entityIndices);
+	GLMC_FREE(firstEntityPerEntityType);
+	GLMC_FREE(blockMaxEntity);
+	GLMC_FREE(blockMinEntity);
+	GLMC_FREE(blockOffsets);
+	GLMC_FREE(clothFirstVertex);
+	GLMC_FREE(clothFirstMesh);
+	return GSC_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 void glmDestroyFrameData(GlmFrameData** frameData, const GlmSimulationData* simulationData)
 {
@@ -3758,6 +5594,80 @@ int glmFindEntityInSimulation(GlmEntityTransform* entityTransforms, unsigned int
 	return -1;
 }
 
+// open addressing entityId -> entity transform index, built once per glmCreateEntityTransforms
+typedef struct GlmEntityIndexMap_v0
+{
+	uint32_t _bucketMask; // bucket count - 1, bucket count is a power of 2 at least twice the entity count
+	int64_t* _entityIds;
+	int32_t* _indices; // -1 for empty buckets
+} GlmEntityIndexMap;
+
+static uint32_t glmHashEntityId(int64_t entityId)
+{
+	// 64 bit finalizer mix (murmur3), ids are often contiguous
+	uint64_t h = (uint64_t)entityId;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (uint32_t)h;
+}
+
+static void glmInitEntityIndexMap(GlmEntityIndexMap* map, unsigned int entityCount)
+{
+	uint32_t bucketCount = 16;
+	while (bucketCount < entityCount * 2)
+		bucketCount *= 2;
+
+	map->_bucketMask = bucketCount - 1;
+	map->_entityIds = (int64_t*)GLMC_MALLOC(bucketCount * sizeof(int64_t));
+	map->_indices = (int32_t*)GLMC_MALLOC(bucketCount * sizeof(int32_t));
+	memset(map->_indices, 0xFF, bucketCount * sizeof(int32_t));
+}
+
+static void glmAddEntityIndex(GlmEntityIndexMap* map, int64_t entityId, int32_t index)
+{
+	uint32_t iBucket = glmHashEntityId(entityId) & map->_bucketMask;
+	while (map->_indices[iBucket] != -1 && map->_entityIds[iBucket] != entityId)
+		iBucket = (iBucket + 1) & map->_bucketMask;
+	if (map->_indices[iBucket] != -1)
+		return; // same id already present : keep the first one, as glmFindEntityInSimulation does
+	map->_entityIds[iBucket] = entityId;
+	map->_indices[iBucket] = index;
+}
+
+static void glmCreateEntityIndexMap(GlmEntityIndexMap* map, const GlmEntityTransform* entityTransforms, unsigned int entityTransformCount)
+{
+	unsigned int i;
+	glmInitEntityIndexMap(map, entityTransformCount);
+	for (i = 0; i < entityTransformCount; i++)
+	{
+		glmAddEntityIndex(map, entityTransforms[i]._entityId, (int32_t)i);
+	}
+}
+
+// same result as glmFindEntityInSimulation
+static int glmFindEntityIndex(const GlmEntityIndexMap* map, int64_t entityId)
+{
+	uint32_t iBucket = glmHashEntityId(entityId) & map->_bucketMask;
+	while (map->_indices[iBucket] != -1)
+	{
+		if (map->_entityIds[iBucket] == entityId)
+			return map->_indices[iBucket];
+		iBucket = (iBucket + 1) & map->_bucketMask;
+	}
+	return -1;
+}
+
+static void glmDestroyEntityIndexMap(GlmEntityIndexMap* map)
+{
+	GLMC_FREE(map->_entityIds);
+	GLMC_FREE(map->_indices);
+	map->_entityIds = NULL;
+	map->_indices = NULL;
+}
+
 void glmConvertMatrix(float* result, const float *translation, const float *rotation)
 {
 	// rotation
@@ -3799,6 +5709,19 @@ void glmConvertMatrix(float* result, const float *translation, const float *rota
 // r = a*b;
 void glmMultMatrix(const float *a, const float *b, float *r)
 {
+#ifdef GLMC_USE_SSE
+	// one row of r per register, same sums in the same order as below. r may alias a or b
+	__m128 b0 = _mm_loadu_ps(b);
+	__m128 b1 = _mm_loadu_ps(b + 4);
+	__m128 b2 = _mm_loadu_ps(b + 8);
+	__m128 b3 = _mm_loadu_ps(b + 12);
+	unsigned int iRow;
+	for (iRow = 0; iRow < 4; iRow++)
+	{
+		__m128 row = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[iRow * 4 + 0]), b0), _mm_mul_ps(_mm_set1_ps(a[iRow * 4 + 1]), b1)), _mm_mul_ps(_mm_set1_ps(a[iRow * 4 + 2]), b2)), _mm_mul_ps(_mm_set1_ps(a[iRow * 4 + 3]), b3));
+		_mm_storeu_ps(r + iRow * 4, row);
+	}
+#else
 	r[0] = a[0]*b[0] + a[1]*b[4] + a[2]*b[8]  + a[3]*b[12];
 	r[1] = a[0]*b[1] + a[1]*b[5] + a[2]*b[9]  + a[3]*b[13];
 	r[2] = a[0]*b[2] + a[1]*b[6] + a[2]*b[10] + a[3]*b[14];
@@ -3818,6 +5741,7 @@ void glmMultMatrix(const float *a, const float *b, float *r)
 	r[13]= a[12]*b[1]+ a[13]*b[5]+ a[14]*b[9] + a[15]*b[13];
 	r[14]= a[12]*b[2]+ a[13]*b[6]+ a[14]*b[10]+ a[15]*b[14];
 	r[15]= a[12]*b[3]+ a[13]*b[7]+ a[14]*b[11]+ a[15]*b[15];
+#endif
 }
 
 //-------------------------------------------------------------------------
@@ -3829,64 +5753,312 @@ void glmTransformPoint(const float *point, const float *matrix, float * destinat
 	//destination[3] = point[0] * matrix[0*4+3] + point[1] * matrix[1*4+3] + point[2] * matrix[2*4+3] + matrix[3*4+3] ;
 }
 
+#ifdef GLMC_USE_SSE
 //-------------------------------------------------------------------------
-void glmMultQuaternion (const float *a ,const float *b, float *r)
+// 4 float[3] (xyzx yzxy zxyz) to one register per component
+static void glmLoadVec3x4(const float *v, __m128 *r)
 {
-	float ww = (a[2] + a[0]) * (b[0] + b[1]);
-	float yy = (a[3] - a[1]) * (b[3] + b[2]);
-	float zz = (a[3] + a[1]) * (b[3] - b[2]);
-	float xx = ww + yy + zz;
-	float qq = 0.5f * (xx + (a[2] - a[0]) * (b[0] - b[1]));
-
-	r[3] = qq - ww + (a[2] - a[1]) * (b[1] - b[2]);
-	r[0] = qq - xx + (a[0] + a[3]) * (b[0] + b[3]);
-	r[1] = qq - yy + (a[3] - a[0]) * (b[1] + b[2]);
-	r[2] = qq - zz + (a[2] + a[1]) * (b[3] - b[0]);
+	__m128 v0 = _mm_loadu_ps(v);
+	__m128 v1 = _mm_loadu_ps(v + 4);
+	__m128 v2 = _mm_loadu_ps(v + 8);
+	__m128 t0 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2));
+	__m128 t1 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1));
+	r[0] = _mm_shuffle_ps(v0, t0, _MM_SHUFFLE(2, 0, 3, 0));
+	r[1] = _mm_shuffle_ps(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));
+	r[2] = _mm_shuffle_ps(t1, v2, _MM_SHUFFLE(3, 0, 3, 1));
 }
 
 //-------------------------------------------------------------------------
-void glmInverseQuaternion (const float *s, float *r)
+static void glmStoreVec3x4(const __m128 *r, float *v)
 {
-	r[0] = s[0];
-	r[1] = s[1];
-	r[2] = s[2];
-	r[3] =-s[3];
+	__m128 t0 = _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(1, 0, 1, 0));
+	__m128 t1 = _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 0, 1, 0));
+	_mm_storeu_ps(v, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 0, 2, 0)));
+	t0 = _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 0, 1, 0));
+	t1 = _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(3, 2, 3, 2));
+	_mm_storeu_ps(v + 4, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 3, 1)));
+	t0 = _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 2, 3, 2));
+	t1 = _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 2, 3, 2));
+	_mm_storeu_ps(v + 8, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 0)));
 }
 
 //-------------------------------------------------------------------------
-void glmNormalizeQuaternion(float *r)
+// m[component * 4 + row] = matrix[row * 4 + component] broadcast, for glmTransformPoint4
+static void glmBroadcastMatrix(const float *matrix, __m128 *m)
 {
-	static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
-	float factor = (1.f / sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2] + r[3]*r[3] + very_small_float));
-	r[0] *= factor;
-	r[1] *= factor;
-	r[2] *= factor;
-	r[3] *= factor;
+	unsigned int iComp, iRow;
+	for (iComp = 0; iComp < 3; iComp++)
+		for (iRow = 0; iRow < 4; iRow++)
+			m[iComp * 4 + iRow] = _mm_set1_ps(matrix[iRow * 4 + iComp]);
 }
 
-
-void glmBuildQuaternion(float angle, const float * axis, float *r)
+//-------------------------------------------------------------------------
+// glmTransformPoint on 4 points, r must not alias p
+static void glmTransformPoint4(const __m128 *p, const __m128 *m, __m128 *r)
 {
-	float sinAngleDiv2 = sinf(angle * 0.5f);
-	float cosAngleDiv2 = cosf(angle * 0.5f);
-	r[0] = sinAngleDiv2 * axis[0];
-	r[1] = sinAngleDiv2 * axis[1];
-	r[2] = sinAngleDiv2 * axis[2];
-	r[3] = cosAngleDiv2;
+	unsigned int iComp;
+	for (iComp = 0; iComp < 3; iComp++)
+		r[iComp] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p[0], m[iComp * 4 + 0]), _mm_mul_ps(p[1], m[iComp * 4 + 1])), _mm_mul_ps(p[2], m[iComp * 4 + 2])), m[iComp * 4 + 3]);
 }
+#endif
 
+#ifdef GLMC_USE_AVX2
 //-------------------------------------------------------------------------
-void glmNormalizeVec3(float *r)
+// AVX versions of the helpers above : 8 elements, the first 4 in the low 128 bit lane and the last 4 in the high one, so the SSE shuffles apply per lane
+GLMC_TARGET_AVX2 static void glmLoadVec3x8(const float *v, __m256 *r)
 {
-	static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
-	float factor = (1.f / sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2] + very_small_float));
-	r[0] *= factor;
-	r[1] *= factor;
-	r[2] *= factor;
+	__m256 v0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(v)), _mm_loadu_ps(v + 12), 1);
+	__m256 v1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(v + 4)), _mm_loadu_ps(v + 16), 1);
+	__m256 v2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(v + 8)), _mm_loadu_ps(v + 20), 1);
+	__m256 t0 = _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2));
+	__m256 t1 = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1));
+	r[0] = _mm256_shuffle_ps(v0, t0, _MM_SHUFFLE(2, 0, 3, 0));
+	r[1] = _mm256_shuffle_ps(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));
+	r[2] = _mm256_shuffle_ps(t1, v2, _MM_SHUFFLE(3, 0, 3, 1));
 }
 
 //-------------------------------------------------------------------------
-//	Quaternion result;     
+GLMC_TARGET_AVX2 static void glmStoreVec3x8(const __m256 *r, float *v)
+{
+	__m256 t0 = _mm256_shuffle_ps(r[0], r[1], _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 t1 = _mm256_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 v0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 0, 2, 0));
+	__m256 v1;
+	__m256 v2;
+	t0 = _mm256_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 0, 1, 0));
+	t1 = _mm256_shuffle_ps(r[0], r[1], _MM_SHUFFLE(3, 2, 3, 2));
+	v1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 3, 1));
+	t0 = _mm256_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 2, 3, 2));
+	t1 = _mm256_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 2, 3, 2));
+	v2 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 0));
+	_mm_storeu_ps(v, _mm256_castps256_ps128(v0));
+	_mm_storeu_ps(v + 4, _mm256_castps256_ps128(v1));
+	_mm_storeu_ps(v + 8, _mm256_castps256_ps128(v2));
+	_mm_storeu_ps(v + 12, _mm256_extractf128_ps(v0, 1));
+	_mm_storeu_ps(v + 16, _mm256_extractf128_ps(v1, 1));
+	_mm_storeu_ps(v + 20, _mm256_extractf128_ps(v2, 1));
+}
+
+//-------------------------------------------------------------------------
+// 4x4 transpose in each lane, r[i] holds elements i and i + 4
+GLMC_TARGET_AVX2 static void glmTranspose4x2(__m256 *r)
+{
+	__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+	__m256 t1 = _mm256_unpacklo_ps(r[2], r[3]);
+	__m256 t2 = _mm256_unpackhi_ps(r[0], r[1]);
+	__m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+	r[0] = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	r[1] = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	r[2] = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r[3] = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmBroadcastMatrix8(const float *matrix, __m256 *m)
+{
+	unsigned int iComp, iRow;
+	for (iComp = 0; iComp < 3; iComp++)
+		for (iRow = 0; iRow < 4; iRow++)
+			m[iComp * 4 + iRow] = _mm256_set1_ps(matrix[iRow * 4 + iComp]);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmTransformPoint8(const __m256 *p, const __m256 *m, __m256 *r)
+{
+	unsigned int iComp;
+	for (iComp = 0; iComp < 3; iComp++)
+		r[iComp] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p[0], m[iComp * 4 + 0]), _mm256_mul_ps(p[1], m[iComp * 4 + 1])), _mm256_mul_ps(p[2], m[iComp * 4 + 2])), m[iComp * 4 + 3]);
+}
+#endif
+
+//-------------------------------------------------------------------------
+// glmTransformPoint + scale around pivot on a contiguous vertex range, boundsMin/boundsMax are extended with the results
+static void glmTransformClothVerticesScalar(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3])
+{
+	uint32_t iVertex;
+	unsigned int iComp;
+
+	for (iVertex = 0; iVertex < vertexCount; iVertex++)
+	{
+		glmTransformPoint(source[iVertex], matrix, destination[iVertex]);
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			float coord = (destination[iVertex][iComp] - scalePivot[iComp]) * scale + scalePivot[iComp];
+			if (coord < boundsMin[iComp]) boundsMin[iComp] = coord;
+			if (coord > boundsMax[iComp]) boundsMax[iComp] = coord;
+			destination[iVertex][iComp] = coord;
+		}
+	}
+}
+
+#ifdef GLMC_USE_SSE
+//-------------------------------------------------------------------------
+static void glmTransformClothVerticesSse2(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3])
+{
+	uint32_t iVertex = 0;
+	unsigned int iComp;
+
+	if (vertexCount >= 4)
+	{
+		__m128 m[12];
+		__m128 pivot[3];
+		__m128 lanesMin[3];
+		__m128 lanesMax[3];
+		const __m128 scaleV = _mm_set1_ps(scale);
+		unsigned int iLane;
+
+		glmBroadcastMatrix(matrix, m);
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			pivot[iComp] = _mm_set1_ps(scalePivot[iComp]);
+			lanesMin[iComp] = _mm_set1_ps(boundsMin[iComp]);
+			lanesMax[iComp] = _mm_set1_ps(boundsMax[iComp]);
+		}
+
+		for (; iVertex + 4 <= vertexCount; iVertex += 4)
+		{
+			__m128 p[3];
+			__m128 r[3];
+
+			glmLoadVec3x4(source[iVertex], p);
+			glmTransformPoint4(p, m, r);
+			for (iComp = 0; iComp < 3; iComp++)
+			{
+				r[iComp] = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r[iComp], pivot[iComp]), scaleV), pivot[iComp]);
+				lanesMin[iComp] = _mm_min_ps(lanesMin[iComp], r[iComp]);
+				lanesMax[iComp] = _mm_max_ps(lanesMax[iComp], r[iComp]);
+			}
+			glmStoreVec3x4(r, destination[iVertex]);
+		}
+
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			float lanes[4];
+			_mm_storeu_ps(lanes, lanesMin[iComp]);
+			for (iLane = 0; iLane < 4; iLane++)
+				if (lanes[iLane] < boundsMin[iComp]) boundsMin[iComp] = lanes[iLane];
+			_mm_storeu_ps(lanes, lanesMax[iComp]);
+			for (iLane = 0; iLane < 4; iLane++)
+				if (lanes[iLane] > boundsMax[iComp]) boundsMax[iComp] = lanes[iLane];
+		}
+	}
+	glmTransformClothVerticesScalar(source + iVertex, destination + iVertex, vertexCount - iVertex, matrix, scalePivot, scale, boundsMin, boundsMax);
+}
+#endif
+
+#ifdef GLMC_USE_AVX2
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmTransformClothVerticesAvx2(const float(*source)[3], float(*destination)[3], uint32_t vertexCount, const float* matrix, const float scalePivot[3], float scale, float boundsMin[3], float boundsMax[3])
+{
+	uint32_t iVertex = 0;
+	unsigned int iComp;
+
+	if (vertexCount >= 8)
+	{
+		__m256 m[12];
+		__m256 pivot[3];
+		__m256 lanesMin[3];
+		__m256 lanesMax[3];
+		const __m256 scaleV = _mm256_set1_ps(scale);
+		unsigned int iLane;
+
+		glmBroadcastMatrix8(matrix, m);
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			pivot[iComp] = _mm256_set1_ps(scalePivot[iComp]);
+			lanesMin[iComp] = _mm256_set1_ps(boundsMin[iComp]);
+			lanesMax[iComp] = _mm256_set1_ps(boundsMax[iComp]);
+		}
+
+		for (; iVertex + 8 <= vertexCount; iVertex += 8)
+		{
+			__m256 p[3];
+			__m256 r[3];
+
+			glmLoadVec3x8(source[iVertex], p);
+			glmTransformPoint8(p, m, r);
+			for (iComp = 0; iComp < 3; iComp++)
+			{
+				r[iComp] = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(r[iComp], pivot[iComp]), scaleV), pivot[iComp]);
+				lanesMin[iComp] = _mm256_min_ps(lanesMin[iComp], r[iComp]);
+				lanesMax[iComp] = _mm256_max_ps(lanesMax[iComp], r[iComp]);
+			}
+			glmStoreVec3x8(r, destination[iVertex]);
+		}
+
+		for (iComp = 0; iComp < 3; iComp++)
+		{
+			float lanes[8];
+			_mm256_storeu_ps(lanes, lanesMin[iComp]);
+			for (iLane = 0; iLane < 8; iLane++)
+				if (lanes[iLane] < boundsMin[iComp]) boundsMin[iComp] = lanes[iLane];
+			_mm256_storeu_ps(lanes, lanesMax[iComp]);
+			for (iLane = 0; iLane < 8; iLane++)
+				if (lanes[iLane] > boundsMax[iComp]) boundsMax[iComp] = lanes[iLane];
+		}
+	}
+	glmTransformClothVerticesSse2(source + iVertex, destination + iVertex, vertexCount - iVertex, matrix, scalePivot, scale, boundsMin, boundsMax);
+}
+#endif
+
+//-------------------------------------------------------------------------
+void glmMultQuaternion (const float *a ,const float *b, float *r)
+{
+	float ww = (a[2] + a[0]) * (b[0] + b[1]);
+	float yy = (a[3] - a[1]) * (b[3] + b[2]);
+	float zz = (a[3] + a[1]) * (b[3] - b[2]);
+	float xx = ww + yy + zz;
+	float qq = 0.5f * (xx + (a[2] - a[0]) * (b[0] - b[1]));
+
+	r[3] = qq - ww + (a[2] - a[1]) * (b[1] - b[2]);
+	r[0] = qq - xx + (a[0] + a[3]) * (b[0] + b[3]);
+	r[1] = qq - yy + (a[3] - a[0]) * (b[1] + b[2]);
+	r[2] = qq - zz + (a[2] + a[1]) * (b[3] - b[0]);
+}
+
+//-------------------------------------------------------------------------
+void glmInverseQuaternion (const float *s, float *r)
+{
+	r[0] = s[0];
+	r[1] = s[1];
+	r[2] = s[2];
+	r[3] =-s[3];
+}
+
+//-------------------------------------------------------------------------
+void glmNormalizeQuaternion(float *r)
+{
+	static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
+	float factor = (1.f / sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2] + r[3]*r[3] + very_small_float));
+	r[0] *= factor;
+	r[1] *= factor;
+	r[2] *= factor;
+	r[3] *= factor;
+}
+
+
+void glmBuildQuaternion(float angle, const float * axis, float *r)
+{
+	float sinAngleDiv2 = sinf(angle * 0.5f);
+	float cosAngleDiv2 = cosf(angle * 0.5f);
+	r[0] = sinAngleDiv2 * axis[0];
+	r[1] = sinAngleDiv2 * axis[1];
+	r[2] = sinAngleDiv2 * axis[2];
+	r[3] = cosAngleDiv2;
+}
+
+//-------------------------------------------------------------------------
+void glmNormalizeVec3(float *r)
+{
+	static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
+	float factor = (1.f / sqrtf(r[0]*r[0] + r[1]*r[1] + r[2]*r[2] + very_small_float));
+	r[0] *= factor;
+	r[1] *= factor;
+	r[2] *= factor;
+}
+
+//-------------------------------------------------------------------------
+//	Quaternion result;     
 //	Vector3 H = from;
 //	H += to;     
 //	H.normalizeSelf();  
@@ -3991,136 +6163,558 @@ void glmMultVec3Quaternion(const float *rot, const float *pos, float *r)
 	r[2] = (xz - wy) * pos[0] + (yz + wx) * pos[1] + (1.f - (xx + yy)) * pos[2];
 }
 
+#ifdef GLMC_USE_SSE
+//-------------------------------------------------------------------------
+// 4 quaternions / vectors at once, one register per component (x, y, z, w). Same operations in the same order as the scalar versions.
+// r may alias a or b
+static void glmMultQuaternion4(const __m128 *a, const __m128 *b, __m128 *r)
+{
+	__m128 ww = _mm_mul_ps(_mm_add_ps(a[2], a[0]), _mm_add_ps(b[0], b[1]));
+	__m128 yy = _mm_mul_ps(_mm_sub_ps(a[3], a[1]), _mm_add_ps(b[3], b[2]));
+	__m128 zz = _mm_mul_ps(_mm_add_ps(a[3], a[1]), _mm_sub_ps(b[3], b[2]));
+	__m128 xx = _mm_add_ps(_mm_add_ps(ww, yy), zz);
+	__m128 qq = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_add_ps(xx, _mm_mul_ps(_mm_sub_ps(a[2], a[0]), _mm_sub_ps(b[0], b[1]))));
+	__m128 r3 = _mm_add_ps(_mm_sub_ps(qq, ww), _mm_mul_ps(_mm_sub_ps(a[2], a[1]), _mm_sub_ps(b[1], b[2])));
+	__m128 r0 = _mm_add_ps(_mm_sub_ps(qq, xx), _mm_mul_ps(_mm_add_ps(a[0], a[3]), _mm_add_ps(b[0], b[3])));
+	__m128 r1 = _mm_add_ps(_mm_sub_ps(qq, yy), _mm_mul_ps(_mm_sub_ps(a[3], a[0]), _mm_add_ps(b[1], b[2])));
+	__m128 r2 = _mm_add_ps(_mm_sub_ps(qq, zz), _mm_mul_ps(_mm_add_ps(a[2], a[1]), _mm_sub_ps(b[3], b[0])));
+	r[0] = r0;
+	r[1] = r1;
+	r[2] = r2;
+	r[3] = r3;
+}
 
-float interpolateFloat(float value1, float value2, float ratio)
+//-------------------------------------------------------------------------
+static void glmNormalizeQuaternion4(__m128 *r)
 {
-	return value1 + (value2 - value1) * ratio;
+	__m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])), _mm_mul_ps(r[2], r[2])), _mm_mul_ps(r[3], r[3])), _mm_set1_ps(1.0e-037f));
+	__m128 factor = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(sum));
+	r[0] = _mm_mul_ps(r[0], factor);
+	r[1] = _mm_mul_ps(r[1], factor);
+	r[2] = _mm_mul_ps(r[2], factor);
+	r[3] = _mm_mul_ps(r[3], factor);
 }
 
 //-------------------------------------------------------------------------
-void interpolateNFloats(float* value1, float *value2, float ratio, float *res, int count)
+// r must not alias rot or pos
+static void glmMultVec3Quaternion4(const __m128 *rot, const __m128 *pos, __m128 *r)
 {
-	int i;
-	for (i = 0; i < count; i++)
+	const __m128 one = _mm_set1_ps(1.f);
+	__m128 x2 = _mm_add_ps(rot[0], rot[0]);
+	__m128 y2 = _mm_add_ps(rot[1], rot[1]);
+	__m128 z2 = _mm_add_ps(rot[2], rot[2]);
+	__m128 xx = _mm_mul_ps(rot[0], x2);
+	__m128 xy = _mm_mul_ps(rot[0], y2);
+	__m128 xz = _mm_mul_ps(rot[0], z2);
+	__m128 yy = _mm_mul_ps(rot[1], y2);
+	__m128 yz = _mm_mul_ps(rot[1], z2);
+	__m128 zz = _mm_mul_ps(rot[2], z2);
+	__m128 wx = _mm_mul_ps(rot[3], x2);
+	__m128 wy = _mm_mul_ps(rot[3], y2);
+	__m128 wz = _mm_mul_ps(rot[3], z2);
+
+	r[0] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), pos[0]), _mm_mul_ps(_mm_sub_ps(xy, wz), pos[1])), _mm_mul_ps(_mm_add_ps(xz, wy), pos[2]));
+	r[1] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(xy, wz), pos[0]), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), pos[1])), _mm_mul_ps(_mm_sub_ps(yz, wx), pos[2]));
+	r[2] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(xz, wy), pos[0]), _mm_mul_ps(_mm_add_ps(yz, wx), pos[1])), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), pos[2]));
+}
+#endif
+
+#ifdef GLMC_USE_AVX2
+//-------------------------------------------------------------------------
+// AVX versions of the helpers above, 8 quaternions / vectors at once
+GLMC_TARGET_AVX2 static void glmMultQuaternion8(const __m256 *a, const __m256 *b, __m256 *r)
+{
+	__m256 ww = _mm256_mul_ps(_mm256_add_ps(a[2], a[0]), _mm256_add_ps(b[0], b[1]));
+	__m256 yy = _mm256_mul_ps(_mm256_sub_ps(a[3], a[1]), _mm256_add_ps(b[3], b[2]));
+	__m256 zz = _mm256_mul_ps(_mm256_add_ps(a[3], a[1]), _mm256_sub_ps(b[3], b[2]));
+	__m256 xx = _mm256_add_ps(_mm256_add_ps(ww, yy), zz);
+	__m256 qq = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_add_ps(xx, _mm256_mul_ps(_mm256_sub_ps(a[2], a[0]), _mm256_sub_ps(b[0], b[1]))));
+	__m256 r3 = _mm256_add_ps(_mm256_sub_ps(qq, ww), _mm256_mul_ps(_mm256_sub_ps(a[2], a[1]), _mm256_sub_ps(b[1], b[2])));
+	__m256 r0 = _mm256_add_ps(_mm256_sub_ps(qq, xx), _mm256_mul_ps(_mm256_add_ps(a[0], a[3]), _mm256_add_ps(b[0], b[3])));
+	__m256 r1 = _mm256_add_ps(_mm256_sub_ps(qq, yy), _mm256_mul_ps(_mm256_sub_ps(a[3], a[0]), _mm256_add_ps(b[1], b[2])));
+	__m256 r2 = _mm256_add_ps(_mm256_sub_ps(qq, zz), _mm256_mul_ps(_mm256_add_ps(a[2], a[1]), _mm256_sub_ps(b[3], b[0])));
+	r[0] = r0;
+	r[1] = r1;
+	r[2] = r2;
+	r[3] = r3;
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmNormalizeQuaternion8(__m256 *r)
+{
+	__m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], r[0]), _mm256_mul_ps(r[1], r[1])), _mm256_mul_ps(r[2], r[2])), _mm256_mul_ps(r[3], r[3])), _mm256_set1_ps(1.0e-037f));
+	__m256 factor = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(sum));
+	r[0] = _mm256_mul_ps(r[0], factor);
+	r[1] = _mm256_mul_ps(r[1], factor);
+	r[2] = _mm256_mul_ps(r[2], factor);
+	r[3] = _mm256_mul_ps(r[3], factor);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmMultVec3Quaternion8(const __m256 *rot, const __m256 *pos, __m256 *r)
+{
+	const __m256 one = _mm256_set1_ps(1.f);
+	__m256 x2 = _mm256_add_ps(rot[0], rot[0]);
+	__m256 y2 = _mm256_add_ps(rot[1], rot[1]);
+	__m256 z2 = _mm256_add_ps(rot[2], rot[2]);
+	__m256 xx = _mm256_mul_ps(rot[0], x2);
+	__m256 xy = _mm256_mul_ps(rot[0], y2);
+	__m256 xz = _mm256_mul_ps(rot[0], z2);
+	__m256 yy = _mm256_mul_ps(rot[1], y2);
+	__m256 yz = _mm256_mul_ps(rot[1], z2);
+	__m256 zz = _mm256_mul_ps(rot[2], z2);
+	__m256 wx = _mm256_mul_ps(rot[3], x2);
+	__m256 wy = _mm256_mul_ps(rot[3], y2);
+	__m256 wz = _mm256_mul_ps(rot[3], z2);
+
+	r[0] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), pos[0]), _mm256_mul_ps(_mm256_sub_ps(xy, wz), pos[1])), _mm256_mul_ps(_mm256_add_ps(xz, wy), pos[2]));
+	r[1] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(xy, wz), pos[0]), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), pos[1])), _mm256_mul_ps(_mm256_sub_ps(yz, wx), pos[2]));
+	r[2] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(xz, wy), pos[0]), _mm256_mul_ps(_mm256_add_ps(yz, wx), pos[1])), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), pos[2]));
+}
+
+//-------------------------------------------------------------------------
+// 8 float[4] to one register per component, in the glmTranspose4x2 layout
+GLMC_TARGET_AVX2 static void glmLoadVec4x8(const float(*v)[4], __m256 *r)
+{
+	unsigned int iComp;
+	for (iComp = 0; iComp < 4; iComp++)
+		r[iComp] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(v[iComp])), _mm_loadu_ps(v[iComp + 4]), 1);
+	glmTranspose4x2(r);
+}
+
+//-------------------------------------------------------------------------
+// r is transposed in place
+GLMC_TARGET_AVX2 static void glmStoreVec4x8(__m256 *r, float(*v)[4])
+{
+	unsigned int iComp;
+	glmTranspose4x2(r);
+	for (iComp = 0; iComp < 4; iComp++)
 	{
-		res[i] = value1[i] + (value2[i] - value1[i]) * ratio;
+		_mm_storeu_ps(v[iComp], _mm256_castps256_ps128(r[iComp]));
+		_mm_storeu_ps(v[iComp + 4], _mm256_extractf128_ps(r[iComp], 1));
 	}
 }
+#endif
 
 //-------------------------------------------------------------------------
-void glmComputeRestRelativesOrientationFromPosture(const float(*worldOrientations)[4], const float(*boneLocalOri)[4], uint32_t *parentIndex, const float(worldOrientation)[4], float(*restRelativeOrientations)[4], unsigned int boneCount)
+// Array forms of the helpers above, with the same results as the per element calls. Destination arrays may be the source arrays.
+// Dispatched to the glmSimdKernels variants
+
+//-------------------------------------------------------------------------
+static void glmTransformPointsScalar(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count)
 {
-	float worldOrientationInverse[4];
 	unsigned int i;
-
-	//root bone:
-	//worldPositions[0] = worldPosition + worldOrientation * bones[0]->getLocalPos();
-	glmInverseQuaternion(worldOrientation, worldOrientationInverse);
-	glmMultQuaternion(worldOrientationInverse, &(*worldOrientations)[0], &(*restRelativeOrientations)[0]);
-	glmNormalizeQuaternion(restRelativeOrientations[0]);
-	//other bones:
-	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
-	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
-	for (i = 1; i < boneCount; ++i)
+	for (i = 0; i < count; i++)
 	{
-		float parentOri[4];
-		float parentOriInverse[4];
-		int boneParentIndex = parentIndex[i]>>16;
-		glmMultQuaternion( &*worldOrientations[boneParentIndex], boneLocalOri[i], parentOri);
-		glmInverseQuaternion(parentOri, parentOriInverse);
-		glmMultQuaternion( parentOriInverse, worldOrientations[i], restRelativeOrientations[i]);
-		glmNormalizeQuaternion(restRelativeOrientations[i]);
+		float point[3];
+		memcpy(point, points[i], sizeof(float) * 3);
+		glmTransformPoint(point, matrix, destination[i]);
 	}
 }
 
-void glmComputePostureFromRestRelativeOrientations(float(*worldPositions)[3], float(*worldOrientations)[4], const float(*boneLocalOri)[4], const float(*boneLocalPosUnscaled)[3], uint32_t *parentIndex, float worldPosition[3], float worldOrientation[4], const float(*restRelativeOrientations)[4], const float skeletonScale, unsigned int boneCount)
+//-------------------------------------------------------------------------
+static void glmMultQuaternionsScalar(const float *a, const float(*b)[4], float(*r)[4], unsigned int count)
 {
 	unsigned int i;
-	//root bone:
-	memcpy(worldOrientations[0], worldOrientation, sizeof(float) *4);	// * restRelativeOrientations[0]; //NOTE: bones[0]->getLocalOri() is pre-multiplied in restRelativeOrientations[0]
-	memcpy(worldPositions[0], worldPosition, sizeof(float) *3);	// + worldOrientation * bones[0]->getLocalPosUnscaled() * skeletonScale;
-
-	//other bones:
-	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
-	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
-	for (i = 1; i < boneCount; ++i)
+	for (i = 0; i < count; i++)
 	{
-		float ori[4];
-		float pos[3];
-		float posScaled[3];
-
-		int boneParentIndex = parentIndex[i]>>16;
-		
-		glmMultQuaternion( worldOrientations[boneParentIndex], boneLocalOri[i], ori);
-		glmMultQuaternion( ori, restRelativeOrientations[i], worldOrientations[i]);
-
-		glmMultVec3Scalar(boneLocalPosUnscaled[i], skeletonScale, posScaled);
-		glmMultVec3Quaternion(worldOrientations[boneParentIndex], posScaled, pos);
-		glmAddVec3(worldPositions[boneParentIndex], pos, worldPositions[i]);
+		float quaternion[4];
+		memcpy(quaternion, b[i], sizeof(float) * 4);
+		glmMultQuaternion(a, quaternion, r[i]);
 	}
 }
 
-void glmComputePostureFromRestRelativeOrientationsScales(float(*worldPositions)[3], float(*worldOrientations)[4], const float(*boneLocalOri)[4], const float(*boneLocalPosUnscaled)[3], uint32_t *parentIndex, float worldPosition[3], float worldOrientation[4], const float(*restRelativeOrientations)[4], const float skeletonScale, unsigned int boneCount, const float(*boneScales)[4])
+//-------------------------------------------------------------------------
+static void glmNormalizeQuaternionsScalar(float(*r)[4], unsigned int count)
 {
 	unsigned int i;
-	//root bone:
-	memcpy(worldOrientations[0], worldOrientation, sizeof(float) * 4);	// * restRelativeOrientations[0]; //NOTE: bones[0]->getLocalOri() is pre-multiplied in restRelativeOrientations[0]
-	memcpy(worldPositions[0], worldPosition, sizeof(float) * 3);	// + worldOrientation * bones[0]->getLocalPosUnscaled() * skeletonScale;
+	for (i = 0; i < count; i++)
+		glmNormalizeQuaternion(r[i]);
+}
 
-	//other bones:
-	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
-	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
-	for (i = 1; i < boneCount; ++i)
+//-------------------------------------------------------------------------
+static void glmMultVec3QuaternionsScalar(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count)
+{
+	unsigned int i;
+	for (i = 0; i < count; i++)
 	{
-		float ori[4];
-		float pos[3];
-
-		float localPos[3];
-		float posScaled[3];
-		
-		int boneParentIndex = parentIndex[i]>>16;
-		glmMultQuaternion( &*worldOrientations[boneParentIndex], boneLocalOri[i], ori);
-		glmMultQuaternion( ori, restRelativeOrientations[i], worldOrientations[i]);
-
-		glmMultVec3Scalar(boneLocalPosUnscaled[i], boneScales[boneParentIndex][3], localPos);
-
-		glmMultVec3Scalar(localPos, skeletonScale, posScaled);
-		glmMultVec3Quaternion(worldOrientations[boneParentIndex], posScaled, pos);
-		glmAddVec3(worldPositions[boneParentIndex], pos, worldPositions[i]);
+		float position[3];
+		memcpy(position, pos[i], sizeof(float) * 3);
+		glmMultVec3Quaternion(rot, position, r[i]);
 	}
 }
 
-void glmAllocateEntityTransformBoneEdit(GlmEntityTransform* tr, unsigned int boneCount, GlmEntityTransform* trSource)
+//-------------------------------------------------------------------------
+// the SIMD variants sum in the same order, without fused multiply-add
+static void glmCullBoxesScalar(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside)
 {
-	unsigned int iLocal;
-	
-	tr->_boneRestRelativeOrientation = (float(*)[4])GLMC_MALLOC(boneCount * sizeof(float[4]));
-	tr->_boneRestRelativePosition = (float(*)[3])GLMC_MALLOC(boneCount * sizeof(float[3]));
-	if (trSource == NULL)
+	unsigned int i;
+	int iPlane;
+	for (i = first; i < last; i++)
 	{
-		for (iLocal = 0; iLocal < boneCount; iLocal++)
+		uint8_t isOutside = 0;
+		for (iPlane = 0; iPlane < 6; iPlane++)
 		{
-			glmSetIdentityQuaternion(tr->_boneRestRelativeOrientation[iLocal]);
-
-			tr->_boneRestRelativePosition[iLocal][0] = 0.f;
-			tr->_boneRestRelativePosition[iLocal][1] = 0.f;
-			tr->_boneRestRelativePosition[iLocal][2] = 0.f;
+			float distance = (centers[0][i] * planes[iPlane][0] + centers[1][i] * planes[iPlane][1]) + (centers[2][i] * planes[iPlane][2] + planes[iPlane][3]);
+			float radius = (extents[0][i] * fabsf(planes[iPlane][0]) + extents[1][i] * fabsf(planes[iPlane][1])) + extents[2][i] * fabsf(planes[iPlane][2]);
+			isOutside |= (uint8_t)(distance + radius < 0.f);
 		}
-	}
-	else
-	{
-		memcpy(tr->_boneRestRelativeOrientation, trSource->_boneRestRelativeOrientation, boneCount * sizeof(float[4]));
-		memcpy(tr->_boneRestRelativePosition, trSource->_boneRestRelativePosition, boneCount * sizeof(float[3]));
+		outside[i - first] = isOutside;
 	}
 }
 
-//---------------------------------------------------------------------------
-void glmCopyTransform(GlmSimulationData* simulationData, GlmEntityTransform* transformDestination, GlmEntityTransform* transformSource)
+#ifdef GLMC_USE_SSE
+//-------------------------------------------------------------------------
+static void glmTransformPointsSse2(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count)
 {
-	unsigned int boneCount = simulationData->_boneCount[simulationData->_entityTypes[transformSource->_sourceIndexInCrowdField]];
-	// duplicate matrices
-	memcpy(&transformDestination->_matrixBase, &transformSource->_matrixBase, sizeof(float) * 16);
-	transformDestination->_scale = transformSource->_scale;
+	unsigned int i = 0;
+	__m128 m[12];
+	glmBroadcastMatrix(matrix, m);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 p[3];
+		__m128 r[3];
+		glmLoadVec3x4(points[i], p);
+		glmTransformPoint4(p, m, r);
+		glmStoreVec3x4(r, destination[i]);
+	}
+	glmTransformPointsScalar(points + i, matrix, destination + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+static void glmMultQuaternionsSse2(const float *a, const float(*b)[4], float(*r)[4], unsigned int count)
+{
+	unsigned int i = 0;
+	__m128 aV[4];
+	aV[0] = _mm_set1_ps(a[0]);
+	aV[1] = _mm_set1_ps(a[1]);
+	aV[2] = _mm_set1_ps(a[2]);
+	aV[3] = _mm_set1_ps(a[3]);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 q[4];
+		q[0] = _mm_loadu_ps(b[i]);
+		q[1] = _mm_loadu_ps(b[i + 1]);
+		q[2] = _mm_loadu_ps(b[i + 2]);
+		q[3] = _mm_loadu_ps(b[i + 3]);
+		_MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+		glmMultQuaternion4(aV, q, q);
+		_MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+		_mm_storeu_ps(r[i], q[0]);
+		_mm_storeu_ps(r[i + 1], q[1]);
+		_mm_storeu_ps(r[i + 2], q[2]);
+		_mm_storeu_ps(r[i + 3], q[3]);
+	}
+	glmMultQuaternionsScalar(a, b + i, r + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+static void glmNormalizeQuaternionsSse2(float(*r)[4], unsigned int count)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 q[4];
+		q[0] = _mm_loadu_ps(r[i]);
+		q[1] = _mm_loadu_ps(r[i + 1]);
+		q[2] = _mm_loadu_ps(r[i + 2]);
+		q[3] = _mm_loadu_ps(r[i + 3]);
+		_MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+		glmNormalizeQuaternion4(q);
+		_MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+		_mm_storeu_ps(r[i], q[0]);
+		_mm_storeu_ps(r[i + 1], q[1]);
+		_mm_storeu_ps(r[i + 2], q[2]);
+		_mm_storeu_ps(r[i + 3], q[3]);
+	}
+	glmNormalizeQuaternionsScalar(r + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+static void glmMultVec3QuaternionsSse2(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count)
+{
+	unsigned int i = 0;
+	__m128 rotV[4];
+	rotV[0] = _mm_set1_ps(rot[0]);
+	rotV[1] = _mm_set1_ps(rot[1]);
+	rotV[2] = _mm_set1_ps(rot[2]);
+	rotV[3] = _mm_set1_ps(rot[3]);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 p[3];
+		__m128 result[3];
+		glmLoadVec3x4(pos[i], p);
+		glmMultVec3Quaternion4(rotV, p, result);
+		glmStoreVec3x4(result, r[i]);
+	}
+	glmMultVec3QuaternionsScalar(rot, pos + i, r + i, count - i);
+}
+#endif
+
+#ifdef GLMC_USE_AVX2
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmTransformPointsAvx2(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count)
+{
+	unsigned int i = 0;
+	__m256 m[12];
+	glmBroadcastMatrix8(matrix, m);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 p[3];
+		__m256 r[3];
+		glmLoadVec3x8(points[i], p);
+		glmTransformPoint8(p, m, r);
+		glmStoreVec3x8(r, destination[i]);
+	}
+	glmTransformPointsSse2(points + i, matrix, destination + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmMultQuaternionsAvx2(const float *a, const float(*b)[4], float(*r)[4], unsigned int count)
+{
+	unsigned int i = 0;
+	__m256 aV[4];
+	aV[0] = _mm256_set1_ps(a[0]);
+	aV[1] = _mm256_set1_ps(a[1]);
+	aV[2] = _mm256_set1_ps(a[2]);
+	aV[3] = _mm256_set1_ps(a[3]);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 q[4];
+		glmLoadVec4x8(b + i, q);
+		glmMultQuaternion8(aV, q, q);
+		glmStoreVec4x8(q, r + i);
+	}
+	glmMultQuaternionsSse2(a, b + i, r + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmNormalizeQuaternionsAvx2(float(*r)[4], unsigned int count)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 q[4];
+		glmLoadVec4x8(r + i, q);
+		glmNormalizeQuaternion8(q);
+		glmStoreVec4x8(q, r + i);
+	}
+	glmNormalizeQuaternionsSse2(r + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmMultVec3QuaternionsAvx2(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count)
+{
+	unsigned int i = 0;
+	__m256 rotV[4];
+	rotV[0] = _mm256_set1_ps(rot[0]);
+	rotV[1] = _mm256_set1_ps(rot[1]);
+	rotV[2] = _mm256_set1_ps(rot[2]);
+	rotV[3] = _mm256_set1_ps(rot[3]);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 p[3];
+		__m256 result[3];
+		glmLoadVec3x8(pos[i], p);
+		glmMultVec3Quaternion8(rotV, p, result);
+		glmStoreVec3x8(result, r[i]);
+	}
+	glmMultVec3QuaternionsSse2(rot, pos + i, r + i, count - i);
+}
+
+//-------------------------------------------------------------------------
+GLMC_TARGET_AVX2 static void glmCullBoxesAvx2(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside)
+{
+	unsigned int i = first;
+	for (; i + 8 <= last; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(centers[0] + i);
+		__m256 cy = _mm256_loadu_ps(centers[1] + i);
+		__m256 cz = _mm256_loadu_ps(centers[2] + i);
+		__m256 ex = _mm256_loadu_ps(extents[0] + i);
+		__m256 ey = _mm256_loadu_ps(extents[1] + i);
+		__m256 ez = _mm256_loadu_ps(extents[2] + i);
+		__m256 isOutside = _mm256_setzero_ps();
+		int iPlane, mask, k;
+		for (iPlane = 0; iPlane < 6; iPlane++)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(planes[iPlane][0])), _mm256_mul_ps(cy, _mm256_set1_ps(planes[iPlane][1]))),
+				_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(planes[iPlane][2])), _mm256_set1_ps(planes[iPlane][3])));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(fabsf(planes[iPlane][0]))), _mm256_mul_ps(ey, _mm256_set1_ps(fabsf(planes[iPlane][1])))),
+				_mm256_mul_ps(ez, _mm256_set1_ps(fabsf(planes[iPlane][2]))));
+			isOutside = _mm256_or_ps(isOutside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+		mask = _mm256_movemask_ps(isOutside);
+		for (k = 0; k < 8; k++)
+			outside[i - first + k] = (uint8_t)((mask >> k) & 1);
+	}
+	glmCullBoxesSse2(centers, extents, i, last, planes, outside + (i - first));
+}
+#endif
+
+//-------------------------------------------------------------------------
+// destination[i] = glmTransformPoint(points[i], matrix)
+void glmTransformPoints(const float(*points)[3], const float *matrix, float(*destination)[3], unsigned int count)
+{
+	glmSimdKernels->_transformPoints(points, matrix, destination, count);
+}
+
+//-------------------------------------------------------------------------
+// r[i] = a * b[i]
+void glmMultQuaternions(const float *a, const float(*b)[4], float(*r)[4], unsigned int count)
+{
+	glmSimdKernels->_multQuaternions(a, b, r, count);
+}
+
+//-------------------------------------------------------------------------
+void glmNormalizeQuaternions(float(*r)[4], unsigned int count)
+{
+	glmSimdKernels->_normalizeQuaternions(r, count);
+}
+
+//-------------------------------------------------------------------------
+// r[i] = glmMultVec3Quaternion(rot, pos[i])
+void glmMultVec3Quaternions(const float *rot, const float(*pos)[3], float(*r)[3], unsigned int count)
+{
+	glmSimdKernels->_multVec3Quaternions(rot, pos, r, count);
+}
+
+//-------------------------------------------------------------------------
+void glmCullBoxes(float* const centers[3], float* const extents[3], unsigned int first, unsigned int last, const float planes[6][4], uint8_t* outside)
+{
+	glmSimdKernels->_cullBoxes(centers, extents, first, last, planes, outside);
+}
+
+
+float interpolateFloat(float value1, float value2, float ratio)
+{
+	return value1 + (value2 - value1) * ratio;
+}
+
+//-------------------------------------------------------------------------
+void interpolateNFloats(float* value1, float *value2, float ratio, float *res, int count)
+{
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		res[i] = value1[i] + (value2[i] - value1[i]) * ratio;
+	}
+}
+
+//-------------------------------------------------------------------------
+void glmComputeRestRelativesOrientationFromPosture(const float(*worldOrientations)[4], const float(*boneLocalOri)[4], uint32_t *parentIndex, const float(worldOrientation)[4], float(*restRelativeOrientations)[4], unsigned int boneCount)
+{
+	float worldOrientationInverse[4];
+	unsigned int i;
+
+	//root bone:
+	//worldPositions[0] = worldPosition + worldOrientation * bones[0]->getLocalPos();
+	glmInverseQuaternion(worldOrientation, worldOrientationInverse);
+	glmMultQuaternion(worldOrientationInverse, &(*worldOrientations)[0], &(*restRelativeOrientations)[0]);
+	glmNormalizeQuaternion(restRelativeOrientations[0]);
+	//other bones:
+	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
+	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
+	for (i = 1; i < boneCount; ++i)
+	{
+		float parentOri[4];
+		float parentOriInverse[4];
+		int boneParentIndex = parentIndex[i]>>16;
+		glmMultQuaternion( &*worldOrientations[boneParentIndex], boneLocalOri[i], parentOri);
+		glmInverseQuaternion(parentOri, parentOriInverse);
+		glmMultQuaternion( parentOriInverse, worldOrientations[i], restRelativeOrientations[i]);
+		glmNormalizeQuaternion(restRelativeOrientations[i]);
+	}
+}
+
+void glmComputePostureFromRestRelativeOrientations(float(*worldPositions)[3], float(*worldOrientations)[4], const float(*boneLocalOri)[4], const float(*boneLocalPosUnscaled)[3], uint32_t *parentIndex, float worldPosition[3], float worldOrientation[4], const float(*restRelativeOrientations)[4], const float skeletonScale, unsigned int boneCount)
+{
+	unsigned int i;
+	//root bone:
+	memcpy(worldOrientations[0], worldOrientation, sizeof(float) *4);	// * restRelativeOrientations[0]; //NOTE: bones[0]->getLocalOri() is pre-multiplied in restRelativeOrientations[0]
+	memcpy(worldPositions[0], worldPosition, sizeof(float) *3);	// + worldOrientation * bones[0]->getLocalPosUnscaled() * skeletonScale;
+
+	//other bones:
+	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
+	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
+	for (i = 1; i < boneCount; ++i)
+	{
+		float ori[4];
+		float pos[3];
+		float posScaled[3];
+
+		int boneParentIndex = parentIndex[i]>>16;
+		
+		glmMultQuaternion( worldOrientations[boneParentIndex], boneLocalOri[i], ori);
+		glmMultQuaternion( ori, restRelativeOrientations[i], worldOrientations[i]);
+
+		glmMultVec3Scalar(boneLocalPosUnscaled[i], skeletonScale, posScaled);
+		glmMultVec3Quaternion(worldOrientations[boneParentIndex], posScaled, pos);
+		glmAddVec3(worldPositions[boneParentIndex], pos, worldPositions[i]);
+	}
+}
+
+void glmComputePostureFromRestRelativeOrientationsScales(float(*worldPositions)[3], float(*worldOrientations)[4], const float(*boneLocalOri)[4], const float(*boneLocalPosUnscaled)[3], uint32_t *parentIndex, float worldPosition[3], float worldOrientation[4], const float(*restRelativeOrientations)[4], const float skeletonScale, unsigned int boneCount, const float(*boneScales)[4])
+{
+	unsigned int i;
+	//root bone:
+	memcpy(worldOrientations[0], worldOrientation, sizeof(float) * 4);	// * restRelativeOrientations[0]; //NOTE: bones[0]->getLocalOri() is pre-multiplied in restRelativeOrientations[0]
+	memcpy(worldPositions[0], worldPosition, sizeof(float) * 3);	// + worldOrientation * bones[0]->getLocalPosUnscaled() * skeletonScale;
+
+	//other bones:
+	//WO(bone) = WO(bone->father) * bone->getLocalOri() * PO(bone)
+	//WP(bone) = WP(bone->father) + WO(bone->father) * bone->getLocalPos()
+	for (i = 1; i < boneCount; ++i)
+	{
+		float ori[4];
+		float pos[3];
+
+		float localPos[3];
+		float posScaled[3];
+		
+		int boneParentIndex = parentIndex[i]>>16;
+		glmMultQuaternion( &*worldOrientations[boneParentIndex], boneLocalOri[i], ori);
+		glmMultQuaternion( ori, restRelativeOrientations[i], worldOrientations[i]);
+
+		glmMultVec3Scalar(boneLocalPosUnscaled[i], boneScales[boneParentIndex][3], localPos);
+
+		glmMultVec3Scalar(localPos, skeletonScale, posScaled);
+		glmMultVec3Quaternion(worldOrientations[boneParentIndex], posScaled, pos);
+		glmAddVec3(worldPositions[boneParentIndex], pos, worldPositions[i]);
+	}
+}
+
+void glmAllocateEntityTransformBoneEdit(GlmEntityTransform* tr, unsigned int boneCount, GlmEntityTransform* trSource)
+{
+	unsigned int iLocal;
+	
+	tr->_boneRestRelativeOrientation = (float(*)[4])GLMC_MALLOC(boneCount * sizeof(float[4]));
+	tr->_boneRestRelativePosition = (float(*)[3])GLMC_MALLOC(boneCount * sizeof(float[3]));
+	if (trSource == NULL)
+	{
+		for (iLocal = 0; iLocal < boneCount; iLocal++)
+		{
+			glmSetIdentityQuaternion(tr->_boneRestRelativeOrientation[iLocal]);
+
+			tr->_boneRestRelativePosition[iLocal][0] = 0.f;
+			tr->_boneRestRelativePosition[iLocal][1] = 0.f;
+			tr->_boneRestRelativePosition[iLocal][2] = 0.f;
+		}
+	}
+	else
+	{
+		memcpy(tr->_boneRestRelativeOrientation, trSource->_boneRestRelativeOrientation, boneCount * sizeof(float[4]));
+		memcpy(tr->_boneRestRelativePosition, trSource->_boneRestRelativePosition, boneCount * sizeof(float[3]));
+	}
+}
+
+//---------------------------------------------------------------------------
+void glmCopyTransform(GlmSimulationData* simulationData, GlmEntityTransform* transformDestination, GlmEntityTransform* transformSource)
+{
+	unsigned int boneCount = simulationData->_boneCount[simulationData->_entityTypes[transformSource->_sourceIndexInCrowdField]];
+	// duplicate matrices
+	memcpy(&transformDestination->_matrixBase, &transformSource->_matrixBase, sizeof(float) * 16);
+	transformDestination->_scale = transformSource->_scale;
 	memcpy(&transformDestination->_orientationBase[0], &transformSource->_orientationBase[0], sizeof(float) * 4);
 	transformDestination->_sourceIndexInCrowdField = transformSource->_sourceIndexInCrowdField;
 	transformDestination->_postureBoneCount = transformSource->_postureBoneCount;
@@ -4151,29 +6745,85 @@ void glmSetSnapToPositionOrientation(GlmEntityTransform* transformDestination, c
 }
 
 //---------------------------------------------------------------------------
-void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* history, GlmEntityTransform** entityTransforms, int *entityTransformCount)
+// identity transform, no edit
+static void glmInitEntityTransform(GlmEntityTransform* tr, int64_t entityId, int sourceIndexInCrowdField, uint32_t postureBoneCount)
 {
-	// count duplications, allocate array
-	unsigned int i;
-	unsigned int j;
-	unsigned int duplicateCount = 0;
-	unsigned int duplicateIndex;
-	unsigned int sourceEntityCount = 0;
-	unsigned int entityAv = 0;
-	unsigned int totalPostureCount = 0;
-	unsigned int totalPostureBoneCount = 0;
-	unsigned int maxBonesPerEntity = 0;
-	unsigned int firstDuplicatedEntityIndex = 0;
-	unsigned int patchedDuplicateCount = 0;
+	tr->_entityId = entityId;
+	tr->_sourceIndexInCrowdField = sourceIndexInCrowdField;
+	glmSetIdentityMatrix(tr->_matrix);
+	glmSetIdentityMatrix(tr->_matrixBase);
+	glmSetIdentityQuaternion(tr->_orientationBase);
+	glmSetIdentityQuaternion(tr->_orientation);
+	tr->_lastEditPostureHistoryIndex = 0;
+	tr->_useCloth = 0;
+	tr->_killed = 0;
+	tr->_scale = 1.f;
+	tr->_postureCount = 0;
+	tr->_boneRestRelativeOrientation = 0;
+	tr->_boneRestRelativePosition = 0;
+	tr->_postureBoneCount = postureBoneCount;
+	tr->_groundAdaptOffset[0] = 0.f;
+	tr->_groundAdaptOffset[1] = 0.f;
+	tr->_groundAdaptOffset[2] = 0.f;
+	tr->_frameOffset._frameOffset = 0.f;
+	tr->_frameOffset._frameWarp = 1.f;
+	tr->_frameOffset._fraction = 0.f;
+	tr->_outOfCache = 0;
+	tr->_perFramePosOriIndex = INT_MIN;
+	tr->_perFramePosOriArrayCount = 0;
+	glmSetIdentityQuaternion(tr->_groundAdaptOrientation);
+}
 
-	uint32_t *postureFrames;
-	float(*posturesPositions)[3];
-	float(*posturesOrientations)[4];
-	float(*posturesPositionsHistorySource)[3]; 
-	float(*posturesOrientationsHistorySource)[4];
+//---------------------------------------------------------------------------
+// duplicates made by the last entity of snap to transform iTransform, copied from each source entity in entity type order until
+// history->_duplicatedEntityArrayCount[iTransform] are made. Only advances *duplicateIndex when apply is 0
+static void glmSnapToDuplicates(GlmSimulationData* simulationData, const GlmHistory* history, const GlmEntityIndexMap* entityIndexMap, GlmEntityTransform* data, unsigned int iTransform, unsigned int* duplicateIndex, int apply)
+{
+	unsigned int iSnapToDuplicate = 0;
+	int entityToDuplicateCount = history->_duplicatedEntityArrayCount[iTransform];
+	// make duplicates
+	while (entityToDuplicateCount > 0)
+	{
+		int iCharacter;
+		for (iCharacter = 0; iCharacter < simulationData->_entityTypeCount; iCharacter++)
+		{
+			unsigned int iEntity;
+			for (iEntity = 0; iEntity < history->_entityArrayCount[iTransform]; iEntity++)
+			{
+				int entityPositionInCrowdField;
+				entityPositionInCrowdField = glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[iTransform] + iEntity]);
 
-	GlmEntityTransform* data;
+				if (simulationData->_entityTypes[entityPositionInCrowdField] != iCharacter)
+					continue;
 
+				if (apply)
+				{
+					int snapToIndex;
+					// copy source transform
+					glmCopyTransform(simulationData, &data[*duplicateIndex], &data[entityPositionInCrowdField]);
+
+					// set snap to
+					snapToIndex = history->_snapToStartIndex[iTransform] + history->_entityArrayCount[iTransform] + iSnapToDuplicate;
+					glmSetSnapToPositionOrientation(&data[*duplicateIndex], history->_snapToPositions[snapToIndex], history->_snapToRotations[snapToIndex]);
+				}
+
+				// duplicate posture edit
+				(*duplicateIndex)++;
+				entityToDuplicateCount--;
+				iSnapToDuplicate++;
+			} // entity
+		} // simulationData->_entityTypeCount
+	} // entityToDuplicateCount > 0)
+}
+
+//---------------------------------------------------------------------------
+// apply the history to entity transforms set by glmInitEntityTransform. When entityMask is not NULL, only the entities with a non 0 mask are transformed,
+// the mask must include every source and duplicate of the duplicate and snap to transforms involving a masked entity. Postures are left untouched
+static void glmApplyHistoryToEntityTransforms(GlmSimulationData* simulationData, GlmHistory* history, GlmEntityTransform* data, unsigned int sourceEntityCount, const GlmEntityIndexMap* entityIndexMap, const uint8_t* entityMask)
+{
+	unsigned int i;
+	unsigned int j;
+	unsigned int duplicateIndex = sourceEntityCount;
 	unsigned int frameOffsetsAv = 0;
 	unsigned int frameWarpAv = 0;
 
@@ -4181,145 +6831,53 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 
 	for (i=0;i<history->_transformCount;i++)
 	{
-		if (history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop)
-			continue;
-		if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
-			duplicateCount += history->_duplicatedEntityArrayCount[i];
-	}
-
-	// we don't store invalid entities anymore :
-	sourceEntityCount += simulationData->_entityCount;
-
-	// get maximum bone count
-	maxBonesPerEntity = simulationData->_boneCount[0];
-	for (i = 1;i<simulationData->_entityTypeCount;i++)
-	{
-		maxBonesPerEntity = (maxBonesPerEntity>simulationData->_boneCount[i])?maxBonesPerEntity:simulationData->_boneCount[i];
-	}
-
-	*entityTransformCount = sourceEntityCount + duplicateCount;
-	*entityTransforms = (GlmEntityTransform*)GLMC_MALLOC(*entityTransformCount * sizeof(GlmEntityTransform));
+		float transformMatrix[16]; // same for all entities of the transform
 
-	// set array
-	data = *entityTransforms;
+		if ( history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop )
+			continue;
+		if (history->_transformTypes[i] == SimulationCacheRotate)
+			glmConvertMatrix(transformMatrix, history->_transformTranslate[i], history->_transformRotate[i]);
+		else if (history->_transformTypes[i] == SimulationCacheTranslate)
+			glmConvertMatrix(transformMatrix, history->_transformTranslate[i], identityRotation);
 
-	// working arrays 
-	data->_sortedBonesWorldOri = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
-	data->_sortedBonesWorldPos = (float(*)[3])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[3]));
-	data->_sortedBonesScale = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
-	data->_restRelativeOri = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
-	
-	// legacy entities
-	for (i = 0;i<simulationData->_entityCount;i++)
-	{
-		GlmEntityTransform* tr = &data[entityAv];
-
-		tr->_entityId = simulationData->_entityIds[i];
-		tr->_sourceIndexInCrowdField = i;
-		glmSetIdentityMatrix(tr->_matrix);
-		glmSetIdentityMatrix(tr->_matrixBase);
-		glmSetIdentityQuaternion(tr->_orientationBase);
-		glmSetIdentityQuaternion(tr->_orientation);
-		tr->_lastEditPostureHistoryIndex = 0;
-		tr->_useCloth = 0;
-		tr->_killed = 0;
-		tr->_scale = 1.f;
-		tr->_postureCount = 0;
-		tr->_boneRestRelativeOrientation = 0;
-		tr->_boneRestRelativePosition = 0;
-		tr->_postureBoneCount = simulationData->_boneCount[simulationData->_entityTypes[i]];
-		tr->_groundAdaptOffset[0] = 0.f;
-		tr->_groundAdaptOffset[1] = 0.f;
-		tr->_groundAdaptOffset[2] = 0.f;
-		tr->_frameOffset._frameOffset = 0.f;
-		tr->_frameOffset._frameWarp = 1.f;
-		tr->_frameOffset._fraction = 0.f;
-		tr->_outOfCache = 0;
-		tr->_perFramePosOriIndex = INT_MIN;
-		tr->_perFramePosOriArrayCount = 0;
-		glmSetIdentityQuaternion(tr->_groundAdaptOrientation);
-		entityAv++;
-	}
-	// init array for duplicates
-	firstDuplicatedEntityIndex = entityAv;
-	for (i = 0;i<duplicateCount;i++)
-	{
-		GlmEntityTransform* tr = &data[entityAv];
-		tr->_entityId = -1;
-		
-		glmSetIdentityMatrix(tr->_matrix);
-		glmSetIdentityMatrix(tr->_matrixBase);
-		tr->_sourceIndexInCrowdField = -1;
-		glmSetIdentityQuaternion(tr->_orientation);
-		glmSetIdentityQuaternion(tr->_orientationBase);
-		tr->_lastEditPostureHistoryIndex = 0;
-		tr->_useCloth = 0;
-		tr->_killed = 0;
-		tr->_scale = 1.f;
-		tr->_postureCount = 0;
-		tr->_boneRestRelativeOrientation = 0;
-		tr->_boneRestRelativePosition = 0;
-		tr->_postureBoneCount = 0xFFFFFFFF;
-		tr->_groundAdaptOffset[0] = 0.f;
-		tr->_groundAdaptOffset[1] = 0.f;
-		tr->_groundAdaptOffset[2] = 0.f;
-		tr->_frameOffset._frameOffset = 0.f;
-		tr->_frameOffset._frameWarp = 1.f;
-		tr->_frameOffset._fraction = 0.f;
-		tr->_outOfCache = 0;
-		tr->_perFramePosOriIndex = INT_MIN;
-		tr->_perFramePosOriArrayCount = 0;
-		glmSetIdentityQuaternion(tr->_groundAdaptOrientation);
-		entityAv++;
-	}
-	duplicateIndex = sourceEntityCount;
-
-	// recompute entityId for duplicates
-	for (i = 0; i<history->_transformCount; i++)
-	{
-		if (history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop)
-		{
-			if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
-				patchedDuplicateCount += history->_duplicatedEntityArrayCount[i];
-			continue;
-		}
-		if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
-		{
-			for (j = 0; j < history->_duplicatedEntityArrayCount[i]; j++)
-			{
-				GlmEntityTransform* tr = &data[duplicateIndex++];
-				tr->_entityId = history->_duplicatedEntityIds[patchedDuplicateCount+j];
-			}
-			patchedDuplicateCount += history->_duplicatedEntityArrayCount[i];
-		}
-	}
-	duplicateIndex = sourceEntityCount;
-
-	// apply transformations
-	for (i=0;i<history->_transformCount;i++)
-	{
-		if ( history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop )
-			continue;
 		for (j=0;j<history->_entityArrayCount[i];j++)
 		{
 			int entityPositionInCrowdField;
-			entityPositionInCrowdField = glmFindEntityInSimulation(data, *entityTransformCount, history->_entityIds[history->_entityArrayStartIndex[i] + j] );
+			entityPositionInCrowdField = glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[i] + j] );
+			if ( entityPositionInCrowdField != -1 && entityMask && !entityMask[entityPositionInCrowdField] )
+			{
+				// keep the shared cursors where a full evaluation has them
+				switch (history->_transformTypes[i])
+				{
+				case SimulationCacheSnapTo:
+					if (j < history->_snapToCount[i] && j == history->_entityArrayCount[i] - 1)
+						glmSnapToDuplicates(simulationData, history, entityIndexMap, data, i, &duplicateIndex, 0);
+					break;
+				case SimulationCacheDuplicate:
+					duplicateIndex++;
+					break;
+				case SimulationCacheFrameOffset:
+					frameOffsetsAv++;
+					break;
+				case SimulationCacheFrameWarp:
+					frameWarpAv++;
+					break;
+				}
+				continue;
+			}
 			if ( entityPositionInCrowdField != -1 )
 			{
 				switch (history->_transformTypes[i])
 				{
 				case SimulationCacheRotate:
 					{
-						float matrix[16];
 						float matrixSource[16];
 
 						float orientationSource[4];
 						memcpy(matrixSource, data[entityPositionInCrowdField]._matrixBase, sizeof(float)*16);
 						memcpy(orientationSource, data[entityPositionInCrowdField]._orientationBase, sizeof(float)*4);
 
-						glmConvertMatrix( matrix, history->_transformTranslate[i], history->_transformRotate[i]);
-
-						glmMultMatrix(matrixSource, matrix, data[entityPositionInCrowdField]._matrixBase);
+						glmMultMatrix(matrixSource, transformMatrix, data[entityPositionInCrowdField]._matrixBase);
 						glmMultQuaternion(orientationSource, history->_transformRotate[i], data[entityPositionInCrowdField]._orientationBase);
 						glmNormalizeQuaternion(data[entityPositionInCrowdField]._orientationBase);
 					}
@@ -4329,12 +6887,10 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 					break;
 				case SimulationCacheTranslate:
 					{
-						float matrix[16];
 						float matrixSource[16];
 
 						memcpy(matrixSource, data[entityPositionInCrowdField]._matrixBase, sizeof(float)*16);
-						glmConvertMatrix( matrix, history->_transformTranslate[i], identityRotation);
-						glmMultMatrix( matrixSource, matrix, data[entityPositionInCrowdField]._matrixBase);
+						glmMultMatrix( matrixSource, transformMatrix, data[entityPositionInCrowdField]._matrixBase);
 					}
 					break;
 				case SimulationCacheExpand:
@@ -4365,39 +6921,7 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 						glmSetSnapToPositionOrientation(&data[entityPositionInCrowdField], history->_snapToPositions[snapToIndex], history->_snapToRotations[snapToIndex]);
 
 						if (j == history->_entityArrayCount[i] - 1) // move duplicated entities
-						{
-							unsigned int iSnapToDuplicate = 0;
-							int entityToDuplicateCount = history->_duplicatedEntityArrayCount[i];
-							// make duplicates
-							while (entityToDuplicateCount > 0)
-							{
-								int iCharacter;
-								for (iCharacter = 0; iCharacter < simulationData->_entityTypeCount; iCharacter++)
-								{
-									unsigned int iEntity;
-									for (iEntity = 0; iEntity < history->_entityArrayCount[i]; iEntity++)
-									{
-										int entityPositionInCrowdField;
-										entityPositionInCrowdField = glmFindEntityInSimulation(data, *entityTransformCount, history->_entityIds[history->_entityArrayStartIndex[i] + iEntity]);
-
-										if (simulationData->_entityTypes[entityPositionInCrowdField] != iCharacter)
-											continue;
-
-										// copy source transform
-										glmCopyTransform(simulationData, &data[duplicateIndex], &data[entityPositionInCrowdField]);
-
-										// set snap to
-										snapToIndex = history->_snapToStartIndex[i] + history->_entityArrayCount[i] + iSnapToDuplicate;
-										glmSetSnapToPositionOrientation(&data[duplicateIndex], history->_snapToPositions[snapToIndex], history->_snapToRotations[snapToIndex]);
-
-										// duplicate posture edit
-										duplicateIndex++;
-										entityToDuplicateCount--;
-										iSnapToDuplicate++;
-									} // entity
-								} // simulationData->_entityTypeCount
-							} // entityToDuplicateCount > 0)
-						}
+							glmSnapToDuplicates(simulationData, history, entityIndexMap, data, i, &duplicateIndex, 1);
 					}
 					break;
 				case SimulationCacheScaleRange:
@@ -4431,6 +6955,7 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 					data[entityPositionInCrowdField]._killed = (history->_transformTypes[i] == SimulationCacheKill);
 					break;
 				case SimulationCachePosture:
+					if (entityMask == NULL)
 					{
 						GlmEntityTransform* tr = &data[entityPositionInCrowdField];
 						tr->_postureCount += history->_postureCount; // maximum, will be lower than that
@@ -4477,6 +7002,102 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 			}
 		}
 	}
+}
+
+//---------------------------------------------------------------------------
+void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* history, GlmEntityTransform** entityTransforms, int *entityTransformCount)
+{
+	// count duplications, allocate array
+	unsigned int i;
+	unsigned int j;
+	unsigned int duplicateCount = 0;
+	unsigned int duplicateIndex;
+	unsigned int sourceEntityCount = 0;
+	unsigned int entityAv = 0;
+	unsigned int totalPostureCount = 0;
+	unsigned int totalPostureBoneCount = 0;
+	unsigned int maxBonesPerEntity = 0;
+	unsigned int patchedDuplicateCount = 0;
+
+	uint32_t *postureFrames;
+	uint32_t *postureFrameOrder;
+	float(*posturesPositions)[3];
+	float(*posturesOrientations)[4];
+	float(*posturesPositionsHistorySource)[3]; 
+	float(*posturesOrientationsHistorySource)[4];
+
+	GlmEntityTransform* data;
+	GlmEntityIndexMap entityIndexMap;
+
+	for (i=0;i<history->_transformCount;i++)
+	{
+		if (history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop)
+			continue;
+		if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
+			duplicateCount += history->_duplicatedEntityArrayCount[i];
+	}
+
+	// we don't store invalid entities anymore :
+	sourceEntityCount += simulationData->_entityCount;
+
+	// get maximum bone count
+	maxBonesPerEntity = simulationData->_boneCount[0];
+	for (i = 1;i<simulationData->_entityTypeCount;i++)
+	{
+		maxBonesPerEntity = (maxBonesPerEntity>simulationData->_boneCount[i])?maxBonesPerEntity:simulationData->_boneCount[i];
+	}
+
+	*entityTransformCount = sourceEntityCount + duplicateCount;
+	*entityTransforms = (GlmEntityTransform*)GLMC_MALLOC(*entityTransformCount * sizeof(GlmEntityTransform));
+
+	// set array
+	data = *entityTransforms;
+
+	// working arrays 
+	data->_sortedBonesWorldOri = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
+	data->_sortedBonesWorldPos = (float(*)[3])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[3]));
+	data->_sortedBonesScale = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
+	data->_restRelativeOri = (float(*)[4])GLMC_MALLOC(maxBonesPerEntity * sizeof(float[4]));
+	
+	// legacy entities
+	for (i = 0;i<simulationData->_entityCount;i++)
+	{
+		glmInitEntityTransform(&data[entityAv], simulationData->_entityIds[i], i, simulationData->_boneCount[simulationData->_entityTypes[i]]);
+		entityAv++;
+	}
+	// init array for duplicates
+	for (i = 0;i<duplicateCount;i++)
+	{
+		glmInitEntityTransform(&data[entityAv], -1, -1, 0xFFFFFFFF);
+		entityAv++;
+	}
+	duplicateIndex = sourceEntityCount;
+
+	// recompute entityId for duplicates
+	for (i = 0; i<history->_transformCount; i++)
+	{
+		if (history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop)
+		{
+			if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
+				patchedDuplicateCount += history->_duplicatedEntityArrayCount[i];
+			continue;
+		}
+		if (history->_transformTypes[i] == SimulationCacheDuplicate || history->_transformTypes[i] == SimulationCacheSnapTo)
+		{
+			for (j = 0; j < history->_duplicatedEntityArrayCount[i]; j++)
+			{
+				GlmEntityTransform* tr = &data[duplicateIndex++];
+				tr->_entityId = history->_duplicatedEntityIds[patchedDuplicateCount+j];
+			}
+			patchedDuplicateCount += history->_duplicatedEntityArrayCount[i];
+		}
+	}
+
+	// all entity ids, duplicates included, are known from here
+	glmCreateEntityIndexMap(&entityIndexMap, data, *entityTransformCount);
+
+	// apply transformations
+	glmApplyHistoryToEntityTransforms(simulationData, history, data, sourceEntityCount, &entityIndexMap, NULL);
 
 	for (i = 0;i<entityAv;i++)
 	{
@@ -4488,10 +7109,12 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 	// postures edit. 1st transform has the pointer to the allocated posture bones & posture frames
 	
 	data->_postureFrames = (uint32_t*)GLMC_MALLOC(totalPostureCount * sizeof(uint32_t));
+	data->_postureFrameOrder = (uint32_t*)GLMC_MALLOC(totalPostureCount * sizeof(uint32_t));
 	data->_posturesPositions = (float(*)[3])GLMC_MALLOC(totalPostureBoneCount * sizeof(float[3]));
 	data->_posturesOrientations = (float(*)[4])GLMC_MALLOC(totalPostureBoneCount * sizeof(float[4]));
 	
 	postureFrames = data->_postureFrames;
+	postureFrameOrder = data->_postureFrameOrder;
 	posturesPositions = data->_posturesPositions;
 	posturesOrientations = data->_posturesOrientations;
 	
@@ -4500,10 +7123,12 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 	{
 		GlmEntityTransform* tr = &data[i];
 		tr->_postureFrames = postureFrames;
+		tr->_postureFrameOrder = postureFrameOrder;
 		tr->_posturesPositions = posturesPositions;
 		tr->_posturesOrientations = posturesOrientations;
 		
 		postureFrames += tr->_postureCount;
+		postureFrameOrder += tr->_postureCount;
 		posturesPositions += tr->_postureCount * tr->_postureBoneCount;
 		posturesOrientations += tr->_postureCount * tr->_postureBoneCount;
 
@@ -4520,7 +7145,7 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 		for (j=0;j<history->_entityArrayCount[i];j++)
 		{
 			int entityPositionInCrowdField;
-			entityPositionInCrowdField = glmFindEntityInSimulation(data, *entityTransformCount, history->_entityIds[history->_entityArrayStartIndex[i] + j] );
+			entityPositionInCrowdField = glmFindEntityIndex(&entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[i] + j] );
 			if ( entityPositionInCrowdField != -1 )
 			{
 				if (history->_transformTypes[i]==SimulationCachePosture)
@@ -4548,6 +7173,24 @@ void glmCreateEntityTransforms(GlmSimulationData* simulationData, GlmHistory* hi
 			}
 		}
 	}
+
+	// sort postures by frame for glmFindPostureIndex. Insertion sort is stable : with several postures on one frame, the last one in history order stays last
+	for (i = 0;i<entityAv;i++)
+	{
+		GlmEntityTransform* tr = &data[i];
+		for (j = 0;j<tr->_postureCount;j++)
+		{
+			unsigned int k = j;
+			while (k > 0 && tr->_postureFrames[tr->_postureFrameOrder[k - 1]] > tr->_postureFrames[j])
+			{
+				tr->_postureFrameOrder[k] = tr->_postureFrameOrder[k - 1];
+				k--;
+			}
+			tr->_postureFrameOrder[k] = j;
+		}
+	}
+
+	glmDestroyEntityIndexMap(&entityIndexMap);
 }
 
 //---------------------------------------------------------------------------
@@ -4569,18 +7212,63 @@ void glmDestroyEntityTransforms(GlmEntityTransform** entityTransforms, unsigned
 	GLMC_FREE(data->_restRelativeOri);
 
 	GLMC_FREE(data->_postureFrames);
+	GLMC_FREE(data->_postureFrameOrder);
 	GLMC_FREE(data->_posturesPositions);
 	GLMC_FREE(data->_posturesOrientations);
 	GLMC_FREE(data);
 	*entityTransforms = NULL;
 }
 
+//---------------------------------------------------------------------------
+// entities scales (legacy & duplicates) of a modified simulation data, only for the entities with a non 0 mask when entityMask is not NULL.
+// The biggest bone hierarchy length per entity type is recomputed from all the entities, in place in data.
+// Transform i is entity outputIndices[i] of data, skipped when < 0. Transform i is entity i when outputIndices is NULL
+static void glmScaleModifiedSimulationData(const GlmSimulationData* simulationDataSource, const GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmSimulationData* data, const uint8_t* entityMask, const int32_t* outputIndices)
+{
+	unsigned int i;
+	float *maxScales = data->_maxBonesHierarchyLength;
+
+	for (i = 0;i<simulationDataSource->_entityTypeCount;i++)
+	{
+		maxScales[i] = -1.f;
+	}
+
+	for (i = 0;i<entityTransformCount;i++)
+	{
+		float entitymaxBonesHierarchyLength;
+		int32_t outputIndex = outputIndices ? outputIndices[i] : (int32_t)i;
+		uint16_t entityType;
+		float scale = entityTransforms[i]._scale;
+
+		if (outputIndex < 0)
+			continue;
+		entityType = data->_entityTypes[outputIndex];
+		if (entityMask == NULL || entityMask[i])
+		{
+			int sourceIndex = entityTransforms[i]._sourceIndexInCrowdField;
+			data->_scales[outputIndex] = simulationDataSource->_scales[sourceIndex] * scale;
+			data->_entityRadius[outputIndex] = simulationDataSource->_entityRadius[sourceIndex] * scale;
+			data->_entityHeight[outputIndex] = simulationDataSource->_entityHeight[sourceIndex] * scale;
+		}
+
+		// set biggest
+		entitymaxBonesHierarchyLength = simulationDataSource->_maxBonesHierarchyLength[entityType] * scale;
+		maxScales[entityType] = (maxScales[entityType]>entitymaxBonesHierarchyLength)?maxScales[entityType]:entitymaxBonesHierarchyLength;
+	}
+
+	// update max scales
+	for (i = 0;i<data->_entityTypeCount;i++)
+	{
+		// <0 means scale not touched
+		data->_maxBonesHierarchyLength[i] = (maxScales[i]>0.f) ? maxScales[i] : simulationDataSource->_maxBonesHierarchyLength[i]; // per entity type
+	}
+}
+
 //---------------------------------------------------------------------------
 void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmSimulationData** simulationDataDestination )
 {
 	unsigned int i;
 	GlmSimulationData* data;
-	float *maxScales;
 
 	unsigned int iBoneOffsetPerEntityType;
 	unsigned int iSnSOffsetPerEntityType;
@@ -4589,13 +7277,13 @@ void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, Gl
 
 	glmCreateSimulationData(simulationDataDestination, entityTransformCount, simulationDataSource->_entityTypeCount, simulationDataSource->_ppFloatAttributeCount, simulationDataSource->_ppVectorAttributeCount);
 	data = *simulationDataDestination;
+	if (data == NULL)
+		return;
 
 	// clear entityTypeCount 
-	maxScales = (float*)GLMC_MALLOC(sizeof(float) * simulationDataSource->_entityTypeCount);
 	for (i = 0;i<simulationDataSource->_entityTypeCount;i++)
 	{
 		data->_entityCountPerEntityType[i] = 0;
-		maxScales[i] = -1.f;
 	}
 
 	// copy/append entity infos
@@ -4608,10 +7296,6 @@ void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, Gl
 	
 		sourceIndex = entityTransforms[i]._sourceIndexInCrowdField;
 		data->_entityTypes[i] = simulationDataSource->_entityTypes[sourceIndex];
-		data->_scales[i] = simulationDataSource->_scales[sourceIndex];
-		data->_entityRadius[i] = simulationDataSource->_entityRadius[sourceIndex];
-		data->_entityHeight[i] = simulationDataSource->_entityHeight[sourceIndex];
-
 
 		entityType = data->_entityTypes[i];
 		data->_indexInEntityType[i] = data->_entityCountPerEntityType[entityType];
@@ -4620,7 +7304,6 @@ void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, Gl
 	
 	// entityType
 	memcpy( data->_boneCount, simulationDataSource->_boneCount, sizeof(uint16_t) * simulationDataSource->_entityTypeCount );
-	memcpy( data->_maxBonesHierarchyLength, simulationDataSource->_maxBonesHierarchyLength, sizeof(float) * simulationDataSource->_entityTypeCount );
 	memcpy( data->_blindDataCount, simulationDataSource->_blindDataCount, sizeof(uint16_t) * simulationDataSource->_entityTypeCount );
 	memcpy( data->_hasGeoBehavior, simulationDataSource->_hasGeoBehavior, sizeof(uint8_t) * simulationDataSource->_entityTypeCount );
 	memcpy( data->_snsCountPerEntityType, simulationDataSource->_snsCountPerEntityType, sizeof(uint16_t) * simulationDataSource->_entityTypeCount );
@@ -4651,41 +7334,87 @@ void glmCreateModifiedSimulationData(GlmSimulationData* simulationDataSource, Gl
 	memcpy( data->_ppFloatAttributeNames, simulationDataSource->_ppFloatAttributeNames, sizeof(char) * simulationDataSource->_ppFloatAttributeCount * GSC_PP_MAX_NAME_LENGTH );
 	memcpy( data->_ppVectorAttributeNames, simulationDataSource->_ppVectorAttributeNames, sizeof(char) * simulationDataSource->_ppVectorAttributeCount * GSC_PP_MAX_NAME_LENGTH);
 
-	// update entities scales (legacy & duplicates)
-	for (i = 0;i<entityTransformCount;i++)
-	{
-		float entitymaxBonesHierarchyLength;
-		float maxScale;
-		float newScale;
+	glmScaleModifiedSimulationData(simulationDataSource, entityTransforms, entityTransformCount, data, NULL, NULL);
 
-		uint16_t entityType;
-		float scale = entityTransforms[i]._scale;
-		//if (data->_entityIds[i]<0)
-		//	continue;
+	data->_contentHashKey = simulationDataSource->_contentHashKey;
+}
 
-		entityType = data->_entityTypes[i];
+//---------------------------------------------------------------------------
+int glmCreateModifiedSimulationDataView(GlmSimulationData* simulationDataSource, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmSimulationData** simulationDataDestination)
+{
+	unsigned int i;
+	GlmSimulationData* data;
 
-		data->_scales[i] *= scale;
-		data->_entityRadius[i] *= scale;
-		data->_entityHeight[i] *= scale;
+	*simulationDataDestination = NULL;
 
-		// set biggest
-		entitymaxBonesHierarchyLength = simulationDataSource->_maxBonesHierarchyLength[entityType] * scale;
-		maxScale = maxScales[entityType];
-		newScale = (maxScale>entitymaxBonesHierarchyLength)?maxScale:entitymaxBonesHierarchyLength;
-		maxScales[entityType] = newScale;
+	// entity set must be unchanged : each transform is its own source entity, in order. Killed entities keep their simulation data
+	if (entityTransformCount != simulationDataSource->_entityCount)
+		return 0;
+	for (i = 0; i < entityTransformCount; i++)
+	{
+		if (entityTransforms[i]._sourceIndexInCrowdField != (int)i || entityTransforms[i]._entityId != simulationDataSource->_entityIds[i])
+			return 0;
 	}
 
-	// update max scales
-	for (i = 0;i<data->_entityTypeCount;i++)
+	data = (GlmSimulationData*)GLMC_MALLOC(sizeof(GlmSimulationData));
+	if (data == NULL)
+		return 0;
+	memcpy(data, simulationDataSource, sizeof(GlmSimulationData));
+	data->_backwardCompatPPAttributeTypes = NULL;
+	glmSetIdentityMatrix(data->_proxyMatrix);
+	glmSetIdentityMatrix(data->_proxyMatrixInverse);
+
+	// scaled fields are owned by the view so layout scale edits can update them in place
+	data->_scales = (float*)GLMC_MALLOC(data->_entityCount * sizeof(float));
+	data->_entityRadius = (float*)GLMC_MALLOC(data->_entityCount * sizeof(float));
+	data->_entityHeight = (float*)GLMC_MALLOC(data->_entityCount * sizeof(float));
+	data->_maxBonesHierarchyLength = (float*)GLMC_MALLOC(data->_entityTypeCount * sizeof(float));
+	if ((data->_entityCount && (data->_scales == NULL || data->_entityRadius == NULL || data->_entityHeight == NULL)) || (data->_entityTypeCount && data->_maxBonesHierarchyLength == NULL))
 	{
-		if (maxScales[i]>0.f) // <0 means scale not touched
-			data->_maxBonesHierarchyLength[i] = maxScales[i]; // per entity type
+		glmDestroySimulationDataView(&data, simulationDataSource);
+		return 0;
 	}
+	glmScaleModifiedSimulationData(simulationDataSource, entityTransforms, entityTransformCount, data, NULL, NULL);
 
-	data->_contentHashKey = simulationDataSource->_contentHashKey;
-	//
-	GLMC_FREE(maxScales);
+	*simulationDataDestination = data;
+	return 1;
+}
+
+//---------------------------------------------------------------------------
+void glmDestroySimulationDataView(GlmSimulationData** simulationDataView, const GlmSimulationData* simulationDataSource)
+{
+	GlmSimulationData* data = *simulationDataView;
+	GLMC_ASSERT((data != NULL) && "Simulation data view must be created before being destroyed");
+	(void)simulationDataSource;
+	GLMC_FREE(data->_scales);
+	GLMC_FREE(data->_entityRadius);
+	GLMC_FREE(data->_entityHeight);
+	GLMC_FREE(data->_maxBonesHierarchyLength);
+	GLMC_FREE(data);
+	*simulationDataView = NULL;
+}
+
+//---------------------------------------------------------------------------
+void glmDetachSimulationDataView(GlmSimulationData* simulationDataView, GlmSimulationData** simulationDataSource)
+{
+	GlmSimulationData* source = *simulationDataSource;
+
+	// shared arrays now belong to the view, the source keeps the ones it does not share
+	source->_entityIds = NULL;
+	source->_entityTypes = NULL;
+	source->_indexInEntityType = NULL;
+	source->_entityCountPerEntityType = NULL;
+	source->_boneCount = NULL;
+	source->_iBoneOffsetPerEntityType = NULL;
+	source->_blindDataCount = NULL;
+	source->_iBlindDataOffsetPerEntityType = NULL;
+	source->_hasGeoBehavior = NULL;
+	source->_iGeoBehaviorOffsetPerEntityType = NULL;
+	source->_snsCountPerEntityType = NULL;
+	source->_snsOffsetPerEntityType = NULL;
+	source->_ppFloatAttributeNames = NULL;
+	source->_ppVectorAttributeNames = NULL;
+	glmDestroySimulationData(simulationDataSource);
 }
 
 // -----------------------------------------------------------------------------
@@ -4738,12 +7467,29 @@ void glmVoidEntityFrameData(GlmFrameData*frameDataOut, GlmSimulationData *simuDa
 }
 
 // -----------------------------------------------------------------------------
-void glmCopyEntityFrameData(const GlmFrameData*frameDataIn, GlmFrameData*frameDataOut, GlmSimulationData *simuDataIn, GlmSimulationData *simuDataOut, int sourceIndexInCrowdField, int destIndexInCrowdField, int geoBeSource, int geoBeDestination, GlmEntityTransform *transform )
+// bones of one entity : rigid transform, then scale around the root
+static void glmTransformEntityBones(const float(*bonePositionsSource)[3], const float(*boneOrientationsSource)[4], unsigned int boneCount, const float* matrix, const float* orientation, float scale, float(*bonePositionsDest)[3], float(*boneOrientationsDest)[4])
 {
 	unsigned int i, j;
-	float *matrix = transform->_matrix;
-	float scale = transform->_scale;
 
+	glmTransformPoints(bonePositionsSource, matrix, bonePositionsDest, boneCount);
+	glmMultQuaternions(orientation, boneOrientationsSource, boneOrientationsDest, boneCount);
+	glmNormalizeQuaternions(boneOrientationsDest, boneCount);
+
+	// scale posture
+	for (i = 1;i<boneCount;i++)
+	{
+		for (j = 0;j<3;j++)
+		{
+			float ref = bonePositionsDest[0][j];
+			bonePositionsDest[i][j] = (bonePositionsDest[i][j]-ref) * scale + ref;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+void glmCopyEntityFrameData(const GlmFrameData*frameDataIn, GlmFrameData*frameDataOut, GlmSimulationData *simuDataIn, GlmSimulationData *simuDataOut, int sourceIndexInCrowdField, int destIndexInCrowdField, int geoBeSource, int geoBeDestination, GlmEntityTransform *transform )
+{
 	// transform entity
 	uint16_t entityTypeIndex = simuDataIn->_entityTypes[sourceIndexInCrowdField];
 	uint16_t boneCount = simuDataIn->_boneCount[entityTypeIndex];
@@ -4758,23 +7504,9 @@ void glmCopyEntityFrameData(const GlmFrameData*frameDataIn, GlmFrameData*frameDa
 	float(*bonePositionsPtrDest)[3] = frameDataOut->_bonePositions + offsetDest;
 	float(*boneOrientationPtrdest)[4] = frameDataOut->_boneOrientations + offsetDest;
 	
-	for (i = 0;i<boneCount;i++)
-	{
-		glmTransformPoint(bonePositionsPtrSource[i], matrix, bonePositionsPtrDest[i]);
-		glmMultQuaternion(&transform->_orientation[0], boneOrientationPtrSource[i], boneOrientationPtrdest[i]);
-		glmNormalizeQuaternion(boneOrientationPtrdest[i]);
-	}
-
-	// scale posture
-	for (i = 1;i<boneCount;i++)
-	{
-		for (j = 0;j<3;j++)
-		{
-			float ref = bonePositionsPtrDest[0][j];
-			bonePositionsPtrDest[i][j] = (bonePositionsPtrDest[i][j]-ref) * scale + ref;
-			transform->_scalePivot[j] = ref;
-		}
-	}
+	glmTransformEntityBones((const float(*)[3])bonePositionsPtrSource, (const float(*)[4])boneOrientationPtrSource, boneCount, transform->_matrix, transform->_orientation, transform->_scale, bonePositionsPtrDest, boneOrientationPtrdest);
+	if (boneCount > 1)
+		memcpy(transform->_scalePivot, bonePositionsPtrDest[0], sizeof(float) * 3);
 
 	// copy snsValues
 	if (snsCount)
@@ -4830,18 +7562,17 @@ void glmInterpolateEntityFrameData(const GlmFrameData*frameDataIn1, const GlmFra
 	float(*bonePositionsPtrDest)[3] = frameDataOut->_bonePositions + offsetDest;
 	float(*boneOrientationPtrdest)[4] = frameDataOut->_boneOrientations + offsetDest;
 
+	// interpolate in place, then transform
 	for (i = 0; i<boneCount; i++)
-{
-		float interpolatedOri[4];
-		float interpolatedPos[3];
-		interpolateNFloats(boneOrientationPtrSource1[i], boneOrientationPtrSource2[i], fraction, interpolatedOri, 4);
-		interpolateNFloats(bonePositionsPtrSource1[i], bonePositionsPtrSource2[i], fraction, interpolatedPos, 3);
-		glmNormalizeQuaternion(interpolatedOri);
-
-		glmTransformPoint(interpolatedPos, matrix, bonePositionsPtrDest[i]);
-		glmMultQuaternion(&transform->_orientation[0], interpolatedOri, boneOrientationPtrdest[i]);
-		glmNormalizeQuaternion(boneOrientationPtrdest[i]);
+	{
+		interpolateNFloats(boneOrientationPtrSource1[i], boneOrientationPtrSource2[i], fraction, boneOrientationPtrdest[i], 4);
+		interpolateNFloats(bonePositionsPtrSource1[i], bonePositionsPtrSource2[i], fraction, bonePositionsPtrDest[i], 3);
 	}
+	glmNormalizeQuaternions(boneOrientationPtrdest, boneCount);
+
+	glmTransformPoints((const float(*)[3])bonePositionsPtrDest, matrix, bonePositionsPtrDest, boneCount);
+	glmMultQuaternions(&transform->_orientation[0], (const float(*)[4])boneOrientationPtrdest, boneOrientationPtrdest, boneCount);
+	glmNormalizeQuaternions(boneOrientationPtrdest, boneCount);
 
 	// scale posture
 	for (i = 1; i<boneCount; i++)
@@ -5054,13 +7785,452 @@ int glmComputeValidFrameIndex(int frameIndex, const char *filePathModel, const c
 	return bestFrameIndex;
 }
 
+//---------------------------------------------------------------------------
+// index of the posture edited on currentFrame in tr->_postureFrames, -1 if none
+static int glmFindPostureIndex(const GlmEntityTransform* tr, int currentFrame)
+{
+	uint32_t first = 0;
+	uint32_t count = tr->_postureCount;
+
+	// upper bound of currentFrame in the sorted frames, the posture we want is right before it
+	while (count > 0)
+	{
+		uint32_t step = count / 2;
+		if (tr->_postureFrames[tr->_postureFrameOrder[first + step]] <= (unsigned int)currentFrame)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+	if (first > 0 && tr->_postureFrames[tr->_postureFrameOrder[first - 1]] == (unsigned int)currentFrame)
+		return (int)tr->_postureFrameOrder[first - 1];
+	return -1;
+}
+
+//---------------------------------------------------------------------------
+// edit posture works like keyframe : apply the bone edits made after it in history
+static void glmApplyLaterBoneEdits(const GlmEntityTransform* tr, const GlmHistory* history, float(*restRelativeOri)[4])
+{
+	unsigned int iTransformHistory;
+	for (iTransformHistory = tr->_lastEditPostureHistoryIndex; iTransformHistory < history->_transformCount; iTransformHistory++)
+	{
+		if (history->_active[iTransformHistory] && 
+			history->_transformTypes[iTransformHistory] == SimulationCachePostureBoneEdit && 
+			history->_entityIds[history->_entityArrayStartIndex[iTransformHistory]] == tr->_entityId)
+		{
+			unsigned int boneIndex = history->_boneIndex[iTransformHistory];
+			float workOri[4];
+
+			glmMultQuaternion(history->_transformRotate[iTransformHistory], restRelativeOri[boneIndex], workOri);
+			glmNormalizeQuaternion(workOri);
+			memcpy(restRelativeOri[boneIndex], workOri, sizeof(float) * 4);
+		}
+	}
+}
+
+#ifdef GLMC_USE_SSE
+//---------------------------------------------------------------------------
+// bone edit of up to 4 entities of the same entity type, one entity per lane. Work buffers are in hierarchical order, boneCount entries each
+static void glmApplyBoneEditBatch(GlmSimulationData* simulationDataIn, GlmEntityTransform* entityTransforms, const unsigned int* batchTransforms, const int* postureIndices, unsigned int laneCount, GlmHistory* history, GlmSimulationData* simulationDataOut, GlmFrameData* frameOut, const uint16_t* sortedIndices, const uint16_t* parents, __m128(*workOri)[4], __m128(*workPos)[3], __m128(*workRestRelativeOri)[4], __m128* workScales)
+{
+	static const float identityQuaternion[4] = { 0.f, 0.f, 0.f, 1.f };
+	const __m128 signBit = _mm_set1_ps(-0.f);
+	unsigned int laneTransforms[4];
+	float(*bonePositionsPtrDest[4])[3];
+	float(*boneOrientationPtrDest[4])[4];
+	const float* deltaOri[4];
+	unsigned int deltaStride[4];
+	float skeletonScales[4];
+	__m128 skeletonScale;
+	int computeRestRelative = 0;
+
+	uint16_t entityTypeIndex = simulationDataIn->_entityTypes[entityTransforms[batchTransforms[0]]._sourceIndexInCrowdField];
+	unsigned int boneCount = simulationDataIn->_boneCount[entityTypeIndex];
+	unsigned int localBoneOffset = history->_localBoneOffset[entityTypeIndex];
+	const float(*boneLocalOri)[4] = (const float(*)[4])history->_localBoneOrientation + localBoneOffset;
+	const float(*boneLocalPos)[3] = (const float(*)[3])history->_localBonePosition + localBoneOffset;
+	uint16_t snsCount = simulationDataIn->_snsCountPerEntityType[entityTypeIndex];
+	unsigned int iLane;
+	unsigned int i;
+	unsigned int c;
+
+	for (iLane = 0; iLane < 4; iLane++)
+	{
+		// empty lanes repeat the first entity, they are not written back
+		unsigned int iTransform = batchTransforms[iLane < laneCount ? iLane : 0];
+		const GlmEntityTransform* tr = &entityTransforms[iTransform];
+		uint32_t offsetDest = simulationDataOut->_iBoneOffsetPerEntityType[entityTypeIndex] + tr->_postureBoneCount * simulationDataOut->_indexInEntityType[iTransform];
+
+		laneTransforms[iLane] = iTransform;
+		bonePositionsPtrDest[iLane] = frameOut->_bonePositions + offsetDest;
+		boneOrientationPtrDest[iLane] = frameOut->_boneOrientations + offsetDest;
+		skeletonScales[iLane] = simulationDataIn->_scales[tr->_sourceIndexInCrowdField] * tr->_scale;
+
+		if (postureIndices[iTransform] == -1)
+		{
+			deltaOri[iLane] = tr->_boneRestRelativeOrientation[0];
+			deltaStride[iLane] = 4;
+			computeRestRelative = 1;
+		}
+		else
+		{
+			// full frame posture, rest relatives are replaced below
+			deltaOri[iLane] = identityQuaternion;
+			deltaStride[iLane] = 0;
+		}
+
+		// map posture to hierarchical order so we can have hierarchical operations
+		for (i = 0; i < boneCount; i++)
+		{
+			unsigned int sortedBoneIndex = sortedIndices[i];
+			for (c = 0; c < 4; c++)
+				((float*)&workOri[sortedBoneIndex][c])[iLane] = boneOrientationPtrDest[iLane][i][c];
+		}
+		if (snsCount)
+		{
+			float(*boneSnsPtr)[4] = frameOut->_snsValues + simulationDataOut->_snsOffsetPerEntityType[entityTypeIndex] + snsCount * simulationDataOut->_indexInEntityType[iTransform];
+			for (i = 0; i < boneCount; i++)
+				((float*)&workScales[sortedIndices[i]])[iLane] = boneSnsPtr[i][3];
+		}
+	}
+
+	// get Rest relative, root is relative to the cache root orientation
+	if (computeRestRelative)
+	{
+		__m128 inverse[4];
+		for (c = 0; c < 4; c++)
+			inverse[c] = _mm_set_ps(boneOrientationPtrDest[3][0][c], boneOrientationPtrDest[2][0][c], boneOrientationPtrDest[1][0][c], boneOrientationPtrDest[0][0][c]);
+		inverse[3] = _mm_xor_ps(inverse[3], signBit);
+		glmMultQuaternion4(inverse, workOri[0], workRestRelativeOri[0]);
+		glmNormalizeQuaternion4(workRestRelativeOri[0]);
+
+		for (i = 1; i < boneCount; i++)
+		{
+			__m128 localOri[4];
+			__m128 parentOri[4];
+			for (c = 0; c < 4; c++)
+				localOri[c] = _mm_set1_ps(boneLocalOri[i][c]);
+			glmMultQuaternion4(workOri[parents[i]], localOri, parentOri);
+			parentOri[3] = _mm_xor_ps(parentOri[3], signBit);
+			glmMultQuaternion4(parentOri, workOri[i], workRestRelativeOri[i]);
+			glmNormalizeQuaternion4(workRestRelativeOri[i]);
+		}
+
+		// multiply RR (add delta)
+		for (i = 0; i < boneCount; i++)
+		{
+			__m128 delta[4];
+			for (c = 0; c < 4; c++)
+				delta[c] = _mm_set_ps(deltaOri[3][i * deltaStride[3] + c], deltaOri[2][i * deltaStride[2] + c], deltaOri[1][i * deltaStride[1] + c], deltaOri[0][i * deltaStride[0] + c]);
+			glmMultQuaternion4(workRestRelativeOri[i], delta, workRestRelativeOri[i]);
+			glmNormalizeQuaternion4(workRestRelativeOri[i]);
+		}
+	}
+
+	// full frame postures : copy maya RR posture to local RR posture. frame RR are in Golaem order.
+	for (iLane = 0; iLane < laneCount; iLane++)
+	{
+		const GlmEntityTransform* tr = &entityTransforms[laneTransforms[iLane]];
+		int postureIndex = postureIndices[laneTransforms[iLane]];
+		if (postureIndex == -1)
+			continue;
+
+		memcpy(entityTransforms->_restRelativeOri, tr->_posturesOrientations + postureIndex * tr->_postureBoneCount, boneCount * sizeof(float[4]));
+		glmApplyLaterBoneEdits(tr, history, entityTransforms->_restRelativeOri);
+		for (i = 0; i < boneCount; i++)
+		{
+			for (c = 0; c < 4; c++)
+				((float*)&workRestRelativeOri[i][c])[iLane] = entityTransforms->_restRelativeOri[i][c];
+		}
+	}
+
+	// compute back world pos/ori from RR
+	skeletonScale = _mm_loadu_ps(skeletonScales);
+	for (c = 0; c < 4; c++)
+		workOri[0][c] = _mm_set_ps(boneOrientationPtrDest[3][0][c], boneOrientationPtrDest[2][0][c], boneOrientationPtrDest[1][0][c], boneOrientationPtrDest[0][0][c]);
+	for (c = 0; c < 3; c++)
+		workPos[0][c] = _mm_set_ps(bonePositionsPtrDest[3][0][c], bonePositionsPtrDest[2][0][c], bonePositionsPtrDest[1][0][c], bonePositionsPtrDest[0][0][c]);
+	for (i = 1; i < boneCount; i++)
+	{
+		unsigned int boneParentIndex = parents[i];
+		__m128 localOri[4];
+		__m128 ori[4];
+		__m128 posScaled[3];
+		__m128 pos[3];
+
+		for (c = 0; c < 4; c++)
+			localOri[c] = _mm_set1_ps(boneLocalOri[i][c]);
+		glmMultQuaternion4(workOri[boneParentIndex], localOri, ori);
+		glmMultQuaternion4(ori, workRestRelativeOri[i], workOri[i]);
+
+		for (c = 0; c < 3; c++)
+		{
+			__m128 localPos = _mm_set1_ps(boneLocalPos[i][c]);
+			if (snsCount)
+				localPos = _mm_mul_ps(localPos, workScales[boneParentIndex]);
+			posScaled[c] = _mm_mul_ps(localPos, skeletonScale);
+		}
+		glmMultVec3Quaternion4(workOri[boneParentIndex], posScaled, pos);
+		for (c = 0; c < 3; c++)
+			workPos[i][c] = _mm_add_ps(workPos[boneParentIndex][c], pos[c]);
+	}
+
+	// remap values -> put back values in cache order
+	for (iLane = 0; iLane < laneCount; iLane++)
+	{
+		for (i = 0; i < boneCount; i++)
+		{
+			unsigned int sortedBoneIndex = sortedIndices[i];
+			for (c = 0; c < 4; c++)
+				boneOrientationPtrDest[iLane][i][c] = ((float*)&workOri[sortedBoneIndex][c])[iLane];
+			for (c = 0; c < 3; c++)
+				bonePositionsPtrDest[iLane][i][c] = ((float*)&workPos[sortedBoneIndex][c])[iLane];
+		}
+	}
+}
+#else
+//---------------------------------------------------------------------------
+static void glmApplyEntityBoneEdit(GlmSimulationData* simulationDataIn, GlmEntityTransform* entityTransforms, unsigned int iTransform, int postureIndex, GlmHistory* history, GlmSimulationData* simulationDataOut, GlmFrameData* frameOut, const uint16_t* sortedIndices)
+{
+	GlmEntityTransform* tr = &entityTransforms[iTransform];
+	uint16_t entityTypeIndex = simulationDataIn->_entityTypes[tr->_sourceIndexInCrowdField];
+	unsigned int boneCount = simulationDataIn->_boneCount[entityTypeIndex];
+	unsigned int localBoneOffset = history->_localBoneOffset[entityTypeIndex];
+	const float(*boneLocalOri)[4] = (const float(*)[4])history->_localBoneOrientation + localBoneOffset;
+	const float(*boneLocalPos)[3] = (const float(*)[3])history->_localBonePosition + localBoneOffset;
+	uint32_t offsetDest = simulationDataOut->_iBoneOffsetPerEntityType[entityTypeIndex] + tr->_postureBoneCount * simulationDataOut->_indexInEntityType[iTransform];
+	float(*bonePositionsPtrDest)[3] = frameOut->_bonePositions + offsetDest;
+	float(*boneOrientationPtrDest)[4] = frameOut->_boneOrientations + offsetDest;
+	uint32_t *parentIndex = history->_localBoneParent + localBoneOffset;
+	float skeletonScale = simulationDataIn->_scales[tr->_sourceIndexInCrowdField] * tr->_scale;
+	uint16_t snsCount = simulationDataIn->_snsCountPerEntityType[entityTypeIndex];
+	unsigned int i;
+
+	if (postureIndex == -1)
+	{
+		// map posture to hierarchical order so we can have hierarchical operations
+		for (i = 0;i<boneCount;i++)
+		{
+			memcpy(entityTransforms->_sortedBonesWorldOri[sortedIndices[i]], boneOrientationPtrDest[i], sizeof(float) * 4);
+		}
+			
+		// get Rest relative
+		glmComputeRestRelativesOrientationFromPosture((const float(*)[4])entityTransforms->_sortedBonesWorldOri, boneLocalOri, parentIndex, boneOrientationPtrDest[0], entityTransforms->_restRelativeOri, boneCount);
+		
+		// multiply RR (add delta)
+		for (i = 0;i<boneCount;i++)
+		{
+			float workOri[4];
+			
+			glmMultQuaternion(entityTransforms->_restRelativeOri[i], tr->_boneRestRelativeOrientation[i], workOri);
+			glmNormalizeQuaternion(workOri);
+			memcpy(entityTransforms->_restRelativeOri[i], workOri, sizeof(float) * 4);
+		}
+	}
+	else
+	{
+		// copy maya RR posture to local RR posture. frame RR are in Golaem order.
+		memcpy(entityTransforms->_restRelativeOri, tr->_posturesOrientations + postureIndex * tr->_postureBoneCount, boneCount * sizeof(float[4]));
+		glmApplyLaterBoneEdits(tr, history, entityTransforms->_restRelativeOri);
+	}
+
+	// compute back world pos/ori from RR
+	if (!snsCount)
+	{
+		glmComputePostureFromRestRelativeOrientations(entityTransforms->_sortedBonesWorldPos, entityTransforms->_sortedBonesWorldOri, boneLocalOri, boneLocalPos, parentIndex, 
+			bonePositionsPtrDest[0], boneOrientationPtrDest[0], (const float(*)[4])entityTransforms->_restRelativeOri, skeletonScale, boneCount);
+	}
+	else
+	{
+		uint32_t offsetSns = simulationDataOut->_snsOffsetPerEntityType[entityTypeIndex] + snsCount * simulationDataOut->_indexInEntityType[iTransform];
+		float(*boneSnsPtr)[4] = frameOut->_snsValues + offsetSns;
+
+		for (i = 0;i<boneCount;i++)
+		{
+			memcpy(entityTransforms->_sortedBonesScale[sortedIndices[i]], boneSnsPtr[i], sizeof(float) * 4);
+		}
+		glmComputePostureFromRestRelativeOrientationsScales(entityTransforms->_sortedBonesWorldPos, entityTransforms->_sortedBonesWorldOri, boneLocalOri, 
+			boneLocalPos, parentIndex, bonePositionsPtrDest[0], boneOrientationPtrDest[0], (const float(*)[4])entityTransforms->_restRelativeOri, skeletonScale, boneCount, (const float(*)[4])entityTransforms->_sortedBonesScale);
+	}
+
+	// remap values -> put back values in cache order
+	for (i = 0;i<boneCount;i++)
+	{
+		memcpy(boneOrientationPtrDest[i], entityTransforms->_sortedBonesWorldOri[sortedIndices[i]], sizeof(float) * 4);
+		memcpy(bonePositionsPtrDest[i], entityTransforms->_sortedBonesWorldPos[sortedIndices[i]], sizeof(float) * 3);
+	}
+}
+#endif
+
+//---------------------------------------------------------------------------
+// bone edit : when the posture has been modified for 1 frame or whole simulation.
+// Edited entities are grouped per entity type so the hierarchy tables are decoded once per type, and processed 4 at a time with SSE
+static void glmApplyBoneEdits(GlmSimulationData* simulationDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmSimulationData* simulationDataOut, GlmFrameData* frameOut, int currentFrame)
+{
+	int* postureIndices;
+	unsigned int* editedTransforms;
+	unsigned int* entityTypeStart;
+	unsigned int editedCount = 0;
+	unsigned int maxBoneCount = 0;
+	uint16_t* sortedIndices;
+	uint16_t* parents;
+	unsigned int iTransform;
+	unsigned int entityTypeIndex;
+	unsigned int i;
+#ifdef GLMC_USE_SSE
+	void* workAllocation;
+	__m128(*workOri)[4];
+	__m128(*workPos)[3];
+	__m128(*workRestRelativeOri)[4];
+	__m128* workScales;
+#endif
+
+	// edited entities per entity type
+	postureIndices = (int*)GLMC_MALLOC((entityTransformCount + 1) * sizeof(int));
+	entityTypeStart = (unsigned int*)GLMC_MALLOC((simulationDataIn->_entityTypeCount + 1) * sizeof(unsigned int));
+	memset(entityTypeStart, 0, (simulationDataIn->_entityTypeCount + 1) * sizeof(unsigned int));
+	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+	{
+		GlmEntityTransform* tr = &entityTransforms[iTransform];
+
+		// search for a full frame rest relative posture
+		postureIndices[iTransform] = glmFindPostureIndex(tr, currentFrame);
+
+		// no RR to apply ?
+		if (tr->_boneRestRelativeOrientation == 0 && postureIndices[iTransform] == -1)
+			continue;
+
+		entityTypeIndex = simulationDataIn->_entityTypes[tr->_sourceIndexInCrowdField];
+		entityTypeStart[entityTypeIndex + 1]++;
+		editedCount++;
+		if (simulationDataIn->_boneCount[entityTypeIndex] > maxBoneCount)
+			maxBoneCount = simulationDataIn->_boneCount[entityTypeIndex];
+	}
+	if (editedCount == 0)
+	{
+		GLMC_FREE(postureIndices);
+		GLMC_FREE(entityTypeStart);
+		return;
+	}
+
+	for (entityTypeIndex = 0; entityTypeIndex < simulationDataIn->_entityTypeCount; entityTypeIndex++)
+	{
+		entityTypeStart[entityTypeIndex + 1] += entityTypeStart[entityTypeIndex];
+	}
+	editedTransforms = (unsigned int*)GLMC_MALLOC(editedCount * sizeof(unsigned int));
+	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+	{
+		GlmEntityTransform* tr = &entityTransforms[iTransform];
+		if (tr->_boneRestRelativeOrientation == 0 && postureIndices[iTransform] == -1)
+			continue;
+		// entityTypeStart[type] moves to the end of the type range, it is shifted back below
+		editedTransforms[entityTypeStart[simulationDataIn->_entityTypes[tr->_sourceIndexInCrowdField]]++] = iTransform;
+	}
+	for (entityTypeIndex = simulationDataIn->_entityTypeCount; entityTypeIndex > 0; entityTypeIndex--)
+	{
+		entityTypeStart[entityTypeIndex] = entityTypeStart[entityTypeIndex - 1];
+	}
+	entityTypeStart[0] = 0;
+
+	sortedIndices = (uint16_t*)GLMC_MALLOC(maxBoneCount * sizeof(uint16_t));
+	parents = (uint16_t*)GLMC_MALLOC(maxBoneCount * sizeof(uint16_t));
+#ifdef GLMC_USE_SSE
+	workAllocation = GLMC_MALLOC(maxBoneCount * sizeof(__m128) * 12 + 16);
+	workOri = (__m128(*)[4])((char*)workAllocation + (16 - ((size_t)workAllocation & 15)) % 16);
+	workPos = (__m128(*)[3])(workOri + maxBoneCount);
+	workRestRelativeOri = (__m128(*)[4])(workPos + maxBoneCount);
+	workScales = (__m128*)(workRestRelativeOri + maxBoneCount);
+#endif
+
+	for (entityTypeIndex = 0; entityTypeIndex < simulationDataIn->_entityTypeCount; entityTypeIndex++)
+	{
+		unsigned int first = entityTypeStart[entityTypeIndex];
+		unsigned int last = entityTypeStart[entityTypeIndex + 1];
+		const uint32_t* parentIndex = history->_localBoneParent + history->_localBoneOffset[entityTypeIndex];
+
+		if (first == last)
+			continue;
+
+		// hierarchical order : low 16 bits = sorted index of cache bone i, high 16 bits = parent sorted index of sorted bone i
+		for (i = 0; i < simulationDataIn->_boneCount[entityTypeIndex]; i++)
+		{
+			sortedIndices[i] = (uint16_t)(parentIndex[i] & 0xFFFF);
+			parents[i] = (uint16_t)(parentIndex[i] >> 16);
+		}
+
+#ifdef GLMC_USE_SSE
+		for (i = first; i < last; i += 4)
+		{
+			glmApplyBoneEditBatch(simulationDataIn, entityTransforms, editedTransforms + i, postureIndices, (last - i < 4) ? last - i : 4, history, simulationDataOut, frameOut, sortedIndices, parents, workOri, workPos, workRestRelativeOri, workScales);
+		}
+#else
+		for (i = first; i < last; i++)
+		{
+			glmApplyEntityBoneEdit(simulationDataIn, entityTransforms, editedTransforms[i], postureIndices[editedTransforms[i]], history, simulationDataOut, frameOut, sortedIndices);
+		}
+#endif
+	}
+
+#ifdef GLMC_USE_SSE
+	GLMC_FREE(workAllocation);
+#endif
+	GLMC_FREE(sortedIndices);
+	GLMC_FREE(parents);
+	GLMC_FREE(editedTransforms);
+	GLMC_FREE(entityTypeStart);
+	GLMC_FREE(postureIndices);
+}
+
+//---------------------------------------------------------------------------
+typedef struct GlmClothTransformTask
+{
+	GlmFrameData* _frameOut;
+	GlmEntityTransform* _entityTransforms;
+	uint32_t* _clothTransformIndices; // entity transform of each output cloth entity
+	uint32_t* _clothVertexCounts;
+	uint32_t* _clothEntityIndices; // output cloth entity of each task item, NULL when items are all the cloth entities in order
+} GlmClothTransformTask;
+
+//---------------------------------------------------------------------------
+static void glmTransformClothEntities(void* userData, unsigned int firstClothEntity, unsigned int lastClothEntity)
+{
+	GlmClothTransformTask* task = (GlmClothTransformTask*)userData;
+	GlmFrameData* frameOut = task->_frameOut;
+	unsigned int iItem;
+
+	for (iItem = firstClothEntity; iItem < lastClothEntity; iItem++)
+	{
+		unsigned int iClothEntity = task->_clothEntityIndices ? task->_clothEntityIndices[iItem] : iItem;
+		const GlmEntityTransform* transform = &task->_entityTransforms[task->_clothTransformIndices[iItem]];
+		float clothMin[] = {FLT_MAX,FLT_MAX,FLT_MAX};
+		float clothMax[] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
+		float maxExtent;
+
+		glmSimdKernels->_transformClothVertices((const float(*)[3])transform->_clothVerticesSource, frameOut->_clothVertices + frameOut->_clothEntityFirstMeshVertex[iClothEntity],
+			task->_clothVertexCounts[iItem], transform->_matrix, transform->_scalePivot, transform->_scale, clothMin, clothMax);
+
+		frameOut->_clothEntityQuantizationReference[iClothEntity][0] = (clothMax[0] + clothMin[0]) * 0.5f;
+		frameOut->_clothEntityQuantizationReference[iClothEntity][1] = (clothMax[1] + clothMin[1]) * 0.5f;
+		frameOut->_clothEntityQuantizationReference[iClothEntity][2] = (clothMax[2] + clothMin[2]) * 0.5f;
+
+		maxExtent =  (clothMax[0] - clothMin[0]) * 0.5f;
+		maxExtent = (((clothMax[1] - clothMin[1]) * 0.5f)>maxExtent)?((clothMax[1] - clothMin[1]) * 0.5f):maxExtent;
+		maxExtent = (((clothMax[2] - clothMin[2]) * 0.5f)>maxExtent)?((clothMax[2] - clothMin[2]) * 0.5f):maxExtent;
+
+		frameOut->_clothEntityQuantizationMaxExtent[iClothEntity] = maxExtent;
+	}
+}
+
 //---------------------------------------------------------------------------
 GlmSimulationCacheStatus glmCreateModifiedFrameData(GlmSimulationData* simulationDataIn, GlmFrameData* frameDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmSimulationData* simulationDataOut, GlmFrameData** frameDataOut, int currentFrame, const char * filePathModel, const char * cacheDirectory)
 {
 	GlmFrameData *frameOut;
 	unsigned int i;
 	unsigned int iTransform;
-	unsigned int iFrame;
 	unsigned int entityTypeIndex;
 
 	// entityType
@@ -5492,445 +8662,1882 @@ GlmSimulationCacheStatus glmCreateModifiedFrameData(GlmSimulationData* simulatio
 				const GlmFrameData* frameDataInput1 = framesToLoad[framesLoadedIndex]._frame;
 				const GlmFrameData* frameDataInput2 = framesToLoad[framesLoadedIndex+1]._frame;
 
-				if (frameDataInput1 || frameDataInput2)
-				{
-					if (!frameDataInput1 || !frameDataInput2)
-					{
-						// any chance of missing 1 data?
-						const GlmFrameData* frameDataInput = frameDataInput1 ? frameDataInput1 : frameDataInput2;
-						glmCopyEntityFrameData(frameDataInput, frameOut, simulationDataIn, simulationDataOut,
-							entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
-							geoBeSourceIndex, geoBeDestinationIndex,
-							&entityTransforms[iTransform]);
-					}
-					else
-					{
-						glmInterpolateEntityFrameData(frameDataInput1, frameDataInput2, fraction, frameOut, simulationDataIn, simulationDataOut,
-							entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
-							geoBeSourceIndex, geoBeDestinationIndex,
-							&entityTransforms[iTransform]);
-					}
-				}
-				else
-				{
-					entityTransforms[iTransform]._outOfCache = 1;
-					glmVoidEntityFrameData(frameOut, simulationDataIn, simulationDataOut,
-						entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
-						geoBeDestinationIndex);
-				}
-			}
-		}
+				if (frameDataInput1 || frameDataInput2)
+				{
+					if (!frameDataInput1 || !frameDataInput2)
+					{
+						// any chance of missing 1 data?
+						const GlmFrameData* frameDataInput = frameDataInput1 ? frameDataInput1 : frameDataInput2;
+						glmCopyEntityFrameData(frameDataInput, frameOut, simulationDataIn, simulationDataOut,
+							entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
+							geoBeSourceIndex, geoBeDestinationIndex,
+							&entityTransforms[iTransform]);
+					}
+					else
+					{
+						glmInterpolateEntityFrameData(frameDataInput1, frameDataInput2, fraction, frameOut, simulationDataIn, simulationDataOut,
+							entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
+							geoBeSourceIndex, geoBeDestinationIndex,
+							&entityTransforms[iTransform]);
+					}
+				}
+				else
+				{
+					entityTransforms[iTransform]._outOfCache = 1;
+					glmVoidEntityFrameData(frameOut, simulationDataIn, simulationDataOut,
+						entityTransforms[iTransform]._sourceIndexInCrowdField, iTransform,
+						geoBeDestinationIndex);
+				}
+			}
+		}
+	}
+
+	// bone edit : when the posture has been modified for 1 frame or whole simulation 
+	glmApplyBoneEdits(simulationDataIn, entityTransforms, entityTransformCount, history, simulationDataOut, frameOut, currentFrame);
+
+	// cloth
+	if (totalClothEntityCount)
+	{
+		int clothAv = 0;
+		GlmClothTransformTask task;
+
+		uint32_t* clothIndicesDest;
+		uint32_t* clothMeshVertexCountDest;
+		uint32_t clothVerticesDest = 0;
+
+		// allocate cloth
+		glmCreateClothData( simulationDataOut, frameOut, totalClothEntityCount, totalClothTotalIndices, totalClothTotalVertices );
+
+		clothIndicesDest = frameOut->_clothMeshIndicesInCharAssets;
+		clothMeshVertexCountDest = frameOut->_clothMeshVertexCount;
+
+		task._frameOut = frameOut;
+		task._entityTransforms = entityTransforms;
+		task._clothTransformIndices = (uint32_t*)GLMC_MALLOC(totalClothEntityCount * sizeof(uint32_t));
+		task._clothVertexCounts = (uint32_t*)GLMC_MALLOC(totalClothEntityCount * sizeof(uint32_t));
+		task._clothEntityIndices = NULL;
+
+		// cloth layout, vertices are transformed per cloth entity afterwards
+		for (i = 0 ; i < entityTransformCount; ++i)
+		{
+			// patch EntityTransform for cloth
+			frameOut->_entityClothIndex[i] = entityTransforms[i]._useCloth ? entityTransforms[i]._clothedEntityIndex : -1;
+			if (frameOut->_entityClothIndex[i] != -1)
+			{
+				unsigned int iVertexGroup;
+				unsigned int meshIndexCount;
+				uint32_t vertexCount = 0;
+
+				uint32_t* clothIndicesSource = entityTransforms[i]._clothIndicesSource;
+				uint32_t* clothMeshVertexCountSource = entityTransforms[i]._clothMeshVertexCountSource;
+
+				// helpers for reading
+				frameOut->_clothEntityFirstAssetMeshIndex[clothAv] = (uint32_t)(clothIndicesDest - frameOut->_clothMeshIndicesInCharAssets);  // write indices offset when beginning a new cloth entity for helper
+				frameOut->_clothEntityFirstMeshVertex[clothAv] = clothVerticesDest; // write vertices offset when beginning a new cloth entity for helper
+
+				meshIndexCount = frameDataIn->_clothEntityMeshCount[entityTransforms[i]._clothedEntityIndex];
+				frameOut->_clothEntityMeshCount[clothAv] = meshIndexCount;
+				memcpy( clothMeshVertexCountDest, clothMeshVertexCountSource, sizeof(uint32_t) * meshIndexCount );
+				memcpy( clothIndicesDest, clothIndicesSource, sizeof(uint32_t) * meshIndexCount );
+
+				clothMeshVertexCountDest += meshIndexCount;
+				clothIndicesDest += meshIndexCount;
+
+				for (iVertexGroup = 0; iVertexGroup < meshIndexCount; iVertexGroup++)
+					vertexCount += clothMeshVertexCountSource[iVertexGroup];
+
+				task._clothTransformIndices[clothAv] = (uint32_t)i;
+				task._clothVertexCounts[clothAv] = vertexCount;
+				clothVerticesDest += vertexCount;
+				clothAv++;
+			}
+		}
+
+		// transform vertices and compute cloth reference/extent
+		glmRunParallelFor(glmTransformClothEntities, &task, (unsigned int)clothAv);
+
+		GLMC_FREE(task._clothVertexCounts);
+		GLMC_FREE(task._clothTransformIndices);
+	}
+
+	for (i = 0; i < totalFrameOffsets; i++)
+	{
+		if (framesToLoad[i]._frame && framesToLoad[i]._frameIndex != currentFrame)
+		{
+			glmDestroyFrameData(&framesToLoad[i]._frame, simulationDataIn);
+		}
+	}
+	GLMC_FREE(framesToLoad);
+
+	return GSC_SUCCESS;
+}
+
+static void glmInterpolateFrameDataBonesScalar(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode)
+{
+	static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
+	float tempQuat[4];
+	uint32_t iValue;
+
+	(void)mode;
+	// interpolate posture positions / orientations
+	for (iValue = firstBoneValue; iValue < lastBoneValue; iValue++)
+	{
+		float *q1;
+		float *q2;
+		float *qResult;
+		float cosom;
+
+		result->_bonePositions[iValue][0] = interpolateFloat(frameData1->_bonePositions[iValue][0],frameData2->_bonePositions[iValue][0],ratio);
+		result->_bonePositions[iValue][1] = interpolateFloat(frameData1->_bonePositions[iValue][1],frameData2->_bonePositions[iValue][1],ratio);
+		result->_bonePositions[iValue][2] = interpolateFloat(frameData1->_bonePositions[iValue][2],frameData2->_bonePositions[iValue][2],ratio);
+
+		// see interpolate_noFactorRangeCheck, can't make quaternion here
+		q1 = frameData1->_boneOrientations[iValue];
+		q2 = frameData2->_boneOrientations[iValue];
+		qResult = result->_boneOrientations[iValue];
+
+		cosom = (q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3]);
+
+		if (cosom < 0.f)
+		{
+			tempQuat[0] = -q2[0];
+			tempQuat[1] = -q2[1];
+			tempQuat[2] = -q2[2];
+			tempQuat[3] = -q2[3];
+		}
+		else
+		{
+			tempQuat[0] = q2[0];
+			tempQuat[1] = q2[1];
+			tempQuat[2] = q2[2];
+			tempQuat[3] = q2[3];
+		}
+
+		// linear interp
+		qResult[0] = interpolateFloat(q1[0], tempQuat[0], ratio);
+		qResult[1] = interpolateFloat(q1[1], tempQuat[1], ratio);
+		qResult[2] = interpolateFloat(q1[2], tempQuat[2], ratio);
+		qResult[3] = interpolateFloat(q1[3], tempQuat[3], ratio);
+
+		// normalize is needed after per component linear interpolation
+		{
+			float factor = (1.f / sqrtf(qResult[0] * qResult[0] + qResult[1] * qResult[1] + qResult[2] * qResult[2] + qResult[3] * qResult[3] + very_small_float));
+			qResult[0] *= factor;
+			qResult[1] *= factor;
+			qResult[2] *= factor;
+			qResult[3] *= factor;
+		}
+	}
+}
+
+#ifdef GLMC_USE_SSE
+static void glmInterpolateFrameDataBonesSse2(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode)
+{
+	static const float very_small_float = 1.0e-037f;
+	uint32_t iValue;
+
+	// 8 bones per iteration. Same operations in the same order as the scalar loop, so strict mode gives the same bits (unless the compiler contracts the scalar loop to FMA)
+	iValue = firstBoneValue;
+	{
+		const __m128 vRatio = _mm_set1_ps(ratio);
+		const __m128 vZero = _mm_setzero_ps();
+		const __m128 vSignBit = _mm_set1_ps(-0.f);
+		const __m128 vOne = _mm_set1_ps(1.f);
+		const __m128 vHalf = _mm_set1_ps(0.5f);
+		const __m128 vThreeHalves = _mm_set1_ps(1.5f);
+		const __m128 vVerySmall = _mm_set1_ps(very_small_float);
+
+		for (; iValue + 8 <= lastBoneValue; iValue += 8)
+		{
+			const float* p1 = frameData1->_bonePositions[iValue];
+			const float* p2 = frameData2->_bonePositions[iValue];
+			float* pResult = result->_bonePositions[iValue];
+			uint32_t iFloat;
+			uint32_t iGroup;
+
+			// positions are lerped component wise, no need to deinterleave
+			for (iFloat = 0; iFloat < 24; iFloat += 4)
+			{
+				__m128 a = _mm_loadu_ps(p1 + iFloat);
+				__m128 b = _mm_loadu_ps(p2 + iFloat);
+				_mm_storeu_ps(pResult + iFloat, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vRatio)));
+			}
+
+			for (iGroup = iValue; iGroup < iValue + 8; iGroup += 4)
+			{
+				__m128 x1 = _mm_loadu_ps(frameData1->_boneOrientations[iGroup]);
+				__m128 y1 = _mm_loadu_ps(frameData1->_boneOrientations[iGroup + 1]);
+				__m128 z1 = _mm_loadu_ps(frameData1->_boneOrientations[iGroup + 2]);
+				__m128 w1 = _mm_loadu_ps(frameData1->_boneOrientations[iGroup + 3]);
+				__m128 x2 = _mm_loadu_ps(frameData2->_boneOrientations[iGroup]);
+				__m128 y2 = _mm_loadu_ps(frameData2->_boneOrientations[iGroup + 1]);
+				__m128 z2 = _mm_loadu_ps(frameData2->_boneOrientations[iGroup + 2]);
+				__m128 w2 = _mm_loadu_ps(frameData2->_boneOrientations[iGroup + 3]);
+				__m128 cosom;
+				__m128 sign;
+				__m128 norm;
+				__m128 factor;
+
+				_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+				_MM_TRANSPOSE4_PS(x2, y2, z2, w2);
+
+				// hemisphere correction, flip frame 2 quaternion sign where cosom < 0
+				cosom = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x2), _mm_mul_ps(y1, y2)), _mm_mul_ps(z1, z2)), _mm_mul_ps(w1, w2));
+				sign = _mm_and_ps(_mm_cmplt_ps(cosom, vZero), vSignBit);
+				x2 = _mm_xor_ps(x2, sign);
+				y2 = _mm_xor_ps(y2, sign);
+				z2 = _mm_xor_ps(z2, sign);
+				w2 = _mm_xor_ps(w2, sign);
+
+				x1 = _mm_add_ps(x1, _mm_mul_ps(_mm_sub_ps(x2, x1), vRatio));
+				y1 = _mm_add_ps(y1, _mm_mul_ps(_mm_sub_ps(y2, y1), vRatio));
+				z1 = _mm_add_ps(z1, _mm_mul_ps(_mm_sub_ps(z2, z1), vRatio));
+				w1 = _mm_add_ps(w1, _mm_mul_ps(_mm_sub_ps(w2, w1), vRatio));
+
+				norm = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x1), _mm_mul_ps(y1, y1)), _mm_mul_ps(z1, z1)), _mm_mul_ps(w1, w1)), vVerySmall);
+				if (mode == GSC_INTERPOLATION_FAST)
+				{
+					// rsqrt estimate + one Newton-Raphson step
+					factor = _mm_rsqrt_ps(norm);
+					factor = _mm_mul_ps(factor, _mm_sub_ps(vThreeHalves, _mm_mul_ps(_mm_mul_ps(vHalf, norm), _mm_mul_ps(factor, factor))));
+				}
+				else
+				{
+					factor = _mm_div_ps(vOne, _mm_sqrt_ps(norm));
+				}
+				x1 = _mm_mul_ps(x1, factor);
+				y1 = _mm_mul_ps(y1, factor);
+				z1 = _mm_mul_ps(z1, factor);
+				w1 = _mm_mul_ps(w1, factor);
+
+				_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+				_mm_storeu_ps(result->_boneOrientations[iGroup], x1);
+				_mm_storeu_ps(result->_boneOrientations[iGroup + 1], y1);
+				_mm_storeu_ps(result->_boneOrientations[iGroup + 2], z1);
+				_mm_storeu_ps(result->_boneOrientations[iGroup + 3], w1);
+			}
+		}
+	}
+	glmInterpolateFrameDataBonesScalar(frameData1, frameData2, ratio, result, iValue, lastBoneValue, mode);
+}
+#endif
+
+#ifdef GLMC_USE_AVX2
+// glmInterpolateFrameDataBonesSse2 on 8 bones per register
+GLMC_TARGET_AVX2 static void glmInterpolateFrameDataBonesAvx2(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode)
+{
+	const __m256 vRatio = _mm256_set1_ps(ratio);
+	const __m256 vZero = _mm256_setzero_ps();
+	const __m256 vSignBit = _mm256_set1_ps(-0.f);
+	const __m256 vOne = _mm256_set1_ps(1.f);
+	const __m256 vHalf = _mm256_set1_ps(0.5f);
+	const __m256 vThreeHalves = _mm256_set1_ps(1.5f);
+	const __m256 vVerySmall = _mm256_set1_ps(1.0e-037f);
+	uint32_t iValue = firstBoneValue;
+
+	for (; iValue + 8 <= lastBoneValue; iValue += 8)
+	{
+		const float* p1 = frameData1->_bonePositions[iValue];
+		const float* p2 = frameData2->_bonePositions[iValue];
+		float* pResult = result->_bonePositions[iValue];
+		__m256 q1[4];
+		__m256 q2[4];
+		__m256 cosom;
+		__m256 sign;
+		__m256 norm;
+		__m256 factor;
+		uint32_t iFloat;
+		unsigned int iComp;
+
+		// positions are lerped component wise, no need to deinterleave
+		for (iFloat = 0; iFloat < 24; iFloat += 8)
+		{
+			__m256 a = _mm256_loadu_ps(p1 + iFloat);
+			__m256 b = _mm256_loadu_ps(p2 + iFloat);
+			_mm256_storeu_ps(pResult + iFloat, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), vRatio)));
+		}
+
+		for (iComp = 0; iComp < 4; iComp++)
+		{
+			q1[iComp] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(frameData1->_boneOrientations[iValue + iComp])), _mm_loadu_ps(frameData1->_boneOrientations[iValue + iComp + 4]), 1);
+			q2[iComp] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(frameData2->_boneOrientations[iValue + iComp])), _mm_loadu_ps(frameData2->_boneOrientations[iValue + iComp + 4]), 1);
+		}
+		glmTranspose4x2(q1);
+		glmTranspose4x2(q2);
+
+		// hemisphere correction, flip frame 2 quaternion sign where cosom < 0
+		cosom = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(q1[0], q2[0]), _mm256_mul_ps(q1[1], q2[1])), _mm256_mul_ps(q1[2], q2[2])), _mm256_mul_ps(q1[3], q2[3]));
+		sign = _mm256_and_ps(_mm256_cmp_ps(cosom, vZero, _CMP_LT_OQ), vSignBit);
+		for (iComp = 0; iComp < 4; iComp++)
+		{
+			q2[iComp] = _mm256_xor_ps(q2[iComp], sign);
+			q1[iComp] = _mm256_add_ps(q1[iComp], _mm256_mul_ps(_mm256_sub_ps(q2[iComp], q1[iComp]), vRatio));
+		}
+
+		norm = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(q1[0], q1[0]), _mm256_mul_ps(q1[1], q1[1])), _mm256_mul_ps(q1[2], q1[2])), _mm256_mul_ps(q1[3], q1[3])), vVerySmall);
+		if (mode == GSC_INTERPOLATION_FAST)
+		{
+			// rsqrt estimate + one Newton-Raphson step
+			factor = _mm256_rsqrt_ps(norm);
+			factor = _mm256_mul_ps(factor, _mm256_sub_ps(vThreeHalves, _mm256_mul_ps(_mm256_mul_ps(vHalf, norm), _mm256_mul_ps(factor, factor))));
+		}
+		else
+		{
+			factor = _mm256_div_ps(vOne, _mm256_sqrt_ps(norm));
+		}
+		for (iComp = 0; iComp < 4; iComp++)
+			q1[iComp] = _mm256_mul_ps(q1[iComp], factor);
+
+		glmTranspose4x2(q1);
+		for (iComp = 0; iComp < 4; iComp++)
+		{
+			_mm_storeu_ps(result->_boneOrientations[iValue + iComp], _mm256_castps256_ps128(q1[iComp]));
+			_mm_storeu_ps(result->_boneOrientations[iValue + iComp + 4], _mm256_extractf128_ps(q1[iComp], 1));
+		}
+	}
+	glmInterpolateFrameDataBonesSse2(frameData1, frameData2, ratio, result, iValue, lastBoneValue, mode);
+}
+#endif
+
+//----------------------------------------------------------------------------
+void glmInterpolateFrameDataBones(const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, uint32_t firstBoneValue, uint32_t lastBoneValue, GlmInterpolationMode mode)
+{
+	glmSimdKernels->_interpolateFrameDataBones(frameData1, frameData2, ratio, result, firstBoneValue, lastBoneValue, mode);
+}
+
+#ifdef GLMC_USE_AVX2
+//----------------------------------------------------------------------------
+static int glmCpuSupportsAvx2(void)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return 0;
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) // OS saves AVX registers, AVX
+		return 0;
+	if ((_xgetbv(0) & 6) != 6)
+		return 0;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+//----------------------------------------------------------------------------
+GlmSimdLevel glmSetSimdLevel(GlmSimdLevel level)
+{
+#ifdef GLMC_USE_AVX2
+	if (level >= GSC_SIMD_AVX2 && glmCpuSupportsAvx2())
+	{
+		glmSimdKernels = &glmSimdKernelsAvx2;
+		return GSC_SIMD_AVX2;
+	}
+#endif
+#ifdef GLMC_USE_SSE
+	if (level >= GSC_SIMD_SSE2)
+	{
+		glmSimdKernels = &glmSimdKernelsSse2;
+		return GSC_SIMD_SSE2;
+	}
+#else
+	(void)level;
+#endif
+	glmSimdKernels = &glmSimdKernelsScalar;
+	return GSC_SIMD_SCALAR;
+}
+
+//----------------------------------------------------------------------------
+GlmSimdLevel glmInitSimdDispatch(void)
+{
+	const char* forcedLevel = getenv("GLMC_SIMD_LEVEL");
+	if (forcedLevel)
+	{
+		if (strcmp(forcedLevel, "scalar") == 0)
+			return glmSetSimdLevel(GSC_SIMD_SCALAR);
+		if (strcmp(forcedLevel, "sse2") == 0)
+			return glmSetSimdLevel(GSC_SIMD_SSE2);
+	}
+	return glmSetSimdLevel(GSC_SIMD_AVX2);
+}
+
+//----------------------------------------------------------------------------
+GlmSimdLevel glmGetSimdLevel(void)
+{
+	return glmSimdKernels->_level;
+}
+
+void glmInterpolateFrameData(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result)
+{
+	uint32_t boneValuesCount;
+	uint16_t iEntityType;
+
+	boneValuesCount = 0;
+
+	if (!frameData2)
+		frameData2 = frameData1;
+	if (!frameData1)
+		frameData1 = frameData2;
+	if (!frameData1)
+		return;
+
+	if (frameData1->_simulationContentHashKey != simulationData->_contentHashKey || frameData1->_simulationContentHashKey != frameData2->_simulationContentHashKey)
+		return; // forbidden, different simu
+
+				// compute total bone arrays size :
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	{
+		boneValuesCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_boneCount[iEntityType];
+	}
+
+	glmInterpolateFrameDataBones(frameData1, frameData2, ratio, result, 0, boneValuesCount, GSC_INTERPOLATION_STRICT);
+	glmInterpolateFrameDataAttributes(simulationData, frameData1, frameData2, ratio, result);
+}
+
+void glmInterpolateFrameDataAttributes(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result)
+{
+	uint32_t snsValuesCount;
+	uint32_t blindDataCount;
+	uint32_t geoBehaviorCount;
+	uint32_t iValue;
+	uint16_t iEntityType;
+
+	// interpolate snsValues
+	snsValuesCount = 0;
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	{
+		snsValuesCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_snsCountPerEntityType[iEntityType];
+	}
+	// interpolate posture positions / orientations
+	for (iValue = 0; iValue < snsValuesCount; iValue++)
+	{
+		result->_snsValues[iValue][0] = interpolateFloat(frameData1->_snsValues[iValue][0], frameData2->_snsValues[iValue][0], ratio);
+		result->_snsValues[iValue][1] = interpolateFloat(frameData1->_snsValues[iValue][1], frameData2->_snsValues[iValue][1], ratio);
+		result->_snsValues[iValue][2] = interpolateFloat(frameData1->_snsValues[iValue][2], frameData2->_snsValues[iValue][2], ratio);
+		result->_snsValues[iValue][3] = interpolateFloat(frameData1->_snsValues[iValue][3], frameData2->_snsValues[iValue][3], ratio);
+	}
+
+	// interpolate geoBehavior
+	if (frameData1->_geoBehaviorAnimFrameInfo != NULL)
+	{
+		// arrays only hold the entities of the types with geo behavior
+		geoBehaviorCount = 0;
+		for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+		{
+			if (simulationData->_hasGeoBehavior[iEntityType])
+				geoBehaviorCount += simulationData->_entityCountPerEntityType[iEntityType];
+		}
+
+		// IDs and modes should not be interpolated, animframeinfo only on "current" part, so just copy everything from frame1 and change what needs to be changed
+		memcpy(result->_geoBehaviorAnimFrameInfo, frameData1->_geoBehaviorAnimFrameInfo, sizeof(float) * 3 * geoBehaviorCount);
+		memcpy(result->_geoBehaviorBlendModes, frameData1->_geoBehaviorBlendModes, sizeof(uint8_t) * geoBehaviorCount);
+		memcpy(result->_geoBehaviorGeometryIds, frameData1->_geoBehaviorGeometryIds, sizeof(uint16_t) * geoBehaviorCount);
+
+		for (iValue = 0; iValue < geoBehaviorCount; iValue++) // beware !! this should be processed in entityType/entity order but here order does not matter as we interpolate all
+		{
+			// animFrameInfo 0 = current, 
+			float frame1Current = frameData1->_geoBehaviorAnimFrameInfo[iValue][0];
+			float frame2Current = frameData2->_geoBehaviorAnimFrameInfo[iValue][0];
+			float* resultCurrent = &(result->_geoBehaviorAnimFrameInfo[iValue][0]);
+
+			if (frame1Current > frame2Current)
+			{
+				float startAttribute = frameData1->_geoBehaviorAnimFrameInfo[iValue][1];
+				float stopAttribute = frameData1->_geoBehaviorAnimFrameInfo[iValue][2];
+
+				// in case of loop behavior, with a cycle [5-25], we can have val1 = 23.5 & val2 = 5.5
+				// we have to interpolate 23.5 with 23.5 + 5.5 and to offset the result in the range of the cycle
+				float frameStep = (stopAttribute - frame1Current) + (frame2Current - startAttribute);
+				float interFrame = frame1Current + frameStep * ratio;
+				if (interFrame <= stopAttribute)
+					*resultCurrent = interFrame;
+				else
+					*resultCurrent = interFrame - stopAttribute + startAttribute;
+			}
+			else
+			{
+				*resultCurrent = interpolateFloat(frame1Current, frame2Current, ratio);
+			}
+		}
+	}
+
+	// interpolate blindData
+	blindDataCount = 0;
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	{
+		blindDataCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_blindDataCount[iEntityType];
+	}
+	for (iValue = 0; iValue < blindDataCount; iValue++)
+	{
+		result->_blindData[iValue] = interpolateFloat(frameData1->_blindData[iValue], frameData2->_blindData[iValue], ratio);
+	}
+
+	// interpolate pp attributes -> they are just copied we can't be sure they can be interpolated
+	for (iValue = 0; iValue < simulationData->_ppFloatAttributeCount; iValue++)
+	{
+		memcpy(result->_ppFloatAttributeData[iValue], frameData1->_ppFloatAttributeData[iValue], simulationData->_entityCount * sizeof(float));
+	}
+
+	for (iValue = 0; iValue< simulationData->_ppVectorAttributeCount; iValue++)
+	{
+		memcpy(result->_ppVectorAttributeData[iValue], frameData1->_ppVectorAttributeData[iValue], simulationData->_entityCount * sizeof(float) * 3);
+	}
+
+	// interpolate cloth : copy structures from frame1 and interpolate all vertices only (we have total vertices count in frameData)
+	if (frameData1->_clothEntityCount > 0 && frameData1->_clothTotalVertices > 0 && frameData1->_clothTotalVertices == frameData2->_clothTotalVertices)
+	{
+		glmCreateClothData(simulationData, result, frameData1->_clothEntityCount, frameData1->_clothTotalMeshIndices, frameData1->_clothTotalVertices);
+
+		memcpy(result->_entityClothIndex, frameData1->_entityClothIndex, simulationData->_entityCount * sizeof(int32_t));
+
+		memcpy(result->_clothEntityFirstAssetMeshIndex, frameData1->_clothEntityFirstAssetMeshIndex, result->_clothEntityCount * sizeof(uint32_t));
+		memcpy(result->_clothEntityFirstMeshVertex, frameData1->_clothEntityFirstMeshVertex, result->_clothEntityCount * sizeof(uint32_t));
+		memcpy(result->_clothEntityMeshCount, frameData1->_clothEntityMeshCount, result->_clothEntityCount * sizeof(uint32_t));
+		memcpy(result->_clothEntityQuantizationReference, frameData1->_clothEntityQuantizationReference, result->_clothEntityCount * sizeof(float[3]));
+		memcpy(result->_clothEntityQuantizationMaxExtent, frameData1->_clothEntityQuantizationMaxExtent, result->_clothEntityCount * sizeof(float));
+		
+		memcpy(result->_clothMeshIndicesInCharAssets, frameData1->_clothMeshIndicesInCharAssets, result->_clothAllocatedIndices * sizeof(uint32_t));
+		memcpy(result->_clothMeshVertexCount, frameData1->_clothMeshVertexCount, result->_clothAllocatedIndices * sizeof(uint32_t));
+		//memcpy(result->_clothMeshVertexOffsetPerClothIndex, frameData1->_clothMeshVertexOffsetPerClothIndex, clothIndices * sizeof(uint32_t));
+
+		// interpolate vertex per vertex
+		for (iValue = 0; iValue < frameData1->_clothTotalVertices; iValue++)
+		{
+			result->_clothVertices[iValue][0] = interpolateFloat(frameData1->_clothVertices[iValue][0], frameData2->_clothVertices[iValue][0], ratio);
+			result->_clothVertices[iValue][1] = interpolateFloat(frameData1->_clothVertices[iValue][1], frameData2->_clothVertices[iValue][1], ratio);
+			result->_clothVertices[iValue][2] = interpolateFloat(frameData1->_clothVertices[iValue][2], frameData2->_clothVertices[iValue][2], ratio);
+		}
+	}
+}
+
+void glmCreateFrameDataSoA(GlmFrameDataSoA** frameDataSoA, const GlmSimulationData* simulationData)
+{
+	GlmFrameDataSoA* data;
+	uint32_t iEntity;
+	uint32_t iBone;
+	uint16_t iEntityType;
+	size_t arraySize;
+	char* arrays;
+
+	*frameDataSoA = NULL;
+	data = (GlmFrameDataSoA*)GLMC_MALLOC(sizeof(GlmFrameDataSoA));
+	if (data == NULL)
+		return;
+	memset(data, 0, sizeof(GlmFrameDataSoA));
+
+	data->_entityCount = simulationData->_entityCount;
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	{
+		data->_boneValueCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_boneCount[iEntityType];
+	}
+	data->_paddedBoneValueCount = (data->_boneValueCount + GSC_SOA_LANE_COUNT - 1) / GSC_SOA_LANE_COUNT * GSC_SOA_LANE_COUNT;
+
+	data->_entityBoneOffsets = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * (data->_entityCount + 1));
+	// 7 arrays in one block, GSC_SOA_LANE_COUNT floats = GSC_SOA_ALIGNMENT bytes so each array start stays aligned
+	arraySize = sizeof(float) * data->_paddedBoneValueCount;
+	data->_allocation = GLMC_MALLOC(arraySize * 7 + GSC_SOA_ALIGNMENT);
+	if (data->_entityBoneOffsets == NULL || data->_allocation == NULL)
+	{
+		glmDestroyFrameDataSoA(&data);
+		return;
+	}
+	*frameDataSoA = data;
+
+	for (iEntity = 0; iEntity < data->_entityCount; iEntity++)
+	{
+		iEntityType = simulationData->_entityTypes[iEntity];
+		data->_entityBoneOffsets[iEntity] = simulationData->_iBoneOffsetPerEntityType[iEntityType] + simulationData->_indexInEntityType[iEntity] * simulationData->_boneCount[iEntityType];
+	}
+
+	arrays = (char*)data->_allocation + (GSC_SOA_ALIGNMENT - ((size_t)data->_allocation & (GSC_SOA_ALIGNMENT - 1))) % GSC_SOA_ALIGNMENT;
+	data->_positionsX = (float*)(arrays);
+	data->_positionsY = (float*)(arrays + arraySize);
+	data->_positionsZ = (float*)(arrays + arraySize * 2);
+	data->_orientationsX = (float*)(arrays + arraySize * 3);
+	data->_orientationsY = (float*)(arrays + arraySize * 4);
+	data->_orientationsZ = (float*)(arrays + arraySize * 5);
+	data->_orientationsW = (float*)(arrays + arraySize * 6);
+
+	// padding bones are identity so kernels can run on full lanes
+	for (iBone = data->_boneValueCount; iBone < data->_paddedBoneValueCount; iBone++)
+	{
+		data->_positionsX[iBone] = data->_positionsY[iBone] = data->_positionsZ[iBone] = 0.f;
+		data->_orientationsX[iBone] = data->_orientationsY[iBone] = data->_orientationsZ[iBone] = 0.f;
+		data->_orientationsW[iBone] = 1.f;
+	}
+}
+
+void glmDestroyFrameDataSoA(GlmFrameDataSoA** frameDataSoA)
+{
+	GlmFrameDataSoA* data = *frameDataSoA;
+	if (data == NULL)
+		return;
+	GLMC_FREE(data->_entityBoneOffsets);
+	GLMC_FREE(data->_allocation);
+	GLMC_FREE(data);
+	*frameDataSoA = NULL;
+}
+
+void glmConvertFrameDataToSoA(const GlmFrameData* frameData, GlmFrameDataSoA* frameDataSoA)
+{
+	uint32_t iBone;
+	for (iBone = 0; iBone < frameDataSoA->_boneValueCount; iBone++)
+	{
+		frameDataSoA->_positionsX[iBone] = frameData->_bonePositions[iBone][0];
+		frameDataSoA->_positionsY[iBone] = frameData->_bonePositions[iBone][1];
+		frameDataSoA->_positionsZ[iBone] = frameData->_bonePositions[iBone][2];
+		frameDataSoA->_orientationsX[iBone] = frameData->_boneOrientations[iBone][0];
+		frameDataSoA->_orientationsY[iBone] = frameData->_boneOrientations[iBone][1];
+		frameDataSoA->_orientationsZ[iBone] = frameData->_boneOrientations[iBone][2];
+		frameDataSoA->_orientationsW[iBone] = frameData->_boneOrientations[iBone][3];
+	}
+}
+
+void glmConvertFrameDataFromSoA(const GlmFrameDataSoA* frameDataSoA, GlmFrameData* frameData)
+{
+	uint32_t iBone;
+	for (iBone = 0; iBone < frameDataSoA->_boneValueCount; iBone++)
+	{
+		frameData->_bonePositions[iBone][0] = frameDataSoA->_positionsX[iBone];
+		frameData->_bonePositions[iBone][1] = frameDataSoA->_positionsY[iBone];
+		frameData->_bonePositions[iBone][2] = frameDataSoA->_positionsZ[iBone];
+		frameData->_boneOrientations[iBone][0] = frameDataSoA->_orientationsX[iBone];
+		frameData->_boneOrientations[iBone][1] = frameDataSoA->_orientationsY[iBone];
+		frameData->_boneOrientations[iBone][2] = frameDataSoA->_orientationsZ[iBone];
+		frameData->_boneOrientations[iBone][3] = frameDataSoA->_orientationsW[iBone];
+	}
+}
+
+void glmInterpolateFrameDataSoA(const GlmFrameDataSoA* frameData1, const GlmFrameDataSoA* frameData2, float ratio, GlmFrameDataSoA* result)
+{
+	static const float very_small_float = 1.0e-037f;
+	uint32_t iBone;
+
+	// branch free loops over padded arrays, left to the compiler vectorizer
+	for (iBone = 0; iBone < result->_paddedBoneValueCount; iBone++)
+	{
+		result->_positionsX[iBone] = frameData1->_positionsX[iBone] + (frameData2->_positionsX[iBone] - frameData1->_positionsX[iBone]) * ratio;
+		result->_positionsY[iBone] = frameData1->_positionsY[iBone] + (frameData2->_positionsY[iBone] - frameData1->_positionsY[iBone]) * ratio;
+		result->_positionsZ[iBone] = frameData1->_positionsZ[iBone] + (frameData2->_positionsZ[iBone] - frameData1->_positionsZ[iBone]) * ratio;
+	}
+	for (iBone = 0; iBone < result->_paddedBoneValueCount; iBone++)
+	{
+		float x1 = frameData1->_orientationsX[iBone];
+		float y1 = frameData1->_orientationsY[iBone];
+		float z1 = frameData1->_orientationsZ[iBone];
+		float w1 = frameData1->_orientationsW[iBone];
+		float cosom = x1 * frameData2->_orientationsX[iBone] + y1 * frameData2->_orientationsY[iBone] + z1 * frameData2->_orientationsZ[iBone] + w1 * frameData2->_orientationsW[iBone];
+		float sign = cosom < 0.f ? -1.f : 1.f; // same hemisphere as frame 1
+		float x = x1 + (sign * frameData2->_orientationsX[iBone] - x1) * ratio;
+		float y = y1 + (sign * frameData2->_orientationsY[iBone] - y1) * ratio;
+		float z = z1 + (sign * frameData2->_orientationsZ[iBone] - z1) * ratio;
+		float w = w1 + (sign * frameData2->_orientationsW[iBone] - w1) * ratio;
+		float factor = 1.f / sqrtf(x * x + y * y + z * z + w * w + very_small_float);
+		result->_orientationsX[iBone] = x * factor;
+		result->_orientationsY[iBone] = y * factor;
+		result->_orientationsZ[iBone] = z * factor;
+		result->_orientationsW[iBone] = w * factor;
 	}
+}
 
-	// bone edit : when the posture has been modified for 1 frame or whole simulation 
-	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+//---------------------------------------------------------------------------
+static int glmSortFrameIndex(const void *a, const void *b)
+{
+	int frameA = *(const int*)a;
+	int frameB = *(const int*)b;
+	if (frameA < frameB)
+		return -1;
+	if (frameA > frameB)
+		return 1;
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+// position of frame in the sorted frameIndices, which must contain it
+static int glmFindFrameIndex(const int* frameIndices, int frameCount, int frame)
+{
+	int first = 0;
+	int last = frameCount - 1;
+	while (first < last)
 	{
-		uint16_t entityTypeIndex;
-		unsigned int boneCount;
-		unsigned int localBoneOffset;
-		const float(*boneLocalOri)[4];
-		const float(*boneLocalPos)[3];
-		uint32_t offsetDest;
-		float(*bonePositionsPtrDest)[3];
-		float(*boneOrientationPtrDest)[4];
-		uint32_t *parentIndex;
-		float skeletonScale;
-		uint16_t snsCount;
-		unsigned int i;
+		int middle = first + (last - first) / 2;
+		if (frameIndices[middle] < frame)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return first;
+}
 
-		float(*frameRestRelativeOrientationPtrSrc)[4] = NULL;
+GlmSimulationCacheStatus glmCreateFrameSamples(GlmFrameSamples** frameSamples, GlmSimulationData* simulationDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmSimulationData* simulationDataOut, const float* sampleTimes, unsigned int sampleCount, const char* filePathModel, const char* cacheDirectory)
+{
+	GlmFrameSamples* samples = NULL;
+	GlmFrameData** frames;
+	int* frameIndices;
+	GlmSimulationCacheStatus status;
+	int frameCount;
+	int iFrame;
+	unsigned int iSample;
+	uint16_t iEntityType;
 
-		GlmEntityTransform* tr = &entityTransforms[iTransform];
+	*frameSamples = NULL;
+	if (sampleCount == 0)
+		return GSC_SIMULATION_NO_FRAMES_FOUND;
+	if (history == NULL)
+		simulationDataOut = simulationDataIn;
+
+	// sorted unique integer frames of the samples : the frame at or before each sample, and the next one for a sub-frame sample.
+	// Distant sample times only cost their own frames, not the gap between them
+	frameIndices = (int*)GLMC_MALLOC(sizeof(int) * 2 * (size_t)sampleCount);
+	if (frameIndices == NULL)
+		return GSC_OUT_OF_MEMORY;
+	frameCount = 0;
+	for (iSample = 0; iSample < sampleCount; iSample++)
+	{
+		int sampleFrame = (int)floorf(sampleTimes[iSample]);
+		frameIndices[frameCount++] = sampleFrame;
+		if (sampleTimes[iSample] > (float)sampleFrame)
+			frameIndices[frameCount++] = sampleFrame + 1;
+	}
+	qsort(frameIndices, frameCount, sizeof(int), glmSortFrameIndex);
+	{
+		int uniqueFrameCount = 1;
+		for (iFrame = 1; iFrame < frameCount; iFrame++)
+		{
+			if (frameIndices[iFrame] != frameIndices[uniqueFrameCount - 1])
+				frameIndices[uniqueFrameCount++] = frameIndices[iFrame];
+		}
+		frameCount = uniqueFrameCount;
+	}
+	frames = (GlmFrameData**)GLMC_MALLOC(sizeof(GlmFrameData*) * frameCount);
+	if (frames == NULL)
+	{
+		GLMC_FREE(frameIndices);
+		return GSC_OUT_OF_MEMORY;
+	}
+	memset(frames, 0, sizeof(GlmFrameData*) * frameCount);
 
-		// search for a full frame reste relative posture
-		for (iFrame = 0; iFrame < tr->_postureCount; iFrame++)
+	// read and modify each needed frame once, layout transforms are shared
+	status = GSC_SUCCESS;
+	for (iFrame = 0; iFrame < frameCount && status == GSC_SUCCESS; iFrame++)
+	{
+		GlmFrameData* frameData;
+		GlmSimulationCacheStatus readStatus;
+		char frameFilePath[2048];
+
+		glmsprintf(frameFilePath, 2048, filePathModel, frameIndices[iFrame]);
+		glmCreateFrameData(&frameData, simulationDataIn);
+		readStatus = glmReadFrameData(frameData, simulationDataIn, frameFilePath);
+		if (readStatus != GSC_SUCCESS)
 		{
-			if ( tr->_postureFrames[iFrame] == (unsigned int)currentFrame )
+			// try to find previous
+			int previousValidFrameIndex = glmComputeValidFrameIndex(frameIndices[iFrame], filePathModel, cacheDirectory);
+			if (previousValidFrameIndex != INT32_MIN)
 			{
-				uint32_t offsetSrc = iFrame * tr->_postureBoneCount;
-				frameRestRelativeOrientationPtrSrc = tr->_posturesOrientations + offsetSrc;
+				glmsprintf(frameFilePath, 2048, filePathModel, previousValidFrameIndex);
+				readStatus = glmReadFrameData(frameData, simulationDataIn, frameFilePath);
 			}
+			if (readStatus != GSC_SUCCESS)
+				glmDestroyFrameData(&frameData, simulationDataIn);
 		}
 
-		// no RR to apply ?
-		if ( tr->_boneRestRelativeOrientation == 0 && frameRestRelativeOrientationPtrSrc == 0)
-			continue;
+		if (history != NULL)
+		{
+			GlmFrameData* frameDataOut = NULL;
+			GlmSimulationCacheStatus modifiedStatus = glmCreateModifiedFrameData(simulationDataIn, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, frameIndices[iFrame], filePathModel, cacheDirectory);
+			if (frameData)
+				glmDestroyFrameData(&frameData, simulationDataIn);
+			frameData = (modifiedStatus == GSC_SUCCESS) ? frameDataOut : NULL;
+			if (modifiedStatus == GSC_OUT_OF_MEMORY)
+				status = GSC_OUT_OF_MEMORY;
+		}
+		frames[iFrame] = frameData;
+	}
 
-		// init
-		entityTypeIndex = simulationDataIn->_entityTypes[tr->_sourceIndexInCrowdField];
-		boneCount = simulationDataIn->_boneCount[entityTypeIndex];
-		localBoneOffset = history->_localBoneOffset[entityTypeIndex];
-		boneLocalOri = (const float(*)[4])history->_localBoneOrientation + localBoneOffset;
-		boneLocalPos = (const float(*)[3])history->_localBonePosition + localBoneOffset;
-		offsetDest = simulationDataOut->_iBoneOffsetPerEntityType[entityTypeIndex] + tr->_postureBoneCount * simulationDataOut->_indexInEntityType[iTransform];
-		bonePositionsPtrDest = frameOut->_bonePositions + offsetDest;
-		boneOrientationPtrDest = frameOut->_boneOrientations + offsetDest;
-		parentIndex = history->_localBoneParent + localBoneOffset;
-		skeletonScale = simulationDataIn->_scales[tr->_sourceIndexInCrowdField] * tr->_scale;
-		snsCount = simulationDataIn->_snsCountPerEntityType[entityTypeIndex];
-
-		if (!frameRestRelativeOrientationPtrSrc)
-		{
-			// map posture to hierarchical order so we can have hierarchical operations
-			for (i = 0;i<boneCount;i++)
-			{
-				int sortedBoneIndex = (parentIndex[i]&0xFFFF);
-				memcpy(entityTransforms->_sortedBonesWorldOri[sortedBoneIndex], boneOrientationPtrDest[i], sizeof(float) * 4);
-				memcpy(entityTransforms->_sortedBonesWorldPos[sortedBoneIndex], bonePositionsPtrDest[i], sizeof(float) * 3);
-			}
-			
-			// get Rest relative
-			glmComputeRestRelativesOrientationFromPosture((const float(*)[4])entityTransforms->_sortedBonesWorldOri, boneLocalOri, parentIndex, boneOrientationPtrDest[0], entityTransforms->_restRelativeOri, boneCount);
-		
-			// multiply RR (add delta)
-			for (i = 0;i<boneCount;i++)
-			{
-				float workOri[4];
-			
-				glmMultQuaternion(entityTransforms->_restRelativeOri[i], tr->_boneRestRelativeOrientation[i], workOri);
-				glmNormalizeQuaternion(workOri);
-				memcpy(entityTransforms->_restRelativeOri[i], workOri, sizeof(float) * 4);
-			}
+	if (status == GSC_SUCCESS)
+	{
+		samples = (GlmFrameSamples*)GLMC_MALLOC(sizeof(GlmFrameSamples));
+		if (samples == NULL)
+			status = GSC_OUT_OF_MEMORY;
+	}
+	if (status == GSC_SUCCESS)
+	{
+		memset(samples, 0, sizeof(GlmFrameSamples));
+		samples->_sampleCount = sampleCount;
+		for (iEntityType = 0; iEntityType < simulationDataOut->_entityTypeCount; iEntityType++)
+		{
+			samples->_boneValueCount += simulationDataOut->_entityCountPerEntityType[iEntityType] * simulationDataOut->_boneCount[iEntityType];
 		}
+		samples->_sampleTimes = (float*)GLMC_MALLOC(sizeof(float) * sampleCount);
+		samples->_bonePositions = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * ((size_t)sampleCount * samples->_boneValueCount + 1));
+		samples->_boneOrientations = (float(*)[4])GLMC_MALLOC(sizeof(float[4]) * ((size_t)sampleCount * samples->_boneValueCount + 1));
+		if (samples->_sampleTimes == NULL || samples->_bonePositions == NULL || samples->_boneOrientations == NULL)
+			status = GSC_OUT_OF_MEMORY;
 		else
+			memcpy(samples->_sampleTimes, sampleTimes, sizeof(float) * sampleCount);
+	}
+
+	// all bones of a sample in one pass, written straight in the [sample][bone] arrays
+	for (iSample = 0; iSample < sampleCount && status == GSC_SUCCESS; iSample++)
+	{
+		int sampleFrame = (int)floorf(sampleTimes[iSample]);
+		float ratio = sampleTimes[iSample] - (float)sampleFrame;
+		int iFrame1 = glmFindFrameIndex(frameIndices, frameCount, sampleFrame);
+		const GlmFrameData* frameData1 = frames[iFrame1];
+		const GlmFrameData* frameData2 = ratio > 0.f ? frames[iFrame1 + 1] : frameData1;
+		GlmFrameData sampleFrameData;
+
+		if (!frameData1)
+			frameData1 = frameData2;
+		if (!frameData2)
+			frameData2 = frameData1;
+		if (!frameData1)
 		{
-			unsigned int iTransformHistory;
-			// copy maya RR posture to local RR posture. frame RR are in Golaem order.
-			for (i = 0;i<boneCount;i++)
-			{
-				memcpy(entityTransforms->_restRelativeOri[i], frameRestRelativeOrientationPtrSrc[i], sizeof(float) * 4);
-				//memcpy(entityTransforms->_sortedBonesWorldPos[sortedBoneIndex], frameRestRelativePositionPtrSrc[i], sizeof(float) * 3);
-			}
-			// apply later bone edit
-			for (iTransformHistory = tr->_lastEditPostureHistoryIndex; iTransformHistory < history->_transformCount; iTransformHistory++)
+			status = GSC_SIMULATION_NO_FRAMES_FOUND;
+			break;
+		}
+
+		memset(&sampleFrameData, 0, sizeof(GlmFrameData));
+		sampleFrameData._bonePositions = samples->_bonePositions + (size_t)iSample * samples->_boneValueCount;
+		sampleFrameData._boneOrientations = samples->_boneOrientations + (size_t)iSample * samples->_boneValueCount;
+		glmInterpolateFrameDataBones(frameData1, frameData2, ratio, &sampleFrameData, 0, samples->_boneValueCount, GSC_INTERPOLATION_STRICT);
+	}
+
+	for (iFrame = 0; iFrame < frameCount; iFrame++)
+	{
+		if (frames[iFrame])
+			glmDestroyFrameData(&frames[iFrame], simulationDataOut);
+	}
+	GLMC_FREE(frames);
+	GLMC_FREE(frameIndices);
+
+	if (status != GSC_SUCCESS)
+	{
+		glmDestroyFrameSamples(&samples);
+		return status;
+	}
+	*frameSamples = samples;
+	return GSC_SUCCESS;
+}
+
+void glmDestroyFrameSamples(GlmFrameSamples** frameSamples)
+{
+	GlmFrameSamples* samples = *frameSamples;
+	if (samples == NULL)
+		return;
+	GLMC_FREE(samples->_sampleTimes);
+	GLMC_FREE(samples->_bonePositions);
+	GLMC_FREE(samples->_boneOrientations);
+	GLMC_FREE(samples);
+	*frameSamples = NULL;
+}
+
+//---------------------------------------------------------------------------
+// everything the evaluation reads outside of the per transform arrays
+static uint32_t glmHashHistoryShared(const GlmHistory* history)
+{
+	uint32_t hash;
+	glmStartHash(&hash);
+	glmCumulativeHashBytes(&history->_options, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(&history->_terrainMeshSource, sizeof(void*), &hash);
+	glmCumulativeHashBytes(&history->_terrainMeshDestination, sizeof(void*), &hash);
+	glmCumulativeHashBytes(&history->_transformGroupCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_transformGroupActive, history->_transformGroupCount * sizeof(uint8_t), &hash);
+	glmCumulativeHashBytes(history->_transformGroupBoundaries, history->_transformGroupCount * sizeof(uint32_t[2]), &hash);
+	glmCumulativeHashBytes(&history->_localBoneCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_localBoneOrientation, history->_localBoneCount * sizeof(float[4]), &hash);
+	glmCumulativeHashBytes(history->_localBonePosition, history->_localBoneCount * sizeof(float[3]), &hash);
+	glmCumulativeHashBytes(history->_localBoneParent, history->_localBoneCount * sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(&history->_localBoneOffsetCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_localBoneOffset, history->_localBoneOffsetCount * sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(&history->_postureCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(&history->_postureTotalBoneCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_posturesPositions, history->_postureTotalBoneCount * sizeof(float[3]), &hash);
+	glmCumulativeHashBytes(history->_posturesOrientations, history->_postureTotalBoneCount * sizeof(float[4]), &hash);
+	glmCumulativeHashBytes(&history->_meshAssetsOverrideTotalCount, sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_meshAssetsOverride, history->_meshAssetsOverrideTotalCount * sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_meshAssetsOverrideStartIndex, history->_entityCount * sizeof(uint32_t), &hash);
+	glmCumulativeHashBytes(history->_meshAssetsOverrideCount, history->_entityCount * sizeof(uint32_t), &hash);
+	return hash;
+}
+
+//---------------------------------------------------------------------------
+// start, count and content of a per transform range
+static void glmCumulativeHashRange(const void* values, size_t valueSize, uint32_t start, uint32_t count, uint32_t* currentHashValue)
+{
+	glmCumulativeHash32(start, currentHashValue);
+	glmCumulativeHash32(count, currentHashValue);
+	glmCumulativeHashBytes((const uint8_t*)values + start * valueSize, count * valueSize, currentHashValue);
+}
+
+//---------------------------------------------------------------------------
+// one hash per transform of every value it reads. Frame offsets and warps are hashed as glmApplyHistoryToEntityTransforms consumes them :
+// from a cursor shared by all the transforms, one per entity found in entityIndexMap
+static void glmHashHistoryTransforms(const GlmHistory* history, const GlmEntityIndexMap* entityIndexMap, uint32_t* transformHashes)
+{
+	unsigned int iTransform;
+	unsigned int j;
+	uint32_t frameOffsetsAv = 0;
+	uint32_t frameWarpAv = 0;
+
+	for (iTransform = 0; iTransform < history->_transformCount; iTransform++)
+	{
+		uint32_t hash;
+		glmStartHash(&hash);
+		glmCumulativeHashBytes(&history->_transformTypes[iTransform], sizeof(uint8_t), &hash);
+		glmCumulativeHashBytes(&history->_active[iTransform], sizeof(uint8_t), &hash);
+		glmCumulativeHashBytes(&history->_boneIndex[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_renderingTypeIdx[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(history->_transformRotate[iTransform], sizeof(float[4]), &hash);
+		glmCumulativeHashBytes(history->_transformTranslate[iTransform], sizeof(float[3]), &hash);
+		glmCumulativeHashBytes(history->_transformPivot[iTransform], sizeof(float[3]), &hash);
+		glmCumulativeHashBytes(&history->_scale[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_clothIndice[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_enableCloth[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashRange(history->_entityIds, sizeof(int64_t), history->_entityArrayStartIndex[iTransform], history->_entityArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_duplicatedEntityIds, sizeof(int64_t), history->_duplicatedEntityArrayStartIndex[iTransform], history->_duplicatedEntityArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_expands, sizeof(float[3]), history->_expandArrayStartIndex[iTransform], history->_expandArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_frameCurvePos, sizeof(float[3]), history->_perFramePosOriArrayStartIndex[iTransform], history->_perFramePosOriArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_frameCachePos, sizeof(float[3]), history->_perFramePosOriArrayStartIndex[iTransform], history->_perFramePosOriArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_framePos, sizeof(float[3]), history->_perFramePosOriArrayStartIndex[iTransform], history->_perFramePosOriArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_frameOri, sizeof(float[4]), history->_perFramePosOriArrayStartIndex[iTransform], history->_perFramePosOriArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_scaleRanges, sizeof(float), history->_scaleRangeArrayStartIndex[iTransform], history->_scaleRangeArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_frameOffsets, sizeof(float), history->_frameOffsetArrayStartIndex[iTransform], history->_frameOffsetArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_frameWarps, sizeof(float), history->_frameWarpArrayStartIndex[iTransform], history->_frameWarpArrayCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_posturesFrames, sizeof(uint32_t), history->_posturesFrameStart[iTransform], history->_posturesFrameCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_snapToPositions, sizeof(float[3]), history->_snapToStartIndex[iTransform], history->_snapToCount[iTransform], &hash);
+		glmCumulativeHashRange(history->_snapToRotations, sizeof(float[4]), history->_snapToStartIndex[iTransform], history->_snapToCount[iTransform], &hash);
+		glmCumulativeHashBytes(&history->_frameOffsetMin[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_frameOffsetMax[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_frameWarpMin[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_frameWarpMax[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_scaleRangeMin[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_scaleRangeMax[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(&history->_startFrame[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_frameCount[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_trajectoryMode[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_trajectorySteps[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_smoothIterationCount[iTransform], sizeof(uint32_t), &hash);
+		glmCumulativeHashBytes(&history->_smoothFrontBackRatio[iTransform], sizeof(float), &hash);
+		glmCumulativeHashBytes(history->_smoothComponents[iTransform], sizeof(float[3]), &hash);
+		glmCumulativeHashBytes(history->_snapToTarget[iTransform], strlen(history->_snapToTarget[iTransform]), &hash);
+		glmCumulativeHashBytes(history->_shaderAttribute[iTransform], strlen(history->_shaderAttribute[iTransform]), &hash);
+
+		if (history->_active[iTransform] && (history->_transformTypes[iTransform] == SimulationCacheFrameOffset || history->_transformTypes[iTransform] == SimulationCacheFrameWarp))
+		{
+			uint32_t* cursor = history->_transformTypes[iTransform] == SimulationCacheFrameOffset ? &frameOffsetsAv : &frameWarpAv;
+			const float* values = history->_transformTypes[iTransform] == SimulationCacheFrameOffset ? history->_frameOffsets : history->_frameWarps;
+			for (j = 0; j < history->_entityArrayCount[iTransform]; j++)
 			{
-				if (history->_active[iTransformHistory] && 
-					history->_transformTypes[iTransformHistory] == SimulationCachePostureBoneEdit && 
-					history->_entityIds[history->_entityArrayStartIndex[iTransformHistory]] == tr->_entityId)
+				if (glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[iTransform] + j]) != -1)
 				{
-					unsigned int boneIndex = history->_boneIndex[iTransformHistory];
-					float workOri[4];
-
-					glmMultQuaternion(history->_transformRotate[iTransformHistory], entityTransforms->_restRelativeOri[boneIndex], workOri);
-					glmNormalizeQuaternion(workOri);
-					memcpy(entityTransforms->_restRelativeOri[boneIndex], workOri, sizeof(float) * 4);
+					glmCumulativeHash32(*cursor, &hash);
+					glmCumulativeHashBytes(&values[*cursor], sizeof(float), &hash);
+					(*cursor)++;
 				}
 			}
 		}
+		transformHashes[iTransform] = hash;
+	}
+}
+
+//---------------------------------------------------------------------------
+// copy the frame data of one entity between two frames of the same entity types, no transformation
+static void glmCopyEntityFrameDataRaw(const GlmFrameData* frameDataIn, const GlmSimulationData* simuDataIn, unsigned int indexIn, GlmFrameData* frameDataOut, const GlmSimulationData* simuDataOut, unsigned int indexOut)
+{
+	unsigned int iValue;
+	uint16_t entityType = simuDataIn->_entityTypes[indexIn];
+	uint32_t localIndexIn = simuDataIn->_indexInEntityType[indexIn];
+	uint32_t localIndexOut = simuDataOut->_indexInEntityType[indexOut];
+	uint16_t boneCount = simuDataIn->_boneCount[entityType];
+	uint16_t snsCount = simuDataIn->_snsCountPerEntityType[entityType];
+	uint16_t blindDataCount = simuDataIn->_blindDataCount[entityType];
+
+	memcpy(frameDataOut->_bonePositions + simuDataOut->_iBoneOffsetPerEntityType[entityType] + localIndexOut * boneCount,
+		frameDataIn->_bonePositions + simuDataIn->_iBoneOffsetPerEntityType[entityType] + localIndexIn * boneCount, boneCount * sizeof(float[3]));
+	memcpy(frameDataOut->_boneOrientations + simuDataOut->_iBoneOffsetPerEntityType[entityType] + localIndexOut * boneCount,
+		frameDataIn->_boneOrientations + simuDataIn->_iBoneOffsetPerEntityType[entityType] + localIndexIn * boneCount, boneCount * sizeof(float[4]));
+	memcpy(frameDataOut->_snsValues + simuDataOut->_snsOffsetPerEntityType[entityType] + localIndexOut * snsCount,
+		frameDataIn->_snsValues + simuDataIn->_snsOffsetPerEntityType[entityType] + localIndexIn * snsCount, snsCount * sizeof(float[4]));
+	memcpy(frameDataOut->_blindData + simuDataOut->_iBlindDataOffsetPerEntityType[entityType] + localIndexOut * blindDataCount,
+		frameDataIn->_blindData + simuDataIn->_iBlindDataOffsetPerEntityType[entityType] + localIndexIn * blindDataCount, blindDataCount * sizeof(float));
+	if (simuDataIn->_hasGeoBehavior[entityType])
+	{
+		uint32_t geoBeIn = simuDataIn->_iGeoBehaviorOffsetPerEntityType[entityType] + localIndexIn;
+		uint32_t geoBeOut = simuDataOut->_iGeoBehaviorOffsetPerEntityType[entityType] + localIndexOut;
+		frameDataOut->_geoBehaviorGeometryIds[geoBeOut] = frameDataIn->_geoBehaviorGeometryIds[geoBeIn];
+		memcpy(frameDataOut->_geoBehaviorAnimFrameInfo[geoBeOut], frameDataIn->_geoBehaviorAnimFrameInfo[geoBeIn], sizeof(float[3]));
+		frameDataOut->_geoBehaviorBlendModes[geoBeOut] = frameDataIn->_geoBehaviorBlendModes[geoBeIn];
+	}
+	for (iValue = 0; iValue < simuDataIn->_ppFloatAttributeCount; iValue++)
+	{
+		frameDataOut->_ppFloatAttributeData[iValue][indexOut] = frameDataIn->_ppFloatAttributeData[iValue][indexIn];
+	}
+	for (iValue = 0; iValue < simuDataIn->_ppVectorAttributeCount; iValue++)
+	{
+		memcpy(frameDataOut->_ppVectorAttributeData[iValue][indexOut], frameDataIn->_ppVectorAttributeData[iValue][indexIn], sizeof(float[3]));
+	}
+}
+
+//---------------------------------------------------------------------------
+// duplicates placed after the source entities, rigid copy of their source at the current frame
+static int glmIsDeferrableTransform(const GlmSimulationData* simulationDataIn, const GlmEntityTransform* tr, unsigned int iTransform)
+{
+	return iTransform >= simulationDataIn->_entityCount
+		&& tr->_entityId >= 0
+		&& tr->_sourceIndexInCrowdField >= 0
+		&& tr->_boneRestRelativeOrientation == NULL
+		&& tr->_postureCount == 0
+		&& fabsf(tr->_frameOffset._frameOffset) <= FLT_EPSILON
+		&& fabsf(tr->_frameOffset._frameWarp - 1) <= FLT_EPSILON
+		&& (tr->_perFramePosOriIndex == INT_MIN || tr->_perFramePosOriArrayCount <= 0);
+}
+
+//---------------------------------------------------------------------------
+// cloth arrays are indexed by output entity and ground adaptation moves entities per frame : keep everything materialized
+static int glmCanDeferFrameData(const GlmFrameData* frameDataIn, const GlmHistory* history)
+{
+	return frameDataIn != NULL
+		&& frameDataIn->_clothEntityCount == 0
+		&& !(glmRaycastClosest && (history->_options&(uint32_t)(OptionsGroundAdaptUseTerrain)));
+}
+
+//---------------------------------------------------------------------------
+// deferred entities only keep their base transform, as glmCreateModifiedFrameData would leave it for a rigid copy
+static void glmDeferEntityTransform(GlmDeferredFrameData* data, GlmEntityTransform* tr, uint32_t deferredIndex, int currentFrame)
+{
+	memcpy(tr->_matrix, tr->_matrixBase, sizeof(float) * 16);
+	memcpy(tr->_orientation, tr->_orientationBase, sizeof(float) * 4);
+	tr->_frameOffset._frameIndex = currentFrame;
+	tr->_frameOffset._framesLoadedIndex = 0;
+	tr->_frameOffset._fraction = 0.f;
+	tr->_outOfCache = 0;
+
+	data->_deferredSourceIndices[deferredIndex] = tr->_sourceIndexInCrowdField;
+	memcpy(data->_deferredMatrices[deferredIndex], tr->_matrix, sizeof(float) * 16);
+	memcpy(data->_deferredOrientations[deferredIndex], tr->_orientation, sizeof(float) * 4);
+	data->_deferredScales[deferredIndex] = tr->_scale;
+}
+
+//---------------------------------------------------------------------------
+GlmSimulationCacheStatus glmCreateDeferredFrameData(GlmSimulationData* simulationDataIn, GlmFrameData* frameDataIn, GlmEntityTransform* entityTransforms, unsigned int entityTransformCount, GlmHistory* history, GlmDeferredFrameData** deferredFrameData, int currentFrame, const char * filePathModel, const char * cacheDirectory)
+{
+	GlmDeferredFrameData* data;
+	GlmEntityTransform* materializedTransforms;
+	unsigned int materializedCount = 0;
+	unsigned int iTransform;
+	int canDefer;
+	GlmSimulationCacheStatus status;
+
+	canDefer = glmCanDeferFrameData(frameDataIn, history);
+
+	*deferredFrameData = NULL;
+	data = (GlmDeferredFrameData*)GLMC_MALLOC(sizeof(GlmDeferredFrameData));
+	if (data == NULL)
+		return GSC_OUT_OF_MEMORY;
+	memset(data, 0, sizeof(GlmDeferredFrameData));
+	data->_simulationDataIn = simulationDataIn;
+	data->_frameDataIn = frameDataIn;
+	data->_entityCount = entityTransformCount;
+	data->_entityIndices = (int32_t*)GLMC_MALLOC((entityTransformCount + 1) * sizeof(int32_t));
+	if (data->_entityIndices == NULL)
+	{
+		glmDestroyDeferredFrameData(&data);
+		return GSC_OUT_OF_MEMORY;
+	}
+
+	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+	{
+		if (canDefer && glmIsDeferrableTransform(simulationDataIn, &entityTransforms[iTransform], iTransform))
+			data->_entityIndices[iTransform] = -1 - (int32_t)data->_deferredEntityCount++;
+		else
+			data->_entityIndices[iTransform] = (int32_t)materializedCount++;
+	}
+
+	// source entities come first and are never deferred, so indexing transforms by source index stays valid in the materialized list
+	materializedTransforms = (GlmEntityTransform*)GLMC_MALLOC((materializedCount + 1) * sizeof(GlmEntityTransform));
+	if (materializedTransforms == NULL)
+	{
+		glmDestroyDeferredFrameData(&data);
+		return GSC_OUT_OF_MEMORY;
+	}
+	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+	{
+		if (data->_entityIndices[iTransform] >= 0)
+			memcpy(&materializedTransforms[data->_entityIndices[iTransform]], &entityTransforms[iTransform], sizeof(GlmEntityTransform));
+	}
+	materializedTransforms->_sortedBonesWorldOri = entityTransforms->_sortedBonesWorldOri;
+	materializedTransforms->_sortedBonesWorldPos = entityTransforms->_sortedBonesWorldPos;
+	materializedTransforms->_sortedBonesScale = entityTransforms->_sortedBonesScale;
+	materializedTransforms->_restRelativeOri = entityTransforms->_restRelativeOri;
+
+	glmCreateModifiedSimulationData(simulationDataIn, materializedTransforms, materializedCount, &data->_materializedSimulationData);
+	if (data->_materializedSimulationData == NULL)
+	{
+		GLMC_FREE(materializedTransforms);
+		glmDestroyDeferredFrameData(&data);
+		return GSC_OUT_OF_MEMORY;
+	}
+	status = glmCreateModifiedFrameData(simulationDataIn, frameDataIn, materializedTransforms, materializedCount, history, data->_materializedSimulationData, &data->_materializedFrameData, currentFrame, filePathModel, cacheDirectory);
+	if (status != GSC_SUCCESS)
+	{
+		GLMC_FREE(materializedTransforms);
+		data->_materializedFrameData = NULL;
+		glmDestroyDeferredFrameData(&data);
+		*deferredFrameData = NULL;
+		return status;
+	}
 
-		// compute back world pos/ori from RR
-		if (!snsCount)
+	// transforms back to the caller, deferred entities only keep their base transform
+	data->_deferredSourceIndices = (int32_t*)GLMC_MALLOC((data->_deferredEntityCount + 1) * sizeof(int32_t));
+	data->_deferredMatrices = (float(*)[16])GLMC_MALLOC((data->_deferredEntityCount + 1) * sizeof(float[16]));
+	data->_deferredOrientations = (float(*)[4])GLMC_MALLOC((data->_deferredEntityCount + 1) * sizeof(float[4]));
+	data->_deferredScales = (float*)GLMC_MALLOC((data->_deferredEntityCount + 1) * sizeof(float));
+	if (data->_deferredSourceIndices == NULL || data->_deferredMatrices == NULL || data->_deferredOrientations == NULL || data->_deferredScales == NULL)
+	{
+		GLMC_FREE(materializedTransforms);
+		glmDestroyDeferredFrameData(&data);
+		return GSC_OUT_OF_MEMORY;
+	}
+	for (iTransform = 0; iTransform < entityTransformCount; iTransform++)
+	{
+		GlmEntityTransform* tr = &entityTransforms[iTransform];
+		int32_t index = data->_entityIndices[iTransform];
+		if (index >= 0)
 		{
-			glmComputePostureFromRestRelativeOrientations(entityTransforms->_sortedBonesWorldPos, entityTransforms->_sortedBonesWorldOri, boneLocalOri, boneLocalPos, parentIndex, 
-				bonePositionsPtrDest[0], boneOrientationPtrDest[0], (const float(*)[4])entityTransforms->_restRelativeOri, skeletonScale, boneCount);
+			memcpy(tr, &materializedTransforms[index], sizeof(GlmEntityTransform));
 		}
 		else
 		{
-			uint32_t offsetSns = simulationDataOut->_snsOffsetPerEntityType[entityTypeIndex] + snsCount * simulationDataOut->_indexInEntityType[iTransform];
-			float(*boneSnsPtr)[4] = frameOut->_snsValues + offsetSns;
-
-			for (i = 0;i<boneCount;i++)
-			{
-				int sortedBoneIndex = (parentIndex[i]&0xFFFF);
-				memcpy(entityTransforms->_sortedBonesScale[sortedBoneIndex], boneSnsPtr[i], sizeof(float) * 4);
-			}
-			glmComputePostureFromRestRelativeOrientationsScales(entityTransforms->_sortedBonesWorldPos, entityTransforms->_sortedBonesWorldOri, boneLocalOri, 
-				boneLocalPos, parentIndex, bonePositionsPtrDest[0], boneOrientationPtrDest[0], (const float(*)[4])entityTransforms->_restRelativeOri, skeletonScale, boneCount, (const float(*)[4])entityTransforms->_sortedBonesScale);
+			glmDeferEntityTransform(data, tr, (uint32_t)(-1 - index), currentFrame);
 		}
+	}
+	GLMC_FREE(materializedTransforms);
 
-		// remap values -> put back values in cache order
-		for (i = 0;i<boneCount;i++)
-		{
-			int sortedBoneIndex = (parentIndex[i]&0xFFFF);
-			memcpy(boneOrientationPtrDest[i], entityTransforms->_sortedBonesWorldOri[sortedBoneIndex], sizeof(float) * 4);
-			memcpy(bonePositionsPtrDest[i], entityTransforms->_sortedBonesWorldPos[sortedBoneIndex], sizeof(float) * 3);
-		}
+	*deferredFrameData = data;
+	return GSC_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+void glmGetDeferredEntityBones(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, float(*bonePositions)[3], float(*boneOrientations)[4])
+{
+	int32_t index = deferredFrameData->_entityIndices[entityIndex];
+	if (index >= 0)
+	{
+		const GlmSimulationData* simulationData = deferredFrameData->_materializedSimulationData;
+		uint16_t entityTypeIndex = simulationData->_entityTypes[index];
+		uint16_t boneCount = simulationData->_boneCount[entityTypeIndex];
+		uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityTypeIndex] + boneCount * simulationData->_indexInEntityType[index];
 
+		memcpy(bonePositions, deferredFrameData->_materializedFrameData->_bonePositions + offset, boneCount * sizeof(float[3]));
+		memcpy(boneOrientations, deferredFrameData->_materializedFrameData->_boneOrientations + offset, boneCount * sizeof(float[4]));
 	}
+	else
+	{
+		const GlmSimulationData* simulationData = deferredFrameData->_simulationDataIn;
+		uint32_t deferredIndex = (uint32_t)(-1 - index);
+		int32_t sourceIndex = deferredFrameData->_deferredSourceIndices[deferredIndex];
+		uint16_t entityTypeIndex = simulationData->_entityTypes[sourceIndex];
+		uint16_t boneCount = simulationData->_boneCount[entityTypeIndex];
+		uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityTypeIndex] + boneCount * simulationData->_indexInEntityType[sourceIndex];
 
-	// cloth
-	if (totalClothEntityCount)
+		glmTransformEntityBones((const float(*)[3])deferredFrameData->_frameDataIn->_bonePositions + offset, (const float(*)[4])deferredFrameData->_frameDataIn->_boneOrientations + offset, boneCount,
+			deferredFrameData->_deferredMatrices[deferredIndex], deferredFrameData->_deferredOrientations[deferredIndex], deferredFrameData->_deferredScales[deferredIndex], bonePositions, boneOrientations);
+	}
+}
+
+//---------------------------------------------------------------------------
+void glmGetDeferredEntityRootBone(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, float bonePosition[3], float boneOrientation[4])
+{
+	const GlmSimulationData* simulationData;
+	unsigned int indexInFrame;
+	const GlmFrameData* frameData = glmGetDeferredEntityFrameData(deferredFrameData, entityIndex, &simulationData, &indexInFrame);
+	uint16_t entityTypeIndex = simulationData->_entityTypes[indexInFrame];
+	uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityTypeIndex] + simulationData->_boneCount[entityTypeIndex] * simulationData->_indexInEntityType[indexInFrame];
+	int32_t index = deferredFrameData->_entityIndices[entityIndex];
+
+	if (index >= 0)
 	{
-		int clothAv = 0;
-		float(*clothReferenceDest)[3];
-		float* clothMaxExtentDest;
+		memcpy(bonePosition, frameData->_bonePositions[offset], sizeof(float) * 3);
+		memcpy(boneOrientation, frameData->_boneOrientations[offset], sizeof(float) * 4);
+	}
+	else
+	{
+		// the scale is around the root, it does not move it
+		uint32_t deferredIndex = (uint32_t)(-1 - index);
+		glmTransformPoint(frameData->_bonePositions[offset], deferredFrameData->_deferredMatrices[deferredIndex], bonePosition);
+		glmMultQuaternion(deferredFrameData->_deferredOrientations[deferredIndex], frameData->_boneOrientations[offset], boneOrientation);
+		glmNormalizeQuaternion(boneOrientation);
+	}
+}
 
-		uint32_t* clothIndicesDest;
-		uint32_t* clothMeshVertexCountDest;
-		float(*clothVerticesDest)[3];
+//---------------------------------------------------------------------------
+const GlmFrameData* glmGetDeferredEntityFrameData(const GlmDeferredFrameData* deferredFrameData, unsigned int entityIndex, const GlmSimulationData** simulationData, unsigned int* indexInFrame)
+{
+	int32_t index = deferredFrameData->_entityIndices[entityIndex];
+	if (index >= 0)
+	{
+		*simulationData = deferredFrameData->_materializedSimulationData;
+		*indexInFrame = (unsigned int)index;
+		return deferredFrameData->_materializedFrameData;
+	}
+	*simulationData = deferredFrameData->_simulationDataIn;
+	*indexInFrame = (unsigned int)deferredFrameData->_deferredSourceIndices[-1 - index];
+	return deferredFrameData->_frameDataIn;
+}
 
-		// allocate cloth
-		glmCreateClothData( simulationDataOut, frameOut, totalClothEntityCount, totalClothTotalIndices, totalClothTotalVertices );
+//---------------------------------------------------------------------------
+void glmMaterializeDeferredFrameData(const GlmDeferredFrameData* deferredFrameData, const GlmSimulationData* simulationDataOut, GlmFrameData** frameDataOut)
+{
+	const GlmFrameData* materializedFrameData = deferredFrameData->_materializedFrameData;
+	GlmFrameData* frameOut;
+	unsigned int iEntity;
 
-		
-		clothReferenceDest = frameOut->_clothEntityQuantizationReference;
-		clothMaxExtentDest = frameOut->_clothEntityQuantizationMaxExtent;
+	glmCreateFrameData(frameDataOut, simulationDataOut);
+	frameOut = *frameDataOut;
+	frameOut->_cacheFormat = materializedFrameData->_cacheFormat;
+	frameOut->_hasSquashAndStretch = materializedFrameData->_hasSquashAndStretch;
+	frameOut->_simulationContentHashKey = simulationDataOut->_contentHashKey;
 
-		clothIndicesDest = frameOut->_clothMeshIndicesInCharAssets;
-		clothMeshVertexCountDest = frameOut->_clothMeshVertexCount;
-		clothVerticesDest = frameOut->_clothVertices;
+	for (iEntity = 0; iEntity < deferredFrameData->_entityCount; iEntity++)
+	{
+		const GlmSimulationData* simulationData;
+		unsigned int indexInFrame;
+		const GlmFrameData* frameData = glmGetDeferredEntityFrameData(deferredFrameData, iEntity, &simulationData, &indexInFrame);
 
-		// compute cloth reference/extent
-		for (i = 0 ; i < entityTransformCount; ++i)
+		glmCopyEntityFrameDataRaw(frameData, simulationData, indexInFrame, frameOut, simulationDataOut, iEntity);
+		if (deferredFrameData->_entityIndices[iEntity] < 0)
 		{
-			// patch EntityTransform for cloth
-			frameOut->_entityClothIndex[i] = entityTransforms[i]._useCloth ? entityTransforms[i]._clothedEntityIndex : -1;
-			if (frameOut->_entityClothIndex[i] != -1)
-			{
-				float clothMin[] = {FLT_MAX,FLT_MAX,FLT_MAX};
-				float clothMax[] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
-				float maxExtent;
-				unsigned int iVertexGroup;
-				unsigned int iVertex;
-				unsigned int iComp;
-				unsigned int meshIndexCount;
-
-				float(*clothVerticesSource)[3] = entityTransforms[i]._clothVerticesSource;
-				uint32_t* clothIndicesSource = entityTransforms[i]._clothIndicesSource;
-				uint32_t* clothMeshVertexCountSource = entityTransforms[i]._clothMeshVertexCountSource;
-								
-				// helpers for reading
-				frameOut->_clothEntityFirstAssetMeshIndex[clothAv] = (uint32_t)(clothIndicesDest - frameOut->_clothMeshIndicesInCharAssets);  // write indices offset when beginning a new cloth entity for helper
-				frameOut->_clothEntityFirstMeshVertex[clothAv] = (uint32_t)(clothVerticesDest - frameOut->_clothVertices); // write vertices offset when beginning a new cloth entity for helper
+			uint16_t entityTypeIndex = simulationDataOut->_entityTypes[iEntity];
+			uint32_t offset = simulationDataOut->_iBoneOffsetPerEntityType[entityTypeIndex] + simulationDataOut->_boneCount[entityTypeIndex] * simulationDataOut->_indexInEntityType[iEntity];
+			glmGetDeferredEntityBones(deferredFrameData, iEntity, frameOut->_bonePositions + offset, frameOut->_boneOrientations + offset);
+		}
+	}
 
-				meshIndexCount = frameDataIn->_clothEntityMeshCount[entityTransforms[i]._clothedEntityIndex];
-				frameOut->_clothEntityMeshCount[clothAv] = meshIndexCount;
-				memcpy( clothMeshVertexCountDest, clothMeshVertexCountSource, sizeof(uint32_t) * meshIndexCount );
-				memcpy( clothIndicesDest, clothIndicesSource, sizeof(uint32_t) * meshIndexCount );
+	// cloth disables deferring, entity indices are the same in both frames
+	glmCopyClothData(materializedFrameData, simulationDataOut, frameOut);
+}
 
-				clothMeshVertexCountDest += meshIndexCount;
-				clothIndicesDest += meshIndexCount;
+//---------------------------------------------------------------------------
+void glmDestroyDeferredFrameData(GlmDeferredFrameData** deferredFrameData)
+{
+	GlmDeferredFrameData* data = *deferredFrameData;
+	if (data == NULL)
+		return;
+	if (data->_materializedFrameData)
+		glmDestroyFrameData(&data->_materializedFrameData, data->_materializedSimulationData);
+	if (data->_materializedSimulationData)
+		glmDestroySimulationData(&data->_materializedSimulationData);
+	GLMC_FREE(data->_entityIndices);
+	GLMC_FREE(data->_deferredSourceIndices);
+	GLMC_FREE(data->_deferredMatrices);
+	GLMC_FREE(data->_deferredOrientations);
+	GLMC_FREE(data->_deferredScales);
+	GLMC_FREE(data);
+	*deferredFrameData = NULL;
+}
 
-				for (iVertexGroup = 0;iVertexGroup<meshIndexCount;iVertexGroup++)
-				{
-					size_t groupVertexCount = frameOut->_clothMeshVertexCount[iVertexGroup];
-					
-					for (iVertex = 0 ; iVertex< groupVertexCount; iVertex ++)
-					{
+//---------------------------------------------------------------------------
+void glmCreateLayoutEvaluator(GlmLayoutEvaluator** evaluator, GlmSimulationData* simulationDataIn)
+{
+	GlmLayoutEvaluator* data = (GlmLayoutEvaluator*)GLMC_MALLOC(sizeof(GlmLayoutEvaluator));
+	*evaluator = data;
+	if (data == NULL)
+		return;
+	memset(data, 0, sizeof(GlmLayoutEvaluator));
+	data->_simulationDataIn = simulationDataIn;
+}
 
-						glmTransformPoint(&(*clothVerticesSource)[0], entityTransforms[i]._matrix, &(*clothVerticesDest)[0]);
-						
-						for (iComp=0;iComp<3;iComp++)
-						{
-							float coord = (*clothVerticesDest)[iComp];
-							float pivotCoord = entityTransforms[i]._scalePivot[iComp];
-							coord = (coord - pivotCoord) * entityTransforms[i]._scale + pivotCoord;
-							if ( coord<clothMin[iComp] ) clothMin[iComp] = coord;
-							if ( coord>clothMax[iComp] ) clothMax[iComp] = coord;
-							(*clothVerticesDest)[iComp] = coord;
-							
-						}
+//---------------------------------------------------------------------------
+// NULL if the copy could not be allocated
+static void* glmCloneArray(const void* source, size_t size)
+{
+	void* result = GLMC_MALLOC(size ? size : 1);
+	if (result != NULL)
+		memcpy(result, source, size);
+	return result;
+}
 
-						clothVerticesSource++;
-						clothVerticesDest++;
-					}
-				}
+//---------------------------------------------------------------------------
+static void glmClearLayoutEvaluatorHistory(GlmLayoutEvaluator* evaluator)
+{
+	GLMC_FREE(evaluator->_transformHashes);
+	GLMC_FREE(evaluator->_transformTypes);
+	GLMC_FREE(evaluator->_entityIds);
+	GLMC_FREE(evaluator->_entityArrayStartIndex);
+	GLMC_FREE(evaluator->_entityArrayCount);
+	GLMC_FREE(evaluator->_duplicatedEntityIds);
+	GLMC_FREE(evaluator->_duplicatedEntityArrayStartIndex);
+	GLMC_FREE(evaluator->_duplicatedEntityArrayCount);
+	evaluator->_transformHashes = NULL;
+	evaluator->_transformTypes = NULL;
+	evaluator->_entityIds = NULL;
+	evaluator->_entityArrayStartIndex = NULL;
+	evaluator->_entityArrayCount = NULL;
+	evaluator->_duplicatedEntityIds = NULL;
+	evaluator->_duplicatedEntityArrayStartIndex = NULL;
+	evaluator->_duplicatedEntityArrayCount = NULL;
+	evaluator->_transformCount = 0;
+	evaluator->_frameDataIn = NULL;
+}
 
-				(*clothReferenceDest)[0] = (clothMax[0] + clothMin[0]) * 0.5f;
-				(*clothReferenceDest)[1] = (clothMax[1] + clothMin[1]) * 0.5f;
-				(*clothReferenceDest)[2] = (clothMax[2] + clothMin[2]) * 0.5f;
+//---------------------------------------------------------------------------
+// the evaluator owns transformHashes. Return 0, with no history stored, when a copy could not be allocated
+static int glmStoreLayoutEvaluatorHistory(GlmLayoutEvaluator* evaluator, const GlmHistory* history, uint32_t historyHash, uint32_t* transformHashes)
+{
+	glmClearLayoutEvaluatorHistory(evaluator);
+	evaluator->_historyHash = historyHash;
+	evaluator->_transformCount = history->_transformCount;
+	evaluator->_transformHashes = transformHashes;
+	evaluator->_transformTypes = (uint8_t*)glmCloneArray(history->_transformTypes, history->_transformCount * sizeof(uint8_t));
+	evaluator->_entityIds = (int64_t*)glmCloneArray(history->_entityIds, history->_entityCount * sizeof(int64_t));
+	evaluator->_entityArrayStartIndex = (uint32_t*)glmCloneArray(history->_entityArrayStartIndex, history->_transformCount * sizeof(uint32_t));
+	evaluator->_entityArrayCount = (uint32_t*)glmCloneArray(history->_entityArrayCount, history->_transformCount * sizeof(uint32_t));
+	evaluator->_duplicatedEntityIds = (int64_t*)glmCloneArray(history->_duplicatedEntityIds, history->_duplicatedEntityCount * sizeof(int64_t));
+	evaluator->_duplicatedEntityArrayStartIndex = (uint32_t*)glmCloneArray(history->_duplicatedEntityArrayStartIndex, history->_transformCount * sizeof(uint32_t));
+	evaluator->_duplicatedEntityArrayCount = (uint32_t*)glmCloneArray(history->_duplicatedEntityArrayCount, history->_transformCount * sizeof(uint32_t));
+	if (evaluator->_transformTypes == NULL || evaluator->_entityIds == NULL || evaluator->_entityArrayStartIndex == NULL || evaluator->_entityArrayCount == NULL
+		|| evaluator->_duplicatedEntityIds == NULL || evaluator->_duplicatedEntityArrayStartIndex == NULL || evaluator->_duplicatedEntityArrayCount == NULL)
+	{
+		glmClearLayoutEvaluatorHistory(evaluator);
+		return 0;
+	}
+	return 1;
+}
 
-				maxExtent =  (clothMax[0] - clothMin[0]) * 0.5f;
-				maxExtent = (((clothMax[1] - clothMin[1]) * 0.5f)>maxExtent)?((clothMax[1] - clothMin[1]) * 0.5f):maxExtent;
-				maxExtent = (((clothMax[2] - clothMin[2]) * 0.5f)>maxExtent)?((clothMax[2] - clothMin[2]) * 0.5f):maxExtent;
+//---------------------------------------------------------------------------
+static void glmClearLayoutEvaluatorResult(GlmLayoutEvaluator* evaluator)
+{
+	if (evaluator->_frameDataOut)
+		glmDestroyFrameData(&evaluator->_frameDataOut, evaluator->_simulationDataOut);
+	if (evaluator->_deferredFrameDataOut)
+		glmDestroyDeferredFrameData(&evaluator->_deferredFrameDataOut);
+	if (evaluator->_simulationDataOut && evaluator->_simulationDataOutIsView)
+		glmDestroySimulationDataView(&evaluator->_simulationDataOut, evaluator->_simulationDataIn);
+	else if (evaluator->_simulationDataOut)
+		glmDestroySimulationData(&evaluator->_simulationDataOut);
+	evaluator->_simulationDataOutIsView = 0;
+	if (evaluator->_entityTransforms)
+		glmDestroyEntityTransforms(&evaluator->_entityTransforms, evaluator->_entityTransformCount);
+	if (evaluator->_entityIndexMap)
+	{
+		glmDestroyEntityIndexMap(evaluator->_entityIndexMap);
+		GLMC_FREE(evaluator->_entityIndexMap);
+		evaluator->_entityIndexMap = NULL;
+	}
+	evaluator->_entityTransformCount = 0;
+}
 
-				*clothMaxExtentDest = maxExtent;
+//---------------------------------------------------------------------------
+// ids of the entities made by the duplicate and snap to transforms, in glmCreateEntityTransforms order. Only counts them when duplicatedEntityIds is NULL
+static unsigned int glmCollectDuplicatedEntityIds(const GlmHistory* history, int64_t* duplicatedEntityIds)
+{
+	unsigned int i;
+	unsigned int j;
+	unsigned int duplicateCount = 0;
+	unsigned int patchedDuplicateCount = 0;
 
-				clothReferenceDest++;
-				clothMaxExtentDest++;
-				clothAv++;
+	for (i = 0; i < history->_transformCount; i++)
+	{
+		if (history->_transformTypes[i] != SimulationCacheDuplicate && history->_transformTypes[i] != SimulationCacheSnapTo)
+			continue;
+		if (history->_active[i] != 0)
+		{
+			for (j = 0; duplicatedEntityIds && j < history->_duplicatedEntityArrayCount[i]; j++)
+			{
+				duplicatedEntityIds[duplicateCount + j] = history->_duplicatedEntityIds[patchedDuplicateCount + j];
 			}
+			duplicateCount += history->_duplicatedEntityArrayCount[i];
 		}
+		patchedDuplicateCount += history->_duplicatedEntityArrayCount[i];
 	}
+	return duplicateCount;
+}
 
-	for (i = 0; i < totalFrameOffsets; i++)
+//---------------------------------------------------------------------------
+static void glmMarkEntities(const GlmEntityIndexMap* entityIndexMap, const int64_t* entityIds, uint32_t start, uint32_t count, uint8_t* entityMask)
+{
+	uint32_t i;
+	for (i = 0; i < count; i++)
 	{
-		if (framesToLoad[i]._frame && framesToLoad[i]._frameIndex != currentFrame)
+		int entityIndex = glmFindEntityIndex(entityIndexMap, entityIds[start + i]);
+		if (entityIndex != -1)
+			entityMask[entityIndex] = 1;
+	}
+}
+
+//---------------------------------------------------------------------------
+// mark the entities referenced by changed transforms, before and after the change. Return 1 when a posture transform changed : postures are packed
+// in one allocation for all the entities, transforms have to be rebuilt
+static int glmMarkChangedTransformEntities(const GlmLayoutEvaluator* evaluator, const GlmHistory* history, const uint32_t* transformHashes, uint8_t* entityMask)
+{
+	unsigned int iTransform;
+	for (iTransform = 0; iTransform < history->_transformCount; iTransform++)
+	{
+		if (transformHashes[iTransform] == evaluator->_transformHashes[iTransform])
+			continue;
+		if (history->_transformTypes[iTransform] == SimulationCachePosture || evaluator->_transformTypes[iTransform] == SimulationCachePosture)
+			return 1;
+		glmMarkEntities(evaluator->_entityIndexMap, evaluator->_entityIds, evaluator->_entityArrayStartIndex[iTransform], evaluator->_entityArrayCount[iTransform], entityMask);
+		glmMarkEntities(evaluator->_entityIndexMap, evaluator->_duplicatedEntityIds, evaluator->_duplicatedEntityArrayStartIndex[iTransform], evaluator->_duplicatedEntityArrayCount[iTransform], entityMask);
+		glmMarkEntities(evaluator->_entityIndexMap, history->_entityIds, history->_entityArrayStartIndex[iTransform], history->_entityArrayCount[iTransform], entityMask);
+		glmMarkEntities(evaluator->_entityIndexMap, history->_duplicatedEntityIds, history->_duplicatedEntityArrayStartIndex[iTransform], history->_duplicatedEntityArrayCount[iTransform], entityMask);
+	}
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+// duplicates are copies of their source at the point of the history they are made : a masked source masks its duplicates and the other way around.
+// Same cursors as glmApplyHistoryToEntityTransforms. Return 1 when the mask grew
+static int glmExtendEntityMaskToDuplicates(GlmSimulationData* simulationData, const GlmHistory* history, const GlmEntityIndexMap* entityIndexMap, GlmEntityTransform* data, uint8_t* entityMask)
+{
+	unsigned int i;
+	unsigned int j;
+	unsigned int duplicateIndex = simulationData->_entityCount;
+	int grown = 0;
+
+	for (i = 0; i < history->_transformCount; i++)
+	{
+		if (history->_active[i] == 0 || history->_transformTypes[i] == SimulationCacheNoop)
+			continue;
+		if (history->_transformTypes[i] == SimulationCacheDuplicate)
 		{
-			glmDestroyFrameData(&framesToLoad[i]._frame, simulationDataIn);
+			for (j = 0; j < history->_entityArrayCount[i]; j++)
+			{
+				int entityIndex = glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[i] + j]);
+				if (entityIndex == -1)
+					continue;
+				if (entityMask[entityIndex] != entityMask[duplicateIndex])
+				{
+					entityMask[entityIndex] = 1;
+					entityMask[duplicateIndex] = 1;
+					grown = 1;
+				}
+				duplicateIndex++;
+			}
+		}
+		else if (history->_transformTypes[i] == SimulationCacheSnapTo)
+		{
+			unsigned int firstDuplicate = duplicateIndex;
+			unsigned int iDuplicate;
+			int masked = 0;
+			for (j = 0; j < history->_entityArrayCount[i]; j++)
+			{
+				int entityIndex = glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[i] + j]);
+				if (entityIndex == -1)
+					continue;
+				masked |= entityMask[entityIndex];
+				if (j < history->_snapToCount[i] && j == history->_entityArrayCount[i] - 1)
+					glmSnapToDuplicates(simulationData, history, entityIndexMap, data, i, &duplicateIndex, 0);
+			}
+			for (iDuplicate = firstDuplicate; iDuplicate < duplicateIndex; iDuplicate++)
+			{
+				masked |= entityMask[iDuplicate];
+			}
+			if (!masked)
+				continue;
+			for (j = 0; j < history->_entityArrayCount[i]; j++)
+			{
+				int entityIndex = glmFindEntityIndex(entityIndexMap, history->_entityIds[history->_entityArrayStartIndex[i] + j]);
+				if (entityIndex != -1 && !entityMask[entityIndex])
+				{
+					entityMask[entityIndex] = 1;
+					grown = 1;
+				}
+			}
+			for (iDuplicate = firstDuplicate; iDuplicate < duplicateIndex; iDuplicate++)
+			{
+				if (!entityMask[iDuplicate])
+				{
+					entityMask[iDuplicate] = 1;
+					grown = 1;
+				}
+			}
 		}
 	}
-	GLMC_FREE(framesToLoad);
-
-	return GSC_SUCCESS;
+	return grown;
 }
 
-void glmInterpolateFrameData(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result)
+//---------------------------------------------------------------------------
+// re-evaluate the masked entity transforms in place. Postures and cloth are kept, they do not depend on the changed transforms.
+// Return 0 when a masked entity changed of source entity : the simulation data layout and cloth of the last evaluation do not hold anymore,
+// -1 with the transforms untouched when out of memory
+static int glmReevaluateEntityTransforms(GlmLayoutEvaluator* evaluator, GlmHistory* history, const uint8_t* entityMask, unsigned int maskedCount)
 {
-	uint32_t boneValuesCount;
-	uint32_t snsValuesCount;
-	uint32_t blindDataCount;	
-	float tempQuat[4];
-	uint32_t iValue;
-	uint16_t iEntityType;
+	GlmSimulationData* simulationData = evaluator->_simulationDataIn;
+	GlmEntityTransform* data = evaluator->_entityTransforms;
+	GlmEntityTransform* previousTransforms = (GlmEntityTransform*)GLMC_MALLOC((maskedCount + 1) * sizeof(GlmEntityTransform));
+	unsigned int iEntity;
+	unsigned int iMasked = 0;
+	int sameSources = 1;
+
+	if (previousTransforms == NULL)
+		return -1;
 
-	boneValuesCount = 0;
+	for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
+	{
+		GlmEntityTransform* tr = &data[iEntity];
+		if (!entityMask[iEntity])
+			continue;
+		memcpy(&previousTransforms[iMasked++], tr, sizeof(GlmEntityTransform));
+		if (tr->_boneRestRelativeOrientation)
+			GLMC_FREE(tr->_boneRestRelativeOrientation);
+		if (tr->_boneRestRelativePosition)
+			GLMC_FREE(tr->_boneRestRelativePosition);
+		if (iEntity < simulationData->_entityCount)
+			glmInitEntityTransform(tr, simulationData->_entityIds[iEntity], iEntity, simulationData->_boneCount[simulationData->_entityTypes[iEntity]]);
+		else
+			glmInitEntityTransform(tr, tr->_entityId, -1, 0xFFFFFFFF);
+	}
 
-	if (!frameData2)
-		frameData2 = frameData1;
-	if (!frameData1)
-		frameData1 = frameData2;
-	if (!frameData1)
-		return;
+	glmApplyHistoryToEntityTransforms(simulationData, history, data, simulationData->_entityCount, evaluator->_entityIndexMap, entityMask);
 
-	if (frameData1->_simulationContentHashKey != simulationData->_contentHashKey || frameData1->_simulationContentHashKey != frameData2->_simulationContentHashKey)
-		return; // forbidden, different simu
+	iMasked = 0;
+	for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
+	{
+		GlmEntityTransform* tr = &data[iEntity];
+		const GlmEntityTransform* previous;
+		if (!entityMask[iEntity])
+			continue;
+		previous = &previousTransforms[iMasked++];
+		if (tr->_sourceIndexInCrowdField != previous->_sourceIndexInCrowdField)
+			sameSources = 0;
+		tr->_postureCount = previous->_postureCount;
+		tr->_lastEditPostureHistoryIndex = previous->_lastEditPostureHistoryIndex;
+		tr->_useCloth = previous->_useCloth;
+	}
+	GLMC_FREE(previousTransforms);
+	return sameSources;
+}
 
-				// compute total bone arrays size :
-	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+//---------------------------------------------------------------------------
+// frame data of all the entities from the current transforms
+static GlmSimulationCacheStatus glmEvaluateLayoutFrame(GlmLayoutEvaluator* evaluator, GlmFrameData* frameDataIn, GlmHistory* history, int currentFrame, const char* filePathModel, const char* cacheDirectory)
+{
+	GlmFrameData* frameDataOut = NULL;
+	GlmSimulationCacheStatus status;
+	int iEntity;
+
+	// set again by glmCreateModifiedFrameData for the new frame
+	for (iEntity = 0; iEntity < evaluator->_entityTransformCount; iEntity++)
 	{
-		boneValuesCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_boneCount[iEntityType];
+		evaluator->_entityTransforms[iEntity]._useCloth = 0;
+		evaluator->_entityTransforms[iEntity]._outOfCache = 0;
 	}
-	
-	// interpolate posture positions / orientations
-	for (iValue = 0; iValue < boneValuesCount; iValue++)
+	if (evaluator->_deferDuplicates)
 	{
-		float *q1;
-		float *q2;
-		float *qResult;
-		float cosom;
-
-		result->_bonePositions[iValue][0] = interpolateFloat(frameData1->_bonePositions[iValue][0],frameData2->_bonePositions[iValue][0],ratio);
-		result->_bonePositions[iValue][1] = interpolateFloat(frameData1->_bonePositions[iValue][1],frameData2->_bonePositions[iValue][1],ratio);
-		result->_bonePositions[iValue][2] = interpolateFloat(frameData1->_bonePositions[iValue][2],frameData2->_bonePositions[iValue][2],ratio);
+		GlmDeferredFrameData* deferredFrameDataOut = NULL;
+		status = glmCreateDeferredFrameData(evaluator->_simulationDataIn, frameDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, history, &deferredFrameDataOut, currentFrame, filePathModel, cacheDirectory);
+		if (status != GSC_SUCCESS)
+			return status;
+		if (evaluator->_deferredFrameDataOut)
+			glmDestroyDeferredFrameData(&evaluator->_deferredFrameDataOut);
+		evaluator->_deferredFrameDataOut = deferredFrameDataOut;
+	}
+	else
+	{
+		status = glmCreateModifiedFrameData(evaluator->_simulationDataIn, frameDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, history, evaluator->_simulationDataOut, &frameDataOut, currentFrame, filePathModel, cacheDirectory);
+		if (status != GSC_SUCCESS)
+			return status;
+		if (evaluator->_frameDataOut)
+			glmDestroyFrameData(&evaluator->_frameDataOut, evaluator->_simulationDataOut);
+		evaluator->_frameDataOut = frameDataOut;
+	}
+	evaluator->_updatedEntityCount = evaluator->_entityTransformCount;
+	return GSC_SUCCESS;
+}
 
-		// see interpolate_noFactorRangeCheck, can't make quaternion here
-		q1 = frameData1->_boneOrientations[iValue];
-		q2 = frameData2->_boneOrientations[iValue];
-		qResult = result->_boneOrientations[iValue];
+//---------------------------------------------------------------------------
+// frame data of the masked entities, on the frame of the last evaluation. The masked entities are evaluated as a layout of their own,
+// without cloth : the cloth layout of the output frame does not change, their cloth vertices are transformed in place afterwards.
+// Entity i is entity outputIndices[i] of simulationDataOut / frameOut, entity i when outputIndices is NULL
+static GlmSimulationCacheStatus glmEvaluateLayoutEntities(GlmLayoutEvaluator* evaluator, GlmFrameData* frameDataIn, GlmHistory* history, const uint8_t* entityMask, unsigned int maskedCount, GlmSimulationData* simulationDataOut, GlmFrameData* frameOut, const int32_t* outputIndices, int currentFrame, const char* filePathModel, const char* cacheDirectory)
+{
+	GlmSimulationData* simulationDataIn = evaluator->_simulationDataIn;
+	GlmEntityTransform* entityTransforms = evaluator->_entityTransforms;
+	GlmEntityTransform* maskedTransforms;
+	GlmSimulationData* maskedSimulationData;
+	GlmFrameData* maskedFrameData = NULL;
+	GlmFrameData frameDataNoCloth;
+	GlmSimulationCacheStatus status;
+	unsigned int iEntity;
+	unsigned int iMasked = 0;
+
+	maskedTransforms = (GlmEntityTransform*)GLMC_MALLOC((maskedCount + 1) * sizeof(GlmEntityTransform));
+	if (maskedTransforms == NULL)
+		return GSC_OUT_OF_MEMORY;
+	for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
+	{
+		if (entityMask[iEntity])
+			memcpy(&maskedTransforms[iMasked++], &entityTransforms[iEntity], sizeof(GlmEntityTransform));
+	}
+	// work buffers are shared through the first transform
+	maskedTransforms->_sortedBonesWorldOri = entityTransforms->_sortedBonesWorldOri;
+	maskedTransforms->_sortedBonesWorldPos = entityTransforms->_sortedBonesWorldPos;
+	maskedTransforms->_sortedBonesScale = entityTransforms->_sortedBonesScale;
+	maskedTransforms->_restRelativeOri = entityTransforms->_restRelativeOri;
+
+	memcpy(&frameDataNoCloth, frameDataIn, sizeof(GlmFrameData));
+	frameDataNoCloth._clothEntityCount = 0;
+
+	glmCreateModifiedSimulationData(simulationDataIn, maskedTransforms, maskedCount, &maskedSimulationData);
+	if (maskedSimulationData == NULL)
+	{
+		GLMC_FREE(maskedTransforms);
+		return GSC_OUT_OF_MEMORY;
+	}
+	status = glmCreateModifiedFrameData(simulationDataIn, &frameDataNoCloth, maskedTransforms, maskedCount, history, maskedSimulationData, &maskedFrameData, currentFrame, filePathModel, cacheDirectory);
+	if (status == GSC_SUCCESS)
+	{
+		iMasked = 0;
+		for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
+		{
+			if (!entityMask[iEntity])
+				continue;
+			glmCopyEntityFrameDataRaw(maskedFrameData, maskedSimulationData, iMasked, frameOut, simulationDataOut, outputIndices ? (unsigned int)outputIndices[iEntity] : iEntity);
+			// matrices and frame offsets of this frame
+			memcpy(&entityTransforms[iEntity], &maskedTransforms[iMasked], sizeof(GlmEntityTransform));
+			iMasked++;
+		}
+		glmDestroyFrameData(&maskedFrameData, maskedSimulationData);
+	}
+	glmDestroySimulationData(&maskedSimulationData);
+	GLMC_FREE(maskedTransforms);
 
-		cosom = (q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3]);
+	if (status == GSC_SUCCESS && frameOut->_clothEntityCount)
+	{
+		GlmClothTransformTask task;
+		unsigned int itemCount = 0;
+		uint32_t clothAv = 0;
 
-		if (cosom < 0.f)
+		task._frameOut = frameOut;
+		task._entityTransforms = entityTransforms;
+		task._clothTransformIndices = (uint32_t*)GLMC_MALLOC((maskedCount + 1) * sizeof(uint32_t));
+		task._clothVertexCounts = (uint32_t*)GLMC_MALLOC((maskedCount + 1) * sizeof(uint32_t));
+		task._clothEntityIndices = (uint32_t*)GLMC_MALLOC((maskedCount + 1) * sizeof(uint32_t));
+		if (task._clothTransformIndices == NULL || task._clothVertexCounts == NULL || task._clothEntityIndices == NULL)
 		{
-			tempQuat[0] = -q2[0];
-			tempQuat[1] = -q2[1];
-			tempQuat[2] = -q2[2];
-			tempQuat[3] = -q2[3];
+			GLMC_FREE(task._clothEntityIndices);
+			GLMC_FREE(task._clothVertexCounts);
+			GLMC_FREE(task._clothTransformIndices);
+			return GSC_OUT_OF_MEMORY;
 		}
-		else
+
+		// output cloth entities are in entity order
+		for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
 		{
-			tempQuat[0] = q2[0];
-			tempQuat[1] = q2[1];
-			tempQuat[2] = q2[2];
-			tempQuat[3] = q2[3];
+			int32_t outputIndex = outputIndices ? outputIndices[iEntity] : (int32_t)iEntity;
+			if (outputIndex < 0 || frameOut->_entityClothIndex[outputIndex] == -1)
+				continue;
+			if (entityMask[iEntity])
+			{
+				uint32_t lastVertex = (clothAv + 1 < frameOut->_clothEntityCount) ? frameOut->_clothEntityFirstMeshVertex[clothAv + 1] : frameOut->_clothTotalVertices;
+				task._clothTransformIndices[itemCount] = iEntity;
+				task._clothVertexCounts[itemCount] = lastVertex - frameOut->_clothEntityFirstMeshVertex[clothAv];
+				task._clothEntityIndices[itemCount] = clothAv;
+				itemCount++;
+			}
+			clothAv++;
 		}
+		glmRunParallelFor(glmTransformClothEntities, &task, itemCount);
 
-		// linear interp
-		qResult[0] = interpolateFloat(q1[0], tempQuat[0], ratio);
-		qResult[1] = interpolateFloat(q1[1], tempQuat[1], ratio);
-		qResult[2] = interpolateFloat(q1[2], tempQuat[2], ratio);
-		qResult[3] = interpolateFloat(q1[3], tempQuat[3], ratio);
+		GLMC_FREE(task._clothEntityIndices);
+		GLMC_FREE(task._clothVertexCounts);
+		GLMC_FREE(task._clothTransformIndices);
+	}
+	evaluator->_updatedEntityCount = maskedCount;
+	return status;
+}
 
-		// normalize is needed after per component linear interpolation. SSE is not available here as we may not be aligned
-		{
-			static const float very_small_float = 1.0e-037f; // from http://altdevblogaday.com/2011/08/21/practical-flt-point-tricks/, adding a very small float avoid testing if == 0
-			float factor = (1.f / sqrtf(qResult[0] * qResult[0] + qResult[1] * qResult[1] + qResult[2] * qResult[2] + qResult[3] * qResult[3] + very_small_float));
-			qResult[0] *= factor;
-			qResult[1] *= factor;
-			qResult[2] *= factor;
-			qResult[3] *= factor;
-		}
+//---------------------------------------------------------------------------
+// masked entities of a deferred result : deferred entities get their new transform, the materialized ones are evaluated in the materialized frame.
+// An entity which becomes deferrable or stops being deferrable changes the materialized layout, the whole frame is evaluated again
+static GlmSimulationCacheStatus glmEvaluateDeferredLayoutEntities(GlmLayoutEvaluator* evaluator, GlmFrameData* frameDataIn, GlmHistory* history, const uint8_t* entityMask, unsigned int maskedCount, int currentFrame, const char* filePathModel, const char* cacheDirectory)
+{
+	GlmDeferredFrameData* deferredFrameData = evaluator->_deferredFrameDataOut;
+	int canDefer = glmCanDeferFrameData(frameDataIn, history);
+	uint8_t* materializedMask;
+	unsigned int materializedCount = 0;
+	unsigned int iEntity;
+	GlmSimulationCacheStatus status = GSC_SUCCESS;
+
+	for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
+	{
+		int deferred = deferredFrameData->_entityIndices[iEntity] < 0;
+		if (entityMask[iEntity] && deferred != (canDefer && glmIsDeferrableTransform(evaluator->_simulationDataIn, &evaluator->_entityTransforms[iEntity], iEntity)))
+			return glmEvaluateLayoutFrame(evaluator, frameDataIn, history, currentFrame, filePathModel, cacheDirectory);
 	}
 
-	// interpolate snsValues
-	snsValuesCount = 0;
-	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	materializedMask = (uint8_t*)GLMC_MALLOC((evaluator->_entityTransformCount + 1) * sizeof(uint8_t));
+	if (materializedMask == NULL)
+		return GSC_OUT_OF_MEMORY;
+	for (iEntity = 0; iEntity < (unsigned int)evaluator->_entityTransformCount; iEntity++)
 	{
-		snsValuesCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_snsCountPerEntityType[iEntityType];
+		int32_t index = deferredFrameData->_entityIndices[iEntity];
+		materializedMask[iEntity] = entityMask[iEntity] && index >= 0;
+		materializedCount += materializedMask[iEntity];
+		if (entityMask[iEntity] && index < 0)
+			glmDeferEntityTransform(deferredFrameData, &evaluator->_entityTransforms[iEntity], (uint32_t)(-1 - index), currentFrame);
 	}
-	// interpolate posture positions / orientations
-	for (iValue = 0; iValue < snsValuesCount; iValue++)
+	if (materializedCount)
 	{
-		result->_snsValues[iValue][0] = interpolateFloat(frameData1->_snsValues[iValue][0], frameData2->_snsValues[iValue][0], ratio);
-		result->_snsValues[iValue][1] = interpolateFloat(frameData1->_snsValues[iValue][1], frameData2->_snsValues[iValue][1], ratio);
-		result->_snsValues[iValue][2] = interpolateFloat(frameData1->_snsValues[iValue][2], frameData2->_snsValues[iValue][2], ratio);
-		result->_snsValues[iValue][3] = interpolateFloat(frameData1->_snsValues[iValue][3], frameData2->_snsValues[iValue][3], ratio);
+		glmScaleModifiedSimulationData(evaluator->_simulationDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, deferredFrameData->_materializedSimulationData, materializedMask, deferredFrameData->_entityIndices);
+		status = glmEvaluateLayoutEntities(evaluator, frameDataIn, history, materializedMask, materializedCount, deferredFrameData->_materializedSimulationData, deferredFrameData->_materializedFrameData, deferredFrameData->_entityIndices, currentFrame, filePathModel, cacheDirectory);
 	}
+	GLMC_FREE(materializedMask);
+	evaluator->_updatedEntityCount = maskedCount;
+	return status;
+}
 
-	// interpolate geoBehavior
-	if (frameData1->_geoBehaviorAnimFrameInfo != NULL)
-	{
-		// IDs and modes should not be interpolated, animframeinfo only on "current" part, so just copy everything from frame1 and change what needs to be changed
-		memcpy(result->_geoBehaviorAnimFrameInfo, frameData1->_geoBehaviorAnimFrameInfo, sizeof(float) * 3 * simulationData->_entityCount);
-		memcpy(result->_geoBehaviorBlendModes, frameData1->_geoBehaviorBlendModes, sizeof(uint8_t) * simulationData->_entityCount);
-		memcpy(result->_geoBehaviorGeometryIds, frameData1->_geoBehaviorGeometryIds, sizeof(uint16_t) * simulationData->_entityCount);
+//---------------------------------------------------------------------------
+GlmSimulationCacheStatus glmUpdateLayoutEvaluator(GlmLayoutEvaluator* evaluator, GlmFrameData* frameDataIn, GlmHistory* history, int currentFrame, const char* filePathModel, const char* cacheDirectory)
+{
+	GlmSimulationData* simulationDataIn = evaluator->_simulationDataIn;
+	uint32_t* transformHashes;
+	uint32_t historyHash;
+	uint8_t* dirtyEntities = NULL;
+	unsigned int dirtyCount = 0;
+	unsigned int duplicateCount;
+	int iEntity;
+	int rebuild;
+	GlmSimulationCacheStatus status = GSC_SUCCESS;
 
-		for (iValue = 0; iValue < simulationData->_entityCount; iValue++) // beware !! this should be processed in entityType/entity order but here order does not matter as we interpolate all
-		{
-			// animFrameInfo 0 = current, 
-			float frame1Current = frameData1->_geoBehaviorAnimFrameInfo[iValue][0];
-			float frame2Current = frameData2->_geoBehaviorAnimFrameInfo[iValue][0];
-			float* resultCurrent = &(result->_geoBehaviorAnimFrameInfo[iValue][0]);
+	historyHash = glmHashHistoryShared(history);
+	transformHashes = (uint32_t*)GLMC_MALLOC((history->_transformCount + 1) * sizeof(uint32_t));
+	if (transformHashes == NULL)
+		status = GSC_OUT_OF_MEMORY;
+	duplicateCount = glmCollectDuplicatedEntityIds(history, NULL);
 
-			if (frame1Current > frame2Current)
+	rebuild = evaluator->_entityTransforms == NULL
+		|| evaluator->_historyHash != historyHash
+		|| evaluator->_transformCount != history->_transformCount
+		|| (unsigned int)evaluator->_entityTransformCount != simulationDataIn->_entityCount + duplicateCount;
+
+	// same entity set : same duplicate ids, in the same order
+	if (status == GSC_SUCCESS && !rebuild && duplicateCount)
+	{
+		unsigned int iDuplicate;
+		int64_t* duplicatedEntityIds = (int64_t*)GLMC_MALLOC(duplicateCount * sizeof(int64_t));
+		if (duplicatedEntityIds == NULL)
+			status = GSC_OUT_OF_MEMORY;
+		else
+		{
+			glmCollectDuplicatedEntityIds(history, duplicatedEntityIds);
+			for (iDuplicate = 0; iDuplicate < duplicateCount && !rebuild; iDuplicate++)
 			{
-				float startAttribute = frameData1->_geoBehaviorAnimFrameInfo[iValue][1];
-				float stopAttribute = frameData1->_geoBehaviorAnimFrameInfo[iValue][2];
+				rebuild = evaluator->_entityTransforms[simulationDataIn->_entityCount + iDuplicate]._entityId != duplicatedEntityIds[iDuplicate];
+			}
+			GLMC_FREE(duplicatedEntityIds);
+		}
+	}
 
-				// in case of loop behavior, with a cycle [5-25], we can have val1 = 23.5 & val2 = 5.5
-				// we have to interpolate 23.5 with 23.5 + 5.5 and to offset the result in the range of the cycle
-				float frameStep = (stopAttribute - frame1Current) + (frame2Current - startAttribute);
-				float interFrame = frame1Current + frameStep * ratio;
-				if (interFrame <= stopAttribute)
-					*resultCurrent = interFrame;
-				else
-					*resultCurrent = interFrame - stopAttribute + startAttribute;
+	if (status == GSC_SUCCESS && !rebuild)
+	{
+		glmHashHistoryTransforms(history, evaluator->_entityIndexMap, transformHashes);
+		dirtyEntities = (uint8_t*)GLMC_MALLOC((evaluator->_entityTransformCount + 1) * sizeof(uint8_t));
+		if (dirtyEntities == NULL)
+			status = GSC_OUT_OF_MEMORY;
+		else
+		{
+			memset(dirtyEntities, 0, evaluator->_entityTransformCount * sizeof(uint8_t));
+			rebuild = glmMarkChangedTransformEntities(evaluator, history, transformHashes, dirtyEntities);
+		}
+		if (status == GSC_SUCCESS && !rebuild)
+		{
+			while (glmExtendEntityMaskToDuplicates(simulationDataIn, history, evaluator->_entityIndexMap, evaluator->_entityTransforms, dirtyEntities))
+				;
+			for (iEntity = 0; iEntity < evaluator->_entityTransformCount; iEntity++)
+			{
+				dirtyCount += dirtyEntities[iEntity];
 			}
-			else
+			if (dirtyCount)
 			{
-				*resultCurrent = interpolateFloat(frame1Current, frame2Current, ratio);
+				int reevaluated = glmReevaluateEntityTransforms(evaluator, history, dirtyEntities, dirtyCount);
+				if (reevaluated < 0)
+					status = GSC_OUT_OF_MEMORY;
+				else
+					rebuild = !reevaluated;
 			}
 		}
 	}
 
-	// interpolate blindData
-	blindDataCount = 0;
-	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+	if (status == GSC_SUCCESS && rebuild)
 	{
-		blindDataCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_blindDataCount[iEntityType];
+		glmClearLayoutEvaluatorResult(evaluator);
+		glmCreateEntityTransforms(simulationDataIn, history, &evaluator->_entityTransforms, &evaluator->_entityTransformCount);
+		evaluator->_entityIndexMap = (GlmEntityIndexMap*)GLMC_MALLOC(sizeof(GlmEntityIndexMap));
+		if (evaluator->_entityIndexMap == NULL)
+			status = GSC_OUT_OF_MEMORY;
+		else
+		{
+			glmCreateEntityIndexMap(evaluator->_entityIndexMap, evaluator->_entityTransforms, evaluator->_entityTransformCount);
+			// transform only layouts share the source arrays
+			evaluator->_simulationDataOutIsView = (uint8_t)glmCreateModifiedSimulationDataView(simulationDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, &evaluator->_simulationDataOut);
+			if (!evaluator->_simulationDataOutIsView)
+				glmCreateModifiedSimulationData(simulationDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, &evaluator->_simulationDataOut);
+			if (evaluator->_simulationDataOut == NULL)
+				status = GSC_OUT_OF_MEMORY;
+		}
+		if (status == GSC_SUCCESS)
+		{
+			glmHashHistoryTransforms(history, evaluator->_entityIndexMap, transformHashes);
+			evaluator->_updatedTransformCount = evaluator->_entityTransformCount;
+		}
 	}
-	for (iValue = 0; iValue < blindDataCount; iValue++)
+	else if (status == GSC_SUCCESS)
 	{
-		result->_blindData[iValue] = interpolateFloat(frameData1->_blindData[iValue], frameData2->_blindData[iValue], ratio);
+		// entity layout has not changed, only scales
+		if (dirtyCount)
+			glmScaleModifiedSimulationData(simulationDataIn, evaluator->_entityTransforms, evaluator->_entityTransformCount, evaluator->_simulationDataOut, dirtyEntities, NULL);
+		evaluator->_updatedTransformCount = dirtyCount;
 	}
 
-	// interpolate pp attributes -> they are just copied we can't be sure they can be interpolated
-	for (iValue = 0; iValue < simulationData->_ppFloatAttributeCount; iValue++)
+	evaluator->_updatedEntityCount = 0;
+	if (status == GSC_SUCCESS)
 	{
-		memcpy(result->_ppFloatAttributeData[iValue], frameData1->_ppFloatAttributeData[iValue], simulationData->_entityCount * sizeof(float));
+		if (rebuild || (evaluator->_frameDataOut == NULL && evaluator->_deferredFrameDataOut == NULL) || frameDataIn == NULL || evaluator->_frameDataIn != frameDataIn || evaluator->_currentFrame != currentFrame)
+			status = glmEvaluateLayoutFrame(evaluator, frameDataIn, history, currentFrame, filePathModel, cacheDirectory);
+		else if (dirtyCount && evaluator->_deferDuplicates)
+			status = glmEvaluateDeferredLayoutEntities(evaluator, frameDataIn, history, dirtyEntities, dirtyCount, currentFrame, filePathModel, cacheDirectory);
+		else if (dirtyCount)
+			status = glmEvaluateLayoutEntities(evaluator, frameDataIn, history, dirtyEntities, dirtyCount, evaluator->_simulationDataOut, evaluator->_frameDataOut, NULL, currentFrame, filePathModel, cacheDirectory);
 	}
+	GLMC_FREE(dirtyEntities);
 
-	for (iValue = 0; iValue< simulationData->_ppVectorAttributeCount; iValue++)
+	if (status != GSC_SUCCESS)
 	{
-		memcpy(result->_ppVectorAttributeData[iValue], frameData1->_ppVectorAttributeData[iValue], simulationData->_entityCount * sizeof(float) * 3);
+		// evaluate from scratch next time
+		GLMC_FREE(transformHashes);
+		glmClearLayoutEvaluatorResult(evaluator);
+		glmClearLayoutEvaluatorHistory(evaluator);
+		return status;
 	}
 
-	// interpolate cloth : copy structures from frame1 and interpolate all vertices only (we have total vertices count in frameData)
-	if (frameData1->_clothEntityCount > 0 && frameData1->_clothTotalVertices > 0 && frameData1->_clothTotalVertices == frameData2->_clothTotalVertices)
+	// remember the evaluated history
+	if (!glmStoreLayoutEvaluatorHistory(evaluator, history, historyHash, transformHashes))
 	{
-		glmCreateClothData(simulationData, result, frameData1->_clothEntityCount, frameData1->_clothTotalMeshIndices, frameData1->_clothTotalVertices);
-
-		memcpy(result->_entityClothIndex, frameData1->_entityClothIndex, simulationData->_entityCount * sizeof(int32_t));
-
-		memcpy(result->_clothEntityFirstAssetMeshIndex, frameData1->_clothEntityFirstAssetMeshIndex, result->_clothEntityCount * sizeof(uint32_t));
-		memcpy(result->_clothEntityFirstMeshVertex, frameData1->_clothEntityFirstMeshVertex, result->_clothEntityCount * sizeof(uint32_t));
-		memcpy(result->_clothEntityMeshCount, frameData1->_clothEntityMeshCount, result->_clothEntityCount * sizeof(uint32_t));
-		memcpy(result->_clothEntityQuantizationReference, frameData1->_clothEntityQuantizationReference, result->_clothEntityCount * sizeof(float[3]));
-		memcpy(result->_clothEntityQuantizationMaxExtent, frameData1->_clothEntityQuantizationMaxExtent, result->_clothEntityCount * sizeof(float));
-		
-		memcpy(result->_clothMeshIndicesInCharAssets, frameData1->_clothMeshIndicesInCharAssets, result->_clothAllocatedIndices * sizeof(uint32_t));
-		memcpy(result->_clothMeshVertexCount, frameData1->_clothMeshVertexCount, result->_clothAllocatedIndices * sizeof(uint32_t));
-		//memcpy(result->_clothMeshVertexOffsetPerClothIndex, frameData1->_clothMeshVertexOffsetPerClothIndex, clothIndices * sizeof(uint32_t));
-
-		// interpolate vertex per vertex
-		for (iValue = 0; iValue < frameData1->_clothTotalVertices; iValue++)
-		{
-			result->_clothVertices[iValue][0] = interpolateFloat(frameData1->_clothVertices[iValue][0], frameData2->_clothVertices[iValue][0], ratio);
-			result->_clothVertices[iValue][1] = interpolateFloat(frameData1->_clothVertices[iValue][1], frameData2->_clothVertices[iValue][1], ratio);
-			result->_clothVertices[iValue][2] = interpolateFloat(frameData1->_clothVertices[iValue][2], frameData2->_clothVertices[iValue][2], ratio);
-		}
+		// transformHashes is released with the history copies, evaluate from scratch next time
+		glmClearLayoutEvaluatorResult(evaluator);
+		return GSC_OUT_OF_MEMORY;
 	}
+	evaluator->_frameDataIn = frameDataIn;
+	evaluator->_currentFrame = currentFrame;
+	return GSC_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+void glmDestroyLayoutEvaluator(GlmLayoutEvaluator** evaluator)
+{
+	if (*evaluator == NULL)
+		return;
+	glmClearLayoutEvaluatorResult(*evaluator);
+	glmClearLayoutEvaluatorHistory(*evaluator);
+	GLMC_FREE(*evaluator);
+	*evaluator = NULL;
 }
 
 uint32_t getClothEntityMeshCount(const GlmFrameData* frameData, int clothEntityIndex)
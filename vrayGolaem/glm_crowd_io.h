@@ -19,8 +19,40 @@
 #include <math.h>
 #include <float.h>
 #include <vector>
+#include <string>
+#include <algorithm>
+// std threads and thread_local need VS2015, the VS2010 (vc101) and VS2012 (vc11) builds lock with CRITICAL_SECTION and run glmParallelForThreads serially
+#if !defined(GIO_NO_STD_THREADS) && (!defined(_MSC_VER) || _MSC_VER >= 1900)
+#define GIO_USE_STD_THREADS
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#elif !defined(_WIN32)
+#include <pthread.h>
+#endif
+#if defined(_M_X64) || defined(__SSE2__)
+#define GIO_USE_SSE
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 //#define GLM_DEVKIT_SKIP_FBX_TERRAIN // declare this before including this file, to disable fbx terrain feature, and get rid of fbx dependency
 
@@ -112,16 +144,70 @@
 #define GIO_MAX_FRAMES 10000
 #define GIO_MAX_INSTANCE_MESHES 10000
 #define GIO_MAX_INSTANCE_MATRIX_PER_ENTITY 1000
+#define GIO_INSTANCE_MATRIX_CHUNK_SIZE 16 // instance matrices allocated 1 KB at a time
+#define GIO_INSTANCE_GROUP_CHUNK_SIZE 256 // mesh instance groups allocated 256 at a time
 #define GIO_NO_SHADER_GROUP_IDX UINT16_MAX
+#define GIO_INTERPOLATION_BONES_PER_TASK 16384 // multiple of 8 to keep the SIMD loop full, smaller crowds are interpolated on the calling thread
+#define GIO_MAX_INTERNED_STRINGS (1 << 22)
+#define GIO_INVALID_STRING_HANDLE UINT32_MAX
 
 #define GCG_MAGIC_NUMBER 0x6C60
 #define GTG_MAGIC_NUMBER 0x6760
+#define GTB_MAGIC_NUMBER 0x67B0 // prebuilt terrain AABB hierarchy, stored next to the terrain file
+#define GTB_VERSION 0x02
 
 namespace CrowdTerrain
 {
 	struct Mesh;
 }
 
+#ifdef __cplusplus
+// chunked array allocated on demand, elements never move once allocated so pointers stay valid while it grows.
+// Only the chunk directory is embedded, no constructor so it can live in memset/GLMC_MALLOC allocated structs : call init/release
+template<typename T, unsigned int chunkSize, unsigned int maxCount> struct GlmPooledArray
+{
+	enum { CHUNK_COUNT = (maxCount + chunkSize - 1) / chunkSize };
+
+	void init()
+	{
+		memset(_chunks, 0, sizeof(_chunks));
+		_allocatedChunkCount = 0;
+	}
+
+	void release()
+	{
+		for (uint32_t iChunk = 0; iChunk < _allocatedChunkCount; iChunk++)
+			GLMC_FREE(_chunks[iChunk]);
+		init();
+	}
+
+	// make elements [0, count) available, returns 0 if count > maxCount or allocation failed. Not threadsafe : lock around concurrent reserves
+	int reserve(uint32_t count)
+	{
+		if (count > maxCount)
+			return 0;
+		while (_allocatedChunkCount * chunkSize < count)
+		{
+			T* chunk = (T*)GLMC_MALLOC(chunkSize * sizeof(T));
+			if (!chunk)
+				return 0;
+			memset(chunk, 0, chunkSize * sizeof(T));
+			_chunks[_allocatedChunkCount++] = chunk;
+		}
+		return 1;
+	}
+
+	uint32_t capacity() const { return _allocatedChunkCount * chunkSize; }
+	size_t allocatedBytes() const { return sizeof(*this) + (size_t)_allocatedChunkCount * chunkSize * sizeof(T); }
+
+	T& operator[] (uint32_t index) { return _chunks[index / chunkSize][index % chunkSize]; }
+	const T& operator[] (uint32_t index) const { return _chunks[index / chunkSize][index % chunkSize]; }
+
+	T* _chunks[CHUNK_COUNT];
+	uint32_t _allocatedChunkCount;
+};
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -152,6 +238,16 @@ extern "C"
 	};
 	typedef GlmShader_0 GlmShader;
 
+	// handle of a string interned in a GlmStringTable, GIO_INVALID_STRING_HANDLE if none
+	typedef uint32_t GlmStringHandle;
+
+	// same as GlmShader_0 with interned strings
+	struct GlmShader_1
+	{
+		GlmStringHandle _name; // name of the shader
+		GlmStringHandle _category; // category of the shader: surface, displace, etc..
+	};
+
 	// Shader group contains an array of shaders and an array of attributes names, values are stored per mesh in GlmMesh 
 	struct GlmShaderGroup_0
 	{
@@ -177,6 +273,30 @@ extern "C"
 	};
 	typedef GlmShaderGroup_0 GlmShaderGroup;
 
+	// same as GlmShaderGroup_0 with interned strings
+	struct GlmShaderGroup_1
+	{
+		GlmStringHandle _name;
+		uint16_t _intShaderAttributeCount;
+		GlmStringHandle* _intShaderAttributeNames; // array size = _intShaderAttributeCount
+		uint16_t* _intShaderAttributeIndexes; // array size = _intShaderAttributeCount
+
+		uint16_t _floatShaderAttributeCount;
+		GlmStringHandle* _floatShaderAttributeNames; // array size = _floatShaderAttributeCount
+		uint16_t* _floatShaderAttributeIndexes; // array size = _floatShaderAttributeCount
+
+		uint16_t _fileShaderAttributeCount;
+		GlmStringHandle* _fileShaderAttributeNames; // array size = _fileShaderAttributeCount
+		uint16_t* _fileShaderAttributeIndexes; // array size = _fileShaderAttributeCount
+
+		uint16_t _vectorShaderAttributeCount;
+		GlmStringHandle* _vectorShaderAttributeNames; // array size = _vectorShaderAttributeCount
+		uint16_t* _vectorShaderAttributeIndexes; // array size = _vectorShaderAttributeCount
+
+		uint16_t _shaderCount;
+		GlmShader_1* _shaders;
+	};
+
 	// Input and ouput parameters passed as a context between functions declared below
 	struct GlmPPAttributes_0
 	{
@@ -327,13 +447,46 @@ extern "C"
 		// UVs
 		uint8_t _hasUVs; // 1 if the character has UV coordinates / mesh
 		uint8_t _uvsByControlPoint; // 1 if the UVs are mapped by control point / mesh
-		float(*_Us); // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
-		float(*_Vs); // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
+		float* _Us; // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
+		float* _Vs; // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
 		// object id
 		uint32_t _objectId;
 	};
 	typedef GlmMesh_0 GlmMesh;
 
+	// same as GlmMesh_0 with an interned name
+	struct GlmMesh_1
+	{
+		int32_t _instanceGroup;
+		int32_t _instanceIndex;
+		int16_t _instanceFirstMatrixIndex;
+
+		GlmStringHandle _name; // name of the mesh
+		// shaders
+		uint16_t _shaderGroupIdx;
+		// vertices
+		uint32_t _verticeCount; // number of vertices per mesh
+		float(**_vertices)[3]; // vertex positions, array size first dimension = _frameToProcessCounts, second dimension = _verticeCount
+		// polygons
+		uint32_t _polygonCount;	// number of polygons per mesh
+		uint32_t* _verticePerPolygonCount; // number of vertices by polygon, array size = _polygonCount
+		uint32_t* _vertexIndicesPerPolygon; // id of vertices by polygon, array size = _polygonCount * _verticePerPolygonCount
+		// normals
+		uint8_t _hasNormals; // 1 if the character has normals / control point. Normals are always extracted as mapped per polygon vertex
+		float(**_normals)[3]; // normals per polygon vertex, array size first dimension = _frameToProcessCounts, second dimension = _polygonCount * _verticePerPolygonCount
+		// tangents
+		uint8_t _hasTangents; // 1 if the character has tangents / mesh
+		uint8_t _tangentsByControlPoint;
+		float(*_tangents)[6]; // tangents and binormals. If _tangentsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
+		// UVs
+		uint8_t _hasUVs; // 1 if the character has UV coordinates / mesh
+		uint8_t _uvsByControlPoint; // 1 if the UVs are mapped by control point / mesh
+		float* _Us; // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
+		float* _Vs; // U coordinates. If _uvsByControlPoint == 1 then array size == _verticeCount, else array size = _polygonCount * _verticePerPolygonCount
+		// object id
+		uint32_t _objectId;
+	};
+
 	// Render data for an entity: meshes
 	struct GlmEntityGeometry_0
 	{
@@ -346,6 +499,18 @@ extern "C"
 		float(*_vectorShaderAttributeValues)[3]; // use GlmShaderGroup::_vectorShaderAttributeCount and GlmShaderGroup::_vectorShaderAttributeIndexes to access it
 	};
 	typedef GlmEntityGeometry_0 GlmEntityGeometry;
+
+	// same as GlmEntityGeometry_0 with interned strings
+	struct GlmEntityGeometry_1
+	{
+		uint16_t _meshCount;
+		GlmMesh_1* _meshes;
+
+		int32_t* _intShaderAttributeValues; // use GlmShaderGroup::_intShaderAttributeCount and GlmShaderGroup::_intShaderAttributeIndexes to access it
+		float* _floatShaderAttributeValues; // use GlmShaderGroup::_floatShaderAttributeCount and GlmShaderGroup::_floatShaderAttributeIndexes to access it
+		GlmStringHandle* _fileShaderAttributeValues; // use GlmShaderGroup::_fileShaderAttributeCount and GlmShaderGroup::_fileShaderAttributeIndexes to access it
+		float(*_vectorShaderAttributeValues)[3]; // use GlmShaderGroup::_vectorShaderAttributeCount and GlmShaderGroup::_vectorShaderAttributeIndexes to access it
+	};
 	
 	typedef float GlmMeshInstanceMatrix[4][4];
 
@@ -369,18 +534,20 @@ extern "C"
 	};
 	typedef GlmMeshInstanceGroupSortEntry_0 GlmMeshInstanceGroupSortEntry;
 
-	// static allocation of instanceMatrices to avoid reallocating (and thus locking) matrices
+	// pooled allocation of instanceMatrices : matrices never move (no locking) and an entity using 3 matrices holds 1 ko instead of 64 ko.
+	// glmInitEntityInstanceMatrices before use, glmAddEntityInstanceMatrix to append, glmReleaseEntityInstanceMatrices when done
 	struct GlmEntityInstanceMatrices
 	{
-		GlmMeshInstanceMatrix _instanceMatrices[GIO_MAX_INSTANCE_MATRIX_PER_ENTITY]; // by default 64 ko = 16 float * 1k
+		GlmPooledArray<GlmMeshInstanceMatrix, GIO_INSTANCE_MATRIX_CHUNK_SIZE, GIO_MAX_INSTANCE_MATRIX_PER_ENTITY> _instanceMatrices;
 		uint16_t _instanceMatrixUsedCount;
 	};
 
 	// instances per crowdField, to be able to diemnsion it according to frame count
+	// glmInitMeshInstanceGroups before use, glmAddMeshInstanceGroup to append, glmReleaseMeshInstanceGroups when done
 	struct GlmMeshInstanceGroupPerCrowdField_0
 	{
 		uint32_t _meshInstanceGroupCount; // number of shader groups used in the current frame
-		GlmMeshInstanceGroup _meshInstanceGroups[GIO_MAX_INSTANCE_MESHES]; // all meshInstanceGroups, one instance group per character file / per rigid mesh
+		GlmPooledArray<GlmMeshInstanceGroup, GIO_INSTANCE_GROUP_CHUNK_SIZE, GIO_MAX_INSTANCE_MESHES> _meshInstanceGroups; // all meshInstanceGroups, one instance group per character file / per rigid mesh
 		void* _meshInstanceGroupSet; // for internal use
 	};
 	typedef GlmMeshInstanceGroupPerCrowdField_0 GlmMeshInstanceGroupPerCrowdField;
@@ -475,7 +642,8 @@ extern "C"
 		GIO_MESH_NO_SHADER_GROUP, // failed to find a shader group for a mesh
 		GIO_MESH_NO_NORMAL, // the input mesh has no normals when generating a geometry file, must generate them
 		GIO_INVALID_CONTEXT, // context passed as a parameter is invalid, either it has not yet been created or destroyed
-		GIO_INVALID_BONE_COUNT // bone count mismatch between cache and GCHA
+		GIO_INVALID_BONE_COUNT, // bone count mismatch between cache and GCHA
+		GIO_OUT_OF_MEMORY // an allocation failed. Only returned by the inline helpers of this header, unknown to glmConvertGeometryGenerationStatus
 	} GlmGeometryGenerationStatus;
 
 	typedef enum
@@ -526,11 +694,2659 @@ extern "C"
 	extern GIO_API GlmGeometryGenerationStatus glmWriteTerrainFile(const char* filename, const uint16_t meshCount, const GlmFileMesh* fileMeshes);
 	extern GIO_API GlmGeometryGenerationStatus glmReadTerrainFile(const char* filename, uint16_t& meshCount, GlmFileMesh*& fileMeshes);
 
-	extern GIO_API GlmSimulationCacheStatus glmImportFrameCacheWithHistory(GlmGeometryGenerationContext* context, const char* filePath, const char* filePathModel, const char* cachePath, const char* layoutPath, GlmSimulationData*& simulationData, GlmFrameData*& frameCache, int currentFrame, CrowdTerrain::Mesh* terrainMeshSource, CrowdTerrain::Mesh* terrainMeshDestination, bool enableLayout);
+	extern GIO_API GlmSimulationCacheStatus glmImportFrameCacheWithHistory(GlmGeometryGenerationContext* context, const char* filePath, const char* filePathModel, const char* cachePath, const char* layoutPath, GlmSimulationData*& simulationData, GlmFrameData*& frameCache, int currentFrame, CrowdTerrain::Mesh* terrainMeshSource, CrowdTerrain::Mesh* terrainMeshDestination, bool enableLayout);
+
+#ifdef __cplusplus
+}
+#endif
+
+//----------------------------------------------------------------------------
+inline void glmInitEntityInstanceMatrices(GlmEntityInstanceMatrices& instanceMatrices)
+{
+	instanceMatrices._instanceMatrices.init();
+	instanceMatrices._instanceMatrixUsedCount = 0;
+}
+
+//----------------------------------------------------------------------------
+inline void glmReleaseEntityInstanceMatrices(GlmEntityInstanceMatrices& instanceMatrices)
+{
+	instanceMatrices._instanceMatrices.release();
+	instanceMatrices._instanceMatrixUsedCount = 0;
+}
+
+//----------------------------------------------------------------------------
+// next unused matrix, zeroed. NULL if GIO_MAX_INSTANCE_MATRIX_PER_ENTITY matrices are used or the allocation failed.
+// Reset _instanceMatrixUsedCount to reuse the matrices for the next entity, allocated chunks are kept
+inline GlmMeshInstanceMatrix* glmAddEntityInstanceMatrix(GlmEntityInstanceMatrices& instanceMatrices)
+{
+	if (!instanceMatrices._instanceMatrices.reserve(instanceMatrices._instanceMatrixUsedCount + 1u))
+		return NULL;
+	GlmMeshInstanceMatrix* matrix = &instanceMatrices._instanceMatrices[instanceMatrices._instanceMatrixUsedCount++];
+	memset(matrix, 0, sizeof(GlmMeshInstanceMatrix));
+	return matrix;
+}
+
+//----------------------------------------------------------------------------
+inline void glmInitMeshInstanceGroups(GlmMeshInstanceGroupPerCrowdField& meshInstances)
+{
+	meshInstances._meshInstanceGroupCount = 0;
+	meshInstances._meshInstanceGroups.init();
+	meshInstances._meshInstanceGroupSet = NULL;
+}
+
+//----------------------------------------------------------------------------
+// _meshInstanceGroupSet is not owned, release it first
+inline void glmReleaseMeshInstanceGroups(GlmMeshInstanceGroupPerCrowdField& meshInstances)
+{
+	meshInstances._meshInstanceGroups.release();
+	meshInstances._meshInstanceGroupCount = 0;
+}
+
+//----------------------------------------------------------------------------
+// index of a new zeroed group, -1 if GIO_MAX_INSTANCE_MESHES groups are used or the allocation failed. Not threadsafe : lock around
+// concurrent adds, groups never move so pointers on the existing ones stay valid while adding
+inline int32_t glmAddMeshInstanceGroup(GlmMeshInstanceGroupPerCrowdField& meshInstances)
+{
+	if (!meshInstances._meshInstanceGroups.reserve(meshInstances._meshInstanceGroupCount + 1))
+		return -1;
+	memset(&meshInstances._meshInstanceGroups[meshInstances._meshInstanceGroupCount], 0, sizeof(GlmMeshInstanceGroup));
+	return (int32_t)meshInstances._meshInstanceGroupCount++;
+}
+
+// mutex of the tables shared by the geometry threads, std::mutex when available
+#ifdef GIO_USE_STD_THREADS
+typedef std::mutex GlmMutex;
+typedef std::lock_guard<std::mutex> GlmLockGuard;
+#else
+class GlmMutex
+{
+public:
+#ifdef _WIN32
+	GlmMutex() { InitializeCriticalSection(&_section); }
+	~GlmMutex() { DeleteCriticalSection(&_section); }
+	void lock() { EnterCriticalSection(&_section); }
+	void unlock() { LeaveCriticalSection(&_section); }
+#else
+	GlmMutex() { pthread_mutex_init(&_mutex, NULL); }
+	~GlmMutex() { pthread_mutex_destroy(&_mutex); }
+	void lock() { pthread_mutex_lock(&_mutex); }
+	void unlock() { pthread_mutex_unlock(&_mutex); }
+#endif
+
+private:
+	GlmMutex(const GlmMutex&);
+	GlmMutex& operator = (const GlmMutex&);
+#ifdef _WIN32
+	CRITICAL_SECTION _section;
+#else
+	pthread_mutex_t _mutex;
+#endif
+};
+
+class GlmLockGuard
+{
+public:
+	explicit GlmLockGuard(GlmMutex& mutex) : _mutex(mutex) { _mutex.lock(); }
+	~GlmLockGuard() { _mutex.unlock(); }
+
+private:
+	GlmLockGuard(const GlmLockGuard&);
+	GlmLockGuard& operator = (const GlmLockGuard&);
+	GlmMutex& _mutex;
+};
+#endif
+
+// Interned strings for shader, attribute and mesh names, referenced by 32 bits GlmStringHandle in the *_1 structs.
+// Each distinct string is stored once, handles compare equal iff strings are equal.
+// intern is threadsafe, get is lock free : strings and handle slots never move once created.
+class GlmStringTable
+{
+public:
+	GlmStringTable() : _count(0), _bucketCount(0), _buckets(NULL), _pageBytes(0), _pageRemaining(0), _pageCursor(NULL)
+	{
+		_strings.init();
+	}
+
+	~GlmStringTable()
+	{
+		for (size_t iPage = 0; iPage < _pages.size(); iPage++)
+			GLMC_FREE(_pages[iPage]);
+		GLMC_FREE(_buckets);
+		_strings.release();
+	}
+
+	// returns the handle of string, interning it on first use. GIO_INVALID_STRING_HANDLE if string is NULL or the table is full
+	GlmStringHandle intern(const char* string)
+	{
+		if (string == NULL)
+			return GIO_INVALID_STRING_HANDLE;
+		size_t length = strlen(string);
+		uint32_t hash = hashString(string, length);
+
+		GlmLockGuard lock(_lock);
+		GlmStringHandle handle = lookup(string, hash);
+		if (handle != GIO_INVALID_STRING_HANDLE)
+			return handle;
+
+		// keep load factor under 1/2
+		if ((_count + 1) * 2 > _bucketCount && !rehash(_bucketCount ? _bucketCount * 2 : 1024))
+			return GIO_INVALID_STRING_HANDLE;
+		if (!_strings.reserve(_count + 1))
+			return GIO_INVALID_STRING_HANDLE;
+		char* copy = allocateString(length + 1);
+		if (copy == NULL)
+			return GIO_INVALID_STRING_HANDLE;
+		memcpy(copy, string, length + 1);
+
+		handle = _count;
+		_strings[handle] = copy;
+		uint32_t iBucket = hash & (_bucketCount - 1);
+		while (_buckets[iBucket] != GIO_INVALID_STRING_HANDLE)
+			iBucket = (iBucket + 1) & (_bucketCount - 1);
+		_buckets[iBucket] = handle;
+		_count++;
+		return handle;
+	}
+
+	// returns the handle of string if already interned, GIO_INVALID_STRING_HANDLE otherwise
+	GlmStringHandle find(const char* string)
+	{
+		if (string == NULL)
+			return GIO_INVALID_STRING_HANDLE;
+		uint32_t hash = hashString(string, strlen(string));
+		GlmLockGuard lock(_lock);
+		return lookup(string, hash);
+	}
+
+	// handle must come from this table, returns "" for GIO_INVALID_STRING_HANDLE
+	const char* get(GlmStringHandle handle) const
+	{
+		if (handle == GIO_INVALID_STRING_HANDLE)
+			return "";
+		return _strings[handle];
+	}
+
+	uint32_t size() const { return _count; }
+	size_t allocatedBytes() const { return sizeof(*this) + _strings.allocatedBytes() + _bucketCount * sizeof(GlmStringHandle) + _pages.capacity() * sizeof(char*) + _pageBytes; }
+
+private:
+	GlmStringTable(const GlmStringTable&);
+	GlmStringTable& operator = (const GlmStringTable&);
+
+	enum { PAGE_SIZE = 64 * 1024 };
+
+	static uint32_t hashString(const char* string, size_t length)
+	{
+		// FNV-1a
+		uint32_t hash = 2166136261u;
+		for (size_t iChar = 0; iChar < length; iChar++)
+		{
+			hash ^= (uint8_t)string[iChar];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	GlmStringHandle lookup(const char* string, uint32_t hash) const
+	{
+		if (_bucketCount == 0)
+			return GIO_INVALID_STRING_HANDLE;
+		uint32_t iBucket = hash & (_bucketCount - 1);
+		while (_buckets[iBucket] != GIO_INVALID_STRING_HANDLE)
+		{
+			if (strcmp(_strings[_buckets[iBucket]], string) == 0)
+				return _buckets[iBucket];
+			iBucket = (iBucket + 1) & (_bucketCount - 1);
+		}
+		return GIO_INVALID_STRING_HANDLE;
+	}
+
+	int rehash(uint32_t bucketCount)
+	{
+		GlmStringHandle* buckets = (GlmStringHandle*)GLMC_MALLOC(bucketCount * sizeof(GlmStringHandle));
+		if (buckets == NULL)
+			return 0;
+		memset(buckets, 0xFF, bucketCount * sizeof(GlmStringHandle));
+		for (uint32_t iHandle = 0; iHandle < _count; iHandle++)
+		{
+			const char* string = _strings[iHandle];
+			uint32_t iBucket = hashString(string, strlen(string)) & (bucketCount - 1);
+			while (buckets[iBucket] != GIO_INVALID_STRING_HANDLE)
+				iBucket = (iBucket + 1) & (bucketCount - 1);
+			buckets[iBucket] = iHandle;
+		}
+		GLMC_FREE(_buckets);
+		_buckets = buckets;
+		_bucketCount = bucketCount;
+		return 1;
+	}
+
+	// strings are packed in pages, long strings get their own page
+	char* allocateString(size_t size)
+	{
+		if (size > _pageRemaining)
+		{
+			size_t pageSize = size > (size_t)PAGE_SIZE ? size : (size_t)PAGE_SIZE;
+			char* page = (char*)GLMC_MALLOC(pageSize);
+			if (page == NULL)
+				return NULL;
+			_pages.push_back(page);
+			_pageBytes += pageSize;
+			if (pageSize != (size_t)PAGE_SIZE)
+				return page;
+			_pageCursor = page;
+			_pageRemaining = PAGE_SIZE;
+		}
+		char* string = _pageCursor;
+		_pageCursor += size;
+		_pageRemaining -= size;
+		return string;
+	}
+
+	GlmMutex _lock;
+	uint32_t _count;
+	uint32_t _bucketCount; // power of 2
+	GlmStringHandle* _buckets; // open addressing, GIO_INVALID_STRING_HANDLE for empty buckets
+	GlmPooledArray<const char*, 4096, GIO_MAX_INTERNED_STRINGS> _strings;
+	std::vector<char*> _pages;
+	size_t _pageBytes; // sum of the page sizes, long strings pages included
+	size_t _pageRemaining;
+	char* _pageCursor;
+};
+
+//----------------------------------------------------------------------------
+// interns string in handle, returns 0 if the table failed to intern it. A NULL string is the only one left GIO_INVALID_STRING_HANDLE
+inline int glmInternString(GlmStringTable& table, const char* string, GlmStringHandle& handle)
+{
+	handle = table.intern(string);
+	return handle != GIO_INVALID_STRING_HANDLE || string == NULL;
+}
+
+//----------------------------------------------------------------------------
+inline void glmDestroyInternedShaderGroup(GlmShaderGroup_1& shaderGroup)
+{
+	GLMC_FREE(shaderGroup._intShaderAttributeNames);
+	GLMC_FREE(shaderGroup._intShaderAttributeIndexes);
+	GLMC_FREE(shaderGroup._floatShaderAttributeNames);
+	GLMC_FREE(shaderGroup._floatShaderAttributeIndexes);
+	GLMC_FREE(shaderGroup._fileShaderAttributeNames);
+	GLMC_FREE(shaderGroup._fileShaderAttributeIndexes);
+	GLMC_FREE(shaderGroup._vectorShaderAttributeNames);
+	GLMC_FREE(shaderGroup._vectorShaderAttributeIndexes);
+	GLMC_FREE(shaderGroup._shaders);
+	memset(&shaderGroup, 0, sizeof(GlmShaderGroup_1));
+}
+
+//----------------------------------------------------------------------------
+// shaderGroupOut arrays are allocated, release them with glmDestroyInternedShaderGroup. On failure nothing stays allocated
+inline int glmInternShaderGroup(GlmStringTable& table, const GlmShaderGroup& shaderGroup, GlmShaderGroup_1& shaderGroupOut)
+{
+	memset(&shaderGroupOut, 0, sizeof(GlmShaderGroup_1));
+	if (!glmInternString(table, shaderGroup._name, shaderGroupOut._name))
+		return 0;
+
+	uint16_t counts[4] = { shaderGroup._intShaderAttributeCount, shaderGroup._floatShaderAttributeCount, shaderGroup._fileShaderAttributeCount, shaderGroup._vectorShaderAttributeCount };
+	char(*names[4])[GIO_NAME_LENGTH] = { shaderGroup._intShaderAttributeNames, shaderGroup._floatShaderAttributeNames, shaderGroup._fileShaderAttributeNames, shaderGroup._vectorShaderAttributeNames };
+	uint16_t* indexes[4] = { shaderGroup._intShaderAttributeIndexes, shaderGroup._floatShaderAttributeIndexes, shaderGroup._fileShaderAttributeIndexes, shaderGroup._vectorShaderAttributeIndexes };
+	GlmStringHandle** namesOut[4] = { &shaderGroupOut._intShaderAttributeNames, &shaderGroupOut._floatShaderAttributeNames, &shaderGroupOut._fileShaderAttributeNames, &shaderGroupOut._vectorShaderAttributeNames };
+	uint16_t** indexesOut[4] = { &shaderGroupOut._intShaderAttributeIndexes, &shaderGroupOut._floatShaderAttributeIndexes, &shaderGroupOut._fileShaderAttributeIndexes, &shaderGroupOut._vectorShaderAttributeIndexes };
+	for (int iType = 0; iType < 4; iType++)
+	{
+		if (counts[iType] == 0)
+			continue;
+		*namesOut[iType] = (GlmStringHandle*)GLMC_MALLOC(counts[iType] * sizeof(GlmStringHandle));
+		*indexesOut[iType] = (uint16_t*)GLMC_MALLOC(counts[iType] * sizeof(uint16_t));
+		if (*namesOut[iType] == NULL || *indexesOut[iType] == NULL)
+		{
+			glmDestroyInternedShaderGroup(shaderGroupOut);
+			return 0;
+		}
+		for (uint16_t iAttribute = 0; iAttribute < counts[iType]; iAttribute++)
+		{
+			if (!glmInternString(table, names[iType][iAttribute], (*namesOut[iType])[iAttribute]))
+			{
+				glmDestroyInternedShaderGroup(shaderGroupOut);
+				return 0;
+			}
+		}
+		memcpy(*indexesOut[iType], indexes[iType], counts[iType] * sizeof(uint16_t));
+	}
+	shaderGroupOut._intShaderAttributeCount = counts[0];
+	shaderGroupOut._floatShaderAttributeCount = counts[1];
+	shaderGroupOut._fileShaderAttributeCount = counts[2];
+	shaderGroupOut._vectorShaderAttributeCount = counts[3];
+
+	if (shaderGroup._shaderCount)
+	{
+		shaderGroupOut._shaders = (GlmShader_1*)GLMC_MALLOC(shaderGroup._shaderCount * sizeof(GlmShader_1));
+		if (shaderGroupOut._shaders == NULL)
+		{
+			glmDestroyInternedShaderGroup(shaderGroupOut);
+			return 0;
+		}
+		for (uint16_t iShader = 0; iShader < shaderGroup._shaderCount; iShader++)
+		{
+			if (!glmInternString(table, shaderGroup._shaders[iShader]._name, shaderGroupOut._shaders[iShader]._name)
+				|| !glmInternString(table, shaderGroup._shaders[iShader]._category, shaderGroupOut._shaders[iShader]._category))
+			{
+				glmDestroyInternedShaderGroup(shaderGroupOut);
+				return 0;
+			}
+		}
+	}
+	shaderGroupOut._shaderCount = shaderGroup._shaderCount;
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+inline void glmDestroyInternedEntityGeometry(GlmEntityGeometry_1& geometry)
+{
+	GLMC_FREE(geometry._meshes);
+	GLMC_FREE(geometry._fileShaderAttributeValues);
+	memset(&geometry, 0, sizeof(GlmEntityGeometry_1));
+}
+
+//----------------------------------------------------------------------------
+// interns the mesh names and file attribute values of geometry in geometryOut. The vertex/polygon/attribute arrays are not copied.
+// fileShaderAttributeCount is GlmShaderGroup::_fileShaderAttributeCount of the entity shader group. Returns 0 if an array or a name
+// failed to be allocated, nothing stays allocated then
+inline int glmInternEntityNames(GlmStringTable& table, const GlmEntityGeometry& geometry, uint16_t fileShaderAttributeCount, GlmEntityGeometry_1& geometryOut)
+{
+	memset(&geometryOut, 0, sizeof(GlmEntityGeometry_1));
+	if (fileShaderAttributeCount)
+	{
+		geometryOut._fileShaderAttributeValues = (GlmStringHandle*)GLMC_MALLOC(fileShaderAttributeCount * sizeof(GlmStringHandle));
+		if (geometryOut._fileShaderAttributeValues == NULL)
+			return 0;
+		for (uint16_t iAttribute = 0; iAttribute < fileShaderAttributeCount; iAttribute++)
+		{
+			if (!glmInternString(table, geometry._fileShaderAttributeValues[iAttribute], geometryOut._fileShaderAttributeValues[iAttribute]))
+			{
+				glmDestroyInternedEntityGeometry(geometryOut);
+				return 0;
+			}
+		}
+	}
+
+	if (geometry._meshCount)
+	{
+		geometryOut._meshes = (GlmMesh_1*)GLMC_MALLOC(geometry._meshCount * sizeof(GlmMesh_1));
+		if (geometryOut._meshes == NULL)
+		{
+			glmDestroyInternedEntityGeometry(geometryOut);
+			return 0;
+		}
+		memset(geometryOut._meshes, 0, geometry._meshCount * sizeof(GlmMesh_1));
+		for (uint16_t iMesh = 0; iMesh < geometry._meshCount; iMesh++)
+		{
+			if (!glmInternString(table, geometry._meshes[iMesh]._name, geometryOut._meshes[iMesh]._name))
+			{
+				glmDestroyInternedEntityGeometry(geometryOut);
+				return 0;
+			}
+			geometryOut._meshes[iMesh]._shaderGroupIdx = geometry._meshes[iMesh]._shaderGroupIdx;
+		}
+	}
+	geometryOut._meshCount = geometry._meshCount;
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// points the meshes of geometryOut, named by glmInternEntityNames, at the arrays of geometry. Returns 0 if the mesh counts differ
+inline int glmLinkInternedEntityGeometry(const GlmEntityGeometry& geometry, GlmEntityGeometry_1& geometryOut)
+{
+	if (geometry._meshCount != geometryOut._meshCount)
+		return 0;
+	geometryOut._intShaderAttributeValues = geometry._intShaderAttributeValues;
+	geometryOut._floatShaderAttributeValues = geometry._floatShaderAttributeValues;
+	geometryOut._vectorShaderAttributeValues = geometry._vectorShaderAttributeValues;
+	for (uint16_t iMesh = 0; iMesh < geometry._meshCount; iMesh++)
+	{
+		const GlmMesh& mesh = geometry._meshes[iMesh];
+		GlmMesh_1& meshOut = geometryOut._meshes[iMesh];
+		meshOut._instanceGroup = mesh._instanceGroup;
+		meshOut._instanceIndex = mesh._instanceIndex;
+		meshOut._instanceFirstMatrixIndex = mesh._instanceFirstMatrixIndex;
+		meshOut._verticeCount = mesh._verticeCount;
+		meshOut._vertices = mesh._vertices;
+		meshOut._polygonCount = mesh._polygonCount;
+		meshOut._verticePerPolygonCount = mesh._verticePerPolygonCount;
+		meshOut._vertexIndicesPerPolygon = mesh._vertexIndicesPerPolygon;
+		meshOut._hasNormals = mesh._hasNormals;
+		meshOut._normals = mesh._normals;
+		meshOut._hasTangents = mesh._hasTangents;
+		meshOut._tangentsByControlPoint = mesh._tangentsByControlPoint;
+		meshOut._tangents = mesh._tangents;
+		meshOut._hasUVs = mesh._hasUVs;
+		meshOut._uvsByControlPoint = mesh._uvsByControlPoint;
+		meshOut._Us = mesh._Us;
+		meshOut._Vs = mesh._Vs;
+		meshOut._objectId = mesh._objectId;
+	}
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// geometryOut shares the vertex/polygon/attribute arrays of geometry, which keeps ownership : only _meshes and _fileShaderAttributeValues are allocated,
+// release them with glmDestroyInternedEntityGeometry. fileShaderAttributeCount is GlmShaderGroup::_fileShaderAttributeCount of the entity shader group.
+// geometry still holds its char[GIO_NAME_LENGTH] arrays, use glmCreateInternedEntityGeometry to not keep them alongside the interned names
+inline int glmInternEntityGeometry(GlmStringTable& table, const GlmEntityGeometry& geometry, uint16_t fileShaderAttributeCount, GlmEntityGeometry_1& geometryOut)
+{
+	if (!glmInternEntityNames(table, geometry, fileShaderAttributeCount, geometryOut))
+		return 0;
+	glmLinkInternedEntityGeometry(geometry, geometryOut);
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// creates the geometry of an entity with interned names. The names are created first (GLM_CREATE_NAMES_AND_SHADERS), interned and released
+// before the geometry is created (GLM_CREATE_GEOMETRY), so the file attribute values are never held as char[GIO_NAME_LENGTH] arrays next to the vertices.
+// geometry owns the arrays shared by geometryOut : release geometryOut with glmDestroyInternedEntityGeometry, then geometry with glmDestroyEntityGeometry.
+// On failure neither is allocated
+inline GlmGeometryGenerationStatus glmCreateInternedEntityGeometry(GlmStringTable& table, GlmEntityGeometry* geometry, GlmGeometryGenerationContext* context, const GlmEntityBoundingBox* bbox, GlmEntityInstanceMatrices& instanceMatrices, GlmEntityGeometry_1& geometryOut)
+{
+	memset(&geometryOut, 0, sizeof(GlmEntityGeometry_1));
+	GlmEntityGeometry names;
+	memset(&names, 0, sizeof(GlmEntityGeometry));
+	GlmGeometryGenerationStatus status = glmCreateEntityGeometry(&names, context, bbox, instanceMatrices, GLM_CREATE_NAMES_AND_SHADERS);
+	if (status != GIO_SUCCESS)
+		return status;
+	uint16_t fileShaderAttributeCount = 0;
+	if (names._meshCount && names._meshes[0]._shaderGroupIdx < context->_shaderGroupCount)
+		fileShaderAttributeCount = context->_shaderGroups[names._meshes[0]._shaderGroupIdx]._fileShaderAttributeCount;
+	int interned = glmInternEntityNames(table, names, fileShaderAttributeCount, geometryOut);
+	glmDestroyEntityGeometry(&names, context, bbox);
+	if (!interned)
+		return GIO_OUT_OF_MEMORY;
+
+	memset(geometry, 0, sizeof(GlmEntityGeometry));
+	status = glmCreateEntityGeometry(geometry, context, bbox, instanceMatrices, GLM_CREATE_GEOMETRY);
+	if (status == GIO_SUCCESS && !glmLinkInternedEntityGeometry(*geometry, geometryOut))
+	{
+		glmDestroyEntityGeometry(geometry, context, bbox);
+		status = GIO_GCG_FILE_MESH_NOT_FOUND;
+	}
+	if (status != GIO_SUCCESS)
+		glmDestroyInternedEntityGeometry(geometryOut);
+	return status;
+}
+
+// compatibility accessors, for code still working with char* names
+inline const char* glmGetShaderName(const GlmStringTable& table, const GlmShader_1& shader) { return table.get(shader._name); }
+inline const char* glmGetShaderCategory(const GlmStringTable& table, const GlmShader_1& shader) { return table.get(shader._category); }
+inline const char* glmGetShaderGroupName(const GlmStringTable& table, const GlmShaderGroup_1& shaderGroup) { return table.get(shaderGroup._name); }
+inline const char* glmGetMeshName(const GlmStringTable& table, const GlmMesh_1& mesh) { return table.get(mesh._name); }
+inline const char* glmGetFileShaderAttributeValue(const GlmStringTable& table, const GlmEntityGeometry_1& geometry, uint16_t index) { return table.get(geometry._fileShaderAttributeValues[index]); }
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Multithreaded frame interpolation
+//
+// Same result as glmInterpolateFrameData in GSC_INTERPOLATION_STRICT mode. Bones of all entity types are split in blocks of
+// GIO_INTERPOLATION_BONES_PER_TASK bones in GlmFrameData bone order, run through the glmParallelFor hook of glm_crowd.h when it is set,
+// the other frame attributes are one more item of the same parallel for.
+
+struct GlmInterpolationTask
+{
+	const GlmSimulationData* _simulationData;
+	const GlmFrameData* _frameData1;
+	const GlmFrameData* _frameData2;
+	float _ratio;
+	GlmFrameData* _result;
+	GlmInterpolationMode _mode;
+	uint32_t _boneValueCount;
+	unsigned int _blockCount; // item _blockCount interpolates the attributes
+};
+
+//----------------------------------------------------------------------------
+// interpolates the bone blocks [first, last) of GIO_INTERPOLATION_BONES_PER_TASK bones, and the attributes when the range holds _blockCount
+inline void glmInterpolateFrameDataBlocks(void* userData, unsigned int first, unsigned int last)
+{
+	const GlmInterpolationTask* task = (const GlmInterpolationTask*)userData;
+	uint32_t firstBone = first * GIO_INTERPOLATION_BONES_PER_TASK;
+	uint32_t lastBone = (last < task->_blockCount ? last : task->_blockCount) * GIO_INTERPOLATION_BONES_PER_TASK;
+	if (lastBone > task->_boneValueCount)
+		lastBone = task->_boneValueCount;
+	if (firstBone < lastBone)
+		glmInterpolateFrameDataBones(task->_frameData1, task->_frameData2, task->_ratio, task->_result, firstBone, lastBone, task->_mode);
+	if (last > task->_blockCount)
+		glmInterpolateFrameDataAttributes(task->_simulationData, task->_frameData1, task->_frameData2, task->_ratio, task->_result);
+}
+
+//----------------------------------------------------------------------------
+inline void glmInterpolateFrameDataParallel(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* result, GlmInterpolationMode mode)
+{
+	GlmInterpolationTask task;
+	uint32_t boneValueCount = 0;
+	uint16_t iEntityType;
+
+	if (!frameData2)
+		frameData2 = frameData1;
+	if (!frameData1)
+		frameData1 = frameData2;
+	if (!frameData1)
+		return;
+	if (frameData1->_simulationContentHashKey != simulationData->_contentHashKey || frameData1->_simulationContentHashKey != frameData2->_simulationContentHashKey)
+		return; // forbidden, different simu
+
+	for (iEntityType = 0; iEntityType < simulationData->_entityTypeCount; iEntityType++)
+		boneValueCount += simulationData->_entityCountPerEntityType[iEntityType] * simulationData->_boneCount[iEntityType];
+
+	task._simulationData = simulationData;
+	task._frameData1 = frameData1;
+	task._frameData2 = frameData2;
+	task._ratio = ratio;
+	task._result = result;
+	task._mode = mode;
+	task._boneValueCount = boneValueCount;
+	task._blockCount = (unsigned int)((boneValueCount + GIO_INTERPOLATION_BONES_PER_TASK - 1) / GIO_INTERPOLATION_BONES_PER_TASK);
+	if (glmParallelFor && task._blockCount > 1)
+		glmParallelFor(glmInterpolateFrameDataBlocks, &task, task._blockCount + 1);
+	else
+		glmInterpolateFrameDataBlocks(&task, 0, task._blockCount + 1);
+}
+
+#ifdef GIO_USE_STD_THREADS
+//----------------------------------------------------------------------------
+// Persistent workers behind glmParallelForThreads : they are started once and wait for the next parallel for instead of being created per call.
+// The calling thread works too, items are handed out in chunks through an atomic counter. One parallel for runs at a time : a call made while
+// the pool is busy (another thread, or a task calling glmParallelFor) runs on the calling thread
+class GlmThreadPool
+{
+public:
+	explicit GlmThreadPool(unsigned int workerCount) : _task(NULL), _userData(NULL), _count(0), _chunkSize(1), _next(0), _generation(0), _busyWorkerCount(0), _stop(false)
+	{
+		for (unsigned int iWorker = 0; iWorker < workerCount; iWorker++)
+			_workers.push_back(std::thread(&GlmThreadPool::workerLoop, this));
+	}
+
+	~GlmThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_stop = true;
+		}
+		_wake.notify_all();
+		for (size_t iWorker = 0; iWorker < _workers.size(); iWorker++)
+			_workers[iWorker].join();
+	}
+
+	unsigned int workerCount() const { return (unsigned int)_workers.size(); }
+
+	void run(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+	{
+		if (_workers.empty() || count <= 1 || isPoolThread() || !_runLock.try_lock())
+		{
+			task(userData, 0, count);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_task = task;
+			_userData = userData;
+			_count = count;
+			// ~4 chunks per thread, items can be of very different sizes (cloth vertex counts)
+			_chunkSize = count / ((unsigned int)_workers.size() + 1) / 4;
+			if (_chunkSize == 0)
+				_chunkSize = 1;
+			_next.store(0);
+			_busyWorkerCount = (unsigned int)_workers.size();
+			_generation++;
+		}
+		_wake.notify_all();
+
+		isPoolThread() = true;
+		work();
+		isPoolThread() = false;
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			while (_busyWorkerCount)
+				_done.wait(lock);
+		}
+		_runLock.unlock();
+	}
+
+private:
+	GlmThreadPool(const GlmThreadPool&);
+	GlmThreadPool& operator = (const GlmThreadPool&);
+
+	// set on the workers and on the caller while it runs a parallel for
+	static bool& isPoolThread()
+	{
+		static thread_local bool poolThread = false;
+		return poolThread;
+	}
+
+	void work()
+	{
+		for (;;)
+		{
+			unsigned int first = _next.fetch_add(_chunkSize);
+			if (first >= _count)
+				return;
+			_task(_userData, first, (_count - first > _chunkSize) ? first + _chunkSize : _count);
+		}
+	}
+
+	void workerLoop()
+	{
+		uint64_t generation = 0;
+		isPoolThread() = true;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+				while (!_stop && _generation == generation)
+					_wake.wait(lock);
+				if (_stop)
+					return;
+				generation = _generation;
+			}
+			work();
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+				if (--_busyWorkerCount == 0)
+					_done.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> _workers;
+	std::mutex _runLock; // held by the thread running a parallel for
+	std::mutex _lock; // protects the members below but _next
+	std::condition_variable _wake;
+	std::condition_variable _done;
+	void(*_task)(void* userData, unsigned int first, unsigned int last);
+	void* _userData;
+	unsigned int _count;
+	unsigned int _chunkSize;
+	std::atomic<unsigned int> _next; // first item of the next chunk
+	uint64_t _generation; // incremented per parallel for, wakes the workers
+	unsigned int _busyWorkerCount; // workers which have not finished the current parallel for
+	bool _stop;
+};
+
+//----------------------------------------------------------------------------
+// pool of glmParallelForThreads, created on first use
+inline GlmThreadPool*& glmParallelForPool()
+{
+	static GlmThreadPool* pool = NULL;
+	return pool;
+}
+
+inline std::mutex& glmParallelForPoolLock()
+{
+	static std::mutex lock;
+	return lock;
+}
+
+//----------------------------------------------------------------------------
+// std::thread implementation of the glmParallelFor hook of glm_crowd.h, the host parallel loop of the whole library (cloth decoding and transform, frame
+// interpolation, skinning and skinned entity generation blocks), assign it once at startup: glmParallelFor = glmParallelForThreads.
+// Runs on a GlmThreadPool of hardware_concurrency - 1 workers and the calling thread
+inline void glmParallelForThreads(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	GlmThreadPool* pool;
+	{
+		std::lock_guard<std::mutex> lock(glmParallelForPoolLock());
+		if (glmParallelForPool() == NULL)
+		{
+			unsigned int threadCount = std::thread::hardware_concurrency();
+			glmParallelForPool() = new GlmThreadPool(threadCount > 1 ? threadCount - 1 : 0);
+		}
+		pool = glmParallelForPool();
+	}
+	pool->run(task, userData, count);
+}
+
+//----------------------------------------------------------------------------
+// joins the glmParallelForThreads workers, call it at shutdown once no parallel for runs anymore (DLL unload must not join threads)
+inline void glmStopParallelForThreads()
+{
+	std::lock_guard<std::mutex> lock(glmParallelForPoolLock());
+	delete glmParallelForPool();
+	glmParallelForPool() = NULL;
+}
+#else
+//----------------------------------------------------------------------------
+// no std threads : glmParallelForThreads runs all the items on the calling thread
+inline void glmParallelForThreads(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	task(userData, 0, count);
+}
+
+inline void glmStopParallelForThreads()
+{
+}
+#endif // GIO_USE_STD_THREADS
+
+//----------------------------------------------------------------------------
+// motion blur sample times of the context for glmCreateFrameSamples : _motionBlurSamples times evenly spread over the window,
+// or _frame only if motion blur is disabled. sampleTimes array size >= max(1, _motionBlurSamples), returns the number of samples
+inline uint32_t glmComputeMotionBlurSampleTimes(const GlmGeometryGenerationContext* context, float* sampleTimes)
+{
+	uint32_t iSample;
+	if (!context->_motionBlurEnabled || context->_motionBlurSamples < 2)
+	{
+		sampleTimes[0] = context->_frame;
+		return 1;
+	}
+	for (iSample = 0; iSample < context->_motionBlurSamples; iSample++)
+		sampleTimes[iSample] = context->_motionBlurStartFrame + context->_motionBlurWindowSize * (float)iSample / (float)(context->_motionBlurSamples - 1);
+	return context->_motionBlurSamples;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Skinning of GlmGeometryFile meshes
+//
+// glmCreateSkinnedMesh packs the influences of a GlmFileMesh once (CSR layout, no per vertex pointers),
+// glmComputeSkinningPalette builds the per bone matrices / dual quaternions of a posture,
+// glmSkinMesh skins all vertices, split in blocks run through the glmParallelFor hook of glm_crowd.h when it is set.
+// glmSkinVertices skins a vertex range (the mesh and palette are read only), glmSkinVerticesReference is the scalar reference implementation.
+//
+
+#define GIO_SKINNING_VERTICES_PER_TASK 4096
+
+// influences of vertex i are [_influenceOffsets[i], _influenceOffsets[i + 1])
+struct GlmSkinnedMesh_0
+{
+	uint8_t _skinningType; // GlmSkinningType
+	uint16_t _boneCount; // bone count of the geometry file, all influences are below
+	uint32_t _vertexCount;
+	float(*_positions)[4]; // bind pose positions, w = 1, array size = _vertexCount
+	float(*_normals)[4]; // bind pose normals, w = 0, array size = _vertexCount
+	uint32_t* _influenceOffsets; // array size = _vertexCount + 1
+	uint16_t* _influenceBoneIds; // array size = _influenceOffsets[_vertexCount]
+	float* _influenceWeights; // array size = _influenceOffsets[_vertexCount]
+	float* _blendWeights; // 0.f linear, 1.f dual quaternion, array size = _vertexCount
+	uint8_t _mapped; // arrays point in a mapped flat gcg (glmCreateSkinnedMeshFromFlat), not freed by glmDestroySkinnedMesh
+};
+typedef GlmSkinnedMesh_0 GlmSkinnedMesh;
+
+// per bone skinning transforms : bind pose offset then bone world transform
+struct GlmSkinningPalette_0
+{
+	uint16_t _boneCount;
+	float(*_matrices)[16]; // row vector convention, as glmConvertMatrix, array size = _boneCount
+	float(*_dualQuaternions)[8]; // real part xyzw, dual part xyzw, array size = _boneCount
+};
+typedef GlmSkinningPalette_0 GlmSkinningPalette;
+
+//----------------------------------------------------------------------------
+inline void glmDestroySkinnedMesh(GlmSkinnedMesh* mesh)
+{
+	if (mesh->_mapped)
+	{
+		memset(mesh, 0, sizeof(GlmSkinnedMesh));
+		return;
+	}
+	GLMC_FREE(mesh->_positions);
+	GLMC_FREE(mesh->_normals);
+	GLMC_FREE(mesh->_influenceOffsets);
+	GLMC_FREE(mesh->_influenceBoneIds);
+	GLMC_FREE(mesh->_influenceWeights);
+	GLMC_FREE(mesh->_blendWeights);
+	memset(mesh, 0, sizeof(GlmSkinnedMesh));
+}
+
+//----------------------------------------------------------------------------
+// allocates the arrays of an empty mesh, return GIO_SUCCESS || GIO_GCG_FILE_BAD_FORMAT (too many influences for 32 bits offsets) || GIO_OUT_OF_MEMORY
+inline GlmGeometryGenerationStatus glmAllocateSkinnedMesh(GlmSkinnedMesh* mesh, uint8_t skinningType, uint16_t boneCount, uint32_t vertexCount, uint64_t influenceCount)
+{
+	memset(mesh, 0, sizeof(GlmSkinnedMesh));
+	if (influenceCount >= UINT32_MAX || vertexCount == UINT32_MAX)
+		return GIO_GCG_FILE_BAD_FORMAT;
+
+	mesh->_skinningType = skinningType;
+	mesh->_boneCount = boneCount;
+	mesh->_vertexCount = vertexCount;
+	mesh->_positions = (float(*)[4])GLMC_MALLOC(sizeof(float[4]) * ((size_t)vertexCount + 1));
+	mesh->_normals = (float(*)[4])GLMC_MALLOC(sizeof(float[4]) * ((size_t)vertexCount + 1));
+	mesh->_influenceOffsets = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * ((size_t)vertexCount + 1));
+	mesh->_influenceBoneIds = (uint16_t*)GLMC_MALLOC(sizeof(uint16_t) * ((size_t)influenceCount + 1));
+	mesh->_influenceWeights = (float*)GLMC_MALLOC(sizeof(float) * ((size_t)influenceCount + 1));
+	mesh->_blendWeights = (float*)GLMC_MALLOC(sizeof(float) * ((size_t)vertexCount + 1));
+	if (!mesh->_positions || !mesh->_normals || !mesh->_influenceOffsets || !mesh->_influenceBoneIds || !mesh->_influenceWeights || !mesh->_blendWeights)
+	{
+		glmDestroySkinnedMesh(mesh);
+		return GIO_OUT_OF_MEMORY;
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// boneCount = GlmGeometryFile::_boneCount of the file holding fileMesh
+// return GIO_SUCCESS || GIO_GCG_FILE_BAD_FORMAT (unknown skinning type, missing arrays, bone ids >= boneCount) || GIO_OUT_OF_MEMORY
+inline GlmGeometryGenerationStatus glmCreateSkinnedMesh(GlmSkinnedMesh* mesh, const GlmFileMesh* fileMesh, uint16_t boneCount)
+{
+	uint32_t iVertex;
+	uint64_t influenceCount = 0;
+	GlmGeometryGenerationStatus status;
+
+	memset(mesh, 0, sizeof(GlmSkinnedMesh));
+	if (fileMesh->_skinningType > GLM_SKIN_BLEND || (fileMesh->_vertexCount && !fileMesh->_vertices))
+		return GIO_GCG_FILE_BAD_FORMAT;
+	if (fileMesh->_skinningType == GLM_SKIN_RIGID && fileMesh->_rigidSkinningBoneId >= boneCount)
+		return GIO_GCG_FILE_BAD_FORMAT;
+
+	for (iVertex = 0; iVertex < fileMesh->_vertexCount; iVertex++)
+	{
+		const GlmFileMeshVertex& vertex = fileMesh->_vertices[iVertex];
+		uint8_t iInfluence;
+		if (fileMesh->_skinningType == GLM_SKIN_RIGID)
+		{
+			influenceCount++;
+			continue;
+		}
+		if (vertex._skinVertexInfluenceCount && (!vertex._skinInfluenceBoneId || !vertex._skinInfluenceWeights))
+			return GIO_GCG_FILE_BAD_FORMAT;
+		for (iInfluence = 0; iInfluence < vertex._skinVertexInfluenceCount; iInfluence++)
+			if (vertex._skinInfluenceBoneId[iInfluence] >= boneCount)
+				return GIO_GCG_FILE_BAD_FORMAT;
+		influenceCount += vertex._skinVertexInfluenceCount;
+	}
+	status = glmAllocateSkinnedMesh(mesh, fileMesh->_skinningType, boneCount, fileMesh->_vertexCount, influenceCount);
+	if (status != GIO_SUCCESS)
+		return status;
+
+	influenceCount = 0;
+	for (iVertex = 0; iVertex < fileMesh->_vertexCount; iVertex++)
+	{
+		const GlmFileMeshVertex& vertex = fileMesh->_vertices[iVertex];
+		mesh->_positions[iVertex][0] = vertex._position[0];
+		mesh->_positions[iVertex][1] = vertex._position[1];
+		mesh->_positions[iVertex][2] = vertex._position[2];
+		mesh->_positions[iVertex][3] = 1.f;
+		mesh->_normals[iVertex][0] = vertex._normal[0];
+		mesh->_normals[iVertex][1] = vertex._normal[1];
+		mesh->_normals[iVertex][2] = vertex._normal[2];
+		mesh->_normals[iVertex][3] = 0.f;
+		mesh->_influenceOffsets[iVertex] = (uint32_t)influenceCount;
+
+		if (fileMesh->_skinningType == GLM_SKIN_RIGID)
+		{
+			mesh->_influenceBoneIds[influenceCount] = fileMesh->_rigidSkinningBoneId;
+			mesh->_influenceWeights[influenceCount] = 1.f;
+			mesh->_blendWeights[iVertex] = 0.f;
+			influenceCount++;
+		}
+		else
+		{
+			uint8_t iInfluence;
+			for (iInfluence = 0; iInfluence < vertex._skinVertexInfluenceCount; iInfluence++)
+			{
+				mesh->_influenceBoneIds[influenceCount] = vertex._skinInfluenceBoneId[iInfluence];
+				mesh->_influenceWeights[influenceCount] = vertex._skinInfluenceWeights[iInfluence];
+				influenceCount++;
+			}
+			mesh->_blendWeights[iVertex] = (fileMesh->_skinningType == GLM_SKIN_LINEAR) ? 0.f : (fileMesh->_skinningType == GLM_SKIN_DUALQ) ? 1.f : vertex._skinInfluenceBlendWeight;
+		}
+	}
+	mesh->_influenceOffsets[mesh->_vertexCount] = (uint32_t)influenceCount;
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+inline void glmDestroySkinningPalette(GlmSkinningPalette* palette)
+{
+	GLMC_FREE(palette->_matrices);
+	GLMC_FREE(palette->_dualQuaternions);
+	memset(palette, 0, sizeof(GlmSkinningPalette));
+}
+
+//----------------------------------------------------------------------------
+// palette must be zeroed before its first use. return GIO_SUCCESS || GIO_GCG_FILE_BAD_FORMAT (missing bind pose arrays) || GIO_OUT_OF_MEMORY
+inline GlmGeometryGenerationStatus glmReserveSkinningPalette(GlmSkinningPalette* palette, const GlmGeometryFile* geometry)
+{
+	if (geometry->_boneCount && (!geometry->_boneOffsetPositions || !geometry->_boneOffsetOrientations))
+		return GIO_GCG_FILE_BAD_FORMAT;
+	if (palette->_boneCount != geometry->_boneCount || !palette->_matrices)
+	{
+		glmDestroySkinningPalette(palette);
+		palette->_boneCount = geometry->_boneCount;
+		palette->_matrices = (float(*)[16])GLMC_MALLOC(sizeof(float[16]) * ((size_t)palette->_boneCount + 1));
+		palette->_dualQuaternions = (float(*)[8])GLMC_MALLOC(sizeof(float[8]) * ((size_t)palette->_boneCount + 1));
+		if (!palette->_matrices || !palette->_dualQuaternions)
+		{
+			glmDestroySkinningPalette(palette);
+			return GIO_OUT_OF_MEMORY;
+		}
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+inline void glmComputeSkinningPaletteBone(GlmSkinningPalette* palette, const GlmGeometryFile* geometry, uint16_t iBone, const float* bonePosition, const float* boneOrientation)
+{
+	// offset applied first : v' = qWorld * (qOffset * v + tOffset) + tWorld
+	float* q = palette->_dualQuaternions[iBone];
+	float* d = q + 4;
+	float t[4];
+
+	glmMultQuaternion(boneOrientation, geometry->_boneOffsetOrientations[iBone], q);
+	glmMultVec3Quaternion(boneOrientation, geometry->_boneOffsetPositions[iBone], t);
+	t[0] += bonePosition[0];
+	t[1] += bonePosition[1];
+	t[2] += bonePosition[2];
+	t[3] = 0.f;
+
+	glmConvertMatrix(palette->_matrices[iBone], t, q);
+
+	// dual part = 0.5 * t * q
+	glmMultQuaternion(t, q, d);
+	d[0] *= 0.5f; d[1] *= 0.5f; d[2] *= 0.5f; d[3] *= 0.5f;
+}
+
+//----------------------------------------------------------------------------
+// bonePositions / boneOrientations are world space, in the geometry file bone order, array size = geometry._boneCount
+inline GlmGeometryGenerationStatus glmComputeSkinningPalette(GlmSkinningPalette* palette, const GlmGeometryFile* geometry, const float(*bonePositions)[3], const float(*boneOrientations)[4])
+{
+	uint16_t iBone;
+	GlmGeometryGenerationStatus status = glmReserveSkinningPalette(palette, geometry);
+	if (status != GIO_SUCCESS)
+		return status;
+
+	for (iBone = 0; iBone < palette->_boneCount; iBone++)
+		glmComputeSkinningPaletteBone(palette, geometry, iBone, bonePositions[iBone], boneOrientations[iBone]);
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// same as glmComputeSkinningPalette, bones of entityIndex (simulation entity order) read from a GlmFrameDataSoA
+// return GIO_INVALID_BONE_COUNT if the entity bones end past the frame bones
+inline GlmGeometryGenerationStatus glmComputeSkinningPaletteSoA(GlmSkinningPalette* palette, const GlmGeometryFile* geometry, const GlmFrameDataSoA* frameDataSoA, uint32_t entityIndex)
+{
+	uint16_t iBone;
+	uint32_t firstBone;
+	GlmGeometryGenerationStatus status;
+	if (entityIndex >= frameDataSoA->_entityCount)
+		return GIO_INVALID_BONE_COUNT;
+	firstBone = frameDataSoA->_entityBoneOffsets[entityIndex];
+	if ((uint64_t)firstBone + geometry->_boneCount > frameDataSoA->_boneValueCount)
+		return GIO_INVALID_BONE_COUNT;
+	status = glmReserveSkinningPalette(palette, geometry);
+	if (status != GIO_SUCCESS)
+		return status;
+
+	for (iBone = 0; iBone < palette->_boneCount; iBone++)
+	{
+		uint32_t iValue = firstBone + iBone;
+		float position[3] = { frameDataSoA->_positionsX[iValue], frameDataSoA->_positionsY[iValue], frameDataSoA->_positionsZ[iValue] };
+		float orientation[4] = { frameDataSoA->_orientationsX[iValue], frameDataSoA->_orientationsY[iValue], frameDataSoA->_orientationsZ[iValue], frameDataSoA->_orientationsW[iValue] };
+		glmComputeSkinningPaletteBone(palette, geometry, iBone, position, orientation);
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// vertex without influence : bind pose position and normal
+inline void glmSkinUnweightedVertex(const GlmSkinnedMesh* mesh, uint32_t iVertex, float* position, float* normal)
+{
+	memcpy(position, mesh->_positions[iVertex], sizeof(float[3]));
+	memcpy(normal, mesh->_normals[iVertex], sizeof(float[3]));
+}
+
+//----------------------------------------------------------------------------
+// scalar, one vertex at a time. Identity transform for vertices without influence
+inline void glmSkinDualQuaternionVertex(const GlmSkinnedMesh* mesh, const GlmSkinningPalette* palette, uint32_t iVertex, float* position, float* normal)
+{
+	float dq[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+	const float* pivot;
+	uint32_t iInfluence;
+	float norm;
+	float t[3];
+	int i;
+
+	if (mesh->_influenceOffsets[iVertex] == mesh->_influenceOffsets[iVertex + 1])
+	{
+		glmSkinUnweightedVertex(mesh, iVertex, position, normal);
+		return;
+	}
+	pivot = palette->_dualQuaternions[mesh->_influenceBoneIds[mesh->_influenceOffsets[iVertex]]];
+	for (iInfluence = mesh->_influenceOffsets[iVertex]; iInfluence < mesh->_influenceOffsets[iVertex + 1]; iInfluence++)
+	{
+		const float* boneDq = palette->_dualQuaternions[mesh->_influenceBoneIds[iInfluence]];
+		float weight = mesh->_influenceWeights[iInfluence];
+		// shortest path : keep all real parts in the hemisphere of the first influence
+		if (boneDq[0] * pivot[0] + boneDq[1] * pivot[1] + boneDq[2] * pivot[2] + boneDq[3] * pivot[3] < 0.f)
+			weight = -weight;
+		for (i = 0; i < 8; i++)
+			dq[i] += boneDq[i] * weight;
+	}
+
+	norm = 1.f / sqrtf(dq[0] * dq[0] + dq[1] * dq[1] + dq[2] * dq[2] + dq[3] * dq[3] + 1.0e-037f);
+	for (i = 0; i < 8; i++)
+		dq[i] *= norm;
+
+	// t = 2 * dual * conjugate(real)
+	t[0] = 2.f * (dq[3] * dq[4] - dq[7] * dq[0] + dq[1] * dq[6] - dq[2] * dq[5]);
+	t[1] = 2.f * (dq[3] * dq[5] - dq[7] * dq[1] + dq[2] * dq[4] - dq[0] * dq[6]);
+	t[2] = 2.f * (dq[3] * dq[6] - dq[7] * dq[2] + dq[0] * dq[5] - dq[1] * dq[4]);
+
+	glmMultVec3Quaternion(dq, mesh->_positions[iVertex], position);
+	position[0] += t[0];
+	position[1] += t[1];
+	position[2] += t[2];
+	glmMultVec3Quaternion(dq, mesh->_normals[iVertex], normal);
+}
+
+//----------------------------------------------------------------------------
+// scalar reference, vertices [firstVertex, firstVertex + vertexCount), positions / normals are indexed from firstVertex. normals can be NULL
+inline void glmSkinVerticesReference(const GlmSkinnedMesh* mesh, const GlmSkinningPalette* palette, uint32_t firstVertex, uint32_t vertexCount, float(*positions)[3], float(*normals)[3])
+{
+	uint32_t iVertex;
+	for (iVertex = firstVertex; iVertex < firstVertex + vertexCount; iVertex++)
+	{
+		float linearPosition[3] = { 0.f, 0.f, 0.f };
+		float linearNormal[3] = { 0.f, 0.f, 0.f };
+		float dqPosition[3], dqNormal[3];
+		float blend = mesh->_blendWeights[iVertex];
+		const float* p = mesh->_positions[iVertex];
+		const float* n = mesh->_normals[iVertex];
+		float* outPosition = positions[iVertex - firstVertex];
+		uint32_t iInfluence;
+		int i;
+
+		if (mesh->_influenceOffsets[iVertex] == mesh->_influenceOffsets[iVertex + 1])
+			glmSkinUnweightedVertex(mesh, iVertex, linearPosition, linearNormal);
+		else if (blend < 1.f)
+		{
+			for (iInfluence = mesh->_influenceOffsets[iVertex]; iInfluence < mesh->_influenceOffsets[iVertex + 1]; iInfluence++)
+			{
+				const float* m = palette->_matrices[mesh->_influenceBoneIds[iInfluence]];
+				float w = mesh->_influenceWeights[iInfluence];
+				for (i = 0; i < 3; i++)
+				{
+					linearPosition[i] += w * (p[0] * m[i] + p[1] * m[4 + i] + p[2] * m[8 + i] + m[12 + i]);
+					linearNormal[i] += w * (n[0] * m[i] + n[1] * m[4 + i] + n[2] * m[8 + i]);
+				}
+			}
+		}
+		if (blend > 0.f)
+			glmSkinDualQuaternionVertex(mesh, palette, iVertex, dqPosition, dqNormal);
+		else
+		{
+			memcpy(dqPosition, linearPosition, sizeof(dqPosition));
+			memcpy(dqNormal, linearNormal, sizeof(dqNormal));
+		}
+
+		for (i = 0; i < 3; i++)
+			outPosition[i] = linearPosition[i] + (dqPosition[i] - linearPosition[i]) * blend;
+		if (normals)
+		{
+			float* outNormal = normals[iVertex - firstVertex];
+			float norm;
+			for (i = 0; i < 3; i++)
+				outNormal[i] = linearNormal[i] + (dqNormal[i] - linearNormal[i]) * blend;
+			norm = 1.f / sqrtf(outNormal[0] * outNormal[0] + outNormal[1] * outNormal[1] + outNormal[2] * outNormal[2] + 1.0e-037f);
+			outNormal[0] *= norm; outNormal[1] *= norm; outNormal[2] *= norm;
+		}
+	}
+}
+
+#ifdef GIO_USE_SSE
+//----------------------------------------------------------------------------
+// 4 lanes helpers of glmSkinVertices : lane l of columns[i] is element i of the 4 floats at lane[l]
+inline void glmSkinLoadLanes4(const float* lane0, const float* lane1, const float* lane2, const float* lane3, __m128* columns)
+{
+	columns[0] = _mm_loadu_ps(lane0);
+	columns[1] = _mm_loadu_ps(lane1);
+	columns[2] = _mm_loadu_ps(lane2);
+	columns[3] = _mm_loadu_ps(lane3);
+	_MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+}
+
+//----------------------------------------------------------------------------
+// r = q * v per lane, same operations as glmMultVec3Quaternion
+inline void glmSkinRotateLanes4(const __m128* q, const __m128* v, __m128* r)
+{
+	__m128 one = _mm_set1_ps(1.f);
+	__m128 x2 = _mm_add_ps(q[0], q[0]);
+	__m128 y2 = _mm_add_ps(q[1], q[1]);
+	__m128 z2 = _mm_add_ps(q[2], q[2]);
+	__m128 xx = _mm_mul_ps(q[0], x2);
+	__m128 xy = _mm_mul_ps(q[0], y2);
+	__m128 xz = _mm_mul_ps(q[0], z2);
+	__m128 yy = _mm_mul_ps(q[1], y2);
+	__m128 yz = _mm_mul_ps(q[1], z2);
+	__m128 zz = _mm_mul_ps(q[2], z2);
+	__m128 wx = _mm_mul_ps(q[3], x2);
+	__m128 wy = _mm_mul_ps(q[3], y2);
+	__m128 wz = _mm_mul_ps(q[3], z2);
+	r[0] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), v[0]), _mm_mul_ps(_mm_sub_ps(xy, wz), v[1])), _mm_mul_ps(_mm_add_ps(xz, wy), v[2]));
+	r[1] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(xy, wz), v[0]), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), v[1])), _mm_mul_ps(_mm_sub_ps(yz, wx), v[2]));
+	r[2] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(xz, wy), v[0]), _mm_mul_ps(_mm_add_ps(yz, wx), v[1])), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), v[2]));
+}
+
+//----------------------------------------------------------------------------
+// mask ? a : b per lane
+inline __m128 glmSkinSelectLanes4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//----------------------------------------------------------------------------
+// writes the xyz of the first laneCount lanes to out[0 .. laneCount), 3 stores of the 12 packed floats for a full batch
+inline void glmSkinStoreLanes4(__m128 x, __m128 y, __m128 z, float(*out)[3], uint32_t laneCount)
+{
+	__m128 w = _mm_setzero_ps();
+	uint32_t iLane;
+	if (laneCount == 4)
+	{
+		__m128 xy01 = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+		__m128 xy23 = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+		__m128 z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)); // z0 z0 x1 x1
+		__m128 y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)); // y1 y1 z1 z1
+		__m128 z2y3 = _mm_shuffle_ps(z, xy23, _MM_SHUFFLE(3, 2, 3, 2)); // z2 z3 x3 y3
+		_mm_storeu_ps(out[0], _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(out[1] + 1, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+		_mm_storeu_ps(out[2] + 2, _mm_shuffle_ps(z2y3, z2y3, _MM_SHUFFLE(1, 3, 2, 0)));
+		return;
+	}
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	{
+		__m128 lanes[4] = { x, y, z, w };
+		for (iLane = 0; iLane < laneCount; iLane++)
+		{
+			_mm_storel_pi((__m64*)out[iLane], lanes[iLane]);
+			_mm_store_ss(out[iLane] + 2, _mm_movehl_ps(lanes[iLane], lanes[iLane]));
+		}
+	}
+}
+#endif
+
+//----------------------------------------------------------------------------
+// same output as glmSkinVerticesReference (within float tolerance). 4 vertices per iteration, one per SSE lane : each lane accumulates the
+// weighted bone matrix rows and / or the sign corrected dual quaternion of its CSR influences, transposed once per iteration, then the
+// transform, dual quaternion normalization, blend, normal normalization and bind pose of the unweighted lanes run on the 4 lanes at once.
+// A lane only depends on its own vertex, the result does not change with firstVertex
+inline void glmSkinVertices(const GlmSkinnedMesh* mesh, const GlmSkinningPalette* palette, uint32_t firstVertex, uint32_t vertexCount, float(*positions)[3], float(*normals)[3])
+{
+#ifdef GIO_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 epsilon = _mm_set1_ps(1.0e-037f);
+	uint32_t lastVertex = firstVertex + vertexCount;
+	uint32_t iFirst;
+	for (iFirst = firstVertex; iFirst < lastVertex; iFirst += 4)
+	{
+		uint32_t laneCount = lastVertex - iFirst < 4 ? lastVertex - iFirst : 4;
+		uint32_t vertices[4]; // the lanes past laneCount load the last vertex as unweighted and are not stored
+		uint32_t influenceBegins[4];
+		uint32_t influenceCounts[4];
+		__m128 p[4], n[4], blend, weighted, linearLanes, dqLanes;
+		__m128 linearPosition[3], linearNormal[3], dqPosition[3], dqNormal[3], position[3], normal[3];
+		uint32_t iLane, iInfluence;
+		int i;
+
+		for (iLane = 0; iLane < 4; iLane++)
+		{
+			uint32_t iVertex = iFirst + (iLane < laneCount ? iLane : laneCount - 1);
+			vertices[iLane] = iVertex;
+			influenceBegins[iLane] = mesh->_influenceOffsets[iVertex];
+			influenceCounts[iLane] = iLane < laneCount ? mesh->_influenceOffsets[iVertex + 1] - influenceBegins[iLane] : 0;
+		}
+		glmSkinLoadLanes4(mesh->_positions[vertices[0]], mesh->_positions[vertices[1]], mesh->_positions[vertices[2]], mesh->_positions[vertices[3]], p);
+		glmSkinLoadLanes4(mesh->_normals[vertices[0]], mesh->_normals[vertices[1]], mesh->_normals[vertices[2]], mesh->_normals[vertices[3]], n);
+		blend = laneCount == 4 ? _mm_loadu_ps(mesh->_blendWeights + iFirst) : _mm_setr_ps(mesh->_blendWeights[vertices[0]], mesh->_blendWeights[vertices[1]], mesh->_blendWeights[vertices[2]], mesh->_blendWeights[vertices[3]]);
+		weighted = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_setr_epi32((int)influenceCounts[0], (int)influenceCounts[1], (int)influenceCounts[2], (int)influenceCounts[3]), _mm_setzero_si128()));
+		linearLanes = _mm_and_ps(weighted, _mm_cmplt_ps(blend, one));
+		dqLanes = _mm_and_ps(weighted, _mm_cmpgt_ps(blend, zero));
+
+		for (i = 0; i < 3; i++)
+		{
+			linearPosition[i] = zero;
+			linearNormal[i] = zero;
+			dqPosition[i] = zero;
+			dqNormal[i] = zero;
+		}
+
+		if (_mm_movemask_ps(linearLanes))
+		{
+			// weighted matrix rows of each lane, then rows 0..2 and translation transposed to 3 columns each
+			__m128 rows[4][4];
+			__m128 matrix[12];
+			int iRow;
+			for (iLane = 0; iLane < 4; iLane++)
+			{
+				__m128 row0 = zero;
+				__m128 row1 = zero;
+				__m128 row2 = zero;
+				__m128 row3 = zero;
+				if (_mm_movemask_ps(linearLanes) & (1 << iLane))
+				{
+					for (iInfluence = influenceBegins[iLane]; iInfluence < influenceBegins[iLane] + influenceCounts[iLane]; iInfluence++)
+					{
+						const float* m = palette->_matrices[mesh->_influenceBoneIds[iInfluence]];
+						__m128 w = _mm_set1_ps(mesh->_influenceWeights[iInfluence]);
+						row0 = _mm_add_ps(row0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+						row1 = _mm_add_ps(row1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+						row2 = _mm_add_ps(row2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+						row3 = _mm_add_ps(row3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+					}
+				}
+				rows[iLane][0] = row0;
+				rows[iLane][1] = row1;
+				rows[iLane][2] = row2;
+				rows[iLane][3] = row3;
+			}
+			for (iRow = 0; iRow < 4; iRow++)
+			{
+				_MM_TRANSPOSE4_PS(rows[0][iRow], rows[1][iRow], rows[2][iRow], rows[3][iRow]);
+				matrix[iRow * 3] = rows[0][iRow];
+				matrix[iRow * 3 + 1] = rows[1][iRow];
+				matrix[iRow * 3 + 2] = rows[2][iRow];
+			}
+			for (i = 0; i < 3; i++)
+			{
+				linearPosition[i] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(p[0], matrix[i]), _mm_mul_ps(p[1], matrix[3 + i])), _mm_mul_ps(p[2], matrix[6 + i])), matrix[9 + i]);
+				linearNormal[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], matrix[i]), _mm_mul_ps(n[1], matrix[3 + i])), _mm_mul_ps(n[2], matrix[6 + i]));
+			}
+		}
+
+		if (_mm_movemask_ps(dqLanes))
+		{
+			// real and dual parts accumulated per lane in the influence order of the reference, then transposed
+			__m128 real[4], dual[4], dq[8], norm, t[3];
+			for (iLane = 0; iLane < 4; iLane++)
+			{
+				__m128 laneReal = zero;
+				__m128 laneDual = zero;
+				if (_mm_movemask_ps(dqLanes) & (1 << iLane))
+				{
+					const float* pivot = palette->_dualQuaternions[mesh->_influenceBoneIds[influenceBegins[iLane]]];
+					for (iInfluence = influenceBegins[iLane]; iInfluence < influenceBegins[iLane] + influenceCounts[iLane]; iInfluence++)
+					{
+						const float* boneDq = palette->_dualQuaternions[mesh->_influenceBoneIds[iInfluence]];
+						float weight = mesh->_influenceWeights[iInfluence];
+						__m128 w;
+						// shortest path : keep all real parts in the hemisphere of the first influence of the lane
+						if (boneDq[0] * pivot[0] + boneDq[1] * pivot[1] + boneDq[2] * pivot[2] + boneDq[3] * pivot[3] < 0.f)
+							weight = -weight;
+						w = _mm_set1_ps(weight);
+						laneReal = _mm_add_ps(laneReal, _mm_mul_ps(_mm_loadu_ps(boneDq), w));
+						laneDual = _mm_add_ps(laneDual, _mm_mul_ps(_mm_loadu_ps(boneDq + 4), w));
+					}
+				}
+				real[iLane] = laneReal;
+				dual[iLane] = laneDual;
+			}
+			_MM_TRANSPOSE4_PS(real[0], real[1], real[2], real[3]);
+			_MM_TRANSPOSE4_PS(dual[0], dual[1], dual[2], dual[3]);
+			for (i = 0; i < 4; i++)
+			{
+				dq[i] = real[i];
+				dq[4 + i] = dual[i];
+			}
+
+			norm = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dq[0], dq[0]), _mm_mul_ps(dq[1], dq[1])), _mm_mul_ps(dq[2], dq[2])), _mm_mul_ps(dq[3], dq[3])), epsilon)));
+			for (i = 0; i < 8; i++)
+				dq[i] = _mm_mul_ps(dq[i], norm);
+
+			// t = 2 * dual * conjugate(real)
+			t[0] = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dq[3], dq[4]), _mm_mul_ps(dq[7], dq[0])), _mm_mul_ps(dq[1], dq[6])), _mm_mul_ps(dq[2], dq[5]));
+			t[1] = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dq[3], dq[5]), _mm_mul_ps(dq[7], dq[1])), _mm_mul_ps(dq[2], dq[4])), _mm_mul_ps(dq[0], dq[6]));
+			t[2] = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dq[3], dq[6]), _mm_mul_ps(dq[7], dq[2])), _mm_mul_ps(dq[0], dq[5])), _mm_mul_ps(dq[1], dq[4]));
+
+			glmSkinRotateLanes4(dq, p, dqPosition);
+			glmSkinRotateLanes4(dq, n, dqNormal);
+			for (i = 0; i < 3; i++)
+				dqPosition[i] = _mm_add_ps(dqPosition[i], _mm_mul_ps(_mm_set1_ps(2.f), t[i]));
+		}
+
+		// as the reference : no linear part once fully dual quaternion, the linear part again where there is no dual quaternion part,
+		// the bind pose for the unweighted lanes
+		for (i = 0; i < 3; i++)
+		{
+			linearPosition[i] = _mm_andnot_ps(_mm_cmpge_ps(blend, one), linearPosition[i]);
+			linearNormal[i] = _mm_andnot_ps(_mm_cmpge_ps(blend, one), linearNormal[i]);
+			dqPosition[i] = glmSkinSelectLanes4(dqLanes, dqPosition[i], linearPosition[i]);
+			dqNormal[i] = glmSkinSelectLanes4(dqLanes, dqNormal[i], linearNormal[i]);
+			position[i] = glmSkinSelectLanes4(weighted, _mm_add_ps(linearPosition[i], _mm_mul_ps(_mm_sub_ps(dqPosition[i], linearPosition[i]), blend)), p[i]);
+			normal[i] = glmSkinSelectLanes4(weighted, _mm_add_ps(linearNormal[i], _mm_mul_ps(_mm_sub_ps(dqNormal[i], linearNormal[i]), blend)), n[i]);
+		}
+		glmSkinStoreLanes4(position[0], position[1], position[2], positions + (iFirst - firstVertex), laneCount);
+		if (normals)
+		{
+			__m128 norm = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normal[0], normal[0]), _mm_mul_ps(normal[1], normal[1])), _mm_mul_ps(normal[2], normal[2])), epsilon)));
+			glmSkinStoreLanes4(_mm_mul_ps(normal[0], norm), _mm_mul_ps(normal[1], norm), _mm_mul_ps(normal[2], norm), normals + (iFirst - firstVertex), laneCount);
+		}
+	}
+#else
+	glmSkinVerticesReference(mesh, palette, firstVertex, vertexCount, positions, normals);
+#endif
+}
+
+//----------------------------------------------------------------------------
+struct GlmSkinningTask
+{
+	const GlmSkinnedMesh* _mesh;
+	const GlmSkinningPalette* _palette;
+	float(*_positions)[3];
+	float(*_normals)[3];
+};
+
+//----------------------------------------------------------------------------
+// skins the vertex blocks [first, last) of GIO_SKINNING_VERTICES_PER_TASK vertices
+inline void glmSkinMeshBlocks(void* userData, unsigned int first, unsigned int last)
+{
+	const GlmSkinningTask* task = (const GlmSkinningTask*)userData;
+	uint32_t firstVertex = first * GIO_SKINNING_VERTICES_PER_TASK;
+	uint32_t lastVertex = last * GIO_SKINNING_VERTICES_PER_TASK;
+	if (lastVertex > task->_mesh->_vertexCount)
+		lastVertex = task->_mesh->_vertexCount;
+	if (firstVertex < lastVertex)
+		glmSkinVertices(task->_mesh, task->_palette, firstVertex, lastVertex - firstVertex, task->_positions + firstVertex, task->_normals ? task->_normals + firstVertex : NULL);
+}
+
+//----------------------------------------------------------------------------
+// skins all the vertices of mesh, positions / normals array size = mesh->_vertexCount, normals can be NULL
+// return GIO_SUCCESS || GIO_INVALID_BONE_COUNT if palette was computed for a geometry with less bones than mesh
+inline GlmGeometryGenerationStatus glmSkinMesh(const GlmSkinnedMesh* mesh, const GlmSkinningPalette* palette, float(*positions)[3], float(*normals)[3])
+{
+	GlmSkinningTask task;
+	unsigned int blockCount = (unsigned int)((mesh->_vertexCount + GIO_SKINNING_VERTICES_PER_TASK - 1) / GIO_SKINNING_VERTICES_PER_TASK);
+	if (palette->_boneCount < mesh->_boneCount || (mesh->_vertexCount && !palette->_matrices))
+		return GIO_INVALID_BONE_COUNT;
+
+	task._mesh = mesh;
+	task._palette = palette;
+	task._positions = positions;
+	task._normals = normals;
+	if (glmParallelFor && blockCount > 1)
+		glmParallelFor(glmSkinMeshBlocks, &task, blockCount);
+	else
+		glmSkinMeshBlocks(&task, 0, blockCount);
+	return GIO_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Read only file mapping
+//
+// The whole file is mapped, pages are loaded on first access and shared by every process mapping the same file.
+//
+
+struct GlmMappedFile_0
+{
+	const uint8_t* _data;
+	uint64_t _size;
+	void* _fileHandle; // for internal use
+	void* _mappingHandle; // for internal use
+};
+typedef GlmMappedFile_0 GlmMappedFile;
+
+//----------------------------------------------------------------------------
+inline void glmUnmapFile(GlmMappedFile& file)
+{
+#ifdef _WIN32
+	if (file._data)
+		UnmapViewOfFile(file._data);
+	if (file._mappingHandle)
+		CloseHandle((HANDLE)file._mappingHandle);
+	if (file._fileHandle)
+		CloseHandle((HANDLE)file._fileHandle);
+#else
+	if (file._data)
+		munmap((void*)file._data, (size_t)file._size);
+#endif
+	memset(&file, 0, sizeof(GlmMappedFile));
+}
+
+//----------------------------------------------------------------------------
+// return 1 on success, 0 if the file cannot be opened, is empty or cannot be mapped
+inline int glmMapFile(const char* filename, GlmMappedFile& file)
+{
+	memset(&file, 0, sizeof(GlmMappedFile));
+#ifdef _WIN32
+	{
+		LARGE_INTEGER size;
+		HANDLE fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return 0;
+		file._fileHandle = fileHandle;
+		if (GetFileSizeEx(fileHandle, &size) && size.QuadPart > 0)
+		{
+			file._size = (uint64_t)size.QuadPart;
+			file._mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (file._mappingHandle)
+				file._data = (const uint8_t*)MapViewOfFile((HANDLE)file._mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+#else
+	{
+		struct stat fileStat;
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0)
+			return 0;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			void* mapping = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapping != MAP_FAILED)
+			{
+				file._data = (const uint8_t*)mapping;
+				file._size = (uint64_t)fileStat.st_size;
+			}
+		}
+		close(fd); // the mapping keeps the file referenced
+	}
+#endif
+	if (!file._data)
+	{
+		glmUnmapFile(file);
+		return 0;
+	}
+	return 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Flat geometry file (.gcg, GCG_FLAT_MAGIC_NUMBER)
+//
+// Own magic number so that the regular gcg readers reject it. All arrays are stored in 32 bytes aligned sections addressed by
+// offsets from the beginning of the file, vertices in the GlmSkinnedMesh layout : once mapped, meshes are skinned in place without
+// any copy, and the read only mapping is shared by every process opening the same file. Opening only checks the header and the
+// section bounds, whatever the vertex count, the indices inside the sections are checked by the opt-in glmValidateFlatGeometryFile.
+// Meshes with geometry animation, vertex cache or blendshapes must use the regular gcg format.
+//
+
+#define GCG_FLAT_MAGIC_NUMBER 0x6CF0
+#define GCG_FLAT_VERSION 0x01
+#define GCG_FLAT_ALIGNMENT 32
+
+struct GlmFlatGeometryHeader_0
+{
+	uint16_t _magicNumber; // GCG_FLAT_MAGIC_NUMBER
+	uint16_t _version; // GCG_FLAT_VERSION
+	uint16_t _meshCount;
+	uint16_t _boneCount;
+	uint64_t _fileSize;
+	uint64_t _meshesOffset; // GlmFlatGeometryMesh, array size = _meshCount
+	uint64_t _boneParentingOffset; // uint16_t, array size = _boneCount
+	uint64_t _boneOffsetPositionsOffset; // float[3], array size = _boneCount
+	uint64_t _boneOffsetOrientationsOffset; // float[4], array size = _boneCount
+	uint64_t _boneJointOrientationsOffset; // float[4], array size = _boneCount
+	uint64_t _boneNameOffsetsOffset; // uint64_t offset of the zero terminated name, array size = _boneCount
+};
+typedef GlmFlatGeometryHeader_0 GlmFlatGeometryHeader;
+
+struct GlmFlatGeometryMesh_0
+{
+	uint64_t _nameOffset; // zero terminated name
+	uint8_t _skinningType; // GlmSkinningType
+	uint8_t _hasUVs;
+	uint16_t _rigidSkinningBoneId;
+	uint32_t _vertexCount;
+	uint32_t _triangleCount;
+	uint32_t _influenceCount;
+	float _defaultLocalToWorldMatrix[16];
+	uint64_t _positionsOffset; // float[4], w = 1, array size = _vertexCount
+	uint64_t _normalsOffset; // float[4], w = 0, array size = _vertexCount
+	uint64_t _uvsOffset; // float[2], array size = _vertexCount
+	uint64_t _blendWeightsOffset; // float, 0.f linear, 1.f dual quaternion as GlmSkinnedMesh::_blendWeights, array size = _vertexCount
+	uint64_t _influenceOffsetsOffset; // uint32_t, influences of vertex i are [offsets[i], offsets[i + 1]), array size = _vertexCount + 1
+	uint64_t _influenceBoneIdsOffset; // uint16_t, array size = _influenceCount
+	uint64_t _influenceWeightsOffset; // float, array size = _influenceCount
+	uint64_t _trianglesOffset; // uint32_t[3], array size = _triangleCount
+};
+typedef GlmFlatGeometryMesh_0 GlmFlatGeometryMesh;
+
+// a mapped flat geometry file, see glmOpenFlatGeometryFile
+struct GlmFlatGeometryFile_0
+{
+	GlmMappedFile _mapping;
+	const GlmFlatGeometryHeader* _header;
+	const GlmFlatGeometryMesh* _meshes; // array size = _header->_meshCount
+};
+typedef GlmFlatGeometryFile_0 GlmFlatGeometryFile;
+
+// typed access to a section of a mapped file, sections are checked by glmOpenFlatGeometryFile
+template<typename T> inline const T* glmFlatGeometrySection(const GlmFlatGeometryFile& file, uint64_t offset)
+{
+	return (const T*)(file._mapping._data + offset);
+}
+
+//----------------------------------------------------------------------------
+inline uint64_t glmFlatGeometryAlign(uint64_t offset)
+{
+	return (offset + GCG_FLAT_ALIGNMENT - 1) & ~(uint64_t)(GCG_FLAT_ALIGNMENT - 1);
+}
+
+//----------------------------------------------------------------------------
+// the layout is computed in a first pass (data == NULL), then written in a zeroed buffer of the returned size
+inline uint64_t glmFlatGeometryLayout(const GlmGeometryFile& geometry, uint8_t* data)
+{
+	GlmFlatGeometryHeader header;
+	uint64_t offset;
+	uint16_t iMesh, iBone;
+
+	memset(&header, 0, sizeof(GlmFlatGeometryHeader));
+	header._magicNumber = GCG_FLAT_MAGIC_NUMBER;
+	header._version = GCG_FLAT_VERSION;
+	header._meshCount = geometry._meshCount;
+	header._boneCount = geometry._boneCount;
+
+	offset = glmFlatGeometryAlign(sizeof(GlmFlatGeometryHeader));
+	header._meshesOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(GlmFlatGeometryMesh) * geometry._meshCount);
+	header._boneParentingOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(uint16_t) * geometry._boneCount);
+	header._boneOffsetPositionsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[3]) * geometry._boneCount);
+	header._boneOffsetOrientationsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[4]) * geometry._boneCount);
+	header._boneJointOrientationsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[4]) * geometry._boneCount);
+	header._boneNameOffsetsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(uint64_t) * geometry._boneCount);
+
+	if (data)
+	{
+		if (geometry._boneParenting)
+			memcpy(data + header._boneParentingOffset, geometry._boneParenting, sizeof(uint16_t) * geometry._boneCount);
+		if (geometry._boneOffsetPositions)
+			memcpy(data + header._boneOffsetPositionsOffset, geometry._boneOffsetPositions, sizeof(float[3]) * geometry._boneCount);
+		if (geometry._boneOffsetOrientations)
+			memcpy(data + header._boneOffsetOrientationsOffset, geometry._boneOffsetOrientations, sizeof(float[4]) * geometry._boneCount);
+		if (geometry._boneJointOrientations)
+			memcpy(data + header._boneJointOrientationsOffset, geometry._boneJointOrientations, sizeof(float[4]) * geometry._boneCount);
+	}
+
+	for (iBone = 0; iBone < geometry._boneCount; iBone++)
+	{
+		const char* name = (geometry._boneNames && geometry._boneNames[iBone]._string) ? geometry._boneNames[iBone]._string : "";
+		size_t nameSize = strlen(name) + 1;
+		if (data)
+		{
+			((uint64_t*)(data + header._boneNameOffsetsOffset))[iBone] = offset;
+			memcpy(data + offset, name, nameSize);
+		}
+		offset += nameSize;
+	}
+	offset = glmFlatGeometryAlign(offset);
+
+	for (iMesh = 0; iMesh < geometry._meshCount; iMesh++)
+	{
+		const GlmFileMesh& fileMesh = geometry._meshes[iMesh];
+		GlmFlatGeometryMesh mesh;
+		const char* name = fileMesh._name._string ? fileMesh._name._string : "";
+		size_t nameSize = strlen(name) + 1;
+		uint32_t iVertex;
+
+		memset(&mesh, 0, sizeof(GlmFlatGeometryMesh));
+		mesh._skinningType = fileMesh._skinningType;
+		mesh._hasUVs = fileMesh._hasUVs;
+		mesh._rigidSkinningBoneId = fileMesh._rigidSkinningBoneId;
+		mesh._vertexCount = fileMesh._vertexCount;
+		mesh._triangleCount = fileMesh._triangleCount;
+		memcpy(mesh._defaultLocalToWorldMatrix, fileMesh._defaultLocalToWorldMatrix, sizeof(float[16]));
+		for (iVertex = 0; iVertex < fileMesh._vertexCount; iVertex++)
+			mesh._influenceCount += (fileMesh._skinningType == GLM_SKIN_RIGID) ? 1 : fileMesh._vertices[iVertex]._skinVertexInfluenceCount;
+
+		mesh._nameOffset = offset; offset = glmFlatGeometryAlign(offset + nameSize);
+		mesh._positionsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[4]) * mesh._vertexCount);
+		mesh._normalsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[4]) * mesh._vertexCount);
+		mesh._uvsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float[2]) * mesh._vertexCount);
+		mesh._blendWeightsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float) * mesh._vertexCount);
+		mesh._influenceOffsetsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(uint32_t) * (mesh._vertexCount + 1));
+		mesh._influenceBoneIdsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(uint16_t) * mesh._influenceCount);
+		mesh._influenceWeightsOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(float) * mesh._influenceCount);
+		mesh._trianglesOffset = offset; offset = glmFlatGeometryAlign(offset + sizeof(uint32_t[3]) * mesh._triangleCount);
+
+		if (data)
+		{
+			float(*positions)[4] = (float(*)[4])(data + mesh._positionsOffset);
+			float(*normals)[4] = (float(*)[4])(data + mesh._normalsOffset);
+			float(*uvs)[2] = (float(*)[2])(data + mesh._uvsOffset);
+			float* blendWeights = (float*)(data + mesh._blendWeightsOffset);
+			uint32_t* influenceOffsets = (uint32_t*)(data + mesh._influenceOffsetsOffset);
+			uint16_t* influenceBoneIds = (uint16_t*)(data + mesh._influenceBoneIdsOffset);
+			float* influenceWeights = (float*)(data + mesh._influenceWeightsOffset);
+			uint32_t influence = 0;
+
+			memcpy(data + header._meshesOffset + sizeof(GlmFlatGeometryMesh) * iMesh, &mesh, sizeof(GlmFlatGeometryMesh));
+			memcpy(data + mesh._nameOffset, name, nameSize);
+			if (mesh._triangleCount)
+				memcpy(data + mesh._trianglesOffset, fileMesh._vertexIndicesPerTriangle, sizeof(uint32_t[3]) * mesh._triangleCount);
+
+			for (iVertex = 0; iVertex < fileMesh._vertexCount; iVertex++)
+			{
+				const GlmFileMeshVertex& vertex = fileMesh._vertices[iVertex];
+				memcpy(positions[iVertex], vertex._position, sizeof(float[3]));
+				positions[iVertex][3] = 1.f;
+				memcpy(normals[iVertex], vertex._normal, sizeof(float[3]));
+				uvs[iVertex][0] = vertex._u;
+				uvs[iVertex][1] = vertex._v;
+				blendWeights[iVertex] = (fileMesh._skinningType == GLM_SKIN_DUALQ) ? 1.f : (fileMesh._skinningType == GLM_SKIN_BLEND) ? vertex._skinInfluenceBlendWeight : 0.f;
+				influenceOffsets[iVertex] = influence;
+				if (fileMesh._skinningType == GLM_SKIN_RIGID)
+				{
+					influenceBoneIds[influence] = fileMesh._rigidSkinningBoneId;
+					influenceWeights[influence] = 1.f;
+					influence++;
+				}
+				else
+				{
+					uint8_t iInfluence;
+					for (iInfluence = 0; iInfluence < vertex._skinVertexInfluenceCount; iInfluence++, influence++)
+					{
+						influenceBoneIds[influence] = vertex._skinInfluenceBoneId[iInfluence];
+						influenceWeights[influence] = vertex._skinInfluenceWeights[iInfluence];
+					}
+				}
+			}
+			influenceOffsets[fileMesh._vertexCount] = influence;
+		}
+	}
+
+	header._fileSize = offset;
+	if (data)
+		memcpy(data, &header, sizeof(GlmFlatGeometryHeader));
+	return offset;
+}
+
+//----------------------------------------------------------------------------
+inline GlmGeometryGenerationStatus glmWriteFlatGeometryFile(const char* filename, const GlmGeometryFile& geometry)
+{
+	uint16_t iMesh;
+	uint64_t fileSize;
+	uint8_t* data;
+	size_t written;
+
+	for (iMesh = 0; iMesh < geometry._meshCount; iMesh++)
+	{
+		const GlmFileMesh& fileMesh = geometry._meshes[iMesh];
+		if (fileMesh._animTransformCount || fileMesh._vertexCacheFrameCount || fileMesh._blendShapeCount)
+			return GIO_GCG_FILE_BAD_FORMAT; // animated meshes are only supported by the regular gcg
+	}
+
+	fileSize = glmFlatGeometryLayout(geometry, NULL);
+	data = (uint8_t*)GLMC_MALLOC((size_t)fileSize);
+	if (!data)
+		return GIO_OUT_OF_MEMORY;
+	memset(data, 0, (size_t)fileSize);
+	glmFlatGeometryLayout(geometry, data);
+
+#ifdef _MSC_VER
+	FILE* fp;
+	errno_t err;
+	err = fopen_s(&fp, filename, "wb");
+	if (err != 0) { GLMC_FREE(data); return GIO_GCG_FILE_OPEN_FAILED; }
+#else
+	FILE* fp = fopen(filename, "wb");
+	if (fp == NULL) { GLMC_FREE(data); return GIO_GCG_FILE_OPEN_FAILED; }
+#endif
+	written = fwrite(data, 1, (size_t)fileSize, fp);
+	fclose(fp);
+	GLMC_FREE(data);
+	return (written == (size_t)fileSize) ? GIO_SUCCESS : GIO_GCG_FILE_OPEN_FAILED;
+}
+
+//----------------------------------------------------------------------------
+inline void glmCloseFlatGeometryFile(GlmFlatGeometryFile& file)
+{
+	glmUnmapFile(file._mapping);
+	memset(&file, 0, sizeof(GlmFlatGeometryFile));
+}
+
+//----------------------------------------------------------------------------
+// aligned section of count elements inside the file
+inline int glmFlatGeometryCheckSection(const GlmFlatGeometryFile& file, uint64_t offset, uint64_t count, uint64_t elementSize)
+{
+	return (offset % GCG_FLAT_ALIGNMENT) == 0 && offset <= file._mapping._size && count <= (file._mapping._size - offset) / elementSize;
+}
+
+//----------------------------------------------------------------------------
+// zero terminated string inside the file
+inline int glmFlatGeometryCheckString(const GlmFlatGeometryFile& file, uint64_t offset)
+{
+	return offset < file._mapping._size && memchr(file._mapping._data + offset, 0, (size_t)(file._mapping._size - offset)) != NULL;
+}
+
+//----------------------------------------------------------------------------
+// influences and triangles of a mesh whose sections are inside the file : increasing influence offsets, bone ids below the bone count,
+// vertex indices below the vertex count. Reads every index, see glmValidateFlatGeometryFile
+inline int glmFlatGeometryCheckMeshIndices(const GlmFlatGeometryFile& file, const GlmFlatGeometryMesh& mesh)
+{
+	const uint32_t* influenceOffsets = glmFlatGeometrySection<uint32_t>(file, mesh._influenceOffsetsOffset);
+	const uint16_t* influenceBoneIds = glmFlatGeometrySection<uint16_t>(file, mesh._influenceBoneIdsOffset);
+	const uint32_t* triangleIndices = glmFlatGeometrySection<uint32_t>(file, mesh._trianglesOffset);
+	uint64_t iIndex;
+	uint32_t iVertex, iInfluence;
+
+	for (iVertex = 0; iVertex < mesh._vertexCount; iVertex++)
+	{
+		if (influenceOffsets[iVertex] > influenceOffsets[iVertex + 1])
+			return 0;
+	}
+	for (iInfluence = 0; iInfluence < mesh._influenceCount; iInfluence++)
+	{
+		if (influenceBoneIds[iInfluence] >= file._header->_boneCount)
+			return 0;
+	}
+	for (iIndex = 0; iIndex < (uint64_t)mesh._triangleCount * 3; iIndex++)
+	{
+		if (triangleIndices[iIndex] >= mesh._vertexCount)
+			return 0;
+	}
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// maps the file read only and checks its header, names and section bounds : returns GIO_GCG_FILE_BAD_FORMAT for regular gcg files and
+// sections outside of the file. Only the header and mesh table pages are read, the indices inside the sections are not checked :
+// call glmValidateFlatGeometryFile on files that may be damaged
+inline GlmGeometryGenerationStatus glmOpenFlatGeometryFile(const char* filename, GlmFlatGeometryFile& file)
+{
+	const GlmFlatGeometryHeader* header;
+	const uint64_t* boneNameOffsets;
+	uint16_t iMesh, iBone;
+
+	memset(&file, 0, sizeof(GlmFlatGeometryFile));
+	if (!glmMapFile(filename, file._mapping))
+		return GIO_GCG_FILE_OPEN_FAILED;
+
+	header = (const GlmFlatGeometryHeader*)file._mapping._data;
+	if (file._mapping._size < sizeof(GlmFlatGeometryHeader) || header->_magicNumber != GCG_FLAT_MAGIC_NUMBER || header->_version != GCG_FLAT_VERSION || header->_fileSize != file._mapping._size
+		|| !glmFlatGeometryCheckSection(file, header->_meshesOffset, header->_meshCount, sizeof(GlmFlatGeometryMesh))
+		|| !glmFlatGeometryCheckSection(file, header->_boneParentingOffset, header->_boneCount, sizeof(uint16_t))
+		|| !glmFlatGeometryCheckSection(file, header->_boneOffsetPositionsOffset, header->_boneCount, sizeof(float[3]))
+		|| !glmFlatGeometryCheckSection(file, header->_boneOffsetOrientationsOffset, header->_boneCount, sizeof(float[4]))
+		|| !glmFlatGeometryCheckSection(file, header->_boneJointOrientationsOffset, header->_boneCount, sizeof(float[4]))
+		|| !glmFlatGeometryCheckSection(file, header->_boneNameOffsetsOffset, header->_boneCount, sizeof(uint64_t)))
+	{
+		glmCloseFlatGeometryFile(file);
+		return GIO_GCG_FILE_BAD_FORMAT;
+	}
+	file._header = header;
+	file._meshes = glmFlatGeometrySection<GlmFlatGeometryMesh>(file, header->_meshesOffset);
+
+	boneNameOffsets = glmFlatGeometrySection<uint64_t>(file, header->_boneNameOffsetsOffset);
+	for (iBone = 0; iBone < header->_boneCount; iBone++)
+	{
+		if (!glmFlatGeometryCheckString(file, boneNameOffsets[iBone]))
+		{
+			glmCloseFlatGeometryFile(file);
+			return GIO_GCG_FILE_BAD_FORMAT;
+		}
+	}
+
+	for (iMesh = 0; iMesh < header->_meshCount; iMesh++)
+	{
+		const GlmFlatGeometryMesh& mesh = file._meshes[iMesh];
+		if (!glmFlatGeometryCheckString(file, mesh._nameOffset)
+			|| mesh._skinningType > GLM_SKIN_BLEND || (mesh._skinningType == GLM_SKIN_RIGID && mesh._rigidSkinningBoneId >= header->_boneCount)
+			|| !glmFlatGeometryCheckSection(file, mesh._positionsOffset, mesh._vertexCount, sizeof(float[4]))
+			|| !glmFlatGeometryCheckSection(file, mesh._normalsOffset, mesh._vertexCount, sizeof(float[4]))
+			|| !glmFlatGeometryCheckSection(file, mesh._uvsOffset, mesh._vertexCount, sizeof(float[2]))
+			|| !glmFlatGeometryCheckSection(file, mesh._blendWeightsOffset, mesh._vertexCount, sizeof(float))
+			|| !glmFlatGeometryCheckSection(file, mesh._influenceOffsetsOffset, (uint64_t)mesh._vertexCount + 1, sizeof(uint32_t))
+			|| !glmFlatGeometryCheckSection(file, mesh._influenceBoneIdsOffset, mesh._influenceCount, sizeof(uint16_t))
+			|| !glmFlatGeometryCheckSection(file, mesh._influenceWeightsOffset, mesh._influenceCount, sizeof(float))
+			|| !glmFlatGeometryCheckSection(file, mesh._trianglesOffset, mesh._triangleCount, sizeof(uint32_t[3]))
+			|| glmFlatGeometrySection<uint32_t>(file, mesh._influenceOffsetsOffset)[mesh._vertexCount] != mesh._influenceCount)
+		{
+			glmCloseFlatGeometryFile(file);
+			return GIO_GCG_FILE_BAD_FORMAT;
+		}
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// checks every influence and triangle index of a file opened by glmOpenFlatGeometryFile, in O(vertices + triangles) : returns
+// GIO_GCG_FILE_BAD_FORMAT for decreasing influence offsets, bone ids past the bone count or vertex indices past the vertex count
+inline GlmGeometryGenerationStatus glmValidateFlatGeometryFile(const GlmFlatGeometryFile& file)
+{
+	uint16_t iMesh;
+	for (iMesh = 0; iMesh < file._header->_meshCount; iMesh++)
+	{
+		if (!glmFlatGeometryCheckMeshIndices(file, file._meshes[iMesh]))
+			return GIO_GCG_FILE_BAD_FORMAT;
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// same as glmCreateSkinnedMesh, from mesh iMesh of a flat file opened by glmOpenFlatGeometryFile : the arrays point in the mapping,
+// nothing is copied or allocated and file must stay open while mesh is used. Return GIO_SUCCESS
+inline GlmGeometryGenerationStatus glmCreateSkinnedMeshFromFlat(GlmSkinnedMesh* mesh, const GlmFlatGeometryFile& file, uint16_t iMesh)
+{
+	const GlmFlatGeometryMesh& flatMesh = file._meshes[iMesh];
+
+	// the skinning only reads the arrays, the mapping stays read only
+	memset(mesh, 0, sizeof(GlmSkinnedMesh));
+	mesh->_skinningType = flatMesh._skinningType;
+	mesh->_boneCount = file._header->_boneCount;
+	mesh->_vertexCount = flatMesh._vertexCount;
+	mesh->_positions = (float(*)[4])glmFlatGeometrySection<float[4]>(file, flatMesh._positionsOffset);
+	mesh->_normals = (float(*)[4])glmFlatGeometrySection<float[4]>(file, flatMesh._normalsOffset);
+	mesh->_influenceOffsets = (uint32_t*)glmFlatGeometrySection<uint32_t>(file, flatMesh._influenceOffsetsOffset);
+	mesh->_influenceBoneIds = (uint16_t*)glmFlatGeometrySection<uint16_t>(file, flatMesh._influenceBoneIdsOffset);
+	mesh->_influenceWeights = (float*)glmFlatGeometrySection<float>(file, flatMesh._influenceWeightsOffset);
+	mesh->_blendWeights = (float*)glmFlatGeometrySection<float>(file, flatMesh._blendWeightsOffset);
+	mesh->_mapped = 1;
+	return GIO_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Skinned character geometry
+//
+// glmOpenSkinnedGeometry reads a character gcg ready for skinning : flat gcg files are mapped and skinned in place,
+// other files go through glmReadGeometryFile of the glmCrowdIO library. _geometry holds the bind pose for glmComputeSkinningPalette
+// in both cases (for a flat file, it only holds the bone count and bone offsets pointing in the mapping). Flat files of unknown origin
+// are checked with glmValidateFlatGeometryFile(_flatFile) before skinning.
+//
+
+struct GlmSkinnedGeometry_0
+{
+	GlmFlatGeometryFile _flatFile; // mapped if the file is a flat gcg
+	GlmGeometryFile _geometry;
+	uint16_t _meshCount;
+	GlmSkinnedMesh* _meshes; // array size = _meshCount
+};
+typedef GlmSkinnedGeometry_0 GlmSkinnedGeometry;
+
+//----------------------------------------------------------------------------
+inline void glmCloseSkinnedGeometry(GlmSkinnedGeometry& skinnedGeometry)
+{
+	uint16_t iMesh;
+	if (skinnedGeometry._meshes)
+	{
+		for (iMesh = 0; iMesh < skinnedGeometry._meshCount; iMesh++)
+			glmDestroySkinnedMesh(&skinnedGeometry._meshes[iMesh]);
+		GLMC_FREE(skinnedGeometry._meshes);
+	}
+	if (skinnedGeometry._flatFile._header)
+		glmCloseFlatGeometryFile(skinnedGeometry._flatFile);
+	else
+		glmClearGeometryFile(skinnedGeometry._geometry);
+	memset(&skinnedGeometry, 0, sizeof(GlmSkinnedGeometry));
+}
+
+//----------------------------------------------------------------------------
+// return GIO_SUCCESS || the glmOpenFlatGeometryFile / glmReadGeometryFile / glmCreateSkinnedMesh errors
+inline GlmGeometryGenerationStatus glmOpenSkinnedGeometry(const char* filename, GlmSkinnedGeometry& skinnedGeometry)
+{
+	GlmGeometryGenerationStatus status;
+	uint16_t iMesh;
+
+	memset(&skinnedGeometry, 0, sizeof(GlmSkinnedGeometry));
+	status = glmOpenFlatGeometryFile(filename, skinnedGeometry._flatFile);
+	if (status == GIO_SUCCESS)
+	{
+		const GlmFlatGeometryHeader* header = skinnedGeometry._flatFile._header;
+		skinnedGeometry._geometry._boneCount = header->_boneCount;
+		skinnedGeometry._geometry._boneOffsetPositions = (float(*)[3])glmFlatGeometrySection<float[3]>(skinnedGeometry._flatFile, header->_boneOffsetPositionsOffset);
+		skinnedGeometry._geometry._boneOffsetOrientations = (float(*)[4])glmFlatGeometrySection<float[4]>(skinnedGeometry._flatFile, header->_boneOffsetOrientationsOffset);
+		skinnedGeometry._meshCount = header->_meshCount;
+	}
+	else if (status == GIO_GCG_FILE_BAD_FORMAT)
+	{
+		// not a flat gcg (or a damaged one, that the regular reader rejects as well)
+		status = glmReadGeometryFile(filename, skinnedGeometry._geometry);
+		if (status != GIO_SUCCESS)
+		{
+			memset(&skinnedGeometry, 0, sizeof(GlmSkinnedGeometry));
+			return status;
+		}
+		skinnedGeometry._meshCount = skinnedGeometry._geometry._meshCount;
+	}
+	else
+		return status;
+
+	skinnedGeometry._meshes = (GlmSkinnedMesh*)GLMC_MALLOC(sizeof(GlmSkinnedMesh) * ((size_t)skinnedGeometry._meshCount + 1));
+	if (!skinnedGeometry._meshes)
+	{
+		glmCloseSkinnedGeometry(skinnedGeometry);
+		return GIO_OUT_OF_MEMORY;
+	}
+	memset(skinnedGeometry._meshes, 0, sizeof(GlmSkinnedMesh) * ((size_t)skinnedGeometry._meshCount + 1));
+	for (iMesh = 0; iMesh < skinnedGeometry._meshCount; iMesh++)
+	{
+		if (skinnedGeometry._flatFile._header)
+			status = glmCreateSkinnedMeshFromFlat(&skinnedGeometry._meshes[iMesh], skinnedGeometry._flatFile, iMesh);
+		else
+			status = glmCreateSkinnedMesh(&skinnedGeometry._meshes[iMesh], &skinnedGeometry._geometry._meshes[iMesh], skinnedGeometry._geometry._boneCount);
+		if (status != GIO_SUCCESS)
+		{
+			glmCloseSkinnedGeometry(skinnedGeometry);
+			return status;
+		}
+	}
+	return GIO_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Parallel entity geometry generation
+//
+// glmCreateSkinnedEntities skins the entities of a frame in blocks of GIO_ENTITIES_PER_TASK run through the glmParallelFor hook of glm_crowd.h.
+// The skinned geometries and the frame bones are only read, each block has its own skinning palette and GlmEntityInstanceMatrices.
+// Rigid meshes are not skinned : they are instances of their bind pose mesh, registered by hash key and name in a GlmMeshInstanceGroupRegistry.
+//
+
+#define GIO_ENTITIES_PER_TASK 16
+#define GIO_INSTANCE_REGISTRY_SHARD_COUNT 64
+
+// Thread safe registration of the mesh instance groups of a crowd field, one registry per crowd field and frame. Groups are spread over
+// GIO_INSTANCE_REGISTRY_SHARD_COUNT shards by hash key and name, each with its own lock : threads only contend when they register meshes of the
+// same shard. Groups are stored in meshInstances (glmInitMeshInstanceGroups) and never move. Names are not copied, they must outlive the registry
+class GlmMeshInstanceGroupRegistry
+{
+public:
+	explicit GlmMeshInstanceGroupRegistry(GlmMeshInstanceGroupPerCrowdField& meshInstances) : _meshInstances(meshInstances)
+	{
+		_meshInstances._meshInstanceGroupSet = this;
+	}
+
+	~GlmMeshInstanceGroupRegistry()
+	{
+		_meshInstances._meshInstanceGroupSet = NULL;
+	}
+
+	// instance group of hashKey / name, created on the first registration, and the instance index of the caller : the caller getting
+	// instance index 0 makes the reference mesh. Returns -1 if GIO_MAX_INSTANCE_MESHES groups are used or the allocation failed
+	int32_t registerInstance(uint32_t hashKey, const char* name, uint32_t& instanceIndex)
+	{
+		Shard& shard = _shards[hashName(hashKey, name) % GIO_INSTANCE_REGISTRY_SHARD_COUNT];
+		GlmLockGuard lock(shard._lock);
+		for (size_t iEntry = 0; iEntry < shard._entries.size(); iEntry++)
+		{
+			const GlmMeshInstanceGroupSortEntry& entry = shard._entries[iEntry];
+			if (entry._hashKey == hashKey && strcmp(entry._name, name) == 0)
+			{
+				// a group only belongs to one shard, its lock protects _instanceCount
+				instanceIndex = _meshInstances._meshInstanceGroups[entry._instanceGroup]._instanceCount++;
+				return entry._instanceGroup;
+			}
+		}
+
+		int32_t instanceGroup;
+		{
+			GlmLockGuard countLock(_countLock);
+			instanceGroup = glmAddMeshInstanceGroup(_meshInstances);
+		}
+		if (instanceGroup < 0)
+			return -1;
+		GlmMeshInstanceGroupSortEntry entry;
+		entry._hashKey = hashKey;
+		entry._name = name;
+		entry._instanceGroup = instanceGroup;
+		shard._entries.push_back(entry);
+
+		// the reference is the bind pose mesh of the skinned geometry, complete before any instance is registered
+		GlmMeshInstanceGroup& group = _meshInstances._meshInstanceGroups[instanceGroup];
+		group._hashKey = (int32_t)hashKey;
+		group._instanceCount = 1;
+		group._definitionComplete = 1;
+		instanceIndex = 0;
+		return instanceGroup;
+	}
+
+private:
+	GlmMeshInstanceGroupRegistry(const GlmMeshInstanceGroupRegistry&);
+	GlmMeshInstanceGroupRegistry& operator = (const GlmMeshInstanceGroupRegistry&);
+
+	static uint32_t hashName(uint32_t hashKey, const char* name)
+	{
+		// FNV-1a of the name, seeded with the hash key
+		uint32_t hash = 2166136261u ^ hashKey;
+		for (; *name; name++)
+		{
+			hash ^= (uint8_t)*name;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	struct Shard
+	{
+		GlmMutex _lock;
+		std::vector<GlmMeshInstanceGroupSortEntry> _entries;
+	};
+
+	GlmMeshInstanceGroupPerCrowdField& _meshInstances;
+	GlmMutex _countLock; // glmAddMeshInstanceGroup calls of different shards
+	Shard _shards[GIO_INSTANCE_REGISTRY_SHARD_COUNT];
+};
+
+// mesh of a GlmSkinnedEntity
+struct GlmSkinnedEntityMesh_0
+{
+	int32_t _instanceGroup; // rigid mesh : instance group in the registry crowd field, -1 for a skinned mesh
+	uint32_t _instanceIndex; // rigid mesh : 0 if this entity makes the reference mesh of the group
+	int16_t _instanceFirstMatrixIndex; // rigid mesh : its matrix in GlmSkinnedEntity::_instanceMatrices, -1 for a skinned mesh
+	uint32_t _firstVertex; // skinned mesh : first vertex in GlmSkinnedEntity::_positions / _normals
+};
+typedef GlmSkinnedEntityMesh_0 GlmSkinnedEntityMesh;
+
+// entity of glmCreateSkinnedEntities, inputs are set by the caller, outputs are allocated by glmCreateSkinnedEntities and released by glmDestroySkinnedEntity
+struct GlmSkinnedEntity_0
+{
+	// input
+	const GlmSkinnedGeometry* _geometry; // character geometry, shared by all the entities of the character
+	uint32_t _hashKey; // key of the character geometry, ex: hash of its file name. Rigid meshes of the same hash key and name are instances of each other
+	uint32_t _entityIndex; // simulation entity index, to read the bones in the GlmFrameDataSoA
+
+	// output
+	GlmGeometryGenerationStatus _status;
+	GlmSkinnedEntityMesh* _meshes; // array size = _geometry->_meshCount
+	uint32_t _vertexCount; // vertices of the skinned meshes
+	float(*_positions)[3]; // array size = _vertexCount
+	float(*_normals)[3]; // array size = _vertexCount
+	uint16_t _instanceMatrixCount;
+	GlmMeshInstanceMatrix* _instanceMatrices; // rigid meshes transforms, row vector convention as GlmSkinningPalette::_matrices, array size = _instanceMatrixCount
+};
+typedef GlmSkinnedEntity_0 GlmSkinnedEntity;
+
+//----------------------------------------------------------------------------
+inline const char* glmGetSkinnedMeshName(const GlmSkinnedGeometry& skinnedGeometry, uint16_t iMesh)
+{
+	if (skinnedGeometry._flatFile._header)
+		return glmFlatGeometrySection<char>(skinnedGeometry._flatFile, skinnedGeometry._flatFile._meshes[iMesh]._nameOffset);
+	const GlmFileString& name = skinnedGeometry._geometry._meshes[iMesh]._name;
+	return name._string ? name._string : "";
+}
+
+//----------------------------------------------------------------------------
+// rigid meshes with vertices are instanced, all their vertices follow their single bone
+inline int glmIsInstancedSkinnedMesh(const GlmSkinnedMesh& mesh)
+{
+	return mesh._skinningType == GLM_SKIN_RIGID && mesh._vertexCount && mesh._influenceOffsets[1] > mesh._influenceOffsets[0];
+}
+
+//----------------------------------------------------------------------------
+// releases the outputs, keeps the inputs and _status
+inline void glmDestroySkinnedEntity(GlmSkinnedEntity* entity)
+{
+	GLMC_FREE(entity->_meshes);
+	GLMC_FREE(entity->_positions);
+	GLMC_FREE(entity->_normals);
+	GLMC_FREE(entity->_instanceMatrices);
+	entity->_meshes = NULL;
+	entity->_vertexCount = 0;
+	entity->_positions = NULL;
+	entity->_normals = NULL;
+	entity->_instanceMatrixCount = 0;
+	entity->_instanceMatrices = NULL;
+}
+
+//----------------------------------------------------------------------------
+// palette and instanceMatrices are the ones of the calling thread. Everything is allocated before the rigid meshes are registered, so an
+// allocation failure leaves the instance groups untouched. return GIO_SUCCESS || the glmComputeSkinningPaletteSoA errors || GIO_OUT_OF_MEMORY
+inline GlmGeometryGenerationStatus glmCreateSkinnedEntity(GlmSkinnedEntity* entity, const GlmFrameDataSoA* frameDataSoA, GlmMeshInstanceGroupRegistry& registry, GlmSkinningPalette* palette, GlmEntityInstanceMatrices& instanceMatrices)
+{
+	const GlmSkinnedGeometry* geometry = entity->_geometry;
+	uint32_t vertexCount = 0;
+	uint16_t instanceCount = 0;
+	uint16_t iMesh;
+	GlmGeometryGenerationStatus status = glmComputeSkinningPaletteSoA(palette, &geometry->_geometry, frameDataSoA, entity->_entityIndex);
+	if (status != GIO_SUCCESS)
+		return status;
+
+	for (iMesh = 0; iMesh < geometry->_meshCount; iMesh++)
+	{
+		if (glmIsInstancedSkinnedMesh(geometry->_meshes[iMesh]))
+			instanceCount++;
+		else
+			vertexCount += geometry->_meshes[iMesh]._vertexCount;
+	}
+	instanceMatrices._instanceMatrixUsedCount = 0;
+	entity->_meshes = (GlmSkinnedEntityMesh*)GLMC_MALLOC(sizeof(GlmSkinnedEntityMesh) * ((size_t)geometry->_meshCount + 1));
+	entity->_positions = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * ((size_t)vertexCount + 1));
+	entity->_normals = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * ((size_t)vertexCount + 1));
+	entity->_instanceMatrices = (GlmMeshInstanceMatrix*)GLMC_MALLOC(sizeof(GlmMeshInstanceMatrix) * ((size_t)instanceCount + 1));
+	if (!entity->_meshes || !entity->_positions || !entity->_normals || !entity->_instanceMatrices || !instanceMatrices._instanceMatrices.reserve(instanceCount))
+	{
+		glmDestroySkinnedEntity(entity);
+		return GIO_OUT_OF_MEMORY;
+	}
+	entity->_vertexCount = vertexCount;
+
+	vertexCount = 0;
+	for (iMesh = 0; iMesh < geometry->_meshCount; iMesh++)
+	{
+		const GlmSkinnedMesh& mesh = geometry->_meshes[iMesh];
+		GlmSkinnedEntityMesh& entityMesh = entity->_meshes[iMesh];
+		entityMesh._instanceGroup = -1;
+		entityMesh._instanceIndex = 0;
+		entityMesh._instanceFirstMatrixIndex = -1;
+		entityMesh._firstVertex = vertexCount;
+		if (glmIsInstancedSkinnedMesh(mesh))
+		{
+			// reserved above, never fails
+			GlmMeshInstanceMatrix* matrix = glmAddEntityInstanceMatrix(instanceMatrices);
+			memcpy(matrix, palette->_matrices[mesh._influenceBoneIds[mesh._influenceOffsets[0]]], sizeof(GlmMeshInstanceMatrix));
+			entityMesh._instanceFirstMatrixIndex = (int16_t)(instanceMatrices._instanceMatrixUsedCount - 1);
+			entityMesh._instanceGroup = registry.registerInstance(entity->_hashKey, glmGetSkinnedMeshName(*geometry, iMesh), entityMesh._instanceIndex);
+			if (entityMesh._instanceGroup < 0)
+			{
+				glmDestroySkinnedEntity(entity);
+				return GIO_OUT_OF_MEMORY;
+			}
+		}
+		else
+		{
+			glmSkinVertices(&mesh, palette, 0, mesh._vertexCount, entity->_positions + vertexCount, entity->_normals + vertexCount);
+			vertexCount += mesh._vertexCount;
+		}
+	}
+
+	// out of the calling thread matrices, reused by its next entity
+	entity->_instanceMatrixCount = instanceMatrices._instanceMatrixUsedCount;
+	for (iMesh = 0; iMesh < entity->_instanceMatrixCount; iMesh++)
+		memcpy(entity->_instanceMatrices[iMesh], instanceMatrices._instanceMatrices[iMesh], sizeof(GlmMeshInstanceMatrix));
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+struct GlmSkinnedEntitiesTask
+{
+	GlmSkinnedEntity* _entities;
+	uint32_t _entityCount;
+	const GlmFrameDataSoA* _frameDataSoA;
+	GlmMeshInstanceGroupRegistry* _registry;
+};
+
+//----------------------------------------------------------------------------
+// creates the entity blocks [first, last) of GIO_ENTITIES_PER_TASK entities. A call runs on a single thread : the palette and the instance
+// matrices are per thread, without thread local storage
+inline void glmCreateSkinnedEntityBlocks(void* userData, unsigned int first, unsigned int last)
+{
+	const GlmSkinnedEntitiesTask* task = (const GlmSkinnedEntitiesTask*)userData;
+	uint32_t firstEntity = first * GIO_ENTITIES_PER_TASK;
+	uint32_t lastEntity = last * GIO_ENTITIES_PER_TASK;
+	uint32_t iEntity;
+	GlmSkinningPalette palette;
+	GlmEntityInstanceMatrices instanceMatrices;
+
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	glmInitEntityInstanceMatrices(instanceMatrices);
+	if (lastEntity > task->_entityCount)
+		lastEntity = task->_entityCount;
+	for (iEntity = firstEntity; iEntity < lastEntity; iEntity++)
+		task->_entities[iEntity]._status = glmCreateSkinnedEntity(&task->_entities[iEntity], task->_frameDataSoA, *task->_registry, &palette, instanceMatrices);
+	glmReleaseEntityInstanceMatrices(instanceMatrices);
+	glmDestroySkinningPalette(&palette);
+}
+
+//----------------------------------------------------------------------------
+// creates the geometry of entities, array size = entityCount, their outputs must be NULL. Runs through glmParallelFor when it is set, entities are
+// independent and may be created in any order : instance indices depend on the thread scheduling, not the instance counts.
+// Every entity gets its _status, the outputs of the failed ones stay NULL. return GIO_SUCCESS || the status of the first failed entity
+inline GlmGeometryGenerationStatus glmCreateSkinnedEntities(GlmSkinnedEntity* entities, uint32_t entityCount, const GlmFrameDataSoA* frameDataSoA, GlmMeshInstanceGroupRegistry& registry)
+{
+	GlmSkinnedEntitiesTask task;
+	unsigned int blockCount = (unsigned int)((entityCount + GIO_ENTITIES_PER_TASK - 1) / GIO_ENTITIES_PER_TASK);
+	uint32_t iEntity;
+
+	task._entities = entities;
+	task._entityCount = entityCount;
+	task._frameDataSoA = frameDataSoA;
+	task._registry = &registry;
+	if (glmParallelFor && blockCount > 1)
+		glmParallelFor(glmCreateSkinnedEntityBlocks, &task, blockCount);
+	else
+		glmCreateSkinnedEntityBlocks(&task, 0, blockCount);
+
+	for (iEntity = 0; iEntity < entityCount; iEntity++)
+	{
+		if (entities[iEntity]._status != GIO_SUCCESS)
+			return entities[iEntity]._status;
+	}
+	return GIO_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Screen space LOD selection
+//
+// LOD 0 is the full resolution geometry. An entity uses the first LOD whose pixel threshold is below its projected size,
+// or the last LOD (decimated proxy) if smaller than every threshold. Entities keep their previous LOD while their size stays
+// inside the hysteresis band around a threshold, so that they do not flicker between LODs from one frame to the next.
+//
+
+#define GIO_NO_LOD UINT8_MAX
+
+struct GlmLodSettings_0
+{
+	uint8_t _lodCount; // number of LODs, including the full resolution one
+	float* _pixelThresholds; // minimum projected size in pixels to use LOD i, decreasing, array size = _lodCount - 1
+	float _hysteresis; // relative band around thresholds, ex: 0.1f = switch at +/-10%
+	float _imageHeight; // in pixels
+};
+typedef GlmLodSettings_0 GlmLodSettings;
+
+//----------------------------------------------------------------------------
+// projected diameter of the entity bounding sphere in pixels, FLT_MAX when the camera is inside the sphere
+inline float glmComputeEntityScreenSize(const GlmGeometryGenerationContext* context, const GlmEntityBoundingBox* bbox, float imageHeight)
+{
+	const float* h = bbox->_boundingBoxHalfExtents;
+	float scale = (bbox->_entityScale > 0.f) ? bbox->_entityScale : 1.f;
+	float radius = sqrtf(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]) * scale;
+	// column-major : [1][1] is the vertical focal factor, [3][3] is 1 for orthographic projections
+	float focal = context->_projectionMatrix[1][1];
+	float dx, dy, dz, distance;
+
+	if (context->_projectionMatrix[3][3] == 1.f)
+		return 2.f * radius * focal * imageHeight * 0.5f;
+
+	dx = bbox->_entityOrigin[0] - context->_cameraWorldPosition[0];
+	dy = bbox->_entityOrigin[1] - context->_cameraWorldPosition[1];
+	dz = bbox->_entityOrigin[2] - context->_cameraWorldPosition[2];
+	distance = sqrtf(dx * dx + dy * dy + dz * dz);
+	if (distance <= radius)
+		return FLT_MAX;
+	return 2.f * radius * focal / distance * imageHeight * 0.5f;
+}
+
+//----------------------------------------------------------------------------
+// previousLod = GIO_NO_LOD if the entity had no LOD last frame
+inline uint8_t glmSelectEntityLod(const GlmLodSettings* settings, float screenSize, uint8_t previousLod)
+{
+	uint8_t lod = 0;
+	uint8_t iThreshold;
+
+	if (settings->_lodCount <= 1)
+		return 0;
+
+	for (iThreshold = 0; iThreshold < settings->_lodCount - 1; iThreshold++)
+	{
+		float threshold = settings->_pixelThresholds[iThreshold];
+		if (previousLod != GIO_NO_LOD)
+		{
+			// threshold between lod iThreshold and iThreshold + 1 : favor the side the entity was on
+			if (previousLod <= iThreshold)
+				threshold *= 1.f - settings->_hysteresis;
+			else
+				threshold *= 1.f + settings->_hysteresis;
+		}
+		if (screenSize >= threshold)
+			break;
+		lod = iThreshold + 1;
+	}
+	return lod;
+}
+
+//----------------------------------------------------------------------------
+// lods must be kept by the caller between frames : previous LOD as input, new LOD as output, array size = context->_entityCount
+// invisible entities keep their LOD unchanged
+inline void glmSelectEntityLods(const GlmGeometryGenerationContext* context, const GlmLodSettings* settings, uint8_t* lods)
+{
+	uint32_t iEntity;
+	for (iEntity = 0; iEntity < context->_entityCount; iEntity++)
+	{
+		const GlmEntityBoundingBox* bbox = &context->_entityBBoxes[iEntity];
+		if (context->_enableFrustumCulling && !bbox->_isVisible)
+			continue;
+		lods[iEntity] = glmSelectEntityLod(settings, glmComputeEntityScreenSize(context, bbox, settings->_imageHeight), lods[iEntity]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Frustum culling of entity bounds
+//
+// Entities are bucketed in a uniform grid (counting sort, bounds stored per cell in structure of arrays). Cells are tested
+// against the frustum planes first : a cell fully inside or fully outside decides for all its entities, only cells crossing
+// a plane test their entities through glmCullBoxes, 8 at a time with AVX2, 4 with SSE2.
+//
+
+#define GIO_CULLING_GRID_RESOLUTION 16 // cells per horizontal axis
+#define GIO_CULLING_CHUNK_SIZE 256 // entities of a crossing cell tested per glmCullBoxes call
+
+struct GlmCullingBounds_0
+{
+	uint32_t _entityCount;
+	// entity bounds sorted by cell, array size = _entityCount rounded up to a multiple of 4
+	uint32_t* _entityIndices; // index in the bounds source (context _entityBBoxes or simulation entity index)
+	float* _centers[3];
+	float* _extents[3];
+	// cells
+	uint32_t _cellCount;
+	uint32_t* _cellFirstEntity; // array size = _cellCount + 1
+	float(*_cellMin)[3]; // array size = _cellCount
+	float(*_cellMax)[3]; // array size = _cellCount
+};
+typedef GlmCullingBounds_0 GlmCullingBounds;
+
+//----------------------------------------------------------------------------
+inline void glmDestroyCullingBounds(GlmCullingBounds* bounds)
+{
+	int i;
+	GLMC_FREE(bounds->_entityIndices);
+	for (i = 0; i < 3; i++)
+	{
+		GLMC_FREE(bounds->_centers[i]);
+		GLMC_FREE(bounds->_extents[i]);
+	}
+	GLMC_FREE(bounds->_cellFirstEntity);
+	GLMC_FREE(bounds->_cellMin);
+	GLMC_FREE(bounds->_cellMax);
+	memset(bounds, 0, sizeof(GlmCullingBounds));
+}
+
+//----------------------------------------------------------------------------
+// centers / extents : unsorted bounds, array size = entityCount. Bucketed on the X/Z plane (Y-up)
+inline GlmGeometryGenerationStatus glmCreateCullingBounds(GlmCullingBounds* bounds, const float(*centers)[3], const float(*extents)[3], uint32_t entityCount)
+{
+	float gridMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float gridMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	uint32_t paddedCount = (entityCount + 3) & ~3u;
+	uint32_t* entityCells;
+	uint32_t iEntity, iCell;
+	int i;
+
+	memset(bounds, 0, sizeof(GlmCullingBounds));
+	bounds->_entityCount = entityCount;
+	bounds->_cellCount = GIO_CULLING_GRID_RESOLUTION * GIO_CULLING_GRID_RESOLUTION;
+	bounds->_entityIndices = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * (paddedCount + 1));
+	for (i = 0; i < 3; i++)
+	{
+		bounds->_centers[i] = (float*)GLMC_MALLOC(sizeof(float) * (paddedCount + 1));
+		bounds->_extents[i] = (float*)GLMC_MALLOC(sizeof(float) * (paddedCount + 1));
+	}
+	bounds->_cellFirstEntity = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * (bounds->_cellCount + 1));
+	bounds->_cellMin = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * bounds->_cellCount);
+	bounds->_cellMax = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * bounds->_cellCount);
+	entityCells = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * (entityCount + 1));
+	if (!bounds->_entityIndices || !bounds->_centers[0] || !bounds->_centers[1] || !bounds->_centers[2] || !bounds->_extents[0] || !bounds->_extents[1] || !bounds->_extents[2]
+		|| !bounds->_cellFirstEntity || !bounds->_cellMin || !bounds->_cellMax || !entityCells)
+	{
+		GLMC_FREE(entityCells);
+		glmDestroyCullingBounds(bounds);
+		return GIO_OUT_OF_MEMORY;
+	}
+	// padding entities are never read, zeroed for the SIMD loads
+	memset(bounds->_entityIndices, 0, sizeof(uint32_t) * (paddedCount + 1));
+	for (i = 0; i < 3; i++)
+	{
+		memset(bounds->_centers[i], 0, sizeof(float) * (paddedCount + 1));
+		memset(bounds->_extents[i], 0, sizeof(float) * (paddedCount + 1));
+	}
+	memset(bounds->_cellFirstEntity, 0, sizeof(uint32_t) * (bounds->_cellCount + 1));
+
+	for (iEntity = 0; iEntity < entityCount; iEntity++)
+	{
+		for (i = 0; i < 3; i++)
+		{
+			gridMin[i] = (centers[iEntity][i] < gridMin[i]) ? centers[iEntity][i] : gridMin[i];
+			gridMax[i] = (centers[iEntity][i] > gridMax[i]) ? centers[iEntity][i] : gridMax[i];
+		}
+	}
+
+	// counting sort per cell
+	for (iEntity = 0; iEntity < entityCount; iEntity++)
+	{
+		float sizeX = gridMax[0] - gridMin[0];
+		float sizeZ = gridMax[2] - gridMin[2];
+		uint32_t cellX = (sizeX > 0.f) ? (uint32_t)((centers[iEntity][0] - gridMin[0]) / sizeX * (GIO_CULLING_GRID_RESOLUTION - 1) + 0.5f) : 0;
+		uint32_t cellZ = (sizeZ > 0.f) ? (uint32_t)((centers[iEntity][2] - gridMin[2]) / sizeZ * (GIO_CULLING_GRID_RESOLUTION - 1) + 0.5f) : 0;
+		entityCells[iEntity] = cellZ * GIO_CULLING_GRID_RESOLUTION + cellX;
+		bounds->_cellFirstEntity[entityCells[iEntity] + 1]++;
+	}
+	for (iCell = 0; iCell < bounds->_cellCount; iCell++)
+	{
+		bounds->_cellFirstEntity[iCell + 1] += bounds->_cellFirstEntity[iCell];
+		for (i = 0; i < 3; i++)
+		{
+			bounds->_cellMin[iCell][i] = FLT_MAX;
+			bounds->_cellMax[iCell][i] = -FLT_MAX;
+		}
+	}
+	{
+		uint32_t* cellCursor = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * bounds->_cellCount);
+		if (!cellCursor)
+		{
+			GLMC_FREE(entityCells);
+			glmDestroyCullingBounds(bounds);
+			return GIO_OUT_OF_MEMORY;
+		}
+		memcpy(cellCursor, bounds->_cellFirstEntity, sizeof(uint32_t) * bounds->_cellCount);
+		for (iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			uint32_t cell = entityCells[iEntity];
+			uint32_t sorted = cellCursor[cell]++;
+			bounds->_entityIndices[sorted] = iEntity;
+			for (i = 0; i < 3; i++)
+			{
+				float minValue = centers[iEntity][i] - extents[iEntity][i];
+				float maxValue = centers[iEntity][i] + extents[iEntity][i];
+				bounds->_centers[i][sorted] = centers[iEntity][i];
+				bounds->_extents[i][sorted] = extents[iEntity][i];
+				bounds->_cellMin[cell][i] = (minValue < bounds->_cellMin[cell][i]) ? minValue : bounds->_cellMin[cell][i];
+				bounds->_cellMax[cell][i] = (maxValue > bounds->_cellMax[cell][i]) ? maxValue : bounds->_cellMax[cell][i];
+			}
+		}
+		GLMC_FREE(cellCursor);
+	}
+	GLMC_FREE(entityCells);
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// bounds of the context entities : origin and scaled half extents
+inline GlmGeometryGenerationStatus glmCreateCullingBoundsFromContext(GlmCullingBounds* bounds, const GlmGeometryGenerationContext* context)
+{
+	GlmGeometryGenerationStatus status;
+	float(*centers)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (context->_entityCount + 1));
+	float(*extents)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (context->_entityCount + 1));
+	uint32_t iEntity;
+	int i;
+
+	if (!centers || !extents)
+	{
+		GLMC_FREE(centers);
+		GLMC_FREE(extents);
+		return GIO_OUT_OF_MEMORY;
+	}
+	for (iEntity = 0; iEntity < context->_entityCount; iEntity++)
+	{
+		const GlmEntityBoundingBox* bbox = &context->_entityBBoxes[iEntity];
+		float scale = (bbox->_entityScale > 0.f) ? bbox->_entityScale : 1.f;
+		for (i = 0; i < 3; i++)
+		{
+			centers[iEntity][i] = bbox->_entityOrigin[i];
+			extents[iEntity][i] = bbox->_boundingBoxHalfExtents[i] * scale;
+		}
+	}
+	status = glmCreateCullingBounds(bounds, (const float(*)[3])centers, (const float(*)[3])extents, context->_entityCount);
+	GLMC_FREE(centers);
+	GLMC_FREE(extents);
+	return status;
+}
+
+//----------------------------------------------------------------------------
+// bounds of the simulation entities for one frame : root bone position, cube of the skeleton max hierarchy length
+inline GlmGeometryGenerationStatus glmCreateCullingBoundsFromFrame(GlmCullingBounds* bounds, const GlmSimulationData* simulationData, const GlmFrameData* frameData)
+{
+	GlmGeometryGenerationStatus status;
+	float(*centers)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (simulationData->_entityCount + 1));
+	float(*extents)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (simulationData->_entityCount + 1));
+	uint32_t iEntity;
+
+	if (!centers || !extents)
+	{
+		GLMC_FREE(centers);
+		GLMC_FREE(extents);
+		return GIO_OUT_OF_MEMORY;
+	}
+	for (iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationData->_entityTypes[iEntity];
+		uint32_t rootBone = simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_indexInEntityType[iEntity] * simulationData->_boneCount[entityType];
+		float extent = simulationData->_maxBonesHierarchyLength[entityType] * simulationData->_scales[iEntity];
+		memcpy(centers[iEntity], frameData->_bonePositions[rootBone], sizeof(float[3]));
+		extents[iEntity][0] = extents[iEntity][1] = extents[iEntity][2] = extent;
+	}
+	status = glmCreateCullingBounds(bounds, (const float(*)[3])centers, (const float(*)[3])extents, simulationData->_entityCount);
+	GLMC_FREE(centers);
+	GLMC_FREE(extents);
+	return status;
+}
+
+//----------------------------------------------------------------------------
+// same as glmCreateCullingBoundsFromFrame, root bones read from a GlmFrameDataSoA
+inline GlmGeometryGenerationStatus glmCreateCullingBoundsFromFrameSoA(GlmCullingBounds* bounds, const GlmSimulationData* simulationData, const GlmFrameDataSoA* frameDataSoA)
+{
+	GlmGeometryGenerationStatus status;
+	float(*centers)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (simulationData->_entityCount + 1));
+	float(*extents)[3] = (float(*)[3])GLMC_MALLOC(sizeof(float[3]) * (simulationData->_entityCount + 1));
+	uint32_t iEntity;
+
+	if (!centers || !extents)
+	{
+		GLMC_FREE(centers);
+		GLMC_FREE(extents);
+		return GIO_OUT_OF_MEMORY;
+	}
+	for (iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationData->_entityTypes[iEntity];
+		uint32_t rootBone = frameDataSoA->_entityBoneOffsets[iEntity];
+		float extent = simulationData->_maxBonesHierarchyLength[entityType] * simulationData->_scales[iEntity];
+		centers[iEntity][0] = frameDataSoA->_positionsX[rootBone];
+		centers[iEntity][1] = frameDataSoA->_positionsY[rootBone];
+		centers[iEntity][2] = frameDataSoA->_positionsZ[rootBone];
+		extents[iEntity][0] = extents[iEntity][1] = extents[iEntity][2] = extent;
+	}
+	status = glmCreateCullingBounds(bounds, (const float(*)[3])centers, (const float(*)[3])extents, simulationData->_entityCount);
+	GLMC_FREE(centers);
+	GLMC_FREE(extents);
+	return status;
+}
+
+//----------------------------------------------------------------------------
+// m[row][col] = projection * view, from the column-major context matrices : clip = m * (x, y, z, 1)
+inline void glmComputeViewProjectionMatrix(const GlmGeometryGenerationContext* context, float m[4][4])
+{
+	int row, col, k;
+	for (row = 0; row < 4; row++)
+	{
+		for (col = 0; col < 4; col++)
+		{
+			m[row][col] = 0.f;
+			for (k = 0; k < 4; k++)
+				m[row][col] += context->_projectionMatrix[k][row] * context->_viewMatrix[col][k];
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// normalized planes (nx, ny, nz, d), inside when n.p + d >= 0, grown by the frustum margin
+inline void glmComputeFrustumPlanes(const GlmGeometryGenerationContext* context, float planes[6][4])
+{
+	float m[4][4];
+	int col, iPlane;
+
+	glmComputeViewProjectionMatrix(context, m);
+	for (iPlane = 0; iPlane < 6; iPlane++)
+	{
+		int axis = iPlane / 2;
+		float sign = (iPlane % 2) ? -1.f : 1.f;
+		float length;
+		for (col = 0; col < 4; col++)
+			planes[iPlane][col] = m[3][col] + sign * m[axis][col];
+		length = sqrtf(planes[iPlane][0] * planes[iPlane][0] + planes[iPlane][1] * planes[iPlane][1] + planes[iPlane][2] * planes[iPlane][2] + 1.0e-037f);
+		for (col = 0; col < 4; col++)
+			planes[iPlane][col] /= length;
+		planes[iPlane][3] += context->_frustumMargin;
+	}
+}
+
+//----------------------------------------------------------------------------
+// 0 outside, 1 intersecting, 2 inside
+inline int glmClassifyBoxFrustum(const float planes[6][4], const float* boxMin, const float* boxMax)
+{
+	int result = 2;
+	int iPlane, i;
+	for (iPlane = 0; iPlane < 6; iPlane++)
+	{
+		float center = planes[iPlane][3];
+		float radius = 0.f;
+		for (i = 0; i < 3; i++)
+		{
+			center += planes[iPlane][i] * (boxMin[i] + boxMax[i]) * 0.5f;
+			radius += fabsf(planes[iPlane][i]) * (boxMax[i] - boxMin[i]) * 0.5f;
+		}
+		if (center < -radius)
+			return 0;
+		if (center < radius)
+			result = 1;
+	}
+	return result;
+}
+
+//----------------------------------------------------------------------------
+// visibilities : 1 if visible, indexed like the bounds source, array size = bounds->_entityCount
+inline void glmCullEntities(const GlmCullingBounds* bounds, const float planes[6][4], uint8_t* visibilities)
+{
+	uint32_t iCell;
+	for (iCell = 0; iCell < bounds->_cellCount; iCell++)
+	{
+		uint32_t first = bounds->_cellFirstEntity[iCell];
+		uint32_t last = bounds->_cellFirstEntity[iCell + 1];
+		uint32_t iEntity;
+		int cellClass;
+
+		if (first == last)
+			continue;
+		cellClass = glmClassifyBoxFrustum(planes, bounds->_cellMin[iCell], bounds->_cellMax[iCell]);
+		if (cellClass != 1)
+		{
+			for (iEntity = first; iEntity < last; iEntity++)
+				visibilities[bounds->_entityIndices[iEntity]] = (uint8_t)(cellClass == 2);
+			continue;
+		}
+
+		// crossing cell : its entities through the glmSimdKernels box test, a chunk at a time
+		for (iEntity = first; iEntity < last; iEntity += GIO_CULLING_CHUNK_SIZE)
+		{
+			uint8_t outside[GIO_CULLING_CHUNK_SIZE];
+			uint32_t chunkLast = (last - iEntity > GIO_CULLING_CHUNK_SIZE) ? iEntity + GIO_CULLING_CHUNK_SIZE : last;
+			uint32_t iChunk;
+			glmCullBoxes(bounds->_centers, bounds->_extents, iEntity, chunkLast, planes, outside);
+			for (iChunk = iEntity; iChunk < chunkLast; iChunk++)
+				visibilities[bounds->_entityIndices[iChunk]] = (uint8_t)!outside[iChunk - iEntity];
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// sets _isVisible of the context bounding boxes, entities closer than _cameraMargin to the camera are always visible
+inline GlmGeometryGenerationStatus glmCullContextEntities(GlmGeometryGenerationContext* context)
+{
+	GlmCullingBounds bounds;
+	GlmGeometryGenerationStatus status;
+	float planes[6][4];
+	uint8_t* visibilities;
+	uint32_t iEntity;
+
+	if (!context->_enableFrustumCulling)
+		return GIO_SUCCESS;
+
+	status = glmCreateCullingBoundsFromContext(&bounds, context);
+	if (status != GIO_SUCCESS)
+		return status;
+	visibilities = (uint8_t*)GLMC_MALLOC(context->_entityCount + 1);
+	if (!visibilities)
+	{
+		glmDestroyCullingBounds(&bounds);
+		return GIO_OUT_OF_MEMORY;
+	}
+
+	glmComputeFrustumPlanes(context, planes);
+	glmCullEntities(&bounds, (const float(*)[4])planes, visibilities);
+	for (iEntity = 0; iEntity < context->_entityCount; iEntity++)
+	{
+		GlmEntityBoundingBox* bbox = &context->_entityBBoxes[iEntity];
+		float dx = bbox->_entityOrigin[0] - context->_cameraWorldPosition[0];
+		float dy = bbox->_entityOrigin[1] - context->_cameraWorldPosition[1];
+		float dz = bbox->_entityOrigin[2] - context->_cameraWorldPosition[2];
+		bbox->_isVisible = visibilities[iEntity] || (dx * dx + dy * dy + dz * dz <= context->_cameraMargin * context->_cameraMargin);
+	}
 
-#ifdef __cplusplus
+	GLMC_FREE(visibilities);
+	glmDestroyCullingBounds(&bounds);
+	return GIO_SUCCESS;
 }
-#endif
 
 namespace CrowdTerrain
 {
@@ -749,7 +3565,7 @@ namespace CrowdTerrain
 	}
 	inline float operator* (const Vec3& vector1, const Vec3& vector2)
 	{
-		return vector1.x*vector2.x + vector1.y*vector2.y + vector1.z - vector2.z;
+		return vector1.x*vector2.x + vector1.y*vector2.y + vector1.z*vector2.z;
 	}
 
 	struct GIO_API SubMesh
@@ -776,6 +3592,10 @@ namespace CrowdTerrain
 		void setFrame(int frame);
 		bool raycastClosest(const Vec3& rayOrigin, const Vec3& rayEnd, Vec3 *collisionPoint, Vec3 *collisionNormal, const Matrix4* proxyMatrix, const Matrix4* proxyMatrixInverse) const;
 
+		// deformed terrain : replace vertex positions (same topology) and refit the AABB hierarchy bottom-up, no rebuild
+		inline void deform(const Vec3 * lVertices, const Vec3 * lNormals);
+		inline void refit();
+
 		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 		Vec3 *_vertices;
@@ -819,6 +3639,11 @@ namespace CrowdTerrain
 			for (unsigned int i = 0; i < _subMeshes.size(); i++)
 				_subMeshes[i]->setFrame(frame);
 		}
+		void refit()
+		{
+			for (unsigned int i = 0; i < _subMeshes.size(); i++)
+				_subMeshes[i]->refit();
+		}
 		std::vector<SubMesh*> _subMeshes;
 		int _startFrame;
 		void setProxyMatrices(const Matrix4* proxyMatrix, const Matrix4* proxyMatrixInverse)
@@ -1043,9 +3868,9 @@ namespace CrowdTerrain
 	}
 
 	//-----------------------------------------------------------------------------
-	// intersection of a ray and an AABox
+	// intersection of a ray and an AABox, boxes ending before tMin along the ray are missed
 	//-----------------------------------------------------------------------------
-	template<typename pointT> bool intersectRayAABox(const pointT & rO, const pointT & rV, const pointT& min, const pointT& max, float &tnear, float &tfar)
+	template<typename pointT> bool intersectRayAABox(const pointT & rO, const pointT & rV, const pointT& min, const pointT& max, float &tnear, float &tfar, float tMin = 0.f)
 	{
 		pointT T_1, T_2; // vectors to hold the T-values for every direction
 		float t_near = -FLT_MAX;
@@ -1084,7 +3909,7 @@ namespace CrowdTerrain
 				{
 					t_far = T_2[i];
 				}
-				if ((t_near > t_far) || (t_far < 0.f))
+				if ((t_near > t_far) || (t_far < tMin))
 				{
 					return false;
 				}
@@ -1094,21 +3919,36 @@ namespace CrowdTerrain
 		return true; // if we made it here, there was an intersection - YAY
 	}
 
-	template<typename vertexT, typename pointT> bool hierarchicalRaycast(const pointT& sourcePt, const pointT &end, int &triIndex, float& tt, int aabbIndex, const AABB<pointT>* aabbArray, const vertexT* vertices, const int* indices)
+	// optional raycast counters, accumulated over calls
+	struct RaycastStats
+	{
+		RaycastStats() : _nodeCount(0), _triangleCount(0)
+		{
+		}
+		uint64_t _nodeCount; // AABB nodes tested against the ray
+		uint64_t _triangleCount; // triangles tested against the ray
+	};
+
+	// boxes ending before tMin along the ray are skipped, see intersectRayAABox. tMin = -0.001 keeps the boxes of triangles a ray starting on the surface can hit
+	template<typename vertexT, typename pointT> bool hierarchicalRaycast(const pointT& sourcePt, const pointT &end, int &triIndex, float& tt, int aabbIndex, const AABB<pointT>* aabbArray, const vertexT* vertices, const int* indices, RaycastStats* stats = NULL, float tMin = 0.f)
 	{
 		const AABB<pointT> & aabb(aabbArray[aabbIndex]);
 
 		float tnear, tfar;
-		if (intersectRayAABox<pointT>(sourcePt, end, aabb._AABBmin, aabb._AABBmax, tnear, tfar))
+		if (stats)
+			stats->_nodeCount++;
+		if (intersectRayAABox<pointT>(sourcePt, end, aabb._AABBmin, aabb._AABBmax, tnear, tfar, tMin))
 		{
 			bool hasHit(false);
 
 			if (aabb._left != -1)
-				hasHit |= hierarchicalRaycast<vertexT, pointT>(sourcePt, end, triIndex, tt, aabb._left, aabbArray, vertices, indices);
+				hasHit |= hierarchicalRaycast<vertexT, pointT>(sourcePt, end, triIndex, tt, aabb._left, aabbArray, vertices, indices, stats, tMin);
 
 			if (aabb._right != -1)
-				hasHit |= hierarchicalRaycast<vertexT, pointT>(sourcePt, end, triIndex, tt, aabb._right, aabbArray, vertices, indices);
+				hasHit |= hierarchicalRaycast<vertexT, pointT>(sourcePt, end, triIndex, tt, aabb._right, aabbArray, vertices, indices, stats, tMin);
 
+			if (stats)
+				stats->_triangleCount += aabb._indexCount / 3;
 			for (int i = aabb._firstIndex; i < (aabb._firstIndex + aabb._indexCount); i += 3)
 			{
 				float tu, tv, t;
@@ -1131,6 +3971,939 @@ namespace CrowdTerrain
 		}
 		return false;
 	}
+
+	// reference raycast testing every triangle, same hit rules as hierarchicalRaycast with tMin = -0.001. Used to validate the hierarchy results
+	template<typename vertexT, typename pointT> bool bruteForceRaycast(const pointT& sourcePt, const pointT &end, int &triIndex, float& tt, const vertexT* vertices, const int* indices, int indexCount, RaycastStats* stats = NULL)
+	{
+		bool hasHit(false);
+		if (stats)
+			stats->_triangleCount += indexCount / 3;
+		for (int i = 0; i + 2 < indexCount; i += 3)
+		{
+			float tu, tv, t;
+			float* v1 = (float*)&vertices[indices[i]];
+			float* v2 = (float*)&vertices[indices[i + 1]];
+			float* v3 = (float*)&vertices[indices[i + 2]];
+			if (rayTriangle((float*)&sourcePt.x, (float*)&end.x,
+				v1, v2, v3,
+				&t, &tu, &tv))
+			{
+				if ((t<tt) && (t>-0.001f) && (t < 1.f))
+				{
+					triIndex = i;
+					tt = t;
+					hasHit = true;
+				}
+			}
+		}
+		return hasHit;
+	}
+
+	// update bounds of an existing hierarchy for deformed vertices, topology and index order are kept.
+	// computeAABBHierarchy pushes children before their parent, so one forward pass is bottom-up.
+	template<typename vertexT, typename pointT> void refitAABBHierarchy(const vertexT *vts, const int *indices, AABB<pointT>* aabbArray, int aabbCount)
+	{
+		for (int iNode = 0; iNode < aabbCount; iNode++)
+		{
+			AABB<pointT>& aabb(aabbArray[iNode]);
+			if (aabb._left == -1 && aabb._right == -1)
+			{
+				computeAABBBounds<const vertexT, pointT>(vts, (int*)indices + aabb._firstIndex, aabb._indexCount, aabb._AABBmin, aabb._AABBmax);
+				continue;
+			}
+
+			aabb._AABBmin.setValues(FLT_MAX, FLT_MAX, FLT_MAX);
+			aabb._AABBmax.setValues(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			int children[2] = { aabb._left, aabb._right };
+			for (int iChild = 0; iChild < 2; iChild++)
+			{
+				if (children[iChild] == -1)
+					continue;
+				const AABB<pointT>& child(aabbArray[children[iChild]]);
+				for (int j = 0; j < 3; j++)
+				{
+					aabb._AABBmin[j] = (aabb._AABBmin[j] < child._AABBmin[j]) ? aabb._AABBmin[j] : child._AABBmin[j];
+					aabb._AABBmax[j] = (aabb._AABBmax[j] > child._AABBmax[j]) ? aabb._AABBmax[j] : child._AABBmax[j];
+				}
+			}
+		}
+	}
+
+	// rigid instance raycast : the ray is moved in the instance local space instead of transforming the vertices.
+	// end is the ray segment vector as in hierarchicalRaycast. tt is the parametric distance along the segment, it is preserved by affine transforms so it can be compared between instances
+	template<typename vertexT, typename pointT> bool instanceRaycast(const Matrix4& worldToLocal, const pointT& sourcePt, const pointT &end, int &triIndex, float& tt, const AABB<pointT>* aabbArray, int aabbCount, const vertexT* vertices, const int* indices, RaycastStats* stats = NULL)
+	{
+		if (!aabbCount)
+			return false;
+		pointT localSource = worldToLocal.transformPoint(sourcePt);
+		pointT localEnd = worldToLocal.transformVector(end);
+		// root is the last node pushed by computeAABBHierarchy. Boxes get the tolerance of the triangle hits : agents raycast from their
+		// feet on the refitted surface, the box of the triangle they stand on must not be skipped
+		return hierarchicalRaycast<vertexT, pointT>(localSource, localEnd, triIndex, tt, aabbCount - 1, aabbArray, vertices, indices, stats, -0.001f);
+	}
+
+	inline void SubMesh::refit()
+	{
+		if (_AABB.empty())
+			return;
+		refitAABBHierarchy<Vec3, Vec3>(_vertices, (const int*)_indices, &_AABB[0], (int)_AABB.size());
+	}
+
+	inline void SubMesh::deform(const Vec3 * lVertices, const Vec3 * lNormals)
+	{
+		memcpy(_vertices, lVertices, sizeof(Vec3) * _vertexCount);
+		if (lNormals && _normals)
+			memcpy(_normals, lNormals, sizeof(Vec3) * _vertexCount);
+		refit();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// prebuilt terrain cache (.gtb), written next to the terrain file
+	// header : magic(uint16), version(uint16), subMeshCount(uint32), sourceHash(uint32), startFrame(int32)
+	// per subMesh : contentHash(uint32), indiceCount(uint32), aabbCount(uint32), vertexCount(uint32), normalCount(uint32), animationCount(uint32),
+	//		localToWorld(float[16]), reordered indices, AABB nodes, vertices, normals, animation world to local matrices then their inverses (float[16])
+	// .gtg terrains are read by glmReadTerrainFile and take the indices and hierarchies of the cache when the submesh content hashes match.
+	// Fbx terrains are built by the library, they are read whole from the cache when sourceHash matches the hash of the fbx file bytes
+
+	inline void cumulativeHashBytes(const void* data, size_t size, uint32_t* currentHashValue)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			*currentHashValue ^= bytes[i];
+			*currentHashValue *= 16777619;
+		}
+	}
+
+	// vertices are hashed in order, triangles are summed so the key is the same before and after computeAABBHierarchy reorders them
+	inline uint32_t computeSubMeshContentHash(const SubMesh& subMesh)
+	{
+		uint32_t hashValue = 2166136261u;
+		uint32_t triangleSum = 0;
+		cumulativeHashBytes(&subMesh._vertexCount, sizeof(unsigned int), &hashValue);
+		cumulativeHashBytes(&subMesh._indiceCount, sizeof(unsigned int), &hashValue);
+		cumulativeHashBytes(subMesh._vertices, sizeof(Vec3) * subMesh._vertexCount, &hashValue);
+		for (unsigned int i = 0; i + 2 < subMesh._indiceCount; i += 3)
+		{
+			uint32_t triangleHash = 2166136261u;
+			cumulativeHashBytes(&subMesh._indices[i], sizeof(unsigned int) * 3, &triangleHash);
+			triangleSum += triangleHash;
+		}
+		cumulativeHashBytes(&triangleSum, sizeof(uint32_t), &hashValue);
+		return hashValue;
+	}
+
+	// hash of the bytes of a terrain file, keys the cache of the terrains the library builds. Returns false if the file cannot be read
+	inline bool computeTerrainFileHash(const char* terrainCompletePath, uint32_t& hashValue)
+	{
+		GlmMappedFile mapping;
+		if (!glmMapFile(terrainCompletePath, mapping))
+			return false;
+		// 64 bits FNV-1a steps on 8 bytes words, the tail byte by byte
+		uint64_t wordHash = 14695981039346656037ull ^ mapping._size;
+		size_t wordCount = (size_t)(mapping._size / sizeof(uint64_t));
+		for (size_t iWord = 0; iWord < wordCount; iWord++)
+		{
+			uint64_t word;
+			memcpy(&word, mapping._data + iWord * sizeof(uint64_t), sizeof(uint64_t));
+			wordHash = (wordHash ^ word) * 1099511628211ull;
+		}
+		for (size_t iByte = wordCount * sizeof(uint64_t); iByte < (size_t)mapping._size; iByte++)
+			wordHash = (wordHash ^ mapping._data[iByte]) * 1099511628211ull;
+		glmUnmapFile(mapping);
+		hashValue = (uint32_t)(wordHash ^ (wordHash >> 32));
+		return true;
+	}
+
+	// sourceHash is 0 for .gtg terrains, the result of computeTerrainFileHash otherwise
+	inline bool writeTerrainAABBCache(const char* file, const Mesh& mesh, uint32_t sourceHash = 0)
+	{
+#ifdef _MSC_VER
+		FILE* fp;
+		errno_t err;
+		err = fopen_s(&fp, file, "wb");
+		if (err != 0) return false;
+#else
+		FILE* fp = fopen(file, "wb");
+		if (fp == NULL) return false;
+#endif
+		uint16_t magicNumber = GTB_MAGIC_NUMBER;
+		uint16_t version = GTB_VERSION;
+		uint32_t subMeshCount = (uint32_t)mesh._subMeshes.size();
+		int32_t startFrame = mesh._startFrame;
+		bool success = fwrite(&magicNumber, sizeof(uint16_t), 1, fp) == 1;
+		success &= fwrite(&version, sizeof(uint16_t), 1, fp) == 1;
+		success &= fwrite(&subMeshCount, sizeof(uint32_t), 1, fp) == 1;
+		success &= fwrite(&sourceHash, sizeof(uint32_t), 1, fp) == 1;
+		success &= fwrite(&startFrame, sizeof(int32_t), 1, fp) == 1;
+		for (uint32_t iSubMesh = 0; iSubMesh < subMeshCount && success; iSubMesh++)
+		{
+			const SubMesh* subMesh = mesh._subMeshes[iSubMesh];
+			uint32_t counts[6]; // contentHash, indiceCount, aabbCount, vertexCount, normalCount, animationCount
+			counts[0] = computeSubMeshContentHash(*subMesh);
+			counts[1] = subMesh->_indiceCount;
+			counts[2] = (uint32_t)subMesh->_AABB.size();
+			counts[3] = subMesh->_vertexCount;
+			counts[4] = subMesh->_normals ? subMesh->_vertexCount : 0;
+			counts[5] = (uint32_t)subMesh->_animation.size();
+			success &= fwrite(counts, sizeof(uint32_t), 6, fp) == 6;
+			success &= fwrite(subMesh->_localToWorld._matrix, sizeof(float), 16, fp) == 16;
+			if (counts[1])
+				success &= fwrite(subMesh->_indices, sizeof(unsigned int), counts[1], fp) == counts[1];
+			if (counts[2])
+				success &= fwrite(&subMesh->_AABB[0], sizeof(AABB<Vec3>), counts[2], fp) == counts[2];
+			if (counts[3])
+				success &= fwrite(subMesh->_vertices, sizeof(Vec3), counts[3], fp) == counts[3];
+			if (counts[4])
+				success &= fwrite(subMesh->_normals, sizeof(Vec3), counts[4], fp) == counts[4];
+			for (uint32_t iFrame = 0; iFrame < counts[5]; iFrame++)
+				success &= fwrite(subMesh->_animation[iFrame]._matrix, sizeof(float), 16, fp) == 16;
+			for (uint32_t iFrame = 0; iFrame < counts[5]; iFrame++)
+				success &= fwrite(subMesh->_animationInverse[iFrame]._matrix, sizeof(float), 16, fp) == 16;
+		}
+		fclose(fp);
+		return success;
+	}
+
+	// one submesh of a mapped cache, pointers into the mapping
+	struct TerrainCacheSubMesh
+	{
+		uint32_t _contentHash;
+		uint32_t _indiceCount;
+		uint32_t _aabbCount;
+		uint32_t _vertexCount;
+		uint32_t _normalCount; // 0 or _vertexCount
+		uint32_t _animationCount;
+		const uint8_t* _localToWorld;
+		const uint8_t* _indices;
+		const uint8_t* _hierarchy;
+		const uint8_t* _vertices;
+		const uint8_t* _normals;
+		const uint8_t* _animation; // _animationCount world to local matrices, then their inverses
+	};
+
+	// checks sizes, indices against the vertex count, node links and leaf ranges as computeAABBHierarchy writes them
+	// (children before their parent, leaves inside the index buffer). Returns false if the cache is damaged or from another version
+	inline bool parseTerrainCache(const GlmMappedFile& mapping, uint32_t& sourceHash, int32_t& startFrame, std::vector<TerrainCacheSubMesh>& subMeshes)
+	{
+		const uint8_t* cursor = mapping._data;
+		const uint8_t* dataEnd = mapping._data + mapping._size;
+		uint16_t magicNumber, version;
+		uint32_t subMeshCount;
+		if (mapping._size < sizeof(uint16_t) * 2 + sizeof(uint32_t) * 3)
+			return false;
+		memcpy(&magicNumber, cursor, sizeof(uint16_t)); cursor += sizeof(uint16_t);
+		memcpy(&version, cursor, sizeof(uint16_t)); cursor += sizeof(uint16_t);
+		memcpy(&subMeshCount, cursor, sizeof(uint32_t)); cursor += sizeof(uint32_t);
+		memcpy(&sourceHash, cursor, sizeof(uint32_t)); cursor += sizeof(uint32_t);
+		memcpy(&startFrame, cursor, sizeof(int32_t)); cursor += sizeof(int32_t);
+		if (magicNumber != GTB_MAGIC_NUMBER || version != GTB_VERSION || subMeshCount > (uint64_t)(dataEnd - cursor) / (sizeof(uint32_t) * 6))
+			return false;
+
+		subMeshes.resize(subMeshCount);
+		for (uint32_t iSubMesh = 0; iSubMesh < subMeshCount; iSubMesh++)
+		{
+			TerrainCacheSubMesh& subMesh = subMeshes[iSubMesh];
+			uint32_t counts[6];
+			if ((size_t)(dataEnd - cursor) < sizeof(counts))
+				return false;
+			memcpy(counts, cursor, sizeof(counts));
+			cursor += sizeof(counts);
+			subMesh._contentHash = counts[0];
+			subMesh._indiceCount = counts[1];
+			subMesh._aabbCount = counts[2];
+			subMesh._vertexCount = counts[3];
+			subMesh._normalCount = counts[4];
+			subMesh._animationCount = counts[5];
+			uint64_t dataSize = sizeof(float) * 16 + sizeof(unsigned int) * (uint64_t)counts[1] + sizeof(AABB<Vec3>) * (uint64_t)counts[2]
+				+ sizeof(Vec3) * ((uint64_t)counts[3] + counts[4]) + sizeof(float) * 32 * (uint64_t)counts[5];
+			if (counts[2] > INT32_MAX || (counts[4] != 0 && counts[4] != counts[3]) || (uint64_t)(dataEnd - cursor) < dataSize)
+				return false;
+			subMesh._localToWorld = cursor;
+			cursor += sizeof(float) * 16;
+			subMesh._indices = cursor;
+			cursor += sizeof(unsigned int) * counts[1];
+			subMesh._hierarchy = cursor;
+			cursor += sizeof(AABB<Vec3>) * counts[2];
+			subMesh._vertices = cursor;
+			cursor += sizeof(Vec3) * counts[3];
+			subMesh._normals = cursor;
+			cursor += sizeof(Vec3) * counts[4];
+			subMesh._animation = cursor;
+			cursor += sizeof(float) * 32 * counts[5];
+
+			for (uint32_t iIndex = 0; iIndex < counts[1]; iIndex++)
+			{
+				unsigned int index;
+				memcpy(&index, subMesh._indices + sizeof(unsigned int) * iIndex, sizeof(unsigned int));
+				if (index >= counts[3])
+					return false;
+			}
+			for (uint32_t iNode = 0; iNode < counts[2]; iNode++)
+			{
+				AABB<Vec3> node;
+				memcpy(&node, subMesh._hierarchy + sizeof(AABB<Vec3>) * iNode, sizeof(AABB<Vec3>));
+				if (!(node._left >= -1 && node._left < (int)iNode && node._right >= -1 && node._right < (int)iNode
+					&& node._firstIndex >= 0 && node._indexCount >= 0 && (uint32_t)node._firstIndex + (uint32_t)node._indexCount <= counts[1]))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// replace the reordered indices and hierarchy of each subMesh if the cache matches the mesh content, nothing is modified otherwise.
+	// The cache is mapped and checked by parseTerrainCache before use
+	inline bool readTerrainAABBCache(const char* file, Mesh& mesh)
+	{
+		GlmMappedFile mapping;
+		if (!glmMapFile(file, mapping))
+			return false;
+
+		uint32_t sourceHash;
+		int32_t startFrame;
+		std::vector<TerrainCacheSubMesh> cachedSubMeshes;
+		bool success = parseTerrainCache(mapping, sourceHash, startFrame, cachedSubMeshes) && cachedSubMeshes.size() == mesh._subMeshes.size();
+		for (size_t iSubMesh = 0; iSubMesh < cachedSubMeshes.size() && success; iSubMesh++)
+		{
+			const SubMesh* subMesh = mesh._subMeshes[iSubMesh];
+			const TerrainCacheSubMesh& cachedSubMesh = cachedSubMeshes[iSubMesh];
+			success = cachedSubMesh._indiceCount == subMesh->_indiceCount && cachedSubMesh._vertexCount == subMesh->_vertexCount
+				&& cachedSubMesh._contentHash == computeSubMeshContentHash(*subMesh);
+		}
+
+		if (success)
+		{
+			for (size_t iSubMesh = 0; iSubMesh < cachedSubMeshes.size(); iSubMesh++)
+			{
+				SubMesh* subMesh = mesh._subMeshes[iSubMesh];
+				const TerrainCacheSubMesh& cachedSubMesh = cachedSubMeshes[iSubMesh];
+				if (subMesh->_indiceCount)
+					memcpy(subMesh->_indices, cachedSubMesh._indices, sizeof(unsigned int) * subMesh->_indiceCount);
+				subMesh->_AABB.resize(cachedSubMesh._aabbCount);
+				if (cachedSubMesh._aabbCount)
+					memcpy(&subMesh->_AABB[0], cachedSubMesh._hierarchy, sizeof(AABB<Vec3>) * cachedSubMesh._aabbCount);
+			}
+		}
+		glmUnmapFile(mapping);
+		return success;
+	}
+
+	// whole terrain from the cache if it was written for a terrain file of hash sourceHash, NULL otherwise. Release with delete
+	inline Mesh* readTerrainCache(const char* file, uint32_t sourceHash)
+	{
+		GlmMappedFile mapping;
+		if (!glmMapFile(file, mapping))
+			return NULL;
+
+		uint32_t cachedSourceHash;
+		int32_t startFrame;
+		std::vector<TerrainCacheSubMesh> cachedSubMeshes;
+		if (!parseTerrainCache(mapping, cachedSourceHash, startFrame, cachedSubMeshes) || cachedSourceHash != sourceHash || sourceHash == 0)
+		{
+			glmUnmapFile(mapping);
+			return NULL;
+		}
+
+		Mesh* mesh = new Mesh();
+		mesh->_startFrame = startFrame;
+		for (size_t iSubMesh = 0; iSubMesh < cachedSubMeshes.size(); iSubMesh++)
+		{
+			const TerrainCacheSubMesh& cachedSubMesh = cachedSubMeshes[iSubMesh];
+			SubMesh* subMesh = new SubMesh();
+			subMesh->_vertexCount = cachedSubMesh._vertexCount;
+			subMesh->_indiceCount = cachedSubMesh._indiceCount;
+			subMesh->_vertices = new Vec3[subMesh->_vertexCount];
+			subMesh->_normals = cachedSubMesh._normalCount ? new Vec3[subMesh->_vertexCount] : NULL;
+			subMesh->_indices = new unsigned int[subMesh->_indiceCount];
+			memcpy(subMesh->_vertices, cachedSubMesh._vertices, sizeof(Vec3) * subMesh->_vertexCount);
+			if (subMesh->_normals)
+				memcpy(subMesh->_normals, cachedSubMesh._normals, sizeof(Vec3) * subMesh->_vertexCount);
+			memcpy(subMesh->_indices, cachedSubMesh._indices, sizeof(unsigned int) * subMesh->_indiceCount);
+			subMesh->_AABB.resize(cachedSubMesh._aabbCount);
+			if (cachedSubMesh._aabbCount)
+				memcpy(&subMesh->_AABB[0], cachedSubMesh._hierarchy, sizeof(AABB<Vec3>) * cachedSubMesh._aabbCount);
+			memcpy(subMesh->_localToWorld._matrix, cachedSubMesh._localToWorld, sizeof(float) * 16);
+			subMesh->_worldToLocal.inverse(subMesh->_localToWorld);
+			subMesh->_animation.resize(cachedSubMesh._animationCount);
+			subMesh->_animationInverse.resize(cachedSubMesh._animationCount);
+			for (uint32_t iFrame = 0; iFrame < cachedSubMesh._animationCount; iFrame++)
+			{
+				memcpy(subMesh->_animation[iFrame]._matrix, cachedSubMesh._animation + sizeof(float) * 16 * iFrame, sizeof(float) * 16);
+				memcpy(subMesh->_animationInverse[iFrame]._matrix, cachedSubMesh._animation + sizeof(float) * 16 * (cachedSubMesh._animationCount + iFrame), sizeof(float) * 16);
+			}
+			mesh->_subMeshes.push_back(subMesh);
+		}
+		glmUnmapFile(mapping);
+		return mesh;
+	}
+
+	// copy of a terrain allocated by the library, so every cached terrain is released the same way
+	inline Mesh* copyTerrain(const Mesh& source)
+	{
+		Mesh* mesh = new Mesh();
+		mesh->_startFrame = source._startFrame;
+		for (size_t iSubMesh = 0; iSubMesh < source._subMeshes.size(); iSubMesh++)
+		{
+			const SubMesh* sourceSubMesh = source._subMeshes[iSubMesh];
+			SubMesh* subMesh = new SubMesh();
+			subMesh->_vertexCount = sourceSubMesh->_vertexCount;
+			subMesh->_indiceCount = sourceSubMesh->_indiceCount;
+			subMesh->_vertices = new Vec3[subMesh->_vertexCount];
+			subMesh->_normals = sourceSubMesh->_normals ? new Vec3[subMesh->_vertexCount] : NULL;
+			subMesh->_indices = new unsigned int[subMesh->_indiceCount];
+			if (subMesh->_vertexCount)
+				memcpy(subMesh->_vertices, sourceSubMesh->_vertices, sizeof(Vec3) * subMesh->_vertexCount);
+			if (subMesh->_normals && subMesh->_vertexCount)
+				memcpy(subMesh->_normals, sourceSubMesh->_normals, sizeof(Vec3) * subMesh->_vertexCount);
+			if (subMesh->_indiceCount)
+				memcpy(subMesh->_indices, sourceSubMesh->_indices, sizeof(unsigned int) * subMesh->_indiceCount);
+			subMesh->_AABB = sourceSubMesh->_AABB;
+			subMesh->_worldToLocal = sourceSubMesh->_worldToLocal;
+			subMesh->_localToWorld = sourceSubMesh->_localToWorld;
+			subMesh->_animation = sourceSubMesh->_animation;
+			subMesh->_animationInverse = sourceSubMesh->_animationInverse;
+			mesh->_subMeshes.push_back(subMesh);
+		}
+		return mesh;
+	}
+
+	inline bool hasTerrainExtension(const char* terrainCompletePath, const char* extension)
+	{
+		size_t length = strlen(terrainCompletePath);
+		return length >= 4 && terrainCompletePath[length - 4] == '.'
+			&& tolower(terrainCompletePath[length - 3]) == extension[0] && tolower(terrainCompletePath[length - 2]) == extension[1] && tolower(terrainCompletePath[length - 1]) == extension[2];
+	}
+
+	inline bool isTerrainGTG(const char* terrainCompletePath)
+	{
+		return hasTerrainExtension(terrainCompletePath, "gtg");
+	}
+
+	inline bool isTerrainFBX(const char* terrainCompletePath)
+	{
+		return hasTerrainExtension(terrainCompletePath, "fbx");
+	}
+
+	// terrain.gtg -> terrain.gtb, terrain.fbx -> terrain.fbx.gtb
+	inline std::string getTerrainAABBCachePath(const char* terrainCompletePath)
+	{
+		std::string path(terrainCompletePath);
+		if (isTerrainGTG(terrainCompletePath))
+			path.resize(path.size() - 4);
+		return path + ".gtb";
+	}
+
+	// .gtg terrain read with glmReadTerrainFile and built on this side of the library : the AABB hierarchies come from the .gtb
+	// next to the terrain when its content hash matches, otherwise they are built and the .gtb is (re)written.
+	// Returns NULL on read failure, release with closeTerrainAssetCached
+	inline Mesh* loadTerrainGTGCached(const char* terrainCompletePath)
+	{
+		uint16_t meshCount = 0;
+		GlmFileMesh* fileMeshes = NULL;
+		if (glmReadTerrainFile(terrainCompletePath, meshCount, fileMeshes) != GIO_SUCCESS)
+			return NULL;
+
+		Mesh* mesh = new Mesh();
+		for (uint16_t iMesh = 0; iMesh < meshCount; iMesh++)
+		{
+			const GlmFileMesh& fileMesh = fileMeshes[iMesh];
+			SubMesh* subMesh = new SubMesh();
+			subMesh->_vertexCount = fileMesh._vertexCount;
+			subMesh->_indiceCount = fileMesh._triangleCount * 3;
+			subMesh->_vertices = new Vec3[subMesh->_vertexCount];
+			subMesh->_normals = new Vec3[subMesh->_vertexCount];
+			subMesh->_indices = new unsigned int[subMesh->_indiceCount];
+			for (uint32_t iVertex = 0; iVertex < fileMesh._vertexCount; iVertex++)
+			{
+				subMesh->_vertices[iVertex].setValues((float*)fileMesh._vertices[iVertex]._position);
+				subMesh->_normals[iVertex].setValues((float*)fileMesh._vertices[iVertex]._normal);
+			}
+			if (subMesh->_indiceCount)
+				memcpy(subMesh->_indices, fileMesh._vertexIndicesPerTriangle, sizeof(unsigned int) * subMesh->_indiceCount);
+			memcpy(subMesh->_localToWorld._matrix, fileMesh._defaultLocalToWorldMatrix, sizeof(float) * 16);
+			subMesh->_worldToLocal.inverse(subMesh->_localToWorld);
+			for (uint32_t iFrame = 0; iFrame < fileMesh._animTransformCount; iFrame++)
+			{
+				Matrix4 localToWorld, worldToLocal;
+				memcpy(localToWorld._matrix, fileMesh._animationLocalToWorldMatrix[iFrame], sizeof(float) * 16);
+				worldToLocal.inverse(localToWorld);
+				subMesh->_animation.push_back(worldToLocal);
+				subMesh->_animationInverse.push_back(localToWorld);
+			}
+			if (fileMesh._animTransformCount && mesh->_subMeshes.size() == 0)
+				mesh->_startFrame = (int)fileMesh._animStartTime;
+			mesh->_subMeshes.push_back(subMesh);
+		}
+		// the terrain file meshes are owned the same way as the geometry file ones
+		GlmGeometryFile terrainFile;
+		memset(&terrainFile, 0, sizeof(GlmGeometryFile));
+		terrainFile._meshCount = meshCount;
+		terrainFile._meshes = fileMeshes;
+		glmClearGeometryFile(terrainFile);
+
+		std::string cachePath = getTerrainAABBCachePath(terrainCompletePath);
+		if (!readTerrainAABBCache(cachePath.c_str(), *mesh))
+		{
+			for (size_t iSubMesh = 0; iSubMesh < mesh->_subMeshes.size(); iSubMesh++)
+			{
+				SubMesh* subMesh = mesh->_subMeshes[iSubMesh];
+				subMesh->_AABB.clear();
+				if (subMesh->_indiceCount)
+					computeAABBHierarchy<Vec3, Vec3>(subMesh->_vertices, (int*)subMesh->_indices, 0, (int)subMesh->_indiceCount, 0, subMesh->_AABB);
+			}
+			writeTerrainAABBCache(cachePath.c_str(), *mesh); // best effort, the terrain directory may be read only
+		}
+		return mesh;
+	}
+
+	// fbx terrain : read whole from the .gtb next to it when the cache was written for the same fbx bytes, without opening the fbx.
+	// Otherwise loadTerrainAsset builds it, the .gtb is (re)written and the terrain is copied on this side of the library.
+	// Returns NULL on read failure, release with closeTerrainAssetCached
+	inline Mesh* loadTerrainFBXCached(const char* terrainCompletePath)
+	{
+		uint32_t sourceHash;
+		if (!computeTerrainFileHash(terrainCompletePath, sourceHash))
+			return NULL;
+		std::string cachePath = getTerrainAABBCachePath(terrainCompletePath);
+		Mesh* mesh = readTerrainCache(cachePath.c_str(), sourceHash);
+		if (mesh)
+			return mesh;
+
+		Mesh* libraryMesh = loadTerrainAsset(terrainCompletePath);
+		if (libraryMesh == NULL)
+			return NULL;
+		mesh = copyTerrain(*libraryMesh);
+		closeTerrainAsset(libraryMesh);
+		writeTerrainAABBCache(cachePath.c_str(), *mesh, sourceHash); // best effort, the terrain directory may be read only
+		return mesh;
+	}
+
+	// loadTerrainAsset with the .gtb cache for .gtg and fbx terrains, other formats are loaded by the glmCrowdIO library
+	inline Mesh* loadTerrainAssetCached(const char* terrainCompletePath)
+	{
+		if (isTerrainGTG(terrainCompletePath))
+			return loadTerrainGTGCached(terrainCompletePath);
+		if (isTerrainFBX(terrainCompletePath))
+			return loadTerrainFBXCached(terrainCompletePath);
+		return loadTerrainAsset(terrainCompletePath);
+	}
+
+	// terrainCompletePath is the path given to loadTerrainAssetCached : .gtg and fbx meshes were allocated on this side of the library
+	inline void closeTerrainAssetCached(const Mesh* terrainMesh, const char* terrainCompletePath)
+	{
+		if (isTerrainGTG(terrainCompletePath) || isTerrainFBX(terrainCompletePath))
+			delete terrainMesh;
+		else
+			closeTerrainAsset(terrainMesh);
+	}
+
+	// glmRaycastClosest and glmTerrainSetFrame for CrowdTerrain meshes, used by the layout ground adaptation
+	inline int raycastTerrainClosest(void* terrain, const float* rayOrigin, const float* rayEnd, float* collisionPoint, float* collisionNormal, float* proxyMatrix, float* proxyMatrixInverse)
+	{
+		Mesh* mesh = (Mesh*)terrain;
+		Matrix4 matrix, matrixInverse;
+		if (proxyMatrix)
+			memcpy(matrix._matrix, proxyMatrix, sizeof(float) * 16);
+		if (proxyMatrixInverse)
+			memcpy(matrixInverse._matrix, proxyMatrixInverse, sizeof(float) * 16);
+		mesh->setProxyMatrices(proxyMatrix ? &matrix : NULL, proxyMatrixInverse ? &matrixInverse : NULL);
+
+		Vec3 point, normal;
+		if (!mesh->raycastClosest(Vec3(rayOrigin[0], rayOrigin[1], rayOrigin[2]), Vec3(rayEnd[0], rayEnd[1], rayEnd[2]), &point, &normal, proxyMatrix != NULL))
+			return 0;
+		memcpy(collisionPoint, &point.x, sizeof(float) * 3);
+		memcpy(collisionNormal, &normal.x, sizeof(float) * 3);
+		return 1;
+	}
+
+	inline void setTerrainFrame(void* terrainSource, void* terrainDestination, int frame)
+	{
+		if (terrainSource)
+			((Mesh*)terrainSource)->setFrame(frame);
+		if (terrainDestination && terrainDestination != terrainSource)
+			((Mesh*)terrainDestination)->setFrame(frame);
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Software occlusion culling
+//
+// The nearest visible entities (shrunk bounding boxes) and optionally the terrain are rasterized in a low resolution depth
+// buffer, then a max-depth hierarchy is built and the other entity boxes are tested against it. The test is conservative :
+// occluders only write the texels they fully cover, with the farthest depth of the triangle, and tested boxes use the texels
+// of their whole screen rectangle with their nearest depth. An entity is only culled if every texel it may touch is covered
+// by an occluder closer than any of its points.
+//
+
+struct GlmOcclusionSettings_0
+{
+	uint16_t _width; // depth buffer resolution, ex: 256 x 128
+	uint16_t _height;
+	uint32_t _occluderCount; // number of nearest entities rasterized as occluders
+	float _occluderScale; // occluder boxes are the entity boxes scaled by this factor, < 1 as entities do not fill their box
+	uint8_t _keepForSecondaryRays; // 1 : occluded entities are only hidden from the camera (cameraVisibilities), they keep _isVisible for shadows and GI
+};
+typedef GlmOcclusionSettings_0 GlmOcclusionSettings;
+
+struct GlmOcclusionBuffer_0
+{
+	uint16_t _levelCount;
+	uint16_t _widths[16];
+	uint16_t _heights[16];
+	float* _levels[16]; // level 0 is the depth buffer (NDC depth, 1 = far), next levels keep the max of 2x2 texels
+	float _clip[4][4]; // view projection matrix, [row][col]
+};
+typedef GlmOcclusionBuffer_0 GlmOcclusionBuffer;
+
+//----------------------------------------------------------------------------
+inline void glmDestroyOcclusionBuffer(GlmOcclusionBuffer* buffer)
+{
+	uint16_t iLevel;
+	for (iLevel = 0; iLevel < buffer->_levelCount; iLevel++)
+		GLMC_FREE(buffer->_levels[iLevel]);
+	memset(buffer, 0, sizeof(GlmOcclusionBuffer));
+}
+
+//----------------------------------------------------------------------------
+inline GlmGeometryGenerationStatus glmCreateOcclusionBuffer(GlmOcclusionBuffer* buffer, uint16_t width, uint16_t height, const float clip[4][4])
+{
+	uint16_t levelWidth = width ? width : 1;
+	uint16_t levelHeight = height ? height : 1;
+
+	memset(buffer, 0, sizeof(GlmOcclusionBuffer));
+	memcpy(buffer->_clip, clip, sizeof(float[4][4]));
+	for (;;)
+	{
+		uint32_t iTexel;
+		float* level = (float*)GLMC_MALLOC(sizeof(float) * levelWidth * levelHeight);
+		if (!level)
+		{
+			glmDestroyOcclusionBuffer(buffer);
+			return GIO_OUT_OF_MEMORY;
+		}
+		for (iTexel = 0; iTexel < (uint32_t)levelWidth * levelHeight; iTexel++)
+			level[iTexel] = 1.f;
+		buffer->_widths[buffer->_levelCount] = levelWidth;
+		buffer->_heights[buffer->_levelCount] = levelHeight;
+		buffer->_levels[buffer->_levelCount++] = level;
+		if ((levelWidth == 1 && levelHeight == 1) || buffer->_levelCount == 16)
+			break;
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+	return GIO_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// screen x, y in pixels and NDC depth, returns 0 if the point is behind the camera
+inline int glmOcclusionProject(const GlmOcclusionBuffer* buffer, const float* point, float* screen)
+{
+	const float(*m)[4] = buffer->_clip;
+	float clip[4];
+	int row;
+	for (row = 0; row < 4; row++)
+		clip[row] = m[row][0] * point[0] + m[row][1] * point[1] + m[row][2] * point[2] + m[row][3];
+	if (clip[3] <= 1.0e-6f)
+		return 0;
+	screen[0] = (clip[0] / clip[3] * 0.5f + 0.5f) * buffer->_widths[0];
+	screen[1] = (0.5f - clip[1] / clip[3] * 0.5f) * buffer->_heights[0];
+	screen[2] = clip[2] / clip[3];
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// texels fully inside the triangle get min(current, farthest triangle depth). A texel is fully inside when each edge function,
+// evaluated at its center, is at least the half texel extent of the edge gradient : e(center) >= 0.5 * (|dx| + |dy|)
+inline void glmRasterizeOcclusionTriangle(GlmOcclusionBuffer* buffer, const float* v0, const float* v1, const float* v2)
+{
+	float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+	float depth = v0[2] > v1[2] ? v0[2] : v1[2];
+	float minX = v0[0], maxX = v0[0], minY = v0[1], maxY = v0[1];
+	const float* a = v0;
+	const float* b = v1;
+	const float* c = v2;
+	float* depthBuffer = buffer->_levels[0];
+	int width = buffer->_widths[0];
+	float margin0, margin1, margin2;
+	int x0, x1, y0, y1, x, y;
+
+	if (fabsf(area) < 1.0e-8f)
+		return;
+	if (area < 0.f)
+	{
+		// counter clockwise order for the edge functions
+		b = v2;
+		c = v1;
+	}
+	depth = depth > v2[2] ? depth : v2[2];
+	if (depth < -1.f || depth > 1.f)
+		return;
+
+	minX = v1[0] < minX ? v1[0] : minX; minX = v2[0] < minX ? v2[0] : minX;
+	maxX = v1[0] > maxX ? v1[0] : maxX; maxX = v2[0] > maxX ? v2[0] : maxX;
+	minY = v1[1] < minY ? v1[1] : minY; minY = v2[1] < minY ? v2[1] : minY;
+	maxY = v1[1] > maxY ? v1[1] : maxY; maxY = v2[1] > maxY ? v2[1] : maxY;
+	x0 = minX < 0.f ? 0 : (int)minX;
+	y0 = minY < 0.f ? 0 : (int)minY;
+	x1 = maxX >= (float)width ? width - 1 : (int)maxX;
+	y1 = maxY >= (float)buffer->_heights[0] ? buffer->_heights[0] - 1 : (int)maxY;
+	margin0 = 0.5f * (fabsf(b[0] - a[0]) + fabsf(b[1] - a[1]));
+	margin1 = 0.5f * (fabsf(c[0] - b[0]) + fabsf(c[1] - b[1]));
+	margin2 = 0.5f * (fabsf(a[0] - c[0]) + fabsf(a[1] - c[1]));
+
+	for (y = y0; y <= y1; y++)
+	{
+		float py = (float)y + 0.5f;
+		float* row = depthBuffer + y * width;
+		x = x0;
+#ifdef GIO_USE_SSE
+		{
+			__m128 depth4 = _mm_set1_ps(depth);
+			__m128 zero = _mm_setzero_ps();
+			// edge function minus its margin e(px) = (b - a) x (p - a) - margin = ex * px + e0, linear in px
+			__m128 e0x = _mm_set1_ps(-(b[1] - a[1])), e0c = _mm_set1_ps((b[0] - a[0]) * (py - a[1]) + (b[1] - a[1]) * a[0] - margin0);
+			__m128 e1x = _mm_set1_ps(-(c[1] - b[1])), e1c = _mm_set1_ps((c[0] - b[0]) * (py - b[1]) + (c[1] - b[1]) * b[0] - margin1);
+			__m128 e2x = _mm_set1_ps(-(a[1] - c[1])), e2c = _mm_set1_ps((a[0] - c[0]) * (py - c[1]) + (a[1] - c[1]) * c[0] - margin2);
+			for (; x + 3 <= x1; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x + 0.5f), _mm_set_ps(3.f, 2.f, 1.f, 0.f));
+				__m128 inside = _mm_and_ps(_mm_and_ps(
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e0x, px), e0c), zero),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e1x, px), e1c), zero)),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e2x, px), e2c), zero));
+				__m128 current = _mm_loadu_ps(row + x);
+				__m128 written = _mm_min_ps(current, depth4);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, written), _mm_andnot_ps(inside, current)));
+			}
+		}
+#endif
+		for (; x <= x1; x++)
+		{
+			float px = (float)x + 0.5f;
+			float e0 = (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]);
+			float e1 = (c[0] - b[0]) * (py - b[1]) - (c[1] - b[1]) * (px - b[0]);
+			float e2 = (a[0] - c[0]) * (py - c[1]) - (a[1] - c[1]) * (px - c[0]);
+			if (e0 >= margin0 && e1 >= margin1 && e2 >= margin2 && depth < row[x])
+				row[x] = depth;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+inline void glmRasterizeOcclusionBox(GlmOcclusionBuffer* buffer, const float* center, const float* extents)
+{
+	static const int faces[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+	float corners[8][3];
+	int iCorner, iFace;
+
+	for (iCorner = 0; iCorner < 8; iCorner++)
+	{
+		float corner[3];
+		corner[0] = center[0] + ((iCorner & 1) ? extents[0] : -extents[0]);
+		corner[1] = center[1] + ((iCorner & 2) ? extents[1] : -extents[1]);
+		corner[2] = center[2] + ((iCorner & 4) ? extents[2] : -extents[2]);
+		if (!glmOcclusionProject(buffer, corner, corners[iCorner]))
+			return; // crossing the camera plane : not used as occluder
+	}
+	for (iFace = 0; iFace < 6; iFace++)
+	{
+		glmRasterizeOcclusionTriangle(buffer, corners[faces[iFace][0]], corners[faces[iFace][1]], corners[faces[iFace][2]]);
+		glmRasterizeOcclusionTriangle(buffer, corners[faces[iFace][0]], corners[faces[iFace][2]], corners[faces[iFace][3]]);
+	}
+}
+
+//----------------------------------------------------------------------------
+inline void glmRasterizeOcclusionTerrain(GlmOcclusionBuffer* buffer, const CrowdTerrain::Mesh* terrain)
+{
+	unsigned int iSubMesh, iIndex;
+	for (iSubMesh = 0; iSubMesh < terrain->_subMeshes.size(); iSubMesh++)
+	{
+		const CrowdTerrain::SubMesh* subMesh = terrain->_subMeshes[iSubMesh];
+		for (iIndex = 0; iIndex + 2 < subMesh->_indiceCount; iIndex += 3)
+		{
+			float screen[3][3];
+			int iVertex, projected = 1;
+			for (iVertex = 0; iVertex < 3 && projected; iVertex++)
+			{
+				CrowdTerrain::Vec3 world = subMesh->_localToWorld.transformPoint(subMesh->_vertices[subMesh->_indices[iIndex + iVertex]]);
+				projected = glmOcclusionProject(buffer, &world.x, screen[iVertex]);
+			}
+			if (projected)
+				glmRasterizeOcclusionTriangle(buffer, screen[0], screen[1], screen[2]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+inline void glmBuildOcclusionHierarchy(GlmOcclusionBuffer* buffer)
+{
+	uint16_t iLevel;
+	for (iLevel = 1; iLevel < buffer->_levelCount; iLevel++)
+	{
+		const float* source = buffer->_levels[iLevel - 1];
+		float* destination = buffer->_levels[iLevel];
+		int sourceWidth = buffer->_widths[iLevel - 1];
+		int sourceHeight = buffer->_heights[iLevel - 1];
+		int x, y;
+		for (y = 0; y < buffer->_heights[iLevel]; y++)
+		{
+			for (x = 0; x < buffer->_widths[iLevel]; x++)
+			{
+				int sx = x * 2, sy = y * 2;
+				int sx1 = (sx + 1 < sourceWidth) ? sx + 1 : sx;
+				int sy1 = (sy + 1 < sourceHeight) ? sy + 1 : sy;
+				float d0 = source[sy * sourceWidth + sx], d1 = source[sy * sourceWidth + sx1];
+				float d2 = source[sy1 * sourceWidth + sx], d3 = source[sy1 * sourceWidth + sx1];
+				d0 = d0 > d1 ? d0 : d1;
+				d2 = d2 > d3 ? d2 : d3;
+				destination[y * buffer->_widths[iLevel] + x] = d0 > d2 ? d0 : d2;
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// 1 if the box is fully hidden by the rasterized occluders, glmBuildOcclusionHierarchy must have been called
+inline int glmTestOcclusionBox(const GlmOcclusionBuffer* buffer, const float* center, const float* extents)
+{
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = FLT_MAX;
+	int iCorner, x0, y0, x1, y1, x, y;
+	uint16_t iLevel = 0;
+
+	for (iCorner = 0; iCorner < 8; iCorner++)
+	{
+		float corner[3], screen[3];
+		corner[0] = center[0] + ((iCorner & 1) ? extents[0] : -extents[0]);
+		corner[1] = center[1] + ((iCorner & 2) ? extents[1] : -extents[1]);
+		corner[2] = center[2] + ((iCorner & 4) ? extents[2] : -extents[2]);
+		if (!glmOcclusionProject(buffer, corner, screen))
+			return 0;
+		minX = screen[0] < minX ? screen[0] : minX; maxX = screen[0] > maxX ? screen[0] : maxX;
+		minY = screen[1] < minY ? screen[1] : minY; maxY = screen[1] > maxY ? screen[1] : maxY;
+		nearest = screen[2] < nearest ? screen[2] : nearest;
+	}
+	if (maxX < 0.f || maxY < 0.f || minX >= buffer->_widths[0] || minY >= buffer->_heights[0])
+		return 0; // off screen, frustum culling decides
+
+	x0 = minX < 0.f ? 0 : (int)minX;
+	y0 = minY < 0.f ? 0 : (int)minY;
+	x1 = maxX >= buffer->_widths[0] ? buffer->_widths[0] - 1 : (int)maxX;
+	y1 = maxY >= buffer->_heights[0] ? buffer->_heights[0] - 1 : (int)maxY;
+	// coarsest level where the rectangle covers at most 2x2 texels
+	while (iLevel + 1 < buffer->_levelCount && (x1 - x0 > 1 || y1 - y0 > 1))
+	{
+		iLevel++;
+		x0 /= 2; y0 /= 2; x1 /= 2; y1 /= 2;
+	}
+	for (y = y0; y <= y1; y++)
+	{
+		for (x = x0; x <= x1; x++)
+		{
+			if (nearest <= buffer->_levels[iLevel][y * buffer->_widths[iLevel] + x])
+				return 0;
+		}
+	}
+	return 1;
+}
+
+//----------------------------------------------------------------------------
+// orders entity indices by distance to the camera
+struct GlmOcclusionDistanceLess
+{
+	const float* _distances; // array size = context->_entityCount
+	bool operator()(uint32_t a, uint32_t b) const
+	{
+		return _distances[a] < _distances[b] || (_distances[a] == _distances[b] && a < b);
+	}
 };
 
+//----------------------------------------------------------------------------
+// cameraVisibilities : 1 if the entity is in the frustum and not occluded, array size = context->_entityCount. Occluded entities also
+// get _isVisible = 0 unless settings->_keepForSecondaryRays. Entities already invisible (frustum culling) are skipped. Like
+// glmCullContextEntities nothing is culled if _enableFrustumCulling is off, every entity is visible from the camera. terrain can be NULL
+inline GlmGeometryGenerationStatus glmOcclusionCullContextEntities(GlmGeometryGenerationContext* context, const GlmOcclusionSettings* settings, const CrowdTerrain::Mesh* terrain, uint8_t* cameraVisibilities)
+{
+	GlmOcclusionBuffer buffer;
+	GlmGeometryGenerationStatus status;
+	GlmOcclusionDistanceLess distanceLess;
+	float clip[4][4];
+	float* distances; // squared distance to the camera, array size = context->_entityCount
+	uint32_t* sortedEntities; // visible entity indices, nearest first
+	uint32_t visibleCount = 0;
+	uint32_t iEntity, iSorted;
+	int i;
+
+	if (!context->_enableFrustumCulling)
+	{
+		memset(cameraVisibilities, 1, context->_entityCount);
+		return GIO_SUCCESS;
+	}
+
+	glmComputeViewProjectionMatrix(context, clip);
+	status = glmCreateOcclusionBuffer(&buffer, settings->_width, settings->_height, (const float(*)[4])clip);
+	if (status != GIO_SUCCESS)
+		return status;
+	distances = (float*)GLMC_MALLOC(sizeof(float) * (context->_entityCount + 1));
+	sortedEntities = (uint32_t*)GLMC_MALLOC(sizeof(uint32_t) * (context->_entityCount + 1));
+	if (!distances || !sortedEntities)
+	{
+		GLMC_FREE(distances);
+		GLMC_FREE(sortedEntities);
+		glmDestroyOcclusionBuffer(&buffer);
+		return GIO_OUT_OF_MEMORY;
+	}
+
+	for (iEntity = 0; iEntity < context->_entityCount; iEntity++)
+	{
+		const GlmEntityBoundingBox* bbox = &context->_entityBBoxes[iEntity];
+		float dx = bbox->_entityOrigin[0] - context->_cameraWorldPosition[0];
+		float dy = bbox->_entityOrigin[1] - context->_cameraWorldPosition[1];
+		float dz = bbox->_entityOrigin[2] - context->_cameraWorldPosition[2];
+		distances[iEntity] = dx * dx + dy * dy + dz * dz;
+		cameraVisibilities[iEntity] = bbox->_isVisible ? 1 : 0;
+		if (bbox->_isVisible)
+			sortedEntities[visibleCount++] = iEntity;
+	}
+	distanceLess._distances = distances;
+	std::sort(sortedEntities, sortedEntities + visibleCount, distanceLess);
+
+	// occluders
+	if (terrain)
+		glmRasterizeOcclusionTerrain(&buffer, terrain);
+	for (iSorted = 0; iSorted < visibleCount && iSorted < settings->_occluderCount; iSorted++)
+	{
+		const GlmEntityBoundingBox* bbox = &context->_entityBBoxes[sortedEntities[iSorted]];
+		float scale = ((bbox->_entityScale > 0.f) ? bbox->_entityScale : 1.f) * settings->_occluderScale;
+		float extents[3];
+		for (i = 0; i < 3; i++)
+			extents[i] = bbox->_boundingBoxHalfExtents[i] * scale;
+		glmRasterizeOcclusionBox(&buffer, bbox->_entityOrigin, extents);
+	}
+	glmBuildOcclusionHierarchy(&buffer);
+
+	// occludees
+	for (iSorted = 0; iSorted < visibleCount; iSorted++)
+	{
+		uint32_t entityIndex = sortedEntities[iSorted];
+		GlmEntityBoundingBox* bbox = &context->_entityBBoxes[entityIndex];
+		float scale = (bbox->_entityScale > 0.f) ? bbox->_entityScale : 1.f;
+		float extents[3];
+		for (i = 0; i < 3; i++)
+			extents[i] = bbox->_boundingBoxHalfExtents[i] * scale;
+		if (glmTestOcclusionBox(&buffer, bbox->_entityOrigin, extents))
+		{
+			cameraVisibilities[entityIndex] = 0;
+			if (!settings->_keepForSecondaryRays)
+				bbox->_isVisible = 0;
+		}
+	}
+
+	GLMC_FREE(distances);
+	GLMC_FREE(sortedEntities);
+	glmDestroyOcclusionBuffer(&buffer);
+	return GIO_SUCCESS;
+}
+
 #endif // GLM_CROWD_IO_INCLUDE_H
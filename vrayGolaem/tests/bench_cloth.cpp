@@ -0,0 +1,124 @@
+// Cloth decoding (48 bits quantized vertices) and cloth transform of glmCreateModifiedFrameData : single thread, threads created per call
+// (the former glmParallelForThreads) and the glmParallelForThreads pool. Outputs are checked identical
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static const char* glmTestFramePathModel = "cloth_missing.%d.gscf";
+
+// [0, count) split in contiguous ranges, one thread created per range and joined at the end of each call
+static void glmTestParallelForSpawn(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	if (threadCount > count)
+		threadCount = count;
+	if (threadCount <= 1)
+	{
+		task(userData, 0, count);
+		return;
+	}
+	unsigned int countPerThread = (count + threadCount - 1) / threadCount;
+	std::vector<std::thread> threads;
+	for (unsigned int first = 0; first + countPerThread < count; first += countPerThread)
+		threads.push_back(std::thread(task, userData, first, first + countPerThread));
+	task(userData, (unsigned int)threads.size() * countPerThread, count);
+	for (size_t iThread = 0; iThread < threads.size(); iThread++)
+		threads[iThread].join();
+}
+
+typedef void(*GlmTestParallelFor)(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count);
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	uint32_t entityCount = quick ? 2000 : 20000;
+	uint32_t clothVertexCount = quick ? 64 : 256;
+	int repeatCount = quick ? 3 : 20;
+	const char* modeNames[3] = { "single thread", "threads per call", "thread pool" };
+	GlmTestParallelFor modes[3] = { NULL, glmTestParallelForSpawn, glmParallelForThreads };
+	uint32_t randomState = 0xc107u;
+
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, entityCount, 4, 20);
+	glmTestCreateFrame(&frameData, simulationData, 0x77u, 1, clothVertexCount);
+
+	// decoding : every cloth entity of the frame, vertices quantized relative to the entity reference
+	GlmClothDecodeTask decodeTask;
+	std::vector<uint16_t> compressedVertices(frameData->_clothTotalVertices * 3);
+	std::vector<uint32_t> firstVertex(frameData->_clothEntityCount + 1);
+	for (size_t i = 0; i < compressedVertices.size(); i++)
+		compressedVertices[i] = (uint16_t)(glmTestRandom(&randomState) * 65535.f);
+	for (uint32_t iClothEntity = 0; iClothEntity <= frameData->_clothEntityCount; iClothEntity++)
+		firstVertex[iClothEntity] = iClothEntity * clothVertexCount;
+	decodeTask._frameData = frameData;
+	decodeTask._compressedVertices = (uint16_t(*)[3])&compressedVertices[0];
+	decodeTask._firstVertex = &firstVertex[0];
+
+	std::vector<float> referenceVertices;
+	for (int iMode = 0; iMode < 3; iMode++)
+	{
+		glmParallelFor = modes[iMode];
+		memset(frameData->_clothVertices, 0, frameData->_clothTotalVertices * sizeof(float[3]));
+		double start = glmTestSeconds();
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+			glmRunParallelFor(glmDecodeClothEntities, &decodeTask, frameData->_clothEntityCount);
+		double seconds = (glmTestSeconds() - start) / repeatCount;
+		if (iMode == 0)
+			referenceVertices.assign(frameData->_clothVertices[0], frameData->_clothVertices[0] + frameData->_clothTotalVertices * 3);
+		else
+			GLM_TEST_CHECK(memcmp(&referenceVertices[0], frameData->_clothVertices, referenceVertices.size() * sizeof(float)) == 0);
+		printf("decode    %-16s %8.3f ms, %7.1f Mverts/s\n", modeNames[iMode], seconds * 1e3, frameData->_clothTotalVertices / seconds * 1e-6);
+	}
+	glmParallelFor = NULL;
+
+	// transform : a translated and rotated crowd, cloth follows its entity
+	GlmHistory* history;
+	glmTestCreateHistory(&history, simulationData, 2, entityCount, 0);
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		history->_entityIds[iEntity] = simulationData->_entityIds[iEntity];
+	for (int iTransform = 0; iTransform < 2; iTransform++)
+		history->_entityArrayCount[iTransform] = entityCount;
+	history->_transformTypes[0] = SimulationCacheTranslate;
+	history->_transformTranslate[0][0] = 10.f;
+	history->_transformTypes[1] = SimulationCacheRotate;
+	history->_transformRotate[1][1] = sinf(0.3f);
+	history->_transformRotate[1][3] = cosf(0.3f);
+
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* referenceFrameData = NULL;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
+	for (int iMode = 0; iMode < 3; iMode++)
+	{
+		glmParallelFor = modes[iMode];
+		double seconds = 0.;
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+		{
+			GlmFrameData* frameDataOut;
+			double start = glmTestSeconds();
+			GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+			seconds += glmTestSeconds() - start;
+			if (referenceFrameData == NULL)
+			{
+				referenceFrameData = frameDataOut;
+				continue;
+			}
+			GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, referenceFrameData, simulationDataOut, frameDataOut));
+			glmDestroyFrameData(&frameDataOut, simulationDataOut);
+		}
+		printf("transform %-16s %8.3f ms per frame (%u cloth entities, %u vertices)\n", modeNames[iMode], seconds / repeatCount * 1e3, frameData->_clothEntityCount, frameData->_clothTotalVertices);
+	}
+	glmParallelFor = NULL;
+	glmStopParallelForThreads();
+
+	glmDestroyFrameData(&referenceFrameData, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+	glmDestroyHistory(&history);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
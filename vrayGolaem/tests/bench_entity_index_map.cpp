@@ -0,0 +1,102 @@
+// GlmEntityIndexMap entity id lookups against the glmFindEntityInSimulation linear search they replace : duplicated ids
+// resolve to their first transform, missing ids to -1, every lookup is checked identical to the linear one
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+// one linear lookup per id, -1 for the missing ones
+static void glmTestFindLinear(std::vector<GlmEntityTransform>& transforms, const std::vector<int64_t>& ids, std::vector<int>& indices)
+{
+	for (size_t iId = 0; iId < ids.size(); iId++)
+		indices[iId] = glmFindEntityInSimulation(&transforms[0], (unsigned int)transforms.size(), ids[iId]);
+}
+
+static void glmTestFindMap(const GlmEntityIndexMap* map, const std::vector<int64_t>& ids, std::vector<int>& indices)
+{
+	for (size_t iId = 0; iId < ids.size(); iId++)
+		indices[iId] = glmFindEntityIndex(map, ids[iId]);
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	unsigned int entityCount = quick ? 2000 : 50000;
+	unsigned int lookupCount = quick ? 4000 : 100000;
+	uint32_t randomState = 0x1234567u;
+
+	// edge cases : duplicated ids keep the first index, ids colliding in the table, id 0, negative and 64 bits ids
+	{
+		GlmEntityTransform transforms[8];
+		memset(transforms, 0, sizeof(transforms));
+		const int64_t ids[8] = { 1001, 0, -5, 1001, (int64_t)1 << 40, 1001, ((int64_t)1 << 40) + 16, 7 };
+		for (int i = 0; i < 8; i++)
+			transforms[i]._entityId = ids[i];
+		GlmEntityIndexMap map;
+		glmCreateEntityIndexMap(&map, transforms, 8);
+		GLM_TEST_CHECK(map._bucketMask + 1 >= 16);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, 1001) == 0);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, 0) == 1);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, -5) == 2);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, (int64_t)1 << 40) == 4);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, ((int64_t)1 << 40) + 16) == 6);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, 7) == 7);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, 1002) == -1);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, -1) == -1);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, (int64_t)1 << 41) == -1);
+		glmDestroyEntityIndexMap(&map);
+		GLM_TEST_CHECK(map._entityIds == NULL && map._indices == NULL);
+
+		// empty map : every id is missing
+		glmCreateEntityIndexMap(&map, transforms, 0);
+		GLM_TEST_CHECK(glmFindEntityIndex(&map, 1001) == -1);
+		glmDestroyEntityIndexMap(&map);
+	}
+
+	// layout like ids : entity i has id 1000 + 3 * i, 1 in 10 duplicated further in the list
+	std::vector<GlmEntityTransform> transforms(entityCount);
+	memset(&transforms[0], 0, entityCount * sizeof(GlmEntityTransform));
+	unsigned int sourceCount = entityCount - entityCount / 10;
+	for (unsigned int iEntity = 0; iEntity < sourceCount; iEntity++)
+		transforms[iEntity]._entityId = 1000 + 3 * (int64_t)iEntity;
+	for (unsigned int iEntity = sourceCount; iEntity < entityCount; iEntity++)
+		transforms[iEntity]._entityId = transforms[(unsigned int)(glmTestRandom(&randomState) * sourceCount)]._entityId;
+
+	// half the lookups present, a quarter between two ids, a quarter out of range
+	std::vector<int64_t> ids(lookupCount);
+	for (unsigned int iLookup = 0; iLookup < lookupCount; iLookup++)
+	{
+		int64_t index = (int64_t)(glmTestRandom(&randomState) * sourceCount);
+		switch (iLookup % 4)
+		{
+		case 0:
+		case 1: ids[iLookup] = 1000 + 3 * index; break;
+		case 2: ids[iLookup] = 1001 + 3 * index; break;
+		default: ids[iLookup] = -1000 - index; break;
+		}
+	}
+
+	std::vector<int> linearIndices(lookupCount), mapIndices(lookupCount);
+	double start = glmTestSeconds();
+	glmTestFindLinear(transforms, ids, linearIndices);
+	double linearSeconds = glmTestSeconds() - start;
+
+	GlmEntityIndexMap map;
+	start = glmTestSeconds();
+	glmCreateEntityIndexMap(&map, &transforms[0], entityCount);
+	double buildSeconds = glmTestSeconds() - start;
+	start = glmTestSeconds();
+	glmTestFindMap(&map, ids, mapIndices);
+	double mapSeconds = glmTestSeconds() - start;
+	glmDestroyEntityIndexMap(&map);
+
+	GLM_TEST_CHECK(linearIndices == mapIndices);
+	unsigned int missingCount = 0;
+	for (unsigned int iLookup = 0; iLookup < lookupCount; iLookup++)
+		missingCount += mapIndices[iLookup] == -1;
+	GLM_TEST_CHECK(missingCount == lookupCount / 2);
+
+	printf("%u entities (%u duplicated), %u lookups, %u missing\n", entityCount, entityCount - sourceCount, lookupCount, missingCount);
+	printf("linear search  %10.0f lookups/s\n", lookupCount / linearSeconds);
+	printf("index map      %10.0f lookups/s, built in %.3f ms\n", lookupCount / mapSeconds, buildSeconds * 1000.);
+	return glmTestResult();
+}
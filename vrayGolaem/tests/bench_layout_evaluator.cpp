@@ -0,0 +1,220 @@
+// Layout edits on a 100k entities crowd with duplicates and cloth : full evaluation against glmUpdateLayoutEvaluator incremental updates.
+// Every update is checked bit exact against a full evaluation of the same history and frame, deferred duplicates once materialized
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static const char* glmTestFramePathModel = "layout_evaluator_missing.%d.gscf";
+
+static void glmTestEvaluateLayout(GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history, int currentFrame, GlmSimulationData** simulationDataOut, GlmFrameData** frameDataOut)
+{
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, simulationDataOut);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, *simulationDataOut, frameDataOut, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+}
+
+// evaluator result against a full evaluation
+static void glmTestCheckEvaluator(const GlmLayoutEvaluator* evaluator, GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history, int currentFrame)
+{
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	glmTestEvaluateLayout(simulationData, frameData, history, currentFrame, &simulationDataOut, &frameDataOut);
+	GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, evaluator->_simulationDataOut, evaluator->_frameDataOut));
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+}
+
+// deferred evaluator result, materialized and through the root bone accessor, against a full evaluation
+static void glmTestCheckDeferredEvaluator(const GlmLayoutEvaluator* evaluator, GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history, int currentFrame)
+{
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	GlmFrameData* materializedFrameData;
+	GLM_TEST_CHECK(evaluator->_frameDataOut == NULL && evaluator->_deferredFrameDataOut != NULL);
+	glmTestEvaluateLayout(simulationData, frameData, history, currentFrame, &simulationDataOut, &frameDataOut);
+	glmMaterializeDeferredFrameData(evaluator->_deferredFrameDataOut, evaluator->_simulationDataOut, &materializedFrameData);
+	GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, evaluator->_simulationDataOut, materializedFrameData));
+
+	int sameRoots = 1;
+	for (uint32_t iEntity = 0; iEntity < simulationDataOut->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationDataOut->_entityTypes[iEntity];
+		uint32_t offset = simulationDataOut->_iBoneOffsetPerEntityType[entityType] + simulationDataOut->_boneCount[entityType] * simulationDataOut->_indexInEntityType[iEntity];
+		float position[3], orientation[4];
+		glmGetDeferredEntityRootBone(evaluator->_deferredFrameDataOut, iEntity, position, orientation);
+		sameRoots &= memcmp(position, frameDataOut->_bonePositions[offset], sizeof(position)) == 0 && memcmp(orientation, frameDataOut->_boneOrientations[offset], sizeof(orientation)) == 0;
+	}
+	GLM_TEST_CHECK(sameRoots);
+
+	glmDestroyFrameData(&materializedFrameData, evaluator->_simulationDataOut);
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	uint32_t entityCount = quick ? 10000 : 100000;
+	int repeatCount = quick ? 2 : 10;
+	const uint32_t duplicateCount = 100;
+	const uint32_t editedCount = 50;
+	const int currentFrame = 1;
+
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	GlmFrameData* nextFrameData;
+	glmTestCreateSimulation(&simulationData, entityCount, 4, 20);
+	glmTestCreateFrame(&frameData, simulationData, 0x1234u, 10, 64);
+	glmTestCreateFrame(&nextFrameData, simulationData, 0x4321u, 10, 64);
+
+	// translate all, rotate 1/7, scale 1/5, duplicate the first entities, kill 1/97, then the edited transforms :
+	// translate entities from the middle of the crowd (cloth every 5th), translate one duplicated source
+	enum { TranslateAll, RotateSome, ScaleSome, Duplicate, KillSome, EditMiddle, EditDuplicated, TransformCount };
+	std::vector<int64_t> entityIds;
+	std::vector<uint32_t> starts(TransformCount), counts(TransformCount);
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+	{
+		starts[iTransform] = (uint32_t)entityIds.size();
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			int used = (iTransform == TranslateAll) || (iTransform == RotateSome && iEntity % 7 == 3) || (iTransform == ScaleSome && iEntity % 5 == 1)
+				|| (iTransform == Duplicate && iEntity < duplicateCount) || (iTransform == KillSome && iEntity % 97 == 42)
+				|| (iTransform == EditMiddle && iEntity >= entityCount / 2 && iEntity < entityCount / 2 + 2 * editedCount && iEntity % 2 == 0)
+				|| (iTransform == EditDuplicated && iEntity == 1);
+			if (used)
+				entityIds.push_back(simulationData->_entityIds[iEntity]);
+		}
+		counts[iTransform] = (uint32_t)entityIds.size() - starts[iTransform];
+	}
+
+	GlmHistory* history;
+	glmTestCreateHistory(&history, simulationData, TransformCount, (uint32_t)entityIds.size(), duplicateCount);
+	memcpy(history->_entityIds, &entityIds[0], entityIds.size() * sizeof(int64_t));
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+	{
+		history->_entityArrayStartIndex[iTransform] = starts[iTransform];
+		history->_entityArrayCount[iTransform] = counts[iTransform];
+	}
+	for (uint32_t iDuplicate = 0; iDuplicate < duplicateCount; iDuplicate++)
+		history->_duplicatedEntityIds[iDuplicate] = 1000000000 + (int64_t)iDuplicate;
+	history->_transformTypes[TranslateAll] = SimulationCacheTranslate;
+	history->_transformTranslate[TranslateAll][0] = 10.f;
+	history->_transformTypes[RotateSome] = SimulationCacheRotate;
+	history->_transformRotate[RotateSome][1] = sinf(0.25f);
+	history->_transformRotate[RotateSome][3] = cosf(0.25f);
+	history->_transformTypes[ScaleSome] = SimulationCacheScale;
+	history->_scale[ScaleSome] = 1.25f;
+	history->_transformTypes[Duplicate] = SimulationCacheDuplicate;
+	history->_duplicatedEntityArrayCount[Duplicate] = duplicateCount;
+	history->_transformTypes[KillSome] = SimulationCacheKill;
+	history->_transformTypes[EditMiddle] = SimulationCacheTranslate;
+	history->_transformTypes[EditDuplicated] = SimulationCacheTranslate;
+
+	// full evaluation
+	GlmLayoutEvaluator* evaluator;
+	glmCreateLayoutEvaluator(&evaluator, simulationData);
+	double start = glmTestSeconds();
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	double fullSeconds = glmTestSeconds() - start;
+	GLM_TEST_CHECK(evaluator->_entityTransformCount == (int)(entityCount + duplicateCount));
+	GLM_TEST_CHECK(evaluator->_updatedTransformCount == entityCount + duplicateCount);
+	GLM_TEST_CHECK(evaluator->_frameDataOut->_clothEntityCount == entityCount / 10 + duplicateCount / 10);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history, currentFrame);
+
+	// nothing changed
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedTransformCount == 0 && evaluator->_updatedEntityCount == 0);
+
+	// edited entities only, cloth included
+	double incrementalSeconds = 0.;
+	for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+	{
+		history->_transformTranslate[EditMiddle][0] = 1.f + (float)iRepeat;
+		start = glmTestSeconds();
+		GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+		incrementalSeconds += glmTestSeconds() - start;
+		GLM_TEST_CHECK(evaluator->_updatedTransformCount == editedCount && evaluator->_updatedEntityCount == editedCount);
+	}
+	incrementalSeconds /= repeatCount;
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history, currentFrame);
+
+	// a duplicated source is re-evaluated with its duplicate
+	history->_transformTranslate[EditDuplicated][2] = -3.f;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedEntityCount == 2);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history, currentFrame);
+
+	// disabled transform : scales and the per type hierarchy length change, duplicates of the scaled entities follow
+	history->_active[ScaleSome] = 0;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedEntityCount == (entityCount + 3) / 5 + duplicateCount / 5);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history, currentFrame);
+	history->_active[ScaleSome] = 1;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history, currentFrame);
+
+	// frame change : transforms are kept, frame data of all the entities
+	start = glmTestSeconds();
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, nextFrameData, history, currentFrame + 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	double frameSeconds = glmTestSeconds() - start;
+	GLM_TEST_CHECK(evaluator->_updatedTransformCount == 0 && evaluator->_updatedEntityCount == entityCount + duplicateCount);
+	glmTestCheckEvaluator(evaluator, simulationData, nextFrameData, history, currentFrame + 1);
+
+	// reference timing : what each edit cost without the evaluator
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	start = glmTestSeconds();
+	glmTestEvaluateLayout(simulationData, frameData, history, currentFrame, &simulationDataOut, &frameDataOut);
+	double referenceSeconds = glmTestSeconds() - start;
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+
+	printf("%u entities, %u duplicates : full evaluation %.2f ms (evaluator first update %.2f ms), %u edited entities %.3f ms, frame change %.2f ms\n",
+		entityCount, duplicateCount, referenceSeconds * 1e3, fullSeconds * 1e3, editedCount, incrementalSeconds * 1e3, frameSeconds * 1e3);
+
+	glmDestroyLayoutEvaluator(&evaluator);
+	GLM_TEST_CHECK(evaluator == NULL);
+
+	// deferred duplicates, what the plugin displays : cloth keeps every entity materialized, these frames have none
+	GlmFrameData* plainFrameData;
+	GlmFrameData* nextPlainFrameData;
+	glmTestCreateFrame(&plainFrameData, simulationData, 0x2468u, 0, 0);
+	glmTestCreateFrame(&nextPlainFrameData, simulationData, 0x8642u, 0, 0);
+	glmCreateLayoutEvaluator(&evaluator, simulationData);
+	evaluator->_deferDuplicates = 1;
+	start = glmTestSeconds();
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, plainFrameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	double deferredFullSeconds = glmTestSeconds() - start;
+	GLM_TEST_CHECK(evaluator->_deferredFrameDataOut->_deferredEntityCount > duplicateCount / 2);
+	glmTestCheckDeferredEvaluator(evaluator, simulationData, plainFrameData, history, currentFrame);
+
+	history->_transformTranslate[EditMiddle][1] = 2.f;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, plainFrameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedTransformCount == editedCount && evaluator->_updatedEntityCount == editedCount);
+	glmTestCheckDeferredEvaluator(evaluator, simulationData, plainFrameData, history, currentFrame);
+
+	// materialized source and deferred duplicate
+	history->_transformTranslate[EditDuplicated][2] = 5.f;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, plainFrameData, history, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedEntityCount == 2);
+	glmTestCheckDeferredEvaluator(evaluator, simulationData, plainFrameData, history, currentFrame);
+
+	start = glmTestSeconds();
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, nextPlainFrameData, history, currentFrame + 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	double deferredFrameSeconds = glmTestSeconds() - start;
+	glmTestCheckDeferredEvaluator(evaluator, simulationData, nextPlainFrameData, history, currentFrame + 1);
+	printf("deferred duplicates : %u deferred entities, first update %.2f ms, frame change %.2f ms\n",
+		evaluator->_deferredFrameDataOut->_deferredEntityCount, deferredFullSeconds * 1e3, deferredFrameSeconds * 1e3);
+
+	glmDestroyLayoutEvaluator(&evaluator);
+	glmDestroyFrameData(&nextPlainFrameData, simulationData);
+	glmDestroyFrameData(&plainFrameData, simulationData);
+	glmDestroyHistory(&history);
+	glmDestroyFrameData(&nextFrameData, simulationData);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,274 @@
+// Occlusion culling of a synthetic stadium : rows of spectators on a rising elliptical bowl, seen from the lower stands
+// (most rows hidden by the nearer ones) and from above the pitch (few hidden). Reports the cull time and the entities left.
+// Conservativeness is checked twice : occluder triangles only write fully covered texels, and every sampled point of a culled
+// box must be hidden by another occluder box.
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+#include <math.h>
+
+struct StadiumCamera
+{
+	const char* _name;
+	float _eye[3];
+	float _target[3];
+};
+
+// column-major [col][row] as GlmGeometryGenerationContext, right handed, Y-up
+static void setCamera(GlmGeometryGenerationContext& context, const StadiumCamera& camera, float fovY, float aspect, float nearPlane, float farPlane)
+{
+	float forward[3], side[3], up[3];
+	float norm = 0.f;
+	for (int i = 0; i < 3; i++)
+	{
+		forward[i] = camera._target[i] - camera._eye[i];
+		norm += forward[i] * forward[i];
+	}
+	for (int i = 0; i < 3; i++)
+		forward[i] /= sqrtf(norm);
+	side[0] = -forward[2]; side[1] = 0.f; side[2] = forward[0]; // forward x (0, 1, 0)
+	norm = sqrtf(side[0] * side[0] + side[2] * side[2]);
+	side[0] /= norm; side[2] /= norm;
+	up[0] = side[1] * forward[2] - side[2] * forward[1];
+	up[1] = side[2] * forward[0] - side[0] * forward[2];
+	up[2] = side[0] * forward[1] - side[1] * forward[0];
+
+	memset(context._viewMatrix, 0, sizeof(context._viewMatrix));
+	memset(context._projectionMatrix, 0, sizeof(context._projectionMatrix));
+	for (int col = 0; col < 3; col++)
+	{
+		context._viewMatrix[col][0] = side[col];
+		context._viewMatrix[col][1] = up[col];
+		context._viewMatrix[col][2] = -forward[col];
+	}
+	context._viewMatrix[3][0] = -(side[0] * camera._eye[0] + side[1] * camera._eye[1] + side[2] * camera._eye[2]);
+	context._viewMatrix[3][1] = -(up[0] * camera._eye[0] + up[1] * camera._eye[1] + up[2] * camera._eye[2]);
+	context._viewMatrix[3][2] = forward[0] * camera._eye[0] + forward[1] * camera._eye[1] + forward[2] * camera._eye[2];
+	context._viewMatrix[3][3] = 1.f;
+
+	float focal = 1.f / tanf(fovY * 0.5f);
+	context._projectionMatrix[0][0] = focal / aspect;
+	context._projectionMatrix[1][1] = focal;
+	context._projectionMatrix[2][2] = (farPlane + nearPlane) / (nearPlane - farPlane);
+	context._projectionMatrix[2][3] = -1.f;
+	context._projectionMatrix[3][2] = 2.f * farPlane * nearPlane / (nearPlane - farPlane);
+	memcpy(context._cameraWorldPosition, camera._eye, sizeof(float[3]));
+}
+
+// one entity per seat, rows every 0.8 units outwards and 0.45 units up, seats every 0.55 units
+static void createStadium(std::vector<GlmEntityBoundingBox>& bboxes, unsigned int rowCount)
+{
+	bboxes.clear();
+	for (unsigned int iRow = 0; iRow < rowCount; iRow++)
+	{
+		float radiusX = 60.f + 0.8f * iRow, radiusZ = 40.f + 0.8f * iRow;
+		float perimeter = 6.2831853f * sqrtf((radiusX * radiusX + radiusZ * radiusZ) * 0.5f);
+		unsigned int seatCount = (unsigned int)(perimeter / 0.55f);
+		for (unsigned int iSeat = 0; iSeat < seatCount; iSeat++)
+		{
+			float angle = 6.2831853f * iSeat / seatCount;
+			GlmEntityBoundingBox bbox;
+			memset(&bbox, 0, sizeof(GlmEntityBoundingBox));
+			bbox._entityIndex = (uint32_t)bboxes.size();
+			bbox._boundingBoxHalfExtents[0] = 0.25f;
+			bbox._boundingBoxHalfExtents[1] = 0.6f;
+			bbox._boundingBoxHalfExtents[2] = 0.25f;
+			bbox._entityOrigin[0] = radiusX * cosf(angle);
+			bbox._entityOrigin[1] = 0.45f * iRow + 0.6f;
+			bbox._entityOrigin[2] = radiusZ * sinf(angle);
+			bbox._entityScale = 1.f;
+			bboxes.push_back(bbox);
+		}
+	}
+}
+
+// segment [eye, point) crosses the box
+static bool segmentHitsBox(const float* eye, const float* point, const float* center, const float* extents)
+{
+	float tMin = 0.f, tMax = 1.f;
+	for (int i = 0; i < 3; i++)
+	{
+		float direction = point[i] - eye[i];
+		float boxMin = center[i] - extents[i], boxMax = center[i] + extents[i];
+		if (fabsf(direction) < 1e-12f)
+		{
+			if (eye[i] < boxMin || eye[i] > boxMax)
+				return false;
+			continue;
+		}
+		float t0 = (boxMin - eye[i]) / direction, t1 = (boxMax - eye[i]) / direction;
+		if (t0 > t1) { float t = t0; t0 = t1; t1 = t; }
+		tMin = t0 > tMin ? t0 : tMin;
+		tMax = t1 < tMax ? t1 : tMax;
+		if (tMin > tMax)
+			return false;
+	}
+	return tMin < 1.f;
+}
+
+// random triangles on a small buffer : every written texel must have its 4 corners inside the triangle
+static void checkOccluderCoverage(unsigned int triangleCount)
+{
+	float identity[4][4] = { { 1.f, 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f }, { 0.f, 0.f, 0.f, 1.f } };
+	uint32_t randomState = 0x7777u;
+	unsigned int writtenCount = 0, partialCount = 0;
+	for (unsigned int iTriangle = 0; iTriangle < triangleCount; iTriangle++)
+	{
+		GlmOcclusionBuffer buffer;
+		float v[3][3];
+		GLM_TEST_CHECK(glmCreateOcclusionBuffer(&buffer, 32, 16, (const float(*)[4])identity) == GIO_SUCCESS);
+		for (int iVertex = 0; iVertex < 3; iVertex++)
+		{
+			v[iVertex][0] = glmTestRandomRange(&randomState, -4.f, 36.f);
+			v[iVertex][1] = glmTestRandomRange(&randomState, -4.f, 20.f);
+			v[iVertex][2] = 0.5f;
+		}
+		glmRasterizeOcclusionTriangle(&buffer, v[0], v[1], v[2]);
+		float area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0]);
+		for (int y = 0; y < 16; y++)
+		{
+			for (int x = 0; x < 32; x++)
+			{
+				if (buffer._levels[0][y * 32 + x] == 1.f)
+					continue;
+				writtenCount++;
+				for (int iCorner = 0; iCorner < 4; iCorner++)
+				{
+					float px = (float)(x + (iCorner & 1)), py = (float)(y + (iCorner >> 1));
+					for (int iEdge = 0; iEdge < 3; iEdge++)
+					{
+						const float* a = v[iEdge];
+						const float* b = v[(iEdge + 1) % 3];
+						float edge = (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]);
+						if (edge * area < -1e-3f)
+						{
+							partialCount++;
+							iEdge = 3;
+							iCorner = 4;
+						}
+					}
+				}
+			}
+		}
+		glmDestroyOcclusionBuffer(&buffer);
+	}
+	GLM_TEST_CHECK(writtenCount > 0);
+	GLM_TEST_CHECK(partialCount == 0);
+}
+
+// occluded entities leave _isVisible and the camera visibilities alike without _keepForSecondaryRays
+static bool glmTestSameVisibility(uint8_t cameraVisibility, const GlmEntityBoundingBox& bbox)
+{
+	return cameraVisibility == bbox._isVisible;
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	unsigned int rowCount = quick ? 12 : 60;
+	unsigned int repeatCount = quick ? 2 : 20;
+	unsigned int checkedCount = quick ? 100000 : 2000;
+	std::vector<GlmEntityBoundingBox> stadium, bboxes;
+	checkOccluderCoverage(quick ? 2000 : 20000);
+	createStadium(stadium, rowCount);
+
+	GlmOcclusionSettings settings;
+	settings._width = 256;
+	settings._height = 128;
+	settings._occluderCount = quick ? 1000 : 4000;
+	settings._occluderScale = 0.6f;
+	settings._keepForSecondaryRays = 0;
+
+	StadiumCamera cameras[2] = {
+		{ "stands", { 64.f, 3.f, 8.f }, { 40.f, 5.f, 40.f } },
+		{ "aerial", { 0.f, 80.f, -90.f }, { 0.f, 0.f, 20.f } } };
+	for (int iCamera = 0; iCamera < 2; iCamera++)
+	{
+		GlmGeometryGenerationContext context;
+		memset(&context, 0, sizeof(GlmGeometryGenerationContext));
+		setCamera(context, cameras[iCamera], 1.0f, 2.f, 0.1f, 1000.f);
+		context._enableFrustumCulling = 1;
+		context._entityCount = (uint32_t)stadium.size();
+
+		double frustumSeconds = 0., occlusionSeconds = 0.;
+		uint32_t frustumVisibleCount = 0, visibleCount = 0;
+		std::vector<uint8_t> frustumVisibilities(stadium.size()), cameraVisibilities(stadium.size());
+		for (unsigned int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+		{
+			bboxes = stadium;
+			context._entityBBoxes = &bboxes[0];
+			double start = glmTestSeconds();
+			GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+			frustumSeconds += glmTestSeconds() - start;
+			frustumVisibleCount = 0;
+			for (size_t iEntity = 0; iEntity < bboxes.size(); iEntity++)
+			{
+				frustumVisibilities[iEntity] = bboxes[iEntity]._isVisible;
+				frustumVisibleCount += bboxes[iEntity]._isVisible;
+			}
+
+			start = glmTestSeconds();
+			GLM_TEST_CHECK(glmOcclusionCullContextEntities(&context, &settings, NULL, &cameraVisibilities[0]) == GIO_SUCCESS);
+			occlusionSeconds += glmTestSeconds() - start;
+			visibleCount = 0;
+			for (size_t iEntity = 0; iEntity < bboxes.size(); iEntity++)
+				visibleCount += bboxes[iEntity]._isVisible;
+			GLM_TEST_CHECK(std::equal(cameraVisibilities.begin(), cameraVisibilities.end(), bboxes.begin(), glmTestSameVisibility));
+		}
+
+		// oracle : occluders are the shrunk boxes of the nearest frustum-visible entities
+		std::vector<uint32_t> occluders;
+		for (size_t iEntity = 0; iEntity < bboxes.size(); iEntity++)
+			if (frustumVisibilities[iEntity])
+				occluders.push_back((uint32_t)iEntity);
+		std::vector<float> distances(bboxes.size());
+		for (size_t iEntity = 0; iEntity < bboxes.size(); iEntity++)
+		{
+			float d[3];
+			for (int i = 0; i < 3; i++)
+				d[i] = bboxes[iEntity]._entityOrigin[i] - context._cameraWorldPosition[i];
+			distances[iEntity] = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+		}
+		GlmOcclusionDistanceLess distanceLess;
+		distanceLess._distances = &distances[0];
+		std::sort(occluders.begin(), occluders.end(), distanceLess);
+		if (occluders.size() > settings._occluderCount)
+			occluders.resize(settings._occluderCount);
+
+		unsigned int checked = 0, visiblePointCount = 0;
+		for (size_t iEntity = 0; iEntity < bboxes.size() && checked < checkedCount; iEntity++)
+		{
+			if (!frustumVisibilities[iEntity] || bboxes[iEntity]._isVisible)
+				continue;
+			checked++;
+			const GlmEntityBoundingBox& bbox = bboxes[iEntity];
+			for (int iPoint = 0; iPoint < 27; iPoint++)
+			{
+				// corners, edge middles, face centers and center of the box
+				float point[3];
+				int steps[3] = { iPoint % 3, (iPoint / 3) % 3, iPoint / 9 };
+				for (int i = 0; i < 3; i++)
+					point[i] = bbox._entityOrigin[i] + (steps[i] - 1) * bbox._boundingBoxHalfExtents[i];
+				bool hidden = false;
+				for (size_t iOccluder = 0; iOccluder < occluders.size() && !hidden; iOccluder++)
+				{
+					const GlmEntityBoundingBox& occluder = bboxes[occluders[iOccluder]];
+					float extents[3];
+					if (occluders[iOccluder] == iEntity)
+						continue;
+					for (int i = 0; i < 3; i++)
+						extents[i] = occluder._boundingBoxHalfExtents[i] * settings._occluderScale;
+					hidden = segmentHitsBox(context._cameraWorldPosition, point, occluder._entityOrigin, extents);
+				}
+				visiblePointCount += !hidden;
+			}
+		}
+		GLM_TEST_CHECK(visiblePointCount == 0);
+		if (iCamera == 0)
+			GLM_TEST_CHECK(visibleCount < frustumVisibleCount / 2); // the stands view must cull most of the crowd
+
+		printf("%-7s %7u entities, %7u after frustum culling (%6.2f ms), %7u after occlusion culling (%6.2f ms), %u culled boxes checked, %u sample points visible\n",
+			cameras[iCamera]._name, (unsigned int)stadium.size(), frustumVisibleCount, frustumSeconds / repeatCount * 1000., visibleCount, occlusionSeconds / repeatCount * 1000., checked, visiblePointCount);
+	}
+	return glmTestResult();
+}
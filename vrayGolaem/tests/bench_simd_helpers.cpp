@@ -0,0 +1,159 @@
+// Batched math helpers and frame kernels of each glmSimdKernels variant (scalar, SSE2, AVX2 when the CPU supports it) on large arrays,
+// and glmMultMatrix against the scalar sums. Outputs of every variant are checked identical to the scalar ones
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+struct GlmTestSimdArrays
+{
+	float _matrix[16];
+	float _quaternion[4];
+	float _pivot[3];
+	float _reference[3];
+	std::vector<float> _points;
+	std::vector<float> _quaternions;
+	std::vector<uint16_t> _compressed;
+	std::vector<float> _result;
+};
+
+typedef void(*GlmTestSimdRun)(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count);
+
+static void glmTestRunTransformPoints(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	kernels->_transformPoints((const float(*)[3])&arrays->_points[0], arrays->_matrix, (float(*)[3])&arrays->_result[0], count);
+}
+
+static void glmTestRunMultVec3Quaternions(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	kernels->_multVec3Quaternions(arrays->_quaternion, (const float(*)[3])&arrays->_points[0], (float(*)[3])&arrays->_result[0], count);
+}
+
+static void glmTestRunMultQuaternions(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	kernels->_multQuaternions(arrays->_quaternion, (const float(*)[4])&arrays->_quaternions[0], (float(*)[4])&arrays->_result[0], count);
+}
+
+static void glmTestRunNormalizeQuaternions(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	memcpy(&arrays->_result[0], &arrays->_quaternions[0], count * sizeof(float[4]));
+	kernels->_normalizeQuaternions((float(*)[4])&arrays->_result[0], count);
+}
+
+static void glmTestRunUncompressPositions48(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	kernels->_uncompressPositions48((float(*)[3])&arrays->_result[0], (const uint16_t(*)[3])&arrays->_compressed[0], count, 20.f, arrays->_reference);
+}
+
+static void glmTestRunTransformClothVertices(const GlmSimdKernels* kernels, GlmTestSimdArrays* arrays, unsigned int count)
+{
+	float boundsMin[3] = { 1e30f, 1e30f, 1e30f };
+	float boundsMax[3] = { -1e30f, -1e30f, -1e30f };
+	kernels->_transformClothVertices((const float(*)[3])&arrays->_points[0], (float(*)[3])&arrays->_result[0], count, arrays->_matrix, arrays->_pivot, 1.5f, boundsMin, boundsMax);
+	memcpy(&arrays->_result[count * 3], boundsMin, sizeof(boundsMin));
+	memcpy(&arrays->_result[count * 3 + 3], boundsMax, sizeof(boundsMax));
+}
+
+static void glmTestMultMatrixScalar(const float *a, const float *b, float *r)
+{
+	for (int iRow = 0; iRow < 4; iRow++)
+		for (int iColumn = 0; iColumn < 4; iColumn++)
+			r[iRow * 4 + iColumn] = a[iRow * 4 + 0] * b[iColumn] + a[iRow * 4 + 1] * b[4 + iColumn] + a[iRow * 4 + 2] * b[8 + iColumn] + a[iRow * 4 + 3] * b[12 + iColumn];
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	unsigned int count = quick ? 4099 : 1000003; // not a multiple of 8, tails are timed too
+	int repeatCount = quick ? 3 : 50;
+	uint32_t randomState = 0x5e2u;
+
+	GlmTestSimdArrays arrays;
+	arrays._points.resize(count * 3);
+	arrays._quaternions.resize(count * 4);
+	arrays._compressed.resize(count * 3);
+	arrays._result.resize(count * 4 + 6);
+	for (size_t i = 0; i < arrays._points.size(); i++)
+		arrays._points[i] = glmTestRandomRange(&randomState, -100.f, 100.f);
+	for (size_t i = 0; i < arrays._quaternions.size(); i++)
+		arrays._quaternions[i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+	for (size_t i = 0; i < arrays._compressed.size(); i++)
+		arrays._compressed[i] = (uint16_t)(glmTestRandom(&randomState) * 65536.f);
+	for (int i = 0; i < 16; i++)
+		arrays._matrix[i] = glmTestRandomRange(&randomState, -2.f, 2.f);
+	arrays._matrix[3] = arrays._matrix[7] = arrays._matrix[11] = 0.f;
+	arrays._matrix[15] = 1.f;
+	for (int i = 0; i < 4; i++)
+		arrays._quaternion[i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+	glmNormalizeQuaternion(arrays._quaternion);
+	for (int i = 0; i < 3; i++)
+	{
+		arrays._pivot[i] = glmTestRandomRange(&randomState, -10.f, 10.f);
+		arrays._reference[i] = glmTestRandomRange(&randomState, -10.f, 10.f);
+	}
+
+	std::vector<const GlmSimdKernels*> kernels;
+	const char* kernelNames[3] = { "scalar", "sse2", "avx2" };
+	kernels.push_back(&glmSimdKernelsScalar);
+#ifdef GLMC_USE_SSE
+	kernels.push_back(&glmSimdKernelsSse2);
+#endif
+#ifdef GLMC_USE_AVX2
+	if (glmCpuSupportsAvx2())
+		kernels.push_back(&glmSimdKernelsAvx2);
+#endif
+
+	const char* runNames[6] = { "transform points", "mult vec3 quaternions", "mult quaternions", "normalize quaternions", "uncompress positions48", "transform cloth" };
+	GlmTestSimdRun runs[6] = { glmTestRunTransformPoints, glmTestRunMultVec3Quaternions, glmTestRunMultQuaternions, glmTestRunNormalizeQuaternions,
+		glmTestRunUncompressPositions48, glmTestRunTransformClothVertices };
+	for (int iRun = 0; iRun < 6; iRun++)
+	{
+		std::vector<float> referenceResult;
+		double scalarSeconds = 0.;
+		for (size_t iKernels = 0; iKernels < kernels.size(); iKernels++)
+		{
+			memset(&arrays._result[0], 0, arrays._result.size() * sizeof(float));
+			double start = glmTestSeconds();
+			for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+				runs[iRun](kernels[iKernels], &arrays, count);
+			double seconds = (glmTestSeconds() - start) / repeatCount;
+			if (iKernels == 0)
+			{
+				referenceResult = arrays._result;
+				scalarSeconds = seconds;
+			}
+			else
+			{
+				GLM_TEST_CHECK(memcmp(&referenceResult[0], &arrays._result[0], referenceResult.size() * sizeof(float)) == 0);
+			}
+			printf("%-22s %-6s %8.3f ms, %7.1f M/s, x%.2f\n", runNames[iRun], kernelNames[kernels[iKernels]->_level], seconds * 1e3, count / seconds * 1e-6, scalarSeconds / seconds);
+		}
+	}
+
+	// matrix products, consecutive matrices of an array
+	unsigned int matrixCount = count / 4;
+	std::vector<float> matrices(matrixCount * 16);
+	std::vector<float> products[2];
+	for (size_t i = 0; i < matrices.size(); i++)
+		matrices[i] = glmTestRandomRange(&randomState, -2.f, 2.f);
+	const char* productNames[2] = { "scalar", "glmMultMatrix" };
+	double productSeconds[2];
+	for (int iProduct = 0; iProduct < 2; iProduct++)
+	{
+		products[iProduct].resize(matrices.size());
+		double start = glmTestSeconds();
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+		{
+			for (unsigned int iMatrix = 0; iMatrix + 1 < matrixCount; iMatrix++)
+			{
+				if (iProduct == 0)
+					glmTestMultMatrixScalar(&matrices[iMatrix * 16], &matrices[iMatrix * 16 + 16], &products[iProduct][iMatrix * 16]);
+				else
+					glmMultMatrix(&matrices[iMatrix * 16], &matrices[iMatrix * 16 + 16], &products[iProduct][iMatrix * 16]);
+			}
+		}
+		productSeconds[iProduct] = (glmTestSeconds() - start) / repeatCount;
+		printf("%-22s %-13s %8.3f ms, %7.1f M/s, x%.2f\n", "mult matrix", productNames[iProduct], productSeconds[iProduct] * 1e3, matrixCount / productSeconds[iProduct] * 1e-6, productSeconds[0] / productSeconds[iProduct]);
+	}
+	GLM_TEST_CHECK(products[0] == products[1]);
+	return glmTestResult();
+}
@@ -0,0 +1,102 @@
+// glmCreateSkinnedEntities throughput in entities/s on 1, 2, 4... threads up to the hardware thread count (4 at least), each run on its own GlmThreadPool.
+// Every run is checked bit exact against the single thread one and for complete instance groups
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_geometry.h"
+#include "test_simulation.h"
+
+enum { CHARACTER_COUNT = 4, BONE_COUNT = 60, RIGID_MESH_COUNT = 3 };
+
+static GlmThreadPool* glmTestPool = NULL;
+
+static void glmTestParallelForPool(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	glmTestPool->run(task, userData, count);
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	uint32_t entityCount = quick ? 2000 : 20000;
+	uint32_t vertexCount = quick ? 500 : 2000;
+	int repeatCount = quick ? 2 : 5;
+
+	// entity i of type i % CHARACTER_COUNT uses character i % CHARACTER_COUNT, of the entity type bone count
+	GlmSimulationData* simulationData = NULL;
+	GlmFrameData* frameData = NULL;
+	GlmFrameDataSoA* frameDataSoA = NULL;
+	glmTestCreateSimulation(&simulationData, entityCount, CHARACTER_COUNT, BONE_COUNT);
+	glmTestCreateFrame(&frameData, simulationData, 11, 0, 0);
+	glmCreateFrameDataSoA(&frameDataSoA, simulationData);
+	glmConvertFrameDataToSoA(frameData, frameDataSoA);
+	GlmTestCharacter characters[CHARACTER_COUNT];
+	for (uint16_t iCharacter = 0; iCharacter < CHARACTER_COUNT; iCharacter++)
+		glmTestCreateCharacter(characters[iCharacter], (uint16_t)(BONE_COUNT + iCharacter), vertexCount, (uint8_t)(GLM_SKIN_LINEAR + iCharacter % 3), RIGID_MESH_COUNT, 0x10u * (iCharacter + 1));
+
+	std::vector<GlmSkinnedEntity> entities(entityCount);
+	std::vector<float> referencePositions;
+	std::vector<unsigned int> threadCounts;
+	// at least up to 4 threads, to check the parallel runs on small machines as well
+	unsigned int maxThreadCount = std::thread::hardware_concurrency() > 4 ? std::thread::hardware_concurrency() : 4;
+	for (unsigned int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+		threadCounts.push_back(threadCount);
+	threadCounts.push_back(maxThreadCount);
+
+	double singleSeconds = 0.;
+	for (size_t iThreadCount = 0; iThreadCount < threadCounts.size(); iThreadCount++)
+	{
+		unsigned int threadCount = threadCounts[iThreadCount];
+		glmTestPool = new GlmThreadPool(threadCount - 1);
+		glmParallelFor = glmTestParallelForPool;
+		double seconds = 0.;
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+		{
+			memset(&entities[0], 0, entityCount * sizeof(GlmSkinnedEntity));
+			for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+			{
+				entities[iEntity]._geometry = &characters[iEntity % CHARACTER_COUNT]._skinnedGeometry;
+				entities[iEntity]._hashKey = iEntity % CHARACTER_COUNT;
+				entities[iEntity]._entityIndex = iEntity;
+			}
+			GlmMeshInstanceGroupPerCrowdField meshInstances;
+			glmInitMeshInstanceGroups(meshInstances);
+			{
+				GlmMeshInstanceGroupRegistry registry(meshInstances);
+				double start = glmTestSeconds();
+				GLM_TEST_CHECK(glmCreateSkinnedEntities(&entities[0], entityCount, frameDataSoA, registry) == GIO_SUCCESS);
+				seconds += glmTestSeconds() - start;
+			}
+
+			// every rigid mesh of every character instanced by all its entities
+			GLM_TEST_CHECK(meshInstances._meshInstanceGroupCount == CHARACTER_COUNT * RIGID_MESH_COUNT);
+			for (uint32_t iGroup = 0; iGroup < meshInstances._meshInstanceGroupCount; iGroup++)
+				GLM_TEST_CHECK(meshInstances._meshInstanceGroups[iGroup]._instanceCount == entityCount / CHARACTER_COUNT);
+			std::vector<float> positions;
+			for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+			{
+				positions.insert(positions.end(), entities[iEntity]._positions[0], entities[iEntity]._positions[0] + entities[iEntity]._vertexCount * 3);
+				glmDestroySkinnedEntity(&entities[iEntity]);
+			}
+			if (referencePositions.empty())
+				referencePositions.swap(positions);
+			else
+				GLM_TEST_CHECK(positions == referencePositions);
+			glmReleaseMeshInstanceGroups(meshInstances);
+		}
+		seconds /= repeatCount;
+		if (iThreadCount == 0)
+			singleSeconds = seconds;
+		glmParallelFor = NULL;
+		delete glmTestPool;
+		glmTestPool = NULL;
+
+		printf("%2u threads %9.0f entities/s (%u vertices, %u rigid meshes), speedup %5.2f\n", threadCount, entityCount / seconds, vertexCount, RIGID_MESH_COUNT, singleSeconds / seconds);
+	}
+
+	for (uint16_t iCharacter = 0; iCharacter < CHARACTER_COUNT; iCharacter++)
+		glmTestDestroyCharacter(characters[iCharacter]);
+	glmDestroyFrameDataSoA(&frameDataSoA);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,63 @@
+// Skinning throughput per skinning type : scalar reference, glmSkinVertices on one thread, glmSkinMesh through glmParallelFor.
+// Outputs are checked against the reference
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_geometry.h"
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	uint32_t vertexCount = quick ? 20000 : 500000;
+	int repeatCount = quick ? 2 : 10;
+	uint16_t boneCount = 80;
+	const char* typeNames[4] = { "rigid", "linear", "dualq", "blend" };
+
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(boneCount, 0x1234u, bonePositions, boneOrientations);
+	std::vector<float> referencePositions(vertexCount * 3), referenceNormals(vertexCount * 3), positions(vertexCount * 3), normals(vertexCount * 3);
+
+	for (uint8_t skinningType = GLM_SKIN_RIGID; skinningType <= GLM_SKIN_BLEND; skinningType++)
+	{
+		GlmTestSkinnedGeometry data;
+		glmTestCreateSkinnedGeometry(data, vertexCount, boneCount, skinningType, 4, 0x42u + skinningType);
+		GlmSkinnedMesh mesh;
+		GlmSkinningPalette palette;
+		memset(&palette, 0, sizeof(GlmSkinningPalette));
+		GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, boneCount) == GIO_SUCCESS);
+		GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+
+		double start = glmTestSeconds();
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+			glmSkinVerticesReference(&mesh, &palette, 0, vertexCount, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+		double referenceSeconds = (glmTestSeconds() - start) / repeatCount;
+
+		start = glmTestSeconds();
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+			glmSkinVertices(&mesh, &palette, 0, vertexCount, (float(*)[3])&positions[0], (float(*)[3])&normals[0]);
+		double singleSeconds = (glmTestSeconds() - start) / repeatCount;
+
+		float maxError = 0.f;
+		for (size_t i = 0; i < positions.size(); i++)
+			maxError = fmaxf(maxError, fabsf(positions[i] - referencePositions[i]));
+		GLM_TEST_CHECK(maxError < 1e-4f);
+
+		glmParallelFor = glmParallelForThreads;
+		memset(&positions[0], 0, positions.size() * sizeof(float));
+		start = glmTestSeconds();
+		for (int iRepeat = 0; iRepeat < repeatCount; iRepeat++)
+			glmSkinMesh(&mesh, &palette, (float(*)[3])&positions[0], (float(*)[3])&normals[0]);
+		double parallelSeconds = (glmTestSeconds() - start) / repeatCount;
+		glmParallelFor = NULL;
+
+		for (size_t i = 0; i < positions.size(); i++)
+			maxError = fmaxf(maxError, fabsf(positions[i] - referencePositions[i]));
+		GLM_TEST_CHECK(maxError < 1e-4f);
+
+		printf("%-6s %7.2f Mverts/s reference %7.2f Mverts/s glmSkinVertices %7.2f Mverts/s glmSkinMesh (%u threads), max error %g\n", typeNames[skinningType],
+			vertexCount / referenceSeconds * 1e-6, vertexCount / singleSeconds * 1e-6, vertexCount / parallelSeconds * 1e-6, std::thread::hardware_concurrency(), maxError);
+
+		glmDestroySkinningPalette(&palette);
+		glmDestroySkinnedMesh(&mesh);
+	}
+	return glmTestResult();
+}
@@ -0,0 +1,164 @@
+// Raycast throughput of the terrain AABB hierarchy on synthetic terrains (flat, noise heightfield, stairs, overhangs),
+// with vertical and random rays. Reports rays/s, nodes visited and triangles tested per ray, every checked ray must
+// return the same hit as the brute-force oracle. Rays starting on or just past the ground check the box tolerance.
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_terrain.h"
+
+using namespace CrowdTerrain;
+
+struct TerrainRay
+{
+	Vec3 _origin;
+	Vec3 _segment;
+};
+
+static void createVerticalRays(std::vector<TerrainRay>& rays, unsigned int rayCount, float size, uint32_t* randomState)
+{
+	rays.resize(rayCount);
+	for (unsigned int iRay = 0; iRay < rayCount; iRay++)
+	{
+		rays[iRay]._origin.setValues(glmTestRandomRange(randomState, 0.f, size), 100.f, glmTestRandomRange(randomState, 0.f, size));
+		rays[iRay]._segment.setValues(0.f, -200.f, 0.f);
+	}
+}
+
+// any direction, starting between the ground and above the overhangs
+static void createRandomRays(std::vector<TerrainRay>& rays, unsigned int rayCount, float size, uint32_t* randomState)
+{
+	rays.resize(rayCount);
+	for (unsigned int iRay = 0; iRay < rayCount; iRay++)
+	{
+		Vec3 direction;
+		do
+		{
+			direction.setValues(glmTestRandomRange(randomState, -1.f, 1.f), glmTestRandomRange(randomState, -1.f, 1.f), glmTestRandomRange(randomState, -1.f, 1.f));
+		} while (direction * direction > 1.f || direction * direction < 0.01f);
+		direction.normalizeSelf();
+		rays[iRay]._origin.setValues(glmTestRandomRange(randomState, 0.f, size), glmTestRandomRange(randomState, -2.f, 20.f), glmTestRandomRange(randomState, 0.f, size));
+		rays[iRay]._segment = direction * (size * 0.5f);
+	}
+}
+
+static void benchmarkRays(const char* terrainName, const char* rayName, const SubMesh& subMesh, const std::vector<TerrainRay>& rays, unsigned int checkedRayCount)
+{
+	const AABB<Vec3>* aabbArray = &subMesh._AABB[0];
+	int rootIndex = (int)subMesh._AABB.size() - 1;
+	RaycastStats stats;
+	unsigned int hitCount = 0;
+	double start = glmTestSeconds();
+	for (size_t iRay = 0; iRay < rays.size(); iRay++)
+	{
+		int triIndex = -1;
+		float tt = FLT_MAX;
+		hitCount += hierarchicalRaycast<Vec3, Vec3>(rays[iRay]._origin, rays[iRay]._segment, triIndex, tt, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices, &stats);
+	}
+	double hierarchySeconds = glmTestSeconds() - start;
+
+	// oracle : same hit distance for every checked ray with the surface tolerance (triangle indices differ, the hierarchy
+	// reorders them). Without it the hierarchy can only miss the hits behind the ray origin
+	unsigned int mismatchCount = 0;
+	start = glmTestSeconds();
+	for (unsigned int iRay = 0; iRay < checkedRayCount && iRay < rays.size(); iRay++)
+	{
+		int triIndex = -1, defaultTriIndex = -1, oracleTriIndex = -1;
+		float tt = FLT_MAX, defaultTT = FLT_MAX, oracleTT = FLT_MAX;
+		bool hit = hierarchicalRaycast<Vec3, Vec3>(rays[iRay]._origin, rays[iRay]._segment, triIndex, tt, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices, NULL, -0.001f);
+		bool defaultHit = hierarchicalRaycast<Vec3, Vec3>(rays[iRay]._origin, rays[iRay]._segment, defaultTriIndex, defaultTT, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices);
+		bool oracleHit = bruteForceRaycast<Vec3, Vec3>(rays[iRay]._origin, rays[iRay]._segment, oracleTriIndex, oracleTT, subMesh._vertices, (const int*)subMesh._indices, (int)subMesh._indiceCount);
+		if (hit != oracleHit || (hit && tt != oracleTT))
+			mismatchCount++;
+		if ((defaultHit != oracleHit || (defaultHit && defaultTT != oracleTT)) && !(oracleHit && oracleTT < 0.f))
+			mismatchCount++;
+	}
+	double oracleSeconds = glmTestSeconds() - start;
+	GLM_TEST_CHECK(mismatchCount == 0);
+
+	printf("%-10s %-9s %10.0f rays/s %8.1f nodes/ray %8.1f triangles/ray %3u%% hit | brute force %8.0f rays/s, %u/%u rays differ\n",
+		terrainName, rayName, rays.size() / hierarchySeconds, (double)stats._nodeCount / rays.size(), (double)stats._triangleCount / rays.size(), (unsigned int)(hitCount * 100 / rays.size()),
+		checkedRayCount / oracleSeconds, mismatchCount, checkedRayCount);
+}
+
+// rays starting on or just past a flat ground : the default box test keeps the boxes the ray starts in or on, as before the
+// surface tolerance existed, and only the tolerance reaches a triangle the ray starts behind
+static void checkBoundaryRays()
+{
+	GlmTestTriangleSoup soup;
+	glmTestAppendGrid(soup, 8, 8.f, glmTestFlatHeight);
+	SubMesh subMesh;
+	glmTestCreateSubMesh(subMesh, soup);
+	const AABB<Vec3>* aabbArray = &subMesh._AABB[0];
+	int rootIndex = (int)subMesh._AABB.size() - 1;
+	Matrix4 identity;
+	identity.setToIdentity();
+
+	// origin height, expected hit without and with the tolerance
+	const float origins[4] = { 1.f, 0.f, -0.0005f, -0.01f };
+	const bool defaultHits[4] = { true, true, false, false };
+	const bool toleranceHits[4] = { true, true, true, false };
+	for (int iOrigin = 0; iOrigin < 4; iOrigin++)
+	{
+		Vec3 origin(3.3f, origins[iOrigin], 4.6f);
+		Vec3 segment(0.f, -10.f, 0.f);
+		int triIndex = -1, toleranceTriIndex = -1, instanceTriIndex = -1, oracleTriIndex = -1;
+		float tt = FLT_MAX, toleranceTT = FLT_MAX, instanceTT = FLT_MAX, oracleTT = FLT_MAX;
+		bool hit = hierarchicalRaycast<Vec3, Vec3>(origin, segment, triIndex, tt, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices);
+		bool toleranceHit = hierarchicalRaycast<Vec3, Vec3>(origin, segment, toleranceTriIndex, toleranceTT, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices, NULL, -0.001f);
+		bool instanceHit = instanceRaycast<Vec3, Vec3>(identity, origin, segment, instanceTriIndex, instanceTT, aabbArray, (int)subMesh._AABB.size(), subMesh._vertices, (const int*)subMesh._indices);
+		bool oracleHit = bruteForceRaycast<Vec3, Vec3>(origin, segment, oracleTriIndex, oracleTT, subMesh._vertices, (const int*)subMesh._indices, (int)subMesh._indiceCount);
+		GLM_TEST_CHECK(hit == defaultHits[iOrigin]);
+		GLM_TEST_CHECK(toleranceHit == toleranceHits[iOrigin]);
+		GLM_TEST_CHECK(instanceHit == toleranceHits[iOrigin]);
+		GLM_TEST_CHECK(oracleHit == toleranceHits[iOrigin]);
+		if (hit && toleranceHit)
+			GLM_TEST_CHECK(tt == toleranceTT);
+		if (toleranceHit && instanceHit && oracleHit)
+			GLM_TEST_CHECK(toleranceTT == oracleTT && instanceTT == oracleTT);
+	}
+
+	// a ray starting inside a box hits with both settings
+	Vec3 origin(3.3f, 0.f, 4.6f);
+	Vec3 segment(0.f, 5.f, 0.f);
+	int triIndex = -1;
+	float tt = FLT_MAX, tnear, tfar;
+	GLM_TEST_CHECK((intersectRayAABox<Vec3>(Vec3(1.f, 1.f, 1.f), segment, Vec3(0.f, 0.f, 0.f), Vec3(2.f, 2.f, 2.f), tnear, tfar)));
+	GLM_TEST_CHECK(tnear < 0.f && tfar > 0.f);
+	GLM_TEST_CHECK((hierarchicalRaycast<Vec3, Vec3>(origin, segment, triIndex, tt, rootIndex, aabbArray, subMesh._vertices, (const int*)subMesh._indices)));
+	GLM_TEST_CHECK(tt == 0.f);
+}
+
+int main(int argc, char** argv)
+{
+	checkBoundaryRays();
+
+	int quick = glmTestIsQuick(argc, argv);
+	unsigned int resolution = quick ? 32 : 256;
+	unsigned int rayCount = quick ? 2000 : 200000;
+	unsigned int checkedRayCount = quick ? rayCount : 500;
+	float size = 256.f;
+
+	const char* terrainNames[4] = { "flat", "noise", "stairs", "overhangs" };
+	for (int iTerrain = 0; iTerrain < 4; iTerrain++)
+	{
+		GlmTestTriangleSoup soup;
+		if (iTerrain == 0)
+			glmTestAppendGrid(soup, resolution, size, glmTestFlatHeight);
+		else if (iTerrain == 1)
+			glmTestAppendGrid(soup, resolution, size, glmTestNoiseHeight);
+		else if (iTerrain == 2)
+			glmTestAppendGrid(soup, resolution, size, glmTestStairsHeight);
+		else
+			glmTestAppendOverhangs(soup, resolution, size, 64, 0x1234567u);
+		SubMesh subMesh;
+		glmTestCreateSubMesh(subMesh, soup);
+		printf("%s : %u triangles, %u nodes\n", terrainNames[iTerrain], subMesh._indiceCount / 3, (unsigned int)subMesh._AABB.size());
+
+		uint32_t randomState = 0xC0FFEEu + iTerrain;
+		std::vector<TerrainRay> rays;
+		createVerticalRays(rays, rayCount, size, &randomState);
+		benchmarkRays(terrainNames[iTerrain], "vertical", subMesh, rays, checkedRayCount);
+		createRandomRays(rays, rayCount, size, &randomState);
+		benchmarkRays(terrainNames[iTerrain], "random", subMesh, rays, checkedRayCount);
+	}
+	return glmTestResult();
+}
@@ -0,0 +1,151 @@
+// Per frame cost of an animated terrain : SubMesh::deform (vertex copy + refit) against a full hierarchy rebuild,
+// then rigid instance raycasts on the refitted hierarchy. Raycasts are checked against the brute-force oracle in world space.
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_terrain.h"
+
+using namespace CrowdTerrain;
+
+static void computeWaveVertices(const std::vector<Vec3>& restVertices, int frame, std::vector<Vec3>& vertices)
+{
+	for (size_t iVertex = 0; iVertex < restVertices.size(); iVertex++)
+	{
+		const Vec3& rest(restVertices[iVertex]);
+		vertices[iVertex].setValues(rest.x, rest.y + 2.f * sinf(rest.x * 0.1f + frame * 0.2f) * cosf(rest.z * 0.07f - frame * 0.1f), rest.z);
+	}
+}
+
+// every node must contain its triangles, parents must contain their children
+static bool checkHierarchyBounds(const SubMesh& subMesh)
+{
+	for (size_t iNode = 0; iNode < subMesh._AABB.size(); iNode++)
+	{
+		const AABB<Vec3>& aabb(subMesh._AABB[iNode]);
+		for (int i = aabb._firstIndex; i < aabb._firstIndex + aabb._indexCount; i++)
+		{
+			const Vec3& v(subMesh._vertices[subMesh._indices[i]]);
+			for (int j = 0; j < 3; j++)
+				if (v[j] < aabb._AABBmin[j] || v[j] > aabb._AABBmax[j])
+					return false;
+		}
+		int children[2] = { aabb._left, aabb._right };
+		for (int iChild = 0; iChild < 2; iChild++)
+		{
+			if (children[iChild] == -1)
+				continue;
+			const AABB<Vec3>& child(subMesh._AABB[children[iChild]]);
+			for (int j = 0; j < 3; j++)
+				if (child._AABBmin[j] < aabb._AABBmin[j] || child._AABBmax[j] > aabb._AABBmax[j])
+					return false;
+		}
+	}
+	return true;
+}
+
+static Matrix4 computeInstanceMatrix(float angle, float tx, float tz)
+{
+	Matrix4 matrix;
+	matrix.setToIdentity();
+	matrix._matrix44[0][0] = cosf(angle);
+	matrix._matrix44[0][2] = -sinf(angle);
+	matrix._matrix44[2][0] = sinf(angle);
+	matrix._matrix44[2][2] = cosf(angle);
+	matrix._matrix44[3][0] = tx;
+	matrix._matrix44[3][2] = tz;
+	return matrix;
+}
+
+int main(int argc, char** argv)
+{
+	int quick = glmTestIsQuick(argc, argv);
+	unsigned int resolution = quick ? 48 : 512;
+	int frameCount = quick ? 4 : 60;
+	unsigned int instanceSide = quick ? 3 : 8;
+	unsigned int rayCount = quick ? 500 : 2000;
+	unsigned int checkedInstanceCount = quick ? instanceSide * instanceSide : 4;
+	unsigned int checkedRayCount = quick ? 64 : 8;
+	float size = 256.f;
+
+	GlmTestTriangleSoup soup;
+	glmTestAppendGrid(soup, resolution, size, glmTestNoiseHeight);
+	SubMesh subMesh;
+	glmTestCreateSubMesh(subMesh, soup);
+	std::vector<Vec3> restVertices(soup._vertices);
+	std::vector<Vec3> vertices(restVertices.size());
+	printf("terrain %u triangles, %u nodes\n", subMesh._indiceCount / 3, (unsigned int)subMesh._AABB.size());
+
+	// instances on a grid, rotated around Y
+	unsigned int instanceCount = instanceSide * instanceSide;
+	std::vector<Matrix4> localToWorld(instanceCount), worldToLocal(instanceCount);
+	for (unsigned int iInstance = 0; iInstance < instanceCount; iInstance++)
+	{
+		localToWorld[iInstance] = computeInstanceMatrix(0.3f * iInstance, (iInstance % instanceSide) * size * 1.1f, (iInstance / instanceSide) * size * 1.1f);
+		worldToLocal[iInstance].inverse(localToWorld[iInstance]);
+	}
+	float worldSize = instanceSide * size * 1.1f;
+
+	std::vector<int> rebuildIndices(subMesh._indiceCount);
+	std::vector<AABB<Vec3> > rebuildHierarchy;
+	std::vector<Vec3> worldVertices(restVertices.size());
+	uint32_t randomState = 0x9E3779B9u;
+	double refitSeconds = 0., rebuildSeconds = 0., raycastSeconds = 0.;
+	unsigned int hitCount = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		computeWaveVertices(restVertices, frame, vertices);
+
+		double start = glmTestSeconds();
+		subMesh.deform(&vertices[0], NULL);
+		refitSeconds += glmTestSeconds() - start;
+
+		// what deforming cost before refit : reordering the indices and building the hierarchy again
+		memcpy(&rebuildIndices[0], subMesh._indices, sizeof(int) * subMesh._indiceCount);
+		start = glmTestSeconds();
+		rebuildHierarchy.clear();
+		computeAABBHierarchy<Vec3, Vec3>(subMesh._vertices, &rebuildIndices[0], 0, (int)subMesh._indiceCount, 0, rebuildHierarchy);
+		rebuildSeconds += glmTestSeconds() - start;
+
+		GLM_TEST_CHECK(checkHierarchyBounds(subMesh));
+
+		// vertical rays over the instance grid, closest hit among all instances
+		start = glmTestSeconds();
+		for (unsigned int iRay = 0; iRay < rayCount; iRay++)
+		{
+			Vec3 origin(glmTestRandomRange(&randomState, 0.f, worldSize), 100.f, glmTestRandomRange(&randomState, 0.f, worldSize));
+			Vec3 segment(0.f, -200.f, 0.f);
+			int triIndex = -1;
+			float tt = FLT_MAX;
+			for (unsigned int iInstance = 0; iInstance < instanceCount; iInstance++)
+				instanceRaycast<Vec3, Vec3>(worldToLocal[iInstance], origin, segment, triIndex, tt, &subMesh._AABB[0], (int)subMesh._AABB.size(), subMesh._vertices, (const int*)subMesh._indices);
+			hitCount += triIndex != -1;
+		}
+		raycastSeconds += glmTestSeconds() - start;
+
+		// oracle on the first and last frames : brute force against the instance vertices moved to world space
+		if (frame != 0 && frame != frameCount - 1)
+			continue;
+		for (unsigned int iInstance = 0; iInstance < checkedInstanceCount; iInstance++)
+		{
+			for (size_t iVertex = 0; iVertex < vertices.size(); iVertex++)
+				worldVertices[iVertex] = localToWorld[iInstance].transformPoint(vertices[iVertex]);
+			for (unsigned int iRay = 0; iRay < checkedRayCount; iRay++)
+			{
+				// random directions, from above the instance
+				Vec3 origin(localToWorld[iInstance]._matrix44[3][0] + glmTestRandomRange(&randomState, -size, size), 20.f, localToWorld[iInstance]._matrix44[3][2] + glmTestRandomRange(&randomState, -size, size));
+				Vec3 segment(glmTestRandomRange(&randomState, -100.f, 100.f), glmTestRandomRange(&randomState, -60.f, -10.f), glmTestRandomRange(&randomState, -100.f, 100.f));
+				int triIndex = -1, oracleTriIndex = -1;
+				float tt = FLT_MAX, oracleTT = FLT_MAX;
+				bool hit = instanceRaycast<Vec3, Vec3>(worldToLocal[iInstance], origin, segment, triIndex, tt, &subMesh._AABB[0], (int)subMesh._AABB.size(), subMesh._vertices, (const int*)subMesh._indices);
+				bool oracleHit = bruteForceRaycast<Vec3, Vec3>(origin, segment, oracleTriIndex, oracleTT, &worldVertices[0], (const int*)subMesh._indices, (int)subMesh._indiceCount);
+				GLM_TEST_CHECK(hit == oracleHit);
+				if (hit && oracleHit)
+					GLM_TEST_CHECK(fabsf(tt - oracleTT) < 1e-4f);
+			}
+		}
+	}
+
+	printf("deform + refit   %8.3f ms/frame\n", refitSeconds * 1000. / frameCount);
+	printf("full rebuild     %8.3f ms/frame\n", rebuildSeconds * 1000. / frameCount);
+	printf("instance rays    %8.0f rays/s (%u instances, %u%% hit)\n", rayCount * frameCount / raycastSeconds, instanceCount, hitCount * 100 / (rayCount * frameCount));
+	return glmTestResult();
+}
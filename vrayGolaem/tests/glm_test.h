@@ -0,0 +1,79 @@
+// Helpers shared by the vrayGolaem tests and benchmarks : checks, timing, random numbers
+#ifndef GLM_TEST_INCLUDE_H
+#define GLM_TEST_INCLUDE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+static int glmTestFailureCount = 0;
+
+// counts and reports a failed check, the test keeps running. main returns glmTestResult()
+#define GLM_TEST_CHECK(expression) \
+	do { if (!(expression)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #expression); glmTestFailureCount++; } } while (0)
+
+inline int glmTestResult()
+{
+	if (glmTestFailureCount)
+		printf("%d check(s) failed\n", glmTestFailureCount);
+	return glmTestFailureCount ? 1 : 0;
+}
+
+// seconds from an arbitrary origin
+inline double glmTestSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// xorshift32, state must not be 0. Returns [0, 1)
+inline float glmTestRandom(uint32_t* state)
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return (float)(x >> 8) / 16777216.f;
+}
+
+inline float glmTestRandomRange(uint32_t* state, float minValue, float maxValue)
+{
+	return minValue + (maxValue - minValue) * glmTestRandom(state);
+}
+
+// benchmarks use small sizes when started with --quick (ctest)
+inline int glmTestIsQuick(int argc, char** argv)
+{
+	for (int iArg = 1; iArg < argc; iArg++)
+		if (strcmp(argv[iArg], "--quick") == 0)
+			return 1;
+	return 0;
+}
+
+// whole file helpers for the file format tests, return 1 on success
+inline int glmTestReadFile(const char* filename, std::vector<uint8_t>& data)
+{
+	FILE* fp = fopen(filename, "rb");
+	if (!fp)
+		return 0;
+	fseek(fp, 0, SEEK_END);
+	data.resize((size_t)ftell(fp));
+	fseek(fp, 0, SEEK_SET);
+	size_t readSize = data.empty() ? 0 : fread(&data[0], 1, data.size(), fp);
+	fclose(fp);
+	return readSize == data.size();
+}
+
+inline int glmTestWriteFile(const char* filename, const void* data, size_t size)
+{
+	FILE* fp = fopen(filename, "wb");
+	if (!fp)
+		return 0;
+	size_t writtenSize = size ? fwrite(data, 1, size, fp) : 0;
+	fclose(fp);
+	return writtenSize == size;
+}
+
+#endif // GLM_TEST_INCLUDE_H
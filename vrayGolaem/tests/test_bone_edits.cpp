@@ -0,0 +1,222 @@
+// Posture bone edits of glmCreateModifiedFrameData : the per entity type batches (4 entities per SSE lane group) against the scalar
+// per entity rest relative / forward kinematics helpers, bit exact, on delta edits, full frame postures with later edits and sns scales
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static const char* glmTestFramePathModel = "bone_edits_missing.%d.gscf";
+
+// scalar bone edit of one entity, as glmCreateModifiedFrameData did it before the per type batches
+static void glmTestApplyEntityBoneEditReference(const GlmSimulationData* simulationData, const GlmEntityTransform* tr, unsigned int iTransform, const GlmHistory* history, GlmFrameData* frameData, int currentFrame)
+{
+	uint16_t entityTypeIndex = simulationData->_entityTypes[tr->_sourceIndexInCrowdField];
+	unsigned int boneCount = simulationData->_boneCount[entityTypeIndex];
+	unsigned int localBoneOffset = history->_localBoneOffset[entityTypeIndex];
+	const float(*boneLocalOri)[4] = (const float(*)[4])history->_localBoneOrientation + localBoneOffset;
+	const float(*boneLocalPos)[3] = (const float(*)[3])history->_localBonePosition + localBoneOffset;
+	uint32_t* parentIndex = history->_localBoneParent + localBoneOffset;
+	uint32_t offset = simulationData->_iBoneOffsetPerEntityType[entityTypeIndex] + boneCount * simulationData->_indexInEntityType[iTransform];
+	float(*bonePositions)[3] = frameData->_bonePositions + offset;
+	float(*boneOrientations)[4] = frameData->_boneOrientations + offset;
+	uint16_t snsCount = simulationData->_snsCountPerEntityType[entityTypeIndex];
+	float skeletonScale = simulationData->_scales[tr->_sourceIndexInCrowdField] * tr->_scale;
+	int postureIndex = glmFindPostureIndex(tr, currentFrame);
+	std::vector<float> sortedOri(boneCount * 4), sortedPos(boneCount * 3), sortedScales(boneCount * 4), restRelativeOri(boneCount * 4);
+
+	if (tr->_boneRestRelativeOrientation == NULL && postureIndex == -1)
+		return;
+
+	if (postureIndex == -1)
+	{
+		for (unsigned int i = 0; i < boneCount; i++)
+			memcpy(&sortedOri[(parentIndex[i] & 0xFFFF) * 4], boneOrientations[i], sizeof(float[4]));
+		glmComputeRestRelativesOrientationFromPosture((const float(*)[4])&sortedOri[0], boneLocalOri, parentIndex, boneOrientations[0], (float(*)[4])&restRelativeOri[0], boneCount);
+		for (unsigned int i = 0; i < boneCount; i++)
+		{
+			float workOri[4];
+			glmMultQuaternion(&restRelativeOri[i * 4], tr->_boneRestRelativeOrientation[i], workOri);
+			glmNormalizeQuaternion(workOri);
+			memcpy(&restRelativeOri[i * 4], workOri, sizeof(workOri));
+		}
+	}
+	else
+	{
+		memcpy(&restRelativeOri[0], tr->_posturesOrientations + postureIndex * tr->_postureBoneCount, boneCount * sizeof(float[4]));
+		glmApplyLaterBoneEdits(tr, history, (float(*)[4])&restRelativeOri[0]);
+	}
+
+	if (snsCount == 0)
+	{
+		glmComputePostureFromRestRelativeOrientations((float(*)[3])&sortedPos[0], (float(*)[4])&sortedOri[0], boneLocalOri, boneLocalPos, parentIndex,
+			bonePositions[0], boneOrientations[0], (const float(*)[4])&restRelativeOri[0], skeletonScale, boneCount);
+	}
+	else
+	{
+		float(*boneSns)[4] = frameData->_snsValues + simulationData->_snsOffsetPerEntityType[entityTypeIndex] + snsCount * simulationData->_indexInEntityType[iTransform];
+		for (unsigned int i = 0; i < boneCount; i++)
+			memcpy(&sortedScales[(parentIndex[i] & 0xFFFF) * 4], boneSns[i], sizeof(float[4]));
+		glmComputePostureFromRestRelativeOrientationsScales((float(*)[3])&sortedPos[0], (float(*)[4])&sortedOri[0], boneLocalOri, boneLocalPos, parentIndex,
+			bonePositions[0], boneOrientations[0], (const float(*)[4])&restRelativeOri[0], skeletonScale, boneCount, (const float(*)[4])&sortedScales[0]);
+	}
+
+	for (unsigned int i = 0; i < boneCount; i++)
+	{
+		memcpy(boneOrientations[i], &sortedOri[(parentIndex[i] & 0xFFFF) * 4], sizeof(float[4]));
+		memcpy(bonePositions[i], &sortedPos[(parentIndex[i] & 0xFFFF) * 3], sizeof(float[3]));
+	}
+}
+
+static void glmTestRandomQuaternion(uint32_t* randomState, float* q)
+{
+	float norm = 0.f;
+	for (int i = 0; i < 4; i++)
+	{
+		q[i] = glmTestRandomRange(randomState, -1.f, 1.f);
+		norm += q[i] * q[i];
+	}
+	norm = 1.f / sqrtf(norm + 1e-6f);
+	for (int i = 0; i < 4; i++)
+		q[i] *= norm;
+}
+
+int main()
+{
+	// 3 types of 7, 8 and 9 bones, 6 to 7 entities per type : full and partial lane groups. Type 0 has no sns
+	const uint32_t entityCount = 20;
+	const uint16_t entityTypeCount = 3;
+	const int currentFrame = 12;
+	uint32_t randomState = 0xb0e5u;
+
+	GlmSimulationData* simulationData;
+	glmTestCreateSimulation(&simulationData, entityCount, entityTypeCount, 7);
+	uint32_t snsOffset = 0;
+	for (uint16_t iType = 0; iType < entityTypeCount; iType++)
+	{
+		simulationData->_snsCountPerEntityType[iType] = iType ? simulationData->_boneCount[iType] : 0;
+		simulationData->_snsOffsetPerEntityType[iType] = snsOffset;
+		snsOffset += simulationData->_entityCountPerEntityType[iType] * simulationData->_snsCountPerEntityType[iType];
+	}
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		simulationData->_scales[iEntity] = glmTestRandomRange(&randomState, 0.5f, 2.f);
+	GlmFrameData* frameData;
+	glmTestCreateFrame(&frameData, simulationData, 0x5151u, 0, 0);
+	for (uint32_t iSns = 0; iSns < snsOffset; iSns++)
+		frameData->_snsValues[iSns][3] = glmTestRandomRange(&randomState, 0.5f, 1.5f);
+
+	// transforms : two bone edits over most entities, a posture on entity 3 (current frame and a later one) followed by a bone edit,
+	// a posture on entity 8 for another frame only (delta path with its bone edit)
+	enum { EditBone2, EditBone4, PostureCurrent, EditAfterPosture, PostureOtherFrame, EditPostureOtherFrame, TransformCount };
+	std::vector<int64_t> entityIds;
+	std::vector<uint32_t> starts(TransformCount), counts(TransformCount);
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+	{
+		starts[iTransform] = (uint32_t)entityIds.size();
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			int used = (iTransform == EditBone2 && iEntity % 4 != 1) || (iTransform == EditBone4 && iEntity % 3 == 0)
+				|| ((iTransform == PostureCurrent || iTransform == EditAfterPosture) && iEntity == 3)
+				|| ((iTransform == PostureOtherFrame || iTransform == EditPostureOtherFrame) && iEntity == 8);
+			if (used)
+				entityIds.push_back(simulationData->_entityIds[iEntity]);
+		}
+		counts[iTransform] = (uint32_t)entityIds.size() - starts[iTransform];
+	}
+	uint32_t postureBoneCount3 = simulationData->_boneCount[simulationData->_entityTypes[3]];
+	uint32_t postureBoneCount8 = simulationData->_boneCount[simulationData->_entityTypes[8]];
+	GlmHistory* history;
+	glmTestCreateHistory(&history, simulationData, TransformCount, (uint32_t)entityIds.size(), 0, 3, 2 * postureBoneCount3 + postureBoneCount8);
+	memcpy(history->_entityIds, &entityIds[0], entityIds.size() * sizeof(int64_t));
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+	{
+		history->_entityArrayStartIndex[iTransform] = starts[iTransform];
+		history->_entityArrayCount[iTransform] = counts[iTransform];
+		glmTestRandomQuaternion(&randomState, history->_transformRotate[iTransform]);
+	}
+
+	// shuffled hierarchies : cache bone 0 stays the root, parents come first in hierarchical order
+	for (uint16_t iType = 0; iType < entityTypeCount; iType++)
+	{
+		uint16_t boneCount = simulationData->_boneCount[iType];
+		uint32_t localBoneOffset = history->_localBoneOffset[iType];
+		std::vector<uint16_t> sortedIndices(boneCount);
+		for (uint16_t iBone = 0; iBone < boneCount; iBone++)
+			sortedIndices[iBone] = iBone;
+		for (uint16_t iBone = boneCount - 1; iBone > 1; iBone--)
+		{
+			uint16_t other = (uint16_t)(1 + (uint32_t)(glmTestRandom(&randomState) * iBone));
+			uint16_t swap = sortedIndices[iBone]; sortedIndices[iBone] = sortedIndices[other]; sortedIndices[other] = swap;
+		}
+		for (uint16_t iBone = 0; iBone < boneCount; iBone++)
+		{
+			uint32_t parent = iBone ? (uint32_t)(glmTestRandom(&randomState) * iBone) : 0;
+			history->_localBoneParent[localBoneOffset + iBone] = (parent << 16) | sortedIndices[iBone];
+			glmTestRandomQuaternion(&randomState, history->_localBoneOrientation[localBoneOffset + iBone]);
+			for (int i = 0; i < 3; i++)
+				history->_localBonePosition[localBoneOffset + iBone][i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+		}
+	}
+
+	history->_transformTypes[EditBone2] = SimulationCachePostureBoneEdit;
+	history->_boneIndex[EditBone2] = 2;
+	history->_transformTypes[EditBone4] = SimulationCachePostureBoneEdit;
+	history->_boneIndex[EditBone4] = 4;
+	history->_transformTypes[EditAfterPosture] = SimulationCachePostureBoneEdit;
+	history->_boneIndex[EditAfterPosture] = 5;
+	history->_transformTypes[EditPostureOtherFrame] = SimulationCachePostureBoneEdit;
+	history->_boneIndex[EditPostureOtherFrame] = 1;
+	history->_transformTypes[PostureCurrent] = SimulationCachePosture;
+	history->_posturesFrameStart[PostureCurrent] = 0;
+	history->_posturesFrameCount[PostureCurrent] = 2;
+	history->_posturesFrames[0] = currentFrame + 5;
+	history->_posturesFrames[1] = currentFrame;
+	history->_transformTypes[PostureOtherFrame] = SimulationCachePosture;
+	history->_posturesFrameStart[PostureOtherFrame] = 2;
+	history->_posturesFrameCount[PostureOtherFrame] = 1;
+	history->_posturesFrames[2] = currentFrame - 1;
+	for (uint32_t iPostureBone = 0; iPostureBone < history->_postureTotalBoneCount; iPostureBone++)
+	{
+		glmTestRandomQuaternion(&randomState, history->_posturesOrientations[iPostureBone]);
+		memset(history->_posturesPositions[iPostureBone], 0, sizeof(float[3]));
+	}
+
+	// batched bone edits
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	GLM_TEST_CHECK(entityTransformCount == (int)entityCount);
+	GLM_TEST_CHECK(glmFindPostureIndex(&entityTransforms[3], currentFrame) == 1);
+	GLM_TEST_CHECK(glmFindPostureIndex(&entityTransforms[8], currentFrame) == -1);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+
+	// reference : same layout without the edits, then the scalar edit of each entity
+	GlmSimulationData* referenceSimulationData;
+	GlmFrameData* referenceFrameData;
+	GlmEntityTransform* baseTransforms;
+	int baseTransformCount;
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+		history->_active[iTransform] = 0;
+	glmCreateEntityTransforms(simulationData, history, &baseTransforms, &baseTransformCount);
+	glmCreateModifiedSimulationData(simulationData, baseTransforms, baseTransformCount, &referenceSimulationData);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, baseTransforms, baseTransformCount, history, referenceSimulationData, &referenceFrameData, currentFrame, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+	GLM_TEST_CHECK(memcmp(referenceFrameData->_boneOrientations, frameDataOut->_boneOrientations, totalBoneCount * sizeof(float[4])) != 0);
+	for (int iTransform = 0; iTransform < TransformCount; iTransform++)
+		history->_active[iTransform] = 1;
+	for (int iTransform = 0; iTransform < entityTransformCount; iTransform++)
+		glmTestApplyEntityBoneEditReference(referenceSimulationData, &entityTransforms[iTransform], iTransform, history, referenceFrameData, currentFrame);
+	GLM_TEST_CHECK(glmTestSameModifiedFrame(referenceSimulationData, referenceFrameData, simulationDataOut, frameDataOut));
+
+	glmDestroyFrameData(&referenceFrameData, referenceSimulationData);
+	glmDestroySimulationData(&referenceSimulationData);
+	glmDestroyEntityTransforms(&baseTransforms, baseTransformCount);
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+	glmDestroyHistory(&history);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
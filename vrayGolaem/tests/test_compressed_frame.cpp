@@ -0,0 +1,92 @@
+// GlmCompressedFrameData round trip : per entity, root bone and whole frame decodes of a .gscf are bit exact with glmReadFrameData at every
+// frame kernel level, and the quantized formats take less memory than the decoded frame
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+int main()
+{
+	const GlmSimulationCacheFormat formats[5] = { GSC_O64_P96, GSC_O32_P96, GSC_O128_P48, GSC_O64_P48, GSC_O32_P48 };
+	const GlmSimdLevel levels[3] = { GSC_SIMD_SCALAR, GSC_SIMD_SSE2, GSC_SIMD_AVX2 };
+	const char* file = "compressed_frame.gscf";
+
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, 41, 3, 5);
+	glmTestCreateFrame(&frameData, simulationData, 0x77u, 4, 9);
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+	std::vector<float> clothVertices(frameData->_clothVertices[0], frameData->_clothVertices[0] + frameData->_clothTotalVertices * 3);
+
+	for (int iFormat = 0; iFormat < 5; iFormat++)
+	{
+		frameData->_cacheFormat = (uint8_t)formats[iFormat];
+		GLM_TEST_CHECK(glmWriteFrameData(file, frameData, simulationData) == GSC_SUCCESS);
+		memcpy(frameData->_clothVertices, &clothVertices[0], clothVertices.size() * sizeof(float)); // the writer quantizes in place
+
+		GlmFrameData* readFrameData;
+		glmCreateFrameData(&readFrameData, simulationData);
+		GLM_TEST_CHECK(glmReadFrameData(readFrameData, simulationData, file) == GSC_SUCCESS);
+
+		GlmCompressedFrameData* compressedFrameData = NULL;
+		GLM_TEST_CHECK(glmCreateAndReadCompressedFrameData(&compressedFrameData, simulationData, file) == GSC_SUCCESS);
+		GLM_TEST_CHECK(compressedFrameData != NULL);
+		if (compressedFrameData == NULL)
+		{
+			glmDestroyFrameData(&readFrameData, simulationData);
+			continue;
+		}
+		GLM_TEST_CHECK(compressedFrameData->_cacheFormat == formats[iFormat] && compressedFrameData->_boneCount == totalBoneCount);
+		GLM_TEST_CHECK(glmComputeCompressedFrameDataSize(compressedFrameData, simulationData) < glmComputeFrameDataSize(readFrameData, simulationData));
+
+		for (int iLevel = 0; iLevel < 3; iLevel++)
+		{
+			glmSetSimdLevel(levels[iLevel]);
+
+			// whole frame
+			GlmFrameData* decompressedFrameData = NULL;
+			glmDecompressFrameData(compressedFrameData, simulationData, &decompressedFrameData);
+			GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationData, readFrameData, simulationData, decompressedFrameData));
+			GLM_TEST_CHECK(glmTestSameFrameAttributes(simulationData, readFrameData, decompressedFrameData));
+			glmDestroyFrameData(&decompressedFrameData, simulationData);
+
+			// per entity and root bone only
+			std::vector<float> bonePositions(simulationData->_boneCount[simulationData->_entityTypeCount - 1] * 3);
+			std::vector<float> boneOrientations(simulationData->_boneCount[simulationData->_entityTypeCount - 1] * 4);
+			for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+			{
+				uint16_t entityType = simulationData->_entityTypes[iEntity];
+				uint16_t boneCount = simulationData->_boneCount[entityType];
+				uint32_t firstBone = simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_indexInEntityType[iEntity] * boneCount;
+				glmGetCompressedEntityBones(compressedFrameData, simulationData, iEntity, (float(*)[3])&bonePositions[0], (float(*)[4])&boneOrientations[0]);
+				GLM_TEST_CHECK(memcmp(&bonePositions[0], readFrameData->_bonePositions[firstBone], boneCount * sizeof(float[3])) == 0);
+				GLM_TEST_CHECK(memcmp(&boneOrientations[0], readFrameData->_boneOrientations[firstBone], boneCount * sizeof(float[4])) == 0);
+
+				float rootPosition[3], rootOrientation[4];
+				glmGetCompressedEntityRootBone(compressedFrameData, simulationData, iEntity, rootPosition, rootOrientation);
+				GLM_TEST_CHECK(memcmp(rootPosition, readFrameData->_bonePositions[firstBone], sizeof(rootPosition)) == 0);
+				GLM_TEST_CHECK(memcmp(rootOrientation, readFrameData->_boneOrientations[firstBone], sizeof(rootOrientation)) == 0);
+			}
+		}
+		glmInitSimdDispatch();
+
+		glmDestroyCompressedFrameData(&compressedFrameData, simulationData);
+		GLM_TEST_CHECK(compressedFrameData == NULL);
+		glmDestroyFrameData(&readFrameData, simulationData);
+		remove(file);
+	}
+
+	// same failures as glmReadFrameData, nothing is returned
+	GlmCompressedFrameData* compressedFrameData = (GlmCompressedFrameData*)&frameData;
+	GLM_TEST_CHECK(glmCreateAndReadCompressedFrameData(&compressedFrameData, simulationData, "compressed_frame_missing.gscf") == GSC_FILE_OPEN_FAILED);
+	GLM_TEST_CHECK(compressedFrameData == NULL);
+	frameData->_cacheFormat = (uint8_t)GSC_O128_P96;
+	GLM_TEST_CHECK(glmWriteFrameData(file, frameData, simulationData) == GSC_SUCCESS);
+	compressedFrameData = (GlmCompressedFrameData*)&frameData;
+	GLM_TEST_CHECK(glmCreateAndReadCompressedFrameData(&compressedFrameData, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	GLM_TEST_CHECK(compressedFrameData == NULL);
+	remove(file);
+
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,114 @@
+// glmCreateDeferredFrameData on a crowd with duplicates : materialized deferred frame bit exact to glmCreateModifiedFrameData, and
+// GSC_OUT_OF_MEMORY with nothing left allocated and the transforms untouched when its own allocations fail
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail, only the allocation it counts down to fails
+static void* glmTestMalloc(size_t size)
+{
+	glmTestAllocationCount++;
+	if (glmTestAllocationsBeforeFailure == 0)
+	{
+		glmTestAllocationsBeforeFailure = -1;
+		return NULL;
+	}
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+enum { ENTITY_COUNT = 200, DUPLICATE_COUNT = 20 };
+
+static const char* glmTestFramePathModel = "deferred_frame_data_missing.%d.gscf";
+
+int main()
+{
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, ENTITY_COUNT, 2, 6);
+	glmTestCreateFrame(&frameData, simulationData, 0x1357u, 0, 0);
+
+	// translate all, duplicate the first entities
+	GlmHistory* history;
+	glmTestCreateHistory(&history, simulationData, 2, ENTITY_COUNT + DUPLICATE_COUNT, DUPLICATE_COUNT);
+	for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+		history->_entityIds[iEntity] = simulationData->_entityIds[iEntity];
+	for (uint32_t iDuplicate = 0; iDuplicate < DUPLICATE_COUNT; iDuplicate++)
+	{
+		history->_entityIds[ENTITY_COUNT + iDuplicate] = simulationData->_entityIds[iDuplicate];
+		history->_duplicatedEntityIds[iDuplicate] = 1000000000 + (int64_t)iDuplicate;
+	}
+	history->_entityArrayStartIndex[0] = 0;
+	history->_entityArrayCount[0] = ENTITY_COUNT;
+	history->_transformTypes[0] = SimulationCacheTranslate;
+	history->_transformTranslate[0][0] = 10.f;
+	history->_entityArrayStartIndex[1] = ENTITY_COUNT;
+	history->_entityArrayCount[1] = DUPLICATE_COUNT;
+	history->_transformTypes[1] = SimulationCacheDuplicate;
+	history->_duplicatedEntityArrayCount[1] = DUPLICATE_COUNT;
+
+	// reference : the full modified frame
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+
+	// deferred, counting its allocations
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	std::vector<GlmEntityTransform> transformsBefore(entityTransforms, entityTransforms + entityTransformCount);
+	int liveAllocationCount = glmTestLiveAllocationCount;
+	GlmDeferredFrameData* deferredFrameData;
+	glmTestAllocationCount = 0;
+	GLM_TEST_CHECK(glmCreateDeferredFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, &deferredFrameData, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	int allocationCount = glmTestAllocationCount;
+	GLM_TEST_CHECK(deferredFrameData != NULL && deferredFrameData->_deferredEntityCount == DUPLICATE_COUNT);
+	GlmFrameData* materializedFrameData;
+	glmMaterializeDeferredFrameData(deferredFrameData, simulationDataOut, &materializedFrameData);
+	GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, simulationDataOut, materializedFrameData));
+	glmDestroyFrameData(&materializedFrameData, simulationDataOut);
+	glmDestroyDeferredFrameData(&deferredFrameData);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount);
+
+	// the deferred data, entity indices and materialized transforms, the materialized simulation data, then the 4 deferred transform arrays
+	int failingAllocations[8] = { 0, 1, 2, 3, allocationCount - 4, allocationCount - 3, allocationCount - 2, allocationCount - 1 };
+	for (int iFailing = 0; iFailing < 8; iFailing++)
+	{
+		memcpy(entityTransforms, &transformsBefore[0], entityTransformCount * sizeof(GlmEntityTransform));
+		deferredFrameData = (GlmDeferredFrameData*)1;
+		glmTestAllocationsBeforeFailure = failingAllocations[iFailing];
+		GLM_TEST_CHECK(glmCreateDeferredFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, &deferredFrameData, 1, glmTestFramePathModel, ".") == GSC_OUT_OF_MEMORY);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(deferredFrameData == NULL);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount);
+		// the transforms are only written back once everything is allocated
+		GLM_TEST_CHECK(memcmp(entityTransforms, &transformsBefore[0], entityTransformCount * sizeof(GlmEntityTransform)) == 0);
+	}
+
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+	glmDestroyHistory(&history);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,226 @@
+// Flat gcg files : written meshes skin exactly as the in memory geometry straight from the mapping, regular gcg files fall back
+// to glmReadGeometryFile, sections outside of the file and magic numbers are rejected when opened, bad influences and triangle indices
+// by glmValidateFlatGeometryFile
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_geometry.h"
+#include <stddef.h>
+
+// glmCrowdIO library stand-ins : a "regular" gcg is a 4 bytes file (magic number, version 0) read as the geometry below
+static GlmTestSkinnedGeometry glmTestRegularGeometry;
+static int glmTestRegularReadCount = 0;
+
+extern "C" GlmGeometryGenerationStatus glmReadGeometryFile(const char* filename, GlmGeometryFile& geometry)
+{
+	std::vector<uint8_t> data;
+	if (!glmTestReadFile(filename, data))
+		return GIO_GCG_FILE_OPEN_FAILED;
+	if (data.size() != 4 || *(uint16_t*)&data[0] != GCG_MAGIC_NUMBER || *(uint16_t*)&data[2] != 0)
+		return GIO_GCG_FILE_BAD_FORMAT;
+	glmTestRegularReadCount++;
+	geometry = glmTestRegularGeometry._geometry;
+	return GIO_SUCCESS;
+}
+
+extern "C" void glmClearGeometryFile(GlmGeometryFile& geometry)
+{
+	memset(&geometry, 0, sizeof(GlmGeometryFile));
+}
+
+// skins a mesh with a random pose, bind pose from geometry
+static std::vector<float> skin(const GlmSkinnedMesh* mesh, const GlmGeometryFile* geometry)
+{
+	std::vector<float> bonePositions, boneOrientations, positions(mesh->_vertexCount * 3 + 3);
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	glmTestCreateRandomPose(geometry->_boneCount, 0x8u, bonePositions, boneOrientations);
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmSkinMesh(mesh, &palette, (float(*)[3])&positions[0], NULL) == GIO_SUCCESS);
+	glmDestroySkinningPalette(&palette);
+	return positions;
+}
+
+static void testRoundTrip(uint8_t skinningType)
+{
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, 777, 20, skinningType, 4, 0x10u + skinningType);
+	GLM_TEST_CHECK(glmWriteFlatGeometryFile("flat.gcg", data._geometry) == GIO_SUCCESS);
+
+	// regular gcg readers check the magic number first
+	std::vector<uint8_t> content;
+	GLM_TEST_CHECK(glmTestReadFile("flat.gcg", content) && *(uint16_t*)&content[0] == GCG_FLAT_MAGIC_NUMBER && GCG_FLAT_MAGIC_NUMBER != GCG_MAGIC_NUMBER);
+
+	GlmSkinnedMesh mesh;
+	GlmSkinnedGeometry skinnedGeometry;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, data._geometry._boneCount) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmOpenSkinnedGeometry("flat.gcg", skinnedGeometry) == GIO_SUCCESS);
+	GLM_TEST_CHECK(skinnedGeometry._flatFile._header != NULL && skinnedGeometry._meshCount == 1);
+	if (skinnedGeometry._meshCount == 1)
+	{
+		// zero copy : the mesh arrays are the mapped sections
+		const GlmSkinnedMesh& flatMesh = skinnedGeometry._meshes[0];
+		const uint8_t* mappingBegin = skinnedGeometry._flatFile._mapping._data;
+		const uint8_t* mappingEnd = mappingBegin + skinnedGeometry._flatFile._mapping._size;
+		GLM_TEST_CHECK(flatMesh._mapped == 1);
+		GLM_TEST_CHECK((const uint8_t*)flatMesh._positions >= mappingBegin && (const uint8_t*)(flatMesh._positions + flatMesh._vertexCount) <= mappingEnd);
+		GLM_TEST_CHECK((const uint8_t*)flatMesh._influenceWeights >= mappingBegin && (const uint8_t*)flatMesh._blendWeights < mappingEnd);
+		GLM_TEST_CHECK(memcmp(flatMesh._positions, mesh._positions, mesh._vertexCount * sizeof(float[4])) == 0);
+		GLM_TEST_CHECK(memcmp(flatMesh._normals, mesh._normals, mesh._vertexCount * sizeof(float[4])) == 0);
+		GLM_TEST_CHECK(memcmp(flatMesh._blendWeights, mesh._blendWeights, mesh._vertexCount * sizeof(float)) == 0);
+
+		std::vector<float> expected = skin(&mesh, &data._geometry);
+		std::vector<float> flat = skin(&skinnedGeometry._meshes[0], &skinnedGeometry._geometry);
+		GLM_TEST_CHECK(memcmp(&expected[0], &flat[0], expected.size() * sizeof(float)) == 0);
+	}
+	glmCloseSkinnedGeometry(skinnedGeometry);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+static void testRegularFallback()
+{
+	uint16_t header[2] = { GCG_MAGIC_NUMBER, 0 };
+	GlmSkinnedGeometry skinnedGeometry;
+	glmTestCreateSkinnedGeometry(glmTestRegularGeometry, 100, 6, GLM_SKIN_LINEAR, 3, 0x20u);
+	GLM_TEST_CHECK(glmTestWriteFile("regular.gcg", header, sizeof(header)));
+	GLM_TEST_CHECK(glmOpenSkinnedGeometry("regular.gcg", skinnedGeometry) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmTestRegularReadCount == 1);
+	GLM_TEST_CHECK(skinnedGeometry._flatFile._header == NULL && skinnedGeometry._meshCount == 1 && skinnedGeometry._meshes[0]._vertexCount == 100);
+	glmCloseSkinnedGeometry(skinnedGeometry);
+
+	GLM_TEST_CHECK(glmOpenSkinnedGeometry("missing.gcg", skinnedGeometry) == GIO_GCG_FILE_OPEN_FAILED);
+	GLM_TEST_CHECK(glmTestRegularReadCount == 1);
+}
+
+// patches a 64 bits value of a valid flat file, the damaged copy must fail to open
+static void checkDamagedOffset(const std::vector<uint8_t>& valid, size_t position, uint64_t value)
+{
+	std::vector<uint8_t> damaged = valid;
+	GlmFlatGeometryFile file;
+	memcpy(&damaged[position], &value, sizeof(uint64_t));
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &damaged[0], damaged.size()));
+	GlmGeometryGenerationStatus status = glmOpenFlatGeometryFile("damaged.gcg", file);
+	GLM_TEST_CHECK(status == GIO_GCG_FILE_BAD_FORMAT);
+	if (status == GIO_SUCCESS)
+		glmCloseFlatGeometryFile(file);
+}
+
+// a damaged copy of a valid flat file must fail to open
+static void checkDamagedFile(const std::vector<uint8_t>& damaged)
+{
+	GlmFlatGeometryFile file;
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &damaged[0], damaged.size()));
+	GlmGeometryGenerationStatus status = glmOpenFlatGeometryFile("damaged.gcg", file);
+	GLM_TEST_CHECK(status == GIO_GCG_FILE_BAD_FORMAT);
+	if (status == GIO_SUCCESS)
+		glmCloseFlatGeometryFile(file);
+}
+
+// a copy of a valid flat file with damaged indices opens, and fails glmValidateFlatGeometryFile
+static void checkInvalidIndices(const std::vector<uint8_t>& damaged)
+{
+	GlmFlatGeometryFile file;
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &damaged[0], damaged.size()));
+	GlmGeometryGenerationStatus status = glmOpenFlatGeometryFile("damaged.gcg", file);
+	GLM_TEST_CHECK(status == GIO_SUCCESS);
+	if (status != GIO_SUCCESS)
+		return;
+	GLM_TEST_CHECK(glmValidateFlatGeometryFile(file) == GIO_GCG_FILE_BAD_FORMAT);
+	glmCloseFlatGeometryFile(file);
+}
+
+static void testDamagedFiles()
+{
+	GlmTestSkinnedGeometry data;
+	std::vector<uint8_t> valid;
+	std::vector<uint32_t> triangles(30);
+	glmTestCreateSkinnedGeometry(data, 50, 4, GLM_SKIN_BLEND, 4, 0x30u);
+	for (uint32_t i = 0; i < 30; i++)
+		triangles[i] = i;
+	data._mesh._triangleCount = 10;
+	data._mesh._vertexIndicesPerTriangle = (uint32_t(*)[3])&triangles[0];
+	GLM_TEST_CHECK(glmWriteFlatGeometryFile("flat.gcg", data._geometry) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmTestReadFile("flat.gcg", valid));
+	const GlmFlatGeometryHeader* header = (const GlmFlatGeometryHeader*)&valid[0];
+	uint64_t size = valid.size();
+
+	// every section starting at the end of the file, misaligned, or wrapping around
+	size_t headerOffsets[6] = { offsetof(GlmFlatGeometryHeader, _meshesOffset), offsetof(GlmFlatGeometryHeader, _boneParentingOffset), offsetof(GlmFlatGeometryHeader, _boneOffsetPositionsOffset),
+		offsetof(GlmFlatGeometryHeader, _boneOffsetOrientationsOffset), offsetof(GlmFlatGeometryHeader, _boneJointOrientationsOffset), offsetof(GlmFlatGeometryHeader, _boneNameOffsetsOffset) };
+	for (int i = 0; i < 6; i++)
+	{
+		checkDamagedOffset(valid, headerOffsets[i], size);
+		checkDamagedOffset(valid, headerOffsets[i], *(const uint64_t*)&valid[headerOffsets[i]] + 4);
+		checkDamagedOffset(valid, headerOffsets[i], UINT64_MAX - GCG_FLAT_ALIGNMENT + 1);
+	}
+	size_t meshOffsets[8] = { offsetof(GlmFlatGeometryMesh, _positionsOffset), offsetof(GlmFlatGeometryMesh, _normalsOffset), offsetof(GlmFlatGeometryMesh, _uvsOffset), offsetof(GlmFlatGeometryMesh, _blendWeightsOffset),
+		offsetof(GlmFlatGeometryMesh, _influenceOffsetsOffset), offsetof(GlmFlatGeometryMesh, _influenceBoneIdsOffset), offsetof(GlmFlatGeometryMesh, _influenceWeightsOffset), offsetof(GlmFlatGeometryMesh, _trianglesOffset) };
+	for (int i = 0; i < 8; i++)
+	{
+		size_t position = (size_t)header->_meshesOffset + meshOffsets[i];
+		checkDamagedOffset(valid, position, size);
+		checkDamagedOffset(valid, position, *(const uint64_t*)&valid[position] + 4);
+	}
+	// bone and mesh names past the end of the file
+	checkDamagedOffset(valid, (size_t)header->_boneNameOffsetsOffset, size);
+	checkDamagedOffset(valid, (size_t)header->_meshesOffset + offsetof(GlmFlatGeometryMesh, _nameOffset), size);
+
+	// truncated file
+	GlmFlatGeometryFile file;
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &valid[0], valid.size() - 1));
+	GLM_TEST_CHECK(glmOpenFlatGeometryFile("damaged.gcg", file) == GIO_GCG_FILE_BAD_FORMAT);
+
+	// the valid file passes the validation
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &valid[0], valid.size()));
+	GLM_TEST_CHECK(glmOpenFlatGeometryFile("damaged.gcg", file) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmValidateFlatGeometryFile(file) == GIO_SUCCESS);
+	glmCloseFlatGeometryFile(file);
+
+	// last influence offset not matching the influence count : rejected when opened
+	const GlmFlatGeometryMesh* flatMesh = (const GlmFlatGeometryMesh*)&valid[(size_t)header->_meshesOffset];
+	std::vector<uint8_t> damaged = valid;
+	((uint32_t*)&damaged[(size_t)flatMesh->_influenceOffsetsOffset])[flatMesh->_vertexCount]++;
+	checkDamagedFile(damaged);
+
+	// influences : bone id past the bone count, decreasing offsets
+	damaged = valid;
+	((uint16_t*)&damaged[(size_t)flatMesh->_influenceBoneIdsOffset])[7] = 4;
+	checkInvalidIndices(damaged);
+	damaged = valid;
+	((uint32_t*)&damaged[(size_t)flatMesh->_influenceOffsetsOffset])[10] = flatMesh->_influenceCount;
+	checkInvalidIndices(damaged);
+
+	// triangle indices : the last vertex is valid, one past it or far away is not, in the first and in the last triangle
+	damaged = valid;
+	((uint32_t*)&damaged[(size_t)flatMesh->_trianglesOffset])[29] = flatMesh->_vertexCount - 1;
+	GLM_TEST_CHECK(glmTestWriteFile("damaged.gcg", &damaged[0], damaged.size()));
+	GLM_TEST_CHECK(glmOpenFlatGeometryFile("damaged.gcg", file) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmValidateFlatGeometryFile(file) == GIO_SUCCESS);
+	glmCloseFlatGeometryFile(file);
+	const size_t corruptIndices[2] = { 0, 29 };
+	const uint32_t corruptValues[3] = { flatMesh->_vertexCount, flatMesh->_vertexCount + 1000, UINT32_MAX };
+	for (int iIndex = 0; iIndex < 2; iIndex++)
+		for (int iValue = 0; iValue < 3; iValue++)
+		{
+			damaged = valid;
+			((uint32_t*)&damaged[(size_t)flatMesh->_trianglesOffset])[corruptIndices[iIndex]] = corruptValues[iValue];
+			checkInvalidIndices(damaged);
+		}
+
+	// a file with the regular gcg magic number, as the first flat files (version 0x10), is not opened as a flat file
+	damaged = valid;
+	*(uint16_t*)&damaged[offsetof(GlmFlatGeometryHeader, _magicNumber)] = GCG_MAGIC_NUMBER;
+	*(uint16_t*)&damaged[offsetof(GlmFlatGeometryHeader, _version)] = 0x10;
+	checkDamagedFile(damaged);
+	damaged = valid;
+	*(uint16_t*)&damaged[offsetof(GlmFlatGeometryHeader, _version)] = GCG_FLAT_VERSION + 1;
+	checkDamagedFile(damaged);
+}
+
+int main()
+{
+	for (uint8_t skinningType = GLM_SKIN_RIGID; skinningType <= GLM_SKIN_BLEND; skinningType++)
+		testRoundTrip(skinningType);
+	testRegularFallback();
+	testDamagedFiles();
+	return glmTestResult();
+}
@@ -0,0 +1,270 @@
+// Chunked .gscf files (glmWriteFrameDataBlocks) : whole, compressed, entity range and entity type reads decode the same bytes as plain files,
+// with entity types whose index in entity type does not follow the simulation order. Block tables and block cloth counts that do not match are rejected
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+#include <algorithm>
+
+// bit exact comparison of the frame data of one entity, cloth entities may have different indices
+static int glmTestSameEntity(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, uint32_t iEntity)
+{
+	uint16_t entityType = simulationData->_entityTypes[iEntity];
+	uint32_t indexInEntityType = simulationData->_indexInEntityType[iEntity];
+	uint32_t boneCount = simulationData->_boneCount[entityType];
+	uint32_t firstBone = simulationData->_iBoneOffsetPerEntityType[entityType] + indexInEntityType * boneCount;
+	uint32_t snsCount = simulationData->_snsCountPerEntityType[entityType];
+	uint32_t firstSns = simulationData->_snsOffsetPerEntityType[entityType] + indexInEntityType * snsCount;
+	uint32_t blindDataCount = simulationData->_blindDataCount[entityType];
+	uint32_t firstBlindData = simulationData->_iBlindDataOffsetPerEntityType[entityType] + indexInEntityType * blindDataCount;
+	if (memcmp(frameData1->_bonePositions[firstBone], frameData2->_bonePositions[firstBone], boneCount * sizeof(float[3])) != 0
+		|| memcmp(frameData1->_boneOrientations[firstBone], frameData2->_boneOrientations[firstBone], boneCount * sizeof(float[4])) != 0
+		|| memcmp(frameData1->_snsValues[firstSns], frameData2->_snsValues[firstSns], snsCount * sizeof(float[4])) != 0
+		|| memcmp(frameData1->_blindData + firstBlindData, frameData2->_blindData + firstBlindData, blindDataCount * sizeof(float)) != 0
+		|| memcmp(&frameData1->_ppFloatAttributeData[0][iEntity], &frameData2->_ppFloatAttributeData[0][iEntity], sizeof(float)) != 0
+		|| memcmp(frameData1->_ppVectorAttributeData[0][iEntity], frameData2->_ppVectorAttributeData[0][iEntity], sizeof(float[3])) != 0)
+		return 0;
+	if (simulationData->_hasGeoBehavior[entityType])
+	{
+		uint32_t geoBehavior = simulationData->_iGeoBehaviorOffsetPerEntityType[entityType] + indexInEntityType;
+		if (frameData1->_geoBehaviorGeometryIds[geoBehavior] != frameData2->_geoBehaviorGeometryIds[geoBehavior]
+			|| memcmp(frameData1->_geoBehaviorAnimFrameInfo[geoBehavior], frameData2->_geoBehaviorAnimFrameInfo[geoBehavior], sizeof(float[3])) != 0
+			|| frameData1->_geoBehaviorBlendModes[geoBehavior] != frameData2->_geoBehaviorBlendModes[geoBehavior])
+			return 0;
+	}
+
+	int32_t clothIndex1 = frameData1->_clothEntityCount ? frameData1->_entityClothIndex[iEntity] : -1;
+	int32_t clothIndex2 = frameData2->_clothEntityCount ? frameData2->_entityClothIndex[iEntity] : -1;
+	if ((clothIndex1 < 0) || (clothIndex2 < 0))
+		return (clothIndex1 < 0) == (clothIndex2 < 0);
+	uint32_t meshCount = frameData1->_clothEntityMeshCount[clothIndex1];
+	uint32_t firstMesh1 = frameData1->_clothEntityFirstAssetMeshIndex[clothIndex1];
+	uint32_t firstMesh2 = frameData2->_clothEntityFirstAssetMeshIndex[clothIndex2];
+	uint32_t vertexCount = 0;
+	for (uint32_t iMesh = 0; iMesh < meshCount; iMesh++)
+		vertexCount += frameData1->_clothMeshVertexCount[firstMesh1 + iMesh];
+	return meshCount == frameData2->_clothEntityMeshCount[clothIndex2]
+		&& memcmp(frameData1->_clothMeshIndicesInCharAssets + firstMesh1, frameData2->_clothMeshIndicesInCharAssets + firstMesh2, meshCount * sizeof(uint32_t)) == 0
+		&& memcmp(frameData1->_clothMeshVertexCount + firstMesh1, frameData2->_clothMeshVertexCount + firstMesh2, meshCount * sizeof(uint32_t)) == 0
+		&& memcmp(frameData1->_clothEntityQuantizationReference[clothIndex1], frameData2->_clothEntityQuantizationReference[clothIndex2], sizeof(float[3])) == 0
+		&& frameData1->_clothEntityQuantizationMaxExtent[clothIndex1] == frameData2->_clothEntityQuantizationMaxExtent[clothIndex2]
+		&& memcmp(frameData1->_clothVertices[frameData1->_clothEntityFirstMeshVertex[clothIndex1]], frameData2->_clothVertices[frameData2->_clothEntityFirstMeshVertex[clothIndex2]],
+			vertexCount * sizeof(float[3])) == 0;
+}
+
+// frame with zero bones, to tell the entities of the blocks that were read
+static void glmTestCreateEmptyFrame(GlmFrameData** frameData, const GlmSimulationData* simulationData)
+{
+	glmCreateFrameData(frameData, simulationData);
+	memset((*frameData)->_bonePositions, 0, glmTestTotalBoneCount(simulationData) * sizeof(float[3]));
+}
+
+static int glmTestRootIsZero(const GlmSimulationData* simulationData, const GlmFrameData* frameData, uint32_t iEntity)
+{
+	uint16_t entityType = simulationData->_entityTypes[iEntity];
+	uint32_t rootBone = simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_indexInEntityType[iEntity] * simulationData->_boneCount[entityType];
+	return frameData->_bonePositions[rootBone][0] == 0.f && frameData->_bonePositions[rootBone][1] == 0.f && frameData->_bonePositions[rootBone][2] == 0.f;
+}
+
+// glmFileRead arrays of more than one element are zlib compressed behind their compressed size
+static void glmTestSkipArray(FILE* fp, long elementSize, long count)
+{
+	uint32_t compressedSize = 0;
+	if (count <= 1)
+	{
+		fseek(fp, elementSize * count, SEEK_CUR);
+		return;
+	}
+	if (fread(&compressedSize, sizeof(uint32_t), 1, fp) == 1)
+		fseek(fp, (long)compressedSize, SEEK_CUR);
+}
+
+static void glmTestPatchUInt32(std::vector<uint8_t>& bytes, long offset, uint32_t value)
+{
+	memcpy(&bytes[offset], &value, sizeof(uint32_t));
+}
+
+static GlmSimulationCacheStatus glmTestReadPatched(const std::vector<uint8_t>& bytes, const GlmSimulationData* simulationData, const char* file)
+{
+	GlmFrameData* frameData;
+	glmTestWriteFile(file, &bytes[0], bytes.size());
+	glmCreateFrameData(&frameData, simulationData);
+	GlmSimulationCacheStatus status = glmReadFrameData(frameData, simulationData, file);
+	glmDestroyFrameData(&frameData, simulationData);
+	return status;
+}
+
+// one bone entities of one entity type without geo behavior, one entity per block : the cloth counts of the first block are at known offsets
+static void glmTestCorruptBlockCloth()
+{
+	const char* file = "frame_blocks_cloth.gscf";
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, 2, 1, 1);
+	glmTestCreateFrame(&frameData, simulationData, 0x31u, 1, 3);
+	frameData->_cacheFormat = (uint8_t)GSC_O64_P96;
+	GLM_TEST_CHECK(glmWriteFrameDataBlocks(file, frameData, simulationData, 1) == GSC_SUCCESS);
+	std::vector<uint8_t> bytes;
+	GLM_TEST_CHECK(glmTestReadFile(file, bytes));
+	GLM_TEST_CHECK(glmTestReadPatched(bytes, simulationData, file) == GSC_SUCCESS);
+
+	// header : magic number, version, format, hash key, entity block size, block table offset
+	long clothEntityCountOffset = 0, meshCountOffset = 0;
+	FILE* fp = fopen(file, "rb");
+	GLM_TEST_CHECK(fp != NULL);
+	if (fp)
+	{
+		fseek(fp, 2 + 1 + 1 + 4 + 4 + 8, SEEK_SET);
+		glmTestSkipArray(fp, sizeof(float), 3); // bone positions
+		glmTestSkipArray(fp, sizeof(uint64_t), 1); // bone orientations
+		glmTestSkipArray(fp, sizeof(float), 4); // sns
+		glmTestSkipArray(fp, sizeof(float), 2); // blind data
+		glmTestSkipArray(fp, sizeof(float), 1); // pp float
+		glmTestSkipArray(fp, sizeof(float), 3); // pp vector
+		clothEntityCountOffset = ftell(fp);
+		fseek(fp, sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t), SEEK_CUR); // cloth entity count, entity use cloth, cloth entity mesh count
+		glmTestSkipArray(fp, sizeof(float), 3); // quantization reference
+		fseek(fp, sizeof(float), SEEK_CUR); // quantization max extent
+		meshCountOffset = ftell(fp);
+		fclose(fp);
+	}
+	GLM_TEST_CHECK(bytes[clothEntityCountOffset] == 1 && bytes[meshCountOffset] == 1 && bytes[meshCountOffset + 12] == 3);
+
+	std::vector<uint8_t> patched = bytes;
+	glmTestPatchUInt32(patched, clothEntityCountOffset, 2); // more cloth entities than entities
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	patched = bytes;
+	patched[clothEntityCountOffset + 4] = 0; // entity use cloth
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	patched = bytes;
+	glmTestPatchUInt32(patched, clothEntityCountOffset + 5, 2); // cloth entity mesh count
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	patched = bytes;
+	glmTestPatchUInt32(patched, meshCountOffset, 0xffffffffu); // block mesh count
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	patched = bytes;
+	glmTestPatchUInt32(patched, meshCountOffset + 8, 0xfffffffeu); // mesh vertex count
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	patched = bytes;
+	glmTestPatchUInt32(patched, meshCountOffset + 12, 4); // block vertex count
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+
+	// block table outside of the file
+	uint64_t blockTableOffset;
+	patched = bytes;
+	blockTableOffset = bytes.size();
+	memcpy(&patched[12], &blockTableOffset, sizeof(uint64_t));
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	blockTableOffset = 0;
+	memcpy(&patched[12], &blockTableOffset, sizeof(uint64_t));
+	GLM_TEST_CHECK(glmTestReadPatched(patched, simulationData, file) == GSC_FILE_FORMAT_ERROR);
+	remove(file);
+
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+}
+
+int main()
+{
+	const GlmSimulationCacheFormat formats[5] = { GSC_O64_P96, GSC_O32_P96, GSC_O128_P48, GSC_O64_P48, GSC_O32_P48 };
+	const unsigned int blockSizes[4] = { 1, 4, 7, 1000 };
+	const char* plainFile = "frame_blocks_plain.gscf";
+	const char* blocksFile = "frame_blocks.gscf";
+
+	// indices in entity type run backwards, so blocks in simulation order are not contiguous in the frame arrays
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, 53, 3, 4);
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationData->_entityTypes[iEntity];
+		simulationData->_indexInEntityType[iEntity] = simulationData->_entityCountPerEntityType[entityType] - 1 - simulationData->_indexInEntityType[iEntity];
+	}
+	glmTestCreateFrame(&frameData, simulationData, 0x99u, 3, 5);
+	std::vector<float> clothVertices(frameData->_clothVertices[0], frameData->_clothVertices[0] + frameData->_clothTotalVertices * 3);
+
+	for (int iFormat = 0; iFormat < 5; iFormat++)
+	{
+		frameData->_cacheFormat = (uint8_t)formats[iFormat];
+		GLM_TEST_CHECK(glmWriteFrameData(plainFile, frameData, simulationData) == GSC_SUCCESS);
+		memcpy(frameData->_clothVertices, &clothVertices[0], clothVertices.size() * sizeof(float)); // the writer quantizes in place
+		GlmFrameData* plainFrameData;
+		glmCreateFrameData(&plainFrameData, simulationData);
+		GLM_TEST_CHECK(glmReadFrameData(plainFrameData, simulationData, plainFile) == GSC_SUCCESS);
+		remove(plainFile);
+
+		for (int iBlockSize = 0; iBlockSize < 4; iBlockSize++)
+		{
+			GLM_TEST_CHECK(glmWriteFrameDataBlocks(blocksFile, frameData, simulationData, blockSizes[iBlockSize]) == GSC_SUCCESS);
+
+			// whole frame
+			GlmFrameData* blocksFrameData;
+			glmCreateFrameData(&blocksFrameData, simulationData);
+			GLM_TEST_CHECK(glmReadFrameData(blocksFrameData, simulationData, blocksFile) == GSC_SUCCESS);
+			GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationData, plainFrameData, simulationData, blocksFrameData));
+			GLM_TEST_CHECK(glmTestSameFrameAttributes(simulationData, plainFrameData, blocksFrameData));
+			glmDestroyFrameData(&blocksFrameData, simulationData);
+
+			// compressed frame, bones kept in their file encoding
+			GlmCompressedFrameData* compressedFrameData = NULL;
+			GLM_TEST_CHECK(glmCreateAndReadCompressedFrameData(&compressedFrameData, simulationData, blocksFile) == GSC_SUCCESS);
+			if (compressedFrameData)
+			{
+				glmDecompressFrameData(compressedFrameData, simulationData, &blocksFrameData);
+				GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationData, plainFrameData, simulationData, blocksFrameData));
+				GLM_TEST_CHECK(glmTestSameFrameAttributes(simulationData, plainFrameData, blocksFrameData));
+				glmDestroyFrameData(&blocksFrameData, simulationData);
+				glmDestroyCompressedFrameData(&compressedFrameData, simulationData);
+			}
+
+			// entity ranges : every entity of the range is read, one entity blocks read nothing else
+			const uint32_t ranges[5][2] = { { 0, 1 }, { 10, 7 }, { 50, 3 }, { 0, 53 }, { 20, 0 } };
+			for (int iRange = 0; iRange < 5; iRange++)
+			{
+				glmTestCreateEmptyFrame(&blocksFrameData, simulationData);
+				GLM_TEST_CHECK(glmReadFrameDataEntityRange(blocksFrameData, simulationData, blocksFile, ranges[iRange][0], ranges[iRange][1]) == GSC_SUCCESS);
+				for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+				{
+					int inRange = iEntity >= ranges[iRange][0] && iEntity - ranges[iRange][0] < ranges[iRange][1];
+					if (inRange)
+						GLM_TEST_CHECK(glmTestSameEntity(simulationData, plainFrameData, blocksFrameData, iEntity));
+					else if (blockSizes[iBlockSize] == 1)
+						GLM_TEST_CHECK(glmTestRootIsZero(simulationData, blocksFrameData, iEntity));
+				}
+				glmDestroyFrameData(&blocksFrameData, simulationData);
+			}
+
+			// entity types
+			uint8_t entityTypeEnabled[3] = { 0, 1, 0 };
+			glmTestCreateEmptyFrame(&blocksFrameData, simulationData);
+			GLM_TEST_CHECK(glmReadFrameDataEntityTypes(blocksFrameData, simulationData, blocksFile, entityTypeEnabled) == GSC_SUCCESS);
+			for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+			{
+				if (simulationData->_entityTypes[iEntity] == 1)
+					GLM_TEST_CHECK(glmTestSameEntity(simulationData, plainFrameData, blocksFrameData, iEntity));
+				else
+					GLM_TEST_CHECK(glmTestRootIsZero(simulationData, blocksFrameData, iEntity));
+			}
+			glmDestroyFrameData(&blocksFrameData, simulationData);
+
+			// entities 0 and 1 swap their entity types : the block table entity ranges do not match anymore
+			std::swap(simulationData->_entityTypes[0], simulationData->_entityTypes[1]);
+			std::swap(simulationData->_indexInEntityType[0], simulationData->_indexInEntityType[1]);
+			glmCreateFrameData(&blocksFrameData, simulationData);
+			GLM_TEST_CHECK(glmReadFrameData(blocksFrameData, simulationData, blocksFile) == GSC_FILE_FORMAT_ERROR);
+			compressedFrameData = NULL;
+			GLM_TEST_CHECK(glmCreateAndReadCompressedFrameData(&compressedFrameData, simulationData, blocksFile) == GSC_FILE_FORMAT_ERROR);
+			GLM_TEST_CHECK(compressedFrameData == NULL);
+			glmDestroyFrameData(&blocksFrameData, simulationData);
+			std::swap(simulationData->_entityTypes[0], simulationData->_entityTypes[1]);
+			std::swap(simulationData->_indexInEntityType[0], simulationData->_indexInEntityType[1]);
+			remove(blocksFile);
+		}
+		glmDestroyFrameData(&plainFrameData, simulationData);
+	}
+
+	glmTestCorruptBlockCloth();
+
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
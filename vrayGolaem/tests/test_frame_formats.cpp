@@ -0,0 +1,195 @@
+// Frame bones and cloth vertices written and read back in the six GlmSimulationCacheFormat : unquantized encodings are read exactly,
+// quantized ones within their quantization step, every frame kernel level and the GlmFrameDecoder of the format decode the same bytes
+// and whole .gscf files decode the same
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static int glmTestWithin(const float* a, const float* b, size_t count, float tolerance)
+{
+	for (size_t i = 0; i < count; i++)
+		if (!(fabsf(a[i] - b[i]) <= tolerance))
+			return 0;
+	return 1;
+}
+
+// quantized orientations may come back with the opposite sign, same rotation
+static int glmTestSameRotations(const float(*a)[4], const float(*b)[4], size_t count, float tolerance)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		float sign = a[i][0] * b[i][0] + a[i][1] * b[i][1] + a[i][2] * b[i][2] + a[i][3] * b[i][3] < 0.f ? -1.f : 1.f;
+		for (int iComp = 0; iComp < 4; iComp++)
+			if (!(fabsf(a[i][iComp] - sign * b[i][iComp]) <= tolerance))
+				return 0;
+	}
+	return 1;
+}
+
+static int glmTestSameBonesAndCloth(const GlmFrameData* frameData1, const GlmFrameData* frameData2, uint32_t totalBoneCount)
+{
+	return memcmp(frameData1->_bonePositions, frameData2->_bonePositions, totalBoneCount * sizeof(float[3])) == 0
+		&& memcmp(frameData1->_boneOrientations, frameData2->_boneOrientations, totalBoneCount * sizeof(float[4])) == 0
+		&& frameData1->_clothTotalVertices == frameData2->_clothTotalVertices
+		&& (frameData1->_clothTotalVertices == 0 || memcmp(frameData1->_clothVertices, frameData2->_clothVertices, frameData1->_clothTotalVertices * sizeof(float[3])) == 0);
+}
+
+// bones and cloth vertices of file read through the compile time decoder of format
+template <GlmSimulationCacheFormat format>
+static void glmTestReadWithDecoder(const char* file, GlmFrameData* frameData, const GlmSimulationData* simulationData, uint32_t totalBoneCount)
+{
+	FILE* fp = fopen(file, "rb");
+	GLM_TEST_CHECK(fp != NULL);
+	if (!fp)
+		return;
+	GlmFrameDecoder<format>::readPositions(frameData->_bonePositions, totalBoneCount, simulationData, fp);
+	GlmFrameDecoder<format>::readOrientations(frameData->_boneOrientations, totalBoneCount, fp);
+	GlmFrameDecoder<format>::readClothVertices(frameData, fp);
+	GLM_TEST_CHECK(fgetc(fp) == EOF);
+	fclose(fp);
+}
+
+int main()
+{
+	const GlmSimulationCacheFormat formats[6] = { GSC_O128_P96, GSC_O64_P96, GSC_O32_P96, GSC_O128_P48, GSC_O64_P48, GSC_O32_P48 };
+	const float orientationTolerances[6] = { 0.f, 5e-5f, 5e-3f, 0.f, 5e-5f, 5e-3f };
+	const GlmSimdLevel levels[3] = { GSC_SIMD_SCALAR, GSC_SIMD_SSE2, GSC_SIMD_AVX2 };
+	void(*const decoderReaders[6])(const char*, GlmFrameData*, const GlmSimulationData*, uint32_t) = {
+		glmTestReadWithDecoder<GSC_O128_P96>, glmTestReadWithDecoder<GSC_O64_P96>, glmTestReadWithDecoder<GSC_O32_P96>,
+		glmTestReadWithDecoder<GSC_O128_P48>, glmTestReadWithDecoder<GSC_O64_P48>, glmTestReadWithDecoder<GSC_O32_P48> };
+	uint32_t randomState = 0xf0e1u;
+
+	// odd bone counts so that the child bone ranges of the 48bit positions end with kernel tails
+	GlmSimulationData* simulationData;
+	GlmFrameData* frameData;
+	glmTestCreateSimulation(&simulationData, 37, 3, 6);
+	glmTestCreateFrame(&frameData, simulationData, 0x4321u, 3, 13);
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+
+	// 48bit child positions are relative to the root and within the hierarchy length
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationData->_entityTypes[iEntity];
+		uint32_t firstBone = simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_indexInEntityType[iEntity] * simulationData->_boneCount[entityType];
+		float maxExtent = simulationData->_maxBonesHierarchyLength[entityType] * 0.95f;
+		for (uint32_t iBone = 1; iBone < simulationData->_boneCount[entityType]; iBone++)
+			for (int i = 0; i < 3; i++)
+				frameData->_bonePositions[firstBone + iBone][i] = frameData->_bonePositions[firstBone][i] + glmTestRandomRange(&randomState, -maxExtent, maxExtent);
+	}
+	std::vector<float> clothVertices(frameData->_clothVertices[0], frameData->_clothVertices[0] + frameData->_clothTotalVertices * 3);
+
+	for (int iFormat = 0; iFormat < 6; iFormat++)
+	{
+		// bones and cloth vertices encoded as in a .gscf
+		char file[64];
+		sprintf(file, "frame_format_%d.bin", (int)formats[iFormat]);
+		FILE* fp = fopen(file, "wb");
+		GLM_TEST_CHECK(fp != NULL);
+		if (!fp)
+			continue;
+		glmFileWritePositions(frameData->_bonePositions, totalBoneCount, simulationData, fp, formats[iFormat]);
+		glmFileWriteOrientations(frameData->_boneOrientations, totalBoneCount, fp, formats[iFormat]);
+		glmFileWriteClothVertices(frameData, fp, formats[iFormat]);
+		fclose(fp);
+		memcpy(frameData->_clothVertices, &clothVertices[0], clothVertices.size() * sizeof(float)); // the writer quantizes in place
+
+		// the same bytes are decoded by every frame kernel level
+		GlmFrameData* referenceFrameData = NULL;
+		for (int iLevel = 0; iLevel < 3; iLevel++)
+		{
+			GlmFrameData* readFrameData;
+			glmSetSimdLevel(levels[iLevel]);
+			glmTestCreateFrame(&readFrameData, simulationData, 0x4321u, 3, 13);
+			memset(readFrameData->_bonePositions, 0, totalBoneCount * sizeof(float[3]));
+			memset(readFrameData->_boneOrientations, 0, totalBoneCount * sizeof(float[4]));
+			memset(readFrameData->_clothVertices, 0, readFrameData->_clothTotalVertices * sizeof(float[3]));
+			fp = fopen(file, "rb");
+			GLM_TEST_CHECK(fp != NULL);
+			if (fp)
+			{
+				glmFileReadPositions(readFrameData->_bonePositions, totalBoneCount, simulationData, fp, formats[iFormat]);
+				glmFileReadOrientations(readFrameData->_boneOrientations, totalBoneCount, fp, formats[iFormat]);
+				glmFileReadClothVertices(readFrameData, fp, formats[iFormat]);
+				GLM_TEST_CHECK(fgetc(fp) == EOF);
+				fclose(fp);
+			}
+			if (referenceFrameData == NULL)
+			{
+				referenceFrameData = readFrameData;
+				continue;
+			}
+			GLM_TEST_CHECK(glmTestSameBonesAndCloth(referenceFrameData, readFrameData, totalBoneCount));
+			glmDestroyFrameData(&readFrameData, simulationData);
+		}
+		glmInitSimdDispatch();
+
+		// GlmFrameDecoder<format> called directly decodes like the runtime dispatch
+		GlmFrameData* decoderFrameData;
+		glmTestCreateFrame(&decoderFrameData, simulationData, 0x4321u, 3, 13);
+		memset(decoderFrameData->_bonePositions, 0, totalBoneCount * sizeof(float[3]));
+		decoderReaders[iFormat](file, decoderFrameData, simulationData, totalBoneCount);
+		GLM_TEST_CHECK(glmTestSameBonesAndCloth(referenceFrameData, decoderFrameData, totalBoneCount));
+		glmDestroyFrameData(&decoderFrameData, simulationData);
+		remove(file);
+
+		int positions48 = formats[iFormat] >= GSC_O128_P48;
+		float positionTolerance = positions48 ? simulationData->_maxBonesHierarchyLength[0] * 4.f / 65535.f : 0.f;
+		float clothTolerance = positions48 ? 50.f * 4.f / 65535.f : 0.f;
+		GLM_TEST_CHECK(glmTestWithin(referenceFrameData->_bonePositions[0], frameData->_bonePositions[0], totalBoneCount * 3, positionTolerance));
+		GLM_TEST_CHECK(glmTestSameRotations(referenceFrameData->_boneOrientations, frameData->_boneOrientations, totalBoneCount, orientationTolerances[iFormat]));
+		GLM_TEST_CHECK(glmTestWithin(referenceFrameData->_clothVertices[0], &clothVertices[0], clothVertices.size(), clothTolerance));
+
+		// roots are never quantized
+		for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+			for (uint32_t iEntity = 0; iEntity < simulationData->_entityCountPerEntityType[iType]; iEntity++)
+			{
+				uint32_t rootBone = simulationData->_iBoneOffsetPerEntityType[iType] + iEntity * simulationData->_boneCount[iType];
+				GLM_TEST_CHECK(memcmp(referenceFrameData->_bonePositions[rootBone], frameData->_bonePositions[rootBone], sizeof(float[3])) == 0);
+			}
+
+		// whole .gscf files decode the same, glmReadFrameData rejects GSC_O128_P96 files
+		sprintf(file, "frame_format_%d.gscf", (int)formats[iFormat]);
+		frameData->_cacheFormat = (uint8_t)formats[iFormat];
+		GLM_TEST_CHECK(glmWriteFrameData(file, frameData, simulationData) == GSC_SUCCESS);
+		memcpy(frameData->_clothVertices, &clothVertices[0], clothVertices.size() * sizeof(float));
+		GlmFrameData* fileFrameData;
+		glmCreateFrameData(&fileFrameData, simulationData);
+		GlmSimulationCacheStatus status = glmReadFrameData(fileFrameData, simulationData, file);
+		if (formats[iFormat] == GSC_O128_P96)
+		{
+			GLM_TEST_CHECK(status == GSC_FILE_FORMAT_ERROR);
+		}
+		else
+		{
+			GLM_TEST_CHECK(status == GSC_SUCCESS);
+			GLM_TEST_CHECK(glmTestSameBonesAndCloth(referenceFrameData, fileFrameData, totalBoneCount));
+		}
+		glmDestroyFrameData(&fileFrameData, simulationData);
+		glmDestroyFrameData(&referenceFrameData, simulationData);
+		remove(file);
+	}
+	glmInitSimdDispatch();
+
+	// unknown formats are read as GSC_O128_P96
+	float orientations[2][4] = { { 0.1f, 0.2f, 0.3f, 0.4f }, { -0.5f, 0.6f, -0.7f, 0.8f } };
+	float readOrientations[2][4];
+	FILE* fp = fopen("frame_format_unknown.bin", "wb");
+	GLM_TEST_CHECK(fp != NULL);
+	if (fp)
+	{
+		glmFileWriteOrientations(orientations, 2, fp, GSC_O128_P96);
+		fclose(fp);
+		fp = fopen("frame_format_unknown.bin", "rb");
+	}
+	if (fp)
+	{
+		glmFileReadOrientations(readOrientations, 2, fp, (GlmSimulationCacheFormat)17);
+		fclose(fp);
+		GLM_TEST_CHECK(memcmp(readOrientations, orientations, sizeof(orientations)) == 0);
+	}
+	remove("frame_format_unknown.bin");
+
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,179 @@
+// glmCreateFrameSamples on a .gscf frame range : samples at integer and sub-frame times match the strict interpolation of
+// the surrounding frames, samples past the last frame clamp to it, sub-frame samples just before the first frame clamp to the first one,
+// distant sample times allocate only their own frames, and its own allocations failing return GSC_OUT_OF_MEMORY without leak
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationCount = 0;
+static size_t glmTestLargestAllocation = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail, only the allocation it counts down to fails
+static void* glmTestMalloc(size_t size)
+{
+	glmTestAllocationCount++;
+	if (size > glmTestLargestAllocation)
+		glmTestLargestAllocation = size;
+	if (glmTestAllocationsBeforeFailure == 0)
+	{
+		glmTestAllocationsBeforeFailure = -1;
+		return NULL;
+	}
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+#define GLM_TEST_FRAME_MODEL "./frame_samples.%d.gscf"
+enum { FIRST_FRAME = 10, LAST_FRAME = 13 };
+
+// bones of sample iSample bit exact to the strict interpolation of frameData1 and frameData2
+static int glmTestSameSample(const GlmFrameSamples* samples, unsigned int iSample, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* expected)
+{
+	glmInterpolateFrameDataBones(frameData1, frameData2, ratio, expected, 0, samples->_boneValueCount, GSC_INTERPOLATION_STRICT);
+	return memcmp(samples->_bonePositions + (size_t)iSample * samples->_boneValueCount, expected->_bonePositions, samples->_boneValueCount * sizeof(float[3])) == 0
+		&& memcmp(samples->_boneOrientations + (size_t)iSample * samples->_boneValueCount, expected->_boneOrientations, samples->_boneValueCount * sizeof(float[4])) == 0;
+}
+
+int main()
+{
+	GlmSimulationData* simulationData = NULL;
+	glmTestCreateSimulation(&simulationData, 24, 2, 6);
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+
+	// frames FIRST_FRAME..LAST_FRAME written, then read back so references carry the file quantization
+	GlmFrameData* frames[LAST_FRAME - FIRST_FRAME + 1];
+	char file[256];
+	for (int iFrame = FIRST_FRAME; iFrame <= LAST_FRAME; iFrame++)
+	{
+		GlmFrameData* frameData = NULL;
+		glmTestCreateFrame(&frameData, simulationData, 101 + iFrame, 0, 0);
+		frameData->_cacheFormat = (uint8_t)GSC_O64_P96;
+		sprintf(file, GLM_TEST_FRAME_MODEL, iFrame);
+		GLM_TEST_CHECK(glmWriteFrameData(file, frameData, simulationData) == GSC_SUCCESS);
+		GLM_TEST_CHECK(glmReadFrameData(frameData, simulationData, file) == GSC_SUCCESS);
+		frames[iFrame - FIRST_FRAME] = frameData;
+	}
+	GlmFrameData* expected = NULL;
+	glmCreateFrameData(&expected, simulationData);
+
+	// in range, unsorted sample times keep their order
+	{
+		const float sampleTimes[5] = { 12.75f, 10.f, 10.25f, 11.5f, 13.f };
+		GlmFrameSamples* samples = NULL;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 5, GLM_TEST_FRAME_MODEL, ".") == GSC_SUCCESS);
+		GLM_TEST_CHECK(samples != NULL);
+		if (samples)
+		{
+			GLM_TEST_CHECK(samples->_sampleCount == 5);
+			GLM_TEST_CHECK(samples->_boneValueCount == totalBoneCount);
+			GLM_TEST_CHECK(memcmp(samples->_sampleTimes, sampleTimes, sizeof(sampleTimes)) == 0);
+			GLM_TEST_CHECK(glmTestSameSample(samples, 0, frames[12 - FIRST_FRAME], frames[13 - FIRST_FRAME], 0.75f, expected));
+			GLM_TEST_CHECK(glmTestSameSample(samples, 2, frames[10 - FIRST_FRAME], frames[11 - FIRST_FRAME], 0.25f, expected));
+			GLM_TEST_CHECK(glmTestSameSample(samples, 3, frames[11 - FIRST_FRAME], frames[12 - FIRST_FRAME], 0.5f, expected));
+			// integer times are the frames themselves
+			GLM_TEST_CHECK(memcmp(samples->_bonePositions + totalBoneCount, frames[10 - FIRST_FRAME]->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+			GLM_TEST_CHECK(memcmp(samples->_bonePositions + 4 * totalBoneCount, frames[13 - FIRST_FRAME]->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+			GLM_TEST_CHECK(glmTestSameSample(samples, 4, frames[13 - FIRST_FRAME], frames[13 - FIRST_FRAME], 0.f, expected));
+		}
+		glmDestroyFrameSamples(&samples);
+		GLM_TEST_CHECK(samples == NULL);
+	}
+
+	// boundaries : after the last frame the previous valid frame is used, between the frame before the first and the first one, the first one
+	{
+		const float sampleTimes[3] = { 13.5f, 15.25f, 9.5f };
+		GlmFrameSamples* samples = NULL;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 3, GLM_TEST_FRAME_MODEL, ".") == GSC_SUCCESS);
+		GLM_TEST_CHECK(samples != NULL);
+		if (samples)
+		{
+			const GlmFrameData* first = frames[0];
+			const GlmFrameData* last = frames[LAST_FRAME - FIRST_FRAME];
+			GLM_TEST_CHECK(glmTestSameSample(samples, 0, last, last, 0.5f, expected));
+			GLM_TEST_CHECK(glmTestSameSample(samples, 1, last, last, 0.25f, expected));
+			GLM_TEST_CHECK(glmTestSameSample(samples, 2, first, first, 0.5f, expected));
+			// clamped samples are the boundary frames up to the renormalization of the orientations
+			int closeToLast = 1;
+			for (uint32_t iBone = 0; iBone < totalBoneCount; iBone++)
+				for (int i = 0; i < 4; i++)
+					closeToLast &= fabsf(samples->_boneOrientations[iBone][i] - last->_boneOrientations[iBone][i]) <= 1e-6f;
+			GLM_TEST_CHECK(closeToLast);
+			GLM_TEST_CHECK(memcmp(samples->_bonePositions, last->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+		}
+		glmDestroyFrameSamples(&samples);
+	}
+
+	// samples a million frames apart : the frames array only holds the 4 frames read, the far ones clamp to the last frame
+	{
+		const float sampleTimes[3] = { 1000000.5f, 10.5f, 1000000.f };
+		GlmFrameSamples* samples = NULL;
+		glmTestLargestAllocation = 0;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 3, GLM_TEST_FRAME_MODEL, ".") == GSC_SUCCESS);
+		GLM_TEST_CHECK(glmTestLargestAllocation <= sizeof(float[4]) * (3 * totalBoneCount + 1));
+		GLM_TEST_CHECK(samples != NULL);
+		if (samples)
+		{
+			const GlmFrameData* last = frames[LAST_FRAME - FIRST_FRAME];
+			GLM_TEST_CHECK(glmTestSameSample(samples, 0, last, last, 0.5f, expected));
+			GLM_TEST_CHECK(glmTestSameSample(samples, 1, frames[10 - FIRST_FRAME], frames[11 - FIRST_FRAME], 0.5f, expected));
+			GLM_TEST_CHECK(memcmp(samples->_bonePositions + 2 * totalBoneCount, last->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+		}
+		glmDestroyFrameSamples(&samples);
+	}
+
+	// the frame list and frames array, then the samples and their 3 arrays, failing alone in turn
+	{
+		const float sampleTimes[3] = { 12.75f, 10.f, 11.5f };
+		int liveAllocationCount = glmTestLiveAllocationCount;
+		GlmFrameSamples* samples = NULL;
+		glmTestAllocationCount = 0;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 3, GLM_TEST_FRAME_MODEL, ".") == GSC_SUCCESS);
+		int allocationCount = glmTestAllocationCount;
+		glmDestroyFrameSamples(&samples);
+		int failingAllocations[6] = { 0, 1, allocationCount - 4, allocationCount - 3, allocationCount - 2, allocationCount - 1 };
+		for (int iFailing = 0; iFailing < 6; iFailing++)
+		{
+			samples = (GlmFrameSamples*)&sampleTimes;
+			glmTestAllocationsBeforeFailure = failingAllocations[iFailing];
+			GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 3, GLM_TEST_FRAME_MODEL, ".") == GSC_OUT_OF_MEMORY);
+			glmTestAllocationsBeforeFailure = -1;
+			GLM_TEST_CHECK(samples == NULL);
+			GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount);
+		}
+	}
+
+	// no frame at or before a sample and no frame after it either, no sample at all
+	{
+		const float sampleTimes[2] = { 11.f, 9.f };
+		GlmFrameSamples* samples = (GlmFrameSamples*)&sampleTimes;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 2, GLM_TEST_FRAME_MODEL, ".") == GSC_SIMULATION_NO_FRAMES_FOUND);
+		GLM_TEST_CHECK(samples == NULL);
+		samples = (GlmFrameSamples*)&sampleTimes;
+		GLM_TEST_CHECK(glmCreateFrameSamples(&samples, simulationData, NULL, 0, NULL, NULL, sampleTimes, 0, GLM_TEST_FRAME_MODEL, ".") == GSC_SIMULATION_NO_FRAMES_FOUND);
+		GLM_TEST_CHECK(samples == NULL);
+	}
+
+	glmDestroyFrameData(&expected, simulationData);
+	for (int iFrame = FIRST_FRAME; iFrame <= LAST_FRAME; iFrame++)
+	{
+		glmDestroyFrameData(&frames[iFrame - FIRST_FRAME], simulationData);
+		sprintf(file, GLM_TEST_FRAME_MODEL, iFrame);
+		remove(file);
+	}
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,145 @@
+// GlmFrameDataSoA : layout of the padded arrays, bit exact conversion to and from GlmFrameData, interpolation against the
+// GlmFrameData one, and allocation failures leaving *frameDataSoA NULL without leaks
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static int glmTestIsIdentityPadding(const GlmFrameDataSoA* frameDataSoA)
+{
+	for (uint32_t iBone = frameDataSoA->_boneValueCount; iBone < frameDataSoA->_paddedBoneValueCount; iBone++)
+	{
+		if (frameDataSoA->_positionsX[iBone] != 0.f || frameDataSoA->_positionsY[iBone] != 0.f || frameDataSoA->_positionsZ[iBone] != 0.f
+			|| frameDataSoA->_orientationsX[iBone] != 0.f || frameDataSoA->_orientationsY[iBone] != 0.f || frameDataSoA->_orientationsZ[iBone] != 0.f
+			|| frameDataSoA->_orientationsW[iBone] != 1.f)
+			return 0;
+	}
+	return 1;
+}
+
+int main()
+{
+	// 3 entity types of 5, 6 and 7 bones : 37 entities = 13 * 5 + 12 * 6 + 12 * 7 = 221 bones, not a multiple of GSC_SOA_LANE_COUNT
+	GlmSimulationData* simulationData = NULL;
+	glmTestCreateSimulation(&simulationData, 37, 3, 5);
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+	GLM_TEST_CHECK(totalBoneCount == 221);
+	GlmFrameData* frameData1 = NULL;
+	GlmFrameData* frameData2 = NULL;
+	glmTestCreateFrame(&frameData1, simulationData, 17, 0, 0);
+	glmTestCreateFrame(&frameData2, simulationData, 29, 0, 0);
+	int baseAllocationCount = glmTestLiveAllocationCount;
+
+	// layout
+	GlmFrameDataSoA* soa1 = NULL;
+	GlmFrameDataSoA* soa2 = NULL;
+	GlmFrameDataSoA* soaResult = NULL;
+	glmCreateFrameDataSoA(&soa1, simulationData);
+	glmCreateFrameDataSoA(&soa2, simulationData);
+	glmCreateFrameDataSoA(&soaResult, simulationData);
+	GLM_TEST_CHECK(soa1 != NULL && soa2 != NULL && soaResult != NULL);
+	GLM_TEST_CHECK(soa1->_entityCount == simulationData->_entityCount);
+	GLM_TEST_CHECK(soa1->_boneValueCount == totalBoneCount);
+	GLM_TEST_CHECK(soa1->_paddedBoneValueCount == 224);
+	float* arrays[7] = { soa1->_positionsX, soa1->_positionsY, soa1->_positionsZ, soa1->_orientationsX, soa1->_orientationsY, soa1->_orientationsZ, soa1->_orientationsW };
+	for (int iArray = 0; iArray < 7; iArray++)
+	{
+		GLM_TEST_CHECK(((size_t)arrays[iArray] & (GSC_SOA_ALIGNMENT - 1)) == 0);
+		if (iArray > 0)
+			GLM_TEST_CHECK(arrays[iArray] == arrays[iArray - 1] + soa1->_paddedBoneValueCount);
+	}
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint16_t entityType = simulationData->_entityTypes[iEntity];
+		GLM_TEST_CHECK(soa1->_entityBoneOffsets[iEntity] == simulationData->_iBoneOffsetPerEntityType[entityType] + simulationData->_indexInEntityType[iEntity] * simulationData->_boneCount[entityType]);
+	}
+	GLM_TEST_CHECK(glmTestIsIdentityPadding(soa1));
+
+	// conversion round trip is bit exact, padding untouched
+	glmConvertFrameDataToSoA(frameData1, soa1);
+	glmConvertFrameDataToSoA(frameData2, soa2);
+	GLM_TEST_CHECK(glmTestIsIdentityPadding(soa1));
+	for (uint32_t iBone = 0; iBone < totalBoneCount; iBone++)
+	{
+		GLM_TEST_CHECK(soa1->_positionsY[iBone] == frameData1->_bonePositions[iBone][1]);
+		GLM_TEST_CHECK(soa1->_orientationsW[iBone] == frameData1->_boneOrientations[iBone][3]);
+	}
+	GlmFrameData* roundTrip = NULL;
+	glmCreateFrameData(&roundTrip, simulationData);
+	glmConvertFrameDataFromSoA(soa1, roundTrip);
+	GLM_TEST_CHECK(memcmp(roundTrip->_bonePositions, frameData1->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+	GLM_TEST_CHECK(memcmp(roundTrip->_boneOrientations, frameData1->_boneOrientations, totalBoneCount * sizeof(float[4])) == 0);
+
+	// interpolation matches the strict GlmFrameData one, padding stays identity, ratio 0 gives the first frame positions
+	const float ratios[4] = { 0.f, 0.25f, 0.5f, 1.f };
+	GlmFrameData* interpolated = NULL;
+	glmCreateFrameData(&interpolated, simulationData);
+	for (int iRatio = 0; iRatio < 4; iRatio++)
+	{
+		float ratio = ratios[iRatio];
+		glmInterpolateFrameDataBones(frameData1, frameData2, ratio, interpolated, 0, totalBoneCount, GSC_INTERPOLATION_STRICT);
+		glmInterpolateFrameDataSoA(soa1, soa2, ratio, soaResult);
+		GLM_TEST_CHECK(glmTestIsIdentityPadding(soaResult));
+		glmConvertFrameDataFromSoA(soaResult, roundTrip);
+		int positionsMatch = 1, orientationsMatch = 1;
+		for (uint32_t iBone = 0; iBone < totalBoneCount; iBone++)
+		{
+			for (int i = 0; i < 3; i++)
+				positionsMatch &= fabsf(roundTrip->_bonePositions[iBone][i] - interpolated->_bonePositions[iBone][i]) <= 1e-4f;
+			for (int i = 0; i < 4; i++)
+				orientationsMatch &= fabsf(roundTrip->_boneOrientations[iBone][i] - interpolated->_boneOrientations[iBone][i]) <= 1e-5f;
+		}
+		GLM_TEST_CHECK(positionsMatch);
+		GLM_TEST_CHECK(orientationsMatch);
+		if (ratio == 0.f)
+			GLM_TEST_CHECK(memcmp(roundTrip->_bonePositions, frameData1->_bonePositions, totalBoneCount * sizeof(float[3])) == 0);
+	}
+
+	glmDestroyFrameData(&interpolated, simulationData);
+	glmDestroyFrameData(&roundTrip, simulationData);
+	glmDestroyFrameDataSoA(&soa1);
+	glmDestroyFrameDataSoA(&soa2);
+	glmDestroyFrameDataSoA(&soaResult);
+	GLM_TEST_CHECK(soa1 == NULL);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == baseAllocationCount);
+
+	// every one of the 3 allocations failing
+	for (int iFailure = 0; iFailure < 3; iFailure++)
+	{
+		GlmFrameDataSoA* soa = (GlmFrameDataSoA*)&iFailure;
+		glmTestAllocationsBeforeFailure = iFailure;
+		glmCreateFrameDataSoA(&soa, simulationData);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(soa == NULL);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == baseAllocationCount);
+	}
+
+	glmDestroyFrameData(&frameData1, simulationData);
+	glmDestroyFrameData(&frameData2, simulationData);
+	glmDestroySimulationData(&simulationData);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	return glmTestResult();
+}
@@ -0,0 +1,240 @@
+// Frustum culling against a brute force reference : planes against the clip space test, entities inside, outside and straddling
+// the planes in a random crowd culled like the 8 corners test, same visibilities at every SIMD level, camera and frustum margins,
+// allocations through GLMC_MALLOC and GIO_OUT_OF_MEMORY when one fails
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+#define NEAR_PLANE 0.5
+#define FAR_PLANE 200.
+
+// camera at eye looking down -Z, 90 degrees vertical field of view, aspect 2
+static void glmTestSetCamera(GlmGeometryGenerationContext* context, const float eye[3])
+{
+	memset(context->_viewMatrix, 0, sizeof(context->_viewMatrix));
+	memset(context->_projectionMatrix, 0, sizeof(context->_projectionMatrix));
+	for (int i = 0; i < 4; i++)
+		context->_viewMatrix[i][i] = 1.f;
+	for (int i = 0; i < 3; i++)
+	{
+		context->_viewMatrix[3][i] = -eye[i];
+		context->_cameraWorldPosition[i] = eye[i];
+	}
+	context->_projectionMatrix[0][0] = 0.5f;
+	context->_projectionMatrix[1][1] = 1.f;
+	context->_projectionMatrix[2][2] = (float)(-(FAR_PLANE + NEAR_PLANE) / (FAR_PLANE - NEAR_PLANE));
+	context->_projectionMatrix[2][3] = -1.f;
+	context->_projectionMatrix[3][2] = (float)(-2. * FAR_PLANE * NEAR_PLANE / (FAR_PLANE - NEAR_PLANE));
+}
+
+// largest signed distance of the box corners to the closest plane they are all behind, > 0 when no plane has the 8 corners behind it
+static double glmTestBoxDistance(const float planes[6][4], const GlmEntityBoundingBox& bbox)
+{
+	double minDistance = 1e30;
+	for (int iPlane = 0; iPlane < 6; iPlane++)
+	{
+		double maxCornerDistance = -1e30;
+		for (int iCorner = 0; iCorner < 8; iCorner++)
+		{
+			double distance = planes[iPlane][3];
+			for (int i = 0; i < 3; i++)
+			{
+				double sign = ((iCorner >> i) & 1) ? 1. : -1.;
+				distance += planes[iPlane][i] * ((double)bbox._entityOrigin[i] + sign * bbox._boundingBoxHalfExtents[i]);
+			}
+			maxCornerDistance = (distance > maxCornerDistance) ? distance : maxCornerDistance;
+		}
+		minDistance = (maxCornerDistance < minDistance) ? maxCornerDistance : minDistance;
+	}
+	return minDistance;
+}
+
+static void glmTestSetEntity(GlmEntityBoundingBox* bbox, float x, float y, float z, float extent)
+{
+	memset(bbox, 0, sizeof(GlmEntityBoundingBox));
+	bbox->_entityOrigin[0] = x;
+	bbox->_entityOrigin[1] = y;
+	bbox->_entityOrigin[2] = z;
+	bbox->_boundingBoxHalfExtents[0] = bbox->_boundingBoxHalfExtents[1] = bbox->_boundingBoxHalfExtents[2] = extent;
+	bbox->_entityScale = 1.f;
+}
+
+int main()
+{
+	GlmGeometryGenerationContext context;
+	memset(&context, 0, sizeof(context));
+	const float eye[3] = { 10.f, 2.f, 30.f };
+	glmTestSetCamera(&context, eye);
+	context._enableFrustumCulling = 1;
+
+	// planes : a point is inside every plane exactly when its clip coordinates are inside the clip volume
+	float planes[6][4];
+	glmComputeFrustumPlanes(&context, planes);
+	float viewProjection[4][4];
+	glmComputeViewProjectionMatrix(&context, viewProjection);
+	uint32_t randomState = 0x2545F491u;
+	int checkedPointCount = 0;
+	for (int iPoint = 0; iPoint < 20000; iPoint++)
+	{
+		float p[3] = { glmTestRandomRange(&randomState, -400.f, 400.f), glmTestRandomRange(&randomState, -200.f, 200.f), glmTestRandomRange(&randomState, -300.f, 60.f) };
+		double clip[4];
+		for (int row = 0; row < 4; row++)
+			clip[row] = viewProjection[row][0] * p[0] + viewProjection[row][1] * p[1] + viewProjection[row][2] * p[2] + viewProjection[row][3];
+		double clipMargin = clip[3];
+		for (int i = 0; i < 3; i++)
+			clipMargin = fmin(clipMargin, fmin(clip[3] - clip[i], clip[3] + clip[i]));
+		double planeMargin = 1e30;
+		for (int iPlane = 0; iPlane < 6; iPlane++)
+			planeMargin = fmin(planeMargin, planes[iPlane][3] + planes[iPlane][0] * p[0] + planes[iPlane][1] * p[1] + planes[iPlane][2] * p[2]);
+		if (fabs(clipMargin) < 1e-2 || fabs(planeMargin) < 1e-2)
+			continue;
+		GLM_TEST_CHECK((clipMargin >= 0.) == (planeMargin >= 0.));
+		checkedPointCount++;
+	}
+	GLM_TEST_CHECK(checkedPointCount > 19000);
+
+	// hand placed entities, camera looking at (10, 2, z < 30), right plane x - 10 = 2 * (30 - z) : at z = -10 it is x = 90
+	{
+		GlmEntityBoundingBox bboxes[10];
+		glmTestSetEntity(&bboxes[0], 10.f, 2.f, 0.f, 1.f); // inside
+		glmTestSetEntity(&bboxes[1], 10.f, 2.f, 40.f, 1.f); // behind the camera
+		glmTestSetEntity(&bboxes[2], 89.5f, 2.f, -10.f, 1.f); // straddling the right plane
+		glmTestSetEntity(&bboxes[3], 94.f, 2.f, -10.f, 1.f); // right of the right plane, its closest corner 0.45 away
+		glmTestSetEntity(&bboxes[4], 10.f, 2.f, 30.f - (float)FAR_PLANE, 2.f); // straddling the far plane
+		glmTestSetEntity(&bboxes[5], 10.f, 2.f, 25.f - (float)FAR_PLANE, 2.f); // past the far plane
+		glmTestSetEntity(&bboxes[6], 10.f, 2.f, 29.5f, 0.2f); // straddling the near plane
+		glmTestSetEntity(&bboxes[7], 10.f, -39.f, -10.f, 2.f); // straddling the bottom plane, y - 2 = -(30 - z)
+		glmTestSetEntity(&bboxes[8], 10.f, 47.f, -10.f, 2.f); // above the top plane
+		glmTestSetEntity(&bboxes[9], 10.f, 2.f, 31.f, 2.f); // around the camera
+		context._entityCount = 10;
+		context._entityBBoxes = bboxes;
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		const uint8_t expected[10] = { 1, 0, 1, 0, 1, 0, 1, 1, 0, 1 };
+		for (int iEntity = 0; iEntity < 10; iEntity++)
+			GLM_TEST_CHECK(bboxes[iEntity]._isVisible == expected[iEntity]);
+
+		// camera margin keeps the entity behind the camera, frustum margin brings back the one right of the right plane
+		context._cameraMargin = 11.f;
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		GLM_TEST_CHECK(bboxes[1]._isVisible == 1 && bboxes[3]._isVisible == 0);
+		context._cameraMargin = 0.f;
+		context._frustumMargin = 1.f;
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		GLM_TEST_CHECK(bboxes[1]._isVisible == 0 && bboxes[3]._isVisible == 1);
+		context._frustumMargin = 0.f;
+
+		// culling off : visibilities untouched
+		context._enableFrustumCulling = 0;
+		bboxes[1]._isVisible = 7;
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		GLM_TEST_CHECK(bboxes[1]._isVisible == 7);
+		context._enableFrustumCulling = 1;
+	}
+
+	// random crowd around the camera : whole cells inside and outside, cells crossing the planes, entities straddling them
+	const uint32_t entityCount = 5000;
+	std::vector<GlmEntityBoundingBox> bboxes(entityCount);
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		glmTestSetEntity(&bboxes[iEntity], glmTestRandomRange(&randomState, -300.f, 300.f), glmTestRandomRange(&randomState, -5.f, 5.f), glmTestRandomRange(&randomState, -250.f, 60.f), glmTestRandomRange(&randomState, 0.2f, 6.f));
+	context._entityCount = entityCount;
+	context._entityBBoxes = &bboxes[0];
+	std::vector<uint8_t> visibilities[3];
+	const GlmSimdLevel levels[3] = { GSC_SIMD_SCALAR, GSC_SIMD_SSE2, GSC_SIMD_AVX2 };
+	for (int iLevel = 0; iLevel < 3; iLevel++)
+	{
+		glmSetSimdLevel(levels[iLevel]);
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+			visibilities[iLevel].push_back(bboxes[iEntity]._isVisible);
+	}
+	GLM_TEST_CHECK(visibilities[0] == visibilities[1] && visibilities[0] == visibilities[2]);
+	uint32_t counts[3] = { 0, 0, 0 }; // inside, outside, straddling
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+	{
+		double distance = glmTestBoxDistance(planes, bboxes[iEntity]);
+		if (fabs(distance) < 1e-3)
+			continue;
+		GLM_TEST_CHECK(bboxes[iEntity]._isVisible == (distance > 0.));
+		int straddling = 0;
+		for (int iPlane = 0; iPlane < 6; iPlane++)
+		{
+			float center = planes[iPlane][3];
+			float radius = 0.f;
+			for (int i = 0; i < 3; i++)
+			{
+				center += planes[iPlane][i] * bboxes[iEntity]._entityOrigin[i];
+				radius += fabsf(planes[iPlane][i]) * bboxes[iEntity]._boundingBoxHalfExtents[i];
+			}
+			straddling |= fabsf(center) < radius;
+		}
+		counts[distance < 0. ? 1 : (straddling ? 2 : 0)]++;
+	}
+	GLM_TEST_CHECK(counts[0] > 100 && counts[1] > 100 && counts[2] > 20);
+
+	// glmCullBoxes on ranges not aligned to the SIMD width, same as the scalar kernel
+	{
+		GlmCullingBounds bounds;
+		GLM_TEST_CHECK(glmCreateCullingBoundsFromContext(&bounds, &context) == GIO_SUCCESS);
+		std::vector<uint8_t> outside[3];
+		for (int iLevel = 0; iLevel < 3; iLevel++)
+		{
+			glmSetSimdLevel(levels[iLevel]);
+			outside[iLevel].assign(entityCount, 2);
+			glmCullBoxes(bounds._centers, bounds._extents, 3, 3 + 8 * 7 + 5, (const float(*)[4])planes, &outside[iLevel][3]);
+			glmCullBoxes(bounds._centers, bounds._extents, 100, entityCount, (const float(*)[4])planes, &outside[iLevel][100]);
+		}
+		GLM_TEST_CHECK(outside[0] == outside[1] && outside[0] == outside[2]);
+		GLM_TEST_CHECK(outside[0][2] == 2 && outside[0][3 + 8 * 7 + 5] == 2 && outside[0][99] == 2);
+		glmDestroyCullingBounds(&bounds);
+	}
+	glmInitSimdDispatch();
+
+	// each allocation failing in turn : GIO_OUT_OF_MEMORY, nothing leaked, visibilities untouched
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	std::vector<uint8_t> expected(visibilities[0]);
+	int failureCount = 0;
+	for (int allocationCount = 0; ; allocationCount++)
+	{
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+			bboxes[iEntity]._isVisible = 3;
+		glmTestAllocationsBeforeFailure = allocationCount;
+		GlmGeometryGenerationStatus status = glmCullContextEntities(&context);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+		if (status == GIO_SUCCESS)
+		{
+			for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+				GLM_TEST_CHECK(bboxes[iEntity]._isVisible == expected[iEntity]);
+			break;
+		}
+		GLM_TEST_CHECK(status == GIO_OUT_OF_MEMORY);
+		GLM_TEST_CHECK(bboxes[0]._isVisible == 3);
+		failureCount++;
+	}
+	GLM_TEST_CHECK(failureCount >= 12);
+	return glmTestResult();
+}
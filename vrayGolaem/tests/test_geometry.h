@@ -0,0 +1,167 @@
+// Synthetic skinned geometry files for the skinning tests and benchmarks, built without the glmCrowdIO library
+#ifndef GLM_TEST_GEOMETRY_INCLUDE_H
+#define GLM_TEST_GEOMETRY_INCLUDE_H
+
+#include "glm_test.h"
+#include <math.h>
+#include <vector>
+#include <string>
+
+inline void glmTestRandomQuaternion(uint32_t* randomState, float* q)
+{
+	float norm;
+	do
+	{
+		for (int i = 0; i < 4; i++)
+			q[i] = glmTestRandomRange(randomState, -1.f, 1.f);
+		norm = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+	} while (norm < 0.01f || norm > 1.f);
+	norm = 1.f / sqrtf(norm);
+	for (int i = 0; i < 4; i++)
+		q[i] *= norm;
+}
+
+// a GlmGeometryFile with one mesh, arrays owned by the struct
+struct GlmTestSkinnedGeometry
+{
+	GlmGeometryFile _geometry;
+	GlmFileMesh _mesh;
+	std::vector<GlmFileMeshVertex> _vertices;
+	std::vector<uint16_t> _influenceBoneIds;
+	std::vector<float> _influenceWeights;
+	std::vector<float> _boneOffsetPositions; // 3 per bone
+	std::vector<float> _boneOffsetOrientations; // 4 per bone
+};
+
+// vertices spread in a 2 units cube, 1 to maxInfluenceCount influences per vertex with normalized weights, random bind pose
+inline void glmTestCreateSkinnedGeometry(GlmTestSkinnedGeometry& data, uint32_t vertexCount, uint16_t boneCount, uint8_t skinningType, uint8_t maxInfluenceCount, uint32_t seed)
+{
+	uint32_t randomState = seed;
+	memset(&data._geometry, 0, sizeof(GlmGeometryFile));
+	memset(&data._mesh, 0, sizeof(GlmFileMesh));
+
+	data._boneOffsetPositions.resize(boneCount * 3);
+	data._boneOffsetOrientations.resize(boneCount * 4);
+	for (uint16_t iBone = 0; iBone < boneCount; iBone++)
+	{
+		for (int i = 0; i < 3; i++)
+			data._boneOffsetPositions[iBone * 3 + i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+		glmTestRandomQuaternion(&randomState, &data._boneOffsetOrientations[iBone * 4]);
+	}
+
+	// influences first, vertices point in the arrays once they stop growing
+	std::vector<uint8_t> influenceCounts(vertexCount);
+	for (uint32_t iVertex = 0; iVertex < vertexCount; iVertex++)
+	{
+		uint8_t influenceCount = (uint8_t)(1 + (uint32_t)(glmTestRandom(&randomState) * maxInfluenceCount) % maxInfluenceCount);
+		float weightSum = 0.f;
+		size_t first = data._influenceWeights.size();
+		influenceCounts[iVertex] = influenceCount;
+		for (uint8_t iInfluence = 0; iInfluence < influenceCount; iInfluence++)
+		{
+			data._influenceBoneIds.push_back((uint16_t)((uint32_t)(glmTestRandom(&randomState) * boneCount) % boneCount));
+			data._influenceWeights.push_back(glmTestRandomRange(&randomState, 0.1f, 1.f));
+			weightSum += data._influenceWeights.back();
+		}
+		for (size_t iWeight = first; iWeight < data._influenceWeights.size(); iWeight++)
+			data._influenceWeights[iWeight] /= weightSum;
+	}
+
+	data._vertices.resize(vertexCount);
+	size_t influenceOffset = 0;
+	for (uint32_t iVertex = 0; iVertex < vertexCount; iVertex++)
+	{
+		GlmFileMeshVertex& vertex = data._vertices[iVertex];
+		memset(&vertex, 0, sizeof(GlmFileMeshVertex));
+		float normal[3];
+		float norm = 0.f;
+		for (int i = 0; i < 3; i++)
+		{
+			vertex._position[i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+			normal[i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+			norm += normal[i] * normal[i];
+		}
+		norm = 1.f / sqrtf(norm + 1e-6f);
+		for (int i = 0; i < 3; i++)
+			vertex._normal[i] = normal[i] * norm;
+		vertex._skinInfluenceBlendWeight = glmTestRandom(&randomState);
+		vertex._skinVertexInfluenceCount = influenceCounts[iVertex];
+		vertex._skinInfluenceBoneId = &data._influenceBoneIds[influenceOffset];
+		vertex._skinInfluenceWeights = &data._influenceWeights[influenceOffset];
+		influenceOffset += influenceCounts[iVertex];
+	}
+
+	data._mesh._skinningType = skinningType;
+	data._mesh._rigidSkinningBoneId = (uint16_t)(boneCount - 1);
+	data._mesh._vertexCount = vertexCount;
+	data._mesh._vertices = vertexCount ? &data._vertices[0] : NULL;
+	data._geometry._meshCount = 1;
+	data._geometry._meshes = &data._mesh;
+	data._geometry._boneCount = boneCount;
+	data._geometry._boneOffsetPositions = (float(*)[3])&data._boneOffsetPositions[0];
+	data._geometry._boneOffsetOrientations = (float(*)[4])&data._boneOffsetOrientations[0];
+}
+
+// character of one skinned mesh and rigidMeshCount rigid meshes, each mesh is a GlmTestSkinnedGeometry sharing the bind pose of the first one.
+// _skinnedGeometry is built in memory as glmOpenSkinnedGeometry does for a regular gcg, release it with glmTestDestroyCharacter
+struct GlmTestCharacter
+{
+	std::vector<GlmTestSkinnedGeometry> _parts;
+	std::vector<GlmFileMesh> _meshes;
+	std::vector<std::string> _names;
+	GlmSkinnedGeometry _skinnedGeometry;
+};
+
+inline void glmTestCreateCharacter(GlmTestCharacter& character, uint16_t boneCount, uint32_t vertexCount, uint8_t skinningType, uint16_t rigidMeshCount, uint32_t seed)
+{
+	uint16_t meshCount = (uint16_t)(rigidMeshCount + 1);
+	// sized once, the parts point in their own vectors
+	character._parts.resize(meshCount);
+	character._meshes.resize(meshCount);
+	character._names.resize(meshCount);
+	for (uint16_t iMesh = 0; iMesh < meshCount; iMesh++)
+	{
+		char name[32];
+		sprintf(name, iMesh ? "rigid%u" : "body", (unsigned int)iMesh);
+		character._names[iMesh] = name;
+		glmTestCreateSkinnedGeometry(character._parts[iMesh], iMesh ? vertexCount / 8 : vertexCount, boneCount, iMesh ? (uint8_t)GLM_SKIN_RIGID : skinningType, 4, seed + iMesh);
+		character._meshes[iMesh] = character._parts[iMesh]._mesh;
+		character._meshes[iMesh]._rigidSkinningBoneId = (uint16_t)(iMesh % boneCount);
+		character._meshes[iMesh]._name._string = &character._names[iMesh][0];
+		character._meshes[iMesh]._name._allocSize = (uint16_t)(character._names[iMesh].size() + 1);
+	}
+
+	GlmSkinnedGeometry& skinnedGeometry = character._skinnedGeometry;
+	memset(&skinnedGeometry, 0, sizeof(GlmSkinnedGeometry));
+	skinnedGeometry._geometry = character._parts[0]._geometry;
+	skinnedGeometry._geometry._meshCount = meshCount;
+	skinnedGeometry._geometry._meshes = &character._meshes[0];
+	skinnedGeometry._meshCount = meshCount;
+	skinnedGeometry._meshes = (GlmSkinnedMesh*)GLMC_MALLOC(meshCount * sizeof(GlmSkinnedMesh));
+	for (uint16_t iMesh = 0; iMesh < meshCount; iMesh++)
+		GLM_TEST_CHECK(glmCreateSkinnedMesh(&skinnedGeometry._meshes[iMesh], &character._meshes[iMesh], boneCount) == GIO_SUCCESS);
+}
+
+inline void glmTestDestroyCharacter(GlmTestCharacter& character)
+{
+	for (uint16_t iMesh = 0; iMesh < character._skinnedGeometry._meshCount; iMesh++)
+		glmDestroySkinnedMesh(&character._skinnedGeometry._meshes[iMesh]);
+	GLMC_FREE(character._skinnedGeometry._meshes);
+	memset(&character._skinnedGeometry, 0, sizeof(GlmSkinnedGeometry));
+}
+
+// random world bones, positions within 10 units
+inline void glmTestCreateRandomPose(uint16_t boneCount, uint32_t seed, std::vector<float>& positions, std::vector<float>& orientations)
+{
+	uint32_t randomState = seed;
+	positions.resize(boneCount * 3);
+	orientations.resize(boneCount * 4);
+	for (uint16_t iBone = 0; iBone < boneCount; iBone++)
+	{
+		for (int i = 0; i < 3; i++)
+			positions[iBone * 3 + i] = glmTestRandomRange(&randomState, -10.f, 10.f);
+		glmTestRandomQuaternion(&randomState, &orientations[iBone * 4]);
+	}
+}
+
+#endif // GLM_TEST_GEOMETRY_INCLUDE_H
@@ -0,0 +1,116 @@
+// GlmEntityInstanceMatrices and GlmMeshInstanceGroupPerCrowdField on pooled storage : memory used by a 1000 entity crowd against the
+// fixed GIO_MAX_INSTANCE_MATRIX_PER_ENTITY / GIO_MAX_INSTANCE_MESHES arrays, limits, stable group pointers and allocation failures
+#include <stdlib.h>
+static size_t glmTestLiveBytes = 0;
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail
+// the size is stored in front of each block to track the live bytes
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	size_t* block = (size_t*)malloc(size + 16);
+	if (block == NULL)
+		return NULL;
+	block[0] = size;
+	glmTestLiveBytes += size;
+	glmTestLiveAllocationCount++;
+	return (char*)block + 16;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr == NULL)
+		return;
+	size_t* block = (size_t*)((char*)ptr - 16);
+	glmTestLiveBytes -= block[0];
+	glmTestLiveAllocationCount--;
+	free(block);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+enum { ENTITY_COUNT = 1000, MATRIX_PER_ENTITY = 3, GROUP_COUNT = 300 };
+
+int main()
+{
+	// fixed arrays of the previous layouts
+	const size_t fixedMatrixBytes = GIO_MAX_INSTANCE_MATRIX_PER_ENTITY * sizeof(GlmMeshInstanceMatrix);
+	const size_t fixedGroupBytes = GIO_MAX_INSTANCE_MESHES * sizeof(GlmMeshInstanceGroup);
+
+	// every entity keeps its 3 matrices : one chunk each
+	std::vector<GlmEntityInstanceMatrices> instanceMatrices(ENTITY_COUNT);
+	for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+	{
+		glmInitEntityInstanceMatrices(instanceMatrices[iEntity]);
+		for (int iMatrix = 0; iMatrix < MATRIX_PER_ENTITY; iMatrix++)
+		{
+			GlmMeshInstanceMatrix* matrix = glmAddEntityInstanceMatrix(instanceMatrices[iEntity]);
+			GLM_TEST_CHECK(matrix != NULL && (*matrix)[3][3] == 0.f);
+			(*matrix)[3][0] = (float)iEntity;
+			(*matrix)[3][3] = 1.f;
+		}
+	}
+	size_t matrixBytes = ENTITY_COUNT * sizeof(GlmEntityInstanceMatrices) + glmTestLiveBytes;
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == ENTITY_COUNT);
+	GLM_TEST_CHECK(matrixBytes == ENTITY_COUNT * (sizeof(GlmEntityInstanceMatrices) + GIO_INSTANCE_MATRIX_CHUNK_SIZE * sizeof(GlmMeshInstanceMatrix)));
+	GLM_TEST_CHECK(instanceMatrices[42]._instanceMatrixUsedCount == MATRIX_PER_ENTITY);
+	GLM_TEST_CHECK(instanceMatrices[42]._instanceMatrices[2][3][0] == 42.f);
+	// at least 32 times less than 64 KB per entity
+	printf("instance matrices : %zu bytes pooled, %zu bytes fixed\n", matrixBytes, ENTITY_COUNT * fixedMatrixBytes);
+	GLM_TEST_CHECK(matrixBytes * 32 <= ENTITY_COUNT * fixedMatrixBytes);
+	for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+		glmReleaseEntityInstanceMatrices(instanceMatrices[iEntity]);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// one entity reusing its matrices : chunks kept, matrices zeroed, NULL past GIO_MAX_INSTANCE_MATRIX_PER_ENTITY
+	GlmEntityInstanceMatrices& reused = instanceMatrices[0];
+	glmInitEntityInstanceMatrices(reused);
+	for (int iMatrix = 0; iMatrix < GIO_MAX_INSTANCE_MATRIX_PER_ENTITY; iMatrix++)
+		(*glmAddEntityInstanceMatrix(reused))[0][0] = 1.f;
+	GLM_TEST_CHECK(glmAddEntityInstanceMatrix(reused) == NULL);
+	GLM_TEST_CHECK(reused._instanceMatrixUsedCount == GIO_MAX_INSTANCE_MATRIX_PER_ENTITY);
+	int allocationCount = glmTestLiveAllocationCount;
+	reused._instanceMatrixUsedCount = 0;
+	GLM_TEST_CHECK((*glmAddEntityInstanceMatrix(reused))[0][0] == 0.f);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount);
+	glmReleaseEntityInstanceMatrices(reused);
+
+	// 300 groups in a crowd field : two chunks instead of 10000 groups
+	GlmMeshInstanceGroupPerCrowdField meshInstances;
+	glmInitMeshInstanceGroups(meshInstances);
+	GLM_TEST_CHECK(glmAddMeshInstanceGroup(meshInstances) == 0);
+	GlmMeshInstanceGroup* firstGroup = &meshInstances._meshInstanceGroups[0];
+	firstGroup->_hashKey = 7;
+	for (int iGroup = 1; iGroup < GROUP_COUNT; iGroup++)
+		GLM_TEST_CHECK(glmAddMeshInstanceGroup(meshInstances) == iGroup);
+	GLM_TEST_CHECK(meshInstances._meshInstanceGroupCount == GROUP_COUNT);
+	GLM_TEST_CHECK(&meshInstances._meshInstanceGroups[0] == firstGroup && firstGroup->_hashKey == 7);
+	size_t groupBytes = sizeof(GlmMeshInstanceGroupPerCrowdField) + glmTestLiveBytes;
+	GLM_TEST_CHECK(groupBytes == sizeof(GlmMeshInstanceGroupPerCrowdField) + 2 * GIO_INSTANCE_GROUP_CHUNK_SIZE * sizeof(GlmMeshInstanceGroup));
+	printf("mesh instance groups : %zu bytes pooled, %zu bytes fixed\n", groupBytes, fixedGroupBytes);
+	GLM_TEST_CHECK(groupBytes * 16 <= fixedGroupBytes);
+	while (meshInstances._meshInstanceGroupCount < GIO_MAX_INSTANCE_MESHES)
+		glmAddMeshInstanceGroup(meshInstances);
+	GLM_TEST_CHECK(glmAddMeshInstanceGroup(meshInstances) == -1);
+	glmReleaseMeshInstanceGroups(meshInstances);
+	GLM_TEST_CHECK(meshInstances._meshInstanceGroupCount == 0);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// failed chunk allocations : nothing added
+	GlmEntityInstanceMatrices failing;
+	glmInitEntityInstanceMatrices(failing);
+	glmTestAllocationsBeforeFailure = 0;
+	GLM_TEST_CHECK(glmAddEntityInstanceMatrix(failing) == NULL);
+	GLM_TEST_CHECK(glmAddMeshInstanceGroup(meshInstances) == -1);
+	glmTestAllocationsBeforeFailure = -1;
+	GLM_TEST_CHECK(failing._instanceMatrixUsedCount == 0 && meshInstances._meshInstanceGroupCount == 0);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	return glmTestResult();
+}
@@ -0,0 +1,112 @@
+// glmInterpolateFrameDataParallel against glmInterpolateFrameData : bit exact in GSC_INTERPOLATION_STRICT mode serially, with every block
+// run separately in reverse order and on glmParallelForThreads, GSC_INTERPOLATION_FAST within its normalization tolerance
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static std::vector<unsigned int> glmTestCallCounts; // item counts of the glmTestParallelForReversed calls
+
+// one item at a time, last one first
+static void glmTestParallelForReversed(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	glmTestCallCounts.push_back(count);
+	for (unsigned int iItem = count; iItem > 0; iItem--)
+		task(userData, iItem - 1, iItem);
+}
+
+static int glmTestSameBones(const GlmFrameData* frameData1, const GlmFrameData* frameData2, uint32_t boneValueCount)
+{
+	return memcmp(frameData1->_bonePositions, frameData2->_bonePositions, boneValueCount * sizeof(float[3])) == 0
+		&& memcmp(frameData1->_boneOrientations, frameData2->_boneOrientations, boneValueCount * sizeof(float[4])) == 0;
+}
+
+// parallel interpolation of frameData1 and frameData2 bit exact to the reference one
+static void glmTestStrict(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2, float ratio, GlmFrameData* expected, GlmFrameData* result)
+{
+	uint32_t boneValueCount = glmTestTotalBoneCount(simulationData);
+	glmInterpolateFrameData(simulationData, frameData1, frameData2, ratio, expected);
+	glmInterpolateFrameDataParallel(simulationData, frameData1, frameData2, ratio, result, GSC_INTERPOLATION_STRICT);
+	GLM_TEST_CHECK(glmTestSameBones(expected, result, boneValueCount));
+	GLM_TEST_CHECK(glmTestSameFrameAttributes(simulationData, expected, result));
+}
+
+int main()
+{
+	// 3 entity types of 5, 6 and 7 bones : 36000 bones, 3 blocks, the last one partial
+	GlmSimulationData* simulationData = NULL;
+	glmTestCreateSimulation(&simulationData, 6000, 3, 5);
+	uint32_t boneValueCount = glmTestTotalBoneCount(simulationData);
+	unsigned int blockCount = (boneValueCount + GIO_INTERPOLATION_BONES_PER_TASK - 1) / GIO_INTERPOLATION_BONES_PER_TASK;
+	GLM_TEST_CHECK(boneValueCount == 36000 && blockCount == 3);
+	GlmFrameData* frameData1 = NULL;
+	GlmFrameData* frameData2 = NULL;
+	GlmFrameData* expected = NULL;
+	GlmFrameData* result = NULL;
+	glmTestCreateFrame(&frameData1, simulationData, 31, 0, 0);
+	glmTestCreateFrame(&frameData2, simulationData, 47, 0, 0);
+	glmCreateFrameData(&expected, simulationData);
+	glmCreateFrameData(&result, simulationData);
+	const float ratios[4] = { 0.f, 0.3f, 0.5f, 1.f };
+
+	// calling thread only
+	glmParallelFor = NULL;
+	for (int iRatio = 0; iRatio < 4; iRatio++)
+		glmTestStrict(simulationData, frameData1, frameData2, ratios[iRatio], expected, result);
+
+	// one call of every block and the attributes item, each block run on its own
+	glmParallelFor = glmTestParallelForReversed;
+	for (int iRatio = 0; iRatio < 4; iRatio++)
+		glmTestStrict(simulationData, frameData1, frameData2, ratios[iRatio], expected, result);
+	GLM_TEST_CHECK(glmTestCallCounts.size() == 4);
+	for (size_t iCall = 0; iCall < glmTestCallCounts.size(); iCall++)
+		GLM_TEST_CHECK(glmTestCallCounts[iCall] == blockCount + 1);
+
+	// missing second frame : the first one with itself
+	glmTestStrict(simulationData, frameData1, NULL, 0.5f, expected, result);
+
+	// thread pool
+	glmParallelFor = glmParallelForThreads;
+	for (int iRatio = 0; iRatio < 4; iRatio++)
+		glmTestStrict(simulationData, frameData1, frameData2, ratios[iRatio], expected, result);
+
+	// fast mode : same positions, orientations within the approximated normalization error
+	glmInterpolateFrameData(simulationData, frameData1, frameData2, 0.3f, expected);
+	glmInterpolateFrameDataParallel(simulationData, frameData1, frameData2, 0.3f, result, GSC_INTERPOLATION_FAST);
+	GLM_TEST_CHECK(memcmp(expected->_bonePositions, result->_bonePositions, boneValueCount * sizeof(float[3])) == 0);
+	float maxError = 0.f;
+	for (uint32_t iBone = 0; iBone < boneValueCount; iBone++)
+		for (int i = 0; i < 4; i++)
+			maxError = fmaxf(maxError, fabsf(expected->_boneOrientations[iBone][i] - result->_boneOrientations[iBone][i]));
+	GLM_TEST_CHECK(maxError <= 4e-6f);
+	GLM_TEST_CHECK(glmTestSameFrameAttributes(simulationData, expected, result));
+	glmStopParallelForThreads();
+
+	// a crowd of one block stays on the calling thread
+	GlmSimulationData* smallSimulationData = NULL;
+	GlmFrameData* smallFrameData1 = NULL;
+	GlmFrameData* smallFrameData2 = NULL;
+	GlmFrameData* smallExpected = NULL;
+	GlmFrameData* smallResult = NULL;
+	glmTestCreateSimulation(&smallSimulationData, 100, 3, 5);
+	glmTestCreateFrame(&smallFrameData1, smallSimulationData, 5, 0, 0);
+	glmTestCreateFrame(&smallFrameData2, smallSimulationData, 6, 0, 0);
+	glmCreateFrameData(&smallExpected, smallSimulationData);
+	glmCreateFrameData(&smallResult, smallSimulationData);
+	glmParallelFor = glmTestParallelForReversed;
+	glmTestCallCounts.clear();
+	glmTestStrict(smallSimulationData, smallFrameData1, smallFrameData2, 0.5f, smallExpected, smallResult);
+	GLM_TEST_CHECK(glmTestCallCounts.empty());
+	glmParallelFor = NULL;
+
+	glmDestroyFrameData(&smallResult, smallSimulationData);
+	glmDestroyFrameData(&smallExpected, smallSimulationData);
+	glmDestroyFrameData(&smallFrameData2, smallSimulationData);
+	glmDestroyFrameData(&smallFrameData1, smallSimulationData);
+	glmDestroySimulationData(&smallSimulationData);
+	glmDestroyFrameData(&result, simulationData);
+	glmDestroyFrameData(&expected, simulationData);
+	glmDestroyFrameData(&frameData2, simulationData);
+	glmDestroyFrameData(&frameData1, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
@@ -0,0 +1,149 @@
+// glmUpdateLayoutEvaluator running out of memory in an incremental update, plain and deferred : the history copies, the dirty entity
+// masks, the masked and cloth arrays failing alone return GSC_OUT_OF_MEMORY, leave the evaluator cleared without leak, and the next
+// update evaluates from scratch to the full evaluation result
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail, only the allocation it counts down to fails
+static void* glmTestMalloc(size_t size)
+{
+	glmTestAllocationCount++;
+	if (glmTestAllocationsBeforeFailure == 0)
+	{
+		glmTestAllocationsBeforeFailure = -1;
+		return NULL;
+	}
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+enum { ENTITY_COUNT = 200, DUPLICATE_COUNT = 10, EDITED_COUNT = 20 };
+enum { TranslateAll, Duplicate, EditSome, TransformCount };
+
+static const char* glmTestFramePathModel = "layout_evaluator_missing.%d.gscf";
+
+// evaluator result against a full evaluation, deferred results once materialized
+static void glmTestCheckEvaluator(const GlmLayoutEvaluator* evaluator, GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history)
+{
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+	if (evaluator->_deferredFrameDataOut)
+	{
+		GlmFrameData* materializedFrameData;
+		glmMaterializeDeferredFrameData(evaluator->_deferredFrameDataOut, evaluator->_simulationDataOut, &materializedFrameData);
+		GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, evaluator->_simulationDataOut, materializedFrameData));
+		glmDestroyFrameData(&materializedFrameData, evaluator->_simulationDataOut);
+	}
+	else
+		GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, evaluator->_simulationDataOut, evaluator->_frameDataOut));
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+}
+
+// an incremental update editing EditSome, with its failingAllocationCount first and last allocations failing alone in turn
+static void glmTestFailingUpdates(GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history, uint8_t deferDuplicates, int firstFailingCount, int lastFailingCount)
+{
+	int liveAllocationCount = glmTestLiveAllocationCount;
+	GlmLayoutEvaluator* evaluator;
+	glmCreateLayoutEvaluator(&evaluator, simulationData);
+	evaluator->_deferDuplicates = deferDuplicates;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+
+	// allocations of a successful incremental update
+	history->_transformTranslate[EditSome][1] += 1.f;
+	glmTestAllocationCount = 0;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedEntityCount == EDITED_COUNT);
+	int allocationCount = glmTestAllocationCount;
+
+	for (int iFailing = 0; iFailing < firstFailingCount + lastFailingCount; iFailing++)
+	{
+		// full evaluation, then the incremental update failing
+		history->_transformTranslate[EditSome][1] += 1.f;
+		GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+		history->_transformTranslate[EditSome][1] += 1.f;
+		glmTestAllocationsBeforeFailure = iFailing < firstFailingCount ? iFailing : allocationCount - firstFailingCount - lastFailingCount + iFailing;
+		GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_OUT_OF_MEMORY);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(evaluator->_entityTransforms == NULL && evaluator->_frameDataOut == NULL && evaluator->_deferredFrameDataOut == NULL && evaluator->_transformHashes == NULL);
+		// only the evaluator itself is left
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount + 1);
+
+		// evaluated from scratch
+		GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+		GLM_TEST_CHECK(evaluator->_updatedTransformCount == ENTITY_COUNT + DUPLICATE_COUNT);
+		glmTestCheckEvaluator(evaluator, simulationData, frameData, history);
+	}
+	glmDestroyLayoutEvaluator(&evaluator);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount);
+}
+
+int main()
+{
+	GlmSimulationData* simulationData;
+	GlmFrameData* clothFrameData;
+	GlmFrameData* plainFrameData;
+	glmTestCreateSimulation(&simulationData, ENTITY_COUNT, 2, 6);
+	glmTestCreateFrame(&clothFrameData, simulationData, 0x1357u, 5, 16);
+	glmTestCreateFrame(&plainFrameData, simulationData, 0x2468u, 0, 0);
+
+	// translate all, duplicate the first entities, translate entities of the middle of the crowd (cloth every 5th)
+	GlmHistory* history;
+	glmTestCreateHistory(&history, simulationData, TransformCount, ENTITY_COUNT + DUPLICATE_COUNT + EDITED_COUNT, DUPLICATE_COUNT);
+	uint32_t iId = 0;
+	for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+		history->_entityIds[iId++] = simulationData->_entityIds[iEntity];
+	for (uint32_t iDuplicate = 0; iDuplicate < DUPLICATE_COUNT; iDuplicate++)
+	{
+		history->_entityIds[iId++] = simulationData->_entityIds[iDuplicate];
+		history->_duplicatedEntityIds[iDuplicate] = 1000000000 + (int64_t)iDuplicate;
+	}
+	for (uint32_t iEdited = 0; iEdited < EDITED_COUNT; iEdited++)
+		history->_entityIds[iId++] = simulationData->_entityIds[ENTITY_COUNT / 2 + iEdited];
+	history->_entityArrayStartIndex[TranslateAll] = 0;
+	history->_entityArrayCount[TranslateAll] = ENTITY_COUNT;
+	history->_transformTypes[TranslateAll] = SimulationCacheTranslate;
+	history->_transformTranslate[TranslateAll][0] = 10.f;
+	history->_entityArrayStartIndex[Duplicate] = ENTITY_COUNT;
+	history->_entityArrayCount[Duplicate] = DUPLICATE_COUNT;
+	history->_transformTypes[Duplicate] = SimulationCacheDuplicate;
+	history->_duplicatedEntityArrayCount[Duplicate] = DUPLICATE_COUNT;
+	history->_entityArrayStartIndex[EditSome] = ENTITY_COUNT + DUPLICATE_COUNT;
+	history->_entityArrayCount[EditSome] = EDITED_COUNT;
+	history->_transformTypes[EditSome] = SimulationCacheTranslate;
+
+	// the transform hashes, duplicate ids, dirty entities, previous and masked transforms, the masked simulation data ;
+	// the 3 cloth arrays and the 7 history copies
+	glmTestFailingUpdates(simulationData, clothFrameData, history, 0, 6, 3 + 7);
+	// deferred : the materialized entity mask before the masked transforms and simulation data
+	glmTestFailingUpdates(simulationData, plainFrameData, history, 1, 7, 7);
+
+	glmDestroyHistory(&history);
+	glmDestroyFrameData(&plainFrameData, simulationData);
+	glmDestroyFrameData(&clothFrameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
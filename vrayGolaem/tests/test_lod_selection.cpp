@@ -0,0 +1,104 @@
+// Screen space LOD selection : projected sizes of perspective and orthographic cameras, LOD switches exactly at the thresholds
+// without a previous LOD and at the edges of the hysteresis band with one, hidden entities keep their LOD
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+// entity of bounding sphere radius 5 at (0, 0, -distance)
+static void glmTestSetEntity(GlmEntityBoundingBox* bbox, float distance)
+{
+	memset(bbox, 0, sizeof(GlmEntityBoundingBox));
+	bbox->_isVisible = 1;
+	bbox->_boundingBoxHalfExtents[0] = 3.f;
+	bbox->_boundingBoxHalfExtents[2] = 4.f;
+	bbox->_entityOrigin[2] = -distance;
+}
+
+int main()
+{
+	// camera at the origin, vertical focal factor 2 : size = 2 * radius * 2 / distance * 200 / 2 pixels
+	GlmGeometryGenerationContext context;
+	memset(&context, 0, sizeof(context));
+	context._projectionMatrix[1][1] = 2.f;
+	context._projectionMatrix[2][3] = -1.f;
+	GlmEntityBoundingBox bbox;
+	glmTestSetEntity(&bbox, 20.f);
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&context, &bbox, 200.f) == 100.f);
+	bbox._entityScale = 2.f;
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&context, &bbox, 200.f) == 200.f);
+	// camera on the sphere or inside it
+	glmTestSetEntity(&bbox, 5.f);
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&context, &bbox, 200.f) == FLT_MAX);
+	glmTestSetEntity(&bbox, 0.f);
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&context, &bbox, 200.f) == FLT_MAX);
+
+	// orthographic : independent of the distance
+	GlmGeometryGenerationContext orthoContext;
+	memset(&orthoContext, 0, sizeof(orthoContext));
+	orthoContext._projectionMatrix[1][1] = 0.125f;
+	orthoContext._projectionMatrix[3][3] = 1.f;
+	glmTestSetEntity(&bbox, 0.f);
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&orthoContext, &bbox, 200.f) == 125.f);
+	glmTestSetEntity(&bbox, 1000.f);
+	GLM_TEST_CHECK(glmComputeEntityScreenSize(&orthoContext, &bbox, 200.f) == 125.f);
+
+	// 3 LODs switching at 100 and 20 pixels, band of +/-25% once an entity has a LOD : 75..125 and 15..25 pixels
+	float thresholds[2] = { 100.f, 20.f };
+	GlmLodSettings settings = { 3, thresholds, 0.25f, 200.f };
+	const float belowHundred = nextafterf(100.f, 0.f);
+	const float belowTwenty = nextafterf(20.f, 0.f);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, FLT_MAX, GIO_NO_LOD) == 0);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 100.f, GIO_NO_LOD) == 0);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, belowHundred, GIO_NO_LOD) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 20.f, GIO_NO_LOD) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, belowTwenty, GIO_NO_LOD) == 2);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 0.f, GIO_NO_LOD) == 2);
+
+	// from LOD 0 : kept down to 75 pixels
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 75.f, 0) == 0);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(75.f, 0.f), 0) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, belowTwenty, 0) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(15.f, 0.f), 0) == 2);
+	// from LOD 1 : back to LOD 0 from 125 pixels, to LOD 2 under 15 pixels
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(125.f, 0.f), 1) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 125.f, 1) == 0);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 15.f, 1) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(15.f, 0.f), 1) == 2);
+	// from LOD 2 : back to LOD 1 from 25 pixels, straight to LOD 0 from 125 pixels
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(25.f, 0.f), 2) == 2);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 25.f, 2) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, nextafterf(125.f, 0.f), 2) == 1);
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 125.f, 2) == 0);
+
+	// a single LOD or none : always the full resolution
+	settings._lodCount = 1;
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 0.f, 2) == 0);
+	settings._lodCount = 0;
+	GLM_TEST_CHECK(glmSelectEntityLod(&settings, 0.f, GIO_NO_LOD) == 0);
+	settings._lodCount = 3;
+
+	// context entities at 100, 80, 16 and 10 pixels, the last one culled
+	GlmEntityBoundingBox bboxes[4];
+	glmTestSetEntity(&bboxes[0], 20.f);
+	glmTestSetEntity(&bboxes[1], 25.f);
+	glmTestSetEntity(&bboxes[2], 125.f);
+	glmTestSetEntity(&bboxes[3], 200.f);
+	bboxes[3]._isVisible = 0;
+	context._entityCount = 4;
+	context._entityBBoxes = bboxes;
+	context._enableFrustumCulling = 1;
+	uint8_t lods[4] = { GIO_NO_LOD, GIO_NO_LOD, GIO_NO_LOD, GIO_NO_LOD };
+	glmSelectEntityLods(&context, &settings, lods);
+	GLM_TEST_CHECK(lods[0] == 0 && lods[1] == 1 && lods[2] == 2 && lods[3] == GIO_NO_LOD);
+	// next frame from LODs 0, 0, 1 : inside their band, 80 pixels stays on LOD 0 and 16 pixels on LOD 1
+	lods[0] = 0;
+	lods[1] = 0;
+	lods[2] = 1;
+	glmSelectEntityLods(&context, &settings, lods);
+	GLM_TEST_CHECK(lods[0] == 0 && lods[1] == 0 && lods[2] == 1 && lods[3] == GIO_NO_LOD);
+	// without frustum culling every entity gets a LOD
+	context._enableFrustumCulling = 0;
+	glmSelectEntityLods(&context, &settings, lods);
+	GLM_TEST_CHECK(lods[3] == 2);
+	return glmTestResult();
+}
@@ -0,0 +1,67 @@
+// Build without std threads, as with the VS2010 (vc101) / VS2012 (vc11) toolchains : glmParallelForThreads runs every item once on
+// the calling thread, GlmStringTable locks with GlmMutex and stays usable from several threads
+#define GIO_NO_STD_THREADS
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+#include <pthread.h>
+
+#ifdef GIO_USE_STD_THREADS
+#error "GIO_NO_STD_THREADS must disable std threads"
+#endif
+
+struct GlmTestItems
+{
+	std::vector<unsigned int> _runCounts;
+	unsigned int _callCount;
+};
+
+static void glmTestCountItems(void* userData, unsigned int first, unsigned int last)
+{
+	GlmTestItems* items = (GlmTestItems*)userData;
+	items->_callCount++;
+	for (unsigned int iItem = first; iItem < last; iItem++)
+		items->_runCounts[iItem]++;
+}
+
+// interns the same 1000 names, returns the handles through userData
+static void* glmTestIntern(void* userData)
+{
+	std::pair<GlmStringTable*, std::vector<GlmStringHandle> >* table = (std::pair<GlmStringTable*, std::vector<GlmStringHandle> >*)userData;
+	char name[32];
+	for (int iName = 0; iName < 1000; iName++)
+	{
+		sprintf(name, "mesh_%d", iName);
+		table->second.push_back(table->first->intern(name));
+	}
+	return NULL;
+}
+
+int main()
+{
+	// one call over the whole range
+	GlmTestItems items;
+	items._runCounts.assign(1000, 0);
+	items._callCount = 0;
+	glmParallelForThreads(glmTestCountItems, &items, 1000);
+	GLM_TEST_CHECK(items._callCount == 1);
+	GLM_TEST_CHECK(std::count(items._runCounts.begin(), items._runCounts.end(), 1u) == 1000);
+	glmStopParallelForThreads();
+
+	// concurrent interning gives the same handles
+	GlmStringTable table;
+	std::pair<GlmStringTable*, std::vector<GlmStringHandle> > results[4];
+	pthread_t threads[4];
+	for (int iThread = 0; iThread < 4; iThread++)
+	{
+		results[iThread].first = &table;
+		pthread_create(&threads[iThread], NULL, glmTestIntern, &results[iThread]);
+	}
+	for (int iThread = 0; iThread < 4; iThread++)
+		pthread_join(threads[iThread], NULL);
+	GLM_TEST_CHECK(table.size() == 1000);
+	for (int iThread = 1; iThread < 4; iThread++)
+		GLM_TEST_CHECK(results[iThread].second == results[0].second);
+	GLM_TEST_CHECK(strcmp(table.get(results[0].second[42]), "mesh_42") == 0);
+	return glmTestResult();
+}
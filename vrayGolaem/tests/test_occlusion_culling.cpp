@@ -0,0 +1,159 @@
+// glmOcclusionCullContextEntities on a wall of entities hiding a crowd behind it : the camera visibilities of both modes, _isVisible
+// cleared for the hidden entities or kept for secondary rays with _keepForSecondaryRays, frustum culling off, allocations through
+// GLMC_MALLOC and GIO_OUT_OF_MEMORY when one fails
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+enum { WALL_SIZE = 10, HIDDEN_COUNT = 9 };
+
+static void glmTestSetEntity(GlmEntityBoundingBox* bbox, float x, float y, float z, float extent)
+{
+	memset(bbox, 0, sizeof(GlmEntityBoundingBox));
+	bbox->_isVisible = 1;
+	bbox->_entityOrigin[0] = x;
+	bbox->_entityOrigin[1] = y;
+	bbox->_entityOrigin[2] = z;
+	bbox->_boundingBoxHalfExtents[0] = bbox->_boundingBoxHalfExtents[1] = bbox->_boundingBoxHalfExtents[2] = extent;
+	bbox->_entityScale = 1.f;
+}
+
+// wall entities first, then the hidden ones, one beside the wall and one behind the camera. Wall boxes overlap their neighbors : texels
+// on the diagonal of a face are covered by neither of its triangles
+static void glmTestCreateScene(std::vector<GlmEntityBoundingBox>& bboxes)
+{
+	bboxes.resize(WALL_SIZE * WALL_SIZE + HIDDEN_COUNT + 2);
+	size_t iEntity = 0;
+	for (int iY = 0; iY < WALL_SIZE; iY++)
+		for (int iX = 0; iX < WALL_SIZE; iX++)
+			glmTestSetEntity(&bboxes[iEntity++], -9.f + 2.f * iX, -9.f + 2.f * iY, -10.f, 2.f);
+	for (int iHidden = 0; iHidden < HIDDEN_COUNT; iHidden++)
+		glmTestSetEntity(&bboxes[iEntity++], -8.f + 8.f * (iHidden % 3), -8.f + 8.f * (iHidden / 3), -50.f, 1.f);
+	glmTestSetEntity(&bboxes[iEntity++], 90.f, 0.f, -50.f, 1.f);
+	glmTestSetEntity(&bboxes[iEntity++], 0.f, 0.f, 20.f, 1.f);
+}
+
+int main()
+{
+	// camera at the origin looking down -Z, 90 degrees vertical field of view, aspect 2
+	GlmGeometryGenerationContext context;
+	memset(&context, 0, sizeof(context));
+	for (int i = 0; i < 4; i++)
+		context._viewMatrix[i][i] = 1.f;
+	context._projectionMatrix[0][0] = 0.5f;
+	context._projectionMatrix[1][1] = 1.f;
+	context._projectionMatrix[2][2] = -1.002f;
+	context._projectionMatrix[2][3] = -1.f;
+	context._projectionMatrix[3][2] = -0.2002f;
+	context._enableFrustumCulling = 1;
+
+	GlmOcclusionSettings settings;
+	settings._width = 128;
+	settings._height = 64;
+	settings._occluderCount = WALL_SIZE * WALL_SIZE;
+	settings._occluderScale = 0.9f;
+
+	const uint32_t besideIndex = WALL_SIZE * WALL_SIZE + HIDDEN_COUNT;
+	const uint32_t behindIndex = besideIndex + 1;
+	std::vector<GlmEntityBoundingBox> bboxes;
+	std::vector<uint8_t> cameraVisibilities[2];
+	for (int keepForSecondaryRays = 0; keepForSecondaryRays < 2; keepForSecondaryRays++)
+	{
+		glmTestCreateScene(bboxes);
+		context._entityCount = (uint32_t)bboxes.size();
+		context._entityBBoxes = &bboxes[0];
+		settings._keepForSecondaryRays = (uint8_t)keepForSecondaryRays;
+		std::vector<uint8_t>& visibilities = cameraVisibilities[keepForSecondaryRays];
+		visibilities.assign(bboxes.size(), 2);
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		GLM_TEST_CHECK(bboxes[behindIndex]._isVisible == 0);
+		GLM_TEST_CHECK(glmOcclusionCullContextEntities(&context, &settings, NULL, &visibilities[0]) == GIO_SUCCESS);
+
+		// the wall and the entity beside it are seen, the crowd behind the wall is not
+		for (uint32_t iEntity = 0; iEntity < WALL_SIZE * WALL_SIZE; iEntity++)
+			GLM_TEST_CHECK(visibilities[iEntity] == 1 && bboxes[iEntity]._isVisible == 1);
+		for (uint32_t iEntity = WALL_SIZE * WALL_SIZE; iEntity < besideIndex; iEntity++)
+		{
+			GLM_TEST_CHECK(visibilities[iEntity] == 0);
+			// hidden from the camera only, still in shadows and reflections with _keepForSecondaryRays
+			GLM_TEST_CHECK(bboxes[iEntity]._isVisible == keepForSecondaryRays);
+		}
+		GLM_TEST_CHECK(visibilities[besideIndex] == 1 && bboxes[besideIndex]._isVisible == 1);
+		// frustum culled entities are not visible from the camera in both modes
+		GLM_TEST_CHECK(visibilities[behindIndex] == 0 && bboxes[behindIndex]._isVisible == 0);
+	}
+	GLM_TEST_CHECK(cameraVisibilities[0] == cameraVisibilities[1]);
+
+	// no occluder : nothing hidden
+	glmTestCreateScene(bboxes);
+	context._entityBBoxes = &bboxes[0];
+	settings._occluderCount = 0;
+	settings._keepForSecondaryRays = 0;
+	std::vector<uint8_t> visibilities(bboxes.size(), 2);
+	GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmOcclusionCullContextEntities(&context, &settings, NULL, &visibilities[0]) == GIO_SUCCESS);
+	for (uint32_t iEntity = 0; iEntity < behindIndex; iEntity++)
+		GLM_TEST_CHECK(visibilities[iEntity] == 1 && bboxes[iEntity]._isVisible == 1);
+	settings._occluderCount = WALL_SIZE * WALL_SIZE;
+
+	// frustum culling off : every entity visible from the camera, _isVisible untouched
+	glmTestCreateScene(bboxes);
+	context._entityBBoxes = &bboxes[0];
+	context._enableFrustumCulling = 0;
+	bboxes[0]._isVisible = 7;
+	visibilities.assign(bboxes.size(), 2);
+	GLM_TEST_CHECK(glmOcclusionCullContextEntities(&context, &settings, NULL, &visibilities[0]) == GIO_SUCCESS);
+	GLM_TEST_CHECK(std::count(visibilities.begin(), visibilities.end(), (uint8_t)1) == (int)bboxes.size());
+	GLM_TEST_CHECK(bboxes[0]._isVisible == 7);
+	context._enableFrustumCulling = 1;
+
+	// each allocation failing in turn : GIO_OUT_OF_MEMORY, nothing leaked, _isVisible untouched
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	int failureCount = 0;
+	for (int allocationCount = 0; ; allocationCount++)
+	{
+		glmTestCreateScene(bboxes);
+		context._entityBBoxes = &bboxes[0];
+		GLM_TEST_CHECK(glmCullContextEntities(&context) == GIO_SUCCESS);
+		visibilities.assign(bboxes.size(), 2);
+		glmTestAllocationsBeforeFailure = allocationCount;
+		GlmGeometryGenerationStatus status = glmOcclusionCullContextEntities(&context, &settings, NULL, &visibilities[0]);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+		if (status == GIO_SUCCESS)
+		{
+			GLM_TEST_CHECK(visibilities == cameraVisibilities[0]);
+			break;
+		}
+		GLM_TEST_CHECK(status == GIO_OUT_OF_MEMORY);
+		GLM_TEST_CHECK(bboxes[WALL_SIZE * WALL_SIZE]._isVisible == 1);
+		failureCount++;
+	}
+	// one allocation per depth buffer level, then the distance and sorted entity arrays
+	GLM_TEST_CHECK(failureCount == 8 + 2);
+	return glmTestResult();
+}
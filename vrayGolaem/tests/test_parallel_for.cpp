@@ -0,0 +1,105 @@
+// GlmThreadPool behind glmParallelForThreads : every item runs exactly once, over many calls, with nested and concurrent parallel fors.
+// Runs on glmParallelForThreads and on a pool of 3 workers, so the workers are used on single core machines too
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+struct GlmTestParallelForItems
+{
+	GlmThreadPool* _pool; // glmParallelForThreads when NULL
+	std::vector<std::atomic<unsigned int> >* _runCounts;
+	GlmTestParallelForItems* _nestedItems; // each item starts a parallel for over the nested items when not NULL
+};
+
+static void glmTestCountItems(void* userData, unsigned int first, unsigned int last);
+
+static void glmTestRunParallelFor(GlmTestParallelForItems* items)
+{
+	unsigned int count = (unsigned int)items->_runCounts->size();
+	if (items->_pool)
+		items->_pool->run(glmTestCountItems, items, count);
+	else
+		glmParallelForThreads(glmTestCountItems, items, count);
+}
+
+static void glmTestCountItems(void* userData, unsigned int first, unsigned int last)
+{
+	GlmTestParallelForItems* items = (GlmTestParallelForItems*)userData;
+	for (unsigned int iItem = first; iItem < last; iItem++)
+	{
+		(*items->_runCounts)[iItem]++;
+		if (items->_nestedItems)
+			glmTestRunParallelFor(items->_nestedItems);
+	}
+}
+
+static void glmTestResetCounts(std::vector<std::atomic<unsigned int> >& runCounts)
+{
+	for (size_t iItem = 0; iItem < runCounts.size(); iItem++)
+		runCounts[iItem] = 0;
+}
+
+static int glmTestRanTimes(const std::vector<std::atomic<unsigned int> >& runCounts, unsigned int expectedCount)
+{
+	for (size_t iItem = 0; iItem < runCounts.size(); iItem++)
+		if (runCounts[iItem].load() != expectedCount)
+			return 0;
+	return 1;
+}
+
+static void glmTestParallelFor(GlmThreadPool* pool, unsigned int count, int callCount)
+{
+	std::vector<std::atomic<unsigned int> > runCounts(count);
+	glmTestResetCounts(runCounts);
+	GlmTestParallelForItems items = { pool, &runCounts, NULL };
+	for (int iCall = 0; iCall < callCount; iCall++)
+		glmTestRunParallelFor(&items);
+	GLM_TEST_CHECK(glmTestRanTimes(runCounts, (unsigned int)callCount));
+}
+
+static void glmTestPool(GlmThreadPool* pool)
+{
+	// item counts around the chunking
+	const unsigned int counts[] = { 0, 1, 2, 3, 7, 64, 1000, 100003 };
+	for (size_t iCount = 0; iCount < sizeof(counts) / sizeof(counts[0]); iCount++)
+		glmTestParallelFor(pool, counts[iCount], 3);
+
+	// many short calls reuse the same workers
+	glmTestParallelFor(pool, 256, 2000);
+
+	// tasks calling glmParallelFor run their nested loop on their own thread
+	std::vector<std::atomic<unsigned int> > outerCounts(100), innerCounts(37);
+	glmTestResetCounts(outerCounts);
+	glmTestResetCounts(innerCounts);
+	GlmTestParallelForItems innerItems = { pool, &innerCounts, NULL };
+	GlmTestParallelForItems outerItems = { pool, &outerCounts, &innerItems };
+	glmTestRunParallelFor(&outerItems);
+	GLM_TEST_CHECK(glmTestRanTimes(outerCounts, 1));
+	GLM_TEST_CHECK(glmTestRanTimes(innerCounts, (unsigned int)outerCounts.size()));
+
+	// callers on several threads : one gets the pool, the others run on their own thread
+	std::vector<std::thread> callers;
+	for (unsigned int iCaller = 0; iCaller < 4; iCaller++)
+		callers.push_back(std::thread(glmTestParallelFor, pool, 5000u + iCaller, 50));
+	for (size_t iCaller = 0; iCaller < callers.size(); iCaller++)
+		callers[iCaller].join();
+}
+
+int main()
+{
+	GlmThreadPool* pool = new GlmThreadPool(3);
+	GLM_TEST_CHECK(pool->workerCount() == 3);
+	glmTestPool(pool);
+	delete pool;
+
+	glmTestPool(NULL);
+	GLM_TEST_CHECK(glmParallelForPool() != NULL);
+	GLM_TEST_CHECK(glmParallelForPool()->workerCount() + 1 >= std::thread::hardware_concurrency());
+
+	// stopped pool is created again on the next call
+	glmStopParallelForThreads();
+	GLM_TEST_CHECK(glmParallelForPool() == NULL);
+	glmTestParallelFor(NULL, 1000, 2);
+	glmStopParallelForThreads();
+	return glmTestResult();
+}
@@ -0,0 +1,61 @@
+// GlmPooledArray : chunks allocated on demand through GLMC_MALLOC, zeroed, never moved, released through GLMC_FREE
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static void* glmTestMalloc(size_t size) { glmTestLiveAllocationCount++; return malloc(size); }
+static void glmTestFree(void* ptr) { if (ptr) glmTestLiveAllocationCount--; free(ptr); }
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+struct PooledElement
+{
+	float _values[16];
+};
+
+int main()
+{
+	typedef GlmPooledArray<PooledElement, 16, 1000> PooledArray;
+	PooledArray* array = (PooledArray*)GLMC_MALLOC(sizeof(PooledArray));
+	array->init();
+	int allocationCount = glmTestLiveAllocationCount;
+
+	// nothing allocated until reserved : only the chunk directory is embedded
+	GLM_TEST_CHECK(array->capacity() == 0);
+	GLM_TEST_CHECK(array->allocatedBytes() == sizeof(PooledArray));
+	GLM_TEST_CHECK(sizeof(PooledArray) < 1000 * sizeof(PooledElement) / 8);
+
+	// 3 elements use one chunk
+	GLM_TEST_CHECK(array->reserve(3) == 1);
+	GLM_TEST_CHECK(array->capacity() == 16);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount + 1);
+	GLM_TEST_CHECK(array->allocatedBytes() == sizeof(PooledArray) + 16 * sizeof(PooledElement));
+	bool zeroed = true;
+	for (uint32_t iElement = 0; iElement < 16; iElement++)
+		for (int iValue = 0; iValue < 16; iValue++)
+			zeroed &= (*array)[iElement]._values[iValue] == 0.f;
+	GLM_TEST_CHECK(zeroed);
+
+	// growing keeps the elements in place
+	(*array)[2]._values[5] = 42.f;
+	PooledElement* element = &(*array)[2];
+	GLM_TEST_CHECK(array->reserve(1000) == 1);
+	GLM_TEST_CHECK(array->capacity() == 1008);
+	GLM_TEST_CHECK(&(*array)[2] == element && element->_values[5] == 42.f);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount + 63);
+	(*array)[999]._values[15] = 1.f;
+	GLM_TEST_CHECK((*array)[999]._values[15] == 1.f);
+
+	// over maxCount fails without allocating
+	GLM_TEST_CHECK(array->reserve(1001) == 0);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount + 63);
+
+	array->release();
+	GLM_TEST_CHECK(array->capacity() == 0);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount);
+	GLMC_FREE(array);
+	return glmTestResult();
+}
@@ -0,0 +1,296 @@
+// Batched math helpers and frame kernels : every glmSimdKernels variant (scalar, SSE2, AVX2 when the CPU supports it) is checked bit exact
+// against the per element helpers, for counts covering the vector loops and their tails, in place and out of place.
+// Also checks glmMultMatrix and the 4 lanes SSE quaternion helpers
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+static const unsigned int glmTestMaxCount = 19; // two AVX2 iterations + a tail of every length
+static const float glmTestGuard = -12345.f; // destination values past count must be left untouched
+
+static void glmTestRandomArray(uint32_t* randomState, float* values, size_t count, float minValue, float maxValue)
+{
+	for (size_t i = 0; i < count; i++)
+		values[i] = glmTestRandomRange(randomState, minValue, maxValue);
+}
+
+static void glmTestRandomQuaternion(uint32_t* randomState, float* quaternion)
+{
+	glmTestRandomArray(randomState, quaternion, 4, -1.f, 1.f);
+	glmNormalizeQuaternion(quaternion);
+}
+
+static void glmTestRandomMatrix(uint32_t* randomState, float* matrix)
+{
+	glmTestRandomArray(randomState, matrix, 16, -3.f, 3.f);
+	matrix[3] = matrix[7] = matrix[11] = 0.f;
+	matrix[15] = 1.f;
+}
+
+// destination arrays have count + 1 elements, the last one must keep its value
+static int glmTestSameFloats(const std::vector<float>& a, const std::vector<float>& b)
+{
+	return a.size() == b.size() && (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(float)) == 0);
+}
+
+static void glmTestKernels(const GlmSimdKernels* kernels, uint32_t* randomState)
+{
+	for (unsigned int count = 0; count <= glmTestMaxCount; count++)
+	{
+		float matrix[16];
+		float quaternion[4];
+		std::vector<float> points((count + 1) * 3), quaternions((count + 1) * 4);
+		std::vector<float> expected, result, inPlace;
+		unsigned int i;
+
+		glmTestRandomMatrix(randomState, matrix);
+		glmTestRandomQuaternion(randomState, quaternion);
+		glmTestRandomArray(randomState, &points[0], points.size(), -100.f, 100.f);
+		for (i = 0; i <= count; i++)
+			glmTestRandomQuaternion(randomState, &quaternions[i * 4]);
+
+		// points
+		expected.assign(points.size(), glmTestGuard);
+		for (i = 0; i < count; i++)
+			glmTransformPoint(&points[i * 3], matrix, &expected[i * 3]);
+		result.assign(points.size(), glmTestGuard);
+		kernels->_transformPoints((const float(*)[3])&points[0], matrix, (float(*)[3])&result[0], count);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+		inPlace = points;
+		kernels->_transformPoints((const float(*)[3])&inPlace[0], matrix, (float(*)[3])&inPlace[0], count);
+		memcpy(&expected[count * 3], &points[count * 3], sizeof(float) * 3);
+		GLM_TEST_CHECK(glmTestSameFloats(inPlace, expected));
+
+		expected.assign(points.size(), glmTestGuard);
+		for (i = 0; i < count; i++)
+			glmMultVec3Quaternion(quaternion, &points[i * 3], &expected[i * 3]);
+		result.assign(points.size(), glmTestGuard);
+		kernels->_multVec3Quaternions(quaternion, (const float(*)[3])&points[0], (float(*)[3])&result[0], count);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+		inPlace = points;
+		kernels->_multVec3Quaternions(quaternion, (const float(*)[3])&inPlace[0], (float(*)[3])&inPlace[0], count);
+		memcpy(&expected[count * 3], &points[count * 3], sizeof(float) * 3);
+		GLM_TEST_CHECK(glmTestSameFloats(inPlace, expected));
+
+		// quaternions
+		expected.assign(quaternions.size(), glmTestGuard);
+		for (i = 0; i < count; i++)
+			glmMultQuaternion(quaternion, &quaternions[i * 4], &expected[i * 4]);
+		result.assign(quaternions.size(), glmTestGuard);
+		kernels->_multQuaternions(quaternion, (const float(*)[4])&quaternions[0], (float(*)[4])&result[0], count);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+		inPlace = quaternions;
+		kernels->_multQuaternions(quaternion, (const float(*)[4])&inPlace[0], (float(*)[4])&inPlace[0], count);
+		memcpy(&expected[count * 4], &quaternions[count * 4], sizeof(float) * 4);
+		GLM_TEST_CHECK(glmTestSameFloats(inPlace, expected));
+
+		// unnormalized input, with a null quaternion
+		glmTestRandomArray(randomState, &quaternions[0], quaternions.size(), -10.f, 10.f);
+		if (count)
+			memset(&quaternions[(count / 2) * 4], 0, sizeof(float) * 4);
+		expected = quaternions;
+		for (i = 0; i < count; i++)
+			glmNormalizeQuaternion(&expected[i * 4]);
+		result = quaternions;
+		kernels->_normalizeQuaternions((float(*)[4])&result[0], count);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+
+		// cloth vertices
+		std::vector<uint16_t> compressed((count + 1) * 3);
+		float reference[3];
+		float maxValue = glmTestRandomRange(randomState, 0.5f, 50.f);
+		for (i = 0; i < compressed.size(); i++)
+			compressed[i] = (uint16_t)(glmTestRandom(randomState) * 65536.f);
+		compressed[0] = 0;
+		compressed[compressed.size() - 1] = 65535;
+		glmTestRandomArray(randomState, reference, 3, -100.f, 100.f);
+		expected.assign(points.size(), glmTestGuard);
+		for (i = 0; i < count * 3; i++)
+		{
+			glmUncompressFloatRL(&expected[i], compressed[i], -maxValue, maxValue, 16u);
+			expected[i] += reference[i % 3];
+		}
+		result.assign(points.size(), glmTestGuard);
+		kernels->_uncompressPositions48((float(*)[3])&result[0], (const uint16_t(*)[3])&compressed[0], count, maxValue, reference);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+
+		float pivot[3];
+		float scale = glmTestRandomRange(randomState, 0.5f, 2.f);
+		float expectedMin[3] = { 1e30f, 1e30f, 1e30f }, expectedMax[3] = { -1e30f, -1e30f, -1e30f };
+		float boundsMin[3] = { 1e30f, 1e30f, 1e30f }, boundsMax[3] = { -1e30f, -1e30f, -1e30f };
+		glmTestRandomArray(randomState, pivot, 3, -10.f, 10.f);
+		expected.assign(points.size(), glmTestGuard);
+		for (i = 0; i < count; i++)
+		{
+			glmTransformPoint(&points[i * 3], matrix, &expected[i * 3]);
+			for (unsigned int iComp = 0; iComp < 3; iComp++)
+			{
+				float coord = (expected[i * 3 + iComp] - pivot[iComp]) * scale + pivot[iComp];
+				if (coord < expectedMin[iComp]) expectedMin[iComp] = coord;
+				if (coord > expectedMax[iComp]) expectedMax[iComp] = coord;
+				expected[i * 3 + iComp] = coord;
+			}
+		}
+		result.assign(points.size(), glmTestGuard);
+		kernels->_transformClothVertices((const float(*)[3])&points[0], (float(*)[3])&result[0], count, matrix, pivot, scale, boundsMin, boundsMax);
+		GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+		GLM_TEST_CHECK(memcmp(boundsMin, expectedMin, sizeof(boundsMin)) == 0);
+		GLM_TEST_CHECK(memcmp(boundsMax, expectedMax, sizeof(boundsMax)) == 0);
+	}
+}
+
+// public helpers go through the selected level
+static void glmTestPublicHelpers(uint32_t* randomState)
+{
+	const unsigned int count = glmTestMaxCount;
+	float matrix[16];
+	float quaternion[4];
+	std::vector<float> points(count * 3), quaternions(count * 4);
+	std::vector<float> expected, result;
+	unsigned int i;
+
+	glmTestRandomMatrix(randomState, matrix);
+	glmTestRandomQuaternion(randomState, quaternion);
+	glmTestRandomArray(randomState, &points[0], points.size(), -100.f, 100.f);
+	glmTestRandomArray(randomState, &quaternions[0], quaternions.size(), -1.f, 1.f);
+
+	expected.resize(points.size());
+	for (i = 0; i < count; i++)
+		glmTransformPoint(&points[i * 3], matrix, &expected[i * 3]);
+	result.resize(points.size());
+	glmTransformPoints((const float(*)[3])&points[0], matrix, (float(*)[3])&result[0], count);
+	GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+
+	for (i = 0; i < count; i++)
+		glmMultVec3Quaternion(quaternion, &points[i * 3], &expected[i * 3]);
+	glmMultVec3Quaternions(quaternion, (const float(*)[3])&points[0], (float(*)[3])&result[0], count);
+	GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+
+	expected.resize(quaternions.size());
+	for (i = 0; i < count; i++)
+		glmMultQuaternion(quaternion, &quaternions[i * 4], &expected[i * 4]);
+	result.resize(quaternions.size());
+	glmMultQuaternions(quaternion, (const float(*)[4])&quaternions[0], (float(*)[4])&result[0], count);
+	GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+
+	for (i = 0; i < count; i++)
+		glmNormalizeQuaternion(&expected[i * 4]);
+	glmNormalizeQuaternions((float(*)[4])&result[0], count);
+	GLM_TEST_CHECK(glmTestSameFloats(result, expected));
+}
+
+// glmMultMatrix against the sums of the scalar build, including r aliasing a or b
+static void glmTestMultMatrix(uint32_t* randomState)
+{
+	for (int iTest = 0; iTest < 100; iTest++)
+	{
+		float a[16], b[16], expected[16], r[16];
+		glmTestRandomArray(randomState, a, 16, -10.f, 10.f);
+		glmTestRandomArray(randomState, b, 16, -10.f, 10.f);
+		for (int iRow = 0; iRow < 4; iRow++)
+			for (int iColumn = 0; iColumn < 4; iColumn++)
+				expected[iRow * 4 + iColumn] = a[iRow * 4 + 0] * b[iColumn] + a[iRow * 4 + 1] * b[4 + iColumn] + a[iRow * 4 + 2] * b[8 + iColumn] + a[iRow * 4 + 3] * b[12 + iColumn];
+
+		glmMultMatrix(a, b, r);
+		GLM_TEST_CHECK(memcmp(r, expected, sizeof(r)) == 0);
+		memcpy(r, a, sizeof(r));
+		glmMultMatrix(r, b, r);
+		GLM_TEST_CHECK(memcmp(r, expected, sizeof(r)) == 0);
+		memcpy(r, b, sizeof(r));
+		glmMultMatrix(a, r, r);
+		GLM_TEST_CHECK(memcmp(r, expected, sizeof(r)) == 0);
+	}
+}
+
+#ifdef GLMC_USE_SSE
+// one register per component, lane iLane of each register is element iLane
+static void glmTestLoadLanes(const float* values, unsigned int componentCount, __m128* lanes)
+{
+	for (unsigned int iComp = 0; iComp < componentCount; iComp++)
+		lanes[iComp] = _mm_setr_ps(values[iComp], values[componentCount + iComp], values[componentCount * 2 + iComp], values[componentCount * 3 + iComp]);
+}
+
+static void glmTestStoreLanes(const __m128* lanes, unsigned int componentCount, float* values)
+{
+	for (unsigned int iComp = 0; iComp < componentCount; iComp++)
+	{
+		float lane[4];
+		_mm_storeu_ps(lane, lanes[iComp]);
+		for (unsigned int iLane = 0; iLane < 4; iLane++)
+			values[componentCount * iLane + iComp] = lane[iLane];
+	}
+}
+
+// 4 lanes helpers of the skeleton passes, each lane against the scalar helper
+static void glmTestQuaternion4(uint32_t* randomState)
+{
+	for (int iTest = 0; iTest < 100; iTest++)
+	{
+		float a[16], b[16], positions[12], expected[16], result[16];
+		__m128 aV[4], bV[4], posV[3], rV[4];
+		unsigned int iLane;
+		for (iLane = 0; iLane < 4; iLane++)
+		{
+			glmTestRandomQuaternion(randomState, a + iLane * 4);
+			glmTestRandomQuaternion(randomState, b + iLane * 4);
+		}
+		glmTestRandomArray(randomState, positions, 12, -100.f, 100.f);
+		glmTestLoadLanes(a, 4, aV);
+		glmTestLoadLanes(b, 4, bV);
+		glmTestLoadLanes(positions, 3, posV);
+
+		for (iLane = 0; iLane < 4; iLane++)
+			glmMultQuaternion(a + iLane * 4, b + iLane * 4, expected + iLane * 4);
+		glmMultQuaternion4(aV, bV, rV);
+		glmTestStoreLanes(rV, 4, result);
+		GLM_TEST_CHECK(memcmp(result, expected, sizeof(float) * 16) == 0);
+		glmMultQuaternion4(aV, bV, bV); // r aliasing b
+		glmTestStoreLanes(bV, 4, result);
+		GLM_TEST_CHECK(memcmp(result, expected, sizeof(float) * 16) == 0);
+
+		for (iLane = 0; iLane < 4; iLane++)
+			glmMultVec3Quaternion(a + iLane * 4, positions + iLane * 3, expected + iLane * 3);
+		glmMultVec3Quaternion4(aV, posV, rV);
+		glmTestStoreLanes(rV, 3, result);
+		GLM_TEST_CHECK(memcmp(result, expected, sizeof(float) * 12) == 0);
+
+		glmTestRandomArray(randomState, a, 16, -10.f, 10.f);
+		memset(a + 8, 0, sizeof(float) * 4);
+		glmTestLoadLanes(a, 4, aV);
+		memcpy(expected, a, sizeof(float) * 16);
+		for (iLane = 0; iLane < 4; iLane++)
+			glmNormalizeQuaternion(expected + iLane * 4);
+		glmNormalizeQuaternion4(aV);
+		glmTestStoreLanes(aV, 4, result);
+		GLM_TEST_CHECK(memcmp(result, expected, sizeof(float) * 16) == 0);
+	}
+}
+#endif
+
+int main()
+{
+	uint32_t randomState = 0x51d0u;
+
+	glmTestKernels(&glmSimdKernelsScalar, &randomState);
+#ifdef GLMC_USE_SSE
+	glmTestKernels(&glmSimdKernelsSse2, &randomState);
+	glmTestQuaternion4(&randomState);
+#endif
+#ifdef GLMC_USE_AVX2
+	if (glmCpuSupportsAvx2())
+		glmTestKernels(&glmSimdKernelsAvx2, &randomState);
+	else
+		printf("AVX2 not supported by the CPU, AVX2 kernels not tested\n");
+#endif
+
+	const GlmSimdLevel levels[3] = { GSC_SIMD_SCALAR, GSC_SIMD_SSE2, GSC_SIMD_AVX2 };
+	for (int iLevel = 0; iLevel < 3; iLevel++)
+	{
+		GlmSimdLevel level = glmSetSimdLevel(levels[iLevel]);
+		GLM_TEST_CHECK(level <= levels[iLevel] && glmGetSimdLevel() == level);
+		glmTestPublicHelpers(&randomState);
+		glmTestMultMatrix(&randomState);
+	}
+	glmInitSimdDispatch();
+	return glmTestResult();
+}
@@ -0,0 +1,247 @@
+// Synthetic simulation caches and histories for the layout and frame tests and benchmarks, built without the glmCrowdIO library
+#ifndef GLM_TEST_SIMULATION_INCLUDE_H
+#define GLM_TEST_SIMULATION_INCLUDE_H
+
+#include "glm_test.h"
+#include <math.h>
+
+// entity i has type i % entityTypeCount and id 1000 + 3 * i, one float and one vector pp attribute
+inline void glmTestCreateSimulation(GlmSimulationData** simulationData, uint32_t entityCount, uint16_t entityTypeCount, uint16_t boneCount)
+{
+	glmCreateSimulationData(simulationData, entityCount, entityTypeCount, 1, 1);
+	GlmSimulationData* data = *simulationData;
+	data->_version = GSC_VERSION;
+	data->_contentHashKey = 0x5eedu;
+	strcpy(data->_ppFloatAttributeNames[0], "ppFloat");
+	strcpy(data->_ppVectorAttributeNames[0], "ppVector");
+
+	for (uint16_t iType = 0; iType < entityTypeCount; iType++)
+	{
+		data->_entityCountPerEntityType[iType] = 0;
+		data->_boneCount[iType] = (uint16_t)(boneCount + iType);
+		data->_maxBonesHierarchyLength[iType] = 2.f;
+		data->_blindDataCount[iType] = 2;
+		data->_hasGeoBehavior[iType] = (uint8_t)(iType & 1);
+		data->_snsCountPerEntityType[iType] = 1;
+	}
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+	{
+		uint16_t entityType = (uint16_t)(iEntity % entityTypeCount);
+		data->_entityIds[iEntity] = 1000 + 3 * (int64_t)iEntity;
+		data->_entityTypes[iEntity] = entityType;
+		data->_indexInEntityType[iEntity] = data->_entityCountPerEntityType[entityType]++;
+		data->_scales[iEntity] = 1.f;
+		data->_entityRadius[iEntity] = 0.5f;
+		data->_entityHeight[iEntity] = 1.8f;
+	}
+
+	uint32_t boneOffset = 0, blindDataOffset = 0, geoBehaviorOffset = 0, snsOffset = 0;
+	for (uint16_t iType = 0; iType < entityTypeCount; iType++)
+	{
+		data->_iBoneOffsetPerEntityType[iType] = boneOffset;
+		data->_iBlindDataOffsetPerEntityType[iType] = blindDataOffset;
+		data->_iGeoBehaviorOffsetPerEntityType[iType] = geoBehaviorOffset;
+		data->_snsOffsetPerEntityType[iType] = snsOffset;
+		boneOffset += data->_entityCountPerEntityType[iType] * data->_boneCount[iType];
+		blindDataOffset += data->_entityCountPerEntityType[iType] * data->_blindDataCount[iType];
+		geoBehaviorOffset += data->_hasGeoBehavior[iType] ? data->_entityCountPerEntityType[iType] : 0;
+		snsOffset += data->_entityCountPerEntityType[iType] * data->_snsCountPerEntityType[iType];
+	}
+}
+
+inline uint32_t glmTestTotalBoneCount(const GlmSimulationData* simulationData)
+{
+	uint32_t totalBoneCount = 0;
+	for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+		totalBoneCount += simulationData->_entityCountPerEntityType[iType] * simulationData->_boneCount[iType];
+	return totalBoneCount;
+}
+
+// random bones within 50 units, normalized orientations. Every clothEntityStride-th entity gets one cloth mesh of clothVertexCount vertices, no cloth when 0
+inline void glmTestCreateFrame(GlmFrameData** frameData, const GlmSimulationData* simulationData, uint32_t seed, uint32_t clothEntityStride, uint32_t clothVertexCount)
+{
+	uint32_t randomState = seed;
+	glmCreateFrameData(frameData, simulationData);
+	GlmFrameData* data = *frameData;
+	data->_cacheFormat = 0;
+
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData);
+	uint32_t totalBlindDataCount = 0, totalGeoBehaviorCount = 0, totalSnsCount = 0;
+	for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+	{
+		totalBlindDataCount += simulationData->_entityCountPerEntityType[iType] * simulationData->_blindDataCount[iType];
+		totalGeoBehaviorCount += simulationData->_hasGeoBehavior[iType] ? simulationData->_entityCountPerEntityType[iType] : 0;
+		totalSnsCount += simulationData->_entityCountPerEntityType[iType] * simulationData->_snsCountPerEntityType[iType];
+	}
+	for (uint32_t iBone = 0; iBone < totalBoneCount; iBone++)
+	{
+		float norm = 0.f;
+		for (int i = 0; i < 3; i++)
+			data->_bonePositions[iBone][i] = glmTestRandomRange(&randomState, -50.f, 50.f);
+		for (int i = 0; i < 4; i++)
+		{
+			data->_boneOrientations[iBone][i] = glmTestRandomRange(&randomState, -1.f, 1.f);
+			norm += data->_boneOrientations[iBone][i] * data->_boneOrientations[iBone][i];
+		}
+		norm = 1.f / sqrtf(norm + 1e-6f);
+		for (int i = 0; i < 4; i++)
+			data->_boneOrientations[iBone][i] *= norm;
+	}
+	for (uint32_t iSns = 0; iSns < totalSnsCount; iSns++)
+		for (int i = 0; i < 4; i++)
+			data->_snsValues[iSns][i] = 1.f;
+	for (uint32_t iBlindData = 0; iBlindData < totalBlindDataCount; iBlindData++)
+		data->_blindData[iBlindData] = glmTestRandom(&randomState);
+	for (uint32_t iGeoBehavior = 0; iGeoBehavior < totalGeoBehaviorCount; iGeoBehavior++)
+	{
+		data->_geoBehaviorGeometryIds[iGeoBehavior] = (uint16_t)iGeoBehavior;
+		for (int i = 0; i < 3; i++)
+			data->_geoBehaviorAnimFrameInfo[iGeoBehavior][i] = (float)i;
+		data->_geoBehaviorBlendModes[iGeoBehavior] = 0;
+	}
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		data->_ppFloatAttributeData[0][iEntity] = glmTestRandom(&randomState);
+		for (int i = 0; i < 3; i++)
+			data->_ppVectorAttributeData[0][iEntity][i] = glmTestRandom(&randomState);
+	}
+
+	if (clothEntityStride == 0)
+		return;
+	uint32_t clothEntityCount = (simulationData->_entityCount + clothEntityStride - 1) / clothEntityStride;
+	glmCreateClothData(simulationData, data, clothEntityCount, clothEntityCount, clothEntityCount * clothVertexCount);
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+	{
+		uint32_t iClothEntity = iEntity / clothEntityStride;
+		if (iEntity % clothEntityStride)
+		{
+			data->_entityClothIndex[iEntity] = -1;
+			continue;
+		}
+		data->_entityClothIndex[iEntity] = (int32_t)iClothEntity;
+		data->_clothEntityMeshCount[iClothEntity] = 1;
+		data->_clothEntityFirstAssetMeshIndex[iClothEntity] = iClothEntity;
+		data->_clothEntityFirstMeshVertex[iClothEntity] = iClothEntity * clothVertexCount;
+		data->_clothMeshIndicesInCharAssets[iClothEntity] = 0;
+		data->_clothMeshVertexCount[iClothEntity] = clothVertexCount;
+		for (int i = 0; i < 3; i++)
+			data->_clothEntityQuantizationReference[iClothEntity][i] = 0.f;
+		data->_clothEntityQuantizationMaxExtent[iClothEntity] = 50.f;
+		for (uint32_t iVertex = 0; iVertex < clothVertexCount; iVertex++)
+			for (int i = 0; i < 3; i++)
+				data->_clothVertices[iClothEntity * clothVertexCount + iVertex][i] = glmTestRandomRange(&randomState, -50.f, 50.f);
+	}
+}
+
+// history of transformCount no-op transforms over entityCount entity ids and duplicatedEntityCount duplicate ids, every array initialized.
+// Callers set the types, parameters and entity ranges of the transforms they use, and fill the postureCount posture frames / postureBoneCount posture bones
+inline void glmTestCreateHistory(GlmHistory** history, const GlmSimulationData* simulationData, uint32_t transformCount, uint32_t entityCount, uint32_t duplicatedEntityCount, uint32_t postureCount = 0, uint32_t postureBoneCount = 0)
+{
+	uint32_t localBoneCount = 0;
+	for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+		localBoneCount += simulationData->_boneCount[iType];
+	glmCreateHistory(history, transformCount, 0, entityCount, postureCount, postureBoneCount, localBoneCount, 0, duplicatedEntityCount, simulationData->_entityTypeCount, 0, 0, 0, 0, 0, 0);
+	GlmHistory* data = *history;
+	data->_options = 0;
+
+	memset(data->_entityIds, 0, entityCount * sizeof(int64_t));
+	memset(data->_duplicatedEntityIds, 0, duplicatedEntityCount * sizeof(int64_t));
+	memset(data->_meshAssetsOverrideStartIndex, 0, entityCount * sizeof(uint32_t));
+	uint32_t localBoneOffset = 0;
+	for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+	{
+		data->_localBoneOffset[iType] = localBoneOffset;
+		for (uint16_t iBone = 0; iBone < simulationData->_boneCount[iType]; iBone++)
+		{
+			float identity[4] = { 0.f, 0.f, 0.f, 1.f };
+			memcpy(data->_localBoneOrientation[localBoneOffset + iBone], identity, sizeof(identity));
+			memset(data->_localBonePosition[localBoneOffset + iBone], 0, sizeof(float[3]));
+			data->_localBoneParent[localBoneOffset + iBone] = iBone ? iBone - 1u : 0xFFFFFFFFu;
+		}
+		localBoneOffset += simulationData->_boneCount[iType];
+	}
+
+	for (uint32_t iTransform = 0; iTransform < transformCount; iTransform++)
+	{
+		float identity[4] = { 0.f, 0.f, 0.f, 1.f };
+		data->_transformTypes[iTransform] = SimulationCacheNoop;
+		data->_active[iTransform] = 1;
+		data->_boneIndex[iTransform] = 0;
+		data->_renderingTypeIdx[iTransform] = 0;
+		memcpy(data->_transformRotate[iTransform], identity, sizeof(identity));
+		memset(data->_transformTranslate[iTransform], 0, sizeof(float[3]));
+		memset(data->_transformPivot[iTransform], 0, sizeof(float[3]));
+		data->_scale[iTransform] = 1.f;
+		data->_clothIndice[iTransform] = 0;
+		data->_enableCloth[iTransform] = 0;
+		data->_entityArrayStartIndex[iTransform] = 0;
+		data->_entityArrayCount[iTransform] = 0;
+		data->_duplicatedEntityArrayStartIndex[iTransform] = 0;
+		data->_duplicatedEntityArrayCount[iTransform] = 0;
+		data->_expandArrayStartIndex[iTransform] = 0;
+		data->_expandArrayCount[iTransform] = 0;
+		data->_perFramePosOriArrayStartIndex[iTransform] = 0;
+		data->_perFramePosOriArrayCount[iTransform] = 0;
+		data->_scaleRangeArrayStartIndex[iTransform] = 0;
+		data->_scaleRangeArrayCount[iTransform] = 0;
+		data->_posturesFrameCount[iTransform] = 0;
+		data->_posturesFrameStart[iTransform] = 0;
+		data->_frameOffsetArrayStartIndex[iTransform] = 0;
+		data->_frameOffsetArrayCount[iTransform] = 0;
+		data->_frameWarpArrayStartIndex[iTransform] = 0;
+		data->_frameWarpArrayCount[iTransform] = 0;
+		data->_frameOffsetMin[iTransform] = 0.f;
+		data->_frameOffsetMax[iTransform] = 0.f;
+		data->_frameWarpMin[iTransform] = 1.f;
+		data->_frameWarpMax[iTransform] = 1.f;
+		data->_scaleRangeMin[iTransform] = 1.f;
+		data->_scaleRangeMax[iTransform] = 1.f;
+		data->_startFrame[iTransform] = 0;
+		data->_frameCount[iTransform] = 0;
+		data->_snapToStartIndex[iTransform] = 0;
+		data->_snapToCount[iTransform] = 0;
+	}
+}
+
+// bit exact comparison of the bones, scales and cloth of two modified frames of the same layout
+inline int glmTestSameModifiedFrame(const GlmSimulationData* simulationData1, const GlmFrameData* frameData1, const GlmSimulationData* simulationData2, const GlmFrameData* frameData2)
+{
+	uint32_t totalBoneCount = glmTestTotalBoneCount(simulationData1);
+	if (simulationData1->_entityCount != simulationData2->_entityCount || totalBoneCount != glmTestTotalBoneCount(simulationData2))
+		return 0;
+	if (memcmp(simulationData1->_scales, simulationData2->_scales, simulationData1->_entityCount * sizeof(float)) != 0
+		|| memcmp(simulationData1->_maxBonesHierarchyLength, simulationData2->_maxBonesHierarchyLength, simulationData1->_entityTypeCount * sizeof(float)) != 0)
+		return 0;
+	if (memcmp(frameData1->_bonePositions, frameData2->_bonePositions, totalBoneCount * sizeof(float[3])) != 0
+		|| memcmp(frameData1->_boneOrientations, frameData2->_boneOrientations, totalBoneCount * sizeof(float[4])) != 0)
+		return 0;
+	if (frameData1->_clothEntityCount != frameData2->_clothEntityCount || frameData1->_clothTotalVertices != frameData2->_clothTotalVertices)
+		return 0;
+	if (frameData1->_clothEntityCount == 0)
+		return 1;
+	return memcmp(frameData1->_clothVertices, frameData2->_clothVertices, frameData1->_clothTotalVertices * sizeof(float[3])) == 0
+		&& memcmp(frameData1->_clothEntityQuantizationReference, frameData2->_clothEntityQuantizationReference, frameData1->_clothEntityCount * sizeof(float[3])) == 0
+		&& memcmp(frameData1->_entityClothIndex, frameData2->_entityClothIndex, simulationData1->_entityCount * sizeof(int32_t)) == 0;
+}
+
+// bit exact comparison of everything a frame file holds besides bones and cloth
+inline int glmTestSameFrameAttributes(const GlmSimulationData* simulationData, const GlmFrameData* frameData1, const GlmFrameData* frameData2)
+{
+	uint32_t totalBlindDataCount = 0, totalGeoBehaviorCount = 0, totalSnsCount = 0;
+	for (uint16_t iType = 0; iType < simulationData->_entityTypeCount; iType++)
+	{
+		totalBlindDataCount += simulationData->_entityCountPerEntityType[iType] * simulationData->_blindDataCount[iType];
+		totalGeoBehaviorCount += simulationData->_hasGeoBehavior[iType] ? simulationData->_entityCountPerEntityType[iType] : 0;
+		totalSnsCount += simulationData->_entityCountPerEntityType[iType] * simulationData->_snsCountPerEntityType[iType];
+	}
+	return frameData1->_cacheFormat == frameData2->_cacheFormat
+		&& frameData1->_simulationContentHashKey == frameData2->_simulationContentHashKey
+		&& memcmp(frameData1->_snsValues, frameData2->_snsValues, totalSnsCount * sizeof(float[4])) == 0
+		&& memcmp(frameData1->_blindData, frameData2->_blindData, totalBlindDataCount * sizeof(float)) == 0
+		&& memcmp(frameData1->_geoBehaviorGeometryIds, frameData2->_geoBehaviorGeometryIds, totalGeoBehaviorCount * sizeof(uint16_t)) == 0
+		&& memcmp(frameData1->_geoBehaviorAnimFrameInfo, frameData2->_geoBehaviorAnimFrameInfo, totalGeoBehaviorCount * sizeof(float[3])) == 0
+		&& memcmp(frameData1->_ppFloatAttributeData[0], frameData2->_ppFloatAttributeData[0], simulationData->_entityCount * sizeof(float)) == 0
+		&& memcmp(frameData1->_ppVectorAttributeData[0], frameData2->_ppVectorAttributeData[0], simulationData->_entityCount * sizeof(float[3])) == 0;
+}
+
+#endif // GLM_TEST_SIMULATION_INCLUDE_H
@@ -0,0 +1,195 @@
+// glmCreateModifiedSimulationDataView : shared and owned arrays, same scales as glmCreateModifiedSimulationData, rejected layouts,
+// release through glmDestroySimulationDataView and glmDetachSimulationDataView without leaks, and its use by glmUpdateLayoutEvaluator
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static void* glmTestMalloc(size_t size)
+{
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_simulation.h"
+
+static const char* glmTestFramePathModel = "simulation_data_view_missing.%d.gscf";
+
+// same scale fields in both simulation data
+static int glmTestSameScales(const GlmSimulationData* simulationData1, const GlmSimulationData* simulationData2)
+{
+	return simulationData1->_entityCount == simulationData2->_entityCount
+		&& memcmp(simulationData1->_scales, simulationData2->_scales, simulationData1->_entityCount * sizeof(float)) == 0
+		&& memcmp(simulationData1->_entityRadius, simulationData2->_entityRadius, simulationData1->_entityCount * sizeof(float)) == 0
+		&& memcmp(simulationData1->_entityHeight, simulationData2->_entityHeight, simulationData1->_entityCount * sizeof(float)) == 0
+		&& memcmp(simulationData1->_maxBonesHierarchyLength, simulationData2->_maxBonesHierarchyLength, simulationData1->_entityTypeCount * sizeof(float)) == 0;
+}
+
+// translate all, scale 1 in 3 entities, duplicate the first duplicateCount ones when not 0
+static void glmTestCreateLayoutHistory(GlmHistory** history, const GlmSimulationData* simulationData, uint32_t duplicateCount)
+{
+	std::vector<int64_t> entityIds;
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity++)
+		entityIds.push_back(simulationData->_entityIds[iEntity]);
+	for (uint32_t iEntity = 0; iEntity < simulationData->_entityCount; iEntity += 3)
+		entityIds.push_back(simulationData->_entityIds[iEntity]);
+	for (uint32_t iEntity = 0; iEntity < duplicateCount; iEntity++)
+		entityIds.push_back(simulationData->_entityIds[iEntity]);
+
+	glmTestCreateHistory(history, simulationData, 3, (uint32_t)entityIds.size(), duplicateCount);
+	GlmHistory* data = *history;
+	memcpy(data->_entityIds, &entityIds[0], entityIds.size() * sizeof(int64_t));
+	data->_entityArrayStartIndex[0] = 0;
+	data->_entityArrayCount[0] = simulationData->_entityCount;
+	data->_entityArrayStartIndex[1] = simulationData->_entityCount;
+	data->_entityArrayCount[1] = (simulationData->_entityCount + 2) / 3;
+	data->_entityArrayStartIndex[2] = data->_entityArrayStartIndex[1] + data->_entityArrayCount[1];
+	data->_entityArrayCount[2] = duplicateCount;
+	data->_transformTypes[0] = SimulationCacheTranslate;
+	data->_transformTranslate[0][0] = 10.f;
+	data->_transformTypes[1] = SimulationCacheScale;
+	data->_scale[1] = 1.5f;
+	for (uint32_t iDuplicate = 0; iDuplicate < duplicateCount; iDuplicate++)
+		data->_duplicatedEntityIds[iDuplicate] = 1000000000 + (int64_t)iDuplicate;
+	data->_transformTypes[2] = SimulationCacheDuplicate;
+	data->_duplicatedEntityArrayCount[2] = duplicateCount;
+}
+
+// evaluator result against a full evaluation of the same history
+static void glmTestCheckEvaluator(const GlmLayoutEvaluator* evaluator, GlmSimulationData* simulationData, GlmFrameData* frameData, GlmHistory* history)
+{
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	GlmSimulationData* simulationDataOut;
+	GlmFrameData* frameDataOut;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
+	GLM_TEST_CHECK(glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(glmTestSameModifiedFrame(simulationDataOut, frameDataOut, evaluator->_simulationDataOut, evaluator->_frameDataOut));
+	GLM_TEST_CHECK(glmTestSameScales(simulationDataOut, evaluator->_simulationDataOut));
+	glmDestroyFrameData(&frameDataOut, simulationDataOut);
+	glmDestroySimulationData(&simulationDataOut);
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+}
+
+int main()
+{
+	GlmSimulationData* simulationData = NULL;
+	GlmFrameData* frameData = NULL;
+	glmTestCreateSimulation(&simulationData, 200, 3, 6);
+	glmTestCreateFrame(&frameData, simulationData, 0x5678u, 0, 0);
+	std::vector<float> sourceScales(simulationData->_scales, simulationData->_scales + simulationData->_entityCount);
+	std::vector<float> sourceMaxLengths(simulationData->_maxBonesHierarchyLength, simulationData->_maxBonesHierarchyLength + simulationData->_entityTypeCount);
+	int baseAllocationCount = glmTestLiveAllocationCount;
+
+	GlmHistory* history = NULL;
+	glmTestCreateLayoutHistory(&history, simulationData, 0);
+	GlmEntityTransform* entityTransforms;
+	int entityTransformCount;
+	glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
+	GLM_TEST_CHECK(entityTransformCount == (int)simulationData->_entityCount);
+	int transformsAllocationCount = glmTestLiveAllocationCount;
+
+	// entity arrays shared, scale fields owned and equal to the full copy ones
+	{
+		GlmSimulationData* view = NULL;
+		GlmSimulationData* copy = NULL;
+		GLM_TEST_CHECK(glmCreateModifiedSimulationDataView(simulationData, entityTransforms, entityTransformCount, &view) == 1);
+		glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &copy);
+		GLM_TEST_CHECK(view != NULL);
+		GLM_TEST_CHECK(view->_entityIds == simulationData->_entityIds && view->_entityTypes == simulationData->_entityTypes);
+		GLM_TEST_CHECK(view->_iBoneOffsetPerEntityType == simulationData->_iBoneOffsetPerEntityType && view->_ppFloatAttributeNames == simulationData->_ppFloatAttributeNames);
+		GLM_TEST_CHECK(view->_scales != simulationData->_scales && view->_entityRadius != simulationData->_entityRadius);
+		GLM_TEST_CHECK(view->_entityHeight != simulationData->_entityHeight && view->_maxBonesHierarchyLength != simulationData->_maxBonesHierarchyLength);
+		GLM_TEST_CHECK(glmTestSameScales(view, copy));
+		GLM_TEST_CHECK(view->_scales[0] == simulationData->_scales[0] * 1.5f && view->_scales[1] == simulationData->_scales[1]);
+		GLM_TEST_CHECK(memcmp(&sourceScales[0], simulationData->_scales, sourceScales.size() * sizeof(float)) == 0);
+		glmDestroySimulationData(&copy);
+		glmDestroySimulationDataView(&view, simulationData);
+		GLM_TEST_CHECK(view == NULL);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == transformsAllocationCount);
+	}
+
+	// detached view owns the source arrays
+	{
+		GlmSimulationData* source = NULL;
+		GlmSimulationData* view = NULL;
+		glmTestCreateSimulation(&source, 200, 3, 6);
+		GLM_TEST_CHECK(glmCreateModifiedSimulationDataView(source, entityTransforms, entityTransformCount, &view) == 1);
+		int64_t* entityIds = view->_entityIds;
+		glmDetachSimulationDataView(view, &source);
+		GLM_TEST_CHECK(source == NULL);
+		GLM_TEST_CHECK(view->_entityIds == entityIds && view->_entityIds[199] == simulationData->_entityIds[199]);
+		GLM_TEST_CHECK(view->_scales[0] == simulationData->_scales[0] * 1.5f);
+		glmDestroySimulationData(&view);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == transformsAllocationCount);
+	}
+
+	// a changed entity set is not a view
+	{
+		GlmSimulationData* view = (GlmSimulationData*)&entityTransformCount;
+		GLM_TEST_CHECK(glmCreateModifiedSimulationDataView(simulationData, entityTransforms, entityTransformCount - 1, &view) == 0);
+		GLM_TEST_CHECK(view == NULL);
+		entityTransforms[3]._sourceIndexInCrowdField = 4;
+		GLM_TEST_CHECK(glmCreateModifiedSimulationDataView(simulationData, entityTransforms, entityTransformCount, &view) == 0);
+		GLM_TEST_CHECK(view == NULL);
+		entityTransforms[3]._sourceIndexInCrowdField = 3;
+		entityTransforms[3]._entityId = -1;
+		GLM_TEST_CHECK(glmCreateModifiedSimulationDataView(simulationData, entityTransforms, entityTransformCount, &view) == 0);
+		GLM_TEST_CHECK(view == NULL);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == transformsAllocationCount);
+	}
+	glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
+
+	// layout evaluator : a view while the layout keeps the entity set, scale edits stay out of the source
+	GlmLayoutEvaluator* evaluator = NULL;
+	glmCreateLayoutEvaluator(&evaluator, simulationData);
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_simulationDataOutIsView == 1);
+	GLM_TEST_CHECK(evaluator->_simulationDataOut->_entityIds == simulationData->_entityIds);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history);
+
+	history->_scale[1] = 0.5f;
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_updatedTransformCount > 0 && evaluator->_simulationDataOutIsView == 1);
+	GLM_TEST_CHECK(evaluator->_simulationDataOut->_scales[0] == simulationData->_scales[0] * 0.5f);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history);
+	GLM_TEST_CHECK(memcmp(&sourceScales[0], simulationData->_scales, sourceScales.size() * sizeof(float)) == 0);
+	GLM_TEST_CHECK(memcmp(&sourceMaxLengths[0], simulationData->_maxBonesHierarchyLength, sourceMaxLengths.size() * sizeof(float)) == 0);
+	glmDestroyHistory(&history);
+
+	// duplicates change the entity set : full copy
+	glmTestCreateLayoutHistory(&history, simulationData, 10);
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_simulationDataOutIsView == 0);
+	GLM_TEST_CHECK(evaluator->_simulationDataOut->_entityCount == simulationData->_entityCount + 10);
+	GLM_TEST_CHECK(evaluator->_simulationDataOut->_entityIds != simulationData->_entityIds);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history);
+	glmDestroyHistory(&history);
+
+	// and back to a view
+	glmTestCreateLayoutHistory(&history, simulationData, 0);
+	GLM_TEST_CHECK(glmUpdateLayoutEvaluator(evaluator, frameData, history, 1, glmTestFramePathModel, ".") == GSC_SUCCESS);
+	GLM_TEST_CHECK(evaluator->_simulationDataOutIsView == 1);
+	glmTestCheckEvaluator(evaluator, simulationData, frameData, history);
+	glmDestroyHistory(&history);
+
+	glmDestroyLayoutEvaluator(&evaluator);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == baseAllocationCount);
+	GLM_TEST_CHECK(memcmp(&sourceScales[0], simulationData->_scales, sourceScales.size() * sizeof(float)) == 0);
+
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	return glmTestResult();
+}
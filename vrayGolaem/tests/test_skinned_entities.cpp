@@ -0,0 +1,204 @@
+// glmCreateSkinnedEntities on the calling thread, with every block run separately in reverse order and on glmParallelForThreads : skinned
+// vertices bit exact to glmSkinMesh, rigid meshes instanced once per hash key and name with a unique instance index per entity, allocation
+// failures leaving the failed entities empty and the instance groups untouched
+#include <stdlib.h>
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	void* ptr = malloc(size);
+	if (ptr)
+		glmTestLiveAllocationCount++;
+	return ptr;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr)
+		glmTestLiveAllocationCount--;
+	free(ptr);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_geometry.h"
+#include "test_simulation.h"
+#include <algorithm>
+
+enum { ENTITY_COUNT = 200, BONE_COUNT = 20, VERTEX_COUNT = 512 };
+
+static std::vector<unsigned int> glmTestCallCounts; // item counts of the glmTestParallelForReversed calls
+
+// one item at a time, last one first
+static void glmTestParallelForReversed(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count)
+{
+	glmTestCallCounts.push_back(count);
+	for (unsigned int iItem = count; iItem > 0; iItem--)
+		task(userData, iItem - 1, iItem);
+}
+
+// entity i uses character i % 2 : 2 rigid meshes for character 0, 1 for character 1, both named "rigid1" but of different hash keys
+static void glmTestSetEntities(std::vector<GlmSkinnedEntity>& entities, GlmTestCharacter* characters)
+{
+	entities.resize(ENTITY_COUNT);
+	memset(&entities[0], 0, ENTITY_COUNT * sizeof(GlmSkinnedEntity));
+	for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+	{
+		entities[iEntity]._geometry = &characters[iEntity % 2]._skinnedGeometry;
+		entities[iEntity]._hashKey = 100 + iEntity % 2;
+		entities[iEntity]._entityIndex = iEntity;
+	}
+}
+
+// every group holds the instances of one rigid mesh of one character, numbered 0 to _instanceCount - 1 over the created entities
+static void glmTestCheckGroups(const std::vector<GlmSkinnedEntity>& entities, const GlmMeshInstanceGroupPerCrowdField& meshInstances, uint32_t expectedGroupCount)
+{
+	GLM_TEST_CHECK(meshInstances._meshInstanceGroupCount == expectedGroupCount);
+	std::vector<std::vector<uint32_t> > instanceIndices(meshInstances._meshInstanceGroupCount);
+	for (size_t iEntity = 0; iEntity < entities.size(); iEntity++)
+	{
+		const GlmSkinnedEntity& entity = entities[iEntity];
+		if (entity._status != GIO_SUCCESS)
+			continue;
+		for (uint16_t iMesh = 0; iMesh < entity._geometry->_meshCount; iMesh++)
+		{
+			int32_t instanceGroup = entity._meshes[iMesh]._instanceGroup;
+			if (instanceGroup < 0)
+				continue;
+			GLM_TEST_CHECK(instanceGroup < (int32_t)meshInstances._meshInstanceGroupCount);
+			if (instanceGroup >= (int32_t)meshInstances._meshInstanceGroupCount)
+				continue;
+			const GlmMeshInstanceGroup& group = meshInstances._meshInstanceGroups[instanceGroup];
+			GLM_TEST_CHECK(group._hashKey == (int32_t)entity._hashKey && group._definitionComplete == 1);
+			instanceIndices[instanceGroup].push_back(entity._meshes[iMesh]._instanceIndex);
+		}
+	}
+	for (uint32_t iGroup = 0; iGroup < meshInstances._meshInstanceGroupCount; iGroup++)
+	{
+		std::vector<uint32_t>& indices = instanceIndices[iGroup];
+		std::sort(indices.begin(), indices.end());
+		GLM_TEST_CHECK(indices.size() == meshInstances._meshInstanceGroups[iGroup]._instanceCount);
+		for (size_t iIndex = 0; iIndex < indices.size(); iIndex++)
+			GLM_TEST_CHECK(indices[iIndex] == iIndex);
+	}
+}
+
+// skinned meshes against glmSkinMesh, rigid meshes instanced with the palette matrix of their bone
+static void glmTestCheckEntity(const GlmSkinnedEntity& entity, const GlmFrameDataSoA* frameDataSoA)
+{
+	const GlmSkinnedGeometry* geometry = entity._geometry;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	GLM_TEST_CHECK(glmComputeSkinningPaletteSoA(&palette, &geometry->_geometry, frameDataSoA, entity._entityIndex) == GIO_SUCCESS);
+	GLM_TEST_CHECK(entity._vertexCount == VERTEX_COUNT && entity._instanceMatrixCount == geometry->_meshCount - 1);
+	std::vector<float> positions(VERTEX_COUNT * 3), normals(VERTEX_COUNT * 3);
+	GLM_TEST_CHECK(glmSkinMesh(&geometry->_meshes[0], &palette, (float(*)[3])&positions[0], (float(*)[3])&normals[0]) == GIO_SUCCESS);
+	GLM_TEST_CHECK(entity._meshes[0]._instanceGroup == -1 && entity._meshes[0]._instanceFirstMatrixIndex == -1 && entity._meshes[0]._firstVertex == 0);
+	GLM_TEST_CHECK(memcmp(&positions[0], entity._positions, VERTEX_COUNT * sizeof(float[3])) == 0);
+	GLM_TEST_CHECK(memcmp(&normals[0], entity._normals, VERTEX_COUNT * sizeof(float[3])) == 0);
+	for (uint16_t iMesh = 1; iMesh < geometry->_meshCount; iMesh++)
+	{
+		const GlmSkinnedEntityMesh& mesh = entity._meshes[iMesh];
+		GLM_TEST_CHECK(mesh._instanceGroup >= 0 && mesh._instanceFirstMatrixIndex == iMesh - 1);
+		GLM_TEST_CHECK(memcmp(entity._instanceMatrices[iMesh - 1], palette._matrices[iMesh % BONE_COUNT], sizeof(GlmMeshInstanceMatrix)) == 0);
+	}
+	glmDestroySkinningPalette(&palette);
+}
+
+int main()
+{
+	GlmSimulationData* simulationData = NULL;
+	GlmFrameData* frameData = NULL;
+	GlmFrameDataSoA* frameDataSoA = NULL;
+	glmTestCreateSimulation(&simulationData, ENTITY_COUNT, 2, BONE_COUNT);
+	glmTestCreateFrame(&frameData, simulationData, 7, 0, 0);
+	glmCreateFrameDataSoA(&frameDataSoA, simulationData);
+	glmConvertFrameDataToSoA(frameData, frameDataSoA);
+	GlmTestCharacter characters[2];
+	glmTestCreateCharacter(characters[0], BONE_COUNT, VERTEX_COUNT, GLM_SKIN_LINEAR, 2, 0x100u);
+	glmTestCreateCharacter(characters[1], BONE_COUNT + 1, VERTEX_COUNT, GLM_SKIN_DUALQ, 1, 0x200u);
+	int allocationCount = glmTestLiveAllocationCount;
+
+	std::vector<GlmSkinnedEntity> entities;
+	GlmMeshInstanceGroupPerCrowdField meshInstances;
+	void(*parallelFors[3])(void(*task)(void* userData, unsigned int first, unsigned int last), void* userData, unsigned int count) = { NULL, glmTestParallelForReversed, glmParallelForThreads };
+	for (int iParallelFor = 0; iParallelFor < 3; iParallelFor++)
+	{
+		glmParallelFor = parallelFors[iParallelFor];
+		glmTestSetEntities(entities, characters);
+		glmInitMeshInstanceGroups(meshInstances);
+		{
+			GlmMeshInstanceGroupRegistry registry(meshInstances);
+			GLM_TEST_CHECK(meshInstances._meshInstanceGroupSet == &registry);
+			GLM_TEST_CHECK(glmCreateSkinnedEntities(&entities[0], ENTITY_COUNT, frameDataSoA, registry) == GIO_SUCCESS);
+		}
+		GLM_TEST_CHECK(meshInstances._meshInstanceGroupSet == NULL);
+		for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+			glmTestCheckEntity(entities[iEntity], frameDataSoA);
+		glmTestCheckGroups(entities, meshInstances, 3);
+		for (uint32_t iGroup = 0; iGroup < 3; iGroup++)
+			GLM_TEST_CHECK(meshInstances._meshInstanceGroups[iGroup]._instanceCount == ENTITY_COUNT / 2);
+		for (uint32_t iEntity = 0; iEntity < ENTITY_COUNT; iEntity++)
+			glmDestroySkinnedEntity(&entities[iEntity]);
+		glmReleaseMeshInstanceGroups(meshInstances);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount);
+	}
+	// one call over the blocks of GIO_ENTITIES_PER_TASK entities
+	GLM_TEST_CHECK(glmTestCallCounts.size() == 1 && glmTestCallCounts[0] == (ENTITY_COUNT + GIO_ENTITIES_PER_TASK - 1) / GIO_ENTITIES_PER_TASK);
+	glmStopParallelForThreads();
+	glmParallelFor = NULL;
+
+	// allocations failing from the nth one on, over the first 20 entities : failed entities are empty, created ones fill the groups
+	int failureCount = 0;
+	for (int allocationsBeforeFailure = 0; ; allocationsBeforeFailure++)
+	{
+		glmTestSetEntities(entities, characters);
+		entities.resize(20);
+		glmInitMeshInstanceGroups(meshInstances);
+		GlmGeometryGenerationStatus status;
+		{
+			GlmMeshInstanceGroupRegistry registry(meshInstances);
+			glmTestAllocationsBeforeFailure = allocationsBeforeFailure;
+			status = glmCreateSkinnedEntities(&entities[0], (uint32_t)entities.size(), frameDataSoA, registry);
+			glmTestAllocationsBeforeFailure = -1;
+		}
+		uint32_t createdCount = 0;
+		for (size_t iEntity = 0; iEntity < entities.size(); iEntity++)
+		{
+			const GlmSkinnedEntity& entity = entities[iEntity];
+			GLM_TEST_CHECK(entity._status == GIO_SUCCESS || entity._status == GIO_OUT_OF_MEMORY);
+			if (entity._status == GIO_SUCCESS)
+				createdCount++;
+			else
+				GLM_TEST_CHECK(entity._meshes == NULL && entity._positions == NULL && entity._normals == NULL && entity._instanceMatrices == NULL);
+		}
+		if (createdCount)
+			glmTestCheckGroups(entities, meshInstances, meshInstances._meshInstanceGroupCount);
+		for (size_t iEntity = 0; iEntity < entities.size(); iEntity++)
+			glmDestroySkinnedEntity(&entities[iEntity]);
+		glmReleaseMeshInstanceGroups(meshInstances);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == allocationCount);
+		if (status == GIO_SUCCESS)
+		{
+			GLM_TEST_CHECK(createdCount == entities.size());
+			break;
+		}
+		GLM_TEST_CHECK(status == GIO_OUT_OF_MEMORY);
+		failureCount++;
+	}
+	// per entity the palette (bone counts alternate between the characters) and 4 arrays, the instance matrix and the group chunks once
+	GLM_TEST_CHECK(failureCount == 20 * (2 + 4) + 1 + 1);
+
+	glmTestDestroyCharacter(characters[1]);
+	glmTestDestroyCharacter(characters[0]);
+	glmDestroyFrameDataSoA(&frameDataSoA);
+	glmDestroyFrameData(&frameData, simulationData);
+	glmDestroySimulationData(&simulationData);
+	return glmTestResult();
+}
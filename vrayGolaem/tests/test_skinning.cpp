@@ -0,0 +1,332 @@
+// Skinning of GlmGeometryFile meshes : bind pose round trip for every skinning type, SSE / parallel paths against the scalar
+// reference, batched dual quaternion and blend lanes, rigid skinning against the glm_crowd.h quaternion helpers, vertices without
+// influence, input validation and allocation failures
+#include <stdlib.h>
+static int glmTestAllocationsBeforeFailure = -1; // < 0 : never fail
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+		return NULL;
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	return malloc(size);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) free(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_geometry.h"
+
+static float computeMaxDifference(const std::vector<float>& a, const std::vector<float>& b)
+{
+	float maxDifference = 0.f;
+	for (size_t i = 0; i < a.size(); i++)
+		maxDifference = fmaxf(maxDifference, fabsf(a[i] - b[i]));
+	return maxDifference;
+}
+
+// bones placed at the inverse of their bind pose offset : every skinning type gives back the bind pose
+static void testBindPose(uint8_t skinningType)
+{
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, 1000, 12, skinningType, 4, 0x51u + skinningType);
+	std::vector<float> bonePositions(12 * 3), boneOrientations(12 * 4);
+	for (int iBone = 0; iBone < 12; iBone++)
+	{
+		const float* offsetOrientation = &data._boneOffsetOrientations[iBone * 4];
+		float* orientation = &boneOrientations[iBone * 4];
+		float* position = &bonePositions[iBone * 3];
+		orientation[0] = -offsetOrientation[0]; orientation[1] = -offsetOrientation[1]; orientation[2] = -offsetOrientation[2]; orientation[3] = offsetOrientation[3];
+		glmMultVec3Quaternion(orientation, &data._boneOffsetPositions[iBone * 3], position);
+		position[0] = -position[0]; position[1] = -position[1]; position[2] = -position[2];
+	}
+
+	GlmSkinnedMesh mesh;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, data._geometry._boneCount) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+
+	std::vector<float> positions(1000 * 3), normals(1000 * 3), referencePositions(1000 * 3), referenceNormals(1000 * 3);
+	GLM_TEST_CHECK(glmSkinMesh(&mesh, &palette, (float(*)[3])&positions[0], (float(*)[3])&normals[0]) == GIO_SUCCESS);
+	glmSkinVerticesReference(&mesh, &palette, 0, 1000, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+	float maxError = 0.f;
+	for (uint32_t iVertex = 0; iVertex < 1000; iVertex++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			maxError = fmaxf(maxError, fabsf(positions[iVertex * 3 + i] - data._vertices[iVertex]._position[i]));
+			maxError = fmaxf(maxError, fabsf(normals[iVertex * 3 + i] - data._vertices[iVertex]._normal[i]));
+			maxError = fmaxf(maxError, fabsf(referencePositions[iVertex * 3 + i] - data._vertices[iVertex]._position[i]));
+		}
+	}
+	GLM_TEST_CHECK(maxError < 5e-4f); // dual quaternions rebuild the translation from t * q, a few ulps of the 2 units offsets
+
+	glmDestroySkinningPalette(&palette);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+// random pose : SSE path and parallel blocks match the scalar reference, rigid vertices follow their bone
+static void testRandomPose(uint8_t skinningType)
+{
+	uint32_t vertexCount = 3 * GIO_SKINNING_VERTICES_PER_TASK + 123; // several blocks, last one partial
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, vertexCount, 40, skinningType, 4, 0x77u + skinningType);
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(40, 0x99u, bonePositions, boneOrientations);
+
+	GlmSkinnedMesh mesh;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, data._geometry._boneCount) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+
+	std::vector<float> referencePositions(vertexCount * 3), referenceNormals(vertexCount * 3);
+	std::vector<float> positions(vertexCount * 3), normals(vertexCount * 3);
+	std::vector<float> parallelPositions(vertexCount * 3), parallelNormals(vertexCount * 3);
+	glmSkinVerticesReference(&mesh, &palette, 0, vertexCount, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+	glmSkinVertices(&mesh, &palette, 0, vertexCount, (float(*)[3])&positions[0], (float(*)[3])&normals[0]);
+	glmParallelFor = glmParallelForThreads;
+	GLM_TEST_CHECK(glmSkinMesh(&mesh, &palette, (float(*)[3])&parallelPositions[0], (float(*)[3])&parallelNormals[0]) == GIO_SUCCESS);
+	glmParallelFor = NULL;
+
+	GLM_TEST_CHECK(computeMaxDifference(positions, referencePositions) < 1e-4f);
+	GLM_TEST_CHECK(computeMaxDifference(normals, referenceNormals) < 1e-5f);
+	GLM_TEST_CHECK(memcmp(&positions[0], &parallelPositions[0], positions.size() * sizeof(float)) == 0);
+	GLM_TEST_CHECK(memcmp(&normals[0], &parallelNormals[0], normals.size() * sizeof(float)) == 0);
+
+	if (skinningType == GLM_SKIN_RIGID)
+	{
+		// v' = qWorld * (qOffset * v + tOffset) + tWorld
+		uint16_t iBone = data._mesh._rigidSkinningBoneId;
+		float maxError = 0.f;
+		for (uint32_t iVertex = 0; iVertex < vertexCount; iVertex++)
+		{
+			float bindSpace[3], world[3];
+			glmMultVec3Quaternion(&data._boneOffsetOrientations[iBone * 4], data._vertices[iVertex]._position, bindSpace);
+			for (int i = 0; i < 3; i++)
+				bindSpace[i] += data._boneOffsetPositions[iBone * 3 + i];
+			glmMultVec3Quaternion(&boneOrientations[iBone * 4], bindSpace, world);
+			for (int i = 0; i < 3; i++)
+				maxError = fmaxf(maxError, fabsf(world[i] + bonePositions[iBone * 3 + i] - positions[iVertex * 3 + i]));
+		}
+		GLM_TEST_CHECK(maxError < 1e-4f);
+	}
+
+	glmDestroySkinningPalette(&palette);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+// vertices without influence keep their bind pose in every path, first and last vertices included
+static void testZeroInfluences(uint8_t skinningType)
+{
+	const uint32_t vertexCount = 500;
+	const uint32_t unweightedVertices[4] = { 0, 1, 250, vertexCount - 1 };
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, vertexCount, 10, skinningType, 4, 0x31u + skinningType);
+	for (int iUnweighted = 0; iUnweighted < 4; iUnweighted++)
+		data._vertices[unweightedVertices[iUnweighted]]._skinVertexInfluenceCount = 0;
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(10, 0x13u, bonePositions, boneOrientations);
+
+	GlmSkinnedMesh mesh;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, data._geometry._boneCount) == GIO_SUCCESS);
+	GLM_TEST_CHECK(mesh._influenceOffsets[vertexCount - 1] == mesh._influenceOffsets[vertexCount]);
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+
+	std::vector<float> referencePositions(vertexCount * 3), referenceNormals(vertexCount * 3);
+	std::vector<float> positions(vertexCount * 3), normals(vertexCount * 3);
+	glmSkinVerticesReference(&mesh, &palette, 0, vertexCount, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+	glmSkinVertices(&mesh, &palette, 0, vertexCount, (float(*)[3])&positions[0], (float(*)[3])&normals[0]);
+	GLM_TEST_CHECK(computeMaxDifference(positions, referencePositions) < 1e-4f);
+	GLM_TEST_CHECK(computeMaxDifference(normals, referenceNormals) < 1e-5f);
+	for (int iUnweighted = 0; iUnweighted < 4; iUnweighted++)
+	{
+		uint32_t iVertex = unweightedVertices[iUnweighted];
+		float dqPosition[3], dqNormal[3];
+		glmSkinDualQuaternionVertex(&mesh, &palette, iVertex, dqPosition, dqNormal);
+		GLM_TEST_CHECK(memcmp(dqPosition, data._vertices[iVertex]._position, sizeof(dqPosition)) == 0);
+		GLM_TEST_CHECK(memcmp(dqNormal, data._vertices[iVertex]._normal, sizeof(dqNormal)) == 0);
+		for (int i = 0; i < 3; i++)
+		{
+			GLM_TEST_CHECK(positions[iVertex * 3 + i] == data._vertices[iVertex]._position[i]);
+			GLM_TEST_CHECK(referencePositions[iVertex * 3 + i] == data._vertices[iVertex]._position[i]);
+			GLM_TEST_CHECK(fabsf(normals[iVertex * 3 + i] - data._vertices[iVertex]._normal[i]) < 1e-5f);
+		}
+	}
+
+	glmDestroySkinningPalette(&palette);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+// dual quaternion and blended vertices, several influence counts per batch of 4 lanes : glmSkinVertices against the scalar reference
+// with unweighted lanes, blend weights of exactly 0 and 1, real parts of opposite hemispheres and every batch alignment / partial last batch
+static void testBatchedLanes(uint8_t skinningType)
+{
+	const uint32_t vertexCount = 257;
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, vertexCount, 16, skinningType, 8, 0x41u + skinningType);
+	for (uint32_t iVertex = 4; iVertex < 8; iVertex++)
+		data._vertices[iVertex]._skinVertexInfluenceCount = 0; // a whole unweighted batch
+	data._vertices[9]._skinVertexInfluenceCount = 0;
+	data._vertices[130]._skinVertexInfluenceCount = 0;
+	for (uint32_t iVertex = 0; iVertex < vertexCount; iVertex += 5)
+		data._vertices[iVertex]._skinInfluenceBlendWeight = 0.f;
+	for (uint32_t iVertex = 0; iVertex < vertexCount; iVertex += 7)
+		data._vertices[iVertex]._skinInfluenceBlendWeight = 1.f;
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(16, 0x27u, bonePositions, boneOrientations);
+
+	GlmSkinnedMesh mesh;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, data._geometry._boneCount) == GIO_SUCCESS);
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+
+	std::vector<float> referencePositions(vertexCount * 3), referenceNormals(vertexCount * 3);
+	std::vector<float> positions(vertexCount * 3), normals(vertexCount * 3);
+	glmSkinVerticesReference(&mesh, &palette, 0, vertexCount, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+
+	// -dq is the same transform : the odd bones in the other hemisphere give the same vertices
+	for (uint16_t iBone = 1; iBone < 16; iBone += 2)
+	{
+		for (int i = 0; i < 8; i++)
+			palette._dualQuaternions[iBone][i] = -palette._dualQuaternions[iBone][i];
+	}
+	glmSkinVertices(&mesh, &palette, 0, vertexCount, (float(*)[3])&positions[0], (float(*)[3])&normals[0]);
+	GLM_TEST_CHECK(computeMaxDifference(positions, referencePositions) < 1e-4f);
+	GLM_TEST_CHECK(computeMaxDifference(normals, referenceNormals) < 1e-5f);
+	glmSkinVerticesReference(&mesh, &palette, 0, vertexCount, (float(*)[3])&referencePositions[0], (float(*)[3])&referenceNormals[0]);
+	GLM_TEST_CHECK(computeMaxDifference(positions, referencePositions) < 1e-4f);
+	GLM_TEST_CHECK(computeMaxDifference(normals, referenceNormals) < 1e-5f);
+	for (uint32_t iVertex = 4; iVertex < 8; iVertex++)
+	{
+		for (int i = 0; i < 3; i++)
+			GLM_TEST_CHECK(positions[iVertex * 3 + i] == data._vertices[iVertex]._position[i]);
+	}
+
+	// a lane only depends on its vertex : same bits whatever the range start and the partial batch
+	const uint32_t rangeCounts[5] = { 1, 2, 3, 5, 0 };
+	for (uint32_t firstVertex = 0; firstVertex < 4; firstVertex++)
+	{
+		for (int iRange = 0; iRange < 5; iRange++)
+		{
+			uint32_t rangeCount = rangeCounts[iRange] ? rangeCounts[iRange] : vertexCount - firstVertex;
+			std::vector<float> rangePositions(rangeCount * 3), rangeNormals(rangeCount * 3);
+			glmSkinVertices(&mesh, &palette, firstVertex, rangeCount, (float(*)[3])&rangePositions[0], (float(*)[3])&rangeNormals[0]);
+			GLM_TEST_CHECK(memcmp(&rangePositions[0], &positions[firstVertex * 3], rangeCount * 3 * sizeof(float)) == 0);
+			GLM_TEST_CHECK(memcmp(&rangeNormals[0], &normals[firstVertex * 3], rangeCount * 3 * sizeof(float)) == 0);
+		}
+	}
+
+	glmDestroySkinningPalette(&palette);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+static void testValidation()
+{
+	GlmTestSkinnedGeometry data;
+	GlmSkinnedMesh mesh;
+	GlmSkinningPalette palette;
+	memset(&palette, 0, sizeof(GlmSkinningPalette));
+	glmTestCreateSkinnedGeometry(data, 100, 8, GLM_SKIN_LINEAR, 4, 0x5u);
+
+	// influences must reference bones of the geometry file
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_SUCCESS);
+	glmDestroySkinnedMesh(&mesh);
+	data._influenceBoneIds[17] = 8;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_GCG_FILE_BAD_FORMAT);
+	GLM_TEST_CHECK(mesh._positions == NULL);
+	data._influenceBoneIds[17] = 0;
+	data._mesh._skinningType = GLM_SKIN_RIGID;
+	data._mesh._rigidSkinningBoneId = 8;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_GCG_FILE_BAD_FORMAT);
+	data._mesh._rigidSkinningBoneId = 0;
+
+	// unknown skinning type, missing arrays
+	data._mesh._skinningType = GLM_SKIN_BLEND + 1;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_GCG_FILE_BAD_FORMAT);
+	data._mesh._skinningType = GLM_SKIN_LINEAR;
+	data._vertices[3]._skinInfluenceWeights = NULL;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_GCG_FILE_BAD_FORMAT);
+	data._vertices[3]._skinInfluenceWeights = &data._influenceWeights[0];
+	data._mesh._vertices = NULL;
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_GCG_FILE_BAD_FORMAT);
+	data._mesh._vertices = &data._vertices[0];
+
+	// bind pose arrays are required
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(8, 0x3u, bonePositions, boneOrientations);
+	float(*offsetPositions)[3] = data._geometry._boneOffsetPositions;
+	data._geometry._boneOffsetPositions = NULL;
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_GCG_FILE_BAD_FORMAT);
+	data._geometry._boneOffsetPositions = offsetPositions;
+
+	// a palette of a smaller skeleton cannot skin the mesh
+	GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_SUCCESS);
+	data._geometry._boneCount = 4;
+	GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_SUCCESS);
+	std::vector<float> positions(100 * 3);
+	GLM_TEST_CHECK(glmSkinMesh(&mesh, &palette, (float(*)[3])&positions[0], NULL) == GIO_INVALID_BONE_COUNT);
+	data._geometry._boneCount = 8;
+
+	// SoA entity bones must be inside the frame
+	uint32_t entityBoneOffsets[2] = { 0, 6 };
+	GlmFrameDataSoA frameDataSoA;
+	memset(&frameDataSoA, 0, sizeof(GlmFrameDataSoA));
+	frameDataSoA._entityCount = 2;
+	frameDataSoA._boneValueCount = 13;
+	frameDataSoA._entityBoneOffsets = entityBoneOffsets;
+	GLM_TEST_CHECK(glmComputeSkinningPaletteSoA(&palette, &data._geometry, &frameDataSoA, 1) == GIO_INVALID_BONE_COUNT);
+	GLM_TEST_CHECK(glmComputeSkinningPaletteSoA(&palette, &data._geometry, &frameDataSoA, 2) == GIO_INVALID_BONE_COUNT);
+
+	glmDestroySkinningPalette(&palette);
+	glmDestroySkinnedMesh(&mesh);
+}
+
+// every allocation failure is reported as GIO_OUT_OF_MEMORY and leaves the outputs empty
+static void testAllocationFailures()
+{
+	GlmTestSkinnedGeometry data;
+	glmTestCreateSkinnedGeometry(data, 100, 8, GLM_SKIN_BLEND, 4, 0x6u);
+	std::vector<float> bonePositions, boneOrientations;
+	glmTestCreateRandomPose(8, 0x4u, bonePositions, boneOrientations);
+	for (int iFailure = 0; iFailure < 6; iFailure++)
+	{
+		GlmSkinnedMesh mesh;
+		glmTestAllocationsBeforeFailure = iFailure;
+		GLM_TEST_CHECK(glmCreateSkinnedMesh(&mesh, &data._mesh, 8) == GIO_OUT_OF_MEMORY);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(mesh._positions == NULL && mesh._influenceOffsets == NULL && mesh._vertexCount == 0);
+	}
+	for (int iFailure = 0; iFailure < 2; iFailure++)
+	{
+		GlmSkinningPalette palette;
+		memset(&palette, 0, sizeof(GlmSkinningPalette));
+		glmTestAllocationsBeforeFailure = iFailure;
+		GLM_TEST_CHECK(glmComputeSkinningPalette(&palette, &data._geometry, (const float(*)[3])&bonePositions[0], (const float(*)[4])&boneOrientations[0]) == GIO_OUT_OF_MEMORY);
+		glmTestAllocationsBeforeFailure = -1;
+		GLM_TEST_CHECK(palette._matrices == NULL && palette._dualQuaternions == NULL);
+	}
+}
+
+int main()
+{
+	for (uint8_t skinningType = GLM_SKIN_RIGID; skinningType <= GLM_SKIN_BLEND; skinningType++)
+	{
+		testBindPose(skinningType);
+		testRandomPose(skinningType);
+	}
+	testZeroInfluences(GLM_SKIN_LINEAR);
+	testZeroInfluences(GLM_SKIN_DUALQ);
+	testZeroInfluences(GLM_SKIN_BLEND);
+	testBatchedLanes(GLM_SKIN_DUALQ);
+	testBatchedLanes(GLM_SKIN_BLEND);
+	testValidation();
+	testAllocationFailures();
+	return glmTestResult();
+}
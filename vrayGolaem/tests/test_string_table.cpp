@@ -0,0 +1,287 @@
+// GlmStringTable and the interned *_1 structs : one copy per distinct string, allocations through GLMC_MALLOC, failed interning
+// reported as a failed allocation, and glmCreateInternedEntityGeometry peaks lower than interning a geometry created with all its names
+#include <stdlib.h>
+static size_t glmTestLiveBytes = 0;
+static size_t glmTestPeakBytes = 0;
+static int glmTestLiveAllocationCount = 0;
+static int glmTestAllocationsBeforeFailure = -1; // -1 : never fail, only the allocation it counts down to fails
+// the size is stored in front of each block to track the live bytes
+static void* glmTestMalloc(size_t size)
+{
+	if (glmTestAllocationsBeforeFailure == 0)
+	{
+		glmTestAllocationsBeforeFailure = -1;
+		return NULL;
+	}
+	if (glmTestAllocationsBeforeFailure > 0)
+		glmTestAllocationsBeforeFailure--;
+	size_t* block = (size_t*)malloc(size + 16);
+	if (block == NULL)
+		return NULL;
+	block[0] = size;
+	glmTestLiveBytes += size;
+	if (glmTestLiveBytes > glmTestPeakBytes)
+		glmTestPeakBytes = glmTestLiveBytes;
+	glmTestLiveAllocationCount++;
+	return (char*)block + 16;
+}
+static void glmTestFree(void* ptr)
+{
+	if (ptr == NULL)
+		return;
+	size_t* block = (size_t*)((char*)ptr - 16);
+	glmTestLiveBytes -= block[0];
+	glmTestLiveAllocationCount--;
+	free(block);
+}
+#define GLMC_MALLOC(size) glmTestMalloc(size)
+#define GLMC_FREE(ptr) glmTestFree(ptr)
+#define GLMC_REALLOC(ptr, size) realloc(ptr, size)
+
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "glm_test.h"
+
+// glmCrowdIO library stand-ins : every entity has MESH_COUNT meshes of VERTEX_COUNT vertices sharing one shader group
+// with FILE_ATTRIBUTE_COUNT file attributes, names only in GLM_CREATE_ALL and GLM_CREATE_NAMES_AND_SHADERS modes
+enum { MESH_COUNT = 8, VERTEX_COUNT = 256, FILE_ATTRIBUTE_COUNT = 32 };
+
+extern "C" GlmGeometryGenerationStatus glmCreateEntityGeometry(GlmEntityGeometry* geometry, GlmGeometryGenerationContext* context, const GlmEntityBoundingBox* bbox, GlmEntityInstanceMatrices& instanceMatrices, GlmCreateGeometryMode mode)
+{
+	memset(geometry, 0, sizeof(GlmEntityGeometry));
+	geometry->_meshCount = MESH_COUNT;
+	geometry->_meshes = (GlmMesh*)GLMC_MALLOC(MESH_COUNT * sizeof(GlmMesh));
+	memset(geometry->_meshes, 0, MESH_COUNT * sizeof(GlmMesh));
+	if (mode != GLM_CREATE_GEOMETRY)
+	{
+		geometry->_fileShaderAttributeValues = (char(*)[GIO_NAME_LENGTH])GLMC_MALLOC(FILE_ATTRIBUTE_COUNT * GIO_NAME_LENGTH);
+		for (int iAttribute = 0; iAttribute < FILE_ATTRIBUTE_COUNT; iAttribute++)
+			sprintf(geometry->_fileShaderAttributeValues[iAttribute], "textures/entity%u_%d.png", bbox->_entityId % 4, iAttribute);
+	}
+	for (int iMesh = 0; iMesh < MESH_COUNT; iMesh++)
+	{
+		GlmMesh& mesh = geometry->_meshes[iMesh];
+		mesh._shaderGroupIdx = 0;
+		if (mode != GLM_CREATE_GEOMETRY)
+			sprintf(mesh._name, "mesh%d", iMesh);
+		if (mode != GLM_CREATE_NAMES_AND_SHADERS)
+		{
+			mesh._verticeCount = VERTEX_COUNT;
+			mesh._vertices = (float(**)[3])GLMC_MALLOC(sizeof(float(*)[3]));
+			mesh._vertices[0] = (float(*)[3])GLMC_MALLOC(VERTEX_COUNT * sizeof(float[3]));
+			mesh._vertices[0][0][0] = (float)iMesh;
+			mesh._objectId = iMesh + 100;
+		}
+	}
+	return GIO_SUCCESS;
+}
+
+extern "C" void glmDestroyEntityGeometry(GlmEntityGeometry* geometry, const GlmGeometryGenerationContext* context, const GlmEntityBoundingBox* bbox)
+{
+	for (uint16_t iMesh = 0; iMesh < geometry->_meshCount; iMesh++)
+	{
+		if (geometry->_meshes[iMesh]._vertices)
+			GLMC_FREE(geometry->_meshes[iMesh]._vertices[0]);
+		GLMC_FREE(geometry->_meshes[iMesh]._vertices);
+	}
+	GLMC_FREE(geometry->_meshes);
+	GLMC_FREE(geometry->_fileShaderAttributeValues);
+	memset(geometry, 0, sizeof(GlmEntityGeometry));
+}
+
+static void checkInternedGeometry(const GlmStringTable& table, const GlmEntityGeometry_1& geometry, uint32_t entityId)
+{
+	char expected[64];
+	GLM_TEST_CHECK(geometry._meshCount == MESH_COUNT);
+	for (int iMesh = 0; iMesh < MESH_COUNT; iMesh++)
+	{
+		sprintf(expected, "mesh%d", iMesh);
+		GLM_TEST_CHECK(strcmp(glmGetMeshName(table, geometry._meshes[iMesh]), expected) == 0);
+		GLM_TEST_CHECK(geometry._meshes[iMesh]._verticeCount == VERTEX_COUNT);
+		GLM_TEST_CHECK(geometry._meshes[iMesh]._vertices[0][0][0] == (float)iMesh);
+		GLM_TEST_CHECK(geometry._meshes[iMesh]._objectId == (uint32_t)iMesh + 100);
+	}
+	sprintf(expected, "textures/entity%u_%d.png", entityId % 4, FILE_ATTRIBUTE_COUNT - 1);
+	GLM_TEST_CHECK(strcmp(glmGetFileShaderAttributeValue(table, geometry, FILE_ATTRIBUTE_COUNT - 1), expected) == 0);
+}
+
+int main()
+{
+	// interning
+	{
+		GlmStringTable table;
+		GlmStringHandle a = table.intern("crowdMan_light");
+		GLM_TEST_CHECK(a != GIO_INVALID_STRING_HANDLE);
+		GLM_TEST_CHECK(table.intern("crowdMan_light") == a);
+		GLM_TEST_CHECK(table.intern("crowdWoman_light") != a);
+		GLM_TEST_CHECK(table.find("crowdMan_light") == a);
+		GLM_TEST_CHECK(table.find("unknown") == GIO_INVALID_STRING_HANDLE);
+		GLM_TEST_CHECK(table.intern(NULL) == GIO_INVALID_STRING_HANDLE);
+		GLM_TEST_CHECK(strcmp(table.get(GIO_INVALID_STRING_HANDLE), "") == 0);
+		GLM_TEST_CHECK(table.size() == 2);
+
+		// enough strings to rehash, a string longer than a page
+		char name[32];
+		for (int iString = 0; iString < 5000; iString++)
+		{
+			sprintf(name, "attribute%d", iString);
+			table.intern(name);
+		}
+		GLM_TEST_CHECK(glmTestLiveBytes <= table.allocatedBytes());
+		size_t allocatedBytesBeforeLong = table.allocatedBytes();
+		std::string longString(100000, 'x');
+		GlmStringHandle longHandle = table.intern(longString.c_str());
+		GLM_TEST_CHECK(table.size() == 5003);
+		GLM_TEST_CHECK(longString == table.get(longHandle));
+		// the long string page is counted with its real size, not as a regular page
+		GLM_TEST_CHECK(table.allocatedBytes() >= allocatedBytesBeforeLong + longString.size() + 1);
+		GLM_TEST_CHECK(glmTestLiveBytes <= table.allocatedBytes());
+		// strings after the long one still go to the current regular page
+		size_t allocatedBytesAfterLong = table.allocatedBytes();
+		GLM_TEST_CHECK(strcmp(table.get(table.intern("afterLongString")), "afterLongString") == 0);
+		GLM_TEST_CHECK(table.allocatedBytes() == allocatedBytesAfterLong);
+		GLM_TEST_CHECK(strcmp(table.get(table.find("attribute4999")), "attribute4999") == 0);
+		GLM_TEST_CHECK(strcmp(table.get(a), "crowdMan_light") == 0);
+		GLM_TEST_CHECK(glmTestLiveAllocationCount > 0);
+	}
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+	GLM_TEST_CHECK(glmTestLiveBytes == 0);
+
+	GlmGeometryGenerationContext context;
+	memset(&context, 0, sizeof(GlmGeometryGenerationContext));
+	GlmShaderGroup shaderGroup;
+	memset(&shaderGroup, 0, sizeof(GlmShaderGroup));
+	strcpy(shaderGroup._name, "shaderGroup");
+	shaderGroup._fileShaderAttributeCount = FILE_ATTRIBUTE_COUNT;
+	context._shaderGroupCount = 1;
+	context._shaderGroups = &shaderGroup;
+	GlmEntityInstanceMatrices instanceMatrices;
+	glmInitEntityInstanceMatrices(instanceMatrices);
+	const uint32_t entityCount = 16;
+	GlmEntityBoundingBox bboxes[entityCount];
+	memset(bboxes, 0, sizeof(bboxes));
+	for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		bboxes[iEntity]._entityId = iEntity;
+	GlmEntityGeometry geometries[entityCount];
+	GlmEntityGeometry_1 internedGeometries[entityCount];
+
+	// shader group : names interned, arrays released
+	{
+		GlmStringTable table;
+		char attributeNames[2][GIO_NAME_LENGTH] = { "diffuse", "bump" };
+		uint16_t attributeIndexes[2] = { 3, 7 };
+		GlmShader shader;
+		strcpy(shader._name, "skin");
+		strcpy(shader._category, "surface");
+		GlmShaderGroup group = shaderGroup;
+		group._fileShaderAttributeCount = 2;
+		group._fileShaderAttributeNames = attributeNames;
+		group._fileShaderAttributeIndexes = attributeIndexes;
+		group._shaderCount = 1;
+		group._shaders = &shader;
+		GlmShaderGroup_1 groupOut;
+		GLM_TEST_CHECK(glmInternShaderGroup(table, group, groupOut) == 1);
+		GLM_TEST_CHECK(strcmp(glmGetShaderGroupName(table, groupOut), "shaderGroup") == 0);
+		GLM_TEST_CHECK(strcmp(table.get(groupOut._fileShaderAttributeNames[1]), "bump") == 0);
+		GLM_TEST_CHECK(groupOut._fileShaderAttributeIndexes[1] == 7);
+		GLM_TEST_CHECK(strcmp(glmGetShaderCategory(table, groupOut._shaders[0]), "surface") == 0);
+		glmDestroyInternedShaderGroup(groupOut);
+
+		// each allocation failing alone, of the table or of the interned arrays : 0 returned and nothing left allocated
+		int failureCount = 0;
+		for (int allocationCount = 0; ; allocationCount++)
+		{
+			GlmStringTable failingTable;
+			glmTestAllocationsBeforeFailure = allocationCount;
+			int interned = glmInternShaderGroup(failingTable, group, groupOut);
+			glmTestAllocationsBeforeFailure = -1;
+			if (interned)
+			{
+				GLM_TEST_CHECK(strcmp(failingTable.get(groupOut._shaders[0]._category), "surface") == 0);
+				glmDestroyInternedShaderGroup(groupOut);
+				break;
+			}
+			GLM_TEST_CHECK(groupOut._fileShaderAttributeNames == NULL && groupOut._shaders == NULL);
+			failureCount++;
+		}
+		// the buckets, string slots and string page of the table, the attribute name and index arrays, the shaders
+		GLM_TEST_CHECK(failureCount == 3 + 2 + 1);
+	}
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// interning geometries created with all their names : the char[GIO_NAME_LENGTH] arrays stay allocated with the interned handles
+	size_t createAllPeakBytes;
+	{
+		GlmStringTable table;
+		glmTestPeakBytes = glmTestLiveBytes;
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			GLM_TEST_CHECK(glmCreateEntityGeometry(&geometries[iEntity], &context, &bboxes[iEntity], instanceMatrices, GLM_CREATE_ALL) == GIO_SUCCESS);
+			GLM_TEST_CHECK(glmInternEntityGeometry(table, geometries[iEntity], FILE_ATTRIBUTE_COUNT, internedGeometries[iEntity]) == 1);
+			checkInternedGeometry(table, internedGeometries[iEntity], iEntity);
+		}
+		createAllPeakBytes = glmTestPeakBytes;
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			glmDestroyInternedEntityGeometry(internedGeometries[iEntity]);
+			glmDestroyEntityGeometry(&geometries[iEntity], &context, &bboxes[iEntity]);
+		}
+	}
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// entity names : a failed intern returns 0 instead of leaving an empty name
+	{
+		GLM_TEST_CHECK(glmCreateEntityGeometry(&geometries[0], &context, &bboxes[0], instanceMatrices, GLM_CREATE_ALL) == GIO_SUCCESS);
+		int liveAllocationCount = glmTestLiveAllocationCount;
+		int failureCount = 0;
+		for (int allocationCount = 0; ; allocationCount++)
+		{
+			GlmStringTable failingTable;
+			glmTestAllocationsBeforeFailure = allocationCount;
+			int interned = glmInternEntityGeometry(failingTable, geometries[0], FILE_ATTRIBUTE_COUNT, internedGeometries[0]);
+			glmTestAllocationsBeforeFailure = -1;
+			if (interned)
+			{
+				checkInternedGeometry(failingTable, internedGeometries[0], 0);
+				glmDestroyInternedEntityGeometry(internedGeometries[0]);
+				break;
+			}
+			GLM_TEST_CHECK(internedGeometries[0]._meshes == NULL && internedGeometries[0]._fileShaderAttributeValues == NULL);
+			failureCount++;
+		}
+		GLM_TEST_CHECK(glmTestLiveAllocationCount == liveAllocationCount);
+		// the attribute values, the buckets, string slots and string page of the table, the meshes
+		GLM_TEST_CHECK(failureCount == 1 + 3 + 1);
+		glmDestroyEntityGeometry(&geometries[0], &context, &bboxes[0]);
+	}
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// names created, interned and released before the geometry
+	size_t createInternedPeakBytes;
+	{
+		GlmStringTable table;
+		glmTestPeakBytes = glmTestLiveBytes;
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			GLM_TEST_CHECK(glmCreateInternedEntityGeometry(table, &geometries[iEntity], &context, &bboxes[iEntity], instanceMatrices, internedGeometries[iEntity]) == GIO_SUCCESS);
+			GLM_TEST_CHECK(geometries[iEntity]._fileShaderAttributeValues == NULL);
+			checkInternedGeometry(table, internedGeometries[iEntity], iEntity);
+		}
+		// 4 distinct attribute value sets and the mesh names
+		GLM_TEST_CHECK(table.size() == 4 * FILE_ATTRIBUTE_COUNT + MESH_COUNT);
+		createInternedPeakBytes = glmTestPeakBytes;
+		for (uint32_t iEntity = 0; iEntity < entityCount; iEntity++)
+		{
+			glmDestroyInternedEntityGeometry(internedGeometries[iEntity]);
+			glmDestroyEntityGeometry(&geometries[iEntity], &context, &bboxes[iEntity]);
+		}
+	}
+	GLM_TEST_CHECK(glmTestLiveAllocationCount == 0);
+
+	// at least the file attribute values of all the entities but one are saved
+	printf("peak bytes : %zu created with names, %zu created interned\n", createAllPeakBytes, createInternedPeakBytes);
+	GLM_TEST_CHECK(createInternedPeakBytes + (entityCount - 1) * FILE_ATTRIBUTE_COUNT * GIO_NAME_LENGTH <= createAllPeakBytes);
+
+	glmReleaseEntityInstanceMatrices(instanceMatrices);
+	return glmTestResult();
+}
@@ -0,0 +1,117 @@
+// Synthetic terrains for the CrowdTerrain tests and benchmarks, built without the glmCrowdIO library
+#ifndef GLM_TEST_TERRAIN_INCLUDE_H
+#define GLM_TEST_TERRAIN_INCLUDE_H
+
+#include "glm_test.h"
+#include <math.h>
+#include <vector>
+
+typedef float(*GlmTestHeightFunction)(float x, float z);
+
+struct GlmTestTriangleSoup
+{
+	std::vector<CrowdTerrain::Vec3> _vertices;
+	std::vector<unsigned int> _indices;
+};
+
+inline float glmTestFlatHeight(float, float)
+{
+	return 0.f;
+}
+
+// a few octaves of sines, no flat area
+inline float glmTestNoiseHeight(float x, float z)
+{
+	return 3.f * sinf(x * 0.05f) * cosf(z * 0.043f) + 1.1f * sinf(x * 0.31f + z * 0.17f) + 0.35f * sinf(x * 1.7f - z * 1.3f);
+}
+
+// 1 unit steps every 4 units along X
+inline float glmTestStairsHeight(float x, float)
+{
+	return floorf(x * 0.25f);
+}
+
+// size x size grid on the X/Z plane (Y-up) with resolution x resolution quads
+inline void glmTestAppendGrid(GlmTestTriangleSoup& soup, unsigned int resolution, float size, GlmTestHeightFunction height)
+{
+	unsigned int firstVertex = (unsigned int)soup._vertices.size();
+	float step = size / (float)resolution;
+	for (unsigned int iZ = 0; iZ <= resolution; iZ++)
+	{
+		for (unsigned int iX = 0; iX <= resolution; iX++)
+		{
+			float x = iX * step;
+			float z = iZ * step;
+			soup._vertices.push_back(CrowdTerrain::Vec3(x, height(x, z), z));
+		}
+	}
+	for (unsigned int iZ = 0; iZ < resolution; iZ++)
+	{
+		for (unsigned int iX = 0; iX < resolution; iX++)
+		{
+			unsigned int v0 = firstVertex + iZ * (resolution + 1) + iX;
+			unsigned int v1 = v0 + 1;
+			unsigned int v2 = v0 + resolution + 1;
+			unsigned int v3 = v2 + 1;
+			unsigned int quad[6] = { v0, v2, v1, v1, v2, v3 };
+			soup._indices.insert(soup._indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+inline void glmTestAppendQuad(GlmTestTriangleSoup& soup, const CrowdTerrain::Vec3& a, const CrowdTerrain::Vec3& b, const CrowdTerrain::Vec3& c, const CrowdTerrain::Vec3& d)
+{
+	unsigned int firstVertex = (unsigned int)soup._vertices.size();
+	soup._vertices.push_back(a);
+	soup._vertices.push_back(b);
+	soup._vertices.push_back(c);
+	soup._vertices.push_back(d);
+	unsigned int quad[6] = { firstVertex, firstVertex + 1, firstVertex + 2, firstVertex, firstVertex + 2, firstVertex + 3 };
+	soup._indices.insert(soup._indices.end(), quad, quad + 6);
+}
+
+// closed axis aligned box, used as overhanging slabs above a grid
+inline void glmTestAppendBox(GlmTestTriangleSoup& soup, const CrowdTerrain::Vec3& boxMin, const CrowdTerrain::Vec3& boxMax)
+{
+	CrowdTerrain::Vec3 c[8];
+	for (int iCorner = 0; iCorner < 8; iCorner++)
+		c[iCorner].setValues((iCorner & 1) ? boxMax.x : boxMin.x, (iCorner & 2) ? boxMax.y : boxMin.y, (iCorner & 4) ? boxMax.z : boxMin.z);
+	glmTestAppendQuad(soup, c[0], c[1], c[3], c[2]);
+	glmTestAppendQuad(soup, c[4], c[6], c[7], c[5]);
+	glmTestAppendQuad(soup, c[0], c[4], c[5], c[1]);
+	glmTestAppendQuad(soup, c[2], c[3], c[7], c[6]);
+	glmTestAppendQuad(soup, c[0], c[2], c[6], c[4]);
+	glmTestAppendQuad(soup, c[1], c[5], c[7], c[3]);
+}
+
+// noise ground with floating slabs : vertical rays hit the slab tops, rays starting below them hit their undersides
+inline void glmTestAppendOverhangs(GlmTestTriangleSoup& soup, unsigned int resolution, float size, unsigned int slabCount, uint32_t seed)
+{
+	glmTestAppendGrid(soup, resolution, size, glmTestNoiseHeight);
+	uint32_t randomState = seed;
+	for (unsigned int iSlab = 0; iSlab < slabCount; iSlab++)
+	{
+		float x = glmTestRandomRange(&randomState, 0.f, size * 0.9f);
+		float z = glmTestRandomRange(&randomState, 0.f, size * 0.9f);
+		float y = glmTestRandomRange(&randomState, 6.f, 12.f);
+		float extent = glmTestRandomRange(&randomState, size * 0.01f, size * 0.1f);
+		glmTestAppendBox(soup, CrowdTerrain::Vec3(x, y, z), CrowdTerrain::Vec3(x + extent, y + 0.5f, z + extent));
+	}
+}
+
+// copies the soup in subMesh (arrays owned by the SubMesh) and builds its hierarchy as SubMesh::init does
+inline void glmTestCreateSubMesh(CrowdTerrain::SubMesh& subMesh, const GlmTestTriangleSoup& soup)
+{
+	subMesh._vertexCount = (unsigned int)soup._vertices.size();
+	subMesh._indiceCount = (unsigned int)soup._indices.size();
+	subMesh._vertices = new CrowdTerrain::Vec3[subMesh._vertexCount];
+	subMesh._indices = new unsigned int[subMesh._indiceCount];
+	memcpy(subMesh._vertices, &soup._vertices[0], sizeof(CrowdTerrain::Vec3) * subMesh._vertexCount);
+	memcpy(subMesh._indices, &soup._indices[0], sizeof(unsigned int) * subMesh._indiceCount);
+	subMesh._worldToLocal.setToIdentity();
+	subMesh._localToWorld.setToIdentity();
+	subMesh._AABB.clear();
+	CrowdTerrain::computeAABBHierarchy<CrowdTerrain::Vec3, CrowdTerrain::Vec3>(subMesh._vertices, (int*)subMesh._indices, 0, (int)subMesh._indiceCount, 0, subMesh._AABB);
+}
+
+#endif // GLM_TEST_TERRAIN_INCLUDE_H
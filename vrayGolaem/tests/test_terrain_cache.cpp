@@ -0,0 +1,246 @@
+// .gtb terrain cache : loadTerrainAssetCached builds and writes the cache once, reuses it while the .gtg content hash or the fbx
+// file hash matches, rebuilds it when the terrain changes or the cache is damaged. Fbx terrains are read without the library
+#define GLMC_IMPLEMENTATION
+#include "glm_crowd_io.h"
+#include "test_terrain.h"
+#include <stddef.h>
+
+using namespace CrowdTerrain;
+
+// glmCrowdIO library stand-ins : the .gtg content is glmTestTerrainSoup, whatever the file
+static GlmTestTriangleSoup glmTestTerrainSoup;
+static int glmTestLiveTerrainMeshCount = 0;
+
+extern "C" GlmGeometryGenerationStatus glmReadTerrainFile(const char* filename, uint16_t& meshCount, GlmFileMesh*& fileMeshes)
+{
+	meshCount = 1;
+	fileMeshes = new GlmFileMesh[1];
+	GlmFileMesh& fileMesh = fileMeshes[0];
+	memset(&fileMesh, 0, sizeof(GlmFileMesh));
+	fileMesh._vertexCount = (uint32_t)glmTestTerrainSoup._vertices.size();
+	fileMesh._triangleCount = (uint32_t)glmTestTerrainSoup._indices.size() / 3;
+	fileMesh._vertices = new GlmFileMeshVertex[fileMesh._vertexCount];
+	fileMesh._vertexIndicesPerTriangle = new uint32_t[fileMesh._triangleCount][3];
+	memset(fileMesh._vertices, 0, sizeof(GlmFileMeshVertex) * fileMesh._vertexCount);
+	for (uint32_t iVertex = 0; iVertex < fileMesh._vertexCount; iVertex++)
+	{
+		memcpy(fileMesh._vertices[iVertex]._position, &glmTestTerrainSoup._vertices[iVertex], sizeof(float[3]));
+		fileMesh._vertices[iVertex]._normal[1] = 1.f;
+	}
+	memcpy(fileMesh._vertexIndicesPerTriangle, &glmTestTerrainSoup._indices[0], sizeof(uint32_t) * glmTestTerrainSoup._indices.size());
+	for (int i = 0; i < 4; i++)
+		fileMesh._defaultLocalToWorldMatrix[i * 5] = 1.f;
+	glmTestLiveTerrainMeshCount++;
+	return GIO_SUCCESS;
+}
+
+extern "C" void glmClearGeometryFile(GlmGeometryFile& geometry)
+{
+	for (uint16_t iMesh = 0; iMesh < geometry._meshCount; iMesh++)
+	{
+		delete[] geometry._meshes[iMesh]._vertices;
+		delete[] geometry._meshes[iMesh]._vertexIndicesPerTriangle;
+	}
+	delete[] geometry._meshes;
+	glmTestLiveTerrainMeshCount--;
+	memset(&geometry, 0, sizeof(GlmGeometryFile));
+}
+
+// fbx terrains : the library builds glmTestTerrainSoup with its hierarchy, normals and a 2 frames animation
+static int glmTestLibraryLoadCount = 0;
+extern "C" Mesh* CrowdTerrain::loadTerrainAsset(const char*)
+{
+	Mesh* mesh = new Mesh();
+	SubMesh* subMesh = new SubMesh();
+	glmTestCreateSubMesh(*subMesh, glmTestTerrainSoup);
+	subMesh->_normals = new Vec3[subMesh->_vertexCount];
+	for (unsigned int iVertex = 0; iVertex < subMesh->_vertexCount; iVertex++)
+		subMesh->_normals[iVertex].setValues(0.f, 1.f, (float)iVertex);
+	subMesh->_localToWorld._matrix44[3][1] = 2.f;
+	subMesh->_worldToLocal.inverse(subMesh->_localToWorld);
+	for (int iFrame = 0; iFrame < 2; iFrame++)
+	{
+		subMesh->_animationInverse.push_back(subMesh->_localToWorld);
+		subMesh->_animationInverse.back()._matrix44[3][0] = (float)iFrame;
+		subMesh->_animation.push_back(subMesh->_worldToLocal);
+		subMesh->_animation.back().inverse(subMesh->_animationInverse.back());
+	}
+	mesh->_subMeshes.push_back(subMesh);
+	mesh->_startFrame = 5;
+	glmTestLibraryLoadCount++;
+	glmTestLiveTerrainMeshCount++;
+	return mesh;
+}
+extern "C" void CrowdTerrain::closeTerrainAsset(const Mesh* mesh)
+{
+	delete mesh;
+	glmTestLiveTerrainMeshCount--;
+}
+
+static void createTerrain(float (*height)(float, float))
+{
+	glmTestTerrainSoup = GlmTestTriangleSoup();
+	glmTestAppendGrid(glmTestTerrainSoup, 24, 64.f, height);
+}
+
+// same hierarchy and index order as a fresh build, and the same raycast hits
+static void checkSameAsBuilt(const Mesh* mesh)
+{
+	SubMesh expected;
+	glmTestCreateSubMesh(expected, glmTestTerrainSoup);
+	GLM_TEST_CHECK(mesh && mesh->_subMeshes.size() == 1);
+	if (!mesh || mesh->_subMeshes.size() != 1)
+		return;
+	const SubMesh* subMesh = mesh->_subMeshes[0];
+	GLM_TEST_CHECK(subMesh->_AABB.size() == expected._AABB.size());
+	GLM_TEST_CHECK(memcmp(subMesh->_indices, expected._indices, sizeof(unsigned int) * expected._indiceCount) == 0);
+	GLM_TEST_CHECK(subMesh->_AABB.size() == expected._AABB.size() && memcmp(&subMesh->_AABB[0], &expected._AABB[0], sizeof(AABB<Vec3>) * expected._AABB.size()) == 0);
+
+	uint32_t randomState = 0xABCu;
+	int mismatchCount = 0;
+	for (int iRay = 0; iRay < 200; iRay++)
+	{
+		Vec3 origin(glmTestRandomRange(&randomState, 0.f, 64.f), 50.f, glmTestRandomRange(&randomState, 0.f, 64.f));
+		Vec3 segment(0.f, -100.f, 0.f);
+		int triIndex = -1, oracleTriIndex = -1;
+		float tt = FLT_MAX, oracleTT = FLT_MAX;
+		bool hit = hierarchicalRaycast<Vec3, Vec3>(origin, segment, triIndex, tt, (int)subMesh->_AABB.size() - 1, &subMesh->_AABB[0], subMesh->_vertices, (const int*)subMesh->_indices);
+		bool oracleHit = bruteForceRaycast<Vec3, Vec3>(origin, segment, oracleTriIndex, oracleTT, expected._vertices, (const int*)expected._indices, (int)expected._indiceCount);
+		mismatchCount += (hit != oracleHit || tt != oracleTT);
+	}
+	GLM_TEST_CHECK(mismatchCount == 0);
+}
+
+// rewrites a 32 bits value of a cache file
+static void patchCache(size_t position, int32_t value, const char* cacheFile = "terrain.gtb")
+{
+	std::vector<uint8_t> data;
+	GLM_TEST_CHECK(glmTestReadFile(cacheFile, data) && position + sizeof(int32_t) <= data.size());
+	memcpy(&data[position], &value, sizeof(int32_t));
+	GLM_TEST_CHECK(glmTestWriteFile(cacheFile, &data[0], data.size()));
+}
+
+// fbx terrain read from the cache : same arrays, matrices and animation as the library terrain
+static void checkSameAsLibrary(const Mesh* mesh)
+{
+	checkSameAsBuilt(mesh);
+	Mesh* expected = loadTerrainAsset("terrain.fbx");
+	glmTestLibraryLoadCount--;
+	if (mesh && mesh->_subMeshes.size() == 1)
+	{
+		const SubMesh* subMesh = mesh->_subMeshes[0];
+		const SubMesh* expectedSubMesh = expected->_subMeshes[0];
+		GLM_TEST_CHECK(mesh->_startFrame == 5);
+		GLM_TEST_CHECK(subMesh->_vertexCount == expectedSubMesh->_vertexCount);
+		GLM_TEST_CHECK(memcmp(subMesh->_vertices, expectedSubMesh->_vertices, sizeof(Vec3) * expectedSubMesh->_vertexCount) == 0);
+		GLM_TEST_CHECK(subMesh->_normals && memcmp(subMesh->_normals, expectedSubMesh->_normals, sizeof(Vec3) * expectedSubMesh->_vertexCount) == 0);
+		GLM_TEST_CHECK(memcmp(subMesh->_localToWorld._matrix, expectedSubMesh->_localToWorld._matrix, sizeof(float) * 16) == 0);
+		GLM_TEST_CHECK(subMesh->_worldToLocal._matrix44[3][1] == -2.f);
+		GLM_TEST_CHECK(subMesh->_animation.size() == 2 && subMesh->_animationInverse.size() == 2);
+		for (size_t iFrame = 0; iFrame < 2 && iFrame < subMesh->_animation.size(); iFrame++)
+		{
+			GLM_TEST_CHECK(memcmp(subMesh->_animation[iFrame]._matrix, expectedSubMesh->_animation[iFrame]._matrix, sizeof(float) * 16) == 0);
+			GLM_TEST_CHECK(memcmp(subMesh->_animationInverse[iFrame]._matrix, expectedSubMesh->_animationInverse[iFrame]._matrix, sizeof(float) * 16) == 0);
+		}
+	}
+	closeTerrainAsset(expected);
+}
+
+static void testFbxTerrain()
+{
+	const char fbxContent[] = "fbx terrain v1";
+	GLM_TEST_CHECK(glmTestWriteFile("terrain.fbx", fbxContent, sizeof(fbxContent)));
+	remove("terrain.fbx.gtb");
+	createTerrain(glmTestNoiseHeight);
+	glmTestLibraryLoadCount = 0;
+
+	// first load goes through the library and writes the cache, the terrain is a copy owned on this side
+	Mesh* mesh = loadTerrainAssetCached("terrain.fbx");
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 1 && glmTestLiveTerrainMeshCount == 0);
+	checkSameAsLibrary(mesh);
+	closeTerrainAssetCached(mesh, "terrain.fbx");
+	std::vector<uint8_t> cache;
+	GLM_TEST_CHECK(glmTestReadFile("terrain.fbx.gtb", cache));
+
+	// next loads do not call the library
+	mesh = loadTerrainAssetCached("terrain.fbx");
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 1);
+	checkSameAsLibrary(mesh);
+	closeTerrainAssetCached(mesh, "terrain.fbx");
+
+	// a damaged cache or a changed fbx goes through the library again
+	patchCache(sizeof(uint16_t) * 2 + sizeof(uint32_t) * 9 + sizeof(float) * 16, 1 << 30, "terrain.fbx.gtb");
+	mesh = loadTerrainAssetCached("terrain.fbx");
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 2);
+	checkSameAsLibrary(mesh);
+	closeTerrainAssetCached(mesh, "terrain.fbx");
+	const char changedFbxContent[] = "fbx terrain v2";
+	GLM_TEST_CHECK(glmTestWriteFile("terrain.fbx", changedFbxContent, sizeof(changedFbxContent)));
+	mesh = loadTerrainAssetCached("terrain.fbx");
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 3);
+	closeTerrainAssetCached(mesh, "terrain.fbx");
+	mesh = loadTerrainAssetCached("terrain.fbx");
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 3);
+	checkSameAsLibrary(mesh);
+	closeTerrainAssetCached(mesh, "terrain.fbx");
+
+	// a missing fbx is not read from its cache
+	remove("terrain.fbx");
+	GLM_TEST_CHECK(loadTerrainAssetCached("terrain.fbx") == NULL);
+	GLM_TEST_CHECK(glmTestLibraryLoadCount == 3 && glmTestLiveTerrainMeshCount == 0);
+}
+
+int main()
+{
+	const size_t firstNodePosition = sizeof(uint16_t) * 2 + sizeof(uint32_t) * 9 + sizeof(float) * 16 + sizeof(unsigned int) * 24 * 24 * 6;
+	GLM_TEST_CHECK(getTerrainAABBCachePath("dir.v2/terrain.gtg") == "dir.v2/terrain.gtb");
+	GLM_TEST_CHECK(getTerrainAABBCachePath("dir.v2/terrain.fbx") == "dir.v2/terrain.fbx.gtb");
+	GLM_TEST_CHECK(getTerrainAABBCachePath("dir.v2/terrain") == "dir.v2/terrain.gtb");
+	GLM_TEST_CHECK(isTerrainGTG("a/terrain.GTG") && !isTerrainGTG("terrain.fbx") && !isTerrainGTG("gtg"));
+	GLM_TEST_CHECK(isTerrainFBX("a/terrain.FBX") && !isTerrainFBX("terrain.gtg"));
+
+	// first load builds and writes the cache
+	remove("terrain.gtb");
+	createTerrain(glmTestNoiseHeight);
+	Mesh* mesh = loadTerrainAssetCached("terrain.gtg");
+	checkSameAsBuilt(mesh);
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+	GLM_TEST_CHECK(glmTestLiveTerrainMeshCount == 0);
+	std::vector<uint8_t> cache;
+	GLM_TEST_CHECK(glmTestReadFile("terrain.gtb", cache) && cache.size() > firstNodePosition);
+
+	// next loads read it : a node bound changed in the file shows up in the loaded hierarchy
+	float patchedMin = -1234.f;
+	int32_t patchedMinBits;
+	memcpy(&patchedMinBits, &patchedMin, sizeof(float));
+	patchCache(firstNodePosition, patchedMinBits);
+	mesh = loadTerrainAssetCached("terrain.gtg");
+	GLM_TEST_CHECK(mesh && mesh->_subMeshes[0]->_AABB[0]._AABBmin.x == -1234.f);
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+
+	// damaged links, leaf ranges or sizes are rejected and the cache rebuilt
+	patchCache(firstNodePosition + offsetof(AABB<Vec3>, _left), 0);
+	mesh = loadTerrainAssetCached("terrain.gtg");
+	checkSameAsBuilt(mesh);
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+	patchCache(firstNodePosition + offsetof(AABB<Vec3>, _indexCount), 24 * 24 * 6 + 1);
+	mesh = loadTerrainAssetCached("terrain.gtg");
+	checkSameAsBuilt(mesh);
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+	GLM_TEST_CHECK(glmTestReadFile("terrain.gtb", cache));
+	GLM_TEST_CHECK(glmTestWriteFile("terrain.gtb", &cache[0], cache.size() - 1));
+	mesh = loadTerrainAssetCached("terrain.gtg");
+	checkSameAsBuilt(mesh);
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+
+	// a different terrain does not match the hash : rebuilt, and the rewritten cache matches the new terrain
+	createTerrain(glmTestStairsHeight);
+	mesh = loadTerrainAssetCached("terrain.gtg");
+	checkSameAsBuilt(mesh);
+	GLM_TEST_CHECK(readTerrainAABBCache("terrain.gtb", *mesh));
+	closeTerrainAssetCached(mesh, "terrain.gtg");
+	GLM_TEST_CHECK(glmTestLiveTerrainMeshCount == 0);
+
+	testFbxTerrain();
+	return glmTestResult();
+}
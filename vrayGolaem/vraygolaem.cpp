@@ -70,9 +70,14 @@ public:
 #define BIGINT		int(999999)
 #define ICON_RADIUS 2
 #define CROWDVRAYPLUGINID PluginID(LARGE_CONST(2011070866)) // from glmCrowdVRayPlugin.h
+#define VIEWPORT_NEAR 0.1f
+#define VIEWPORT_FAR BIGFLOAT
+#define VIEWPORT_LOD_COUNT 3 // bbox and entity id, bbox, vertical line
+#define VIEWPORT_LOD_HYSTERESIS 0.1f
 
 TCHAR *iconText=_T("VRayGolaem");
 static VRayGolaemClassDesc vrayGolaemClassDesc;
+static float viewportLodThresholds[VIEWPORT_LOD_COUNT-1] = { 32.f, 8.f }; // minimum entity size in pixels of the viewport LODs
 
 // The names of the node user properties that V-Ray uses for reflection/refraction visibility.
 // V-Ray doesn't publish the header with their definitions so I copy them here.
@@ -115,9 +120,16 @@ __declspec( dllexport ) ClassDesc* LibClassDesc(int i) {
 
 __declspec( dllexport ) ULONG LibVersion(void) { return VERSION_3DSMAX; }
 
-__declspec( dllexport ) int LibInitialize(void) { return TRUE; }
+__declspec( dllexport ) int LibInitialize(void) {
+	glmInitSimdDispatch(); // frame kernels for the CPU of this render node
+	glmParallelFor = glmParallelForThreads; // host parallel loop of the crowd library : cloth, frame interpolation, skinning, entity generation
+	glmRaycastClosest = CrowdTerrain::raycastTerrainClosest; // layout ground adaptation on the terrains of VRayGolaemLayout
+	glmTerrainSetFrame = CrowdTerrain::setTerrainFrame;
+	return TRUE;
+}
 
 __declspec( dllexport ) int LibShutdown(void) {
+	glmStopParallelForThreads(); // before the DLL unload, which must not join threads
 	if (golaemPlugman) {
 		golaemPlugman->deleteAll();
 		golaemPlugman->unloadAll();
@@ -301,6 +313,7 @@ VRayGolaem::VRayGolaem()
 }
 
 VRayGolaem::~VRayGolaem() {
+	clearLayouts();
 }
 
 //------------------------------------------------------------
@@ -635,6 +648,34 @@ void VRayGolaemDlgProc::chooseFileName(IParamBlock2 *pblock2, ParamID paramID, c
 // Draw
 //************************************************************
 
+//------------------------------------------------------------
+// destroyLayoutData
+//------------------------------------------------------------
+static void destroyLayoutData(VRayGolaemLayout& layout)
+{
+	if (layout._terrainSource) CrowdTerrain::closeTerrainAssetCached(layout._terrainSource, layout._terrainSourceFile);
+	if (layout._terrainDestination) CrowdTerrain::closeTerrainAssetCached(layout._terrainDestination, layout._terrainDestinationFile);
+	layout._terrainSource = layout._terrainDestination = NULL;
+	layout._terrainSourceFile = layout._terrainDestinationFile = CStr();
+	if (layout._evaluator) glmDestroyLayoutEvaluator(&layout._evaluator);
+	if (layout._frameData) glmDestroyFrameData(&layout._frameData, layout._simulationData);
+	if (layout._compressedFrameData) glmDestroyCompressedFrameData(&layout._compressedFrameData, layout._simulationData);
+	if (layout._simulationData) glmDestroySimulationData(&layout._simulationData);
+}
+
+//------------------------------------------------------------
+// loadLayoutTerrain
+//------------------------------------------------------------
+// (re)loads terrain when file changes, .gtg and .fbx terrains come from the .gtb cache next to them after the first load
+static void loadLayoutTerrain(CStr& terrainFile, CrowdTerrain::Mesh*& terrain, const CStr& file)
+{
+	if (terrainFile == file) return;
+	if (terrain) CrowdTerrain::closeTerrainAssetCached(terrain, terrainFile);
+	terrain = NULL;
+	terrainFile = file;
+	if (file.Length()) terrain = CrowdTerrain::loadTerrainAssetCached(file); // caches without terrain leave it NULL, not retried
+}
+
 //------------------------------------------------------------
 // readGolaemCache
 //------------------------------------------------------------
@@ -642,14 +683,11 @@ void VRayGolaem::readGolaemCache(TimeValue t)
 {
 	if (!_updateCacheData) return;
 	
-	// clean previous data
-	for (size_t iData=0, nbData=_simulationData.length(); iData<nbData; ++iData)
-	{
-		glmDestroyFrameData(&_frameData[iData], _simulationData[iData]);
-		glmDestroySimulationData(&_simulationData[iData]);
-	}
+	// displayed data is owned by the layouts
 	_simulationData.removeAll();
 	_frameData.removeAll();
+	_deferredFrameData.removeAll();
+	_compressedFrameData.removeAll();
 
 	// update params
 	updateVRayParams(t);
@@ -658,97 +696,154 @@ void VRayGolaem::readGolaemCache(TimeValue t)
 	// read caches
 	MaxSDK::Array<CStr> crowdFields;
 	splitStr(_crowdFields, ';', crowdFields);
-	if (_cacheName.length() != 0 && _cacheDir.length() != 0)
+	if (_cacheName.length() == 0 || _cacheDir.length() == 0)
+	{
+		clearLayouts();
+		return;
+	}
+	clearLayouts(crowdFields.length());
+	for (size_t iCf=0, nbCf=crowdFields.length(); iCf<nbCf; ++iCf)
 	{
-		for (size_t iCf=0, nbCf=crowdFields.length(); iCf<nbCf; ++iCf)
+		int currentFrame = (int)((float)t / (float)TIME_TICKSPERSEC * (float)GetFrameRate()) + _frameOffset; 
+		CStr currentFrameStr; currentFrameStr.printf("%i", currentFrame);
+		CStr cachePrefix(_cacheDir + "/" + _cacheName + "." + crowdFields[iCf] + ".");
+		CStr cacheStream(cachePrefix + "%d.gscf");
+		CStr gscsFileStr(cachePrefix + "gscs");
+		CStr gscfFileStr(cachePrefix + currentFrameStr + ".gscf");
+		CStr gsclFileStr(_layoutDir + "/" + _layoutName + "." + crowdFields[iCf] + ".gscl");
+		CStr srcTerrainFile(cachePrefix + "terrain.fbx");
+
+		if (iCf == _layouts.length())
 		{
-			int currentFrame = (int)((float)t / (float)TIME_TICKSPERSEC * (float)GetFrameRate()) + _frameOffset; 
-			CStr currentFrameStr; currentFrameStr.printf("%i", currentFrame);
-			CStr cachePrefix(_cacheDir + "/" + _cacheName + "." + crowdFields[iCf] + ".");
-			CStr cacheStream(cachePrefix + "%d.gscf");
-			CStr gscsFileStr(cachePrefix + "gscs");
-			CStr gscfFileStr(cachePrefix + currentFrameStr + ".gscf");
-			CStr gsclFileStr(_layoutDir + "/" + _layoutName + "." + crowdFields[iCf] + ".gscl");
-			CStr srcTerrainFile(cachePrefix + "terrain.fbx");
-
-			// load gscs
-			GlmSimulationCacheStatus status;
-			GlmSimulationData* simulationData(NULL);
-			GlmFrameData* frameData(NULL);
-			status = glmCreateAndReadSimulationData(&simulationData, gscsFileStr);
+			VRayGolaemLayout newLayout = { CStr(), NULL, NULL, NULL, 0, NULL, CStr(), NULL, CStr(), NULL };
+			_layouts.append(newLayout);
+		}
+		VRayGolaemLayout& layout = _layouts[iCf];
+
+		// load gscs, once per cache
+		GlmSimulationCacheStatus status;
+		if (layout._simulationData == NULL || layout._simulationFile != gscsFileStr)
+		{
+			destroyLayoutData(layout);
+			layout._simulationFile = gscsFileStr;
+			status = glmCreateAndReadSimulationData(&layout._simulationData, gscsFileStr);
 			if (status != GSC_SUCCESS)
 			{
-				glmDestroySimulationData(&simulationData);
+				glmDestroySimulationData(&layout._simulationData);
 				DebugPrint(_T("VRayGolaem: Error loading .gscs file \"%s\""), gscsFileStr);
 				return;
 			}
+		}
 
-			// load gscf
-			glmCreateFrameData(&frameData, simulationData);
-			status = glmReadFrameData(frameData, simulationData, gscfFileStr);
+		// load gscf with its bones kept quantized, the previous frame is destroyed once the layout does not refer to it anymore
+		GlmCompressedFrameData* previousCompressedFrameData(NULL);
+		GlmFrameData* previousFrameData(NULL);
+		if (layout._compressedFrameData == NULL || layout._frame != currentFrame)
+		{
+			GlmCompressedFrameData* compressedFrameData(NULL);
+			status = glmCreateAndReadCompressedFrameData(&compressedFrameData, layout._simulationData, gscfFileStr);
 			if (status != GSC_SUCCESS)
 			{
-				glmDestroyFrameData(&frameData, simulationData);
+				destroyLayoutData(layout); // the .gscs may have been rewritten with the cache, read it again next time
 				DebugPrint(_T("VRayGolaem: Error loading .gscf file \"%s\""), gscfFileStr);
 				return;
 			}
+			previousCompressedFrameData = layout._compressedFrameData;
+			previousFrameData = layout._frameData;
+			layout._compressedFrameData = compressedFrameData;
+			layout._frameData = NULL;
+			layout._frame = currentFrame;
+		}
 
-			// load gscl
-			GlmHistory* history = NULL;
-			GlmEntityTransform* entityTransforms = NULL;
-			int entityTransformCount(0);
-
-			if (_layoutEnable)
+		// load gscl, the evaluator only recomputes what the history or frame change affects
+		GlmHistory* history = NULL;
+		bool layoutApplied(false);
+		if (_layoutEnable && glmCreateAndReadHistoryJSON(&history, gsclFileStr) == GSC_SUCCESS)
+		{
+			// Terrain, kept with the layout so the evaluator sees the same meshes from frame to frame
+			loadLayoutTerrain(layout._terrainSourceFile, layout._terrainSource, srcTerrainFile);
+			loadLayoutTerrain(layout._terrainDestinationFile, layout._terrainDestination, _terrainFile);
+			history->_terrainMeshSource = layout._terrainSource;
+			history->_terrainMeshDestination = layout._terrainDestination ? layout._terrainDestination : layout._terrainSource;
+
+			// the viewport only needs the root bones, duplicates are not materialized
+			if (layout._evaluator == NULL)
 			{
-				GlmSimulationCacheStatus gsclStatus = glmCreateAndReadHistoryJSON(&history, gsclFileStr);
-				if (gsclStatus == GSC_SUCCESS)
-				{
-					// Terrain
-					/*
-					CrowdTerrain::Mesh* terrainMeshSource(NULL), *terrainMeshDestination(NULL);
-					if (srcTerrainFile.Length()) terrainMeshSource = CrowdTerrain::loadTerrainAsset(srcTerrainFile);
-					if (_terrainFile.Length()) terrainMeshDestination = CrowdTerrain::loadTerrainAsset(_terrainFile);
-					if (terrainMeshDestination == NULL) terrainMeshDestination = terrainMeshSource;
-					
-					history->_terrainMeshSource = terrainMeshSource;
-					history->_terrainMeshDestination = terrainMeshDestination;
-					*/
-
-					glmCreateEntityTransforms(simulationData, history, &entityTransforms, &entityTransformCount);
-
-					GlmSimulationData* simulationDataOut;
-					GlmFrameData* frameDataOut;
-					glmCreateModifiedSimulationData(simulationData, entityTransforms, entityTransformCount, &simulationDataOut);
-					glmCreateModifiedFrameData(simulationData, frameData, entityTransforms, entityTransformCount, history, simulationDataOut, &frameDataOut, currentFrame, cacheStream, _cacheDir);
-
-					// replace previous simulation & frame data
-					glmDestroyFrameData(&frameData, simulationData);
-					glmDestroySimulationData(&simulationData);
-					frameData = frameDataOut;
-					simulationData = simulationDataOut;
-
-					// Delete Terrain
-					/*
-					if (terrainMeshSource && terrainMeshSource != terrainMeshDestination) CrowdTerrain::closeTerrainAsset(terrainMeshSource);
-					if (terrainMeshDestination) CrowdTerrain::closeTerrainAsset(terrainMeshDestination);
-					*/
-				}
+				glmCreateLayoutEvaluator(&layout._evaluator, layout._simulationData);
+				if (layout._evaluator) layout._evaluator->_deferDuplicates = 1;
 			}
-
-			if (history) glmDestroyHistory(&history);
-			if (entityTransforms) glmDestroyEntityTransforms(&entityTransforms, entityTransformCount);
-			
-			_simulationData.append(simulationData);
-			_frameData.append(frameData);
-			
+			// the evaluator reads decoded bones, the frame is decoded once per frame change
+			if (layout._frameData == NULL) glmDecompressFrameData(layout._compressedFrameData, layout._simulationData, &layout._frameData);
+			layoutApplied = layout._evaluator && glmUpdateLayoutEvaluator(layout._evaluator, layout._frameData, history, currentFrame, cacheStream, _cacheDir) == GSC_SUCCESS;
 		}
+		if (history) glmDestroyHistory(&history);
+		if (!layoutApplied && layout._evaluator) glmDestroyLayoutEvaluator(&layout._evaluator);
+		if (!layoutApplied && layout._frameData) glmDestroyFrameData(&layout._frameData, layout._simulationData);
+		if (previousFrameData) glmDestroyFrameData(&previousFrameData, layout._simulationData);
+		if (previousCompressedFrameData) glmDestroyCompressedFrameData(&previousCompressedFrameData, layout._simulationData);
+
+		_simulationData.append(layoutApplied ? layout._evaluator->_simulationDataOut : layout._simulationData);
+		_frameData.append(layoutApplied ? layout._evaluator->_frameDataOut : NULL);
+		_deferredFrameData.append(layoutApplied ? layout._evaluator->_deferredFrameDataOut : NULL);
+		_compressedFrameData.append(layoutApplied ? NULL : layout._compressedFrameData);
+	}
+}
+
+//------------------------------------------------------------
+// clearLayouts
+//------------------------------------------------------------
+void VRayGolaem::clearLayouts(size_t firstLayout)
+{
+	for (size_t iLayout=firstLayout, nbLayouts=_layouts.length(); iLayout<nbLayouts; ++iLayout)
+		destroyLayoutData(_layouts[iLayout]);
+	if (firstLayout < _layouts.length()) _layouts.setLengthUsed(firstLayout);
+}
+
+//------------------------------------------------------------
+// setViewportCamera
+//------------------------------------------------------------
+// viewport camera in the context, in max world space : column-major view matrix, OpenGL like projection
+static void setViewportCamera(GlmGeometryGenerationContext& context, ViewExp *vpt)
+{
+	Matrix3 viewTM;
+	vpt->GetAffineTM(viewTM);
+	for (int iRow=0; iRow<4; ++iRow)
+	{
+		Point3 row(viewTM.GetRow(iRow));
+		for (int i=0; i<3; ++i) context._viewMatrix[iRow][i] = row[i];
+		context._viewMatrix[iRow][3] = (iRow == 3) ? 1.f : 0.f;
+	}
+	Point3 cameraPosition(Inverse(viewTM).GetTrans());
+	for (int i=0; i<3; ++i) context._cameraWorldPosition[i] = cameraPosition[i];
+
+	GraphicsWindow *gw=vpt->getGW();
+	float aspect = (float)gw->getWinSizeX() / (float)max(gw->getWinSizeY(), 1);
+	memset(context._projectionMatrix, 0, sizeof(context._projectionMatrix));
+	if (vpt->IsPerspView())
+	{
+		// GetFOV is the horizontal field of view
+		float focal = 1.f / tanf(vpt->GetFOV() * 0.5f);
+		context._projectionMatrix[0][0] = focal;
+		context._projectionMatrix[1][1] = focal * aspect;
+		context._projectionMatrix[2][2] = -(VIEWPORT_FAR + VIEWPORT_NEAR) / (VIEWPORT_FAR - VIEWPORT_NEAR);
+		context._projectionMatrix[2][3] = -1.f;
+		context._projectionMatrix[3][2] = -2.f * VIEWPORT_FAR * VIEWPORT_NEAR / (VIEWPORT_FAR - VIEWPORT_NEAR);
+	}
+	else
+	{
+		// no near plane, entities behind the view point are displayed
+		float width = vpt->GetVPWorldWidth(cameraPosition);
+		context._projectionMatrix[0][0] = 2.f / width;
+		context._projectionMatrix[1][1] = 2.f * aspect / width;
+		context._projectionMatrix[2][2] = -1.f / VIEWPORT_FAR;
+		context._projectionMatrix[3][3] = 1.f;
 	}
 }
 
 //------------------------------------------------------------
 // drawEntities
 //------------------------------------------------------------
-void VRayGolaem::drawEntities(GraphicsWindow *gw, const Matrix3& transform, TimeValue t)
+void VRayGolaem::drawEntities(ViewExp *vpt, const Matrix3& transform, TimeValue t)
 {
 	// get display attributes
 	bool displayEnable = pblock2->GetInt(pb_enable_display, t) == 1;
@@ -758,11 +853,11 @@ void VRayGolaem::drawEntities(GraphicsWindow *gw, const Matrix3& transform, Time
 
 	// update cache if required
 	readGolaemCache(t);
-	if (_simulationData.length() == 0 || _frameData.length() == 0 || _simulationData.length() != _frameData.length()) return;
+	if (_simulationData.length() == 0 || _simulationData.length() != _frameData.length() || _simulationData.length() != _deferredFrameData.length() || _simulationData.length() != _compressedFrameData.length()) return;
 
-	// draw
+	// entity bounds, in world space
 	_nodeBbox.Init();
-	
+	MaxSDK::Array<GlmEntityBoundingBox> entityBBoxes;
 	float transformScale(transform.GetRow(0).Length());
 	for (size_t iData=0, nbData=_simulationData.length(); iData<nbData; ++iData)
 	{
@@ -777,24 +872,93 @@ void VRayGolaem::drawEntities(GraphicsWindow *gw, const Matrix3& transform, Time
 			float entityHeight = _simulationData[iData]->_entityHeight[iEntity] * transformScale;
 			if(_simulationData[iData]->_boneCount[entityType])
 			{
-				// draw bbox
-				unsigned int iBoneIndex = _simulationData[iData]->_iBoneOffsetPerEntityType[entityType] + _simulationData[iData]->_indexInEntityType[iEntity] * _simulationData[iData]->_boneCount[entityType];
-				Point3 entityPosition(_frameData[iData]->_bonePositions[iBoneIndex][0], _frameData[iData]->_bonePositions[iBoneIndex][1], _frameData[iData]->_bonePositions[iBoneIndex][2]);
+				Point3 entityPosition;
+				if (_deferredFrameData[iData])
+				{
+					float rootPosition[3], rootOrientation[4];
+					glmGetDeferredEntityRootBone(_deferredFrameData[iData], (unsigned int)iEntity, rootPosition, rootOrientation);
+					entityPosition = Point3(rootPosition[0], rootPosition[1], rootPosition[2]);
+				}
+				else if (_compressedFrameData[iData])
+				{
+					float rootPosition[3], rootOrientation[4];
+					glmGetCompressedEntityRootBone(_compressedFrameData[iData], _simulationData[iData], (unsigned int)iEntity, rootPosition, rootOrientation);
+					entityPosition = Point3(rootPosition[0], rootPosition[1], rootPosition[2]);
+				}
+				else
+				{
+					unsigned int iBoneIndex = _simulationData[iData]->_iBoneOffsetPerEntityType[entityType] + _simulationData[iData]->_indexInEntityType[iEntity] * _simulationData[iData]->_boneCount[entityType];
+					entityPosition = Point3(_frameData[iData]->_bonePositions[iBoneIndex][0], _frameData[iData]->_bonePositions[iBoneIndex][1], _frameData[iData]->_bonePositions[iBoneIndex][2]);
+				}
 				// axis transformation for max
 				entityPosition = entityPosition * transform;
 				Box3 entityBbox(Point3(entityPosition[0]-entityRadius, entityPosition[1]-entityRadius, entityPosition[2]), Point3(entityPosition[0]+entityRadius, entityPosition[1]+entityRadius, entityPosition[2]+entityHeight));
-				drawBBox(gw, entityBbox); // update node bbox
-				_nodeBbox += entityBbox;
-
-				// draw EntityID
-				if (displayEntityIds)
+				_nodeBbox += entityBbox; // update node bbox
+
+				GlmEntityBoundingBox bbox;
+				memset(&bbox, 0, sizeof(bbox));
+				bbox._isVisible = 1;
+				bbox._entityIndex = (uint32_t)iEntity;
+				bbox._crowdFieldIndex = (uint8_t)iData;
+				for (int i=0; i<3; ++i)
 				{
-					CStr entityIdStrs; entityIdStrs.printf("%i", entityId);
-					drawText(gw, entityIdStrs.ToMCHAR(), entityPosition);
+					bbox._entityOrigin[i] = entityBbox.Center()[i];
+					bbox._boundingBoxHalfExtents[i] = entityBbox.Width()[i] * 0.5f;
 				}
+				bbox._entityScale = 1.f;
+				entityBBoxes.append(bbox);
 			}
 		}
 	}
+	if (entityBBoxes.length() == 0) return;
+
+	GlmGeometryGenerationContext context;
+	memset(&context, 0, sizeof(context));
+	context._entityCount = (uint32_t)entityBBoxes.length();
+	context._entityBBoxes = entityBBoxes.asArrayPtr();
+	setViewportCamera(context, vpt);
+
+	// frustum culling with the render settings, every entity is drawn if it fails
+	context._enableFrustumCulling = _frustumEnable;
+	context._frustumMargin = _frustumMargin;
+	context._cameraMargin = _cameraMargin;
+	glmCullContextEntities(&context);
+
+	// LODs of the entities in the frustum, the previous ones are kept while the displayed entities stay the same
+	if (_entityLods.length() != entityBBoxes.length())
+	{
+		_entityLods.removeAll();
+		_entityLods.setLengthUsed(entityBBoxes.length(), GIO_NO_LOD);
+	}
+	GlmLodSettings lodSettings = { VIEWPORT_LOD_COUNT, viewportLodThresholds, VIEWPORT_LOD_HYSTERESIS, (float)vpt->getGW()->getWinSizeY() };
+	glmSelectEntityLods(&context, &lodSettings, _entityLods.asArrayPtr());
+
+	// draw : bbox and entity id, bbox only, vertical line
+	GraphicsWindow *gw=vpt->getGW();
+	gw->setTransform(Matrix3(1));
+	for (size_t iEntity=0, entityCount=entityBBoxes.length(); iEntity<entityCount; ++iEntity)
+	{
+		const GlmEntityBoundingBox& bbox = entityBBoxes[iEntity];
+		if (!bbox._isVisible) continue;
+		Point3 center(bbox._entityOrigin[0], bbox._entityOrigin[1], bbox._entityOrigin[2]);
+		Point3 halfExtents(bbox._boundingBoxHalfExtents[0], bbox._boundingBoxHalfExtents[1], bbox._boundingBoxHalfExtents[2]);
+		uint8_t lod = _entityLods[iEntity];
+		if (lod >= 2)
+		{
+			gw->startSegments();
+			drawLine(gw, center - Point3(0.f, 0.f, halfExtents[2]), center + Point3(0.f, 0.f, halfExtents[2]));
+			gw->endSegments();
+			continue;
+		}
+		drawBBox(gw, Box3(center - halfExtents, center + halfExtents));
+
+		// draw EntityID
+		if (displayEntityIds && lod == 0)
+		{
+			CStr entityIdStrs; entityIdStrs.printf("%i", _simulationData[bbox._crowdFieldIndex]->_entityIds[bbox._entityIndex]);
+			drawText(gw, entityIdStrs.ToMCHAR(), center - Point3(0.f, 0.f, halfExtents[2]));
+		}
+	}
 }
 
 //------------------------------------------------------------
@@ -815,7 +979,7 @@ void VRayGolaem::draw(TimeValue t, INode *node, ViewExp *vpt)
 	drawSphere(gw, Point3::Origin, ICON_RADIUS, 30);
 
 	// entities	
-	drawEntities(gw, tm, t);
+	drawEntities(vpt, tm, t);
 
 	// text
 	tm.NoScale();
@@ -157,6 +157,28 @@ struct GlmSimulationData_v0;
 typedef GlmSimulationData_v0 GlmSimulationData;
 struct GlmFrameData_v0;
 typedef GlmFrameData_v0 GlmFrameData;
+struct GlmLayoutEvaluator_v0;
+typedef GlmLayoutEvaluator_v0 GlmLayoutEvaluator;
+struct GlmDeferredFrameData_v0;
+typedef GlmDeferredFrameData_v0 GlmDeferredFrameData;
+struct GlmCompressedFrameData_v0;
+typedef GlmCompressedFrameData_v0 GlmCompressedFrameData;
+namespace CrowdTerrain { struct Mesh; }
+
+// cache data of one crowd field, kept between frames
+struct VRayGolaemLayout
+{
+	CStr _simulationFile;				//!< .gscs of _simulationData
+	GlmSimulationData* _simulationData;	//!< source simulation data
+	GlmCompressedFrameData* _compressedFrameData;	//!< source frame data, bones kept quantized
+	GlmFrameData* _frameData;			//!< source frame decoded for the layout evaluator, NULL when no layout is applied
+	int _frame;							//!< frame of _compressedFrameData
+	GlmLayoutEvaluator* _evaluator;		//!< layout of the crowd field, NULL when no layout is applied
+	CStr _terrainSourceFile;			//!< file of _terrainSource
+	CrowdTerrain::Mesh* _terrainSource;	//!< terrain of the simulation, for the layout ground adaptation. NULL if it could not be loaded
+	CStr _terrainDestinationFile;		//!< file of _terrainDestination
+	CrowdTerrain::Mesh* _terrainDestination;	//!< terrain the layout adapts the entities to, NULL to use _terrainSource
+};
 
 class VRayGolaem: public GeomObject, public VR::VRenderObject, public VR::VRayPluginRendererInterface 
 {
@@ -212,10 +234,14 @@ class VRayGolaem: public GeomObject, public VR::VRenderObject, public VR::VRayPl
 	CStr _tempVRSceneFileDir;
 
 	// Internal attributes
-	MaxSDK::Array<GlmSimulationData*> _simulationData;
-	MaxSDK::Array<GlmFrameData*> _frameData;
+	MaxSDK::Array<VRayGolaemLayout> _layouts;			//!< owns the simulation/frame data, one per crowd field
+	MaxSDK::Array<GlmSimulationData*> _simulationData;	//!< displayed data, layout result or source
+	MaxSDK::Array<GlmFrameData*> _frameData;				//!< layout result, NULL when it has deferred duplicates or no layout is applied
+	MaxSDK::Array<GlmDeferredFrameData*> _deferredFrameData;	//!< layout result, duplicates bones are computed when drawn. NULL when _frameData is set
+	MaxSDK::Array<GlmCompressedFrameData*> _compressedFrameData;	//!< source frame when no layout is applied, root bones are decoded when drawn
 	bool _updateCacheData;
 	Box3 _nodeBbox;					//!< Node bbox
+	MaxSDK::Array<uint8_t> _entityLods;	//!< viewport LOD of the displayed entities at the previous draw, for the LOD hysteresis
 
 public:
 	IParamBlock2 *pblock2;
@@ -304,8 +330,9 @@ public:
 	// Draw
 	//////////////////////////////////////////
 	void readGolaemCache(TimeValue t);
+	void clearLayouts(size_t firstLayout = 0);
 	void draw(TimeValue t, INode *node, ViewExp *vpt);
-	void drawEntities(GraphicsWindow *gw, const Matrix3& transform, TimeValue t);
+	void drawEntities(ViewExp *vpt, const Matrix3& transform, TimeValue t);
 
 	//////////////////////////////////////////
 	// read/write vrscene